@@ -6,6 +6,7 @@ include_guard(GLOBAL)
 # ---- User-facing options ----
 option(BODY_PACK   "pack eva"                                   OFF)
 option(EVA_ENABLE_COVERAGE "Enable gcov/llvm-cov instrumentation for coverage reports" OFF)
+option(EVA_BUILD_BENCH "Build the headless eva-bench evaluation runner" ON)
 
 if(EVA_ENABLE_COVERAGE)
     if (CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
@@ -261,7 +262,7 @@ elseif (MINGW)
 elseif (UNIX)
     message(STATUS "Compiling on Unix/Linux")
     find_package(X11 REQUIRED)
-    list(APPEND extra_LIBS X11::Xtst)
+    list(APPEND extra_LIBS X11::X11 X11::Xtst)
 endif()
 
 # ---- Language standard ----
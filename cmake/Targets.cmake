@@ -22,24 +22,48 @@ add_executable(
     src/app/app_bootstrap.cpp
     src/app/config_migrator.cpp
     src/app/default_model_finder.cpp
+    src/app/startup_sequencer.cpp
     src/app/app_context.h
     src/app/app_bootstrap.h
     src/app/config_migrator.h
     src/app/default_model_finder.h
+    src/app/startup_sequencer.h
+    src/core/replay/agent_replay.cpp
+    src/core/replay/agent_replay.h
+    src/core/replay/agent_stage_profiler.cpp
+    src/core/replay/agent_stage_profiler.h
+    src/core/replay/agent_tape.cpp
+    src/core/replay/agent_tape.h
     src/core/session/session_controller.cpp
     src/core/session/session_controller.h
     src/core/session/session_types.h
+    src/core/session/token_budget.cpp
+    src/core/session/token_budget.h
     src/core/toolflow/tool_flow_controller.cpp
     src/core/toolflow/tool_flow_controller.h
+    src/service/net/embedding_client.cpp
+    src/service/net/embedding_client.h
+    src/service/net/endpoint_pool.cpp
+    src/service/net/endpoint_pool.h
     src/service/net/net_client.cpp
     src/service/net/net_client.h
+    src/service/net/slot_scheduler.cpp
+    src/service/net/slot_scheduler.h
     src/service/net/request_snapshot.h
     src/service/backend/backend_coordinator.cpp
     src/service/backend/backend_coordinator.h
+    src/service/backend/resident_worker.cpp
+    src/service/backend/resident_worker.h
+    src/service/tools/content_search.cpp
+    src/service/tools/content_search.h
+    src/service/tools/line_index.cpp
+    src/service/tools/line_index.h
     src/service/tools/tool_executor.cpp
     src/service/tools/tool_executor.h
     src/service/tools/tool_registry.cpp
     src/service/tools/tool_registry.h
+    src/service/tools/workspace_index.cpp
+    src/service/tools/workspace_index.h
     src/main.cpp
     src/widget/widget.cpp
     src/widget/widget_session.cpp
@@ -69,19 +93,24 @@ add_executable(
     src/widget/terminal_pane.cpp
     src/widget/toolcall_test_dialog.cpp src/widget/toolcall_test_dialog.h
     src/expend/expend_knowledge.cpp src/expend/expend_ui.cpp src/expend/expend_quantize.cpp src/expend/expend_whisper.cpp src/expend/expend_sd.cpp 
-    src/expend/expend_eval.cpp 
+    src/expend/expend_eval.cpp src/expend/eval_suite.cpp src/expend/eval_suite.h
     src/expend/expend_mcp.cpp src/expend/expend_tts.cpp src/expend/expend_schedule.cpp
     src/expend/sd_params_dialog.cpp src/expend/sd_params_dialog.h
+    src/expend/doc_ingest.cpp src/expend/doc_ingest.h
     src/expend/expend.cpp src/xnet.cpp src/service/backend/localproxy.cpp src/xtool.cpp src/xmcp.cpp src/xmcp_internal.cpp src/service/backend/xbackend.cpp src/service/backend/xbackend_args.cpp src/prompt_builder.cpp src/prompt.cpp
     src/storage/history_store.cpp
+    src/storage/history_index.cpp src/storage/history_index.h
+    src/storage/history_writer.cpp src/storage/history_writer.h
     src/utils/scheduler_service.cpp
     src/storage/vectordb.cpp src/storage/vectordb.h
     src/utils/devicemanager.cpp src/utils/devicemanager.h
+    src/utils/gguf_reader.cpp src/utils/gguf_reader.h src/utils/model_catalog.cpp src/utils/model_catalog.h src/utils/memory_fit.cpp src/utils/memory_fit.h
     src/utils/docker_sandbox.cpp src/utils/docker_sandbox.h
     src/utils/pathutil.cpp src/utils/pathutil.h src/utils/processrunner.cpp src/utils/processrunner.h src/utils/depresolver.cpp src/utils/depresolver.h
     src/utils/startuplogger.cpp src/utils/startuplogger.h
     src/utils/flowtracer.cpp src/utils/flowtracer.h
     src/utils/perf_metrics.cpp src/utils/perf_metrics.h
+    src/utils/screen_capture.cpp src/utils/screen_capture.h src/utils/frame_change_detector.cpp src/utils/frame_change_detector.h
     src/utils/settings_change_analyzer.cpp src/utils/settings_change_analyzer.h
     src/utils/singleinstance.cpp src/utils/singleinstance.h
     src/widget/widget.h src/widget/terminal_pane.h src/xtool.h src/expend/expend.h src/xnet.h src/xconfig.h src/xmcp.h src/prompt.h src/service/backend/xbackend.h
@@ -94,6 +123,7 @@ add_executable(
     src/utils/evallogedit.cpp src/utils/evallogedit.h
     src/utils/introanimedit.cpp src/utils/introanimedit.h
     src/utils/textspacing.cpp src/utils/textspacing.h
+    src/utils/speech_stream_window.cpp src/utils/speech_stream_window.h
     src/utils/elidelabel.cpp src/utils/elidelabel.h
     src/utils/minibarchart.cpp  src/utils/minibarchart.h src/utils/flowprogressbar.h
     src/utils/textparse.cpp src/utils/textparse.h
@@ -104,6 +134,7 @@ add_executable(
     src/widget/skill_drop_area.cpp src/widget/skill_drop_area.h
     src/service/backend/localproxy.h
     src/net/controlchannel.cpp src/net/controlchannel.h
+    src/net/control_outbox.cpp src/net/control_outbox.h
 )
 # 避免 AUTOUIC 在非 UI 源文件中误扫描 ui_*.h
 set_source_files_properties(
@@ -185,6 +216,45 @@ endif()
 
 message(STATUS "eva型号: ${eva_OUTPUT_NAME}")
 
+# eva-bench：无界面的评估套件运行器（与评估页同一套题），输出 JSON 报告供回归追踪
+# 与 eva 放在同一 bin 目录，按同样的 EVA_BACKEND 规则找到 llama-server
+if (EVA_BUILD_BENCH)
+    add_executable(eva-bench
+        src/bench/eva_bench.cpp
+        src/bench/bench_runner.cpp src/bench/bench_runner.h
+        src/expend/eval_suite.cpp src/expend/eval_suite.h
+        src/xnet.cpp src/xnet.h
+        src/prompt.cpp src/prompt_builder.cpp
+        src/service/tools/tool_registry.cpp
+        src/service/backend/xbackend_args.cpp
+        src/utils/devicemanager.cpp
+        src/utils/gguf_reader.cpp
+        src/utils/memory_fit.cpp
+        src/utils/pathutil.cpp
+        src/utils/flowtracer.cpp
+        src/utils/simpleini.cpp
+        resource/res_bench.qrc)
+    target_link_libraries(eva-bench PRIVATE Qt5::Core Qt5::Gui Qt5::Network)
+    target_compile_features(eva-bench PRIVATE cxx_std_17)
+    target_include_directories(eva-bench PRIVATE
+        ${CMAKE_BINARY_DIR}/src/utils
+        ${CMAKE_SOURCE_DIR}
+        ${CMAKE_SOURCE_DIR}/src
+        ${CMAKE_SOURCE_DIR}/thirdparty/nlohmann)
+    set_target_properties(eva-bench PROPERTIES AUTOUIC OFF)
+    if (MINGW)
+        if (DEFINED EVA_COMPILE_OPTIONS)
+            target_compile_options(eva-bench PRIVATE ${EVA_COMPILE_OPTIONS})
+        endif()
+        if (DEFINED EVA_LINK_OPTIONS)
+            target_link_options(eva-bench PRIVATE ${EVA_LINK_OPTIONS})
+        endif()
+    endif()
+    if (TARGET backends)
+        add_dependencies(eva-bench backends)
+    endif()
+endif()
+
 
 
 
@@ -11,6 +11,7 @@
 
 #include "default_model_finder.h"
 #include "utils/devicemanager.h"
+#include "utils/model_catalog.h"
 #include "xconfig.h"
 
 void AppBootstrap::applyEarlyEnv()
@@ -165,7 +166,7 @@ void AppBootstrap::ensureDefaultConfig(const AppContext &ctx)
         return;
 
     const QString modelsRoot = ctx.modelsDir;
-    DefaultModelPaths paths = DefaultModelFinder::discover(modelsRoot);
+    DefaultModelPaths paths = DefaultModelFinder::discover(modelsRoot, &ModelCatalog::shared(ctx.appDir));
 
     QSettings s(cfgPath, QSettings::IniFormat);
     s.setIniCodec("utf-8");
@@ -1,5 +1,7 @@
 ﻿#include "default_model_finder.h"
 
+#include "utils/model_catalog.h"
+
 #include <QDir>
 #include <QDirIterator>
 #include <QFileInfo>
@@ -24,29 +26,36 @@ static QString findSmallestFile(const QString &root,
         const QString suffix = fi.suffix().toLower();
         if (!exts.contains("*." + suffix))
             continue;
+        // 先比体积再跑谓词：谓词可能要读文件头，只对可能胜出的候选执行
+        const qint64 sz = fi.size();
+        if (sz <= 0 || sz >= bestSz)
+            continue;
         if (pred && !pred(fi))
             continue;
-        const qint64 sz = fi.size();
-        if (sz > 0 && sz < bestSz)
-        {
-            best = fi.absoluteFilePath();
-            bestSz = sz;
-        }
+        best = fi.absoluteFilePath();
+        bestSz = sz;
     }
     return best;
 }
 
-DefaultModelPaths DefaultModelFinder::discover(const QString &modelsRoot)
+DefaultModelPaths DefaultModelFinder::discover(const QString &modelsRoot, ModelCatalog *catalog)
 {
     DefaultModelPaths out;
     if (modelsRoot.isEmpty() || !QDir(modelsRoot).exists())
         return out;
 
-    // LLM: EVA_MODELS/llm -> smallest .gguf
-    out.llmModel = findSmallestFile(QDir(modelsRoot).filePath("llm"), {"*.gguf"});
+    // 只读 GGUF 文件头判断能否作为主模型装载：损坏/非 GGUF 与 mmproj 投影文件都跳过
+    auto isLoadableModel = [catalog](const QFileInfo &fi)
+    {
+        const GgufInfo info = catalog ? catalog->lookup(fi.absoluteFilePath()) : GgufReader::read(fi.absoluteFilePath());
+        return info.valid && !info.isProjector();
+    };
+
+    // LLM: EVA_MODELS/llm -> smallest loadable .gguf
+    out.llmModel = findSmallestFile(QDir(modelsRoot).filePath("llm"), {"*.gguf"}, isLoadableModel);
 
-    // Embedding: EVA_MODELS/embedding -> smallest .gguf
-    out.embeddingModel = findSmallestFile(QDir(modelsRoot).filePath("embedding"), {"*.gguf"});
+    // Embedding: EVA_MODELS/embedding -> smallest loadable .gguf
+    out.embeddingModel = findSmallestFile(QDir(modelsRoot).filePath("embedding"), {"*.gguf"}, isLoadableModel);
 
     // Whisper(STT): EVA_MODELS/speech2text -> prefer filenames containing 'whisper'
     const QString sttRoot = QDir(modelsRoot).filePath("speech2text");
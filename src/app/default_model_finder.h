@@ -3,6 +3,8 @@
 #include <QSettings>
 #include <QString>
 
+class ModelCatalog;
+
 // 启动时的默认模型发现结果。
 struct DefaultModelPaths
 {
@@ -15,11 +17,12 @@ struct DefaultModelPaths
 };
 
 // 默认模型发现器：扫描 EVA_MODELS 并选择“最小体积可用模型”。
+// LLM/嵌入目录下的候选需是可解析的 GGUF，且排除 mmproj 视觉投影文件（它们往往体积最小）。
 class DefaultModelFinder
 {
 public:
-    // 在 EVA_MODELS 目录中自动查找最小模型路径。
-    static DefaultModelPaths discover(const QString &modelsRoot);
+    // 在 EVA_MODELS 目录中自动查找最小模型路径；catalog 为空时直接读取文件头（不落缓存）。
+    static DefaultModelPaths discover(const QString &modelsRoot, ModelCatalog *catalog = nullptr);
     // 将发现结果写入配置文件（仅写入非空项）。
     static void applyToSettings(QSettings &settings, const DefaultModelPaths &paths);
 };
@@ -0,0 +1,72 @@
+﻿#include "startup_sequencer.h"
+
+#include <QEvent>
+#include <QTimer>
+
+#include "../utils/flowtracer.h"
+#include "../utils/startuplogger.h"
+
+StartupSequencer::StartupSequencer(QWidget *window, QObject *parent)
+    : QObject(parent), window_(window)
+{
+    if (window_) window_->installEventFilter(this);
+    // 兜底定时器在进入事件循环后才开始计时，与首帧竞争，先到者触发
+    QTimer::singleShot(0, this, [this]()
+                       { QTimer::singleShot(fallbackMs_, this, [this]()
+                                            {
+                                                if (started_) return;
+                                                FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("startup: first paint not observed, draining deferred work"));
+                                                begin(); }); });
+}
+
+void StartupSequencer::defer(const QString &name, std::function<void()> task)
+{
+    if (!task) return;
+    tasks_.enqueue(Task{name, std::move(task)});
+    // 已经排空过一轮：重新拉起
+    if (finished_)
+    {
+        finished_ = false;
+        QTimer::singleShot(0, this, &StartupSequencer::runNext);
+    }
+}
+
+bool StartupSequencer::eventFilter(QObject *watched, QEvent *event)
+{
+    if (!started_ && watched == window_ && event->type() == QEvent::Paint)
+    {
+        // 首帧：此刻 paintEvent 尚未返回，记下时间后让出事件循环，等这一帧真正画完再排空任务
+        StartupLogger::milestone(QStringLiteral("first_window"));
+        FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("startup: first window paint"));
+        emit firstWindow(StartupLogger::milestoneMs(QStringLiteral("first_window")));
+        begin();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void StartupSequencer::begin()
+{
+    if (started_) return;
+    started_ = true;
+    if (window_) window_->removeEventFilter(this);
+    QTimer::singleShot(0, this, &StartupSequencer::runNext);
+}
+
+void StartupSequencer::runNext()
+{
+    if (tasks_.isEmpty())
+    {
+        if (finished_) return;
+        finished_ = true;
+        StartupLogger::milestone(QStringLiteral("ready"));
+        FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("startup: deferred work drained"));
+        emit finished();
+        return;
+    }
+    const Task task = tasks_.dequeue();
+    {
+        StartupLogger::Scope scope(task.name);
+        task.run();
+    }
+    QTimer::singleShot(0, this, &StartupSequencer::runNext);
+}
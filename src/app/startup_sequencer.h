@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QString>
+#include <QWidget>
+
+#include <functional>
+
+// 启动编排：主窗口首帧绘制后再逐个执行不可见子系统的初始化（后端拉起、向量库加载、嵌入服务等），
+// 每个任务占一个事件循环回合，窗口在任务之间仍可响应。任务都以 StartupLogger::Scope 计时，
+// 首帧与全部完成分别记为 first_window / ready 里程碑。
+class StartupSequencer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StartupSequencer(QWidget *window, QObject *parent = nullptr);
+
+    // 追加一个首帧后执行的任务（GUI 线程）；已开始排空时同样按顺序执行。
+    void defer(const QString &name, std::function<void()> task);
+
+    // 首帧迟迟没有到来（窗口被最小化到托盘、无显示环境等）时的兜底等待，毫秒
+    void setFallbackMs(int ms) { fallbackMs_ = ms; }
+
+    bool started() const { return started_; }
+    bool isFinished() const { return finished_; }
+
+signals:
+    void firstWindow(qint64 ms);
+    void finished();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Task
+    {
+        QString name;
+        std::function<void()> run;
+    };
+
+    void begin();
+    void runNext();
+
+    QPointer<QWidget> window_;
+    QQueue<Task> tasks_;
+    int fallbackMs_ = 3000;
+    bool started_ = false;
+    bool finished_ = false;
+};
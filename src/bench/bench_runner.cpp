@@ -0,0 +1,679 @@
+#include "bench_runner.h"
+
+#include "cmakeconfig.h"
+#include "expend/eval_suite.h"
+#include "prompt.h"
+#include "service/backend/xbackend_args.h"
+#include "utils/devicemanager.h"
+#include "utils/gguf_reader.h"
+#include "utils/memory_fit.h"
+#include "utils/simpleini.h"
+#include "xnet.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTextStream>
+
+namespace
+{
+// 语言包：lang_en.ini 为 "id|key=text"，其余语种为 "id=text"；缺失的条目回退英文
+QHash<int, QString> loadLanguageEntries(const QString &path, QHash<int, QString> *idToKey)
+{
+    QHash<int, QString> table;
+    const auto map = simpleini::parseFile(path);
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+    {
+        QString rawKey = it.key().trimmed();
+        const int pipePos = rawKey.indexOf(QLatin1Char('|'));
+        QString keyName;
+        if (pipePos >= 0)
+        {
+            keyName = rawKey.mid(pipePos + 1).trimmed();
+            rawKey = rawKey.left(pipePos);
+        }
+        bool ok = false;
+        const int id = rawKey.trimmed().toInt(&ok);
+        if (!ok) continue;
+        if (idToKey && !keyName.isEmpty()) idToKey->insert(id, keyName);
+        table.insert(id, it.value());
+    }
+    return table;
+}
+
+QString languageFile(int language)
+{
+    switch (language)
+    {
+    case EVA_LANG_ZH: return QStringLiteral(":/language/lang_zh.ini");
+    case EVA_LANG_JA: return QStringLiteral(":/language/lang_ja.ini");
+    default: return QStringLiteral(":/language/lang_en.ini");
+    }
+}
+
+QJsonObject summaryJson(const QVector<double> &samples)
+{
+    const EvalSuite::Summary s = EvalSuite::summarize(samples);
+    QJsonObject obj;
+    obj.insert(QStringLiteral("count"), s.count);
+    if (s.count == 0) return obj;
+    obj.insert(QStringLiteral("min"), s.min);
+    obj.insert(QStringLiteral("max"), s.max);
+    obj.insert(QStringLiteral("mean"), s.mean);
+    obj.insert(QStringLiteral("p50"), s.p50);
+    obj.insert(QStringLiteral("p90"), s.p90);
+    obj.insert(QStringLiteral("p99"), s.p99);
+    return obj;
+}
+
+QTextStream &errStream()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+} // namespace
+
+BenchRunner::BenchRunner(const Options &options, QObject *parent)
+    : QObject(parent), options_(options)
+{
+    requestTimer_.setSingleShot(true);
+    connect(&requestTimer_, &QTimer::timeout, this, &BenchRunner::onRequestTimeout);
+    healthTimer_.setSingleShot(true);
+    healthTimer_.setInterval(DEFAULT_BENCH_HEALTH_POLL_MS);
+    connect(&healthTimer_, &QTimer::timeout, this, &BenchRunner::pollHealth);
+}
+
+BenchRunner::~BenchRunner()
+{
+    stopServer();
+    delete net_;
+}
+
+QStringList BenchRunner::knownSuites()
+{
+    return {QStringLiteral("latency"), QStringLiteral("gen"), QStringLiteral("qa"), QStringLiteral("logic"), QStringLiteral("tool")};
+}
+
+void BenchRunner::start()
+{
+    if (options_.suites.isEmpty()) options_.suites = knownSuites();
+    for (const QString &suite : options_.suites)
+    {
+        if (!knownSuites().contains(suite))
+        {
+            fail(QStringLiteral("unknown suite: %1 (expected %2)").arg(suite, knownSuites().join(QLatin1Char(','))));
+            return;
+        }
+    }
+    promptx::setPromptLanguage(options_.language);
+    if (!loadWords())
+    {
+        fail(QStringLiteral("language pack missing in resources"));
+        return;
+    }
+
+    net_ = new xNet();
+    net_->recv_language(options_.language);
+    // xNet 与 BenchRunner 同在主线程，直连即可
+    connect(net_, &xNet::net2ui_output, this, &BenchRunner::onOutput);
+    connect(net_, &xNet::net2ui_state, this, &BenchRunner::onState);
+    connect(net_, &xNet::net2ui_speeds, this, &BenchRunner::onSpeeds);
+    connect(net_, &xNet::net2ui_turn_counters, this, &BenchRunner::onTurnCounters);
+    connect(net_, &xNet::net2ui_pushover, this, &BenchRunner::onPushover);
+
+    apis_.api_key = options_.apiKey;
+    apis_.api_model = options_.model;
+    if (!options_.gguf.isEmpty())
+    {
+        if (!startServer()) return;
+        healthClock_.start();
+        pollHealth();
+        return;
+    }
+    apis_.api_endpoint = options_.endpoint;
+    apis_.is_local_backend = false;
+    buildPlan();
+    runNext();
+}
+
+bool BenchRunner::loadWords()
+{
+    QHash<int, QString> idToKey;
+    const QHash<int, QString> english = loadLanguageEntries(languageFile(EVA_LANG_EN), &idToKey);
+    if (idToKey.isEmpty()) return false;
+    const QHash<int, QString> local = options_.language == EVA_LANG_EN ? english : loadLanguageEntries(languageFile(options_.language), nullptr);
+    for (auto it = idToKey.constBegin(); it != idToKey.constEnd(); ++it)
+    {
+        QString text = local.value(it.key());
+        if (text.isEmpty()) text = english.value(it.key());
+        words_.insert(it.value(), text.isEmpty() ? it.value() : text);
+    }
+    return true;
+}
+
+QString BenchRunner::word(const char *key) const
+{
+    const QString name = QString::fromLatin1(key);
+    return words_.value(name, name);
+}
+
+ENDPOINT_DATA BenchRunner::baseData(double temp, int npredict) const
+{
+    // 与评估页 makeBaseData 一致，其余采样参数取默认值
+    const SETTINGS defaults;
+    ENDPOINT_DATA d{};
+    d.is_complete_state = false;
+    d.temp = float(temp);
+    d.repeat = defaults.repeat;
+    d.top_k = defaults.top_k;
+    d.top_p = defaults.hid_top_p;
+    d.n_predict = npredict;
+    d.reasoning_effort = sanitizeReasoningEffort(defaults.reasoning_effort);
+    d.stopwords = QStringList();
+    d.id_slot = -1;
+    return d;
+}
+
+void BenchRunner::buildPlan()
+{
+    auto makeMsgs = [](const QString &sys, const QString &user)
+    {
+        QJsonArray arr;
+        arr.append(QJsonObject{{QStringLiteral("role"), QStringLiteral(DEFAULT_SYSTEM_NAME)}, {QStringLiteral("content"), sys}});
+        arr.append(QJsonObject{{QStringLiteral("role"), QStringLiteral(DEFAULT_USER_NAME)}, {QStringLiteral("content"), user}});
+        return arr;
+    };
+    auto latencyTask = [&](const QString &suite, int round)
+    {
+        Task task;
+        task.suite = suite;
+        task.round = round;
+        task.data = baseData(EvalSuite::kLatencyTemp, 1);
+        task.data.messagesArray = makeMsgs(EvalSuite::latencySystemPrompt(), EvalSuite::latencyUserPrompt());
+        task.stopAtFirstToken = true;
+        return task;
+    };
+
+    plan_.clear();
+    for (int w = 0; w < options_.warmup; ++w) plan_.append(latencyTask(QStringLiteral("warmup"), -1 - w));
+
+    const QString toolSystem = EvalSuite::toolSystemPrompt();
+    for (int round = 0; round < options_.repeat; ++round)
+    {
+        for (const QString &suite : options_.suites)
+        {
+            if (suite == QLatin1String("latency"))
+            {
+                plan_.append(latencyTask(suite, round));
+            }
+            else if (suite == QLatin1String("gen"))
+            {
+                Task task;
+                task.suite = suite;
+                task.round = round;
+                task.key = QStringLiteral("gen essay prompt");
+                task.data = baseData(EvalSuite::kGenTemp, EvalSuite::kGenPredict);
+                task.data.messagesArray = makeMsgs(EvalSuite::genSystemPrompt(), word("gen essay prompt"));
+                plan_.append(task);
+            }
+            else if (suite == QLatin1String("qa") || suite == QLatin1String("logic"))
+            {
+                const QVector<EvalSuite::ChoiceItem> &items = suite == QLatin1String("qa") ? EvalSuite::qaItems() : EvalSuite::logicItems();
+                for (int i = 0; i < items.size(); ++i)
+                {
+                    Task task;
+                    task.suite = suite;
+                    task.round = round;
+                    task.index = i;
+                    task.key = QString::fromLatin1(items.at(i).key);
+                    task.expectChoice = items.at(i).answer;
+                    task.data = baseData(EvalSuite::kChoiceTemp, 0);
+                    task.data.messagesArray = makeMsgs(EvalSuite::choiceSystemPrompt(), word(items.at(i).key));
+                    plan_.append(task);
+                }
+            }
+            else if (suite == QLatin1String("tool"))
+            {
+                const QVector<EvalSuite::ToolCase> &cases = EvalSuite::toolCases();
+                for (int i = 0; i < cases.size(); ++i)
+                {
+                    Task task;
+                    task.suite = suite;
+                    task.round = round;
+                    task.index = i;
+                    task.key = QString::fromLatin1(cases.at(i).taskKey);
+                    task.expectTool = QString::fromLatin1(cases.at(i).name);
+                    task.data = baseData(EvalSuite::kToolTemp, 0);
+                    task.data.messagesArray = makeMsgs(toolSystem, EvalSuite::toolTask(word(cases.at(i).taskKey)));
+                    plan_.append(task);
+                }
+            }
+        }
+    }
+    cursor_ = -1;
+    results_.clear();
+}
+
+bool BenchRunner::startServer()
+{
+    if (!options_.backend.isEmpty()) DeviceManager::setUserChoice(options_.backend);
+    const QString program = options_.serverProgram.isEmpty() ? DeviceManager::programPath(QStringLiteral("llama-server-main")) : options_.serverProgram;
+    if (program.isEmpty() || !QFileInfo::exists(program))
+    {
+        fail(QStringLiteral("llama-server not found (backend=%1)").arg(DeviceManager::effectiveBackend()));
+        return false;
+    }
+    if (!QFileInfo::exists(options_.gguf))
+    {
+        fail(QStringLiteral("model not found: %1").arg(options_.gguf));
+        return false;
+    }
+
+    LocalServerArgsInput input;
+    input.settings.nctx = options_.nctx;
+    input.settings.ngl = options_.ngl;
+    input.settings.hid_parallel = 1;
+    input.settings.hid_cache_type_k = options_.cacheType;
+    input.settings.hid_cache_type_v = options_.cacheType;
+    input.settings.hid_cache_reuse = options_.cacheReuse;
+    input.settings.hid_context_shift = options_.contextShift;
+    input.host = QStringLiteral("127.0.0.1");
+    input.port = options_.port;
+    input.modelPath = options_.gguf;
+    input.resolvedDevice = DeviceManager::lastResolvedDeviceFor(QStringLiteral("llama-server-main"));
+    input.win7Backend = (DeviceManager::currentOsId() == QStringLiteral("win7"));
+    const QStringList args = buildLocalServerArgs(input);
+
+    // 与 LocalServerManager 一致：让子进程能找到同目录下的运行时库
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    const QString toolDir = QFileInfo(program).absolutePath();
+#ifdef _WIN32
+    env.insert("PATH", toolDir + ";" + env.value("PATH"));
+#elif __APPLE__
+    env.insert("DYLD_LIBRARY_PATH", toolDir + ":" + env.value("DYLD_LIBRARY_PATH"));
+#else
+    env.insert("LD_LIBRARY_PATH", toolDir + ":" + env.value("LD_LIBRARY_PATH"));
+#endif
+    server_ = new QProcess(this);
+    server_->setProcessEnvironment(env);
+    server_->setWorkingDirectory(toolDir);
+    // 服务端日志量大，不混进报告所在的标准输出
+    server_->setStandardOutputFile(QProcess::nullDevice());
+    server_->setStandardErrorFile(QProcess::nullDevice());
+    connect(server_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this](int code, QProcess::ExitStatus)
+            {
+        if (!done_) fail(QStringLiteral("llama-server exited early (code %1)").arg(code)); });
+    errStream() << "eva-bench: launching " << QFileInfo(program).fileName() << ' ' << args.join(QLatin1Char(' ')) << '\n';
+    errStream().flush();
+    server_->start(program, args);
+
+    apis_.api_endpoint = QStringLiteral("http://127.0.0.1:%1").arg(options_.port);
+    apis_.is_local_backend = true;
+    return true;
+}
+
+double BenchRunner::serverPeakRssMb() const
+{
+#ifdef Q_OS_LINUX
+    if (!server_ || server_->state() == QProcess::NotRunning) return -1.0;
+    QFile status(QStringLiteral("/proc/%1/status").arg(server_->processId()));
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) return -1.0;
+    while (!status.atEnd())
+    {
+        const QByteArray line = status.readLine();
+        if (!line.startsWith("VmHWM:")) continue;
+        const QList<QByteArray> parts = line.mid(6).simplified().split(' ');
+        bool ok = false;
+        const double kb = parts.value(0).toDouble(&ok);
+        return ok ? kb / 1024.0 : -1.0;
+    }
+#endif
+    return -1.0;
+}
+
+void BenchRunner::stopServer()
+{
+    if (!server_) return;
+    server_->disconnect(this);
+    if (server_->state() != QProcess::NotRunning)
+    {
+        server_->kill();
+        server_->waitForFinished(3000);
+    }
+}
+
+void BenchRunner::pollHealth()
+{
+    if (done_) return;
+    if (healthClock_.elapsed() > DEFAULT_BENCH_HEALTH_TIMEOUT_MS)
+    {
+        fail(QStringLiteral("llama-server did not become healthy in time"));
+        return;
+    }
+    if (!nam_) nam_ = new QNetworkAccessManager(this);
+    QNetworkRequest request(QUrl(apis_.api_endpoint + QStringLiteral("/health")));
+    QNetworkReply *reply = nam_->get(request);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]()
+            {
+        reply->deleteLater();
+        if (done_) return;
+        // 模型加载期间 /health 返回 503，连接被拒说明进程还没监听
+        const int http = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (reply->error() == QNetworkReply::NoError && http == 200)
+        {
+            errStream() << "eva-bench: server ready after " << healthClock_.elapsed() << " ms\n";
+            errStream().flush();
+            buildPlan();
+            runNext();
+            return;
+        }
+        healthTimer_.start(); });
+}
+
+void BenchRunner::runNext()
+{
+    if (done_) return;
+    ++cursor_;
+    if (cursor_ >= plan_.size())
+    {
+        writeReport();
+        return;
+    }
+    const Task &task = plan_.at(cursor_);
+    current_ = Result();
+    current_.suite = task.suite;
+    current_.round = task.round;
+    current_.index = task.index;
+    current_.key = task.key;
+    raw_.clear();
+    stopping_ = false;
+    inFlight_ = true;
+    net_->recv_apis(apis_);
+    net_->recv_data(task.data);
+    clock_.restart();
+    requestTimer_.start(options_.requestTimeoutMs);
+    net_->run();
+}
+
+void BenchRunner::onOutput(const QString &text, bool streaming, QColor color)
+{
+    Q_UNUSED(streaming);
+    Q_UNUSED(color);
+    if (!inFlight_ || text.isEmpty()) return;
+    raw_ += text;
+    if (text.trimmed().isEmpty()) return;
+    ++current_.chunks;
+    if (current_.ttfbMs >= 0.0) return;
+    current_.ttfbMs = clock_.nsecsElapsed() / 1e6;
+    if (plan_.at(cursor_).stopAtFirstToken)
+    {
+        // 只测首包：拿到就停，pushover 会同步回来
+        stopping_ = true;
+        net_->recv_stop(true);
+    }
+}
+
+void BenchRunner::onState(const QString &line, SIGNAL_STATE state)
+{
+    if (!inFlight_ || stopping_ || state != WRONG_SIGNAL) return;
+    if (current_.error.isEmpty()) current_.error = line;
+}
+
+void BenchRunner::onSpeeds(double promptPerSecond, double predictedPerSecond)
+{
+    if (!inFlight_) return;
+    if (promptPerSecond > 0.0)
+    {
+        current_.prefillTps = promptPerSecond;
+        current_.speedsReported = true;
+    }
+    if (predictedPerSecond > 0.0)
+    {
+        current_.decodeTps = predictedPerSecond;
+        current_.speedsReported = true;
+    }
+}
+
+void BenchRunner::onTurnCounters(int cacheTokens, int promptTokens, int predictedTokens)
+{
+    Q_UNUSED(cacheTokens);
+    if (!inFlight_) return;
+    if (promptTokens > 0) current_.promptTokens = promptTokens;
+    if (predictedTokens > 0) current_.predictedTokens = predictedTokens;
+}
+
+void BenchRunner::onRequestTimeout()
+{
+    if (!inFlight_) return;
+    current_.error = QStringLiteral("bench: request timed out after %1 ms").arg(options_.requestTimeoutMs);
+    stopping_ = true;
+    net_->recv_stop(true);
+}
+
+void BenchRunner::onPushover()
+{
+    if (!inFlight_) return;
+    inFlight_ = false;
+    finishTask();
+    // 推迟到下一轮事件循环，避免在 xNet 的回调栈里重入 run()
+    QTimer::singleShot(0, this, &BenchRunner::runNext);
+}
+
+void BenchRunner::finishTask()
+{
+    requestTimer_.stop();
+    const Task &task = plan_.at(cursor_);
+    Result &r = current_;
+    r.totalMs = clock_.nsecsElapsed() / 1e6;
+    if (r.error.isEmpty())
+    {
+        // 非流式回复没有单独的首包，退化为整段耗时（与评估页一致）
+        if (r.ttfbMs < 0.0) r.ttfbMs = r.totalMs;
+        // 远端 API 不回 timings 时按 token 计数估算；都没有就按 1 chunk≈1 token
+        const double decodeMs = r.totalMs - r.ttfbMs;
+        const int produced = r.predictedTokens > 0 ? r.predictedTokens : r.chunks;
+        if (r.decodeTps < 0.0 && !task.stopAtFirstToken && decodeMs > 0.0 && produced > 1) r.decodeTps = (produced - 1) * 1000.0 / decodeMs;
+        if (r.prefillTps < 0.0 && r.promptTokens > 0 && r.ttfbMs > 0.0) r.prefillTps = r.promptTokens * 1000.0 / r.ttfbMs;
+    }
+
+    if (!task.expectChoice.isNull())
+    {
+        r.judged = true;
+        r.ok = r.error.isEmpty() && EvalSuite::judgeChoice(EvalSuite::stripReasoning(raw_), task.expectChoice);
+    }
+    else if (!task.expectTool.isEmpty())
+    {
+        r.judged = true;
+        const QString visible = EvalSuite::stripReasoning(raw_);
+        const QString name = EvalSuite::toolCallName(visible.trimmed().isEmpty() ? raw_ : visible);
+        r.ok = r.error.isEmpty() && name == task.expectTool;
+    }
+
+    QTextStream &err = errStream();
+    err << "[" << r.suite << (r.round >= 0 ? QStringLiteral(" r%1").arg(r.round + 1) : QString()) << " " << (cursor_ + 1) << "/" << plan_.size() << "] ";
+    if (!r.error.isEmpty())
+        err << "error: " << r.error;
+    else
+    {
+        err << "ttfb " << QString::number(r.ttfbMs, 'f', 1) << " ms";
+        if (r.decodeTps > 0.0) err << ", decode " << QString::number(r.decodeTps, 'f', 1) << " tok/s";
+        if (r.judged) err << (r.ok ? ", ok" : ", wrong");
+    }
+    err << '\n';
+    err.flush();
+
+    if (r.round >= 0) results_.append(r);
+}
+
+QJsonObject BenchRunner::report() const
+{
+    QJsonObject root;
+    root.insert(QStringLiteral("schema"), 1);
+    root.insert(QStringLiteral("tool"), QStringLiteral("eva-bench"));
+    root.insert(QStringLiteral("eva_version"), QStringLiteral(EVA_VERSION));
+    root.insert(QStringLiteral("compiler"), QStringLiteral(COMPILE_VERSION));
+    root.insert(QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    if (!options_.tag.isEmpty()) root.insert(QStringLiteral("tag"), options_.tag);
+
+    QJsonObject target;
+    target.insert(QStringLiteral("endpoint"), apis_.api_endpoint);
+    target.insert(QStringLiteral("model"), options_.gguf.isEmpty() ? options_.model : QFileInfo(options_.gguf).fileName());
+    if (!options_.gguf.isEmpty())
+    {
+        target.insert(QStringLiteral("backend"), DeviceManager::lastResolvedDeviceFor(QStringLiteral("llama-server-main")));
+        target.insert(QStringLiteral("n_ctx"), options_.nctx);
+        target.insert(QStringLiteral("n_gpu_layers"), options_.ngl);
+        // KV 相关选项与内存占用：对比不同 --cache-type 的内存与 tok/s 取舍
+        const QString cacheType = effectiveKvCacheType(options_.cacheType, DEFAULT_FLASH_ATTN);
+        target.insert(QStringLiteral("cache_type_k"), cacheType);
+        target.insert(QStringLiteral("cache_type_v"), cacheType);
+        target.insert(QStringLiteral("cache_reuse"), options_.cacheReuse);
+        target.insert(QStringLiteral("context_shift"), options_.contextShift);
+        const GgufInfo info = GgufReader::read(options_.gguf);
+        if (info.valid)
+        {
+            const qint64 kvBytes = MemoryFit::kvCacheBytes(info, options_.nctx, cacheType, cacheType);
+            target.insert(QStringLiteral("kv_cache_mb"), double(kvBytes) / (1024.0 * 1024.0));
+        }
+        if (serverPeakRssMb_ >= 0.0) target.insert(QStringLiteral("server_peak_rss_mb"), serverPeakRssMb_);
+    }
+    root.insert(QStringLiteral("target"), target);
+
+    QJsonObject config;
+    config.insert(QStringLiteral("repeat"), options_.repeat);
+    config.insert(QStringLiteral("warmup"), options_.warmup);
+    config.insert(QStringLiteral("suites"), QJsonArray::fromStringList(options_.suites));
+    config.insert(QStringLiteral("language"), evaLanguageCodeFromFlag(options_.language));
+    root.insert(QStringLiteral("config"), config);
+
+    QJsonObject suites;
+    QHash<QString, double> accuracy;
+    QHash<QString, double> medianTtfb;
+    QHash<QString, double> meanDecode;
+    int failures = 0;
+    for (const QString &suite : options_.suites)
+    {
+        QVector<double> ttfb, total, prefill, decode;
+        int requests = 0, errors = 0, judged = 0, correct = 0;
+        for (const Result &r : results_)
+        {
+            if (r.suite != suite) continue;
+            ++requests;
+            if (r.judged)
+            {
+                ++judged;
+                if (r.ok) ++correct;
+            }
+            if (!r.error.isEmpty())
+            {
+                ++errors;
+                continue;
+            }
+            ttfb.append(r.ttfbMs);
+            total.append(r.totalMs);
+            if (r.prefillTps > 0.0) prefill.append(r.prefillTps);
+            if (r.decodeTps > 0.0) decode.append(r.decodeTps);
+        }
+        failures += errors;
+        QJsonObject obj;
+        obj.insert(QStringLiteral("requests"), requests);
+        obj.insert(QStringLiteral("errors"), errors);
+        obj.insert(QStringLiteral("ttfb_ms"), summaryJson(ttfb));
+        obj.insert(QStringLiteral("total_ms"), summaryJson(total));
+        if (suite != QLatin1String("latency"))
+        {
+            obj.insert(QStringLiteral("prefill_tok_s"), summaryJson(prefill));
+            obj.insert(QStringLiteral("decode_tok_s"), summaryJson(decode));
+        }
+        if (judged > 0)
+        {
+            accuracy.insert(suite, 100.0 * correct / judged);
+            obj.insert(QStringLiteral("correct"), correct);
+            obj.insert(QStringLiteral("total"), judged);
+            obj.insert(QStringLiteral("accuracy"), accuracy.value(suite));
+        }
+        if (!ttfb.isEmpty()) medianTtfb.insert(suite, EvalSuite::summarize(ttfb).p50);
+        if (!decode.isEmpty()) meanDecode.insert(suite, EvalSuite::summarize(decode).mean);
+        suites.insert(suite, obj);
+    }
+    root.insert(QStringLiteral("suites"), suites);
+    root.insert(QStringLiteral("errors"), failures);
+
+    // 五项齐全时给出与评估页同口径的同步率
+    if (options_.suites.size() == knownSuites().size())
+    {
+        root.insert(QStringLiteral("sync_rate"), EvalSuite::syncRate(medianTtfb.value(QStringLiteral("latency"), -1.0), meanDecode.value(QStringLiteral("gen"), -1.0),
+                                                                      accuracy.value(QStringLiteral("qa")), accuracy.value(QStringLiteral("logic")), accuracy.value(QStringLiteral("tool"))));
+    }
+
+    QJsonArray runs;
+    for (const Result &r : results_)
+    {
+        QJsonObject obj;
+        obj.insert(QStringLiteral("suite"), r.suite);
+        obj.insert(QStringLiteral("round"), r.round + 1);
+        obj.insert(QStringLiteral("index"), r.index);
+        if (!r.key.isEmpty()) obj.insert(QStringLiteral("case"), r.key);
+        obj.insert(QStringLiteral("ttfb_ms"), r.ttfbMs);
+        obj.insert(QStringLiteral("total_ms"), r.totalMs);
+        if (r.prefillTps > 0.0) obj.insert(QStringLiteral("prefill_tok_s"), r.prefillTps);
+        if (r.decodeTps > 0.0) obj.insert(QStringLiteral("decode_tok_s"), r.decodeTps);
+        obj.insert(QStringLiteral("speeds_reported"), r.speedsReported);
+        if (r.promptTokens > 0) obj.insert(QStringLiteral("prompt_tokens"), r.promptTokens);
+        if (r.predictedTokens > 0) obj.insert(QStringLiteral("predicted_tokens"), r.predictedTokens);
+        if (r.judged) obj.insert(QStringLiteral("ok"), r.ok);
+        if (!r.error.isEmpty()) obj.insert(QStringLiteral("error"), r.error);
+        runs.append(obj);
+    }
+    root.insert(QStringLiteral("runs"), runs);
+    return root;
+}
+
+void BenchRunner::writeReport()
+{
+    done_ = true;
+    serverPeakRssMb_ = serverPeakRssMb();
+    stopServer();
+    const QJsonObject root = report();
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    if (options_.outPath.isEmpty())
+    {
+        QTextStream out(stdout);
+        out << QString::fromUtf8(json);
+        out.flush();
+    }
+    else
+    {
+        QFile file(options_.outPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            errStream() << "eva-bench: cannot write " << options_.outPath << '\n';
+            errStream().flush();
+            emit finished(1);
+            return;
+        }
+        file.write(json);
+        file.close();
+        errStream() << "eva-bench: report written to " << options_.outPath << '\n';
+        errStream().flush();
+    }
+    // 有请求失败时用非零退出码提醒 CI，报告照常输出
+    emit finished(root.value(QStringLiteral("errors")).toInt() > 0 ? 2 : 0);
+}
+
+void BenchRunner::fail(const QString &message)
+{
+    if (done_) return;
+    done_ = true;
+    requestTimer_.stop();
+    healthTimer_.stop();
+    stopServer();
+    errStream() << "eva-bench: " << message << '\n';
+    errStream().flush();
+    emit finished(1);
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <QColor>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QPointer>
+#include <QProcess>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+#include "xconfig.h"
+
+class QNetworkAccessManager;
+class xNet;
+
+// eva-bench 的调度核心：按顺序跑评估套件（与增殖窗口评估页同一套题，见 expend/eval_suite.h），
+// 逐请求记录首包/预填充/生成速度，最后输出 JSON 报告，便于按提交、按后端构建追踪回归。
+// - 目标可以是现成的 OpenAI 兼容端点，也可以是本地 GGUF（自动拉起 llama-server 并等待 /health）
+// - warmup 轮只跑不记；repeat 轮逐条记录，统计取 nearest-rank 分位数
+// - 单个请求出错只记入该请求，不中断整轮
+class BenchRunner : public QObject
+{
+    Q_OBJECT
+  public:
+    struct Options
+    {
+        QString endpoint;
+        QString apiKey;
+        QString model = QStringLiteral("default");
+        QString gguf;          // 非空时在本地拉起 llama-server
+        QString serverProgram; // 覆盖 llama-server 路径；为空按 DeviceManager 解析
+        QString backend;       // cpu/cuda/vulkan/...，为空沿用 auto
+        QString port = QStringLiteral(DEFAULT_BENCH_SERVER_PORT);
+        int nctx = DEFAULT_NCTX;
+        int ngl = DEFAULT_BENCH_NGL;
+        QString cacheType = QStringLiteral(DEFAULT_CACHE_TYPE); // KV 缓存类型（K/V 相同）
+        int cacheReuse = DEFAULT_CACHE_REUSE;
+        bool contextShift = DEFAULT_CONTEXT_SHIFT;
+        QStringList suites;
+        int repeat = 1;
+        int warmup = 1;
+        int language = EVA_LANG_EN;
+        int requestTimeoutMs = DEFAULT_BENCH_REQUEST_TIMEOUT_MS;
+        QString outPath; // 为空时写到标准输出
+        QString tag;     // 调用方自定义标签（提交号、构建号等），原样写进报告
+    };
+
+    explicit BenchRunner(const Options &options, QObject *parent = nullptr);
+    ~BenchRunner() override;
+
+    static QStringList knownSuites();
+    void start();
+
+  signals:
+    void finished(int exitCode);
+
+  private slots:
+    void onOutput(const QString &text, bool streaming, QColor color);
+    void onState(const QString &line, SIGNAL_STATE state);
+    void onSpeeds(double promptPerSecond, double predictedPerSecond);
+    void onTurnCounters(int cacheTokens, int promptTokens, int predictedTokens);
+    void onPushover();
+    void onRequestTimeout();
+    void pollHealth();
+
+  private:
+    struct Task
+    {
+        QString suite;
+        int round = 0;   // 0 起；warmup 为负
+        int index = 0;   // 套件内序号
+        QString key;     // 题目 / 用例的语言键
+        ENDPOINT_DATA data;
+        QChar expectChoice;
+        QString expectTool;
+        bool stopAtFirstToken = false;
+    };
+    struct Result
+    {
+        QString suite;
+        int round = 0;
+        int index = 0;
+        QString key;
+        double ttfbMs = -1.0;
+        double totalMs = -1.0;
+        double prefillTps = -1.0;
+        double decodeTps = -1.0;
+        bool speedsReported = false;
+        int promptTokens = 0;
+        int predictedTokens = 0;
+        int chunks = 0;
+        bool judged = false;
+        bool ok = false;
+        QString error;
+    };
+
+    bool loadWords();
+    QString word(const char *key) const;
+    ENDPOINT_DATA baseData(double temp, int npredict) const;
+    void buildPlan();
+    bool startServer();
+    void stopServer();
+    double serverPeakRssMb() const; // 本地 llama-server 的峰值常驻内存（Linux VmHWM）；不可得时为 -1
+    void runNext();
+    void finishTask();
+    QJsonObject report() const;
+    void writeReport();
+    void fail(const QString &message);
+
+    Options options_;
+    APIS apis_;
+    xNet *net_ = nullptr;
+    QPointer<QProcess> server_;
+    QNetworkAccessManager *nam_ = nullptr; // 仅用于探测 /health
+    QTimer healthTimer_;
+    QElapsedTimer healthClock_;
+    QTimer requestTimer_;
+    QHash<QString, QString> words_;
+
+    QVector<Task> plan_;
+    int cursor_ = -1;
+    QVector<Result> results_;
+    Result current_;
+    QString raw_;
+    QElapsedTimer clock_;
+    bool inFlight_ = false;
+    bool stopping_ = false; // 主动截断（首包即停 / 超时）后不再把状态当作错误
+    bool done_ = false;
+    double serverPeakRssMb_ = -1.0;
+};
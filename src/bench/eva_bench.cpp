@@ -0,0 +1,76 @@
+// eva-bench: headless runner for the model evaluation suites
+// 用法示例：
+//   eva-bench --endpoint http://127.0.0.1:8080 --repeat 5 --out bench.json
+//   eva-bench --gguf models/qwen.gguf --backend cuda --suites latency,gen --tag $(git rev-parse --short HEAD)
+//   eva-bench --gguf models/qwen.gguf --ctx 32768 --cache-type q8_0 --suites gen --out q8.json   # 对比 KV 内存与 tok/s
+#include "bench_runner.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTimer>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("eva-bench"));
+    qRegisterMetaType<APIS>("APIS");
+    qRegisterMetaType<ENDPOINT_DATA>("ENDPOINT_DATA");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Run the EVA evaluation suites headlessly and emit a JSON report."));
+    parser.addHelpOption();
+    const QCommandLineOption endpointOpt(QStringLiteral("endpoint"), QStringLiteral("OpenAI-compatible endpoint (scheme://host:port)."), QStringLiteral("url"));
+    const QCommandLineOption keyOpt(QStringLiteral("key"), QStringLiteral("API key."), QStringLiteral("key"));
+    const QCommandLineOption modelOpt(QStringLiteral("model"), QStringLiteral("Model name sent to the endpoint."), QStringLiteral("name"), QStringLiteral("default"));
+    const QCommandLineOption ggufOpt(QStringLiteral("gguf"), QStringLiteral("Local GGUF model; launches llama-server instead of using --endpoint."), QStringLiteral("path"));
+    const QCommandLineOption serverOpt(QStringLiteral("server"), QStringLiteral("llama-server executable (default: resolved from EVA_BACKEND)."), QStringLiteral("path"));
+    const QCommandLineOption backendOpt(QStringLiteral("backend"), QStringLiteral("Backend for the local server: auto, cpu, cuda, vulkan, opencl."), QStringLiteral("name"));
+    const QCommandLineOption portOpt(QStringLiteral("port"), QStringLiteral("Port for the local server."), QStringLiteral("port"), QStringLiteral(DEFAULT_BENCH_SERVER_PORT));
+    const QCommandLineOption ctxOpt(QStringLiteral("ctx"), QStringLiteral("Context length for the local server."), QStringLiteral("n"), QString::number(DEFAULT_NCTX));
+    const QCommandLineOption nglOpt(QStringLiteral("ngl"), QStringLiteral("GPU layers for the local server."), QStringLiteral("n"), QString::number(DEFAULT_BENCH_NGL));
+    const QCommandLineOption cacheTypeOpt(QStringLiteral("cache-type"), QStringLiteral("KV cache type for K and V on the local server: f16, q8_0, q4_0."), QStringLiteral("type"), QStringLiteral(DEFAULT_CACHE_TYPE));
+    const QCommandLineOption cacheReuseOpt(QStringLiteral("cache-reuse"), QStringLiteral("Prompt cache reuse chunk size for the local server (0 = off)."), QStringLiteral("n"), QString::number(DEFAULT_CACHE_REUSE));
+    const QCommandLineOption contextShiftOpt(QStringLiteral("context-shift"), QStringLiteral("Enable context shifting on the local server."));
+    const QCommandLineOption suitesOpt(QStringLiteral("suites"), QStringLiteral("Comma separated suites: %1.").arg(BenchRunner::knownSuites().join(QLatin1Char(','))), QStringLiteral("list"));
+    const QCommandLineOption repeatOpt(QStringLiteral("repeat"), QStringLiteral("Measured rounds per suite."), QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption warmupOpt(QStringLiteral("warmup"), QStringLiteral("Unrecorded warmup requests before measuring."), QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption langOpt(QStringLiteral("lang"), QStringLiteral("Question language: en, zh, ja."), QStringLiteral("code"), QStringLiteral("en"));
+    const QCommandLineOption timeoutOpt(QStringLiteral("timeout"), QStringLiteral("Per-request timeout in seconds."), QStringLiteral("s"), QString::number(DEFAULT_BENCH_REQUEST_TIMEOUT_MS / 1000));
+    const QCommandLineOption outOpt(QStringLiteral("out"), QStringLiteral("Write the JSON report to this file instead of stdout."), QStringLiteral("path"));
+    const QCommandLineOption tagOpt(QStringLiteral("tag"), QStringLiteral("Free-form label stored in the report (commit, build id)."), QStringLiteral("text"));
+    parser.addOptions({endpointOpt, keyOpt, modelOpt, ggufOpt, serverOpt, backendOpt, portOpt, ctxOpt, nglOpt, cacheTypeOpt, cacheReuseOpt, contextShiftOpt, suitesOpt, repeatOpt, warmupOpt, langOpt, timeoutOpt, outOpt, tagOpt});
+    parser.process(app);
+
+    BenchRunner::Options options;
+    options.endpoint = parser.value(endpointOpt).trimmed();
+    while (options.endpoint.endsWith(QLatin1Char('/'))) options.endpoint.chop(1);
+    options.apiKey = parser.value(keyOpt);
+    options.model = parser.value(modelOpt);
+    options.gguf = parser.value(ggufOpt);
+    options.serverProgram = parser.value(serverOpt);
+    options.backend = parser.value(backendOpt).trimmed().toLower();
+    options.port = parser.value(portOpt);
+    options.nctx = qMax(256, parser.value(ctxOpt).toInt());
+    options.ngl = qMax(0, parser.value(nglOpt).toInt());
+    options.cacheType = parser.value(cacheTypeOpt).trimmed().toLower();
+    options.cacheReuse = qMax(0, parser.value(cacheReuseOpt).toInt());
+    options.contextShift = parser.isSet(contextShiftOpt);
+    for (const QString &suite : parser.value(suitesOpt).split(QLatin1Char(','), Qt::SkipEmptyParts)) options.suites << suite.trimmed().toLower();
+    options.repeat = qMax(1, parser.value(repeatOpt).toInt());
+    options.warmup = qMax(0, parser.value(warmupOpt).toInt());
+    options.language = evaLanguageFlagFromCode(parser.value(langOpt));
+    options.requestTimeoutMs = qMax(1, parser.value(timeoutOpt).toInt()) * 1000;
+    options.outPath = parser.value(outOpt);
+    options.tag = parser.value(tagOpt);
+
+    if (options.gguf.isEmpty() && options.endpoint.isEmpty())
+    {
+        fputs("eva-bench: either --endpoint or --gguf is required\n", stderr);
+        parser.showHelp(1);
+    }
+
+    BenchRunner runner(options);
+    QObject::connect(&runner, &BenchRunner::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+    QTimer::singleShot(0, &runner, &BenchRunner::start);
+    return app.exec();
+}
@@ -0,0 +1,109 @@
+#include "core/replay/agent_replay.h"
+
+#include <QJsonArray>
+#include <QTimer>
+
+AgentReplay::AgentReplay(const AgentTape &tape, QObject *parent)
+    : QObject(parent), tape_(tape)
+{
+    connect(&profiler_, &AgentStageProfiler::turnFinished, this, &AgentReplay::onTurnFinished);
+}
+
+void AgentReplay::setIdleTimeoutMs(int idleMs)
+{
+    idleTimeoutMs_ = qMax(1, idleMs);
+    if (watchdog_ && watchdog_->isActive()) watchdog_->start(idleTimeoutMs_);
+}
+
+void AgentReplay::armWatchdog()
+{
+    if (done_) return;
+    if (!watchdog_)
+    {
+        watchdog_ = new QTimer(this);
+        watchdog_->setSingleShot(true);
+        connect(watchdog_, &QTimer::timeout, this, &AgentReplay::onStalled);
+    }
+    watchdog_->start(idleTimeoutMs_);
+}
+
+void AgentReplay::send(const RequestSnapshot &snapshot)
+{
+    Q_UNUSED(snapshot);
+    armWatchdog();
+    if (modelCursor_ >= tape_.model.size())
+    {
+        divergences_ << QStringLiteral("request %1 has no recorded model turn").arg(modelCursor_ + 1);
+        ++modelCursor_;
+        emit net2ui_pushover();
+        return;
+    }
+    const AgentTape::ModelTurn &turn = tape_.model.at(modelCursor_++);
+    for (const QString &chunk : turn.chunks) emit net2ui_output(chunk, true);
+    if (!turn.toolCalls.isEmpty()) emit net2ui_tool_calls(turn.toolCalls);
+    emit net2ui_pushover();
+}
+
+void AgentReplay::stop(bool stop)
+{
+    // 回放的输出在 send 里一次发完，没有在途请求可停
+    Q_UNUSED(stop);
+}
+
+void AgentReplay::exec(mcp::json call)
+{
+    armWatchdog();
+    const QString name = QString::fromStdString(call.value("name", std::string()));
+    QString result;
+    if (toolCursor_ < tape_.tools.size() && tape_.tools.at(toolCursor_).name == name)
+    {
+        result = tape_.tools.at(toolCursor_).result;
+    }
+    else
+    {
+        const QString expected = toolCursor_ < tape_.tools.size() ? tape_.tools.at(toolCursor_).name : QStringLiteral("<none>");
+        divergences_ << QStringLiteral("tool call %1: got %2, recorded %3").arg(toolCursor_ + 1).arg(name, expected);
+        result = QStringLiteral("replay: no recorded result for %1").arg(name);
+    }
+    ++toolCursor_;
+    emit tool2ui_pushover(result);
+}
+
+void AgentReplay::onTurnFinished()
+{
+    if (done_) return;
+    done_ = true;
+    if (watchdog_) watchdog_->stop();
+    if (modelCursor_ < tape_.model.size()) divergences_ << QStringLiteral("%1 recorded model turns were not replayed").arg(tape_.model.size() - modelCursor_);
+    if (toolCursor_ < tape_.tools.size()) divergences_ << QStringLiteral("%1 recorded tool results were not replayed").arg(tape_.tools.size() - toolCursor_);
+    // 让 Widget 先走完本轮收尾（Finish 标记在 normal_finish_pushover 末尾打出）
+    QTimer::singleShot(0, this, &AgentReplay::finished);
+}
+
+void AgentReplay::onStalled()
+{
+    // 某些收尾路径（如工具流提前返回）没有打出 Finish 标记：不再等待，报告卡在哪一回合哪一段
+    if (done_) return;
+    done_ = true;
+    const QString stage = profiler_.stage();
+    stallReason_ = QStringLiteral("turn %1 stalled%2: no activity or Finish for %3 ms (model turns %4/%5, tool steps %6/%7)")
+                        .arg(profiler_.turns() + 1)
+                        .arg(stage.isEmpty() ? QString() : QStringLiteral(" in %1").arg(stage))
+                        .arg(idleTimeoutMs_)
+                        .arg(modelCursor_)
+                        .arg(tape_.model.size())
+                        .arg(toolCursor_)
+                        .arg(tape_.tools.size());
+    divergences_ << stallReason_;
+    emit finished();
+}
+
+QJsonObject AgentReplay::report() const
+{
+    QJsonObject out = profiler_.report();
+    out.insert(QStringLiteral("model_turns"), QJsonObject{{QStringLiteral("recorded"), tape_.model.size()}, {QStringLiteral("replayed"), modelCursor_}});
+    out.insert(QStringLiteral("tool_steps"), QJsonObject{{QStringLiteral("recorded"), tape_.tools.size()}, {QStringLiteral("replayed"), toolCursor_}});
+    out.insert(QStringLiteral("divergences"), QJsonArray::fromStringList(divergences_));
+    out.insert(QStringLiteral("stalled"), stalled());
+    return out;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QColor>
+#include <QJsonObject>
+#include <QObject>
+#include <QStringList>
+
+class QTimer;
+
+#include "core/replay/agent_stage_profiler.h"
+#include "core/replay/agent_tape.h"
+
+// 回放驱动：顶替 NetClient 与 xTool，按录像零延迟地回灌模型输出与工具结果，
+// 让 SessionController / ToolFlowController 走与真实会话相同的路径，再由 AgentStageProfiler 给出分段开销。
+// 信号与 NetClient/xTool 同名同参，main 里按原样（排队）连到 Widget。
+class AgentReplay : public QObject
+{
+    Q_OBJECT
+  public:
+    explicit AgentReplay(const AgentTape &tape, QObject *parent = nullptr);
+
+    const AgentTape &tape() const { return tape_; }
+    AgentStageProfiler *profiler() { return &profiler_; }
+    // 分段开销 + 录像消耗情况 + 偏离记录（EVA 的行为与录制时不一致，例如少调/多调了工具）
+    QJsonObject report() const;
+    bool diverged() const { return !divergences_.isEmpty(); }
+    // 看门狗：两次活动（请求/工具调用）之间超过 idleMs 仍未收尾时记下卡住的回合并发出 finished
+    void setIdleTimeoutMs(int idleMs);
+    void armWatchdog();
+    bool stalled() const { return !stallReason_.isEmpty(); }
+    QString stallReason() const { return stallReason_; }
+
+  public slots:
+    void send(const RequestSnapshot &snapshot);
+    void stop(bool stop);
+    void exec(mcp::json call);
+
+  signals:
+    void net2ui_output(const QString &result, bool is_while = 1, QColor color = QColor(0, 0, 0));
+    void net2ui_tool_calls(const QString &payload);
+    void net2ui_pushover();
+    void tool2ui_pushover(QString result);
+    void finished();
+
+  private:
+    void onTurnFinished();
+    void onStalled();
+
+    AgentTape tape_;
+    AgentStageProfiler profiler_;
+    int modelCursor_ = 0;
+    int toolCursor_ = 0;
+    QStringList divergences_;
+    QTimer *watchdog_ = nullptr;
+    int idleTimeoutMs_ = DEFAULT_AGENT_REPLAY_IDLE_TIMEOUT_MS;
+    QString stallReason_;
+    bool done_ = false;
+};
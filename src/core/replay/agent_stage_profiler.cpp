@@ -0,0 +1,98 @@
+#include "core/replay/agent_stage_profiler.h"
+
+#include "expend/eval_suite.h"
+
+#include <QStringList>
+
+namespace
+{
+const QStringList &stageNames()
+{
+    static const QStringList names{QStringLiteral("build"), QStringLiteral("net"), QStringLiteral("parse"), QStringLiteral("tool")};
+    return names;
+}
+
+QJsonObject summaryJson(const QVector<double> &samples)
+{
+    const EvalSuite::Summary s = EvalSuite::summarize(samples);
+    double total = 0.0;
+    for (double v : samples) total += v;
+    return QJsonObject{{QStringLiteral("count"), s.count}, {QStringLiteral("total"), total}, {QStringLiteral("mean"), s.mean}, {QStringLiteral("p50"), s.p50}, {QStringLiteral("p90"), s.p90}, {QStringLiteral("max"), s.max}};
+}
+} // namespace
+
+AgentStageProfiler::AgentStageProfiler(QObject *parent)
+    : QObject(parent)
+{
+    clock_.start();
+}
+
+void AgentStageProfiler::mark(FlowPhase phase)
+{
+    markAt(phase, clock_.nsecsElapsed() / 1e6);
+}
+
+void AgentStageProfiler::markAt(FlowPhase phase, double ms)
+{
+    switch (phase)
+    {
+    case FlowPhase::Start:
+        // 工具续轮也会再打一次 Start：回合已开着时只保证处于 build 段
+        if (!open_)
+        {
+            open_ = true;
+            turnStartMs_ = ms;
+            openStage(QStringLiteral("build"), ms);
+        }
+        else if (stage_ != QLatin1String("build"))
+        {
+            openStage(QStringLiteral("build"), ms);
+        }
+        break;
+    case FlowPhase::NetRequest:
+        if (open_) openStage(QStringLiteral("net"), ms);
+        break;
+    case FlowPhase::NetDone:
+        if (open_) openStage(QStringLiteral("parse"), ms);
+        break;
+    case FlowPhase::ToolStart:
+        if (open_) openStage(QStringLiteral("tool"), ms);
+        break;
+    case FlowPhase::ToolResult:
+        if (open_) openStage(QStringLiteral("build"), ms);
+        break;
+    case FlowPhase::Finish:
+        if (!open_) break;
+        closeStage(ms);
+        open_ = false;
+        turnMs_.append(ms - turnStartMs_);
+        emit turnFinished();
+        break;
+    case FlowPhase::Cancel:
+        open_ = false;
+        stage_.clear();
+        break;
+    default:
+        break;
+    }
+}
+
+void AgentStageProfiler::closeStage(double ms)
+{
+    if (!stage_.isEmpty()) stages_[stage_].append(qMax(0.0, ms - stageStartMs_));
+    stage_.clear();
+}
+
+void AgentStageProfiler::openStage(const QString &stage, double ms)
+{
+    closeStage(ms);
+    stage_ = stage;
+    stageStartMs_ = ms;
+}
+
+QJsonObject AgentStageProfiler::report() const
+{
+    QJsonObject stages;
+    for (const QString &name : stageNames()) stages.insert(name, summaryJson(stages_.value(name)));
+    return QJsonObject{{QStringLiteral("turns"), turnMs_.size()}, {QStringLiteral("turn_ms"), summaryJson(turnMs_)}, {QStringLiteral("stages"), stages}};
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QVector>
+
+#include "core/session/session_types.h"
+
+// 智能体回合分段计时：由 Widget::logFlow 的阶段标记驱动，把一次回合切成
+// build（组请求体，含工具结果回注后的重新组装）→ net（发出到 pushover）→ parse（解析输出/工具调用）
+// → tool（工具执行）→ build ... → 回合结束。回放时模型与工具耗时为零，各段即 EVA 自身的开销。
+class AgentStageProfiler : public QObject
+{
+    Q_OBJECT
+  public:
+    explicit AgentStageProfiler(QObject *parent = nullptr);
+
+    void mark(FlowPhase phase);
+    // 测试用：显式传入时间戳（毫秒）
+    void markAt(FlowPhase phase, double ms);
+
+    int turns() const { return turnMs_.size(); }
+    // 当前回合是否已开始但尚未结束，以及所处的阶段（未开始时为空）
+    bool turnOpen() const { return open_; }
+    QString stage() const { return open_ ? stage_ : QString(); }
+    QVector<double> samples(const QString &stage) const { return stages_.value(stage); }
+    // {"turns":N,"turn_ms":{...},"stages":{"build":{...},"net":{...},"parse":{...},"tool":{...}}}
+    QJsonObject report() const;
+
+  signals:
+    void turnFinished();
+
+  private:
+    void closeStage(double ms);
+    void openStage(const QString &stage, double ms);
+
+    QElapsedTimer clock_;
+    bool open_ = false;
+    double turnStartMs_ = 0.0;
+    QString stage_;
+    double stageStartMs_ = 0.0;
+    QHash<QString, QVector<double>> stages_;
+    QVector<double> turnMs_;
+};
@@ -0,0 +1,141 @@
+#include "core/replay/agent_tape.h"
+
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace
+{
+QString messageText(const QJsonObject &message)
+{
+    const QJsonValue content = message.value(QStringLiteral("content"));
+    if (content.isString()) return content.toString();
+    QString text;
+    for (const QJsonValue &part : content.toArray())
+    {
+        const QJsonObject obj = part.toObject();
+        if (obj.value(QStringLiteral("type")).toString() == QLatin1String("text")) text += obj.value(QStringLiteral("text")).toString();
+    }
+    return text;
+}
+} // namespace
+
+bool AgentTape::load(const QString &path, AgentTape *out, QString *error)
+{
+    auto fail = [error](const QString &message)
+    {
+        if (error) *error = message;
+        return false;
+    };
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return fail(QStringLiteral("cannot open %1: %2").arg(path, file.errorString()));
+
+    AgentTape tape;
+    int lineNo = 0;
+    while (!file.atEnd())
+    {
+        ++lineNo;
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) continue;
+        QJsonParseError err{};
+        const QJsonObject event = QJsonDocument::fromJson(line, &err).object();
+        if (err.error != QJsonParseError::NoError) return fail(QStringLiteral("line %1: %2").arg(lineNo).arg(err.errorString()));
+
+        const QString type = event.value(QStringLiteral("type")).toString();
+        if (type == QLatin1String("session"))
+        {
+            tape.prompt = event.value(QStringLiteral("prompt")).toString();
+            tape.toolCallMode = event.value(QStringLiteral("tool_call_mode")).toInt(DEFAULT_TOOL_CALL_MODE);
+        }
+        else if (type == QLatin1String("model"))
+        {
+            ModelTurn turn;
+            for (const QJsonValue &chunk : event.value(QStringLiteral("chunks")).toArray()) turn.chunks << chunk.toString();
+            turn.toolCalls = event.value(QStringLiteral("tool_calls")).toString();
+            tape.model.append(turn);
+        }
+        else if (type == QLatin1String("tool"))
+        {
+            tape.tools.append({event.value(QStringLiteral("name")).toString(), event.value(QStringLiteral("arguments")).toObject(), event.value(QStringLiteral("result")).toString()});
+        }
+        else
+        {
+            return fail(QStringLiteral("line %1: unknown event type '%2'").arg(lineNo).arg(type));
+        }
+    }
+    if (tape.model.isEmpty()) return fail(QStringLiteral("%1 has no model turns").arg(path));
+    if (out) *out = tape;
+    return true;
+}
+
+AgentTapeRecorder::AgentTapeRecorder(const QString &path, QObject *parent)
+    : QObject(parent), file_(path)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    file_.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+void AgentTapeRecorder::recordSend(const RequestSnapshot &snapshot)
+{
+    if (!sessionWritten_)
+    {
+        // 首个请求里最后一条 user 消息即本次会话的输入；回放时由 EVA 自己重新组织系统提示与工具清单
+        QString prompt;
+        const QJsonArray messages = snapshot.endpoint.messagesArray;
+        for (int i = messages.size() - 1; i >= 0; --i)
+        {
+            const QJsonObject message = messages.at(i).toObject();
+            if (message.value(QStringLiteral("role")).toString() != QLatin1String(DEFAULT_USER_NAME)) continue;
+            prompt = messageText(message);
+            break;
+        }
+        writeLine(QJsonObject{{QStringLiteral("type"), QStringLiteral("session")}, {QStringLiteral("prompt"), prompt}, {QStringLiteral("tool_call_mode"), snapshot.endpoint.tool_call_mode}});
+        sessionWritten_ = true;
+    }
+    inTurn_ = true;
+    turn_ = AgentTape::ModelTurn();
+}
+
+void AgentTapeRecorder::recordOutput(const QString &chunk, bool streaming, QColor color)
+{
+    Q_UNUSED(streaming);
+    Q_UNUSED(color);
+    if (inTurn_ && !chunk.isEmpty()) turn_.chunks << chunk;
+}
+
+void AgentTapeRecorder::recordToolCalls(const QString &payload)
+{
+    if (inTurn_) turn_.toolCalls = payload;
+}
+
+void AgentTapeRecorder::recordPushover()
+{
+    if (!inTurn_) return;
+    inTurn_ = false;
+    writeLine(QJsonObject{{QStringLiteral("type"), QStringLiteral("model")}, {QStringLiteral("chunks"), QJsonArray::fromStringList(turn_.chunks)}, {QStringLiteral("tool_calls"), turn_.toolCalls}});
+}
+
+void AgentTapeRecorder::recordToolExec(const mcp::json &call)
+{
+    pendingTool_ = AgentTape::ToolStep();
+    pendingTool_.name = QString::fromStdString(call.value("name", std::string()));
+    if (call.contains("arguments") && call["arguments"].is_object())
+    {
+        pendingTool_.arguments = QJsonDocument::fromJson(QByteArray::fromStdString(call["arguments"].dump())).object();
+    }
+}
+
+void AgentTapeRecorder::recordToolResult(const QString &result)
+{
+    if (pendingTool_.name.isEmpty()) return;
+    writeLine(QJsonObject{{QStringLiteral("type"), QStringLiteral("tool")}, {QStringLiteral("name"), pendingTool_.name}, {QStringLiteral("arguments"), pendingTool_.arguments}, {QStringLiteral("result"), result}});
+    pendingTool_ = AgentTape::ToolStep();
+}
+
+void AgentTapeRecorder::writeLine(const QJsonObject &event)
+{
+    if (!file_.isOpen()) return;
+    file_.write(QJsonDocument(event).toJson(QJsonDocument::Compact) + '\n');
+    file_.flush();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QColor>
+#include <QFile>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "mcp_json.h"
+#include "service/net/request_snapshot.h"
+
+// 智能体回合录像：按顺序记下一次真实会话里模型的流式输出与工具结果，供回放时替代网络与工具执行。
+// 文件为 JSONL，每行一个事件：
+//   {"type":"session","prompt":"...","tool_call_mode":0}
+//   {"type":"model","chunks":["..."],"tool_calls":"..."}   一次请求的流式输出与 function_call 负载
+//   {"type":"tool","name":"...","arguments":{...},"result":"..."}
+struct AgentTape
+{
+    struct ModelTurn
+    {
+        QStringList chunks;
+        QString toolCalls;
+    };
+    struct ToolStep
+    {
+        QString name;
+        QJsonObject arguments;
+        QString result;
+    };
+
+    QString prompt;
+    int toolCallMode = DEFAULT_TOOL_CALL_MODE;
+    QVector<ModelTurn> model;
+    QVector<ToolStep> tools;
+
+    static bool load(const QString &path, AgentTape *out, QString *error = nullptr);
+};
+
+// 录制器：被动挂在 UI 与 NetClient/xTool 之间的信号上，边录边写（进程中途退出也能留下已完成的部分）
+class AgentTapeRecorder : public QObject
+{
+    Q_OBJECT
+  public:
+    explicit AgentTapeRecorder(const QString &path, QObject *parent = nullptr);
+
+    bool isOpen() const { return file_.isOpen(); }
+    QString errorString() const { return file_.errorString(); }
+
+  public slots:
+    void recordSend(const RequestSnapshot &snapshot);
+    void recordOutput(const QString &chunk, bool streaming = true, QColor color = QColor());
+    void recordToolCalls(const QString &payload);
+    void recordPushover();
+    void recordToolExec(const mcp::json &call);
+    void recordToolResult(const QString &result);
+
+  private:
+    void writeLine(const QJsonObject &event);
+
+    QFile file_;
+    bool sessionWritten_ = false;
+    bool inTurn_ = false;
+    AgentTape::ModelTurn turn_;
+    AgentTape::ToolStep pendingTool_;
+};
@@ -38,7 +38,7 @@ QString joinAttachmentNames(const QStringList &paths, int maxCount)
 }
 
 SessionController::SessionController(Widget *owner)
-    : QObject(owner), w_(owner)
+    : QObject(owner), w_(owner), tokenCounter_(new TokenCounter(this))
 {
 }
 
@@ -182,11 +182,15 @@ void SessionController::collectUserInputs(InputPack &pack, bool attachController
     ui->input->clearThumbnails();
 }
 
-void SessionController::handleChatReply(ENDPOINT_DATA &data, const InputPack &in)
+void SessionController::handleChatReply(ENDPOINT_DATA &data, const InputPack &input)
 {
     w_->markBackendActivity();
     w_->cancelLazyUnload(QStringLiteral("handle chat reply"));
 
+    // 发送前按预算裁剪：可能截断待追加的工具结果、丢弃放不下的文档
+    InputPack in = input;
+    applyPromptBudget(in);
+
     // 记录本轮用户输入对应的第一条消息索引，便于记录条锚点定位
     int firstUserMsgIndex = -1;
     const auto markUserIndex = [&](int idx) {
@@ -406,6 +410,10 @@ void SessionController::handleToolLoop(ENDPOINT_DATA &data)
     w_->markBackendActivity();
     w_->cancelLazyUnload(QStringLiteral("handle tool loop"));
 
+    // 工具循环中不做压缩，超出预算时只截断本次工具结果
+    InputPack noInput;
+    applyPromptBudget(noInput);
+
     // 插入 tool 结果作为 tool 消息（文本模式下会在 net 层兼容为 user 前缀）
     QJsonObject toolMessage;
     toolMessage.insert("role", QStringLiteral("tool"));
@@ -484,6 +492,8 @@ void SessionController::finishTurnFlow(const QString &reason, bool success)
     w_->logFlow(FlowPhase::Finish, detail, success ? SIGNAL_SIGNAL : WRONG_SIGNAL);
     w_->turnActive_ = false;
     w_->activeTurnId_ = 0;
+    // 回合结束：把后台攒批的历史写入提交并刷到磁盘；在写入线程上完成，UI 线程不等待 fsync
+    if (w_->history_) w_->history_->flushAsync(true);
 }
 
 void SessionController::ensureSystemHeader(const QString &systemText)
@@ -521,7 +531,7 @@ void SessionController::ensureSystemHeader(const QString &systemText)
     w_->engineerProxyRuntime_.active = engineerProxyWasActive;
 }
 
-bool SessionController::shouldTriggerCompaction() const
+bool SessionController::compactionAllowed() const
 {
     if (!w_->compactionSettings_.enabled)
         return false;
@@ -533,6 +543,13 @@ bool SessionController::shouldTriggerCompaction() const
         return false;
     if (w_->ui_messagesArray.isEmpty())
         return false;
+    return true;
+}
+
+bool SessionController::shouldTriggerCompaction() const
+{
+    if (!compactionAllowed())
+        return false;
 
     const int cap = w_->resolvedContextLimitForUi();
     if (cap <= 0)
@@ -551,16 +568,148 @@ bool SessionController::shouldTriggerCompaction() const
 
 bool SessionController::startCompactionIfNeeded(const InputPack &pendingInput)
 {
-    if (!shouldTriggerCompaction())
+    QString reason;
+    if (shouldTriggerCompaction())
+    {
+        reason = QStringLiteral("auto kvUsed=%1 cap=%2").arg(w_->kvUsed_).arg(w_->resolvedContextLimitForUi());
+    }
+    else if (compactionAllowed())
+    {
+        // kvUsed_ 只反映上一轮；本轮附带的大文档/长输入要在发送前算进去
+        const TokenBudget::Plan plan = planPromptBudget(pendingInput, w_->tool_result, true);
+        if (!plan.compact)
+            return false;
+        w_->logFlow(FlowPhase::Build, plan.describe());
+        reason = QStringLiteral("preflight %1/%2").arg(plan.sections.total()).arg(plan.cap);
+    }
+    else
+    {
         return false;
+    }
     w_->compactionPendingInput_ = pendingInput;
     w_->compactionPendingHasInput_ = true;
     w_->compactionQueued_ = true;
-    const int cap = w_->resolvedContextLimitForUi();
-    w_->compactionReason_ = QStringLiteral("auto kvUsed=%1 cap=%2").arg(w_->kvUsed_).arg(cap);
+    w_->compactionReason_ = reason;
     return true;
 }
 
+void SessionController::refreshTokenizerEndpoint()
+{
+    // 只有本地 llama-server 保证提供 /tokenize；远端 API 走启发式估算
+    QUrl url;
+    if (w_->ui_mode == LOCAL_MODE && w_->backendOnline_)
+    {
+        url = QUrl(w_->formatLocalEndpoint(w_->activeServerHost_, w_->activeServerPort_));
+        url.setPath(QStringLiteral(DEFAULT_BUDGET_TOKENIZE_API));
+    }
+    tokenCounter_->setEndpoint(url, w_->ui_SETTINGS.modelpath);
+}
+
+void SessionController::resetTokenizerBackoff()
+{
+    tokenCounter_->resetBackoff();
+}
+
+int SessionController::countMessageTokens(const QJsonObject &msg)
+{
+    int tokens = DEFAULT_BUDGET_MESSAGE_OVERHEAD;
+    const QJsonValue contentVal = msg.value(QStringLiteral("content"));
+    if (contentVal.isString())
+    {
+        tokens += tokenCounter_->count(contentVal.toString());
+    }
+    else if (contentVal.isArray())
+    {
+        for (const QJsonValue &pv : contentVal.toArray())
+        {
+            const QJsonObject po = pv.toObject();
+            const QString type = po.value(QStringLiteral("type")).toString();
+            if (type == QLatin1String("text"))
+                tokens += tokenCounter_->count(po.value(QStringLiteral("text")).toString());
+            else if (!type.isEmpty())
+                tokens += DEFAULT_BUDGET_MEDIA_TOKENS; // image_url/audio_url 等：不能把 base64 当文本计
+        }
+    }
+    const QJsonValue toolCalls = msg.value(QStringLiteral("tool_calls"));
+    if (toolCalls.isArray())
+        tokens += tokenCounter_->count(QString::fromUtf8(QJsonDocument(toolCalls.toArray()).toJson(QJsonDocument::Compact)));
+    return tokens;
+}
+
+TokenBudget::Plan SessionController::planPromptBudget(const InputPack &pending, const QString &toolOutput, bool allowCompaction)
+{
+    refreshTokenizerEndpoint();
+
+    TokenBudget::Sections sections;
+    sections.system = tokenCounter_->count(w_->ui_DATES.date_prompt) + DEFAULT_BUDGET_MESSAGE_OVERHEAD;
+    if (w_->ui_tool_call_mode == TOOL_CALL_FUNCTION)
+        sections.tools = tokenCounter_->count(QString::fromUtf8(QJsonDocument(w_->buildFunctionTools()).toJson(QJsonDocument::Compact)));
+
+    // 历史：与 startCompactionRun 相同的范围划分，统计可被摘要替换的部分
+    int startIdx = 0;
+    const int total = w_->ui_messagesArray.size();
+    if (total > 0 && w_->ui_messagesArray.first().toObject().value(QStringLiteral("role")).toString() == QStringLiteral(DEFAULT_SYSTEM_NAME))
+        startIdx = 1;
+    const int compactTo = total - qMax(1, w_->compactionSettings_.keep_last_messages);
+    int compactable = 0;
+    for (int i = startIdx; i < total; ++i)
+    {
+        const int tokens = countMessageTokens(w_->ui_messagesArray.at(i).toObject());
+        sections.history += tokens;
+        if (i < compactTo) compactable += tokens;
+    }
+    if (!pending.text.isEmpty())
+        sections.history += tokenCounter_->count(pending.text) + DEFAULT_BUDGET_MESSAGE_OVERHEAD;
+
+    int documentTokens = 0;
+    for (const DocumentAttachment &doc : pending.documents)
+    {
+        if (!doc.markdown.isEmpty()) documentTokens += tokenCounter_->count(formatDocumentPayload(doc));
+    }
+    sections.attachments = documentTokens + (pending.images.size() + pending.wavs.size()) * DEFAULT_BUDGET_MEDIA_TOKENS;
+    if (!toolOutput.isEmpty())
+        sections.toolOutput = tokenCounter_->count(toolOutput) + DEFAULT_BUDGET_MESSAGE_OVERHEAD;
+
+    TokenBudget::Limits limits;
+    limits.contextCap = w_->resolvedContextLimitForUi();
+    const int nPredict = w_->ui_SETTINGS.hid_npredict > 0 ? w_->ui_SETTINGS.hid_npredict : DEFAULT_BUDGET_OUTPUT_RESERVE;
+    limits.reserveOutput = qMin(nPredict, qMax(0, limits.contextCap / 4));
+    limits.triggerRatio = w_->compactionSettings_.trigger_ratio;
+    limits.reserveTokens = w_->compactionSettings_.reserve_tokens;
+    limits.canCompact = allowCompaction;
+    limits.compactableHistory = compactable;
+    // 摘要按字符上限估算（中英混合约 1 token/字符，偏保守）
+    limits.summaryTokens = w_->compactionSettings_.max_summary_chars;
+    limits.droppableAttachments = documentTokens;
+    limits.minToolOutput = DEFAULT_BUDGET_TOOL_OUTPUT_MIN;
+    return TokenBudget::plan(sections, limits);
+}
+
+void SessionController::applyPromptBudget(InputPack &pending)
+{
+    const TokenBudget::Plan plan = planPromptBudget(pending, w_->tool_result, false);
+    w_->logFlow(FlowPhase::Build, plan.describe());
+    // 接近上限或需要裁剪时才在状态区展示分节预算，平时只进 flow 日志
+    const bool nearLimit = plan.cap > 0 && plan.sections.total() > plan.softLimit;
+    if (nearLimit)
+        w_->reflash_state(QStringLiteral("ui:") + plan.describe(), plan.fits() ? USUAL_SIGNAL : WRONG_SIGNAL);
+
+    if (plan.toolOutputKeep >= 0 && !w_->tool_result.isEmpty())
+    {
+        const int before = w_->tool_result.size();
+        w_->tool_result = TokenBudget::truncateMiddle(w_->tool_result, plan.sections.toolOutput, plan.toolOutputKeep);
+        w_->reflash_state(QStringLiteral("ui:工具结果超出上下文预算，已截断 %1 -> %2 字符").arg(before).arg(w_->tool_result.size()), WRONG_SIGNAL);
+    }
+    if (plan.dropAttachments && !pending.documents.isEmpty())
+    {
+        const QString names = describeDocumentList(pending.documents);
+        pending.documents.clear();
+        const QString note = QStringLiteral("[Attached documents omitted because they do not fit in the context window: %1]").arg(names);
+        pending.text = pending.text.isEmpty() ? note : pending.text + QStringLiteral("\n\n") + note;
+        w_->reflash_state(QStringLiteral("ui:文档附件超出上下文预算，已移除 -> ") + names, WRONG_SIGNAL);
+    }
+}
+
 void SessionController::startCompactionRun(const QString &reason)
 {
     if (w_->compactionInFlight_)
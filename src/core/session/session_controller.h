@@ -4,6 +4,7 @@
 #include <QString>
 
 #include "core/session/session_types.h"
+#include "core/session/token_budget.h"
 #include "xconfig.h"
 
 class Widget;
@@ -45,6 +46,17 @@ public:
     void handleCompactionReply(const QString &summaryText, const QString &reasoningText);
     void resumeSendAfterCompaction();
 
+    // 发送前 token 预算：按节统计本次请求的 token，决定压缩/截断工具输出/丢弃文档
+    TokenBudget::Plan planPromptBudget(const InputPack &pending, const QString &toolOutput, bool allowCompaction);
+    void applyPromptBudget(InputPack &pending);
+    // 后端（重新）就绪：分词端点此前的失败不再作数
+    void resetTokenizerBackoff();
+
 private:
+    bool compactionAllowed() const;
+    void refreshTokenizerEndpoint();
+    int countMessageTokens(const QJsonObject &msg);
+
     Widget *w_ = nullptr; // 不拥有，仅用于访问 UI 与状态
+    TokenCounter *tokenCounter_ = nullptr;
 };
@@ -0,0 +1,185 @@
+#include "core/session/token_budget.h"
+
+#include "xconfig.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QStringList>
+
+#include <algorithm>
+
+namespace
+{
+QString kTokens(int tokens)
+{
+    if (tokens >= 1000) return QString::number(tokens / 1000.0, 'f', 1) + QStringLiteral("k");
+    return QString::number(tokens);
+}
+} // namespace
+
+int TokenBudget::estimateTokens(const QString &text)
+{
+    int ascii = 0;
+    int other = 0;
+    const QChar *data = text.constData();
+    const int size = text.size();
+    for (int i = 0; i < size; ++i)
+    {
+        const ushort u = data[i].unicode();
+        if (u < 0x80)
+            ++ascii;
+        else if (!QChar::isLowSurrogate(u))
+            ++other; // CJK/假名/西里尔字母/Emoji 等按 1 token/字符计；代理对只计一次
+    }
+    return (ascii + 2) / 3 + other;
+}
+
+QString TokenBudget::Plan::describe() const
+{
+    QString line = QStringLiteral("budget system %1 | tools %2 | history %3 | attachments %4")
+                       .arg(kTokens(sections.system), kTokens(sections.tools), kTokens(sections.history), kTokens(sections.attachments));
+    if (sections.toolOutput > 0) line += QStringLiteral(" | tool output %1").arg(kTokens(sections.toolOutput));
+    if (cap <= 0) return line + QStringLiteral(" = %1 (n_ctx unknown)").arg(kTokens(sections.total()));
+    line += QStringLiteral(" = %1 / %2").arg(kTokens(sections.total()), kTokens(hardLimit));
+    QStringList actions;
+    if (compact) actions << QStringLiteral("compact");
+    if (toolOutputKeep >= 0) actions << QStringLiteral("truncate tool output to %1").arg(kTokens(toolOutputKeep));
+    if (dropAttachments) actions << QStringLiteral("drop documents");
+    if (!actions.isEmpty()) line += QStringLiteral(" -> %1 => %2").arg(actions.join(QStringLiteral(", ")), kTokens(projected));
+    if (!fits()) line += QStringLiteral(" (still over)");
+    return line;
+}
+
+TokenBudget::Plan TokenBudget::plan(const Sections &sections, const Limits &limits)
+{
+    Plan p;
+    p.sections = sections;
+    p.cap = limits.contextCap;
+    int total = sections.total();
+    p.projected = total;
+    if (p.cap <= 0) return p;
+
+    p.hardLimit = std::max(0, p.cap - std::max(0, limits.reserveOutput));
+    const int ratioLimit = static_cast<int>(p.cap * limits.triggerRatio);
+    p.softLimit = std::max(0, std::min({p.hardLimit, ratioLimit, p.cap - limits.reserveTokens}));
+
+    // 1) 压缩：只有摘要能明显省出空间时才值得（否则每轮都会反复压缩同一段摘要）
+    const int gain = limits.compactableHistory - limits.summaryTokens;
+    if (total > p.softLimit && limits.canCompact && gain > limits.summaryTokens)
+    {
+        p.compact = true;
+        total -= gain;
+    }
+    // 2) 截断本轮工具输出，至少保留 minToolOutput
+    if (total > p.hardLimit && sections.toolOutput > limits.minToolOutput)
+    {
+        const int cut = std::min(total - p.hardLimit, sections.toolOutput - limits.minToolOutput);
+        p.toolOutputKeep = sections.toolOutput - cut;
+        total -= cut;
+    }
+    // 3) 仍放不下则整体丢弃文档附件（截一半的文档比没有更容易误导模型）
+    if (total > p.hardLimit && limits.droppableAttachments > 0)
+    {
+        p.dropAttachments = true;
+        total -= limits.droppableAttachments;
+    }
+    p.projected = total;
+    return p;
+}
+
+QString TokenBudget::truncateMiddle(const QString &text, int totalTokens, int keepTokens)
+{
+    if (totalTokens <= 0 || keepTokens >= totalTokens) return text;
+    const qint64 keepChars = qint64(text.size()) * std::max(0, keepTokens) / totalTokens;
+    if (keepChars >= text.size()) return text;
+    const int head = static_cast<int>(keepChars * 2 / 3);
+    const int tail = static_cast<int>(keepChars) - head;
+    const int omitted = text.size() - head - tail;
+    return text.left(head) + QStringLiteral("\n...[truncated %1 chars to fit the context window]...\n").arg(omitted) + text.right(tail);
+}
+
+TokenCounter::TokenCounter(QObject *parent)
+    : QObject(parent)
+{
+    cache_.setMaxCost(DEFAULT_BUDGET_TOKEN_CACHE);
+    clock_.start();
+}
+
+void TokenCounter::setEndpoint(const QUrl &tokenizeUrl, const QString &modelTag)
+{
+    if (tokenizeUrl == endpoint_ && modelTag == modelTag_) return;
+    endpoint_ = tokenizeUrl;
+    modelTag_ = modelTag;
+    cache_.clear(); // 不同模型的分词器计数不可混用
+    inflight_.clear();
+    ++generation_;
+    resetBackoff();
+}
+
+bool TokenCounter::backingOff() const
+{
+    return failures_ > 0 && clock_.elapsed() < retryAtMs_;
+}
+
+void TokenCounter::resetBackoff()
+{
+    failures_ = 0;
+    retryAtMs_ = 0;
+}
+
+quint64 TokenCounter::keyFor(const QString &text)
+{
+    // 两个不同种子的 32 位哈希拼成 64 位键，碰撞概率可忽略
+    return (quint64(qHash(text, 0x9e3779b9u)) << 32) | quint64(qHash(text, 0x85ebca6bu));
+}
+
+int TokenCounter::count(const QString &text, bool *exact)
+{
+    if (exact) *exact = false;
+    if (text.isEmpty()) return 0;
+    if (!endpoint_.isValid() || text.size() < DEFAULT_BUDGET_EXACT_MIN_CHARS) return TokenBudget::estimateTokens(text);
+    const quint64 key = keyFor(text);
+    if (const int *cached = cache_.object(key))
+    {
+        if (exact) *exact = true;
+        return *cached;
+    }
+    requestExact(key, text);
+    return TokenBudget::estimateTokens(text);
+}
+
+void TokenCounter::requestExact(quint64 key, const QString &text)
+{
+    if (backingOff() || inflight_.contains(key)) return;
+    if (!nam_) nam_ = new QNetworkAccessManager(this);
+    inflight_.insert(key);
+
+    QNetworkRequest request(endpoint_);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+    QJsonObject body;
+    body.insert(QStringLiteral("content"), text);
+    body.insert(QStringLiteral("add_special"), false);
+    QNetworkReply *reply = nam_->post(request, QJsonDocument(body).toJson(QJsonDocument::Compact));
+    const quint64 generation = generation_;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, key, generation]()
+            {
+        reply->deleteLater();
+        if (generation != generation_) return;
+        inflight_.remove(key);
+        const QJsonValue tokens = reply->error() == QNetworkReply::NoError
+                                      ? QJsonDocument::fromJson(reply->readAll()).object().value(QStringLiteral("tokens"))
+                                      : QJsonValue();
+        if (!tokens.isArray())
+        {
+            // 端点暂时不可用（加载中/重启中）或不支持 /tokenize：退避后再试，而不是永久放弃
+            const int shift = qMin(failures_++, 16);
+            retryAtMs_ = clock_.elapsed() + qMin<qint64>(qint64(DEFAULT_BUDGET_TOKENIZE_RETRY_MS) << shift, DEFAULT_BUDGET_TOKENIZE_RETRY_MAX_MS);
+            return;
+        }
+        resetBackoff();
+        cache_.insert(key, new int(tokens.toArray().size()), 1); });
+}
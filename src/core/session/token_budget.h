@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QCache>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QUrl>
+
+class QNetworkAccessManager;
+
+// 发送前的 token 预算规划：在请求发出之前估算各部分占用，提前决定截断工具输出、压缩历史或丢弃附件，
+// 而不是等上一轮回报的 kvUsed_ 超限后才补救（大文档/大段工具结果一次就可能冲破 n_ctx）。
+namespace TokenBudget
+{
+// 启发式计数：ASCII 约 3 字符/token，其它字符按 1 字符/token；宁可高估
+int estimateTokens(const QString &text);
+
+struct Sections
+{
+    int system = 0;      // 系统提示词
+    int tools = 0;       // function 模式下的工具 schema
+    int history = 0;     // 历史消息 + 本轮用户文本
+    int attachments = 0; // 本轮文档/图片/音频
+    int toolOutput = 0;  // 本轮待追加的工具结果
+    int total() const { return system + tools + history + attachments + toolOutput; }
+};
+
+struct Limits
+{
+    int contextCap = 0;           // n_ctx；<=0 表示未知，不做规划
+    int reserveOutput = 0;        // 为本轮生成预留的 token
+    double triggerRatio = 1.0;    // 超过 cap*ratio 即倾向压缩（与自动压缩同一阈值）
+    int reserveTokens = 0;        // 同 compaction reserve_tokens
+    bool canCompact = false;      // 本轮是否允许先做一次压缩
+    int compactableHistory = 0;   // 压缩时会被摘要替换的历史 token 数
+    int summaryTokens = 0;        // 摘要的预估 token 数
+    int droppableAttachments = 0; // 可整体丢弃的附件（文档）token 数
+    int minToolOutput = 0;        // 工具输出截断后至少保留的 token 数
+};
+
+struct Plan
+{
+    Sections sections;
+    int cap = 0;
+    int hardLimit = 0; // 超过即必然溢出：cap - reserveOutput
+    int softLimit = 0; // 超过即建议压缩
+    int projected = 0; // 执行下列动作后的预计占用
+    int toolOutputKeep = -1; // >=0 时把工具输出截断到该 token 数
+    bool compact = false;
+    bool dropAttachments = false;
+
+    bool fits() const { return cap <= 0 || projected <= hardLimit; }
+    QString describe() const;
+};
+
+// 依次尝试：压缩历史（超过 softLimit 且允许）-> 截断工具输出 -> 丢弃文档附件（超过 hardLimit）
+Plan plan(const Sections &sections, const Limits &limits);
+
+// 按 keepTokens/totalTokens 的比例保留首尾（头 2/3、尾 1/3），中间插入截断说明
+QString truncateMiddle(const QString &text, int totalTokens, int keepTokens);
+} // namespace TokenBudget
+
+// 按内容哈希缓存的 token 计数器：命中缓存返回服务端 /tokenize 的精确值，
+// 未命中先返回启发式估算，同时异步请求精确值供下一次使用（历史消息每轮都会重复计数）
+class TokenCounter : public QObject
+{
+    Q_OBJECT
+  public:
+    explicit TokenCounter(QObject *parent = nullptr);
+
+    // 端点或模型变化时清空缓存（同一端口可能换了模型）；传空 QUrl 则只用启发式
+    void setEndpoint(const QUrl &tokenizeUrl, const QString &modelTag = QString());
+    QUrl endpoint() const { return endpoint_; }
+
+    int count(const QString &text, bool *exact = nullptr);
+    int cachedEntries() const { return cache_.count(); }
+    // 端点失败后按指数退避暂停请求；成功一次或后端重启（resetBackoff）后恢复
+    bool backingOff() const;
+    void resetBackoff();
+
+    static quint64 keyFor(const QString &text);
+
+  private:
+    void requestExact(quint64 key, const QString &text);
+
+    QNetworkAccessManager *nam_ = nullptr;
+    QUrl endpoint_;
+    QString modelTag_;
+    QCache<quint64, int> cache_;
+    QSet<quint64> inflight_;
+    quint64 generation_ = 0; // 端点切换后丢弃旧请求的回包
+    QElapsedTimer clock_;
+    int failures_ = 0;       // 连续失败次数，决定退避时长
+    qint64 retryAtMs_ = 0;   // clock_ 到达该时刻前不再请求
+};
@@ -390,8 +390,10 @@ void ToolFlowController::recvToolPushover(QString tool_result_)
     w_->toolInvocationActive_ = false;
     if (tool_result_.contains("<ylsdamxssjxxdd:showdraw>")) // 有图像要显示的情况
     {
-        w_->wait_to_show_images_filepath.append(tool_result_.split("<ylsdamxssjxxdd:showdraw>")[1]); // 文生图后待显示图像的图像路径
-        w_->tool_result = "stablediffusion " + w_->jtr("call successful, image save at") + " " + tool_result_.split("<ylsdamxssjxxdd:showdraw>")[1];
+        // 一次调用可能生成多张图，路径按行分隔
+        const QStringList paths = tool_result_.split("<ylsdamxssjxxdd:showdraw>")[1].split('\n', Qt::SkipEmptyParts);
+        w_->wait_to_show_images_filepath.append(paths); // 文生图后待显示图像的图像路径
+        w_->tool_result = "stablediffusion " + w_->jtr("call successful, image save at") + " " + paths.join(QStringLiteral(", "));
     }
     else
     {
@@ -0,0 +1,545 @@
+#include "doc_ingest.h"
+
+#include "xconfig.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <doc2md/document_converter.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr int kMaxIngestWorkers = 8; // doc2md 解析大文档时内存占用可观，线程数封顶
+constexpr int kInFlightPerWorker = 2; // 每个工作线程最多领先“下一个待交付文件”的任务数
+constexpr int kMinTokenBudget = 8;
+
+bool isSentenceEnd(QChar c)
+{
+    static const QString terminators = QStringLiteral("。！？；…");
+    return terminators.contains(c);
+}
+
+bool isAsciiSentenceEnd(QChar c)
+{
+    return c == QLatin1Char('.') || c == QLatin1Char('!') || c == QLatin1Char('?') || c == QLatin1Char(';');
+}
+
+bool isClosingMark(QChar c)
+{
+    static const QString closing = QStringLiteral("”’」』)）\"'");
+    return closing.contains(c);
+}
+
+// 一行内按句末标点切分，片段保留标点与随后的空白
+void appendSentences(const QString &line, bool breakBefore, QVector<DocIngest::Segment> &out)
+{
+    int start = 0;
+    const int n = line.size();
+    for (int k = 0; k < n; ++k)
+    {
+        const QChar c = line.at(k);
+        int cut = -1;
+        if (isSentenceEnd(c))
+        {
+            cut = k + 1;
+        }
+        else if (isAsciiSentenceEnd(c) && (k + 1 >= n || line.at(k + 1).isSpace()))
+        {
+            cut = k + 1;
+        }
+        if (cut < 0) continue;
+        while (cut < n && isClosingMark(line.at(cut))) ++cut;
+        while (cut < n && line.at(cut).isSpace()) ++cut;
+        out.append({line.mid(start, cut - start), breakBefore && start == 0});
+        start = cut;
+        k = cut - 1;
+    }
+    if (start < n) out.append({line.mid(start), breakBefore && start == 0});
+}
+} // namespace
+
+QVector<int> DocIngest::tokenBoundaries(const QString &content)
+{
+    // 正则表达式匹配中文、英文单词、Emoji及其他字符；每个线程各自持有，避免跨线程共享
+    thread_local const QRegularExpression re(
+        "(\\p{Han}+)"                // 中文字符
+        "|([A-Za-z]+)"               // 英文单词
+        "|([\\x{1F300}-\\x{1F5FF}])" // Emoji 范围1
+        "|([\\x{1F600}-\\x{1F64F}])" // Emoji 范围2
+        "|([\\x{1F680}-\\x{1F6FF}])" // Emoji 范围3
+        "|([\\x{2600}-\\x{26FF}])"   // 其他符号
+        "|(\\s+)"                    // 空白字符
+        "|(.)",                      // 其他任意单字符
+        QRegularExpression::UseUnicodePropertiesOption);
+
+    // 返回 n+1 个位置：第 i 个 token 为 [b[i], b[i+1])
+    QVector<int> bounds;
+    QRegularExpressionMatchIterator it = re.globalMatch(content);
+    while (it.hasNext())
+    {
+        const QRegularExpressionMatch match = it.next();
+        if (!match.hasMatch() || match.capturedLength() == 0) continue;
+        if (bounds.isEmpty()) bounds.append(match.capturedStart());
+        bounds.append(match.capturedEnd());
+    }
+    return bounds;
+}
+
+QStringList DocIngest::splitChunks(const QString &content, int splitLength, int overlap)
+{
+    QStringList chunks;
+    const QVector<int> bounds = tokenBoundaries(content);
+    const int tokenCount = bounds.size() - 1;
+    if (tokenCount <= 0) return chunks;
+    splitLength = qMax(1, splitLength);
+    const auto tokenLength = [&bounds](int i)
+    { return bounds[i + 1] - bounds[i]; };
+
+    int startTokenIndex = 0;
+    while (startTokenIndex < tokenCount)
+    {
+        int currentLength = 0;
+        int endTokenIndex = startTokenIndex;
+        while (endTokenIndex < tokenCount)
+        {
+            const int length = tokenLength(endTokenIndex);
+            if (currentLength + length > splitLength) break;
+            currentLength += length;
+            ++endTokenIndex;
+        }
+        // 单个 token 超过分段长度（如整段无标点的中文）时单独成段，否则窗口无法前进
+        if (endTokenIndex == startTokenIndex) ++endTokenIndex;
+        const QString paragraph = content.mid(bounds[startTokenIndex], bounds[endTokenIndex] - bounds[startTokenIndex]);
+        if (!paragraph.trimmed().isEmpty()) chunks << paragraph;
+        if (endTokenIndex >= tokenCount) break;
+        int overlapLength = 0;
+        int overlapTokens = 0;
+        while (endTokenIndex - overlapTokens - 1 > startTokenIndex && overlapLength < overlap)
+        {
+            overlapLength += tokenLength(endTokenIndex - 1 - overlapTokens);
+            ++overlapTokens;
+        }
+        startTokenIndex = endTokenIndex - overlapTokens;
+    }
+    return chunks;
+}
+
+QVector<DocIngest::Segment> DocIngest::splitSegments(const QString &markdown)
+{
+    QVector<Segment> segments;
+    int pos = 0;
+    const int n = markdown.size();
+    while (pos < n)
+    {
+        const int newline = markdown.indexOf(QLatin1Char('\n'), pos);
+        const int end = newline < 0 ? n : newline + 1;
+        const QString line = markdown.mid(pos, end - pos);
+        const QString trimmed = line.trimmed();
+        if (trimmed.startsWith(QLatin1Char('#')))
+            segments.append({line, true}); // 标题整行作为一个片段，并开启新块
+        else if (trimmed.isEmpty())
+            segments.append({line, false});
+        else
+            appendSentences(line, false, segments);
+        pos = end;
+    }
+    return segments;
+}
+
+bool DocIngest::packByTokens(const QString &markdown, int tokenBudget, int overlapTokens, const TokenCounter &counter, QStringList *chunks)
+{
+    if (!counter) return false;
+    const RangeTokenCounter ranges = [&markdown, &counter](int from, int to)
+    { return counter(markdown.mid(from, to - from)); };
+    return packByTokenRanges(markdown, tokenBudget, overlapTokens, ranges, chunks);
+}
+
+bool DocIngest::packByTokenRanges(const QString &markdown, int tokenBudget, int overlapTokens, const RangeTokenCounter &counter, QStringList *chunks)
+{
+    if (!chunks || !counter) return false;
+    chunks->clear();
+    QVector<Segment> segs = splitSegments(markdown);
+    // 片段拼接即原文：offsets[k] 为第 k 个片段在 markdown 中的起点，硬切片段后重建
+    QVector<int> offsets;
+    const auto rebuildOffsets = [&segs, &offsets]()
+    {
+        offsets.resize(segs.size() + 1);
+        int pos = 0;
+        for (int k = 0; k < segs.size(); ++k)
+        {
+            offsets[k] = pos;
+            pos += segs.at(k).text.size();
+        }
+        offsets[segs.size()] = pos;
+    };
+    rebuildOffsets();
+    const int budget = qMax(kMinTokenBudget, tokenBudget);
+    double charsPerToken = 0.0; // 由实测结果逐步校准；未知时按 1 字符 = 1 token 保守估计
+    const auto estimate = [&charsPerToken](const QString &text)
+    {
+        return charsPerToken > 0.0 ? int(std::ceil(text.size() / charsPerToken)) : text.size();
+    };
+    const auto learn = [&charsPerToken](int chars, int tokens)
+    {
+        if (tokens <= 0) return;
+        const double ratio = double(chars) / tokens;
+        charsPerToken = charsPerToken > 0.0 ? 0.7 * charsPerToken + 0.3 * ratio : ratio;
+    };
+    const auto measure = [&](int from, int to)
+    {
+        const int tokens = counter(offsets.at(from), offsets.at(to));
+        learn(offsets.at(to) - offsets.at(from), tokens);
+        return tokens;
+    };
+
+    int i = 0;
+    while (i < segs.size())
+    {
+        // 1) 按估算贪心装箱，遇到标题强制断开
+        int j = i;
+        int estimated = 0;
+        while (j < segs.size())
+        {
+            if (j > i && segs.at(j).breakBefore) break;
+            const int e = estimate(segs.at(j).text);
+            if (j > i && estimated + e > budget) break;
+            estimated += e;
+            ++j;
+        }
+        int tokens = measure(i, j);
+        if (tokens < 0) return false;
+
+        // 2) 实测超出预算：按比例减少片段数后复核
+        while (tokens > budget && j - i > 1)
+        {
+            j = i + qMax(1, qMin(j - i - 1, int((j - i) * double(budget) / tokens)));
+            tokens = measure(i, j);
+            if (tokens < 0) return false;
+        }
+        if (tokens > budget && segs.at(i).text.size() >= 2)
+        {
+            // 单个片段（超长句/无标点段落）仍超出：按校准后的字符数硬切，替换原片段后重新装箱
+            const QString big = segs.at(i).text;
+            const bool breakBefore = segs.at(i).breakBefore;
+            int pieceChars = int(budget * qMax(charsPerToken, 0.25) * 0.9);
+            pieceChars = qBound(1, pieceChars, qMax(1, big.size() / 2));
+            QVector<Segment> pieces;
+            for (int p = 0; p < big.size();)
+            {
+                int end = qMin(big.size(), p + pieceChars);
+                if (end < big.size() && big.at(end - 1).isHighSurrogate()) ++end; // 不拆开代理对
+                pieces.append({big.mid(p, end - p), breakBefore && p == 0});
+                p = end;
+            }
+            segs.remove(i);
+            for (int k = 0; k < pieces.size(); ++k) segs.insert(i + k, pieces.at(k));
+            rebuildOffsets();
+            continue;
+        }
+
+        // 3) 余量较大时按校准后的估算再追加一次，减少块数
+        if (j < segs.size() && tokens < budget * 0.85 && !segs.at(j).breakBefore)
+        {
+            const int room = budget - tokens;
+            int k = j;
+            int extra = 0;
+            while (k < segs.size() && !segs.at(k).breakBefore)
+            {
+                const int e = estimate(segs.at(k).text);
+                if (extra + e > room) break;
+                extra += e;
+                ++k;
+            }
+            if (k > j)
+            {
+                const int grownTokens = measure(i, k);
+                if (grownTokens < 0) return false;
+                if (grownTokens <= budget) j = k;
+            }
+        }
+
+        const QString text = markdown.mid(offsets.at(i), offsets.at(j) - offsets.at(i));
+        if (!text.trimmed().isEmpty()) chunks->append(text);
+        if (j >= segs.size()) break;
+
+        // 4) 重叠：下一块从若干尾部片段开始（标题处不重叠），并保证窗口前进
+        int back = 0;
+        int overlapEstimated = 0;
+        while (!segs.at(j).breakBefore && j - back - 1 > i)
+        {
+            const int e = estimate(segs.at(j - 1 - back).text);
+            if (overlapEstimated + e > overlapTokens) break;
+            overlapEstimated += e;
+            ++back;
+        }
+        i = j - back;
+    }
+    return true;
+}
+
+bool DocIngest::parseTokenPieces(const QByteArray &reply, const QString &text, QVector<int> *tokenStarts)
+{
+    if (!tokenStarts) return false;
+    tokenStarts->clear();
+    const QJsonValue tokens = QJsonDocument::fromJson(reply).object().value(QStringLiteral("tokens"));
+    if (!tokens.isArray()) return false;
+    const QJsonArray array = tokens.toArray();
+    // 各 token 片段在“片段拼接串”中的 UTF-8 起点；不完整的 UTF-8 片段以字节数组返回
+    QVector<qint64> pieceStarts;
+    pieceStarts.reserve(array.size());
+    qint64 pieceBytes = 0;
+    for (const QJsonValue &token : array)
+    {
+        const QJsonValue piece = token.toObject().value(QStringLiteral("piece"));
+        pieceStarts.append(pieceBytes);
+        if (piece.isString())
+            pieceBytes += piece.toString().toUtf8().size();
+        else if (piece.isArray())
+            pieceBytes += piece.toArray().size();
+        else
+            return false; // 旧版服务端不支持 with_pieces，只返回 token id
+    }
+
+    // 原文每个 UTF-16 单元的 UTF-8 起点
+    const int n = text.size();
+    QVector<qint64> charBytes(n + 1);
+    qint64 bytes = 0;
+    for (int k = 0; k < n; ++k)
+    {
+        charBytes[k] = bytes;
+        const ushort c = text.at(k).unicode();
+        if (c < 0x80)
+            bytes += 1;
+        else if (c < 0x800)
+            bytes += 2;
+        else if (QChar::isHighSurrogate(c) && k + 1 < n && text.at(k + 1).isLowSurrogate())
+        {
+            charBytes[++k] = bytes + 2; // 低位代理记在字符中间，字符起点仍映射到高位
+            bytes += 4;
+        }
+        else
+            bytes += 3;
+    }
+    charBytes[n] = bytes;
+
+    // SentencePiece 类分词器会给首个片段补前导空格，片段总长与原文略有出入：按比例映射回原文
+    tokenStarts->reserve(pieceStarts.size());
+    for (const qint64 start : pieceStarts)
+    {
+        const qint64 mapped = pieceBytes > 0 ? start * bytes / pieceBytes : 0;
+        const int index = int(std::upper_bound(charBytes.cbegin(), charBytes.cend(), mapped) - charBytes.cbegin()) - 1;
+        tokenStarts->append(qBound(0, index, n));
+    }
+    return true;
+}
+
+DocIngest::RangeTokenCounter DocIngest::makeOffsetTokenCounter(const QVector<int> &tokenStarts)
+{
+    return [tokenStarts](int from, int to)
+    {
+        if (to <= from || tokenStarts.isEmpty()) return 0;
+        // 与 [from, to) 有交集的 token：起点在 to 之前，且终点（下一个 token 的起点）在 from 之后；
+        // 跨边界的 token 两侧都计入，整篇分词与单独分词在边界处的差异因此只会多算不会少算
+        const int startedBefore = int(std::lower_bound(tokenStarts.cbegin(), tokenStarts.cend(), to) - tokenStarts.cbegin());
+        const int startedAtOrBefore = int(std::upper_bound(tokenStarts.cbegin(), tokenStarts.cend(), from) - tokenStarts.cbegin());
+        return qMax(0, startedBefore - qMax(0, startedAtOrBefore - 1));
+    };
+}
+
+DocIngestPipeline::DocIngestPipeline(QObject *parent)
+    : QObject(parent)
+{
+    pool_.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), kMaxIngestWorkers));
+}
+
+DocIngestPipeline::~DocIngestPipeline()
+{
+    if (canceled_) canceled_->store(true);
+    pool_.clear();
+    pool_.waitForDone();
+}
+
+void DocIngestPipeline::start(const QStringList &paths, int splitLength, int overlap, const QUrl &tokenizeUrl)
+{
+    cancel();
+    ++batch_;
+    canceled_ = std::make_shared<std::atomic_bool>(false);
+    running_ = true;
+    paths_ = paths;
+    total_ = paths.size();
+    submitted_ = 0;
+    nextIndex_ = 0;
+    chunkCount_ = 0;
+    reorder_.clear();
+    if (paths.isEmpty())
+    {
+        running_ = false;
+        emit finished(false, 0);
+        return;
+    }
+
+    options_ = BatchOptions();
+    options_.splitLength = splitLength;
+    options_.overlap = overlap;
+    options_.tokenizeUrl = tokenizeUrl;
+    options_.tokenizerDown = std::make_shared<std::atomic_bool>(false);
+    options_.canceled = canceled_;
+    submitMore();
+}
+
+void DocIngestPipeline::submitMore()
+{
+    const int window = pool_.maxThreadCount() * kInFlightPerWorker;
+    const quint64 batch = batch_;
+    const std::shared_ptr<std::atomic_bool> flag = canceled_;
+    const BatchOptions options = options_;
+    while (running_ && submitted_ < total_ && submitted_ - nextIndex_ < window)
+    {
+        const int i = submitted_++;
+        const QString path = paths_.at(i);
+        QtConcurrent::run(&pool_, [this, flag, batch, i, path, options]()
+                          {
+                              if (flag->load()) return;
+                              const FileResult result = processFile(i, path, options);
+                              if (flag->load()) return;
+                              QMetaObject::invokeMethod(this, [this, batch, result]()
+                                                        { deliver(batch, result); }, Qt::QueuedConnection); });
+    }
+}
+
+void DocIngestPipeline::cancel()
+{
+    if (!running_) return;
+    if (canceled_) canceled_->store(true);
+    pool_.clear(); // 移除尚未开始的任务；正在转换的文件跑完后结果被丢弃
+    ++batch_;
+    const QSet<QNetworkReply *> replies = tokenReplies_;
+    for (QNetworkReply *reply : replies) reply->abort(); // finished 回调看到批次已变化后直接丢弃
+    running_ = false;
+    reorder_.clear();
+    paths_.clear();
+    emit finished(true, chunkCount_);
+}
+
+DocIngestPipeline::FileResult DocIngestPipeline::processFile(int index, const QString &path, const BatchOptions &options)
+{
+    FileResult result;
+    result.index = index;
+    result.path = path;
+    const QByteArray encoded = QFile::encodeName(path);
+    if (encoded.isEmpty()) return result;
+    const std::string pathStr(encoded.constData(), static_cast<size_t>(encoded.size()));
+    const doc2md::ConversionResult converted = doc2md::convertFile(pathStr);
+    for (const std::string &warn : converted.warnings) result.warnings << QString::fromStdString(warn);
+    if (!converted.success || converted.markdown.empty()) return result;
+    const QString markdown = QString::fromUtf8(converted.markdown.data(), static_cast<int>(converted.markdown.size()));
+    result.ok = true;
+    if (options.canceled && options.canceled->load()) return result;
+    if (options.tokenizeUrl.isValid() && !options.tokenizerDown->load())
+    {
+        // 分词请求由 UI 线程的共享 QNetworkAccessManager 异步发出，工作线程不阻塞等待
+        result.markdown = markdown;
+        result.awaitingTokens = true;
+        return result;
+    }
+    result.chunks = DocIngest::splitChunks(markdown, options.splitLength, options.overlap);
+    return result;
+}
+
+void DocIngestPipeline::chunkFile(FileResult *result, const QByteArray &tokenReply, const BatchOptions &options)
+{
+    QVector<int> tokenStarts;
+    const bool packed = !tokenReply.isEmpty() && DocIngest::parseTokenPieces(tokenReply, result->markdown, &tokenStarts) &&
+                        DocIngest::packByTokenRanges(result->markdown, options.splitLength, options.overlap,
+                                                     DocIngest::makeOffsetTokenCounter(tokenStarts), &result->chunks);
+    if (!packed)
+    {
+        if (!options.tokenizerDown->exchange(true))
+        {
+            result->warnings << QStringLiteral("tokenizer endpoint unavailable (%1), falling back to character split").arg(options.tokenizeUrl.toString());
+        }
+        result->chunks = DocIngest::splitChunks(result->markdown, options.splitLength, options.overlap);
+    }
+    result->markdown.clear();
+    result->awaitingTokens = false;
+}
+
+void DocIngestPipeline::requestTokens(quint64 batch, const FileResult &result)
+{
+    if (options_.tokenizerDown->load())
+    {
+        chunkInPool(batch, result, QByteArray()); // 端点已判定不可用，直接按字符切分
+        return;
+    }
+    if (!nam_) nam_ = new QNetworkAccessManager(this);
+    QNetworkRequest request(options_.tokenizeUrl);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+    request.setTransferTimeout(DEFAULT_EMBEDDING_TOKENIZE_TIMEOUT_MS);
+    QJsonObject body;
+    body.insert(QStringLiteral("content"), result.markdown);
+    body.insert(QStringLiteral("add_special"), false);
+    body.insert(QStringLiteral("with_pieces"), true); // 整篇只分词一次，由 piece 长度还原每个 token 的位置
+    QNetworkReply *reply = nam_->post(request, QJsonDocument(body).toJson(QJsonDocument::Compact));
+    tokenReplies_.insert(reply);
+    connect(reply, &QNetworkReply::finished, this, [this, batch, reply, result]()
+            {
+                tokenReplies_.remove(reply);
+                reply->deleteLater();
+                if (batch != batch_ || !running_) return;
+                const QByteArray tokenReply = reply->error() == QNetworkReply::NoError ? reply->readAll() : QByteArray();
+                chunkInPool(batch, result, tokenReply); });
+}
+
+void DocIngestPipeline::chunkInPool(quint64 batch, const FileResult &result, const QByteArray &tokenReply)
+{
+    // 应答解析与装箱都是纯计算，放回线程池，避免大文档卡住 UI 线程
+    const std::shared_ptr<std::atomic_bool> flag = canceled_;
+    const BatchOptions options = options_;
+    QtConcurrent::run(&pool_, [this, flag, batch, result, tokenReply, options]()
+                      {
+                          if (flag->load()) return;
+                          FileResult chunked = result;
+                          chunkFile(&chunked, tokenReply, options);
+                          if (flag->load()) return;
+                          QMetaObject::invokeMethod(this, [this, batch, chunked]()
+                                                    { deliver(batch, chunked); }, Qt::QueuedConnection); });
+}
+
+void DocIngestPipeline::deliver(quint64 batch, const FileResult &result)
+{
+    if (batch != batch_ || !running_) return;
+    if (result.awaitingTokens)
+    {
+        requestTokens(batch, result);
+        return;
+    }
+    reorder_.insert(result.index, result);
+    while (reorder_.contains(nextIndex_))
+    {
+        const FileResult ready = reorder_.take(nextIndex_);
+        ++nextIndex_;
+        chunkCount_ += ready.chunks.size();
+        emit fileParsed(ready.path, ready.chunks, ready.warnings, ready.ok);
+        if (batch != batch_) return; // 槽函数中取消或重新开始
+    }
+    emit progress(nextIndex_, total_, chunkCount_);
+    if (nextIndex_ >= total_)
+    {
+        running_ = false;
+        paths_.clear();
+        emit finished(false, chunkCount_);
+        return;
+    }
+    submitMore();
+}
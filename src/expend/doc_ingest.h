@@ -0,0 +1,121 @@
+// Knowledge-base document ingestion: doc2md conversion and chunking off the UI thread
+#ifndef DOC_INGEST_H
+#define DOC_INGEST_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QUrl>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+namespace DocIngest
+{
+// 分词边界：中文串/英文单词/Emoji/空白/其它单字符，与原 tokenizeContent 的切分规则一致。
+// 只记录每个 token 的起止位置，不为每个 token 分配 QString
+QVector<int> tokenBoundaries(const QString &content);
+// 按字符长度滑动窗口切分，相邻段保留约 overlap 个字符的重叠；纯空白段被丢弃
+QStringList splitChunks(const QString &content, int splitLength, int overlap);
+
+struct Segment
+{
+    QString text;
+    bool breakBefore = false; // 标题行：之前必须断开
+};
+// 按 markdown 结构切成句子级片段：标题行前强制断开，句末标点/换行处为可选断点；所有片段拼接后与原文一致
+QVector<Segment> splitSegments(const QString &markdown);
+
+// 返回文本的 token 数；-1 表示分词不可用
+using TokenCounter = std::function<int(const QString &text)>;
+// 返回 markdown 中 [from, to) 字符区间的 token 数；-1 表示分词不可用
+using RangeTokenCounter = std::function<int(int from, int to)>;
+// 按 token 预算装箱：先用校准后的“字符/token”比例估算，再由 counter 实测校验，超出则回退片段数；
+// 单个片段超出预算时按字符硬切。overlapTokens 为相邻块之间回退的尾部片段 token 上限。
+// counter 失败时返回 false，调用方应回退到字符切分
+bool packByTokens(const QString &markdown, int tokenBudget, int overlapTokens, const TokenCounter &counter, QStringList *chunks);
+bool packByTokenRanges(const QString &markdown, int tokenBudget, int overlapTokens, const RangeTokenCounter &counter, QStringList *chunks);
+// 解析整篇文本一次 /tokenize（with_pieces=true）的应答，得到各 token 在 text 中的起始字符位置（非递减）；
+// 应答不含 piece（旧版服务端）时返回 false
+bool parseTokenPieces(const QByteArray &reply, const QString &text, QVector<int> *tokenStarts);
+// 基于整篇分词结果的区间计数器，装箱时不再逐块请求服务端
+RangeTokenCounter makeOffsetTokenCounter(const QVector<int> &tokenStarts);
+} // namespace DocIngest
+
+// 后台入库流水线：线程池并行执行 doc2md 转换与切分，结果按文件顺序分批回到 UI 线程。
+// - 按 token 切分时每个文件只发一次异步 /tokenize（共用一个 QNetworkAccessManager），应答回来后在线程池中装箱
+// - 同时在内存中的 markdown 全文不超过在途窗口，切分后立即释放
+// - 背压：只提交“下一个待交付文件 + 在途窗口”以内的任务，前序大文件卡住时乱序缓冲 reorder_ 不会无限增长
+// - cancel()/再次 start() 会丢弃旧批次尚未交付的结果；正在转换的文件跑完后直接丢弃，分词请求立即中止
+class DocIngestPipeline : public QObject
+{
+    Q_OBJECT
+  public:
+    explicit DocIngestPipeline(QObject *parent = nullptr);
+    ~DocIngestPipeline() override;
+
+    // tokenizeUrl 有效时按嵌入模型的真实 token 数装箱（splitLength/overlap 视为 token 数），否则按字符切分
+    void start(const QStringList &paths, int splitLength, int overlap, const QUrl &tokenizeUrl = QUrl());
+    void cancel();
+    bool isRunning() const { return running_; }
+    int maxWorkers() const { return pool_.maxThreadCount(); }
+    // 已提交但尚未按序交付的文件数（含 reorder_ 中的暂存），不超过 maxWorkers() * 2
+    int inFlight() const { return submitted_ - nextIndex_; }
+
+  signals:
+    // 单个文件处理完毕（按文件顺序）；chunks 可能为空
+    void fileParsed(const QString &path, const QStringList &chunks, const QStringList &warnings, bool ok);
+    void progress(int doneFiles, int totalFiles, int totalChunks);
+    void finished(bool canceled, int totalChunks);
+
+  private:
+    struct FileResult
+    {
+        int index = 0;
+        QString path;
+        QString markdown; // 等待分词时暂存，切分后清空
+        QStringList chunks;
+        QStringList warnings;
+        bool ok = false;
+        bool awaitingTokens = false; // 已转换，尚需请求分词后再切分
+    };
+    struct BatchOptions
+    {
+        int splitLength = 0;
+        int overlap = 0;
+        QUrl tokenizeUrl;
+        std::shared_ptr<std::atomic_bool> tokenizerDown; // 本批次内分词端点失败后不再重试
+        std::shared_ptr<std::atomic_bool> canceled;
+    };
+    static FileResult processFile(int index, const QString &path, const BatchOptions &options);
+    // tokenReply 为 /tokenize 应答（失败时为空），据此按 token 装箱，否则回退到字符切分
+    static void chunkFile(FileResult *result, const QByteArray &tokenReply, const BatchOptions &options);
+    void submitMore();
+    void requestTokens(quint64 batch, const FileResult &result);
+    void chunkInPool(quint64 batch, const FileResult &result, const QByteArray &tokenReply);
+    void deliver(quint64 batch, const FileResult &result);
+
+    QThreadPool pool_;
+    QNetworkAccessManager *nam_ = nullptr; // 懒创建，整个流水线共用
+    QSet<QNetworkReply *> tokenReplies_;   // 在途的分词请求，取消时中止
+    std::shared_ptr<std::atomic_bool> canceled_;
+    quint64 batch_ = 0;
+    bool running_ = false;
+    QStringList paths_;
+    BatchOptions options_;
+    int total_ = 0;
+    int submitted_ = 0; // 已提交到线程池的文件数
+    int nextIndex_ = 0;
+    int chunkCount_ = 0;
+    QMap<int, FileResult> reorder_; // 乱序完成的文件暂存，等待前序文件；大小受在途窗口约束
+};
+
+#endif // DOC_INGEST_H
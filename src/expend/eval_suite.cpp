@@ -0,0 +1,185 @@
+#include "eval_suite.h"
+
+#include "../prompt.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <cmath>
+
+namespace EvalSuite
+{
+const QVector<ChoiceItem> &qaItems()
+{
+    static const QVector<ChoiceItem> items{
+        {"qa1", QChar('b')},
+        {"qa2", QChar('b')},
+        {"qa3", QChar('c')},
+        {"qa4", QChar('a')},
+        {"qa5", QChar('d')},
+    };
+    return items;
+}
+
+const QVector<ChoiceItem> &logicItems()
+{
+    static const QVector<ChoiceItem> items{
+        {"logic1", QChar('b')},
+        {"logic2", QChar('b')},
+        {"logic3", QChar('c')},
+        {"logic4", QChar('d')},
+        {"logic5", QChar('c')},
+    };
+    return items;
+}
+
+const QVector<ToolCase> &toolCases()
+{
+    // 每个工具两条自然语言任务
+    static const QVector<ToolCase> cases{
+        {"calculator", "tc_desc_calculator", "tc_tag_calculator"},
+        {"calculator", "tc_desc_calculator_2", "tc_tag_calculator_2"},
+        {"stablediffusion", "tc_desc_sd", "tc_tag_sd"},
+        {"stablediffusion", "tc_desc_sd_2", "tc_tag_sd_2"},
+        {"knowledge", "tc_desc_knowledge", "tc_tag_knowledge"},
+        {"knowledge", "tc_desc_knowledge_2", "tc_tag_knowledge_2"},
+        {"execute_command", "tc_desc_exec", "tc_tag_exec"},
+        {"execute_command", "tc_desc_exec_2", "tc_tag_exec_2"},
+        {"mcp_tools_list", "tc_desc_mcp", "tc_tag_mcp"},
+        {"mcp_tools_list", "tc_desc_mcp_2", "tc_tag_mcp_2"},
+        {"controller", "tc_desc_controller", "tc_tag_controller"},
+        {"controller", "tc_desc_controller_2", "tc_tag_controller_2"},
+    };
+    return cases;
+}
+
+QString latencySystemPrompt()
+{
+    return QStringLiteral("You are a helpful assistant. Reply briefly.");
+}
+
+QString latencyUserPrompt()
+{
+    return QString(1024, QLatin1Char('A'));
+}
+
+QString genSystemPrompt()
+{
+    return QStringLiteral("You are a helpful assistant.");
+}
+
+QString choiceSystemPrompt()
+{
+    return QStringLiteral("You are a concise assistant. Reply with a single letter A/B/C/D only.");
+}
+
+QString toolSystemPrompt()
+{
+    const QString sep = QStringLiteral("\n\n");
+    const QString toolsDesc = promptx::toolAnswer().text + sep + promptx::toolCalculator().text + sep + promptx::toolStableDiffusion().text + sep + promptx::toolKnowledge().text + sep + promptx::toolExecuteCommand().text + sep + promptx::toolController().text + sep + promptx::toolMcpList().text;
+    QString sys = promptx::extraPromptTemplate();
+    sys.replace(QStringLiteral("{available_tools_describe}"), toolsDesc);
+    sys.replace(QStringLiteral("{engineer_info}"), QString());
+    return sys;
+}
+
+QString toolTask(const QString &task)
+{
+    return task + QStringLiteral(" Strictly output exactly one <tool_call> JSON and stop.");
+}
+
+QString stripReasoning(const QString &raw)
+{
+    const QString begin = QStringLiteral(DEFAULT_THINK_BEGIN);
+    const QString end = QStringLiteral(DEFAULT_THINK_END);
+    QString out;
+    int pos = 0;
+    while (pos < raw.size())
+    {
+        const int b = raw.indexOf(begin, pos);
+        if (b < 0)
+        {
+            out += raw.mid(pos);
+            break;
+        }
+        out += raw.mid(pos, b - pos);
+        const int e = raw.indexOf(end, b + begin.size());
+        if (e < 0) break;
+        pos = e + end.size();
+    }
+    return out;
+}
+
+QChar parseChoice(const QString &answer)
+{
+    const QString s = answer.trimmed();
+    if (s.isEmpty()) return QChar();
+    for (const QChar c : {QChar('A'), QChar('B'), QChar('C'), QChar('D')})
+    {
+        if (s.contains(c, Qt::CaseInsensitive)) return c;
+    }
+    return QChar();
+}
+
+bool judgeChoice(const QString &answer, QChar expected)
+{
+    const QChar pick = parseChoice(answer);
+    return !expected.isNull() && !pick.isNull() && pick.toLower() == expected.toLower();
+}
+
+QString toolCallName(const QString &output, QString *json)
+{
+    const QString open = QStringLiteral("<tool_call>");
+    const int s = output.indexOf(open);
+    const int e = output.indexOf(QStringLiteral("</tool_call>"));
+    if (s < 0 || e <= s) return QString();
+    const QString body = output.mid(s + open.size(), e - (s + open.size())).trimmed();
+    if (json) *json = body;
+    const QJsonDocument doc = QJsonDocument::fromJson(body.toUtf8());
+    if (!doc.isObject()) return QString();
+    return doc.object().value(QStringLiteral("name")).toString();
+}
+
+double scoreTtfb(double ms)
+{
+    if (ms < 0) return 0.0;
+    if (ms <= 500.0) return 100.0;
+    if (ms >= 10000.0) return 0.0;
+    return (10000.0 - ms) * 100.0 / (10000.0 - 500.0);
+}
+
+double scoreGen(double tokPerSec)
+{
+    if (tokPerSec <= 0.0) return 0.0;
+    return std::min(100.0, tokPerSec);
+}
+
+double syncRate(double ttfbMs, double genTokPerSec, double qaScore, double logicScore, double toolScore)
+{
+    const double total = 0.10 * scoreTtfb(ttfbMs) + 0.20 * scoreGen(genTokPerSec) + 0.20 * std::max(0.0, qaScore) + 0.20 * std::max(0.0, logicScore) + 0.30 * std::max(0.0, toolScore);
+    return std::max(0.0, std::min(100.0, total));
+}
+
+Summary summarize(QVector<double> samples)
+{
+    Summary out;
+    out.count = samples.size();
+    if (samples.isEmpty()) return out;
+    std::sort(samples.begin(), samples.end());
+    auto rank = [&samples](double p)
+    {
+        const int r = static_cast<int>(std::ceil(p / 100.0 * samples.size()));
+        return samples.at(qBound(0, r - 1, samples.size() - 1));
+    };
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    out.min = samples.first();
+    out.max = samples.last();
+    out.mean = sum / samples.size();
+    out.p50 = rank(50.0);
+    out.p90 = rank(90.0);
+    out.p99 = rank(99.0);
+    return out;
+}
+} // namespace EvalSuite
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QChar>
+#include <QString>
+#include <QVector>
+
+// 模型评估套件的公共部分：题库、提示词、判分与统计。
+// 增殖窗口的评估页与无界面的 eva-bench 共用这里，两边跑的是同一套题、同一套判分。
+// 题目文本仍放在语言包里，这里只记录语言键，由调用方用各自的 jtr 解析。
+namespace EvalSuite
+{
+struct ChoiceItem
+{
+    const char *key; // 语言键（qa1 / logic1 ...）
+    QChar answer;    // 小写选项 a~d
+};
+
+struct ToolCase
+{
+    const char *name;     // 期望调用的工具名
+    const char *taskKey;  // 发给模型的任务的语言键
+    const char *labelKey; // 日志里显示的用例标签的语言键
+};
+
+const QVector<ChoiceItem> &qaItems();
+const QVector<ChoiceItem> &logicItems();
+const QVector<ToolCase> &toolCases();
+
+QString latencySystemPrompt();
+QString latencyUserPrompt(); // 1024 个 'A'，测的是带一定预填充量的首包延迟
+QString genSystemPrompt();
+QString choiceSystemPrompt();
+// 工具调用用例的系统提示词：跟随 promptx 当前语种
+QString toolSystemPrompt();
+QString toolTask(const QString &task);
+
+constexpr double kLatencyTemp = 0.2;
+constexpr double kGenTemp = 0.0;
+constexpr int kGenPredict = 1024;
+constexpr double kChoiceTemp = 0.1;
+constexpr double kToolTemp = 0.2;
+
+// 去掉 <think>...</think> 段（未闭合的思考段一直删到末尾），只留最终回答
+QString stripReasoning(const QString &raw);
+// 接受 A、a、'A)'、'选A'、'答案：C' 等写法；识别不出返回空 QChar（大写）
+QChar parseChoice(const QString &answer);
+bool judgeChoice(const QString &answer, QChar expected);
+// 抽取第一个 <tool_call> 中 JSON 的 name；json 非空时写回标签内的原文
+QString toolCallName(const QString &output, QString *json = nullptr);
+
+// 分项得分（0~100）与加权同步率：10% 首包、20% 生成、20% 常识、20% 逻辑、30% 工具
+double scoreTtfb(double ms);
+double scoreGen(double tokPerSec);
+double syncRate(double ttfbMs, double genTokPerSec, double qaScore, double logicScore, double toolScore);
+
+struct Summary
+{
+    int count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+};
+
+// nearest-rank 分位数；空样本返回 count=0
+Summary summarize(QVector<double> samples);
+} // namespace EvalSuite
@@ -99,9 +99,7 @@ Expend::Expend(QWidget *parent, QString applicationDirPath_)
         shutdownEvalWorker();
         stopEmbeddingServer(true); });
 
-    // Speech playback
-    speech_player = new QMediaPlayer;
-    connect(speech_player, &QMediaPlayer::mediaStatusChanged, this, &Expend::speech_player_over);
+    // Speech playback: QMediaPlayer 初始化多媒体后端较慢，首次播放时再创建（speechPlayer()）
 
     // Periodic timers for TTS stream/playback
     connect(&speechTimer, &QTimer::timeout, this, &Expend::speech_process);
@@ -113,7 +111,7 @@ Expend::Expend(QWidget *parent, QString applicationDirPath_)
     createTempDirectory(applicationDirPath + "/EVA_TEMP");
     readConfig();
     setupMcpConfigPersistence();
-    scheduleEmbeddingWarmup();
+    // 向量库在首帧之后由 main 的启动编排加载（ensureEmbeddingStoreLoaded），切到知识库页时也会按需加载
 }
 
 Expend::~Expend()
@@ -135,18 +133,18 @@ Expend::~Expend()
     killProc(whisper_process);
     killProc(quantize_process);
     killProc(tts_process);
+    if (docIngest_)
+    {
+        // 停止后台解析并等待工作线程退出；此时不再回调界面
+        docIngest_->blockSignals(true);
+        delete docIngest_;
+        docIngest_ = nullptr;
+    }
 
     flushMcpConfigToDisk();
     delete ui;
 }
 
-void Expend::scheduleEmbeddingWarmup()
-{
-    if (embeddingWarmupScheduled_) return;
-    embeddingWarmupScheduled_ = true;
-    QTimer::singleShot(900, this, &Expend::warmupEmbeddingStore);
-}
-
 void Expend::warmupEmbeddingStore()
 {
     if (embeddingStoreReady_) return;
@@ -160,11 +158,17 @@ void Expend::ensureEmbeddingStoreLoaded()
 {
     if (embeddingStoreReady_)
         return;
-    if (!embeddingWarmupScheduled_)
+    warmupEmbeddingStore();
+}
+
+QMediaPlayer *Expend::speechPlayer()
+{
+    if (!speech_player)
     {
-        embeddingWarmupScheduled_ = true;
+        speech_player = new QMediaPlayer(this);
+        connect(speech_player, &QMediaPlayer::mediaStatusChanged, this, &Expend::speech_player_over);
     }
-    warmupEmbeddingStore();
+    return speech_player;
 }
 
 void Expend::configureEmbeddingAutoStart(const QString &modelPath, bool shouldStart)
@@ -191,7 +195,9 @@ void Expend::tryAutoStartEmbeddingServer()
 
     embedding_embed_need = false;
     embedding_params.modelpath = resolvedPath;
+    emit expend2tool_embedding_model(embedding_params.modelpath);
     embedding_server_start();
+    ensureRerankWorker();
     embedding_server_need = false;
     pendingEmbeddingModelPath_.clear();
 }
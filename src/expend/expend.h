@@ -35,6 +35,7 @@
 #include <QNetworkRequest>
 #include <QObject>
 #include <QPlainTextEdit>
+#include <QPointer>
 #include <QProcess>
 #include <QScrollBar>
 #include <QSettings>
@@ -67,16 +68,20 @@
 
 #include "../mcp_tools.h"
 #include "../utils/mediaresultwidget.h"
+#include "../utils/speech_stream_window.h"
+#include "../utils/wavutil.h"
 #include "../storage/vectordb.h"
 #include "../xconfig.h"
 #include "./src/utils/toggleswitch.h"
 #include "sd_params_dialog.h"
+#include "doc_ingest.h"
 namespace Ui
 {
 class Expend;
 }
 
 class ImageDropWidget;
+class ResidentWorker;
 class Expend : public QWidget
 {
     Q_OBJECT
@@ -181,21 +186,48 @@ class Expend : public QWidget
   signals:
     void whisper_kill();
     void expend2ui_speechdecode_over(QString result);
+    void expend2ui_speechdecode_partial(QString text); // 流式转写的实时部分结果
     void expend2ui_whisper_modelpath(QString modelpath);
   public slots:
     void recv_speechdecode(QString wavpath, QString out_format = "txt"); // 开始语音转文字
     void whisper_onProcessStarted();
     void whisper_onProcessFinished();
+    void recv_speechstream_begin();                  // 流式录音开始：预热常驻 whisper-server
+    void recv_speechstream_chunk(QByteArray pcm);    // 16kHz/mono/16-bit PCM 片段
+    void recv_speechstream_end(QString wavpath);     // 录音结束：识别尾段并给出最终文本
   private slots:
     void on_whisper_load_modelpath_button_clicked(); // 用户点击选择whisper路径时响应
     void on_whisper_wavpath_pushButton_clicked();    // 用户点击选择wav路径时响应
     void on_whisper_execute_pushbutton_clicked();    // 用户点击执行转换时响应
 
+  private:
+    // whisper-server 常驻服务：模型只加载一次；流式识别维护“已定稿文本 + 当前窗口”
+    enum class WhisperRequestKind
+    {
+        Partial,
+        Final
+    };
+    bool ensureWhisperResidentWorker();
+    void postWhisperInference(const QByteArray &wav, WhisperRequestKind kind);
+    void onWhisperReplyFinished(QNetworkReply *reply, WhisperRequestKind kind);
+    void maybeRequestWhisperPartial();
+    void startWhisperStreamFinal();
+    void finishWhisperStream(const QString &tail);
+    void abortWhisperReply();
+    ResidentWorker *whisper_worker_ = nullptr;
+    QNetworkAccessManager *whisper_net_ = nullptr;
+    QPointer<QNetworkReply> whisper_reply_;
+    SpeechStreamWindow whisper_stream_{pcm16BytesForMs(DEFAULT_WHISPER_STREAM_STEP_MS, DEFAULT_WHISPER_SAMPLE_RATE),
+                                       pcm16BytesForMs(DEFAULT_WHISPER_STREAM_WINDOW_MS, DEFAULT_WHISPER_SAMPLE_RATE)};
+    QString whisper_stream_wavpath_; // 完整录音，服务不可用时交给 whisper-cli
+    bool whisper_stream_active_ = false;
+    bool whisper_stream_ending_ = false;
+    bool whisper_resident_disabled_ = false;
+
     //-------------------------------------------------------------------------
     //----------------------------------知识库相关--------------------------------
     //-------------------------------------------------------------------------
   public:
-    QStringList tokenizeContent(const QString &content); // 分词函数
     Embedding_Params embedding_params;
     int embedding_resultnumb = 3;       // 嵌入结果返回个数
     bool embedding_server_need = false; // 下一次打开是否需要自启动嵌入服务
@@ -214,6 +246,10 @@ class Expend : public QWidget
     int embedding_server_dim = DEFAULT_EMBEDDING_DIM; // 开启嵌入服务的嵌入维度
     void preprocessTXT();                           // 预处理文件内容
     void preprocessFiles(const QStringList &paths); // preprocess multiple files
+    void ensureDocIngestPipeline();                 // 后台解析/切分流水线（懒创建）
+    DocIngestPipeline *docIngest_ = nullptr;
+    QElapsedTimer docIngestTimer_;
+    bool embedAfterIngest_ = false; // 解析未完成时请求了嵌入，完成后自动开始
     int show_chunk_index = 0;                       // 待显示的嵌入文本段的序号
     QVector<Embedding_vector> Embedding_DB;         // 嵌入的所有文本段的词向量，向量数据库
     VectorDB vectorDb;                              // SQLite 持久化向量库
@@ -224,8 +260,10 @@ class Expend : public QWidget
   signals:
     void expend2tool_embeddingdb(QVector<Embedding_vector> Embedding_DB_); // 发送已嵌入文本段数据给tool
     void expend2tool_embedding_dim(int dim);                               // 同步嵌入维度给工具侧
+    void expend2tool_embedding_model(QString modelpath);                   // 同步嵌入模型路径给工具侧
     void expend2ui_embeddingdb_describe(QString describe);                 // 传递知识库的描述
     void expend2ui_embedding_resultnumb(int resultnumb);                   // 传递嵌入结果返回个数
+    void expend2tool_rerank_endpoint(QString endpoint);                    // 重排序服务就绪/停止时同步给工具侧（空串表示不可用）
   public slots:
     void embedding_processing(); // 知识库构建过程
     void readyRead_server_process_StandardOutput();
@@ -246,18 +284,22 @@ class Expend : public QWidget
     void on_embedding_txt_describe_lineEdit_textChanged();        // 知识库描述改变响应
     void on_embedding_resultnumb_spinBox_valueChanged(int value); // 嵌入结果返回个数改变响应
     void on_embedding_dim_spinBox_valueChanged(int value);        // 嵌入维度改变响应
+    void on_rerank_modelpath_button_clicked();                    // 用户点击选择/停止重排序模型时响应
 
   private:
     QString embedding_store_path_;
     void rebuildEmbeddedTableView();
     void restoreEmbeddingsFromStore();
     void initializeEmbeddingStore();
-    void scheduleEmbeddingWarmup();
     void warmupEmbeddingStore();
     void tryAutoStartEmbeddingServer();
     bool embeddingStoreReady_ = false;
-    bool embeddingWarmupScheduled_ = false;
     QString pendingEmbeddingModelPath_;
+    // 可选的重排序服务（llama-server --reranking），与嵌入服务一样常驻，不做空闲回收
+    bool ensureRerankWorker();
+    void stopRerankWorker();
+    ResidentWorker *rerank_worker_ = nullptr;
+    QString rerank_modelpath_;
 
     //-------------------------------------------------------------------------
     //----------------------------------模型量化相关--------------------------------
@@ -305,7 +347,7 @@ class Expend : public QWidget
     void sd_onProcessStarted();  // 进程开始响应
     void sd_onProcessFinished(); // 进程结束响应
 
-    void recv_draw(quint64 invocationId, QString prompt_); // 接收到tool的开始绘制图像信号
+    void recv_draw(quint64 invocationId, QString prompt_, int count = 1, int seed = -1); // 接收到tool的开始绘制图像信号
   signals:
     void expend2tool_drawover(quint64 invocationId, QString result_, bool ok_); // 绘制完成信号
   private slots:
@@ -313,6 +355,39 @@ class Expend : public QWidget
     void on_sd_draw_pushButton_clicked();    // 用户点击文生图时响应
     void on_sd_open_params_button_clicked(); // 打开高级参数弹窗
 
+  private:
+    // 常驻 sd-server：按当前预设加载一次模型，排队执行绘制任务（同一任务内的多张图连续生成，不重新加载）
+    struct SdJob
+    {
+        quint64 invocationId = 0;
+        bool fromTool = false;
+        QString positive; // 原始正向提示词（回退 CLI 时使用）
+        QString prompt;   // 已拼接修饰词与 LoRA 标签
+        int seed = -1;  // -1 表示每张随机
+        int count = 1;
+    };
+    QStringList sdModelArguments(QString *loraPrompt) const; // 模型/组件/后端开关（CLI 与 sd-server 共用）
+    QString sdComposePrompt(const QString &positive, const QString &loraPrompt) const;
+    bool sdResidentEligible() const; // 纯文生图才走常驻服务；图生图/视频/ControlNet 仍用 CLI
+    bool ensureSdResidentWorker();
+    void enqueueSdJob(const SdJob &job);
+    void startNextSdJob();
+    void postSdResidentImage();
+    void onSdResidentReplyFinished(QNetworkReply *reply);
+    void finishSdJob(bool ok, const QString &detail);
+    void cancelSdJobs(const QString &reason); // 中止在途与排队任务，工具调用以 reason 失败返回
+    void fallbackSdJobsToCli(const QString &reason); // sd-server 不可用：停用常驻服务，在途与排队任务改由 CLI 逐个重做
+    void runNextSdCliJob();
+    ResidentWorker *sd_worker_ = nullptr;
+    QNetworkAccessManager *sd_net_ = nullptr;
+    QPointer<QNetworkReply> sd_reply_;
+    QList<SdJob> sd_jobs_;
+    SdJob sd_current_job_;
+    bool sd_job_running_ = false;
+    QStringList sd_job_outputs_;
+    bool sd_resident_disabled_ = false;
+    QList<SdJob> sd_cli_jobs_; // 从 sd-server 回退到 CLI、尚未开始的任务
+
     //-------------------------------------------------------------------------
     //----------------------------------文转声相关--------------------------------
     //-------------------------------------------------------------------------
@@ -326,7 +401,8 @@ class Expend : public QWidget
 #if defined(EVA_ENABLE_QT_TTS)
     QTextToSpeech *sys_speech = nullptr;
 #endif
-    QMediaPlayer *speech_player;
+    QMediaPlayer *speech_player = nullptr; // 懒创建，统一经 speechPlayer() 取用
+    QMediaPlayer *speechPlayer();
     bool is_sys_speech_available = false; // Whether platform voices are available
     bool is_speech = false;               // Whether synthesis is running
     bool is_speech_play = false;          // Whether playback is running
@@ -335,7 +411,8 @@ class Expend : public QWidget
     QStringList wait_speech_txt_list;     // Text awaiting synthesis
     QStringList wait_speech_play_list;    // Wav files awaiting playback
     QString temp_speech_txt;
-    void runTtsProcess(const QString &text); // Invoke tts.cpp CLI for synthesis
+    void runTtsProcess(const QString &text); // Synthesize via resident tts-server, fallback to tts.cpp CLI
+    void runTtsCliProcess(const QString &text); // One-shot tts-cli synthesis (loads model per call)
     QProcess *tts_process;                  // Child process for tts.cpp
     QProcess *tts_list_process;             // 枚举 tts.cpp 可用音色（--list-voices）
     QStringList ttscpp_voice_list_cache_;   // 最近一次枚举到的 tts.cpp 音色列表（用于回填/兜底）
@@ -377,6 +454,18 @@ class Expend : public QWidget
     void refreshSpeechVoiceUi();               // 按当前声源刷新“可用音色”下拉框
     void requestTtscppVoiceList(bool resetRetryBudget = true); // 启动 tts-cli --list-voices（resetRetryBudget=true 时重置重试次数）
     void applyVoiceComboItems(const QStringList &voices, const QString &preferred); // 填充音色下拉框并回填选择
+    // tts-server 常驻合成：模型只加载一次，段落经本地 HTTP 持久连接合成
+    bool ensureTtsResidentWorker();                 // 准备/拉起常驻服务；false 表示不可用需回退 CLI
+    void postTtsResidentRequest(const QString &text);
+    void onTtsResidentReady();
+    void onTtsResidentFailed(const QString &reason);
+    void onTtsResidentReplyFinished(QNetworkReply *reply, const QString &text);
+    QString takeNextTtsSegment();                   // 取下一段待合成文本（常驻模式下对长段落按句拆分）
+    ResidentWorker *tts_worker_ = nullptr;
+    QNetworkAccessManager *tts_net_ = nullptr;
+    QPointer<QNetworkReply> tts_reply_;
+    QString tts_resident_pending_text_; // 常驻服务就绪前暂存的段落
+    bool tts_resident_disabled_ = false; // 本次会话常驻服务失败后回退 CLI
     // Strict per-preset isolation for SD advanced configuration
     QMap<QString, SDRunConfig> sd_preset_configs_; // key: preset name -> config
     QString sanitizePresetKey(const QString &preset) const
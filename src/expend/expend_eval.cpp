@@ -2,6 +2,7 @@
 #include "expend.h"
 
 #include "../prompt.h"
+#include "eval_suite.h"
 #include "../utils/devicemanager.h"
 #include "../utils/flowprogressbar.h"
 #include "../xnet.h"
@@ -283,18 +284,8 @@ void Expend::on_eval_start_pushButton_clicked()
     }
     toolCases_.clear();
     // Construct evaluation tasks for each tool (two natural prompts per tool).
-    toolCases_.push_back({QStringLiteral("calculator"), jtr("tc_desc_calculator"), jtr("tc_tag_calculator")});
-    toolCases_.push_back({QStringLiteral("calculator"), jtr("tc_desc_calculator_2"), jtr("tc_tag_calculator_2")});
-    toolCases_.push_back({QStringLiteral("stablediffusion"), jtr("tc_desc_sd"), jtr("tc_tag_sd")});
-    toolCases_.push_back({QStringLiteral("stablediffusion"), jtr("tc_desc_sd_2"), jtr("tc_tag_sd_2")});
-    toolCases_.push_back({QStringLiteral("knowledge"), jtr("tc_desc_knowledge"), jtr("tc_tag_knowledge")});
-    toolCases_.push_back({QStringLiteral("knowledge"), jtr("tc_desc_knowledge_2"), jtr("tc_tag_knowledge_2")});
-    toolCases_.push_back({QStringLiteral("execute_command"), jtr("tc_desc_exec"), jtr("tc_tag_exec")});
-    toolCases_.push_back({QStringLiteral("execute_command"), jtr("tc_desc_exec_2"), jtr("tc_tag_exec_2")});
-    toolCases_.push_back({QStringLiteral("mcp_tools_list"), jtr("tc_desc_mcp"), jtr("tc_tag_mcp")});
-    toolCases_.push_back({QStringLiteral("mcp_tools_list"), jtr("tc_desc_mcp_2"), jtr("tc_tag_mcp_2")});
-    toolCases_.push_back({QStringLiteral("controller"), jtr("tc_desc_controller"), jtr("tc_tag_controller")});
-    toolCases_.push_back({QStringLiteral("controller"), jtr("tc_desc_controller_2"), jtr("tc_tag_controller_2")});
+    for (const EvalSuite::ToolCase &tc : EvalSuite::toolCases())
+        toolCases_.push_back({QString::fromLatin1(tc.name), jtr(tc.taskKey), jtr(tc.labelKey)});
 
     stepsUnitsTotal = 1 /*latency*/ + genPlanned_ /*gen (multi-run)*/ + qaPlanned_ /*qa*/ + logicPlanned_ /*logic*/ + toolCases_.size() /*tools*/;
     evalResetUi();
@@ -329,14 +320,7 @@ void Expend::on_eval_start_pushButton_clicked()
 
 QChar Expend::parseMCAnswer(const QString &ans)
 {
-    // Accept formats like A, a, 'A)', '选A', '答案：C', etc.
-    const QString s = ans.trimmed();
-    if (s.isEmpty()) return QChar();
-    for (const QChar &c : {QChar('A'), QChar('B'), QChar('C'), QChar('D'), QChar('a'), QChar('b'), QChar('c'), QChar('d')})
-    {
-        if (s.contains(c, Qt::CaseInsensitive)) return c.toUpper();
-    }
-    return QChar();
+    return EvalSuite::parseChoice(ans);
 }
 
 void Expend::evalNext()
@@ -358,9 +342,8 @@ void Expend::runLatencyTest()
     // Step header (no leading blank for the very first step)
     evalLog(jtr("latency intro"));
     evalSetStatus(0, jtr("in progress"));
-    ENDPOINT_DATA d = makeBaseData(0.2, 1);
-    const QString bigUser = QString(1024, QLatin1Char('A'));
-    d.messagesArray = makeMsgs(QStringLiteral("You are a helpful assistant. Reply briefly."), bigUser);
+    ENDPOINT_DATA d = makeBaseData(EvalSuite::kLatencyTemp, 1);
+    d.messagesArray = makeMsgs(EvalSuite::latencySystemPrompt(), EvalSuite::latencyUserPrompt());
     // Prepare and fire
     evalFirstToken = false;
     evalAccum.clear();
@@ -382,9 +365,9 @@ void Expend::runGenSpeedTest()
     evalSetStatus(1, jtr("in progress") + " " + QString::number(genRunIndex_) + "/" + QString::number(genPlanned_));
     // Note: per-run counters are reset after timers restart below to ensure
     // a clean boundary between runs (see duplicates after stepTimer.restart()).
-    ENDPOINT_DATA d = makeBaseData(0.0, 1024);
+    ENDPOINT_DATA d = makeBaseData(EvalSuite::kGenTemp, EvalSuite::kGenPredict);
     const QString ask = jtr("gen essay prompt");
-    d.messagesArray = makeMsgs(QStringLiteral("You are a helpful assistant."), ask);
+    d.messagesArray = makeMsgs(EvalSuite::genSystemPrompt(), ask);
     evalFirstToken = false;
     evalAccum.clear();
     evalAccumRaw_.clear();
@@ -410,11 +393,8 @@ void Expend::runQATest()
     {
         // Initialize common-sense MC (A-D). second is expected option in lower case
         qaPairs_.clear();
-        qaPairs_.push_back({jtr("qa1"), QStringLiteral("b")});
-        qaPairs_.push_back({jtr("qa2"), QStringLiteral("b")});
-        qaPairs_.push_back({jtr("qa3"), QStringLiteral("c")});
-        qaPairs_.push_back({jtr("qa4"), QStringLiteral("a")});
-        qaPairs_.push_back({jtr("qa5"), QStringLiteral("d")});
+        for (const EvalSuite::ChoiceItem &item : EvalSuite::qaItems())
+            qaPairs_.push_back({jtr(item.key), QString(item.answer)});
         qaIndex_ = 0;
         qaCorrect_ = 0;
         // Blank line to visually separate previous step
@@ -435,8 +415,8 @@ void Expend::runQATest()
     if (qaIndex_ == 0) evalSetStatus(2, jtr("in progress") + QStringLiteral(" 0/") + QString::number(qaPlanned_));
     // Print question first for QA
     evalLog(QStringLiteral("[") + jtr("common qa") + QStringLiteral("] ") + jtr("question") + QStringLiteral("(") + QString::number(qaIndex_ + 1) + "/" + QString::number(qaPlanned_) + QStringLiteral(")\n") + p.first);
-    ENDPOINT_DATA d = makeBaseData(0.1, 0);
-    d.messagesArray = makeMsgs(QStringLiteral("You are a concise assistant. Reply with a single letter A/B/C/D only."), p.first);
+    ENDPOINT_DATA d = makeBaseData(EvalSuite::kChoiceTemp, 0);
+    d.messagesArray = makeMsgs(EvalSuite::choiceSystemPrompt(), p.first);
     evalFirstToken = false;
     // Reset per-turn accumulators
     evalAccum.clear();
@@ -457,11 +437,8 @@ void Expend::runLogicTest()
     {
         // Initialize 5 harder MC questions (Olympiad-style, simplified)
         logicPairs_.clear();
-        logicPairs_.push_back({jtr("logic1"), QStringLiteral("b")});
-        logicPairs_.push_back({jtr("logic2"), QStringLiteral("b")});
-        logicPairs_.push_back({jtr("logic3"), QStringLiteral("c")});
-        logicPairs_.push_back({jtr("logic4"), QStringLiteral("d")});
-        logicPairs_.push_back({jtr("logic5"), QStringLiteral("c")});
+        for (const EvalSuite::ChoiceItem &item : EvalSuite::logicItems())
+            logicPairs_.push_back({jtr(item.key), QString(item.answer)});
         logicIndex_ = 0;
         logicCorrect_ = 0;
         // Blank line to visually separate previous step
@@ -480,8 +457,8 @@ void Expend::runLogicTest()
     if (logicIndex_ == 0) evalSetStatus(3, jtr("in progress") + QStringLiteral(" 0/") + QString::number(logicPlanned_));
     // Print question first for Logic
     evalLog(QStringLiteral("[") + jtr("logic") + QStringLiteral("] ") + jtr("question") + QStringLiteral("(") + QString::number(logicIndex_ + 1) + "/" + QString::number(logicPlanned_) + QStringLiteral(")\n") + p.first);
-    ENDPOINT_DATA d = makeBaseData(0.1, 0);
-    d.messagesArray = makeMsgs(QStringLiteral("You are a concise assistant. Reply with a single letter A/B/C/D only."), p.first);
+    ENDPOINT_DATA d = makeBaseData(EvalSuite::kChoiceTemp, 0);
+    d.messagesArray = makeMsgs(EvalSuite::choiceSystemPrompt(), p.first);
     evalFirstToken = false;
     // Reset per-turn accumulators for logic question
     evalAccum.clear();
@@ -520,16 +497,10 @@ void Expend::runToolcallTest()
     }
     // Prepare one tool case
     const ToolCase &tc = toolCases_[toolIndex_];
-    QString toolsDesc = promptx::toolAnswer().text + QString("\n\n") + promptx::toolCalculator().text + QString("\n\n") + promptx::toolStableDiffusion().text + QString("\n\n") + promptx::toolKnowledge().text + QString("\n\n") + promptx::toolExecuteCommand().text + QString("\n\n") + promptx::toolController().text + QString("\n\n") + promptx::toolMcpList().text;
     // Print tool case header and task before model output
     evalLog(QStringLiteral("[") + jtr("tool call") + QStringLiteral("] ") + QString("(%1/%2) ").arg(toolIndex_ + 1).arg(toolCases_.size()) + tc.desc + QStringLiteral("\n") + jtr("task") + QStringLiteral("\n") + tc.user);
-        QString sys = promptx::extraPromptTemplate();
-    sys.replace("{available_tools_describe}", toolsDesc);
-    sys.replace("{engineer_info}", QString());
-    const QString task = tc.user + QStringLiteral(" Strictly output exactly one <tool_call> JSON and stop.");
-
-    ENDPOINT_DATA d = makeBaseData(0.2, 0);
-    d.messagesArray = makeMsgs(sys, task);
+    ENDPOINT_DATA d = makeBaseData(EvalSuite::kToolTemp, 0);
+    d.messagesArray = makeMsgs(EvalSuite::toolSystemPrompt(), EvalSuite::toolTask(tc.user));
     evalFirstToken = false;
     // Reset per-turn accumulators for tool case
     evalAccum.clear();
@@ -552,26 +523,7 @@ void Expend::evalFinish()
         if (auto fp = qobject_cast<FlowProgressBar *>(ui->eval_progressBar)) fp->setFlowing(false);
     }
     // Weighted overall score per spec: 10% TTFB, 20% Gen, 20% Common QA, 20% Logic, 30% Tools
-    auto scoreTTFB = [&](double ms)
-    {
-        if (ms < 0) return 0.0;
-        if (ms <= 500.0) return 100.0;
-        if (ms >= 10000.0) return 0.0;
-        return (10000.0 - ms) * 100.0 / (10000.0 - 500.0);
-    };
-    auto scoreGen = [&](double tokps) -> double
-    {
-        if (tokps < 0) return 0.0;
-        if (tokps >= 100.0) return 100.0;
-        if (tokps <= 0.0) return 0.0;
-        return tokps;
-    };
-    const double s_ttfb = scoreTTFB(m_firstTokenMs);
-    const double s_gen = scoreGen(m_genTokPerSec);
-    const double s_qa = qMax(0.0, m_qaScore);
-    const double s_log = qMax(0.0, m_logicScore);
-    const double s_tool = qMax(0.0, m_toolScore);
-    m_syncRate = std::max(0.0, std::min(100.0, 0.10 * s_ttfb + 0.20 * s_gen + 0.20 * s_qa + 0.20 * s_log + 0.30 * s_tool));
+    m_syncRate = EvalSuite::syncRate(m_firstTokenMs, m_genTokPerSec, m_qaScore, m_logicScore, m_toolScore);
     // Do not show overall score in the table; only log it and reflect on bar chart
     // Insert spacing before the final summary for better visual grouping
     evalLog(QString());
@@ -656,14 +608,7 @@ void Expend::onEvalOutput(const QString &text, bool streaming, QColor)
         {
             m_firstTokenMs = ms;
             // Display score (0-100) in the "值" column for TTFB
-            auto scoreTTFB = [&](double t_ms)
-            {
-                if (t_ms < 0) return 0.0;
-                if (t_ms <= 500.0) return 100.0;
-                if (t_ms >= 10000.0) return 0.0;
-                return (10000.0 - t_ms) * 100.0 / (10000.0 - 500.0);
-            };
-            const double s = scoreTTFB(m_firstTokenMs);
+            const double s = EvalSuite::scoreTtfb(m_firstTokenMs);
             evalSetTable(0, jtr("first token"), QString::number(s, 'f', 0));
             updateScoreBars();
             // Immediately stop the request after first token to measure TTFB only
@@ -751,14 +696,7 @@ void Expend::onEvalPushover()
             const double totalMs = evalTimer.isValid() ? (evalTimer.nsecsElapsed() / 1e6) : 0.0;
             m_firstTokenMs = totalMs;
             evalFirstToken = true;
-            auto scoreTTFB = [&](double t_ms)
-            {
-                if (t_ms < 0) return 0.0;
-                if (t_ms <= 500.0) return 100.0;
-                if (t_ms >= 10000.0) return 0.0;
-                return (10000.0 - t_ms) * 100.0 / (10000.0 - 500.0);
-            };
-            const double s = scoreTTFB(m_firstTokenMs);
+            const double s = EvalSuite::scoreTtfb(m_firstTokenMs);
             evalSetTable(0, jtr("first token"), QString::number(s, 'f', 0));
             updateScoreBars();
         }
@@ -944,24 +882,9 @@ void Expend::onEvalPushover()
         // Tools: evaluate current case then proceed to next
         // Prefer outside-<think> text when extracting the tool_call JSON
         const QString all = (evalAnswer_.trimmed().isEmpty() ? evalAccum : evalAnswer_);
-        int s = all.indexOf("<tool_call>");
-        int e = all.indexOf("</tool_call>");
-        bool ok = false;
         QString jsonStr;
-        if (s >= 0 && e > s)
-        {
-            jsonStr = all.mid(s + 11, e - (s + 11)).trimmed();
-            try
-            {
-                mcp::json call = mcp::json::parse(jsonStr.toStdString());
-                const QString name = QString::fromStdString(get_string_safely(call, "name"));
-                ok = (name == toolCases_[toolIndex_].name);
-            }
-            catch (...)
-            {
-                ok = false;
-            }
-        }
+        const QString name = EvalSuite::toolCallName(all, &jsonStr);
+        const bool ok = !name.isEmpty() && name == toolCases_[toolIndex_].name;
         toolCorrect_ += ok ? 1 : 0;
         // Log result only (case header already printed before sending the task)
         QString tlog;
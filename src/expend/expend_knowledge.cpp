@@ -1,8 +1,9 @@
 #include "expend.h"
 
+#include "../service/backend/resident_worker.h"
 #include "../utils/devicemanager.h"
+#include "../utils/model_catalog.h"
 #include "../utils/pathutil.h"
-#include <doc2md/document_converter.h>
 #include "ui_expend.h"
 #include <QByteArray>
 #include <QDebug>
@@ -52,6 +53,7 @@ void Expend::restoreEmbeddingsFromStore()
     if (!vectorDb.currentModelId().isEmpty())
     {
         embedding_params.modelpath = vectorDb.currentModelId();
+        emit expend2tool_embedding_model(embedding_params.modelpath);
         if (ui && ui->embedding_model_lineedit)
         {
             const bool prevKeep = keep_embedding_server;
@@ -108,12 +110,28 @@ void Expend::on_embedding_txt_modelpath_button_clicked()
         return;
     }
     embedding_params.modelpath = currentpath;
-    // 若为新模型，立即清空持久化库，避免混用；维度稍后由服务日志刷新
+    emit expend2tool_embedding_model(embedding_params.modelpath);
+    // 嵌入维度直接取自 GGUF 元数据；读不到时保持 0，等服务日志回报
+    const GgufInfo modelInfo = ModelCatalog::shared(applicationDirPath).lookup(embedding_params.modelpath);
+    const int catalogDim = modelInfo.valid ? modelInfo.nEmbd : 0;
+    // 若为新模型，立即清空持久化库，避免混用
     if (embedding_params.modelpath != vectorDb.currentModelId())
     {
-        vectorDb.setCurrentModel(embedding_params.modelpath, 0 /*keep dim until server reports*/);
+        vectorDb.setCurrentModel(embedding_params.modelpath, catalogDim);
         vectorDb.clearAll();
     }
+    if (catalogDim > 0 && catalogDim != embedding_server_dim)
+    {
+        embedding_server_dim = catalogDim;
+        if (ui && ui->embedding_dim_spinBox)
+        {
+            const bool prev_keep = keep_embedding_server;
+            keep_embedding_server = true;
+            ui->embedding_dim_spinBox->setValue(embedding_server_dim);
+            keep_embedding_server = prev_keep;
+        }
+        emit expend2tool_embedding_dim(embedding_server_dim);
+    }
     // 清空内存与 UI 视图
     Embedding_DB.clear();
     ui->embedding_txt_over->clear();                                                             // 清空已嵌入文本段表格内容
@@ -151,7 +169,10 @@ void Expend::embedding_server_start()
         splitLength = ui->embedding_split_spinbox->value();
     }
     if (splitLength <= 0) splitLength = DEFAULT_EMBEDDING_SPLITLENTH;
-    const int ctxSize = std::max(DEFAULT_EMBEDDING_CTX_MIN, splitLength + DEFAULT_EMBEDDING_CTX_PADDING);
+    int ctxSize = std::max(DEFAULT_EMBEDDING_CTX_MIN, splitLength + DEFAULT_EMBEDDING_CTX_PADDING);
+    // 不超过模型训练长度（如 512 的 bert 系），超出时 llama-server 只会告警并浪费 KV
+    const GgufInfo modelInfo = ModelCatalog::shared(applicationDirPath).lookup(embedding_params.modelpath);
+    if (modelInfo.valid && modelInfo.nCtxTrain > 0) ctxSize = std::min(ctxSize, modelInfo.nCtxTrain);
     arguments << "-c" << QString::number(ctxSize);
     arguments << "--parallel" << QString::number(DEFAULT_PARALLEL); // 默认并发：保持与主推理服务一致（默认 1）
 
@@ -283,9 +304,94 @@ void Expend::server_onProcessFinished()
     embedding_server_active = false;
 }
 
+// 用户点击选择/停止重排序模型时响应
+void Expend::on_rerank_modelpath_button_clicked()
+{
+    if (rerank_worker_ && rerank_worker_->isRunning())
+    {
+        stopRerankWorker();
+        return;
+    }
+    const QString path = customOpenfile(currentpath, jtr("select rerank model"), "(*.gguf)");
+    if (path.isEmpty()) return;
+    currentpath = QFileInfo(path).absolutePath();
+    rerank_modelpath_ = path;
+    ui->rerank_model_lineedit->setText(rerank_modelpath_);
+    QSettings settings(applicationDirPath + "/EVA_TEMP/eva_config.ini", QSettings::IniFormat);
+    settings.setIniCodec("utf-8");
+    settings.setValue("rerank_modelpath", rerank_modelpath_);
+    if (!ensureRerankWorker())
+    {
+        ui->embedding_test_log->appendPlainText("[error] llama-server not found under current device folder");
+    }
+}
+
+// 拉起（或复用）常驻重排序服务；模型变化时 ResidentWorker 自动重启
+bool Expend::ensureRerankWorker()
+{
+    if (rerank_modelpath_.isEmpty() || !QFileInfo::exists(rerank_modelpath_)) return false;
+    const QString program = DeviceManager::programPath(QStringLiteral("llama-server-embed"));
+    if (program.isEmpty() || !QFileInfo::exists(program)) return false;
+
+    if (!rerank_worker_)
+    {
+        rerank_worker_ = new ResidentWorker(QStringLiteral("llama-server-rerank"), this);
+        rerank_worker_->setPort(QStringLiteral(DEFAULT_RERANK_PORT));
+        rerank_worker_->setReadyTimeoutMs(DEFAULT_RESIDENT_WORKER_READY_TIMEOUT_MS);
+        rerank_worker_->setIdleTimeoutMs(0); // 工具线程发起请求，无法及时 touch()，与嵌入服务一样常驻
+        connect(rerank_worker_, &ResidentWorker::ready, this, [this](const QString &endpoint)
+                {
+                    ui->rerank_modelpath_button->setText(jtr("abort server"));
+                    ui->embedding_test_log->appendPlainText(jtr("rerank server ready") + ": " + endpoint + DEFAULT_RERANK_API);
+                    emit expend2tool_rerank_endpoint(endpoint + DEFAULT_RERANK_API); });
+        connect(rerank_worker_, &ResidentWorker::failed, this, [this](const QString &reason)
+                {
+                    ui->rerank_modelpath_button->setText("...");
+                    ui->embedding_test_log->appendPlainText(QStringLiteral("[warn] %1").arg(reason));
+                    emit expend2tool_rerank_endpoint(QString()); });
+        connect(rerank_worker_, &ResidentWorker::stopped, this, [this]()
+                {
+                    ui->rerank_modelpath_button->setText("...");
+                    ui->embedding_test_log->appendPlainText(jtr("rerank server stopped"));
+                    emit expend2tool_rerank_endpoint(QString()); });
+        connect(rerank_worker_, &ResidentWorker::output, this, [this](const QString &text)
+                { recv_llama_log(QStringLiteral("[rerank] ") + text); });
+    }
+
+    // 每个候选按“查询 + 文本段”整体编码，上下文与批大小按两倍分块长度估算，保证单条序列放得进一个 ubatch
+    int splitLength = ui->embedding_split_spinbox ? ui->embedding_split_spinbox->value() : DEFAULT_EMBEDDING_SPLITLENTH;
+    if (splitLength <= 0) splitLength = DEFAULT_EMBEDDING_SPLITLENTH;
+    const QString ctxSize = QString::number(std::max(DEFAULT_EMBEDDING_CTX_MIN, splitLength * 2 + DEFAULT_EMBEDDING_CTX_PADDING));
+    QStringList args;
+    args << "-m" << ensureToolFriendlyFilePath(rerank_modelpath_);
+    args << "--host" << "127.0.0.1";
+    args << "--port" << DEFAULT_RERANK_PORT;
+    args << "-c" << ctxSize << "-b" << ctxSize << "-ub" << ctxSize;
+    args << "--parallel" << QString::number(DEFAULT_PARALLEL);
+    args << "-ngl" << QString::number(DEFAULT_EMBEDDING_NGL);
+    args << "--threads" << QString::number(qMax(1, int(max_thread * 0.5)));
+    args << "--reranking";
+    if (!DEFAULT_USE_MMAP) { args << "--no-mmap"; }
+    rerank_worker_->setProgram(program);
+    rerank_worker_->setArguments(args);
+    return rerank_worker_->ensureRunning();
+}
+
+void Expend::stopRerankWorker()
+{
+    if (rerank_worker_) rerank_worker_->stop(); // stopped 信号负责通知工具侧
+}
+
 // 用户点击上传路径时响应
 void Expend::on_embedding_txt_upload_clicked()
 {
+    // 解析进行中按钮充当“取消导入”
+    if (docIngest_ && docIngest_->isRunning())
+    {
+        embedAfterIngest_ = false;
+        docIngest_->cancel();
+        return;
+    }
     QStringList paths = QFileDialog::getOpenFileNames(
         this, jtr("choose files to embed"), currentpath,
         QStringLiteral("Text/Docs (*.txt *.md *.markdown *.html *.htm *.py *.c *.cpp *.cc *.h *.hpp *.json *.js *.ts *.css *.ini *.cfg *.log "
@@ -301,48 +407,6 @@ void Expend::on_embedding_txt_upload_clicked()
     preprocessFiles(upload_paths);
 }
 
-// 分词函数
-QStringList Expend::tokenizeContent(const QString &content)
-{
-    QStringList tokens;
-    // 正则表达式匹配中文、英文单词、Emoji及其他字符
-    QRegularExpression re(
-        "(\\p{Han}+)"                // 中文字符
-        "|([A-Za-z]+)"               // 英文单词
-        "|([\\x{1F300}-\\x{1F5FF}])" // Emoji 范围1
-        "|([\\x{1F600}-\\x{1F64F}])" // Emoji 范围2
-        "|([\\x{1F680}-\\x{1F6FF}])" // Emoji 范围3
-        "|([\\x{2600}-\\x{26FF}])"   // 其他符号
-        "|(\\s+)"                    // 空白字符
-        "|(.)",                      // 其他任意单字符
-        QRegularExpression::UseUnicodePropertiesOption);
-
-    QRegularExpressionMatchIterator it = re.globalMatch(content);
-    while (it.hasNext())
-    {
-        QRegularExpressionMatch match = it.next();
-        if (match.hasMatch())
-        {
-            QString token;
-            if (match.captured(1).length() > 0)
-                token = match.captured(1); // 中文
-            else if (match.captured(2).length() > 0)
-                token = match.captured(2); // 英文单词
-            else if (match.captured(3).length() > 0 ||
-                     match.captured(4).length() > 0 ||
-                     match.captured(5).length() > 0 ||
-                     match.captured(6).length() > 0)
-                token = match.captured(); // Emoji
-            else if (match.captured(7).length() > 0)
-                token = match.captured(7); // 空白
-            else
-                token = match.captured(8); // 其他字符
-            tokens << token;
-        }
-    }
-    return tokens;
-}
-
 // 预处理文件内容
 // 预处理文件内容（多文件，多格式）
 void Expend::preprocessTXT()
@@ -354,87 +418,81 @@ void Expend::preprocessTXT()
 void Expend::preprocessFiles(const QStringList &paths)
 {
     if (paths.isEmpty()) return;
+    ensureDocIngestPipeline();
 
-    // Aggregate all paragraphs from all files
-    QStringList allParagraphs;
-    const int splitLength = ui->embedding_split_spinbox->value();
-    const int overlap = ui->embedding_overlap_spinbox->value();
-
-    auto splitContent = [&](const QString &content)
-    {
-        // tokenize then sliding-window split by character length with overlap
-        const QStringList tokens = tokenizeContent(content);
-        int startTokenIndex = 0;
-        while (startTokenIndex < tokens.size())
-        {
-            int currentLength = 0;
-            int endTokenIndex = startTokenIndex;
-            while (endTokenIndex < tokens.size())
-            {
-                const int tokenLength = tokens[endTokenIndex].length();
-                if (currentLength + tokenLength > splitLength) break;
-                currentLength += tokenLength;
-                ++endTokenIndex;
-            }
-            QString paragraph;
-            for (int i = startTokenIndex; i < endTokenIndex; ++i) paragraph += tokens[i];
-            if (!paragraph.trimmed().isEmpty()) allParagraphs << paragraph;
-            if (endTokenIndex >= tokens.size()) break;
-            int overlapLength = 0;
-            int overlapTokens = 0;
-            while (endTokenIndex - overlapTokens > startTokenIndex && overlapLength < overlap)
-            {
-                overlapLength += tokens[endTokenIndex - 1 - overlapTokens].length();
-                ++overlapTokens;
-            }
-            startTokenIndex = endTokenIndex - overlapTokens;
-        }
-    };
-
-    auto parseFile = [&](const QString &filePath) -> QString
-    {
-        const QByteArray encoded = QFile::encodeName(filePath);
-        if (encoded.isEmpty())
-        {
-            ui->embedding_test_log->appendPlainText(jtr("invalid file path") + ": " + filePath);
-            return {};
-        }
-        const std::string pathStr(encoded.constData(), static_cast<size_t>(encoded.size()));
-        const doc2md::ConversionResult result = doc2md::convertFile(pathStr);
-        for (const std::string &warn : result.warnings)
-        {
-            ui->embedding_test_log->appendPlainText(QStringLiteral("[doc2md] %1").arg(QString::fromStdString(warn)));
-        }
-        if (!result.success || result.markdown.empty())
-        {
-            ui->embedding_test_log->appendPlainText(jtr("doc parse failed") + ": " + filePath);
-            return {};
-        }
-        return QString::fromUtf8(result.markdown.data(), static_cast<int>(result.markdown.size()));
-    };
-
-    // Parse each file to markdown text via doc2md
-    for (const QString &p : paths)
-    {
-        const QString parsed = parseFile(p);
-        if (parsed.isEmpty()) continue;
-        splitContent(parsed);
-    }
-
-    // Show in pending table
+    // 先清空待嵌入表格，解析结果按文件顺序分批追加
     ui->embedding_txt_wait->clear();
     ui->embedding_txt_wait->setColumnCount(1);
-    ui->embedding_txt_wait->setRowCount(allParagraphs.size());
-    for (int i = 0; i < allParagraphs.size(); ++i)
+    ui->embedding_txt_wait->setRowCount(0);
+    ui->embedding_txt_wait->setHorizontalHeaderLabels(QStringList{jtr("embedless text segment")});
+    ui->embedding_txt_embedding->setEnabled(false); // 入库完成前禁止嵌入，避免只嵌入一半
+
+    // 嵌入服务在运行时按其分词器的真实 token 数切分，与服务端上下文（splitLength + padding）口径一致；
+    // 否则沿用按字符切分
+    QUrl tokenizeUrl;
+    if (embedding_server_active)
     {
-        QTableWidgetItem *newItem = new QTableWidgetItem(allParagraphs.at(i));
-        ui->embedding_txt_wait->setItem(i, 0, newItem);
+        tokenizeUrl = QUrl(embedding_server_api);
+        tokenizeUrl.setPath(QStringLiteral(DEFAULT_EMBEDDING_TOKENIZE_API));
+        ui->embedding_test_log->appendPlainText(QStringLiteral("[chunk] token budget %1 via %2")
+                                                    .arg(ui->embedding_split_spinbox->value())
+                                                    .arg(tokenizeUrl.toString()));
     }
-    ui->embedding_txt_wait->resizeRowsToContents();
-    ui->embedding_txt_wait->setHorizontalHeaderLabels(QStringList{jtr("embedless text segment")});
+    docIngestTimer_.start();
+    docIngest_->start(paths, ui->embedding_split_spinbox->value(), ui->embedding_overlap_spinbox->value(), tokenizeUrl);
+    if (docIngest_->isRunning()) ui->embedding_txt_upload->setText(jtr("cancel import"));
+}
 
-    ui->embedding_test_log->appendPlainText(jtr("pending chunks") + ": " + QString::number(allParagraphs.size()));
+void Expend::ensureDocIngestPipeline()
+{
+    if (docIngest_) return;
+    docIngest_ = new DocIngestPipeline(this);
+    connect(docIngest_, &DocIngestPipeline::fileParsed, this, [this](const QString &path, const QStringList &chunks, const QStringList &warnings, bool ok)
+            {
+                for (const QString &warn : warnings)
+                {
+                    ui->embedding_test_log->appendPlainText(QStringLiteral("[doc2md] %1").arg(warn));
+                }
+                if (!ok)
+                {
+                    ui->embedding_test_log->appendPlainText(jtr("doc parse failed") + ": " + path);
+                    return;
+                }
+                if (chunks.isEmpty()) return;
+                // 每个文件一次性追加，暂停重绘；行高在全部完成后统一计算
+                QTableWidget *table = ui->embedding_txt_wait;
+                table->setUpdatesEnabled(false);
+                const int firstRow = table->rowCount();
+                table->setRowCount(firstRow + chunks.size());
+                for (int i = 0; i < chunks.size(); ++i)
+                {
+                    table->setItem(firstRow + i, 0, new QTableWidgetItem(chunks.at(i)));
+                }
+                table->setUpdatesEnabled(true); });
+    connect(docIngest_, &DocIngestPipeline::progress, this, [this](int doneFiles, int totalFiles, int totalChunks)
+            {
+                ui->embedding_txt_wait->setHorizontalHeaderLabels(
+                    QStringList{QStringLiteral("%1 (%2/%3, %4)").arg(jtr("embedless text segment")).arg(doneFiles).arg(totalFiles).arg(totalChunks)}); });
+    connect(docIngest_, &DocIngestPipeline::finished, this, [this](bool canceled, int totalChunks)
+            {
+                ui->embedding_txt_wait->setHorizontalHeaderLabels(QStringList{jtr("embedless text segment")});
+                ui->embedding_txt_wait->resizeRowsToContents();
+                ui->embedding_txt_embedding->setEnabled(true);
+                ui->embedding_txt_upload->setText(QStringLiteral("..."));
+                if (canceled)
+                {
+                    ui->embedding_test_log->appendPlainText(jtr("doc ingest canceled"));
+                    return;
+                }
+                ui->embedding_test_log->appendPlainText(jtr("pending chunks") + ": " + QString::number(totalChunks) +
+                                                        QStringLiteral(" (%1 ms, %2 workers)").arg(docIngestTimer_.elapsed()).arg(docIngest_->maxWorkers()));
+                if (embedAfterIngest_)
+                {
+                    embedAfterIngest_ = false;
+                    embedding_processing();
+                } });
 }
+
 void Expend::show_embedding_txt_wait_menu(const QPoint &pos)
 {
     // 创建菜单并添加动作
@@ -714,6 +772,12 @@ std::vector<std::pair<int, double>> Expend::similar_indices(const std::vector<do
 // 知识库构建过程
 void Expend::embedding_processing()
 {
+    if (docIngest_ && docIngest_->isRunning())
+    {
+        // 文档仍在后台解析：解析完成后自动开始嵌入
+        embedAfterIngest_ = true;
+        return;
+    }
     // 锁定界面
     ui->embedding_txt_upload->setEnabled(0);           // 上传按钮
     ui->embedding_txt_embedding->setEnabled(0);        // 嵌入按钮
@@ -1,8 +1,10 @@
 #include "expend.h"
 
+#include "../service/backend/resident_worker.h"
 #include "../utils/devicemanager.h"
 #include "../utils/pathutil.h"
 #include "ui_expend.h"
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
 #include <src/utils/imagedropwidget.h>
@@ -316,6 +318,80 @@ void Expend::on_sd_open_params_button_clicked()
     sdParamsDialog_->activateWindow();
 }
 
+// 组装与单次生成无关的参数：主模型、可选组件、LoRA 目录与后端开关。
+// CLI 每次绘制都会带上；常驻 sd-server 只在启动时传一次，参数变化才重启。
+QStringList Expend::sdModelArguments(QString *loraPrompt) const
+{
+    QStringList arguments;
+    // main model arg
+    SDModelArgKind argk = sd_run_config_.modelArg;
+    if (argk == SDModelArgKind::Auto)
+    {
+        // Heuristic: prefer --diffusion-model when clip/t5/llm provided or filename hints
+        const bool hasExtra = !sd_run_config_.t5xxlPath.isEmpty() || !sd_run_config_.llmPath.isEmpty() || !sd_run_config_.llmVisionPath.isEmpty() || !sd_run_config_.clipLPath.isEmpty() || !sd_run_config_.clipGPath.isEmpty();
+        if (hasExtra || sd_run_config_.modelPath.contains("flux", Qt::CaseInsensitive) || sd_run_config_.modelPath.contains("qwen", Qt::CaseInsensitive))
+            argk = SDModelArgKind::Diffusion;
+        else
+            argk = SDModelArgKind::LegacyM;
+    }
+    if (argk == SDModelArgKind::Diffusion)
+        arguments << "--diffusion-model" << ensureToolFriendlyFilePath(sd_run_config_.modelPath);
+    else
+        arguments << "-m" << ensureToolFriendlyFilePath(sd_run_config_.modelPath);
+
+    // optional components
+    if (!sd_run_config_.vaePath.isEmpty()) arguments << "--vae" << ensureToolFriendlyFilePath(sd_run_config_.vaePath);
+    if (!sd_run_config_.clipLPath.isEmpty()) arguments << "--clip_l" << ensureToolFriendlyFilePath(sd_run_config_.clipLPath);
+    if (!sd_run_config_.clipGPath.isEmpty()) arguments << "--clip_g" << ensureToolFriendlyFilePath(sd_run_config_.clipGPath);
+    if (!sd_run_config_.clipVisionPath.isEmpty()) arguments << "--clip_vision" << ensureToolFriendlyFilePath(sd_run_config_.clipVisionPath);
+    if (!sd_run_config_.t5xxlPath.isEmpty()) arguments << "--t5xxl" << ensureToolFriendlyFilePath(sd_run_config_.t5xxlPath);
+    if (!sd_run_config_.llmPath.isEmpty()) arguments << "--llm" << ensureToolFriendlyFilePath(sd_run_config_.llmPath);
+    if (!sd_run_config_.llmVisionPath.isEmpty()) arguments << "--llm_vision" << ensureToolFriendlyFilePath(sd_run_config_.llmVisionPath);
+    if (!sd_run_config_.taesdPath.isEmpty()) arguments << "--taesd" << ensureToolFriendlyFilePath(sd_run_config_.taesdPath);
+    if (!sd_run_config_.upscaleModelPath.isEmpty()) arguments << "--upscale-model" << ensureToolFriendlyFilePath(sd_run_config_.upscaleModelPath);
+    if (!sd_run_config_.controlNetPath.isEmpty()) arguments << "--control-net" << ensureToolFriendlyFilePath(sd_run_config_.controlNetPath);
+    if (!sd_run_config_.controlImagePath.isEmpty()) arguments << "--control-image" << ensureToolFriendlyFilePath(sd_run_config_.controlImagePath);
+
+    // LoRA directory (and heuristic prompt injection)
+    if (!sd_run_config_.loraDirPath.isEmpty())
+    {
+        arguments << "--lora-model-dir" << toToolFriendlyPath(sd_run_config_.loraDirPath);
+        // Heuristically pick first .safetensors file name for prompt tag
+        QDir ld(sd_run_config_.loraDirPath);
+        QStringList loraFiles = ld.entryList(QStringList() << "*.safetensors", QDir::Files);
+        if (!loraFiles.isEmpty())
+        {
+            const QString name = QFileInfo(loraFiles.first()).fileName().replace(".safetensors", "");
+            if (loraPrompt) *loraPrompt = QString(" <lora:%1:1>").arg(name);
+        }
+    }
+
+    // Backend toggles
+    if (sd_run_config_.offloadToCpu) arguments << "--offload-to-cpu";
+    if (sd_run_config_.clipOnCpu) arguments << "--clip-on-cpu";
+    if (sd_run_config_.vaeOnCpu) arguments << "--vae-on-cpu";
+    if (sd_run_config_.controlNetOnCpu) arguments << "--control-net-cpu";
+    if (sd_run_config_.diffusionFA) arguments << "--diffusion-fa";
+    if (sd_run_config_.flowShiftEnabled) arguments << "--flow-shift" << QString::number(sd_run_config_.flowShift);
+    if (sd_run_config_.vaeTiling)
+    {
+        arguments << "--vae-tiling";
+        arguments << "--vae-tile-size" << QString("%1x%2").arg(sd_run_config_.vaeTileX).arg(sd_run_config_.vaeTileY);
+        arguments << "--vae-tile-overlap" << QString::number(sd_run_config_.vaeTileOverlap);
+    }
+
+    // threads
+    arguments << "-t" << QString::number(std::thread::hardware_concurrency() * 0.5);
+    return arguments;
+}
+
+QString Expend::sdComposePrompt(const QString &positive, const QString &loraPrompt) const
+{
+    const QString mod = sd_run_config_.modifyPrompt.trimmed();
+    const QString promptCore = (mod.isEmpty() ? positive : (mod + ", " + positive));
+    return promptCore + loraPrompt;
+}
+
 // 用户点击开始绘制时响应
 void Expend::on_sd_draw_pushButton_clicked()
 {
@@ -324,6 +400,7 @@ void Expend::on_sd_draw_pushButton_clicked()
     {
         ui->sd_log->appendPlainText("stop");
         sd_process->kill(); // 强制结束sd
+        cancelSdJobs(QStringLiteral("stablediffusion: stopped by user"));
         ui->sd_draw_pushButton->setText(QStringLiteral("生成"));
         img2img = false;
         return;
@@ -346,6 +423,22 @@ void Expend::on_sd_draw_pushButton_clicked()
         emit expend2ui_state(QString("expend:sd") + SFX_NAME + " " + jtr("drawing"), USUAL_SIGNAL);
     }
 
+    // 常驻 sd-server：模型只加载一次，任务排队执行
+    if (sdResidentEligible() && ensureSdResidentWorker())
+    {
+        QString loraPrompt;
+        sdModelArguments(&loraPrompt);
+        SdJob job;
+        job.invocationId = current_sd_invocation_id_;
+        job.fromTool = !is_handle_sd;
+        job.positive = ui->sd_prompt_textEdit->toPlainText();
+        job.prompt = sdComposePrompt(job.positive, loraPrompt);
+        job.seed = sd_run_config_.seed;
+        job.count = qMax(1, sd_run_config_.batchCount);
+        enqueueSdJob(job);
+        return;
+    }
+
     QTime currentTime = QTime::currentTime();               // 获取当前时间
     QString timeString = currentTime.toString("-hh-mm-ss"); // 格式化时间为时-分-秒
     // Decide output extension by mode (image/video)
@@ -384,52 +477,9 @@ void Expend::on_sd_draw_pushButton_clicked()
         // strength for img2img (from config)
         arguments << "--strength" << QString::number(sd_run_config_.strength);
     }
-    // main model arg
-    SDModelArgKind argk = sd_run_config_.modelArg;
-    if (argk == SDModelArgKind::Auto)
-    {
-        // Heuristic: prefer --diffusion-model when clip/t5/llm provided or filename hints
-        const bool hasExtra = !sd_run_config_.t5xxlPath.isEmpty() || !sd_run_config_.llmPath.isEmpty() || !sd_run_config_.llmVisionPath.isEmpty() || !sd_run_config_.clipLPath.isEmpty() || !sd_run_config_.clipGPath.isEmpty();
-        if (hasExtra || sd_run_config_.modelPath.contains("flux", Qt::CaseInsensitive) || sd_run_config_.modelPath.contains("qwen", Qt::CaseInsensitive))
-            argk = SDModelArgKind::Diffusion;
-        else
-            argk = SDModelArgKind::LegacyM;
-    }
-    if (argk == SDModelArgKind::Diffusion)
-        arguments << "--diffusion-model" << ensureToolFriendlyFilePath(sd_run_config_.modelPath);
-    else
-        arguments << "-m" << ensureToolFriendlyFilePath(sd_run_config_.modelPath);
-
-    // optional components
-    if (!sd_run_config_.vaePath.isEmpty()) arguments << "--vae" << ensureToolFriendlyFilePath(sd_run_config_.vaePath);
-    if (!sd_run_config_.clipLPath.isEmpty()) arguments << "--clip_l" << ensureToolFriendlyFilePath(sd_run_config_.clipLPath);
-    if (!sd_run_config_.clipGPath.isEmpty()) arguments << "--clip_g" << ensureToolFriendlyFilePath(sd_run_config_.clipGPath);
-    if (!sd_run_config_.clipVisionPath.isEmpty()) arguments << "--clip_vision" << ensureToolFriendlyFilePath(sd_run_config_.clipVisionPath);
-    if (!sd_run_config_.t5xxlPath.isEmpty()) arguments << "--t5xxl" << ensureToolFriendlyFilePath(sd_run_config_.t5xxlPath);
-    if (!sd_run_config_.llmPath.isEmpty()) arguments << "--llm" << ensureToolFriendlyFilePath(sd_run_config_.llmPath);
- 
-    if (!sd_run_config_.llmVisionPath.isEmpty()) arguments << "--llm_vision" << ensureToolFriendlyFilePath(sd_run_config_.llmVisionPath);
-    if (!sd_run_config_.taesdPath.isEmpty()) arguments << "--taesd" << ensureToolFriendlyFilePath(sd_run_config_.taesdPath);
-    if (!sd_run_config_.upscaleModelPath.isEmpty()) arguments << "--upscale-model" << ensureToolFriendlyFilePath(sd_run_config_.upscaleModelPath);
-    if (!sd_run_config_.controlNetPath.isEmpty()) arguments << "--control-net" << ensureToolFriendlyFilePath(sd_run_config_.controlNetPath);
-    if (!sd_run_config_.controlImagePath.isEmpty()) arguments << "--control-image" << ensureToolFriendlyFilePath(sd_run_config_.controlImagePath);
-
-    // LoRA directory (and heuristic prompt injection)
+    // 模型、组件与后端开关（与常驻 sd-server 共用同一套参数）
     QString lora_prompt;
-    if (!sd_run_config_.loraDirPath.isEmpty())
-    {
-        arguments << "--lora-model-dir" << toToolFriendlyPath(sd_run_config_.loraDirPath);
-        // Heuristically pick first .safetensors file name for prompt tag
-        QDir ld(sd_run_config_.loraDirPath);
-        QStringList loraFiles = ld.entryList(QStringList() << "*.safetensors", QDir::Files);
-        if (!loraFiles.isEmpty())
-        {
-            const QString name = QFileInfo(loraFiles.first()).fileName().replace(".safetensors", "");
-            lora_prompt = QString(" <lora:%1:1>").arg(name);
-        }
-    }
-    // Also support legacy single-file line edit if provided (backward compat)
-    // Legacy single-file LoRA fallback removed; advanced dialog uses directory
+    arguments << sdModelArguments(&lora_prompt);
 
     // dims and sampling
     arguments << "-W" << QString::number(sd_run_config_.width);
@@ -450,30 +500,9 @@ void Expend::on_sd_draw_pushButton_clicked()
     const QString neg = sd_run_config_.negativePrompt.trimmed();
     if (!neg.isEmpty())
         arguments << "-n" << neg;
-    const QString pos = ui->sd_prompt_textEdit->toPlainText(); // main UI prompt (positive)
-    const QString mod = sd_run_config_.modifyPrompt.trimmed();
-    const QString promptCore = (mod.isEmpty() ? pos : (mod + ", " + pos));
-    if (!lora_prompt.isEmpty())
-        arguments << "-p" << (promptCore + lora_prompt);
-    else
-        arguments << "-p" << promptCore;
+    arguments << "-p" << sdComposePrompt(ui->sd_prompt_textEdit->toPlainText(), lora_prompt); // main UI prompt (positive)
 
-    // Backend toggles
-    if (sd_run_config_.offloadToCpu) arguments << "--offload-to-cpu";
-    if (sd_run_config_.clipOnCpu) arguments << "--clip-on-cpu";
-    if (sd_run_config_.vaeOnCpu) arguments << "--vae-on-cpu";
-    if (sd_run_config_.controlNetOnCpu) arguments << "--control-net-cpu";
-    if (sd_run_config_.diffusionFA) arguments << "--diffusion-fa";
-    if (sd_run_config_.flowShiftEnabled) arguments << "--flow-shift" << QString::number(sd_run_config_.flowShift);
-    if (sd_run_config_.vaeTiling)
-    {
-        arguments << "--vae-tiling";
-        arguments << "--vae-tile-size" << QString("%1x%2").arg(sd_run_config_.vaeTileX).arg(sd_run_config_.vaeTileY);
-        arguments << "--vae-tile-overlap" << QString::number(sd_run_config_.vaeTileOverlap);
-    }
-
-    // threads, output, verbosity
-    arguments << "-t" << QString::number(std::thread::hardware_concurrency() * 0.5);
+    // output, verbosity
     arguments << "-o" << toToolFriendlyPath(sd_outputpath);
     arguments << "-v";
 
@@ -651,20 +680,38 @@ void Expend::sd_onProcessFinished()
             emit expend2tool_drawover(current_sd_invocation_id_, msg, 0); // 绘制完成信号
         }
     }
+    // 从 sd-server 回退下来的任务：上一个结束后接着用 CLI 跑下一个
+    if (!sd_cli_jobs_.isEmpty()) QTimer::singleShot(0, this, &Expend::runNextSdCliJob);
 }
 
 // 接收到tool的开始绘制图像信号
-void Expend::recv_draw(quint64 invocationId, QString prompt_)
+void Expend::recv_draw(quint64 invocationId, QString prompt_, int count, int seed)
 {
-    // 判断是否空闲
-    if (!ui->sd_draw_pushButton->isEnabled())
+    if (sd_run_config_.modelPath.isEmpty())
     {
-        emit expend2tool_drawover(invocationId, "stablediffusion" + jtr("Running, please try again later"), 0); // 绘制完成信号
+        emit expend2tool_drawover(invocationId, jtr("The command is invalid. Please ask the user to specify the SD model path in the breeding window first"), 0); // 绘制完成信号
         return;
     }
-    else if (sd_run_config_.modelPath.isEmpty())
+    // 常驻 sd-server：忙碌时直接排队，同一调用的多张图连续生成
+    if (sdResidentEligible() && ensureSdResidentWorker())
     {
-        emit expend2tool_drawover(invocationId, jtr("The command is invalid. Please ask the user to specify the SD model path in the breeding window first"), 0); // 绘制完成信号
+        QString loraPrompt;
+        sdModelArguments(&loraPrompt);
+        SdJob job;
+        job.invocationId = invocationId;
+        job.fromTool = true;
+        job.positive = prompt_;
+        job.prompt = sdComposePrompt(prompt_, loraPrompt);
+        job.seed = seed >= 0 ? seed : sd_run_config_.seed;
+        job.count = qBound(1, count, DEFAULT_SD_TOOL_MAX_IMAGES);
+        emit expend2ui_state(QString("expend:sd") + SFX_NAME + " " + jtr("drawing"), USUAL_SIGNAL);
+        enqueueSdJob(job);
+        return;
+    }
+    // 判断是否空闲
+    if (!ui->sd_draw_pushButton->isEnabled())
+    {
+        emit expend2tool_drawover(invocationId, "stablediffusion" + jtr("Running, please try again later"), 0); // 绘制完成信号
         return;
     }
     current_sd_invocation_id_ = invocationId;
@@ -675,3 +722,231 @@ void Expend::recv_draw(quint64 invocationId, QString prompt_)
     // 触发绘制
     ui->sd_draw_pushButton->click();
 }
+
+//-------------------------------------------------------------------------
+// 常驻 sd-server：模型常驻，绘制任务排队
+//-------------------------------------------------------------------------
+
+bool Expend::sdResidentEligible() const
+{
+    if (!DEFAULT_SD_RESIDENT_ENABLE || sd_resident_disabled_) return false;
+    if (sd_run_config_.videoFrames > 0) return false;
+    if (sd_imgDrop && QFile::exists(sd_imgDrop->imagePath())) return false;
+    if (!sd_run_config_.controlNetPath.isEmpty() || !sd_run_config_.controlImagePath.isEmpty()) return false;
+    return true;
+}
+
+// 拉起（或复用）常驻 sd-server；预设的模型/组件变化时 ResidentWorker 会自动重启
+bool Expend::ensureSdResidentWorker()
+{
+    const QString program = DeviceManager::programPath(QStringLiteral("sd-server"));
+    if (program.isEmpty() || !QFileInfo::exists(program)) return false;
+
+    if (!sd_worker_)
+    {
+        sd_worker_ = new ResidentWorker(QStringLiteral("sd-server"), this);
+        sd_worker_->setPort(QStringLiteral(DEFAULT_SD_SERVER_PORT));
+        sd_worker_->setProbePath(QStringLiteral("/"));
+        sd_worker_->setProbeExpect(QByteArray()); // sd-server 没有 /health，根路径返回 200 即可
+        sd_worker_->setReadyTimeoutMs(DEFAULT_RESIDENT_WORKER_READY_TIMEOUT_MS);
+        sd_worker_->setIdleTimeoutMs(DEFAULT_RESIDENT_WORKER_IDLE_MS);
+        connect(sd_worker_, &ResidentWorker::ready, this, [this](const QString &endpoint)
+                {
+                    ui->sd_log->appendPlainText(QStringLiteral("[info] sd-server ready: %1").arg(endpoint));
+                    startNextSdJob(); });
+        connect(sd_worker_, &ResidentWorker::failed, this, [this](const QString &reason)
+                {
+                    fallbackSdJobsToCli(reason); });
+        // 服务端日志里带有采样进度条，直接追加到日志区即可看到逐步进度
+        connect(sd_worker_, &ResidentWorker::output, this, [this](const QString &text)
+                {
+                    QTextCursor cursor(ui->sd_log->textCursor());
+                    cursor.movePosition(QTextCursor::End);
+                    cursor.insertText(text);
+                    ui->sd_log->verticalScrollBar()->setValue(ui->sd_log->verticalScrollBar()->maximum()); });
+        sd_net_ = new QNetworkAccessManager(this);
+    }
+
+    QStringList args = sdModelArguments(nullptr);
+    args << "--listen-ip" << "127.0.0.1" << "--listen-port" << QStringLiteral(DEFAULT_SD_SERVER_PORT);
+    sd_worker_->setProgram(program);
+    sd_worker_->setArguments(args);
+    return sd_worker_->ensureRunning();
+}
+
+void Expend::enqueueSdJob(const SdJob &job)
+{
+    sd_jobs_.append(job);
+    ui->sd_draw_pushButton->setText("stop");
+    if (sd_job_running_)
+        ui->sd_log->appendPlainText(QStringLiteral("[queue] %1 job(s) waiting").arg(sd_jobs_.size()));
+    startNextSdJob();
+}
+
+void Expend::startNextSdJob()
+{
+    if (sd_job_running_ || sd_jobs_.isEmpty()) return;
+    if (!sd_worker_ || !sd_worker_->isReady()) return; // 模型加载中，ready 后再开始
+    sd_current_job_ = sd_jobs_.takeFirst();
+    sd_job_running_ = true;
+    sd_job_outputs_.clear();
+    postSdResidentImage();
+}
+
+void Expend::postSdResidentImage()
+{
+    const int index = sd_job_outputs_.size();
+    const SdJob &job = sd_current_job_;
+    sd_worker_->touch();
+
+    QJsonObject body;
+    body.insert(QStringLiteral("prompt"), job.prompt);
+    const QString neg = sd_run_config_.negativePrompt.trimmed();
+    if (!neg.isEmpty()) body.insert(QStringLiteral("negative_prompt"), neg);
+    body.insert(QStringLiteral("width"), sd_run_config_.width);
+    body.insert(QStringLiteral("height"), sd_run_config_.height);
+    body.insert(QStringLiteral("steps"), sd_run_config_.steps);
+    body.insert(QStringLiteral("cfg_scale"), sd_run_config_.cfgScale);
+    body.insert(QStringLiteral("sampler_name"), sd_run_config_.sampler);
+    if (!sd_run_config_.scheduler.isEmpty()) body.insert(QStringLiteral("scheduler"), sd_run_config_.scheduler);
+    body.insert(QStringLiteral("clip_skip"), sd_run_config_.clipSkip);
+    // 固定种子时逐张递增，得到可复现的种子扫描；-1 交给服务端随机
+    body.insert(QStringLiteral("seed"), job.seed < 0 ? -1 : job.seed + index);
+    body.insert(QStringLiteral("batch_size"), 1);
+
+    ui->sd_log->appendPlainText(QStringLiteral("[sd-server] image %1/%2").arg(index + 1).arg(job.count));
+    if (job.fromTool)
+        emit expend2ui_state(QString("expend:sd") + SFX_NAME + " " + jtr("drawing") + QStringLiteral(" %1/%2").arg(index + 1).arg(job.count), USUAL_SIGNAL);
+
+    QNetworkRequest req(QUrl(sd_worker_->endpointBase() + QStringLiteral(DEFAULT_SD_SERVER_API)));
+    req.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+    QNetworkReply *reply = sd_net_->post(req, QJsonDocument(body).toJson(QJsonDocument::Compact));
+    sd_reply_ = reply;
+    connect(reply, &QNetworkReply::finished, this, [this, reply]()
+            { onSdResidentReplyFinished(reply); });
+}
+
+void Expend::onSdResidentReplyFinished(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    if (sd_reply_ == reply) sd_reply_.clear();
+    if (!sd_job_running_ || reply->error() == QNetworkReply::OperationCanceledError) return;
+
+    const int code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QJsonObject obj = QJsonDocument::fromJson(reply->readAll()).object();
+    // 兼容 A1111 风格 {"images":[b64]} 与 OpenAI 风格 {"data":[{"b64_json":...}]}
+    QString b64 = obj.value(QStringLiteral("images")).toArray().at(0).toString();
+    if (b64.isEmpty()) b64 = obj.value(QStringLiteral("data")).toArray().at(0).toObject().value(QStringLiteral("b64_json")).toString();
+    const QByteArray png = QByteArray::fromBase64(b64.toLatin1());
+
+    if (reply->error() != QNetworkReply::NoError || code >= 400 || png.isEmpty())
+    {
+        if (sd_worker_) sd_worker_->stop();
+        fallbackSdJobsToCli(QStringLiteral("sd-server failed (http=%1, %2)").arg(code).arg(reply->errorString()));
+        return;
+    }
+
+    if (sdOutputDir.isEmpty()) sdOutputDir = QDir(applicationDirPath).filePath(EVA_TEMP_SD_DIR_RELATIVE);
+    createTempDirectory(sdOutputDir);
+    const QString path = QDir(sdOutputDir).filePath(QStringLiteral("sd_output-%1-%2.png")
+                                                        .arg(QDateTime::currentDateTime().toString("hh-mm-ss-zzz"))
+                                                        .arg(sd_job_outputs_.size() + 1));
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly))
+    {
+        file.write(png);
+        file.close();
+        sd_job_outputs_ << path;
+        sd_outputpath = path;
+        if (sd_mediaResult) sd_mediaResult->addImage(path);
+    }
+    else
+    {
+        ui->sd_log->appendPlainText("[error] cannot write sd output: " + path);
+        finishSdJob(false, jtr("draw fail prompt"));
+        return;
+    }
+
+    if (sd_job_outputs_.size() < sd_current_job_.count)
+        postSdResidentImage(); // 同一任务的下一张：模型已在显存中，直接开始采样
+    else
+        finishSdJob(true, QString());
+}
+
+void Expend::finishSdJob(bool ok, const QString &detail)
+{
+    const SdJob job = sd_current_job_;
+    sd_job_running_ = false;
+    sd_current_job_ = SdJob();
+    if (job.fromTool)
+    {
+        if (ok)
+        {
+            emit expend2ui_state("expend:" + jtr("draw over"), USUAL_SIGNAL);
+            emit expend2tool_drawover(job.invocationId, sd_job_outputs_.join(QLatin1Char('\n')), 1); // 多张图按行分隔
+        }
+        else
+        {
+            emit expend2ui_state("expend:" + detail, WRONG_SIGNAL);
+            emit expend2tool_drawover(job.invocationId, detail, 0);
+        }
+    }
+    if (sd_jobs_.isEmpty()) ui->sd_draw_pushButton->setText(QStringLiteral("生成"));
+    startNextSdJob();
+}
+
+void Expend::fallbackSdJobsToCli(const QString &reason)
+{
+    ui->sd_log->appendPlainText(QStringLiteral("[warn] %1; fallback to sd cli").arg(reason));
+    sd_resident_disabled_ = true;
+    if (sd_reply_)
+    {
+        QNetworkReply *reply = sd_reply_;
+        sd_reply_.clear();
+        const QSignalBlocker blocker(reply);
+        reply->abort();
+        reply->deleteLater();
+    }
+    // 在途任务排在最前重做，排队任务随后；CLI 一次只跑一个，由 sd_onProcessFinished 接着启动下一个
+    if (sd_job_running_) sd_cli_jobs_ << sd_current_job_;
+    sd_cli_jobs_ << sd_jobs_;
+    sd_jobs_.clear();
+    sd_job_running_ = false;
+    sd_current_job_ = SdJob();
+    if (sd_process->state() == QProcess::NotRunning) runNextSdCliJob();
+}
+
+void Expend::runNextSdCliJob()
+{
+    if (sd_cli_jobs_.isEmpty()) return;
+    const SdJob job = sd_cli_jobs_.takeFirst();
+    ui->sd_prompt_textEdit->setText(job.positive);
+    current_sd_invocation_id_ = job.invocationId;
+    is_handle_sd = !job.fromTool;
+    ui->sd_draw_pushButton->setText(QStringLiteral("生成"));
+    ui->sd_draw_pushButton->click();
+}
+
+void Expend::cancelSdJobs(const QString &reason)
+{
+    if (sd_reply_)
+    {
+        QNetworkReply *reply = sd_reply_;
+        sd_reply_.clear();
+        const QSignalBlocker blocker(reply);
+        reply->abort();
+        reply->deleteLater();
+    }
+    QList<SdJob> pending = sd_jobs_;
+    sd_jobs_.clear();
+    if (sd_job_running_) pending.prepend(sd_current_job_);
+    pending << sd_cli_jobs_;
+    sd_cli_jobs_.clear();
+    sd_job_running_ = false;
+    sd_current_job_ = SdJob();
+    for (const SdJob &job : pending)
+    {
+        if (job.fromTool) emit expend2tool_drawover(job.invocationId, reason, 0);
+    }
+    ui->sd_draw_pushButton->setText(QStringLiteral("生成"));
+}
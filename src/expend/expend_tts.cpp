@@ -3,6 +3,7 @@
 
 #include "ui_expend.h"
 // Bring in backend path resolver and path helpers to run tts.cpp robustly
+#include "../service/backend/resident_worker.h"
 #include "../utils/devicemanager.h"
 #include "../utils/pathutil.h"
 #include <QDateTime>
@@ -17,6 +18,29 @@
 
 namespace
 {
+// tts.cpp 语言偏好（数字读法等）：按界面语言映射 zh/en/ja，未知值兜底为 en
+QString ttscppLangForUi(int languageFlag)
+{
+    if (languageFlag == EVA_LANG_ZH) return QStringLiteral("zh");
+    if (languageFlag == EVA_LANG_JA) return QStringLiteral("ja");
+    return QStringLiteral("en");
+}
+
+// 在 [minPos, maxPos] 内寻找第一个句末标点，返回切分位置（标点之后）；找不到返回 -1
+int findSentenceCut(const QString &text, int minPos, int maxPos)
+{
+    const int end = qMin(maxPos, text.size() - 1);
+    for (int i = qMax(0, minPos); i <= end; ++i)
+    {
+        const QChar c = text.at(i);
+        if (c == QChar(0x3002) || c == QChar(0xFF01) || c == QChar(0xFF1F) || c == QChar(0xFF1B) ||
+            c == QLatin1Char('!') || c == QLatin1Char('?') || c == QLatin1Char(';') || c == QLatin1Char('\n'))
+            return i + 1;
+        if (c == QLatin1Char('.') && (i + 1 >= text.size() || text.at(i + 1).isSpace())) return i + 1;
+    }
+    return -1;
+}
+
 // 判断一行输出是否“像”一个音色 id（tts.cpp 的 voice id 通常是纯英文/数字/下划线组合）
 // 说明：这里不用 QRegularExpression，避免引入 PCRE2 JIT 的兼容性风险。
 bool isTtscppVoiceIdCandidate(const QString &s)
@@ -521,8 +545,7 @@ void Expend::speech_process()
         {
             speechTimer.stop();
             is_speech = true;
-            start_tts(wait_speech_txt_list.first());
-            wait_speech_txt_list.removeFirst();
+            start_tts(takeNextTtsSegment());
         }
     }
 }
@@ -537,8 +560,8 @@ void Expend::speech_play_process()
             speechPlayTimer.stop();
             is_speech_play = true;
             // 播放第一路径的音频
-            speech_player->setMedia(QUrl::fromLocalFile(wait_speech_play_list.first()));
-            speech_player->play();
+            speechPlayer()->setMedia(QUrl::fromLocalFile(wait_speech_play_list.first()));
+            speechPlayer()->play();
             wait_speech_play_list.removeFirst();
         }
     }
@@ -918,6 +941,16 @@ void Expend::recv_resettts()
             tts_process->waitForFinished(150);
         }
     }
+    // 常驻 tts-server：只中止在途请求，进程保持常驻，下一轮无需重新加载模型
+    tts_resident_pending_text_.clear();
+    if (tts_reply_)
+    {
+        QNetworkReply *reply = tts_reply_;
+        tts_reply_.clear();
+        const QSignalBlocker blocker(reply);
+        reply->abort();
+        reply->deleteLater();
+    }
     // 停止正在播放的音频
     if (speech_player) speech_player->stop();
     is_speech = false;
@@ -930,7 +963,7 @@ void Expend::recv_resettts()
     speechPlayTimer.start(500);
 }
 
-// Run tts.cpp CLI to synthesize speech
+// 合成入口：优先交给常驻 tts-server（模型只加载一次），不可用时回退到逐段 tts-cli
 void Expend::runTtsProcess(const QString &text)
 {
     const QString modelPath = ui->speech_ttscpp_modelpath_lineEdit->text().trimmed();
@@ -941,6 +974,28 @@ void Expend::runTtsProcess(const QString &text)
         return;
     }
 
+    if (ensureTtsResidentWorker())
+    {
+        if (tts_worker_->isReady())
+            postTtsResidentRequest(text);
+        else
+            tts_resident_pending_text_ = text; // 服务就绪后由 onTtsResidentReady 发出
+        return;
+    }
+    runTtsCliProcess(text);
+}
+
+// Run tts.cpp CLI to synthesize speech
+void Expend::runTtsCliProcess(const QString &text)
+{
+    const QString modelPath = ui->speech_ttscpp_modelpath_lineEdit->text().trimmed();
+    if (!QFileInfo::exists(modelPath))
+    {
+        ui->speech_log->appendPlainText("[error] tts.cpp model path not found");
+        speechOver();
+        return;
+    }
+
     const QString program = DeviceManager::programPath(QStringLiteral("tts-cli"));
     if (program.isEmpty() || !QFileInfo::exists(program))
     {
@@ -975,10 +1030,7 @@ void Expend::runTtsProcess(const QString &text)
     // - 英文/日文界面：en（兜底到英文读法，避免日文界面仍用中文数字读法）
     // ---------------------------------------------------------------------
     // tts.cpp 当前支持 `--lang zh/en/ja`：按界面语言自动映射，未知值兜底为 en。
-    QString ttsLang = QStringLiteral("en");
-    if (language_flag == EVA_LANG_ZH) ttsLang = QStringLiteral("zh");
-    else if (language_flag == EVA_LANG_JA) ttsLang = QStringLiteral("ja");
-    arguments << QStringLiteral("--lang") << ttsLang;
+    arguments << QStringLiteral("--lang") << ttscppLangForUi(language_flag);
 
     arguments << QStringLiteral("-p") << text;
 
@@ -1117,8 +1169,7 @@ void Expend::startNextTTSIfIdle()
     if (!is_speech && !wait_speech_txt_list.isEmpty())
     {
         is_speech = true;
-        const QString seg = wait_speech_txt_list.takeFirst();
-        start_tts(seg);
+        start_tts(takeNextTtsSegment());
     }
 }
 
@@ -1128,10 +1179,141 @@ void Expend::startNextPlayIfIdle()
     {
         is_speech_play = true;
         const QString path = wait_speech_play_list.takeFirst();
-        speech_player->setMedia(QUrl::fromLocalFile(path));
-        speech_player->play();
+        speechPlayer()->setMedia(QUrl::fromLocalFile(path));
+        speechPlayer()->play();
     }
 }
 
+// 取下一段待合成文本。常驻服务已就绪时，把过长的段落在首个句末标点处切开：
+// 首句尽快送去合成并开始播放，其余部分留在队首，与播放重叠进行。
+QString Expend::takeNextTtsSegment()
+{
+    QString seg = wait_speech_txt_list.takeFirst();
+    const bool resident = tts_worker_ && tts_worker_->isReady() &&
+                          speech_params.speech_source == QLatin1String(SPPECH_TTSCPP);
+    if (!resident || seg.size() <= DEFAULT_TTS_RESIDENT_SENTENCE_SPLIT) return seg;
+    const int cut = findSentenceCut(seg, DEFAULT_TTS_RESIDENT_SENTENCE_SPLIT / 8, DEFAULT_TTS_RESIDENT_SENTENCE_SPLIT);
+    if (cut <= 0 || cut >= seg.size()) return seg;
+    const QString rest = seg.mid(cut).trimmed();
+    if (!rest.isEmpty()) wait_speech_txt_list.prepend(rest);
+    return seg.left(cut).trimmed();
+}
+
+// 拉起（或复用）常驻 tts-server；返回 false 表示不可用，调用方回退到 tts-cli
+bool Expend::ensureTtsResidentWorker()
+{
+    if (!DEFAULT_TTS_RESIDENT_ENABLE || tts_resident_disabled_) return false;
+    const QString program = DeviceManager::programPath(QStringLiteral("tts-server"));
+    if (program.isEmpty() || !QFileInfo::exists(program)) return false;
+    const QString modelPath = ui->speech_ttscpp_modelpath_lineEdit->text().trimmed();
 
+    if (!tts_worker_)
+    {
+        tts_worker_ = new ResidentWorker(QStringLiteral("tts-server"), this);
+        tts_worker_->setPort(QStringLiteral(DEFAULT_TTS_SERVER_PORT));
+        tts_worker_->setReadyTimeoutMs(DEFAULT_RESIDENT_WORKER_READY_TIMEOUT_MS);
+        tts_worker_->setIdleTimeoutMs(DEFAULT_RESIDENT_WORKER_IDLE_MS);
+        connect(tts_worker_, &ResidentWorker::ready, this, [this](const QString &)
+                { onTtsResidentReady(); });
+        connect(tts_worker_, &ResidentWorker::failed, this, &Expend::onTtsResidentFailed);
+        connect(tts_worker_, &ResidentWorker::output, this, [this](const QString &text)
+                { ui->speech_log->appendPlainText(text.trimmed()); });
+        tts_net_ = new QNetworkAccessManager(this);
+    }
 
+    // 音色与语言随请求下发；只有模型变化才需要重启服务
+    QStringList args;
+    args << QStringLiteral("--model-path") << ensureToolFriendlyFilePath(modelPath)
+         << QStringLiteral("--host") << QStringLiteral("127.0.0.1")
+         << QStringLiteral("--port") << QStringLiteral(DEFAULT_TTS_SERVER_PORT);
+    tts_worker_->setProgram(program);
+    tts_worker_->setArguments(args);
+    return tts_worker_->ensureRunning();
+}
+
+void Expend::postTtsResidentRequest(const QString &text)
+{
+    if (!tts_worker_ || !tts_net_)
+    {
+        runTtsCliProcess(text);
+        return;
+    }
+    tts_worker_->touch();
+
+    QJsonObject body;
+    body.insert(QStringLiteral("input"), text);
+    const QString voice = speech_params.ttscpp_voice.trimmed();
+    if (!voice.isEmpty()) body.insert(QStringLiteral("voice"), voice);
+    body.insert(QStringLiteral("response_format"), QStringLiteral("wav"));
+    body.insert(QStringLiteral("lang"), ttscppLangForUi(language_flag));
+
+    QNetworkRequest req(QUrl(tts_worker_->endpointBase() + QStringLiteral(DEFAULT_TTS_SERVER_API)));
+    req.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+    QNetworkReply *reply = tts_net_->post(req, QJsonDocument(body).toJson(QJsonDocument::Compact));
+    tts_reply_ = reply;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, text]()
+            { onTtsResidentReplyFinished(reply, text); });
+}
+
+void Expend::onTtsResidentReady()
+{
+    ui->speech_log->appendPlainText(QStringLiteral("[info] tts-server ready: %1").arg(tts_worker_->endpointBase()));
+    if (tts_resident_pending_text_.isEmpty()) return;
+    const QString text = tts_resident_pending_text_;
+    tts_resident_pending_text_.clear();
+    postTtsResidentRequest(text);
+}
+
+void Expend::onTtsResidentFailed(const QString &reason)
+{
+    // 本次会话内不再尝试常驻服务，后续段落全部走 tts-cli
+    ui->speech_log->appendPlainText(QStringLiteral("[warn] %1; fallback to tts-cli").arg(reason));
+    tts_resident_disabled_ = true;
+    if (tts_resident_pending_text_.isEmpty()) return;
+    const QString text = tts_resident_pending_text_;
+    tts_resident_pending_text_.clear();
+    runTtsCliProcess(text);
+}
+
+void Expend::onTtsResidentReplyFinished(QNetworkReply *reply, const QString &text)
+{
+    reply->deleteLater();
+    if (tts_reply_ == reply) tts_reply_.clear();
+    if (tts_resetting_ || reply->error() == QNetworkReply::OperationCanceledError)
+    {
+        is_speech = false;
+        return;
+    }
+
+    const int code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QByteArray audio = reply->readAll();
+    if (reply->error() != QNetworkReply::NoError || code >= 400 || audio.isEmpty())
+    {
+        ui->speech_log->appendPlainText(QStringLiteral("[warn] tts-server synthesis failed (http=%1, %2); fallback to tts-cli")
+                                            .arg(code)
+                                            .arg(reply->errorString()));
+        tts_resident_disabled_ = true;
+        if (tts_worker_) tts_worker_->stop();
+        runTtsCliProcess(text);
+        return;
+    }
+
+    createTempDirectory(ttsOutputDir);
+    static int residentSeq = 0;
+    ttsLastOutputFile = QDir(ttsOutputDir).filePath(QDateTime::currentDateTime().toString("yyyyMMddHHmmsszzz") +
+                                                    QStringLiteral("_%1.wav").arg(++residentSeq));
+    QFile file(ttsLastOutputFile);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        ui->speech_log->appendPlainText("[error] cannot write tts output: " + ttsLastOutputFile);
+        speechOver();
+        return;
+    }
+    file.write(audio);
+    file.close();
+
+    // 先入播放队列再推进下一段合成：第一句播放的同时，后续句子已在服务端合成
+    wait_speech_play_list << ttsLastOutputFile;
+    startNextPlayIfIdle();
+    speechOver();
+}
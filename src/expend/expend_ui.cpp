@@ -101,6 +101,8 @@ void Expend::init_expend()
     ui->embedding_result_groupBox->setTitle(jtr("retrieval result"));
     ui->embedding_log_groupBox->setTitle(jtr("log"));
     ui->embedding_resultnumb_label->setText(jtr("resultnumb"));
+    ui->rerank_model_label->setText(jtr("rerank model"));
+    ui->rerank_model_lineedit->setPlaceholderText(jtr("rerank_model_lineedit_placeholder"));
     setSpacing(ui->embedding_test_result, 1.2);
     setSpacing(ui->embedding_test_textEdit, 1.2);
     ui->sd_result_groupBox->setTitle(jtr("result"));
@@ -539,6 +541,13 @@ void Expend::readConfig()
     ui->embedding_split_spinbox->setValue(settings.value("embedding_split", DEFAULT_EMBEDDING_SPLITLENTH).toInt());
     ui->embedding_resultnumb_spinBox->setValue(settings.value("embedding_resultnumb", DEFAULT_EMBEDDING_RESULTNUMB).toInt());
     ui->embedding_overlap_spinbox->setValue(settings.value("embedding_overlap", DEFAULT_EMBEDDING_OVERLAP).toInt());
+    // 重排序模型：随嵌入服务自启动（见 tryAutoStartEmbeddingServer）
+    const QString rerank_modelpath = settings.value("rerank_modelpath", "").toString();
+    if (QFileInfo::exists(rerank_modelpath))
+    {
+        rerank_modelpath_ = rerank_modelpath;
+        ui->rerank_model_lineedit->setText(rerank_modelpath_);
+    }
     const int embedding_dim = settings.value("embedding_dim", DEFAULT_EMBEDDING_DIM).toInt();
     // 避免初始化时触发维度变更逻辑：先暂时压制信号，再同步默认维度
     const bool prev_keep = keep_embedding_server;
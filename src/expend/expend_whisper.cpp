@@ -1,10 +1,13 @@
 #include "expend.h"
 
-#include "../utils/devicemanager.h"
-#include "../utils/pathutil.h"
-#include "../utils/textspacing.h"
+#include "../service/backend/resident_worker.h"
+#include "../utils/devicemanager.h"
+#include "../utils/pathutil.h"
+#include "../utils/textspacing.h"
 #include "ui_expend.h"
 
+#include <QHttpMultiPart>
+
 //-------------------------------------------------------------------------
 //----------------------------------声转文相关--------------------------------
 //-------------------------------------------------------------------------
@@ -31,6 +34,26 @@ void Expend::recv_speechdecode(QString wavpath, QString out_format)
 {
     whisper_time.restart();
 
+    // 常驻 whisper-server 已就绪：录音转写直接走本地 HTTP，省去每次重新加载模型
+    if (!is_handle_whisper && out_format == QLatin1String("txt") && whisper_worker_ && whisper_worker_->isReady())
+    {
+        QFile wav(wavpath);
+        WavPcm16 audio;
+        // QAudioRecorder 回退路径录出的 wav 未必是 16kHz/mono，先在本地转换；解析失败则交给 whisper-cli
+        if (wav.open(QIODevice::ReadOnly) && parseWavPcm16(wav.readAll(), &audio))
+        {
+            if (audio.sampleRate != DEFAULT_WHISPER_SAMPLE_RATE || audio.channels != 1)
+                audio.pcm = resamplePcm16Mono(audio.pcm, audio.sampleRate, audio.channels, DEFAULT_WHISPER_SAMPLE_RATE);
+            abortWhisperReply();
+            whisper_stream_wavpath_ = wavpath;
+            whisper_stream_.reset();
+            whisper_stream_active_ = true;
+            whisper_stream_ending_ = true;
+            postWhisperInference(pcm16ToWav(audio.pcm, DEFAULT_WHISPER_SAMPLE_RATE), WhisperRequestKind::Final);
+            return;
+        }
+    }
+
     const QString localPath = DeviceManager::programPath(QStringLiteral("whisper-cli"));
 
     // 录音/输入音频交由 whisper-cli 处理采样率，无需在应用内重采样
@@ -150,3 +173,199 @@ void Expend::on_whisper_execute_pushbutton_clicked()
     whisper_process->kill();
     recv_speechdecode(ui->whisper_wavpath_lineedit->text(), ui->whisper_output_format->currentText());
 }
+
+//-------------------------------------------------------------------------
+// 流式转写：录音期间把 PCM 片段交给常驻 whisper-server
+//-------------------------------------------------------------------------
+
+// 拉起（或复用）常驻 whisper-server；返回 false 表示不可用，调用方回退到 whisper-cli
+bool Expend::ensureWhisperResidentWorker()
+{
+    if (!DEFAULT_WHISPER_RESIDENT_ENABLE || whisper_resident_disabled_) return false;
+    const QString program = DeviceManager::programPath(QStringLiteral("whisper-server"));
+    if (program.isEmpty() || !QFileInfo::exists(program)) return false;
+    const QString modelPath = ui->whisper_load_modelpath_linedit->text().trimmed();
+    if (!QFileInfo::exists(modelPath)) return false;
+
+    if (!whisper_worker_)
+    {
+        whisper_worker_ = new ResidentWorker(QStringLiteral("whisper-server"), this);
+        whisper_worker_->setPort(QStringLiteral(DEFAULT_WHISPER_SERVER_PORT));
+        whisper_worker_->setReadyTimeoutMs(DEFAULT_RESIDENT_WORKER_READY_TIMEOUT_MS);
+        whisper_worker_->setIdleTimeoutMs(DEFAULT_RESIDENT_WORKER_IDLE_MS);
+        connect(whisper_worker_, &ResidentWorker::ready, this, [this](const QString &endpoint)
+                {
+                    ui->whisper_log->appendPlainText(QStringLiteral("[info] whisper-server ready: %1").arg(endpoint));
+                    // 模型加载期间用户可能已经松开 F2：此时补发最终识别
+                    if (whisper_stream_active_ && whisper_stream_ending_ && !whisper_reply_) startWhisperStreamFinal();
+                    else maybeRequestWhisperPartial(); });
+        connect(whisper_worker_, &ResidentWorker::failed, this, [this](const QString &reason)
+                {
+                    ui->whisper_log->appendPlainText(QStringLiteral("[warn] %1; fallback to whisper-cli").arg(reason));
+                    whisper_resident_disabled_ = true;
+                    if (whisper_stream_active_ && whisper_stream_ending_)
+                    {
+                        whisper_stream_active_ = false;
+                        recv_speechdecode(whisper_stream_wavpath_, QStringLiteral("txt"));
+                    } });
+        connect(whisper_worker_, &ResidentWorker::output, this, [this](const QString &text)
+                { ui->whisper_log->appendPlainText(text.trimmed()); });
+        whisper_net_ = new QNetworkAccessManager(this);
+    }
+
+    QStringList args;
+    args << QStringLiteral("-m") << ensureToolFriendlyFilePath(modelPath)
+         << QStringLiteral("--host") << QStringLiteral("127.0.0.1")
+         << QStringLiteral("--port") << QStringLiteral(DEFAULT_WHISPER_SERVER_PORT)
+         << QStringLiteral("-l") << QString::fromStdString(whisper_params.language)
+         << QStringLiteral("-t") << QString::number(qMax(1, int(max_thread * 0.5)));
+    whisper_worker_->setProgram(program);
+    whisper_worker_->setArguments(args);
+    return whisper_worker_->ensureRunning();
+}
+
+void Expend::abortWhisperReply()
+{
+    if (!whisper_reply_) return;
+    QNetworkReply *reply = whisper_reply_;
+    whisper_reply_.clear();
+    const QSignalBlocker blocker(reply);
+    reply->abort();
+    reply->deleteLater();
+}
+
+void Expend::postWhisperInference(const QByteArray &wav, WhisperRequestKind kind)
+{
+    if (!whisper_worker_ || !whisper_net_) return;
+    whisper_worker_->touch();
+
+    QHttpMultiPart *multi = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    QHttpPart filePart;
+    filePart.setHeader(QNetworkRequest::ContentDispositionHeader, QStringLiteral("form-data; name=\"file\"; filename=\"EVA_.wav\""));
+    filePart.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("audio/wav"));
+    filePart.setBody(wav);
+    multi->append(filePart);
+    auto addField = [multi](const QString &name, const QString &value)
+    {
+        QHttpPart part;
+        part.setHeader(QNetworkRequest::ContentDispositionHeader, QStringLiteral("form-data; name=\"%1\"").arg(name));
+        part.setBody(value.toUtf8());
+        multi->append(part);
+    };
+    addField(QStringLiteral("response_format"), QStringLiteral("json"));
+    addField(QStringLiteral("temperature"), QStringLiteral("0.0"));
+    addField(QStringLiteral("language"), QString::fromStdString(whisper_params.language));
+
+    QNetworkRequest req(QUrl(whisper_worker_->endpointBase() + QStringLiteral(DEFAULT_WHISPER_SERVER_API)));
+    QNetworkReply *reply = whisper_net_->post(req, multi);
+    multi->setParent(reply);
+    whisper_reply_ = reply;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, kind]()
+            { onWhisperReplyFinished(reply, kind); });
+}
+
+void Expend::onWhisperReplyFinished(QNetworkReply *reply, WhisperRequestKind kind)
+{
+    reply->deleteLater();
+    if (whisper_reply_ == reply) whisper_reply_.clear();
+    if (!whisper_stream_active_ || reply->error() == QNetworkReply::OperationCanceledError) return;
+
+    const int code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QJsonObject obj = QJsonDocument::fromJson(reply->readAll()).object();
+    const bool ok = reply->error() == QNetworkReply::NoError && code < 400 && obj.contains(QStringLiteral("text"));
+    const QString text = obj.value(QStringLiteral("text")).toString().simplified();
+
+    if (kind == WhisperRequestKind::Final)
+    {
+        if (!ok)
+        {
+            ui->whisper_log->appendPlainText(QStringLiteral("[warn] whisper-server inference failed (http=%1, %2); fallback to whisper-cli")
+                                                 .arg(code)
+                                                 .arg(reply->errorString()));
+            whisper_resident_disabled_ = true;
+            whisper_stream_active_ = false;
+            if (whisper_worker_) whisper_worker_->stop();
+            recv_speechdecode(whisper_stream_wavpath_, QStringLiteral("txt"));
+            return;
+        }
+        finishWhisperStream(text);
+        return;
+    }
+
+    // 部分结果失败不影响录音，等下一步长再试
+    if (ok)
+    {
+        whisper_stream_.acceptPartial(text);
+        emit expend2ui_speechdecode_partial(whisper_stream_.text());
+    }
+    if (whisper_stream_ending_)
+        startWhisperStreamFinal();
+    else
+        maybeRequestWhisperPartial();
+}
+
+void Expend::maybeRequestWhisperPartial()
+{
+    if (!whisper_stream_active_ || whisper_stream_ending_ || whisper_reply_) return;
+    if (!whisper_worker_ || !whisper_worker_->isReady()) return;
+    QByteArray pcm;
+    if (!whisper_stream_.takePartial(&pcm)) return;
+    postWhisperInference(pcm16ToWav(pcm, DEFAULT_WHISPER_SAMPLE_RATE), WhisperRequestKind::Partial);
+}
+
+void Expend::startWhisperStreamFinal()
+{
+    if (!whisper_stream_active_) return;
+    // 最近一次部分识别已覆盖整个窗口：直接用它作为尾段，无需再请求
+    if (!whisper_stream_.hasUnsentAudio())
+    {
+        finishWhisperStream(whisper_stream_.partial());
+        return;
+    }
+    if (!whisper_worker_ || !whisper_worker_->isReady()) return; // 等 ready 回调再发
+    QByteArray pcm;
+    whisper_stream_.takeFinal(&pcm);
+    postWhisperInference(pcm16ToWav(pcm, DEFAULT_WHISPER_SAMPLE_RATE), WhisperRequestKind::Final);
+}
+
+void Expend::finishWhisperStream(const QString &tail)
+{
+    const QString content = whisper_stream_.finish(tail);
+    whisper_stream_active_ = false;
+    whisper_stream_ending_ = false;
+    emit expend2ui_state("expend:" + jtr("decode over") + " " + QString::number(whisper_time.nsecsElapsed() / 1000000000.0, 'f', 2) + "s ->" + content, SUCCESS_SIGNAL);
+    emit expend2ui_speechdecode_over(content);
+}
+
+// 录音开始：提前拉起常驻服务，模型加载与用户说话并行
+void Expend::recv_speechstream_begin()
+{
+    abortWhisperReply();
+    whisper_stream_.reset();
+    whisper_stream_wavpath_.clear();
+    whisper_stream_ending_ = false;
+    whisper_stream_active_ = ensureWhisperResidentWorker();
+}
+
+void Expend::recv_speechstream_chunk(QByteArray pcm)
+{
+    if (!whisper_stream_active_ || whisper_stream_ending_) return;
+    whisper_stream_.append(pcm);
+    maybeRequestWhisperPartial();
+}
+
+// 录音结束：whisper_time 从松开 F2 开始计时，反映用户实际等待的时间
+void Expend::recv_speechstream_end(QString wavpath)
+{
+    whisper_time.restart();
+    whisper_stream_wavpath_ = wavpath;
+    if (!whisper_stream_active_ || !whisper_worker_ || !whisper_worker_->isRunning())
+    {
+        whisper_stream_active_ = false;
+        recv_speechdecode(wavpath, QStringLiteral("txt"));
+        return;
+    }
+    whisper_stream_ending_ = true;
+    emit expend2ui_state("expend:" + jtr("calling whisper to decode recording"), USUAL_SIGNAL);
+    if (!whisper_reply_) startWhisperStreamFinal(); // 否则等在途的部分识别返回后再收尾
+}
@@ -5,6 +5,7 @@
 #include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
+#include <QJsonDocument>
 #include <QFont>
 #include <QCheckBox>
 #include <QDebug>
@@ -17,7 +18,6 @@
 #include <QStandardPaths>
 #include <QStyleFactory>
 #include <QtGlobal> // qRound/qBound
-#include <QElapsedTimer>
 #include <QGuiApplication>
 #include <QMetaObject>
 #include <QTimer>
@@ -32,11 +32,16 @@ Q_IMPORT_PLUGIN(QFcitxPlatformInputContextPlugin)
 
 #include "app/app_bootstrap.h"
 #include "app/config_migrator.h"
+#include "app/startup_sequencer.h"
+#include "core/replay/agent_replay.h"
+#include "core/replay/agent_tape.h"
 #include "expend/expend.h"
 #include "utils/cpuchecker.h"
 #include "utils/devicemanager.h"
 #include "utils/docker_sandbox.h"
 #include "utils/gpuchecker.h"
+#include "utils/openai_compat.h"
+#include "utils/perf_metrics.h"
 #include "utils/startuplogger.h"
 #include "utils/singleinstance.h" // single-instance guard (per app path)
 #include "utils/flowtracer.h"
@@ -90,6 +95,34 @@ int main(int argc, char *argv[])
     const QString applicationDirPath = appCtx.appDir;
     const QString appPath = appCtx.appPath;
     const QString tempDir = appCtx.tempDir;
+    // 智能体回合录制/回放（度量 EVA 自身在工具回环里的开销，与模型耗时分开）：
+    //   --agent-record <tape.jsonl>  录制本次运行的模型输出与工具结果
+    //   --agent-replay <tape.jsonl> [--agent-replay-report <report.json>]  零延迟回放录像，输出分段开销后退出
+    //     退出码：0 与录像一致，2 行为偏离录像，3 回合卡住（长时间没有活动也没有收尾）
+    const QStringList cliArgs = QCoreApplication::arguments();
+    auto cliValue = [&cliArgs](const QString &name)
+    {
+        const int index = cliArgs.indexOf(name);
+        return (index >= 0 && index + 1 < cliArgs.size()) ? cliArgs.at(index + 1) : QString();
+    };
+    const QString agentRecordPath = cliValue(QStringLiteral("--agent-record"));
+    const QString agentReplayPath = cliValue(QStringLiteral("--agent-replay"));
+    const QString agentReplayReport = cliValue(QStringLiteral("--agent-replay-report"));
+    // 启动剖析：时间线默认写到 EVA_TEMP/metrics/startup.json，--startup-profile 可改路径；
+    //   --startup-probe [--startup-budget-ms N]  首帧后的延迟任务排空即退出，时间线打到 stdout，首帧超预算时退出码 3
+    const QString startupProfilePath = cliValue(QStringLiteral("--startup-profile"));
+    const bool startupProbe = cliArgs.contains(QStringLiteral("--startup-probe"));
+    const int startupBudgetMs = cliValue(QStringLiteral("--startup-budget-ms")).toInt();
+    AgentTape agentTape;
+    if (!agentReplayPath.isEmpty())
+    {
+        QString tapeError;
+        if (!AgentTape::load(agentReplayPath, &agentTape, &tapeError))
+        {
+            qCritical().noquote() << "agent replay:" << tapeError;
+            return 1;
+        }
+    }
     StartupLogger::log(QStringLiteral("字体资源加载完成"));
     FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("startup: fonts loaded"));
 
@@ -137,30 +170,36 @@ int main(int argc, char *argv[])
     StartupLogger::log(QStringLiteral("单实例检查通过"));
     FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("startup: single instance check passed"));
     // Auto-discover default models from EVA_MODELS when no config exists
-    AppBootstrap::ensureDefaultConfig(appCtx);
+    // 仅首次启动（无配置文件）时扫描模型目录；后续读取配置依赖它，因此保留在首帧之前
+    {
+        StartupLogger::Scope span(QStringLiteral("default_model_scan"));
+        AppBootstrap::ensureDefaultConfig(appCtx);
+    }
     StartupLogger::log(QStringLiteral("默认模型自动发现完成"));
     FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("startup: default model discovery finished"));
     //------------------实例化主要节点------------------
-    QElapsedTimer widgetTimer;
-    widgetTimer.start();
+    StartupLogger::Scope widgetSpan(QStringLiteral("widget"));
     Widget w(nullptr, applicationDirPath);      // 窗口实例
-    StartupLogger::log(QStringLiteral("Widget 构造完成（%1 ms）").arg(widgetTimer.elapsed()));
-    FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("construct: Widget %1 ms").arg(widgetTimer.elapsed()));
-    QElapsedTimer expendTimer;
-    expendTimer.start();
-    Expend expend(nullptr, applicationDirPath); // 增殖窗口实例
-    StartupLogger::log(QStringLiteral("Expend 构造完成（%1 ms）").arg(expendTimer.elapsed()));
-    FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("construct: Expend %1 ms").arg(expendTimer.elapsed()));
-    QElapsedTimer toolTimer;
-    toolTimer.start();
+    const qint64 widgetMs = qRound64(widgetSpan.finish());
+    StartupLogger::log(QStringLiteral("Widget 构造完成（%1 ms）").arg(widgetMs));
+    FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("construct: Widget %1 ms").arg(widgetMs));
+    StartupLogger::Scope expendSpan(QStringLiteral("expend"));
+    Expend expend(nullptr, applicationDirPath); // 增殖窗口实例（向量库与语音播放器在首帧后/首次使用时才加载）
+    const qint64 expendMs = qRound64(expendSpan.finish());
+    StartupLogger::log(QStringLiteral("Expend 构造完成（%1 ms）").arg(expendMs));
+    FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("construct: Expend %1 ms").arg(expendMs));
+    StartupLogger::Scope toolSpan(QStringLiteral("tool_net"));
     ToolExecutor tool(applicationDirPath);      // 工具执行器
     NetClient *netClient = new NetClient;  // ?????worker ????????
-    StartupLogger::log(QStringLiteral("xTool 构造完成（%1 ms）").arg(toolTimer.elapsed()));
-    FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("construct: xTool %1 ms").arg(toolTimer.elapsed()));
+    const qint64 toolMs = qRound64(toolSpan.finish());
+    StartupLogger::log(QStringLiteral("xTool 构造完成（%1 ms）").arg(toolMs));
+    FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("construct: xTool %1 ms").arg(toolMs));
     // 将 xNet 改为堆对象，确保在其所属线程内析构，避免 Windows 下 QWinEventNotifier 跨线程清理告警
     xMcp *mcp = new xMcp;  // MCP 管理实例（确保在线程内析构避免跨线程 QTimer 告警）
     gpuChecker gpuer;     // 监测显卡信息
     cpuChecker cpuer;     // 监视系统信息
+    // 首帧之后才执行的启动任务：拉起推理后端、加载向量库、自动启动嵌入服务等，均不影响主窗口首次显示
+    StartupSequencer startupSequencer(&w);
 
     //-----------------初始值设定-----------------------
     // 传递语言（注意 net 改为指针）
@@ -268,12 +307,16 @@ int main(int argc, char *argv[])
     QObject::connect(&w, &Widget::ui2expend_language, &expend, &Expend::recv_language);         // 传递使用的语言
     QObject::connect(&w, &Widget::ui2expend_show, &expend, &Expend::recv_expend_show);          // 通知显示扩展窗口
     QObject::connect(&w, &Widget::ui2expend_speechdecode, &expend, &Expend::recv_speechdecode); // 开始语音转文字
+    QObject::connect(&w, &Widget::ui2expend_speechstream_begin, &expend, &Expend::recv_speechstream_begin); // 流式录音开始
+    QObject::connect(&w, &Widget::ui2expend_speechstream_chunk, &expend, &Expend::recv_speechstream_chunk); // 流式录音片段
+    QObject::connect(&w, &Widget::ui2expend_speechstream_end, &expend, &Expend::recv_speechstream_end);     // 流式录音结束
     QObject::connect(&w, &Widget::ui2expend_resettts, &expend, &Expend::recv_resettts);         // 重置文字转语音
     // 模型评估：同步 UI 端点/设置/模式
     QObject::connect(&w, &Widget::ui2expend_apis, &expend, &Expend::recv_eval_apis);
     QObject::connect(&w, &Widget::ui2expend_settings, &expend, &Expend::recv_eval_settings);
     QObject::connect(&w, &Widget::ui2expend_mode, &expend, &Expend::recv_eval_mode);
     QObject::connect(&expend, &Expend::expend2ui_speechdecode_over, &w, &Widget::recv_speechdecode_over);       // 转换完成返回结果
+    QObject::connect(&expend, &Expend::expend2ui_speechdecode_partial, &w, &Widget::recv_speechdecode_partial); // 流式转写实时结果
     QObject::connect(&expend, &Expend::expend2ui_whisper_modelpath, &w, &Widget::recv_whisper_modelpath);       // 传递模型路径
     QObject::connect(&expend, &Expend::expend2ui_state, &w, &Widget::reflash_state);                            // 窗口状态区更新
     QObject::connect(&expend, &Expend::expend2ui_embeddingdb_describe, &w, &Widget::recv_embeddingdb_describe); // 传递知识库的描述
@@ -298,6 +341,12 @@ int main(int argc, char *argv[])
     QObject::connect(netClient, &NetClient::net2ui_reasoning_tokens, &w, &Widget::recv_reasoning_tokens, Qt::QueuedConnection); // think tokens for this turn
     QObject::connect(&w, &Widget::ui2net_send, netClient, &NetClient::send, Qt::QueuedConnection);                 // ?????
     QObject::connect(&w, &Widget::ui2net_stop, netClient, &NetClient::stop, Qt::QueuedConnection);                // ??????
+    QObject::connect(&w, &Widget::ui2net_stream_config, netClient, &NetClient::configureStreams, Qt::QueuedConnection);   // 后台流：slot 配置
+    QObject::connect(&w, &Widget::ui2net_foreground_slot, netClient, &NetClient::setForegroundSlot, Qt::QueuedConnection); // 后台流：前台 slot
+    QObject::connect(&w, &Widget::ui2net_stream_start, netClient, &NetClient::startStream, Qt::QueuedConnection);         // 后台流：启动
+    QObject::connect(&w, &Widget::ui2net_stream_cancel, netClient, &NetClient::cancelStream, Qt::QueuedConnection);       // 后台流：取消
+    QObject::connect(netClient, &NetClient::net2ui_stream_started, &w, &Widget::recv_stream_started, Qt::QueuedConnection);
+    QObject::connect(netClient, &NetClient::net2ui_stream_finished, &w, &Widget::recv_stream_finished, Qt::QueuedConnection);
 
     //------------------连接tool和窗口-------------------
     QObject::connect(&tool, &xTool::tool2ui_state, &w, &Widget::reflash_state);        // 窗口状态区更新
@@ -325,10 +374,54 @@ int main(int argc, char *argv[])
     QObject::connect(&tool, &xTool::dockerShutdownCompleted, &w, &Widget::onDockerShutdownCompleted, Qt::QueuedConnection);
     QObject::connect(&tool, &xTool::tool2ui_dockerStatusChanged, &w, &Widget::recv_docker_status);
 
+    //------------------智能体回合录制/回放-------------------
+    if (!agentRecordPath.isEmpty())
+    {
+        AgentTapeRecorder *recorder = new AgentTapeRecorder(agentRecordPath, &w);
+        if (!recorder->isOpen()) qWarning().noquote() << "agent record: cannot open" << agentRecordPath << recorder->errorString();
+        QObject::connect(&w, &Widget::ui2net_send, recorder, &AgentTapeRecorder::recordSend);
+        QObject::connect(netClient, &NetClient::net2ui_output, recorder, &AgentTapeRecorder::recordOutput, Qt::QueuedConnection);
+        QObject::connect(netClient, &NetClient::net2ui_tool_calls, recorder, &AgentTapeRecorder::recordToolCalls, Qt::QueuedConnection);
+        QObject::connect(netClient, &NetClient::net2ui_pushover, recorder, &AgentTapeRecorder::recordPushover, Qt::QueuedConnection);
+        QObject::connect(&w, &Widget::ui2tool_exec, recorder, &AgentTapeRecorder::recordToolExec);
+        QObject::connect(&tool, &xTool::tool2ui_pushover, recorder, &AgentTapeRecorder::recordToolResult, Qt::QueuedConnection);
+    }
+    AgentReplay *agentReplay = nullptr;
+    if (!agentReplayPath.isEmpty())
+    {
+        agentReplay = new AgentReplay(agentTape, &w);
+        // 顶替网络与工具：Widget 的请求改由录像应答，连接方式与 NetClient/xTool 跨线程时一致（排队）
+        QObject::disconnect(&w, &Widget::ui2net_send, netClient, &NetClient::send);
+        QObject::disconnect(&w, &Widget::ui2net_stop, netClient, &NetClient::stop);
+        QObject::disconnect(&w, &Widget::ui2tool_exec, &tool, &xTool::Exec);
+        QObject::connect(&w, &Widget::ui2net_send, agentReplay, &AgentReplay::send, Qt::QueuedConnection);
+        QObject::connect(&w, &Widget::ui2net_stop, agentReplay, &AgentReplay::stop, Qt::QueuedConnection);
+        QObject::connect(&w, &Widget::ui2tool_exec, agentReplay, &AgentReplay::exec, Qt::QueuedConnection);
+        QObject::connect(agentReplay, &AgentReplay::net2ui_output, &w, &Widget::reflash_output, Qt::QueuedConnection);
+        QObject::connect(agentReplay, &AgentReplay::net2ui_tool_calls, &w, &Widget::recv_tool_calls, Qt::QueuedConnection);
+        QObject::connect(agentReplay, &AgentReplay::net2ui_pushover, &w, &Widget::recv_pushover, Qt::QueuedConnection);
+        QObject::connect(agentReplay, &AgentReplay::tool2ui_pushover, &w, &Widget::recv_toolpushover, Qt::QueuedConnection);
+        w.attachStageProfiler(agentReplay->profiler());
+        QObject::connect(agentReplay, &AgentReplay::finished, &w, [agentReplay, agentReplayPath, agentReplayReport]()
+                         {
+            QJsonObject report = agentReplay->report();
+            report.insert(QStringLiteral("tape"), agentReplayPath);
+            const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+            QFile out(agentReplayReport);
+            if (!agentReplayReport.isEmpty() && out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                out.write(json);
+            else
+                fprintf(stdout, "%s\n", json.constData());
+            if (agentReplay->stalled()) qCritical().noquote() << "agent replay:" << agentReplay->stallReason();
+            QCoreApplication::exit(agentReplay->stalled() ? 3 : (agentReplay->diverged() ? 2 : 0)); });
+    }
+
     //------------------连接增殖窗口和tool-------------------
     QObject::connect(&expend, &Expend::expend2tool_embeddingdb, &tool, &xTool::recv_embeddingdb);                 // 传递已嵌入文本段数据
     QObject::connect(&expend, &Expend::expend2tool_embedding_dim, &tool, &xTool::recv_embedding_dim);             // 同步嵌入维度
+    QObject::connect(&expend, &Expend::expend2tool_embedding_model, &tool, &xTool::recv_embedding_model);         // 同步嵌入模型路径
     QObject::connect(&expend, &Expend::expend2ui_embedding_resultnumb, &tool, &xTool::recv_embedding_resultnumb); // 传递嵌入结果返回个数
+    QObject::connect(&expend, &Expend::expend2tool_rerank_endpoint, &tool, &xTool::recv_rerank_endpoint);         // 同步重排序服务端点
 
     QObject::connect(&tool, &xTool::tool2expend_draw, &expend, &Expend::recv_draw);         // 开始绘制图像
     QObject::connect(&expend, &Expend::expend2tool_drawover, &tool, &xTool::recv_drawover); // 图像绘制完成
@@ -369,10 +462,16 @@ int main(int argc, char *argv[])
         w.currentpath = w.historypath = expend.currentpath = modelpath;                                                             // 默认打开路径
         w.ui_SETTINGS.modelpath = modelpath;
         w.ui_mode = static_cast<EVA_MODE>(settings.value("ui_mode", "0").toInt()); //
+        if (w.ui_mode == LOCAL_MODE) w.applyModelCatalogHints(modelpath); // 读缓存只需一次 stat，先于下方 nctx 取值设好滑块上限
         w.api_endpoint_LineEdit->setText(settings.value("api_endpoint", "").toString());
         w.api_key_LineEdit->setText(settings.value("api_key", "").toString());
         w.api_model_LineEdit->setText(settings.value("api_model", "default").toString());
-        w.apis.api_endpoint = w.api_endpoint_LineEdit->text();
+        {
+            const QStringList endpoints = OpenAiCompat::splitEndpointList(w.api_endpoint_LineEdit->text());
+            w.apis.api_endpoint = endpoints.value(0);
+            w.apis.api_endpoint_pool = endpoints.mid(1);
+        }
+        w.apis.api_hedge = settings.value("api_hedge", DEFAULT_NET_HEDGE_ENABLED).toBool();
         w.apis.api_key = w.api_key_LineEdit->text();
         w.apis.api_model = w.api_model_LineEdit->text();
         w.apis.is_local_backend = (w.ui_mode == LOCAL_MODE);
@@ -511,7 +610,11 @@ int main(int argc, char *argv[])
         }
         // 应用定时任务配置（刷新调度器）
         w.refreshSchedulerSettings();
-        if (engineerOn) { w.triggerEngineerEnvRefresh(true); }
+        if (engineerOn)
+        {
+            startupSequencer.defer(QStringLiteral("engineer_env"), [&w]()
+                                   { w.triggerEngineerEnvRefresh(true); });
+        }
         if (allowControlHost)
         {
             w.setControlHostEnabled(true);
@@ -646,6 +749,11 @@ int main(int argc, char *argv[])
         w.ui_SETTINGS.hid_use_mlock = settings.value("hid_use_mlock", DEFAULT_USE_MLOCCK).toBool();
         w.ui_SETTINGS.hid_flash_attn = settings.value("hid_flash_attn", DEFAULT_FLASH_ATTN).toBool();
         w.ui_SETTINGS.hid_parallel = settings.value("hid_parallel", DEFAULT_PARALLEL).toInt();
+        w.ui_SETTINGS.hid_cache_type_k = settings.value("hid_cache_type_k", DEFAULT_CACHE_TYPE).toString().trimmed().toLower();
+        w.ui_SETTINGS.hid_cache_type_v = settings.value("hid_cache_type_v", DEFAULT_CACHE_TYPE).toString().trimmed().toLower();
+        w.ui_SETTINGS.hid_cache_reuse = qMax(0, settings.value("hid_cache_reuse", DEFAULT_CACHE_REUSE).toInt());
+        w.ui_SETTINGS.hid_context_shift = settings.value("hid_context_shift", DEFAULT_CONTEXT_SHIFT).toBool();
+        w.syncKvCacheControls(); // get_set() 会从控件回读
 
         w.enforcePredictLimit(true);
 
@@ -664,10 +772,12 @@ int main(int argc, char *argv[])
 
         // 初次启动强制赋予隐藏的设定值
         // 处理模型装载相关
+        // 本地后端的拉起（进程启动、端口探测）放到首帧之后；回放与启动探测不需要真实后端
         QFile modelpath_file(modelpath);
-        if (w.ui_mode == LOCAL_MODE && modelpath_file.exists())
+        if (w.ui_mode == LOCAL_MODE && modelpath_file.exists() && !agentReplay && !startupProbe)
         {
-            w.ensureLocalServer();
+            startupSequencer.defer(QStringLiteral("local_backend"), [&w]()
+                                   { w.ensureLocalServer(); });
         }
         else if (w.ui_mode == LINK_MODE)
         {
@@ -677,8 +787,35 @@ int main(int argc, char *argv[])
         // 自动启动嵌入服务：
         // - 若已有持久化向量(Expend::Embedding_DB非空)，为支持查询自动启动服务（仅用于查询向量），不触发重嵌入
         // - 或者用户显式开启了 embedding_server_need（兼容旧配置），同样仅启动服务，不自动重嵌
-        expend.configureEmbeddingAutoStart(embedding_modelpath, embedding_server_need);
+        if (!startupProbe)
+        {
+            startupSequencer.defer(QStringLiteral("embedding_autostart"), [&expend, embedding_modelpath, embedding_server_need]()
+                                   { expend.configureEmbeddingAutoStart(embedding_modelpath, embedding_server_need); });
+        }
     }
+    // 向量库（SQLite 全量读入）原先在构造后 900ms 定时加载，现排在首帧之后；加载完会再判断一次是否自动启动嵌入服务
+    startupSequencer.defer(QStringLiteral("embedding_store"), [&expend]()
+                           { expend.ensureEmbeddingStoreLoaded(); });
+    // 延迟任务排空：落盘启动时间线并记一条首帧耗时指标；探测模式下打印后退出
+    QObject::connect(&startupSequencer, &StartupSequencer::finished, &w, [applicationDirPath, startupProfilePath, startupProbe, startupBudgetMs]()
+                     {
+        const QString profilePath = startupProfilePath.isEmpty()
+                                        ? QDir(applicationDirPath).filePath(QStringLiteral("EVA_TEMP/metrics/startup.json"))
+                                        : startupProfilePath;
+        StartupLogger::writeTimeline(profilePath);
+        const qint64 firstWindowMs = StartupLogger::milestoneMs(QStringLiteral("first_window"));
+        if (firstWindowMs >= 0)
+        {
+            PerfMetrics::recordDuration(applicationDirPath, QStringLiteral("startup.first_window"), firstWindowMs,
+                                        QJsonObject{{QStringLiteral("ready_ms"), StartupLogger::milestoneMs(QStringLiteral("ready"))}});
+        }
+        if (!startupProbe) return;
+        const QJsonObject timeline = StartupLogger::timeline();
+        fprintf(stdout, "%s\n", QJsonDocument(timeline).toJson(QJsonDocument::Compact).constData());
+        fflush(stdout);
+        const bool overBudget = startupBudgetMs > 0 && (firstWindowMs < 0 || firstWindowMs > startupBudgetMs);
+        if (overBudget) qWarning().noquote() << QStringLiteral("startup: first window %1 ms exceeds budget %2 ms").arg(firstWindowMs).arg(startupBudgetMs);
+        QCoreApplication::exit(overBudget ? 3 : 0); });
     w.show();        // 展示窗口
     StartupLogger::log(QStringLiteral("主窗口显示完成"));
     FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("ui: main window shown"));
@@ -689,5 +826,12 @@ int main(int argc, char *argv[])
     // 事件循环首次心跳：用单次定时器确认 event loop 已启动
     QTimer::singleShot(0, []()
                        { FlowTracer::log(FlowChannel::Lifecycle, QStringLiteral("startup: event loop heartbeat")); });
+    if (agentReplay)
+    {
+        QTimer::singleShot(0, &w, [&w, agentReplay]()
+                           {
+                               agentReplay->armWatchdog(); // 回合根本没发出请求也不会无限等待
+                               w.startAgentReplay(agentReplay->tape().prompt, agentReplay->tape().toolCallMode); });
+    }
     return a.exec(); // 进入事件循环
 }
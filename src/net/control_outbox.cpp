@@ -0,0 +1,158 @@
+#include "control_outbox.h"
+
+#include <QJsonDocument>
+
+namespace
+{
+qint64 estimateBytes(const QJsonObject &obj)
+{
+    return QJsonDocument(obj).toJson(QJsonDocument::Compact).size() + qint64(sizeof(quint32));
+}
+
+bool sameStreamTarget(const QJsonObject &a, const QJsonObject &b)
+{
+    return a.value(QStringLiteral("role")) == b.value(QStringLiteral("role")) &&
+           a.value(QStringLiteral("color")) == b.value(QStringLiteral("color")) &&
+           a.value(QStringLiteral("think_active")) == b.value(QStringLiteral("think_active"));
+}
+} // namespace
+
+ControlOutbox::FrameClass ControlOutbox::classify(const QJsonObject &obj)
+{
+    const QString type = obj.value(QStringLiteral("type")).toString();
+    if (type == QStringLiteral("snapshot")) return FrameClass::Snapshot;
+    if (type == QStringLiteral("output"))
+    {
+        return obj.value(QStringLiteral("stream")).toBool() ? FrameClass::Stream : FrameClass::Log;
+    }
+    if (type == QStringLiteral("record_update")) return FrameClass::Stream;
+    if (type == QStringLiteral("monitor") || type == QStringLiteral("kv") || type == QStringLiteral("ui_state"))
+    {
+        return FrameClass::Latest;
+    }
+    if (type == QStringLiteral("state_log") || type == QStringLiteral("record_add") || type == QStringLiteral("record_clear"))
+    {
+        return FrameClass::Log;
+    }
+    // 未知类型按控制帧处理：宁可多发，不可丢失协议语义
+    return FrameClass::Control;
+}
+
+void ControlOutbox::setLimits(int maxFrames, qint64 maxBytes)
+{
+    maxFrames_ = qMax(1, maxFrames);
+    maxBytes_ = qMax<qint64>(1024, maxBytes);
+    enforceLimits();
+}
+
+void ControlOutbox::enqueue(const QJsonObject &obj)
+{
+    Frame frame;
+    frame.type = obj.value(QStringLiteral("type")).toString();
+    frame.cls = classify(obj);
+    frame.obj = obj;
+
+    if (frame.cls == FrameClass::Snapshot)
+    {
+        // 快照携带完整状态：此前排队的状态帧均已过时
+        dropStateFrames();
+        needsResync_ = false;
+    }
+    else if (needsResync_ && frame.cls != FrameClass::Control)
+    {
+        ++droppedFrames_;
+        return;
+    }
+
+    if (tryCoalesce(frame)) return;
+
+    frame.bytes = estimateBytes(obj);
+    pendingBytes_ += frame.bytes;
+    frames_.append(frame);
+    enforceLimits();
+}
+
+QJsonObject ControlOutbox::takeFirst()
+{
+    if (frames_.isEmpty()) return QJsonObject();
+    const Frame frame = frames_.takeFirst();
+    pendingBytes_ = qMax<qint64>(0, pendingBytes_ - frame.bytes);
+    return frame.obj;
+}
+
+void ControlOutbox::clear()
+{
+    frames_.clear();
+    pendingBytes_ = 0;
+    needsResync_ = false;
+}
+
+bool ControlOutbox::tryCoalesce(const Frame &frame)
+{
+    if (frame.cls == FrameClass::Latest)
+    {
+        for (int i = frames_.size() - 1; i >= 0; --i)
+        {
+            if (frames_.at(i).type != frame.type) continue;
+            pendingBytes_ -= frames_.at(i).bytes;
+            frames_.removeAt(i);
+            ++coalescedFrames_;
+            break;
+        }
+        return false; // 删除旧帧后仍需入队最新帧
+    }
+    if (frame.cls != FrameClass::Stream || frames_.isEmpty()) return false;
+
+    // 只与队尾合并，保证与其它事件的相对顺序不变
+    Frame &tail = frames_.last();
+    if (tail.cls != FrameClass::Stream || tail.type != frame.type) return false;
+
+    QString key;
+    if (frame.type == QStringLiteral("output"))
+    {
+        if (!sameStreamTarget(tail.obj, frame.obj)) return false;
+        key = QStringLiteral("text");
+    }
+    else
+    {
+        if (tail.obj.value(QStringLiteral("index")) != frame.obj.value(QStringLiteral("index"))) return false;
+        key = QStringLiteral("delta");
+    }
+    const QString delta = frame.obj.value(key).toString();
+    tail.obj.insert(key, tail.obj.value(key).toString() + delta);
+    const qint64 grow = delta.toUtf8().size();
+    tail.bytes += grow;
+    pendingBytes_ += grow;
+    ++coalescedFrames_;
+    enforceLimits();
+    return true;
+}
+
+void ControlOutbox::dropStateFrames()
+{
+    for (int i = frames_.size() - 1; i >= 0; --i)
+    {
+        if (frames_.at(i).cls == FrameClass::Control) continue;
+        pendingBytes_ -= frames_.at(i).bytes;
+        frames_.removeAt(i);
+        ++droppedFrames_;
+    }
+    pendingBytes_ = qMax<qint64>(0, pendingBytes_);
+}
+
+void ControlOutbox::enforceLimits()
+{
+    // 快照本身不计入预算：大会话的快照可能超过 maxBytes_，若按普通帧处理会被立即丢弃并再次要求重同步，
+    // 对端就永远无法追上。预算只约束快照之外的积压。
+    int frames = 0;
+    qint64 bytes = 0;
+    for (const Frame &frame : frames_)
+    {
+        if (frame.cls == FrameClass::Snapshot) continue;
+        ++frames;
+        bytes += frame.bytes;
+    }
+    if (frames <= maxFrames_ && bytes <= maxBytes_) return;
+    dropStateFrames();
+    needsResync_ = true;
+}
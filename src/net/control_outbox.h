@@ -0,0 +1,63 @@
+#ifndef CONTROL_OUTBOX_H
+#define CONTROL_OUTBOX_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+// 主机端单个订阅者的发送队列（背压策略）。
+// - 快速对端：队列始终为空，帧直接写入 socket。
+// - 慢速对端：流式帧在队尾合并（output/record_update 拼接文本，monitor/kv/ui_state 只保留最新）。
+// - 队列超限：丢弃全部可重建的状态帧并标记 needsResync，由上层补发一次完整快照。
+//   快照帧不计入帧数/字节预算，超过 maxBytes 的大快照也能送达。
+// 控制帧（hello_ack/reject/released 等）永不丢弃，保证握手语义。
+class ControlOutbox
+{
+  public:
+    enum class FrameClass
+    {
+        Control,  // 握手/权限类，必须送达
+        Snapshot, // 完整状态，覆盖此前所有状态帧
+        Stream,   // 增量文本，可与队尾同类帧合并
+        Latest,   // 周期状态，只保留最新一帧
+        Log       // 普通事件，按序送达，超限时可丢弃
+    };
+
+    struct Frame
+    {
+        QString type;
+        FrameClass cls = FrameClass::Log;
+        QJsonObject obj;
+        qint64 bytes = 0;
+    };
+
+    static FrameClass classify(const QJsonObject &obj);
+
+    void setLimits(int maxFrames, qint64 maxBytes);
+    void enqueue(const QJsonObject &obj);
+    bool isEmpty() const { return frames_.isEmpty(); }
+    int size() const { return frames_.size(); }
+    qint64 pendingBytes() const { return pendingBytes_; }
+    QJsonObject takeFirst();
+    void clear();
+
+    // 队列溢出后置位：期间状态帧直接丢弃，直到收到新的快照
+    bool needsResync() const { return needsResync_; }
+    int droppedFrames() const { return droppedFrames_; }
+    int coalescedFrames() const { return coalescedFrames_; }
+
+  private:
+    bool tryCoalesce(const Frame &frame);
+    void dropStateFrames();
+    void enforceLimits();
+
+    QList<Frame> frames_;
+    qint64 pendingBytes_ = 0;
+    int maxFrames_ = 512;
+    qint64 maxBytes_ = 4 * 1024 * 1024;
+    bool needsResync_ = false;
+    int droppedFrames_ = 0;
+    int coalescedFrames_ = 0;
+};
+
+#endif // CONTROL_OUTBOX_H
@@ -7,6 +7,10 @@
 namespace
 {
 constexpr QDataStream::ByteOrder kByteOrder = QDataStream::BigEndian;
+// socket 内核/Qt 缓冲超过该水位时停止写入，剩余帧留在对端 outbox 中合并
+constexpr qint64 kSocketHighWaterBytes = 256 * 1024;
+constexpr int kOutboxMaxFrames = 512;
+constexpr qint64 kOutboxMaxBytes = 4 * 1024 * 1024;
 
 QJsonObject parseJson(const QByteArray &payload)
 {
@@ -53,13 +57,42 @@ bool ControlChannel::startHost(quint16 port)
 void ControlChannel::stopHost()
 {
     if (server_ && server_->isListening()) server_->close();
-    closeHostSocket(QStringLiteral("host stop"));
+    closeAllHostPeers(QStringLiteral("host stop"));
 }
 
-QString ControlChannel::hostPeer() const
+QString ControlChannel::hostPeer(int peerId) const
 {
-    if (hostSocket_.isNull()) return QString();
-    return QStringLiteral("%1:%2").arg(hostSocket_->peerAddress().toString()).arg(hostSocket_->peerPort());
+    const auto it = hostPeers_.constFind(peerId);
+    if (it == hostPeers_.constEnd() || it->socket.isNull()) return QString();
+    return QStringLiteral("%1:%2").arg(it->socket->peerAddress().toString()).arg(it->socket->peerPort());
+}
+
+void ControlChannel::setPeerRole(int peerId, PeerRole role)
+{
+    auto it = hostPeers_.find(peerId);
+    if (it == hostPeers_.end()) return;
+    it->role = role;
+}
+
+ControlChannel::PeerRole ControlChannel::peerRole(int peerId) const
+{
+    const auto it = hostPeers_.constFind(peerId);
+    return it == hostPeers_.constEnd() ? PeerRole::Pending : it->role;
+}
+
+void ControlChannel::closePeer(int peerId, const QString &reason)
+{
+    auto it = hostPeers_.find(peerId);
+    if (it == hostPeers_.end()) return;
+    QPointer<QTcpSocket> sock = it->socket;
+    hostPeers_.erase(it);
+    if (!sock.isNull())
+    {
+        sock->disconnect(this);
+        sock->disconnectFromHost();
+        sock->deleteLater();
+    }
+    emit hostClientChanged(peerId, false, reason);
 }
 
 void ControlChannel::connectToHost(const QString &host, quint16 port)
@@ -94,7 +127,23 @@ void ControlChannel::disconnectFromHost()
 
 bool ControlChannel::sendToController(const QJsonObject &obj)
 {
-    return writeFrame(hostSocket_.data(), obj);
+    bool any = false;
+    const QList<int> ids = hostPeers_.keys();
+    for (int id : ids)
+    {
+        const auto it = hostPeers_.constFind(id);
+        if (it == hostPeers_.constEnd() || it->role == PeerRole::Pending) continue;
+        enqueueToPeer(id, obj);
+        any = true;
+    }
+    return any;
+}
+
+bool ControlChannel::sendToPeer(int peerId, const QJsonObject &obj)
+{
+    if (!hostPeers_.contains(peerId)) return false;
+    enqueueToPeer(peerId, obj);
+    return true;
 }
 
 bool ControlChannel::sendToHost(const QJsonObject &obj)
@@ -108,9 +157,9 @@ void ControlChannel::handleNewConnection()
     QTcpSocket *incoming = server_->nextPendingConnection();
     if (!incoming) return;
 
-    if (!hostSocket_.isNull())
+    if (hostPeers_.size() >= 1 + maxObservers_)
     {
-        // Already controlled; politely reject and close.
+        // Writer + observers already at capacity; politely reject and close.
         QJsonObject busy;
         busy.insert(QStringLiteral("type"), QStringLiteral("reject"));
         busy.insert(QStringLiteral("reason"), QStringLiteral("busy"));
@@ -120,24 +169,81 @@ void ControlChannel::handleNewConnection()
         return;
     }
 
-    hostSocket_ = incoming;
-    hostBuffer_.clear();
-    connect(hostSocket_, &QTcpSocket::readyRead, this, &ControlChannel::handleHostReadyRead);
-    connect(hostSocket_, &QTcpSocket::disconnected, this, &ControlChannel::handleHostDisconnected);
-    connect(hostSocket_, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::error), this, &ControlChannel::handleSocketError);
-    emit hostClientChanged(true, QStringLiteral("connected"));
+    const int peerId = nextPeerId_++;
+    HostPeer peer;
+    peer.socket = incoming;
+    peer.outbox.setLimits(kOutboxMaxFrames, kOutboxMaxBytes);
+    hostPeers_.insert(peerId, peer);
+    // 关闭 Nagle：流式帧很小，避免观察者看到成批“跳字”
+    incoming->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    connect(incoming, &QTcpSocket::readyRead, this, [this, peerId]()
+            { handleHostReadyRead(peerId); });
+    connect(incoming, &QTcpSocket::bytesWritten, this, [this, peerId](qint64)
+            { pumpPeer(peerId); });
+    connect(incoming, &QTcpSocket::disconnected, this, [this, peerId]()
+            { closePeer(peerId, QStringLiteral("peer closed")); });
+    connect(incoming, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::error), this, [this, peerId](QAbstractSocket::SocketError)
+            { handleHostSocketError(peerId); });
+    emit hostClientChanged(peerId, true, QStringLiteral("connected"));
+}
+
+void ControlChannel::handleHostReadyRead(int peerId)
+{
+    auto it = hostPeers_.find(peerId);
+    if (it == hostPeers_.end() || it->socket.isNull()) return;
+    // handler 可能关闭该对端（如 release），先把帧拷出再逐个派发
+    QList<QJsonObject> frames;
+    processBuffer(it->socket.data(), it->buffer, [&frames](const QJsonObject &obj)
+                  { frames.append(obj); });
+    for (const QJsonObject &obj : frames)
+    {
+        if (!hostPeers_.contains(peerId)) break;
+        emit hostCommandArrived(peerId, obj);
+    }
+}
+
+void ControlChannel::handleHostSocketError(int peerId)
+{
+    const auto it = hostPeers_.constFind(peerId);
+    if (it == hostPeers_.constEnd()) return;
+    if (it->socket.isNull() || it->socket->state() == QAbstractSocket::UnconnectedState)
+    {
+        closePeer(peerId, QStringLiteral("error"));
+    }
 }
 
-void ControlChannel::handleHostReadyRead()
+void ControlChannel::enqueueToPeer(int peerId, const QJsonObject &obj)
 {
-    if (hostSocket_.isNull()) return;
-    processBuffer(hostSocket_.data(), hostBuffer_, [this](const QJsonObject &obj)
-                  { emit hostCommandArrived(obj); });
+    auto it = hostPeers_.find(peerId);
+    if (it == hostPeers_.end()) return;
+    it->outbox.enqueue(obj);
+    if (it->outbox.needsResync())
+    {
+        if (!it->lagNotified)
+        {
+            it->lagNotified = true;
+            emit hostPeerLagging(peerId);
+        }
+    }
+    else
+    {
+        it->lagNotified = false;
+    }
+    pumpPeer(peerId);
 }
 
-void ControlChannel::handleHostDisconnected()
+void ControlChannel::pumpPeer(int peerId)
 {
-    closeHostSocket(QStringLiteral("peer closed"));
+    auto it = hostPeers_.find(peerId);
+    if (it == hostPeers_.end()) return;
+    QTcpSocket *sock = it->socket.data();
+    if (!sock || sock->state() != QAbstractSocket::ConnectedState) return;
+    // 只在 socket 缓冲低于水位时写入，慢速对端的积压留在 outbox 里合并/丢弃，
+    // 不会无限占用内存，也不会拖慢主机事件循环或其它观察者
+    while (!it->outbox.isEmpty() && sock->bytesToWrite() < kSocketHighWaterBytes)
+    {
+        if (!writeFrame(sock, it->outbox.takeFirst())) break;
+    }
 }
 
 void ControlChannel::handleControllerReadyRead()
@@ -173,10 +279,6 @@ void ControlChannel::handleSocketError(QAbstractSocket::SocketError error)
             emit controllerStateChanged(controllerState_, reason);
         }
     }
-    if (!hostSocket_.isNull() && hostSocket_->state() == QAbstractSocket::UnconnectedState)
-    {
-        closeHostSocket(QStringLiteral("error"));
-    }
 }
 
 void ControlChannel::processBuffer(QTcpSocket *sock, QByteArray &buffer, const std::function<void(const QJsonObject &)> &handler)
@@ -211,14 +313,8 @@ bool ControlChannel::writeFrame(QTcpSocket *sock, const QJsonObject &obj)
     return written == frame.size();
 }
 
-void ControlChannel::closeHostSocket(const QString &reason)
+void ControlChannel::closeAllHostPeers(const QString &reason)
 {
-    if (!hostSocket_.isNull())
-    {
-        hostSocket_->disconnectFromHost();
-        hostSocket_->deleteLater();
-    }
-    hostSocket_.clear();
-    hostBuffer_.clear();
-    emit hostClientChanged(false, reason);
+    const QList<int> ids = hostPeers_.keys();
+    for (int id : ids) closePeer(id, reason);
 }
@@ -3,13 +3,17 @@
 
 #include <QByteArray>
 #include <QJsonObject>
+#include <QMap>
 #include <QPointer>
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <functional>
 
+#include "control_outbox.h"
+
 // Lightweight duplex channel for controller<->host coordination.
-// Provides framed JSON messages with a single active controller.
+// Provides framed JSON messages with one writer and several read-only observers.
+// Each host-side peer owns an outbound queue so a slow observer never stalls the host.
 class ControlChannel : public QObject
 {
     Q_OBJECT
@@ -22,14 +26,26 @@ class ControlChannel : public QObject
         Connected
     };
 
+    enum class PeerRole
+    {
+        Pending,  // connected, hello not handled yet
+        Writer,   // may issue commands
+        Observer  // mirror only
+    };
+
     explicit ControlChannel(QObject *parent = nullptr);
     ~ControlChannel() override;
 
-    // Host-side: listen for a controller. Rejects extra connections.
+    // Host-side: listen for controllers. Accepts up to 1 + maxObservers peers.
     bool startHost(quint16 port);
     void stopHost();
-    bool hasHostClient() const { return !hostSocket_.isNull(); }
-    QString hostPeer() const;
+    bool hasHostClient() const { return !hostPeers_.isEmpty(); }
+    int hostClientCount() const { return hostPeers_.size(); }
+    QString hostPeer(int peerId) const;
+    void setMaxObservers(int count) { maxObservers_ = qMax(0, count); }
+    void setPeerRole(int peerId, PeerRole role);
+    PeerRole peerRole(int peerId) const;
+    void closePeer(int peerId, const QString &reason);
 
     // Controller-side: connect to a host.
     void connectToHost(const QString &host, quint16 port);
@@ -37,19 +53,20 @@ class ControlChannel : public QObject
     ControllerState controllerState() const { return controllerState_; }
 
     // Send framed JSON. Returns false on missing socket.
+    // sendToController fans out to every peer that passed hello.
     bool sendToController(const QJsonObject &obj);
+    bool sendToPeer(int peerId, const QJsonObject &obj);
     bool sendToHost(const QJsonObject &obj);
 
   signals:
-    void hostClientChanged(bool connected, const QString &reason);
-    void hostCommandArrived(const QJsonObject &payload); // controller -> host
+    void hostClientChanged(int peerId, bool connected, const QString &reason);
+    void hostCommandArrived(int peerId, const QJsonObject &payload); // controller -> host
+    void hostPeerLagging(int peerId); // outbox overflowed; peer needs a fresh snapshot
     void controllerEventArrived(const QJsonObject &payload); // host -> controller
     void controllerStateChanged(ControlChannel::ControllerState state, const QString &reason);
 
   private slots:
     void handleNewConnection();
-    void handleHostReadyRead();
-    void handleHostDisconnected();
     void handleControllerReadyRead();
     void handleControllerConnected();
     void handleControllerDisconnected();
@@ -58,11 +75,25 @@ class ControlChannel : public QObject
   private:
     void processBuffer(QTcpSocket *sock, QByteArray &buffer, const std::function<void(const QJsonObject &)> &handler);
     bool writeFrame(QTcpSocket *sock, const QJsonObject &obj);
-    void closeHostSocket(const QString &reason);
+    void handleHostReadyRead(int peerId);
+    void handleHostSocketError(int peerId);
+    void enqueueToPeer(int peerId, const QJsonObject &obj);
+    void pumpPeer(int peerId);
+    void closeAllHostPeers(const QString &reason);
+
+    struct HostPeer
+    {
+        QPointer<QTcpSocket> socket;
+        QByteArray buffer;
+        PeerRole role = PeerRole::Pending;
+        ControlOutbox outbox;
+        bool lagNotified = false;
+    };
 
     QTcpServer *server_ = nullptr;
-    QPointer<QTcpSocket> hostSocket_;
-    QByteArray hostBuffer_;
+    QMap<int, HostPeer> hostPeers_;
+    int nextPeerId_ = 1;
+    int maxObservers_ = 8;
 
     QPointer<QTcpSocket> controllerSocket_;
     QByteArray controllerBuffer_;
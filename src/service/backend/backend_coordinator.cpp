@@ -1,10 +1,14 @@
 #include "service/backend/backend_coordinator.h"
 
 #include "widget/widget.h"
+#include "core/session/session_controller.h"
 #include "ui_widget.h"
+#include "utils/cpuchecker.h"
 #include "utils/devicemanager.h"
 #include "utils/eva_error.h"
 #include "utils/flowtracer.h"
+#include "utils/memory_fit.h"
+#include "utils/model_catalog.h"
 #include "utils/recovery_guidance.h"
 #include "utils/startuplogger.h"
 #include "utils/textparse.h"
@@ -20,6 +24,15 @@
 #include <QTimer>
 #include <QUrl>
 
+namespace
+{
+bool backendUsesGpu()
+{
+    // cpu / cpu-noavx 后端不会传 -ngl
+    return !DeviceManager::effectiveBackend().startsWith(QLatin1String("cpu"));
+}
+} // namespace
+
 BackendCoordinator::BackendCoordinator(Widget *owner)
     : QObject(owner),
       w_(owner)
@@ -83,10 +96,10 @@ void BackendCoordinator::ensureLocalServer(bool lazyWake, bool forceReload)
             const int modelsize_MB = fileInfo.size() / 1024 / 1024 + fileInfo2.size() / 1024 / 1024;
             if (modelsize_MB > 0 && w_->vfree > 0)
             {
-                const double limit = 0.95 * w_->vfree;
-                if (modelsize_MB <= limit)
+                const int autoNgl = autoGpuLayers();
+                if (autoNgl > 0)
                 {
-                    w_->ui_SETTINGS.ngl = 999; // 初次装载：尽可能全量 offload
+                    w_->ui_SETTINGS.ngl = autoNgl; // 初次装载：在显存内尽可能多地 offload
                     if (w_->settings_ui && w_->settings_ui->ngl_slider)
                     {
                         w_->settings_ui->ngl_slider->setValue(w_->ui_SETTINGS.ngl);
@@ -259,7 +272,11 @@ void BackendCoordinator::ensureLocalServer(bool lazyWake, bool forceReload)
                         .arg(w_->backendListenHost_, w_->activeBackendPort_, w_->activeServerHost_, w_->activeServerPort_),
                     w_->activeTurnId_);
 
-    w_->serverManager->setSettings(w_->ui_SETTINGS);
+    // 只在冷启动前估算：运行中的后端自身占着内存/显存，此时的可用量会低估
+    if (!backendRunning) applyMemoryFit();
+
+    // 内存估算的收敛只进命令行；运行中的后端沿用上次冷启动时估算的上限
+    w_->serverManager->setSettings(launchSettings());
     w_->serverManager->setHost(w_->backendListenHost_);
     w_->serverManager->setPort(w_->activeBackendPort_);
     w_->serverManager->setModelPath(w_->ui_SETTINGS.modelpath);
@@ -739,6 +756,7 @@ void BackendCoordinator::onServerReady(const QString &endpoint)
     w_->lazyWakeInFlight_ = false;
     w_->applyWakeUiLock(false);
     cancelLazyUnload(QStringLiteral("backend ready"));
+    if (w_->sessionController_) w_->sessionController_->resetTokenizerBackoff();
     markBackendActivity();
     updateProxyBackend(w_->backendListenHost_, w_->activeBackendPort_);
     if (w_->proxyServer_) w_->proxyServer_->setBackendAvailable(true);
@@ -1051,7 +1069,8 @@ bool BackendCoordinator::processServerOutputLine(const QString &line)
     if (line.contains(QStringLiteral("llama_context")) && TextParse::extractIntAfterKeyword(line, QStringLiteral("n_ctx"), ctxValue) && ctxValue > 0)
     {
         w_->server_nctx_ = ctxValue;
-        const int slotCtx = w_->ui_SETTINGS.nctx > 0 ? w_->ui_SETTINGS.nctx : DEFAULT_NCTX;
+        const int launchCtx = launchSettings().nctx;
+        const int slotCtx = launchCtx > 0 ? launchCtx : DEFAULT_NCTX;
         const int parallel = w_->ui_SETTINGS.hid_parallel > 0 ? w_->ui_SETTINGS.hid_parallel : 1;
         const int expectedTotal = slotCtx * parallel;
         if (w_->server_nctx_ != expectedTotal)
@@ -1441,3 +1460,106 @@ bool BackendCoordinator::triggerBackendFallback(const QString &failedBackend, co
                        { ensureLocalServer(); });
     return true;
 }
+
+SETTINGS BackendCoordinator::launchSettings() const
+{
+    SETTINGS settings = w_->ui_SETTINGS;
+    if (memoryFit_.modelPath.isEmpty() || memoryFit_.modelPath != settings.modelpath) return settings;
+    if (memoryFit_.ngl >= 0) settings.ngl = qMin(settings.ngl, memoryFit_.ngl);
+    if (memoryFit_.nctx > 0) settings.nctx = (settings.nctx > 0) ? qMin(settings.nctx, memoryFit_.nctx) : memoryFit_.nctx;
+    return settings;
+}
+
+MemoryFitPlan BackendCoordinator::planMemoryFit(int requestedNgl) const
+{
+    const SETTINGS &settings = w_->ui_SETTINGS;
+    MemoryFitInput input;
+    input.info = ModelCatalog::shared(w_->applicationDirPath).lookup(settings.modelpath);
+    input.modelBytes = QFileInfo(settings.modelpath).size();
+    if (!settings.mmprojpath.isEmpty()) input.mmprojBytes = QFileInfo(settings.mmprojpath).size();
+    input.nctx = (settings.nctx > 0) ? settings.nctx : DEFAULT_NCTX;
+    input.parallel = (settings.hid_parallel > 0) ? settings.hid_parallel : 1;
+    input.batch = settings.hid_batch;
+    input.flashAttn = settings.hid_flash_attn;
+    input.useMmap = settings.hid_use_mmap && !settings.hid_use_mlock;
+    input.cacheTypeK = effectiveKvCacheType(settings.hid_cache_type_k, settings.hid_flash_attn);
+    input.cacheTypeV = effectiveKvCacheType(settings.hid_cache_type_v, settings.hid_flash_attn);
+    input.gpu = backendUsesGpu();
+    input.requestedGpuLayers = requestedNgl;
+    input.freeVramMb = w_->vfree;
+    double totalRamMb = 0.0;
+    double freeRamMb = 0.0;
+    if (cpuChecker::readMemoryMb(totalRamMb, freeRamMb)) input.freeRamMb = freeRamMb;
+    return MemoryFit::plan(input);
+}
+
+int BackendCoordinator::autoGpuLayers() const
+{
+    if (!w_) return 0;
+    const MemoryFitPlan plan = planMemoryFit(999);
+    if (plan.valid) return (plan.gpuLayers >= plan.maxGpuLayers) ? 999 : plan.gpuLayers;
+    // 非 GGUF 或元数据不全：退回按文件体积近似（模型大小低于可用显存的 95% 则全量 offload）
+    const qint64 modelsize_MB = QFileInfo(w_->ui_SETTINGS.modelpath).size() / 1024 / 1024 + QFileInfo(w_->ui_SETTINGS.mmprojpath).size() / 1024 / 1024;
+    return (modelsize_MB > 0 && w_->vfree > 0 && modelsize_MB <= 0.95 * w_->vfree) ? 999 : 0;
+}
+
+void BackendCoordinator::applyMemoryFit()
+{
+    memoryFit_ = MemoryFitOverride();
+    if (!w_ || w_->ui_SETTINGS.modelpath.isEmpty()) return;
+    const int requestedNgl = w_->ui_SETTINGS.ngl;
+    const int requestedCtx = w_->ui_SETTINGS.nctx;
+    const MemoryFitPlan plan = planMemoryFit(requestedNgl);
+    if (!plan.valid)
+    {
+        FlowTracer::log(FlowChannel::Backend,
+                        QStringLiteral("memfit: skipped (%1)").arg(plan.reason),
+                        w_->activeTurnId_);
+        return;
+    }
+    const qint64 mib = 1024 * 1024;
+    FlowTracer::log(FlowChannel::Backend,
+                    QStringLiteral("memfit: ngl %1/%2 ctx %3 kv %4MB compute %5MB vram %6MB (free %7MB) ram %8MB fits=%9")
+                        .arg(plan.gpuLayers)
+                        .arg(plan.maxGpuLayers)
+                        .arg(plan.nctx)
+                        .arg(plan.kvBytes / mib)
+                        .arg(plan.computeBytes / mib)
+                        .arg(plan.vramBytes / mib)
+                        .arg(qint64(w_->vfree))
+                        .arg(plan.ramBytes / mib)
+                        .arg(plan.fits ? QStringLiteral("yes") : QStringLiteral("no")),
+                    w_->activeTurnId_);
+    {
+        QJsonObject fields;
+        fields.insert(QStringLiteral("ngl"), plan.gpuLayers);
+        fields.insert(QStringLiteral("max_ngl"), plan.maxGpuLayers);
+        fields.insert(QStringLiteral("nctx"), plan.nctx);
+        fields.insert(QStringLiteral("vram_mb"), double(plan.vramBytes / mib));
+        fields.insert(QStringLiteral("ram_mb"), double(plan.ramBytes / mib));
+        fields.insert(QStringLiteral("fits"), plan.fits);
+        w_->recordPerfEvent(QStringLiteral("backend.memfit"), fields);
+    }
+    if (!plan.fits)
+    {
+        // 权重本身超出可用内存：不改设置，交给启动失败后的回退链处理
+        w_->reflash_state("ui:" + w_->jtr("memory fit insufficient").arg(plan.reason), WRONG_SIGNAL);
+        return;
+    }
+
+    const bool cutNgl = backendUsesGpu() && plan.gpuLayers < qMin(requestedNgl, plan.maxGpuLayers);
+    const bool cutCtx = plan.nctx < requestedCtx;
+    if (!cutNgl && !cutCtx) return;
+
+    // 估算是保守的，且可用内存随其它程序变化：只收敛本次启动参数，用户设置与滑块保持原值
+    memoryFit_.modelPath = w_->ui_SETTINGS.modelpath;
+    if (cutNgl) memoryFit_.ngl = plan.gpuLayers;
+    if (cutCtx) memoryFit_.nctx = plan.nctx;
+    const SETTINGS launch = launchSettings();
+    w_->reflash_state("ui:" + w_->jtr("memory fit adjusted")
+                                  .arg(launch.ngl)
+                                  .arg(launch.nctx)
+                                  .arg(plan.vramBytes / mib)
+                                  .arg(plan.ramBytes / mib),
+                      SIGNAL_SIGNAL);
+}
@@ -6,6 +6,8 @@
 #include <QString>
 
 class Widget;
+struct MemoryFitPlan;
+struct SETTINGS;
 
 // 后端协调器：集中本地后端生命周期、代理端口与惰性卸载逻辑
 // 注意：当前仍通过 Widget 访问 UI/配置状态，后续可继续下沉为独立状态机。
@@ -43,9 +45,26 @@ class BackendCoordinator : public QObject
     void resetBackendFallbackState(const QString &reasonTag);
     QString pickNextBackendFallback(const QString &failedBackend) const;
     bool triggerBackendFallback(const QString &failedBackend, const QString &reasonTag);
+    // 装载前按 GGUF 元数据估算权重/KV/计算缓冲占用，与可用内存、显存比较
+    MemoryFitPlan planMemoryFit(int requestedNgl) const;
+    // 可用显存内能卸载的层数；全部放得下时返回 999（装载后由 recv_params 收敛为真实层数）
+    int autoGpuLayers() const;
+    // 启动前把 -ngl / 上下文收敛到估算能装下的最大值；只记在 memoryFit_ 中，不改用户设置
+    void applyMemoryFit();
+    // 本次启动实际使用的参数：用户设置叠加内存估算的收敛结果
+    SETTINGS launchSettings() const;
 
   private:
+    // 内存估算得出的上限，只对估算时的模型生效；用户设置更小时以用户设置为准
+    struct MemoryFitOverride
+    {
+        QString modelPath;
+        int ngl = -1;  // < 0 表示不限制
+        int nctx = -1; // < 0 表示不限制
+    };
+
     Widget *w_ = nullptr;
+    MemoryFitOverride memoryFit_;
 };
 
 #endif // BACKEND_COORDINATOR_H
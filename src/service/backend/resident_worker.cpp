@@ -0,0 +1,254 @@
+#include "resident_worker.h"
+
+#include "utils/flowtracer.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+namespace
+{
+constexpr int kProbeIntervalMs = 300;
+constexpr int kStopGraceMs = 800;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+constexpr int kProbeRequestTimeoutMs = 1000;
+#endif
+} // namespace
+
+ResidentWorker::ResidentWorker(const QString &name, QObject *parent)
+    : QObject(parent), name_(name)
+{
+    probeTimer_.setInterval(kProbeIntervalMs);
+    probeTimer_.setSingleShot(false);
+    connect(&probeTimer_, &QTimer::timeout, this, &ResidentWorker::probeOnce);
+
+    idleTimer_.setSingleShot(true);
+    connect(&idleTimer_, &QTimer::timeout, this, [this]()
+            {
+                if (!isRunning()) return;
+                FlowTracer::log(FlowChannel::Backend, QStringLiteral("%1: idle, releasing resident model").arg(name_));
+                stop(); });
+}
+
+ResidentWorker::~ResidentWorker()
+{
+    // 析构阶段（退出程序）不再向上层发信号，进程需同步回收，避免残留孤儿进程
+    blockSignals(true);
+    probeTimer_.stop();
+    idleTimer_.stop();
+    killNow(proc_);
+    killNow(retiring_);
+}
+
+void ResidentWorker::setProgram(const QString &program)
+{
+    program_ = program;
+}
+
+void ResidentWorker::setArguments(const QStringList &args)
+{
+    args_ = args;
+}
+
+void ResidentWorker::setPort(const QString &port)
+{
+    port_ = port;
+}
+
+void ResidentWorker::setIdleTimeoutMs(int ms)
+{
+    idleTimer_.setInterval(qMax(0, ms));
+    if (ms <= 0) idleTimer_.stop();
+}
+
+QString ResidentWorker::endpointBase() const
+{
+    return QStringLiteral("http://127.0.0.1:%1").arg(port_);
+}
+
+bool ResidentWorker::isRunning() const
+{
+    return proc_ && proc_->state() != QProcess::NotRunning;
+}
+
+bool ResidentWorker::ensureRunning()
+{
+    const QString prog = program_.trimmed();
+    if (prog.isEmpty() || !QFileInfo::exists(prog)) return false;
+    touch();
+    if (isRunning() && prog == lastProgram_ && args_ == lastArgs_) return true;
+    if (isRunning())
+    {
+        // 模型或参数变化：重启常驻进程
+        FlowTracer::log(FlowChannel::Backend, QStringLiteral("%1: args changed, restarting").arg(name_));
+        stop();
+    }
+    if (retiring_)
+    {
+        // 旧进程仍在退出，端口未释放：等它的 finished 再启动
+        pendingStart_ = true;
+        state_ = State::Starting;
+        lastProgram_ = prog;
+        lastArgs_ = args_;
+        return true;
+    }
+    startProcess();
+    return true;
+}
+
+void ResidentWorker::touch()
+{
+    if (idleTimer_.interval() > 0) idleTimer_.start();
+}
+
+void ResidentWorker::startProcess()
+{
+    const QString prog = program_.trimmed();
+    proc_ = new QProcess(this);
+    QProcess *p = proc_;
+    pendingStart_ = false;
+    state_ = State::Starting;
+    lastProgram_ = prog;
+    lastArgs_ = args_;
+
+    connect(p, &QProcess::readyReadStandardOutput, this, [this, p]()
+            {
+                if (p != proc_) return;
+                const QString out = QString::fromUtf8(p->readAllStandardOutput());
+                if (!out.isEmpty()) emit output(out); });
+    connect(p, &QProcess::readyReadStandardError, this, [this, p]()
+            {
+                if (p != proc_) return;
+                const QString err = QString::fromUtf8(p->readAllStandardError());
+                if (!err.isEmpty()) emit output(err); });
+    connect(p, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this, p](int exitCode, QProcess::ExitStatus)
+            {
+                // 主动 stop() 的进程已断开这里的连接，走到这里说明是意外退出
+                if (p != proc_) return;
+                probeTimer_.stop();
+                state_ = State::Stopped;
+                proc_.clear();
+                p->deleteLater();
+                fail(QStringLiteral("%1 exited (code=%2)").arg(name_).arg(exitCode));
+                emit stopped(); });
+    connect(p, &QProcess::errorOccurred, this, [this, p](QProcess::ProcessError e)
+            {
+                if (p != proc_) return;
+                if (e != QProcess::FailedToStart) return; // 其它错误由 finished 统一处理
+                probeTimer_.stop();
+                state_ = State::Stopped;
+                proc_.clear();
+                p->deleteLater();
+                fail(QStringLiteral("%1 failed to start").arg(name_)); });
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    const QString toolDir = QFileInfo(prog).absolutePath();
+#ifdef _WIN32
+    env.insert("PATH", toolDir + ";" + env.value("PATH"));
+#elif __APPLE__
+    env.insert("DYLD_LIBRARY_PATH", toolDir + ":" + env.value("DYLD_LIBRARY_PATH"));
+#else
+    env.insert("LD_LIBRARY_PATH", toolDir + ":" + env.value("LD_LIBRARY_PATH"));
+#endif
+    p->setProcessEnvironment(env);
+    p->setWorkingDirectory(toolDir);
+    FlowTracer::log(FlowChannel::Backend,
+                    QStringLiteral("%1: launch %2 %3").arg(name_, QDir::toNativeSeparators(prog), args_.join(QLatin1Char(' '))));
+    startedAtMs_ = QDateTime::currentMSecsSinceEpoch();
+    p->start(prog, args_);
+    probeTimer_.start();
+}
+
+void ResidentWorker::probeOnce()
+{
+    if (state_ != State::Starting || !proc_) return;
+    if (QDateTime::currentMSecsSinceEpoch() - startedAtMs_ > readyTimeoutMs_)
+    {
+        probeTimer_.stop();
+        stop();
+        fail(QStringLiteral("%1 not ready after %2 ms").arg(name_).arg(readyTimeoutMs_));
+        return;
+    }
+    QNetworkRequest req(QUrl(endpointBase() + probePath_));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    req.setTransferTimeout(kProbeRequestTimeoutMs);
+#endif
+    QNetworkReply *reply = probeNet_.get(req);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]()
+            {
+                reply->deleteLater();
+                if (state_ != State::Starting) return;
+                // 只认 200 且响应体符合预期：503 表示模型仍在加载，其它状态或内容可能来自占用同端口的无关进程
+                const int code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                if (code != 200) return;
+                if (!probeExpect_.isEmpty() && !reply->readAll().contains(probeExpect_)) return;
+                probeTimer_.stop();
+                state_ = State::Ready;
+                touch();
+                FlowTracer::log(FlowChannel::Backend,
+                                QStringLiteral("%1: ready %2 (%3 ms)")
+                                    .arg(name_, endpointBase())
+                                    .arg(QDateTime::currentMSecsSinceEpoch() - startedAtMs_));
+                emit ready(endpointBase()); });
+}
+
+void ResidentWorker::stop()
+{
+    probeTimer_.stop();
+    idleTimer_.stop();
+    pendingStart_ = false;
+    state_ = State::Stopped;
+    if (!proc_) return;
+    QProcess *p = proc_;
+    proc_.clear();
+    retireProcess(p);
+    emit stopped();
+}
+
+void ResidentWorker::retireProcess(QProcess *p)
+{
+    // 断开运行期回调，之后的 finished 只用于回收，不再视为意外退出
+    disconnect(p, nullptr, this, nullptr);
+    if (p->state() == QProcess::NotRunning)
+    {
+        p->deleteLater();
+        return;
+    }
+    killNow(retiring_); // 连续重启时最多保留一个退出中的旧进程
+    retiring_ = p;
+    connect(p, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this, p]()
+            {
+                if (retiring_ == p) retiring_.clear();
+                p->deleteLater();
+                if (pendingStart_) startProcess(); });
+    p->terminate();
+    // 上下文对象为 p：进程先退出并被删除时定时器自动失效
+    QTimer::singleShot(kStopGraceMs, p, [p]()
+                       {
+                           if (p->state() != QProcess::NotRunning) p->kill(); });
+}
+
+void ResidentWorker::killNow(QProcess *p)
+{
+    if (!p) return;
+    disconnect(p, nullptr, this, nullptr);
+    if (p->state() != QProcess::NotRunning)
+    {
+        p->terminate();
+        if (!p->waitForFinished(kStopGraceMs))
+        {
+            p->kill();
+            p->waitForFinished(500);
+        }
+    }
+    p->deleteLater();
+}
+
+void ResidentWorker::fail(const QString &reason)
+{
+    state_ = State::Stopped;
+    FlowTracer::log(FlowChannel::Backend, QStringLiteral("%1: %2").arg(name_, reason));
+    emit failed(reason);
+}
@@ -0,0 +1,89 @@
+// Long-lived helper server (tts / whisper / stable-diffusion) kept resident between requests
+#ifndef RESIDENT_WORKER_H
+#define RESIDENT_WORKER_H
+
+#include <QByteArray>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QPointer>
+#include <QProcess>
+#include <QStringList>
+#include <QTimer>
+
+// 常驻辅助服务：与 LocalServerManager 类似，但面向 tts-server / whisper-server / sd-server 等
+// “一次加载模型、多次请求”的本地服务。
+// - ensureRunning()：未运行或参数变化时（重新）拉起进程
+// - 就绪判定：轮询 probePath，要求返回 200 且响应体包含 probeExpect，避免把占用同一端口的其它进程误判为就绪
+// - 空闲回收：超过 idleTimeoutMs 没有 touch() 时自动停止，释放内存/显存
+class ResidentWorker : public QObject
+{
+    Q_OBJECT
+  public:
+    enum class State
+    {
+        Stopped,
+        Starting,
+        Ready
+    };
+
+    ResidentWorker(const QString &name, QObject *parent = nullptr);
+    ~ResidentWorker() override;
+
+    void setProgram(const QString &program);
+    void setArguments(const QStringList &args);
+    void setPort(const QString &port);
+    void setProbePath(const QString &path) { probePath_ = path; }
+    // 就绪响应体需包含的片段；为空时只要求 200
+    void setProbeExpect(const QByteArray &marker) { probeExpect_ = marker; }
+    void setReadyTimeoutMs(int ms) { readyTimeoutMs_ = ms; }
+    void setIdleTimeoutMs(int ms);
+
+    // 返回 false 表示可执行文件缺失，调用方应回退到一次性 CLI
+    bool ensureRunning();
+    // 异步停止：发送 terminate 后立即返回，进程在 finished 中回收，超时未退出再 kill
+    void stop();
+    // 记录一次使用，推迟空闲回收
+    void touch();
+
+    State state() const { return state_; }
+    bool isReady() const { return state_ == State::Ready; }
+    bool isRunning() const;
+    QString name() const { return name_; }
+    QString program() const { return program_; }
+    QString endpointBase() const; // e.g. http://127.0.0.1:7759
+
+  signals:
+    void ready(const QString &endpoint);
+    void failed(const QString &reason); // 启动失败或运行中意外退出
+    void output(const QString &text);
+    void stopped();
+
+  private:
+    void startProcess();
+    void retireProcess(QProcess *p);
+    void killNow(QProcess *p);
+    void probeOnce();
+    void fail(const QString &reason);
+
+    QString name_;
+    QString program_;
+    QStringList args_;
+    QString port_;
+    QString probePath_ = QStringLiteral("/health");
+    QByteArray probeExpect_ = QByteArrayLiteral("ok");
+    int readyTimeoutMs_ = 120000;
+
+    QPointer<QProcess> proc_;
+    QPointer<QProcess> retiring_; // 已发 terminate、尚未退出的旧进程；它占着端口，新进程需等它退出再启动
+    bool pendingStart_ = false;
+    QString lastProgram_;
+    QStringList lastArgs_;
+    State state_ = State::Stopped;
+
+    QNetworkAccessManager probeNet_;
+    QTimer probeTimer_;
+    QTimer idleTimer_;
+    qint64 startedAtMs_ = 0;
+};
+
+#endif // RESIDENT_WORKER_H
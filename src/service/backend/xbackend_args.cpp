@@ -76,10 +76,36 @@ QStringList buildLocalServerArgs(const LocalServerArgsInput &input)
     {
         args << QStringLiteral("--mmproj") << ensureToolFriendlyFilePath(input.mmprojPath);
     }
+    // KV 缓存量化：长上下文时显著降低 KV 占用；仅在 flash attention 开启时生效
+    const QString cacheTypeK = effectiveKvCacheType(input.settings.hid_cache_type_k, input.settings.hid_flash_attn);
+    const QString cacheTypeV = effectiveKvCacheType(input.settings.hid_cache_type_v, input.settings.hid_flash_attn);
+    const bool quantizedKv = cacheTypeK != QStringLiteral(DEFAULT_CACHE_TYPE) || cacheTypeV != QStringLiteral(DEFAULT_CACHE_TYPE);
     if (!input.settings.hid_flash_attn)
     {
         args << QStringLiteral("-fa") << QStringLiteral("off");
     }
+    else if (quantizedKv)
+    {
+        // 服务端默认 -fa auto 可能在部分后端回落为关闭，量化的 V 缓存随即报错，这里显式开启
+        args << QStringLiteral("-fa") << QStringLiteral("on");
+    }
+    if (cacheTypeK != QStringLiteral(DEFAULT_CACHE_TYPE))
+    {
+        args << QStringLiteral("-ctk") << cacheTypeK;
+    }
+    if (cacheTypeV != QStringLiteral(DEFAULT_CACHE_TYPE))
+    {
+        args << QStringLiteral("-ctv") << cacheTypeV;
+    }
+    // 提示词前缀变化后按块平移复用已有 KV，减少多轮/工具回合的重复预填充
+    if (input.settings.hid_cache_reuse > 0)
+    {
+        args << QStringLiteral("--cache-reuse") << QString::number(input.settings.hid_cache_reuse);
+    }
+    if (input.settings.hid_context_shift)
+    {
+        args << QStringLiteral("--context-shift");
+    }
     if (input.settings.hid_use_mlock)
     {
         args << QStringLiteral("--mlock");
@@ -0,0 +1,289 @@
+#include "embedding_client.h"
+
+#include "xconfig.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+
+QueryVectorCache::QueryVectorCache(int capacity)
+    : capacity_(qMax(1, capacity))
+{
+}
+
+QString QueryVectorCache::normalizeQuery(const QString &query)
+{
+    QString normalized = query.simplified().toCaseFolded();
+    const auto isTrim = [](QChar c)
+    { return c.isPunct() || c.isSpace(); };
+    int begin = 0;
+    int end = normalized.size();
+    while (begin < end && isTrim(normalized.at(begin))) ++begin;
+    while (end > begin && isTrim(normalized.at(end - 1))) --end;
+    if (begin == end) return normalized; // 全是标点时保留原样，避免不同查询撞到空键
+    return normalized.mid(begin, end - begin);
+}
+
+QString QueryVectorCache::keyOf(const QString &modelId, const QString &query)
+{
+    return modelId + QLatin1Char('\n') + normalizeQuery(query);
+}
+
+bool QueryVectorCache::lookup(const QString &modelId, const QString &query, std::vector<double> *out)
+{
+    auto it = entries_.find(keyOf(modelId, query));
+    if (it == entries_.end()) return false;
+    order_.splice(order_.begin(), order_, it->order);
+    if (out) *out = it->vector;
+    return true;
+}
+
+void QueryVectorCache::insert(const QString &modelId, const QString &query, const std::vector<double> &vector)
+{
+    const QString key = keyOf(modelId, query);
+    auto it = entries_.find(key);
+    if (it != entries_.end())
+    {
+        it->vector = vector;
+        order_.splice(order_.begin(), order_, it->order);
+        return;
+    }
+    order_.push_front(key);
+    entries_.insert(key, Node{vector, order_.begin()});
+    while (entries_.size() > capacity_)
+    {
+        entries_.remove(order_.back());
+        order_.pop_back();
+    }
+}
+
+void QueryVectorCache::clear()
+{
+    entries_.clear();
+    order_.clear();
+}
+
+EmbeddingClient::EmbeddingClient(QObject *parent)
+    : QObject(parent), cache_(DEFAULT_EMBEDDING_QUERY_CACHE_SIZE)
+{
+}
+
+EmbeddingClient::~EmbeddingClient()
+{
+    if (active_) active_->abort();
+}
+
+EmbeddingClient *EmbeddingClient::shared()
+{
+    static EmbeddingClient *instance = []()
+    {
+        auto *thread = new QThread;
+        thread->setObjectName(QStringLiteral("embedding_client"));
+        auto *client = new EmbeddingClient;
+        client->moveToThread(thread);
+        if (QCoreApplication *app = QCoreApplication::instance())
+        {
+            // quit() 同时结束 embed() 内的局部事件循环，未完成的请求随即中断
+            QObject::connect(app, &QCoreApplication::aboutToQuit, thread, [thread]()
+                             {
+                                 thread->quit();
+                                 thread->wait(2000); });
+        }
+        thread->start();
+        return client;
+    }();
+    return instance;
+}
+
+EmbeddingClient::Result EmbeddingClient::query(const QString &endpoint, const QString &apiKey, const QString &text, int timeoutMs, const QString &modelKey)
+{
+    Result result;
+    const auto run = [this, &endpoint, &apiKey, &text, timeoutMs, &modelKey, &result]()
+    {
+        setEndpoint(endpoint);
+        setApiKey(apiKey);
+        setModelKey(modelKey.isEmpty() ? endpoint : modelKey);
+        result = embed(text, timeoutMs);
+    };
+    if (QThread::currentThread() == thread())
+        run();
+    else if (!thread()->isRunning())
+        result.error = QStringLiteral("embedding client thread stopped"); // 退出阶段线程已停，阻塞投递会永远等不到返回
+    else
+        QMetaObject::invokeMethod(this, run, Qt::BlockingQueuedConnection);
+    return result;
+}
+
+void EmbeddingClient::setEndpoint(const QString &url)
+{
+    if (url == endpoint_) return;
+    endpoint_ = url;
+    invalidate();
+}
+
+QString EmbeddingClient::modelKey(const QString &endpoint, const QString &modelPath, int dim)
+{
+    return endpoint + QLatin1Char('|') + modelPath + QLatin1Char('|') + QString::number(dim);
+}
+
+void EmbeddingClient::setModelKey(const QString &key)
+{
+    if (key == modelId_) return;
+    cache_.clear();
+    modelId_ = key;
+}
+
+void EmbeddingClient::invalidate()
+{
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, [this]()
+                                  { invalidate(); }, Qt::QueuedConnection);
+        return;
+    }
+    cache_.clear();
+    modelId_ = endpoint_;
+}
+
+void EmbeddingClient::abort()
+{
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, [this]()
+                                  { abort(); }, Qt::QueuedConnection);
+        return;
+    }
+    if (active_) active_->abort();
+}
+
+EmbeddingClient::Result EmbeddingClient::embed(const QString &text, int timeoutMs)
+{
+    Result result;
+    QElapsedTimer timer;
+    timer.start();
+    if (modelId_.isEmpty()) modelId_ = endpoint_;
+    if (cache_.lookup(modelId_, text, &result.vector))
+    {
+        result.ok = true;
+        result.cached = true;
+        result.elapsedUs = timer.nsecsElapsed() / 1000;
+        return result;
+    }
+
+    QJsonObject json;
+    json.insert("model", "defult");
+    json.insert("encoding_format", "float");
+    json.insert("input", text);
+    QByteArray body;
+    if (!postJson(endpoint_, QJsonDocument(json).toJson(QJsonDocument::Compact), timeoutMs, &body, &result.error))
+    {
+        result.elapsedUs = timer.nsecsElapsed() / 1000;
+        return result;
+    }
+
+    const QJsonObject root = QJsonDocument::fromJson(body).object();
+    const QJsonArray data = root.value("data").toArray();
+    const QJsonArray embedding = data.isEmpty() ? QJsonArray() : data.at(0).toObject().value("embedding").toArray();
+    if (embedding.isEmpty())
+    {
+        result.error = QStringLiteral("invalid embedding response");
+        result.elapsedUs = timer.nsecsElapsed() / 1000;
+        return result;
+    }
+    result.vector.reserve(embedding.size());
+    for (const QJsonValue &v : embedding) result.vector.push_back(v.toDouble());
+
+    cache_.insert(modelId_, text, result.vector);
+    result.ok = true;
+    result.elapsedUs = timer.nsecsElapsed() / 1000;
+    return result;
+}
+
+EmbeddingClient::RerankResult EmbeddingClient::rerank(const QString &endpoint, const QString &query, const QStringList &documents, int timeoutMs)
+{
+    RerankResult result;
+    const auto run = [this, &endpoint, &query, &documents, timeoutMs, &result]()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        QJsonObject json;
+        json.insert("query", query);
+        json.insert("documents", QJsonArray::fromStringList(documents));
+        json.insert("top_n", documents.size());
+        QByteArray body;
+        if (postJson(endpoint, QJsonDocument(json).toJson(QJsonDocument::Compact), timeoutMs, &body, &result.error))
+        {
+            result.ok = parseRerankResponse(body, documents.size(), &result.scores);
+            if (!result.ok) result.error = QStringLiteral("invalid rerank response");
+        }
+        result.elapsedUs = timer.nsecsElapsed() / 1000;
+    };
+    if (QThread::currentThread() == thread())
+        run();
+    else if (!thread()->isRunning())
+        result.error = QStringLiteral("embedding client thread stopped"); // 退出阶段线程已停，阻塞投递会永远等不到返回
+    else
+        QMetaObject::invokeMethod(this, run, Qt::BlockingQueuedConnection);
+    return result;
+}
+
+bool EmbeddingClient::parseRerankResponse(const QByteArray &body, int documentCount, QVector<QPair<int, double>> *scores)
+{
+    const QJsonObject root = QJsonDocument::fromJson(body).object();
+    // 兼容 Jina/Cohere 风格的 results 与旧版 llama-server 的 data
+    QJsonArray items = root.value("results").toArray();
+    if (items.isEmpty()) items = root.value("data").toArray();
+    if (items.isEmpty()) return false;
+    QVector<QPair<int, double>> parsed;
+    parsed.reserve(items.size());
+    for (const QJsonValue &v : items)
+    {
+        const QJsonObject item = v.toObject();
+        const int index = item.value("index").toInt(-1);
+        if (index < 0 || index >= documentCount) continue;
+        const QJsonValue score = item.contains("relevance_score") ? item.value("relevance_score") : item.value("score");
+        parsed.append(qMakePair(index, score.toDouble()));
+    }
+    if (parsed.isEmpty()) return false;
+    std::stable_sort(parsed.begin(), parsed.end(), [](const QPair<int, double> &a, const QPair<int, double> &b)
+                     { return a.second > b.second; });
+    if (scores) *scores = parsed;
+    return true;
+}
+
+bool EmbeddingClient::postJson(const QString &url, const QByteArray &payload, int timeoutMs, QByteArray *body, QString *error)
+{
+    if (!nam_) nam_ = new QNetworkAccessManager(this);
+    QNetworkRequest request{QUrl(url)};
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    if (!apiKey_.isEmpty()) request.setRawHeader("Authorization", ("Bearer " + apiKey_).toUtf8());
+    QNetworkReply *reply = nam_->post(request, payload);
+    active_ = reply;
+
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+    if (timeoutMs > 0) timeout.start(timeoutMs);
+    if (!reply->isFinished()) loop.exec();
+    if (!reply->isFinished()) reply->abort();
+    active_.clear();
+
+    // 只在 finished 之后读取，保证拿到完整响应体
+    *body = reply->readAll();
+    const bool ok = reply->error() == QNetworkReply::NoError;
+    if (!ok && error) *error = reply->errorString();
+    reply->deleteLater();
+    return ok;
+}
@@ -0,0 +1,115 @@
+// Reusable embedding/rerank endpoint client with an LRU cache of query vectors
+#ifndef EMBEDDING_CLIENT_H
+#define EMBEDDING_CLIENT_H
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <list>
+#include <vector>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// 查询向量 LRU 缓存：键为 (模型标识, 归一化查询)；智能体循环中重复/近似重复的检索直接命中
+class QueryVectorCache
+{
+  public:
+    explicit QueryVectorCache(int capacity = 256);
+
+    // 归一化：折叠空白、大小写折叠、去掉首尾标点，使“同一问题的不同写法”落到同一个键
+    static QString normalizeQuery(const QString &query);
+
+    bool lookup(const QString &modelId, const QString &query, std::vector<double> *out);
+    void insert(const QString &modelId, const QString &query, const std::vector<double> &vector);
+    void clear();
+    int size() const { return entries_.size(); }
+    int capacity() const { return capacity_; }
+
+  private:
+    struct Node
+    {
+        std::vector<double> vector;
+        std::list<QString>::iterator order;
+    };
+    static QString keyOf(const QString &modelId, const QString &query);
+
+    int capacity_;
+    QHash<QString, Node> entries_;
+    std::list<QString> order_; // 头部为最近使用
+};
+
+// 嵌入客户端：长期持有同一个 QNetworkAccessManager，复用到嵌入服务的 keep-alive 连接；
+// 在 finished 后解析完整响应体；命中缓存时不发请求。
+// 工具在线程池中执行，shared() 实例常驻独立线程，query()/abort()/invalidate() 可从任意线程调用。
+class EmbeddingClient : public QObject
+{
+    Q_OBJECT
+  public:
+    struct Result
+    {
+        bool ok = false;
+        bool cached = false;
+        std::vector<double> vector;
+        QString error;
+        qint64 elapsedUs = 0;
+    };
+    struct RerankResult
+    {
+        bool ok = false;
+        QVector<QPair<int, double>> scores; // (候选下标, 相关度)，按相关度降序
+        QString error;
+        qint64 elapsedUs = 0;
+    };
+
+    explicit EmbeddingClient(QObject *parent = nullptr);
+    ~EmbeddingClient() override;
+
+    // 进程内共享实例，运行在独立线程上
+    static EmbeddingClient *shared();
+
+    // 以下设置与 embed() 只能在客户端线程调用
+    void setEndpoint(const QString &url);
+    QString endpoint() const { return endpoint_; }
+    void setApiKey(const QString &key) { apiKey_ = key; }
+
+    // 模型标识：端点 + 本地配置的嵌入模型路径 + 维度。llama-server 只回显请求里的 model 字段，
+    // 不能据响应判断是否换了模型，所以由调用方给出；与上次不同时清空缓存
+    static QString modelKey(const QString &endpoint, const QString &modelPath, int dim);
+    void setModelKey(const QString &key);
+
+    // 线程安全：跨线程时阻塞转发到客户端所在线程，先 setModelKey(modelKey) 再执行 embed()；
+    // modelKey 为空时以端点为标识
+    Result query(const QString &endpoint, const QString &apiKey, const QString &text, int timeoutMs, const QString &modelKey = QString());
+    // 线程安全：用重排序服务（llama-server --reranking）给候选段打分，复用同一连接池
+    RerankResult rerank(const QString &endpoint, const QString &query, const QStringList &documents, int timeoutMs);
+    // 阻塞直到拿到完整响应（在客户端线程内开局部事件循环）
+    Result embed(const QString &text, int timeoutMs);
+    // 解析 /v1/rerank 响应：{"results":[{"index":i,"relevance_score":s}]}；越界下标被丢弃
+    static bool parseRerankResponse(const QByteArray &body, int documentCount, QVector<QPair<int, double>> *scores);
+    // 嵌入模型或维度变化时清空缓存
+    void invalidate();
+    // 中断进行中的请求（工具取消时调用）
+    void abort();
+
+    QueryVectorCache &cache() { return cache_; }
+    QString modelId() const { return modelId_; }
+
+  private:
+    // 在客户端线程内发送 JSON POST 并等待完成；失败时返回 false 并填写 error
+    bool postJson(const QString &url, const QByteArray &payload, int timeoutMs, QByteArray *body, QString *error);
+
+    QNetworkAccessManager *nam_ = nullptr;
+    QPointer<QNetworkReply> active_;
+    QString endpoint_;
+    QString apiKey_;
+    QString modelId_; // 当前缓存所属的模型标识，变化时缓存失效
+    QueryVectorCache cache_;
+};
+
+#endif // EMBEDDING_CLIENT_H
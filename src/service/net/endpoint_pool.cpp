@@ -0,0 +1,91 @@
+#include "service/net/endpoint_pool.h"
+
+#include "xconfig.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr double kLatencyAlpha = 0.3;
+constexpr double kErrorAlpha = 0.2;
+constexpr double kRefTokens = 256.0; // 估算生成耗时用的典型回复长度
+} // namespace
+
+void EndpointPool::setEndpoints(const QStringList &endpoints)
+{
+    endpoints_ = endpoints;
+    QHash<QString, Stats> kept;
+    for (const QString &endpoint : endpoints_) kept.insert(endpoint, stats_.value(endpoint));
+    stats_.swap(kept);
+}
+
+bool EndpointPool::isHealthy(int index, qint64 nowMs) const
+{
+    if (index < 0 || index >= endpoints_.size()) return false;
+    return stats_.value(endpoints_.at(index)).cooldownUntilMs <= nowMs;
+}
+
+double EndpointPool::score(int index) const
+{
+    const Stats s = stats(index);
+    const double ttfb = s.ttfbMs >= 0.0 ? s.ttfbMs : 0.0;
+    const double generation = s.tokPerSec > 0.0 ? kRefTokens * 1000.0 / s.tokPerSec : 0.0;
+    // 失败需要重来一次：按成功率折算期望耗时
+    return (ttfb + generation) / std::max(0.1, 1.0 - s.errorRate);
+}
+
+QVector<int> EndpointPool::ranked(qint64 nowMs) const
+{
+    QVector<int> order;
+    for (int i = 0; i < endpoints_.size(); ++i) order.append(i);
+    std::stable_sort(order.begin(), order.end(), [this, nowMs](int a, int b)
+                     {
+        const bool healthyA = isHealthy(a, nowMs);
+        const bool healthyB = isHealthy(b, nowMs);
+        if (healthyA != healthyB) return healthyA;
+        return score(a) < score(b); });
+    return order;
+}
+
+int EndpointPool::hedgeDelayMs(int index) const
+{
+    QVector<int> samples = stats(index).recentTtfb;
+    if (samples.size() < DEFAULT_NET_HEDGE_MIN_SAMPLES) return DEFAULT_NET_HEDGE_DEFAULT_DELAY_MS;
+    std::sort(samples.begin(), samples.end());
+    // nearest-rank 分位数
+    const int rank = static_cast<int>(std::ceil(DEFAULT_NET_HEDGE_PERCENTILE / 100.0 * samples.size()));
+    const int value = samples.at(qBound(0, rank - 1, samples.size() - 1));
+    return std::max(DEFAULT_NET_HEDGE_MIN_DELAY_MS, value);
+}
+
+void EndpointPool::recordSuccess(int index, int ttfbMs)
+{
+    if (index < 0 || index >= endpoints_.size()) return;
+    Stats &s = stats_[endpoints_.at(index)];
+    const double ttfb = std::max(0, ttfbMs);
+    s.ttfbMs = s.ttfbMs < 0.0 ? ttfb : s.ttfbMs + kLatencyAlpha * (ttfb - s.ttfbMs);
+    s.errorRate -= kErrorAlpha * s.errorRate;
+    s.consecutiveFailures = 0;
+    s.cooldownUntilMs = 0;
+    s.recentTtfb.append(std::max(0, ttfbMs));
+    if (s.recentTtfb.size() > DEFAULT_NET_POOL_TTFB_WINDOW) s.recentTtfb.removeFirst();
+}
+
+void EndpointPool::recordFailure(int index, qint64 nowMs)
+{
+    if (index < 0 || index >= endpoints_.size()) return;
+    Stats &s = stats_[endpoints_.at(index)];
+    s.errorRate += kErrorAlpha * (1.0 - s.errorRate);
+    ++s.consecutiveFailures;
+    const int shift = qBound(0, s.consecutiveFailures - 1, 10);
+    const qint64 cooldown = std::min<qint64>(qint64(DEFAULT_NET_POOL_COOLDOWN_MS) << shift, DEFAULT_NET_POOL_COOLDOWN_MAX_MS);
+    s.cooldownUntilMs = nowMs + cooldown;
+}
+
+void EndpointPool::recordSpeed(int index, double tokPerSec)
+{
+    if (index < 0 || index >= endpoints_.size() || tokPerSec <= 0.0) return;
+    Stats &s = stats_[endpoints_.at(index)];
+    s.tokPerSec = s.tokPerSec < 0.0 ? tokPerSec : s.tokPerSec + kLatencyAlpha * (tokPerSec - s.tokPerSec);
+}
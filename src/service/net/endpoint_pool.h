@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 链接模式的端点池：同一组等价的 OpenAI 兼容端点按健康度排序。
+// - 健康度来自首包延迟（TTFB）、错误率与生成速度（net2ui_speeds），均为指数滑动平均
+// - 连续失败的端点进入冷却期，排在健康端点之后；冷却窗口随连续失败次数指数增长
+// - 对冲阈值取该端点近期 TTFB 的分位数：首包等待超过它时才值得向第二个端点并发请求
+// 时间由调用方传入，便于单元测试。
+class EndpointPool
+{
+  public:
+    struct Stats
+    {
+        double ttfbMs = -1.0;    // EWMA，-1 表示尚未测过
+        double errorRate = 0.0;  // EWMA，0~1
+        double tokPerSec = -1.0; // EWMA，-1 表示未知
+        int consecutiveFailures = 0;
+        qint64 cooldownUntilMs = 0;
+        QVector<int> recentTtfb; // 最近 DEFAULT_NET_POOL_TTFB_WINDOW 次成功请求的 TTFB
+    };
+
+    // 保留仍在列表中的端点的历史统计
+    void setEndpoints(const QStringList &endpoints);
+    const QStringList &endpoints() const { return endpoints_; }
+    int size() const { return endpoints_.size(); }
+    QString endpoint(int index) const { return endpoints_.value(index); }
+
+    // 健康端点按得分升序在前，冷却中的端点排在最后（全部冷却时仍可用于兜底）
+    QVector<int> ranked(qint64 nowMs) const;
+    bool isHealthy(int index, qint64 nowMs) const;
+    // 预计拿到一次完整回复的代价（越小越好）；未测过的端点视为最快，保证新端点会被探测
+    double score(int index) const;
+    int hedgeDelayMs(int index) const;
+
+    void recordSuccess(int index, int ttfbMs);
+    void recordFailure(int index, qint64 nowMs);
+    void recordSpeed(int index, double tokPerSec);
+    Stats stats(int index) const { return stats_.value(endpoints_.value(index)); }
+
+  private:
+    QStringList endpoints_;
+    QHash<QString, Stats> stats_;
+};
@@ -1,10 +1,29 @@
 ﻿#include "service/net/net_client.h"
 
+#include "utils/openai_compat.h"
 #include "xnet.h"
 
+#include <QRegularExpression>
+#include <QTimer>
+#include <QUrl>
+
+namespace
+{
+APIS apisForEndpoint(const APIS &base, const QString &endpoint)
+{
+    APIS apis = base;
+    apis.api_endpoint = endpoint;
+    const QUrl baseUrl = QUrl::fromUserInput(endpoint);
+    apis.api_chat_endpoint = OpenAiCompat::chatCompletionsPath(baseUrl);
+    apis.api_completion_endpoint = OpenAiCompat::completionsPath(baseUrl);
+    return apis;
+}
+} // namespace
+
 NetClient::NetClient(QObject *parent)
     : QObject(parent)
 {
+    poolClock_.start();
 }
 
 NetClient::~NetClient()
@@ -14,41 +33,365 @@ NetClient::~NetClient()
         net_->deleteLater();
         net_ = nullptr;
     }
+    if (hedgeNet_)
+    {
+        hedgeNet_->deleteLater();
+        hedgeNet_ = nullptr;
+    }
+    for (auto it = streams_.begin(); it != streams_.end(); ++it)
+    {
+        if (it->net) it->net->deleteLater();
+    }
+    for (xNet *net : idleNets_) net->deleteLater();
 }
 
 void NetClient::ensureNet()
 {
     if (net_)
         return;
-    net_ = new xNet();
-    net_->moveToThread(thread());
+    net_ = createForegroundNet();
+}
 
-    // 将 xNet 信号转发到 NetClient
-    connect(net_, &xNet::net2ui_tool_calls, this, &NetClient::net2ui_tool_calls);
-    connect(net_, &xNet::net2ui_state, this, &NetClient::net2ui_state);
-    connect(net_, &xNet::net2ui_output, this, &NetClient::net2ui_output);
-    connect(net_, &xNet::net2ui_pushover, this, &NetClient::net2ui_pushover);
-    connect(net_, &xNet::net2ui_kv_tokens, this, &NetClient::net2ui_kv_tokens);
-    connect(net_, &xNet::net2ui_prompt_baseline, this, &NetClient::net2ui_prompt_baseline);
-    connect(net_, &xNet::net2ui_slot_id, this, &NetClient::net2ui_slot_id);
-    connect(net_, &xNet::net2ui_reasoning_tokens, this, &NetClient::net2ui_reasoning_tokens);
-    connect(net_, &xNet::net2ui_speeds, this, &NetClient::net2ui_speeds);
-    connect(net_, &xNet::net2ui_turn_counters, this, &NetClient::net2ui_turn_counters);
+xNet *NetClient::createForegroundNet()
+{
+    xNet *net = new xNet();
+    net->moveToThread(thread());
+
+    // 将 xNet 信号转发到 NetClient；同一轮可能有多个尝试在途，只转发胜出（或领先）的那个
+    connect(net, &xNet::net2ui_tool_calls, this, [this, net](const QString &payload)
+            { if (accepts(net)) emit net2ui_tool_calls(payload); });
+    connect(net, &xNet::net2ui_state, this, [this, net](const QString &line, SIGNAL_STATE state)
+            {
+        auto it = attempts_.find(net);
+        if (it != attempts_.end() && state == WRONG_SIGNAL)
+        {
+            it->error = true;
+            // 端点池中首包前的失败可能随后切换到别的端点，先暂存，整轮失败时再转发
+            if (pooled() && net != winner_ && !it->cancelled)
+            {
+                it->errors << line;
+                return;
+            }
+        }
+        if (accepts(net)) emit net2ui_state(line, state); });
+    connect(net, &xNet::net2ui_output, this, [this, net](const QString &result, bool isWhile, QColor color)
+            { if (accepts(net)) emit net2ui_output(result, isWhile, color); });
+    connect(net, &xNet::net2ui_kv_tokens, this, [this, net](int usedTokens)
+            { if (accepts(net)) emit net2ui_kv_tokens(usedTokens); });
+    connect(net, &xNet::net2ui_prompt_baseline, this, [this, net](int promptTokens)
+            { if (accepts(net)) emit net2ui_prompt_baseline(promptTokens); });
+    connect(net, &xNet::net2ui_slot_id, this, [this, net](int slotId)
+            { if (accepts(net)) emit net2ui_slot_id(slotId); });
+    connect(net, &xNet::net2ui_reasoning_tokens, this, [this, net](int count)
+            { if (accepts(net)) emit net2ui_reasoning_tokens(count); });
+    connect(net, &xNet::net2ui_speeds, this, [this, net](double promptPerSecond, double predictedPerSecond)
+            {
+        if (!accepts(net)) return;
+        const auto it = attempts_.constFind(net);
+        if (it != attempts_.constEnd()) pool_.recordSpeed(it->endpoint, predictedPerSecond);
+        emit net2ui_speeds(promptPerSecond, predictedPerSecond); });
+    connect(net, &xNet::net2ui_turn_counters, this, [this, net](int cacheTokens, int promptTokens, int predictedTokens)
+            { if (accepts(net)) emit net2ui_turn_counters(cacheTokens, promptTokens, predictedTokens); });
+    connect(net, &xNet::net2ui_first_byte, this, [this, net]()
+            { onAttemptFirstByte(net); });
+    connect(net, &xNet::net2ui_pushover, this, [this, net]()
+            { onAttemptPushover(net); });
+    return net;
+}
+
+bool NetClient::accepts(xNet *net) const
+{
+    // 已取消或已结束的尝试（对冲落败、被新一轮替换）之后的信号一律丢弃
+    const auto it = attempts_.constFind(net);
+    if (it == attempts_.constEnd() || it->cancelled) return false;
+    return winner_ ? net == winner_ : net == lead_;
+}
+
+bool NetClient::pooled() const
+{
+    return !foreground_.apis.is_local_backend && pool_.size() > 1;
 }
 
 void NetClient::send(const RequestSnapshot &snapshot)
 {
     ensureNet();
-    net_->recv_apis(snapshot.apis);
-    net_->recv_data(snapshot.endpoint);
-    net_->recv_language(snapshot.languageFlag);
-    net_->recv_turn(snapshot.turnId);
-    net_->wordsObj = snapshot.wordsObj; // 语言资源仅在主线程更新后快照传入
-    net_->run();
+    // 上一轮遗留的对冲请求（正常情况下已随胜者决出而取消）；先移出再中止，其 pushover 不再转发
+    if (hedgeNet_ && attempts_.remove(hedgeNet_) > 0) hedgeNet_->recv_stop(true);
+    if (hedgeTimer_) hedgeTimer_->stop();
+
+    foreground_ = snapshot;
+    QStringList endpoints;
+    if (!snapshot.apis.is_local_backend)
+    {
+        endpoints << snapshot.apis.api_endpoint;
+        for (const QString &endpoint : snapshot.apis.api_endpoint_pool)
+        {
+            if (!endpoint.isEmpty() && !endpoints.contains(endpoint)) endpoints << endpoint;
+        }
+    }
+    if (endpoints != pool_.endpoints()) pool_.setEndpoints(endpoints);
+
+    tried_.clear();
+    winner_ = nullptr;
+    stopping_ = false;
+    const int endpoint = pooled() ? pool_.ranked(poolClock_.elapsed()).first() : -1;
+    launchAttempt(net_, endpoint);
+
+    if (pooled() && snapshot.apis.api_hedge)
+    {
+        if (!hedgeTimer_)
+        {
+            hedgeTimer_ = new QTimer(this);
+            hedgeTimer_->setSingleShot(true);
+            connect(hedgeTimer_, &QTimer::timeout, this, &NetClient::launchHedge);
+        }
+        hedgeTimer_->start(pool_.hedgeDelayMs(endpoint));
+    }
 }
 
 void NetClient::stop(bool stop)
 {
     ensureNet();
-    net_->recv_stop(stop);
+    if (!stop)
+    {
+        net_->recv_stop(false);
+        return;
+    }
+    stopping_ = true;
+    if (hedgeTimer_) hedgeTimer_->stop();
+    if (attempts_.isEmpty())
+    {
+        net_->recv_stop(true);
+        return;
+    }
+    // 每个在途尝试中止后各自发出 pushover，全部结束后只向 UI 转发一次
+    const QList<xNet *> nets = attempts_.keys();
+    for (xNet *net : nets) net->recv_stop(true);
+}
+
+void NetClient::launchAttempt(xNet *net, int endpoint)
+{
+    Attempt attempt;
+    attempt.endpoint = endpoint;
+    attempt.clock.start();
+    attempts_.insert(net, attempt);
+    if (!winner_ && (!lead_ || !attempts_.contains(lead_))) lead_ = net;
+    if (endpoint >= 0) tried_.insert(endpoint);
+
+    const APIS apis = endpoint >= 0 ? apisForEndpoint(foreground_.apis, pool_.endpoint(endpoint)) : foreground_.apis;
+    net->recv_apis(apis);
+    net->recv_data(foreground_.endpoint);
+    net->recv_language(foreground_.languageFlag);
+    net->recv_turn(foreground_.turnId);
+    net->wordsObj = foreground_.wordsObj; // 语言资源仅在主线程更新后快照传入
+    net->run();
+}
+
+int NetClient::nextEndpoint(bool healthyOnly) const
+{
+    const qint64 now = poolClock_.elapsed();
+    for (int index : pool_.ranked(now))
+    {
+        if (tried_.contains(index)) continue;
+        if (healthyOnly && !pool_.isHealthy(index, now)) continue;
+        return index;
+    }
+    return -1;
+}
+
+void NetClient::launchHedge()
+{
+    if (winner_ || stopping_ || attempts_.isEmpty()) return;
+    // 对冲只发往健康端点：冷却中的端点大概率同样慢或失败
+    const int endpoint = nextEndpoint(true);
+    if (endpoint < 0) return;
+    if (!hedgeNet_) hedgeNet_ = createForegroundNet();
+    if (attempts_.contains(hedgeNet_)) return;
+    emit net2ui_state(QStringLiteral("net: hedge -> %1 after %2ms")
+                          .arg(pool_.endpoint(endpoint))
+                          .arg(hedgeTimer_ ? hedgeTimer_->interval() : 0),
+                      SIGNAL_SIGNAL);
+    launchAttempt(hedgeNet_, endpoint);
+}
+
+void NetClient::onAttemptFirstByte(xNet *net)
+{
+    auto it = attempts_.find(net);
+    if (winner_ || it == attempts_.end() || it->cancelled) return;
+    winner_ = net;
+    if (hedgeTimer_) hedgeTimer_->stop();
+    pool_.recordSuccess(it->endpoint, int(it->clock.elapsed()));
+
+    // 取消落败的尝试：其 pushover 在 recv_stop 内同步发出，由 onAttemptPushover 按 cancelled 丢弃
+    const QList<xNet *> nets = attempts_.keys();
+    for (xNet *other : nets)
+    {
+        if (other == net) continue;
+        attempts_[other].cancelled = true;
+        other->recv_stop(true);
+    }
+    if (nets.size() > 1)
+        emit net2ui_state(QStringLiteral("net: first byte from %1").arg(pool_.endpoint(it->endpoint)), SIGNAL_SIGNAL);
+}
+
+void NetClient::onAttemptPushover(xNet *net)
+{
+    auto it = attempts_.find(net);
+    if (it == attempts_.end()) return;
+    const Attempt attempt = it.value();
+    attempts_.erase(it);
+
+    if (stopping_ || attempt.cancelled)
+    {
+        if (attempts_.isEmpty()) finishRace();
+        return;
+    }
+    if (net == winner_)
+    {
+        if (attempt.error) pool_.recordFailure(attempt.endpoint, poolClock_.elapsed());
+        finishRace();
+        return;
+    }
+
+    // 首包前失败：记入端点健康度；还有对冲请求在途就等它，否则切到下一个端点
+    pool_.recordFailure(attempt.endpoint, poolClock_.elapsed());
+    if (!attempts_.isEmpty())
+    {
+        lead_ = attempts_.constBegin().key();
+        return;
+    }
+    const int endpoint = pooled() ? nextEndpoint(false) : -1;
+    if (endpoint < 0)
+    {
+        for (const QString &line : attempt.errors) emit net2ui_state(line, WRONG_SIGNAL);
+        finishRace();
+        return;
+    }
+    emit net2ui_state(QStringLiteral("net: failover -> %1").arg(pool_.endpoint(endpoint)), SIGNAL_SIGNAL);
+    // xNet 在 pushover 之前已清理完本次请求，可直接复用它发起下一次尝试
+    launchAttempt(net, endpoint);
+}
+
+void NetClient::finishRace()
+{
+    if (hedgeTimer_) hedgeTimer_->stop();
+    winner_ = nullptr;
+    lead_ = nullptr;
+    stopping_ = false;
+    emit net2ui_pushover();
+}
+
+void NetClient::configureStreams(int slotCount, bool pinned)
+{
+    launchGranted(slots_.configure(slotCount, pinned));
+}
+
+void NetClient::setForegroundSlot(int slotId)
+{
+    slots_.setForegroundSlot(slotId);
+}
+
+void NetClient::startStream(quint64 streamId, const QString &owner, const RequestSnapshot &snapshot)
+{
+    if (streams_.contains(streamId)) return;
+    if (slots_.capacity() <= 0)
+    {
+        // 单 slot 后端没有可并行的空闲 slot，直接告知调用方改走前台队列
+        emit net2ui_stream_finished(streamId, QString(), QStringLiteral("no idle slot"));
+        return;
+    }
+    Stream stream;
+    stream.snapshot = snapshot;
+    streams_.insert(streamId, stream);
+    int slotId = -1;
+    if (slots_.request(streamId, owner.isEmpty() ? QStringLiteral("default") : owner, &slotId))
+        launchStream(streamId, slotId);
+}
+
+void NetClient::cancelStream(quint64 streamId)
+{
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) return;
+    it->cancelled = true;
+    if (it->net)
+    {
+        it->net->recv_stop(true); // 中断后 xNet 会发出 pushover，由 finishStream 收尾
+        return;
+    }
+    // 仍在排队：直接移出
+    streams_.erase(it);
+    launchGranted(slots_.release(streamId));
+    emit net2ui_stream_finished(streamId, QString(), QStringLiteral("cancelled"));
+}
+
+void NetClient::launchGranted(const QVector<SlotScheduler::Grant> &grants)
+{
+    for (const SlotScheduler::Grant &grant : grants) launchStream(grant.requestId, grant.slot);
+}
+
+void NetClient::launchStream(quint64 streamId, int slotId)
+{
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) return;
+
+    xNet *net = nullptr;
+    if (!idleNets_.isEmpty())
+    {
+        net = idleNets_.takeLast();
+    }
+    else
+    {
+        net = new xNet();
+        net->moveToThread(thread());
+    }
+    it->net = net;
+
+    connect(net, &xNet::net2ui_output, this, [this, streamId](const QString &result, bool, QColor)
+            {
+        auto s = streams_.find(streamId);
+        if (s != streams_.end()) s->content += result; });
+    connect(net, &xNet::net2ui_state, this, [this, streamId](const QString &line, SIGNAL_STATE state)
+            {
+        auto s = streams_.find(streamId);
+        if (s != streams_.end() && state == WRONG_SIGNAL) s->error = line; });
+    connect(net, &xNet::net2ui_pushover, this, [this, streamId]()
+            { finishStream(streamId); });
+
+    ENDPOINT_DATA endpoint = it->snapshot.endpoint;
+    endpoint.id_slot = slotId;
+    net->recv_apis(it->snapshot.apis);
+    net->recv_data(endpoint);
+    net->recv_language(it->snapshot.languageFlag);
+    net->recv_turn(it->snapshot.turnId);
+    net->wordsObj = it->snapshot.wordsObj;
+    net->recv_stop(false);
+    emit net2ui_stream_started(streamId, slotId);
+    net->run();
+}
+
+void NetClient::finishStream(quint64 streamId)
+{
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) return;
+    const Stream stream = it.value();
+    streams_.erase(it);
+    if (stream.net)
+    {
+        disconnect(stream.net, nullptr, this, nullptr);
+        idleNets_.append(stream.net);
+    }
+
+    static const QRegularExpression thinkRe(QStringLiteral("%1.*?(%2|$)")
+                                                .arg(QRegularExpression::escape(QStringLiteral(DEFAULT_THINK_BEGIN)),
+                                                     QRegularExpression::escape(QStringLiteral(DEFAULT_THINK_END))),
+                                            QRegularExpression::DotMatchesEverythingOption);
+    QString content = stream.content;
+    content.remove(thinkRe);
+    QString error = stream.error;
+    if (stream.cancelled) error = QStringLiteral("cancelled");
+    emit net2ui_stream_finished(streamId, content.trimmed(), error);
+    // 当前仍处于 xNet 的 pushover 发射过程中，排队启动下一个流，避免重入刚归还的 xNet
+    const QVector<SlotScheduler::Grant> grants = slots_.release(streamId);
+    if (!grants.isEmpty())
+        QMetaObject::invokeMethod(this, [this, grants]() { launchGranted(grants); }, Qt::QueuedConnection);
 }
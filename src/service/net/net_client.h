@@ -1,12 +1,24 @@
 ﻿#pragma once
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
 
+#include "service/net/endpoint_pool.h"
 #include "service/net/request_snapshot.h"
+#include "service/net/slot_scheduler.h"
 
+class QTimer;
 class xNet;
 
 // 网络客户端：封装 xNet，使用 RequestSnapshot 进行一次性发送。
+// 前台对话固定使用一个 xNet（send/stop）；后台流（startStream）各自使用独立的 xNet 并固定到空闲 slot，
+// 与前台并行运行，互不阻塞，可按流 id 单独取消。
+// 链接模式配置了多个等价端点时，前台请求按端点池的健康度选择端点：首包前失败自动切到下一个端点；
+// 开启对冲时首包等待超过阈值会向第二个端点并发请求，先收到首包的胜出，另一个立即取消。
 class NetClient : public QObject
 {
     Q_OBJECT
@@ -18,6 +30,12 @@ public slots:
     void send(const RequestSnapshot &snapshot);
     void stop(bool stop);
 
+    // 后台流：slotCount 为后端总 slot 数（含前台），pinned=false 时不指定 id_slot，仅限制并发
+    void configureStreams(int slotCount, bool pinned);
+    void setForegroundSlot(int slotId);
+    void startStream(quint64 streamId, const QString &owner, const RequestSnapshot &snapshot);
+    void cancelStream(quint64 streamId);
+
 signals:
     void net2ui_tool_calls(const QString &payload);
     void net2ui_state(const QString &state_string, SIGNAL_STATE state = USUAL_SIGNAL);
@@ -30,8 +48,56 @@ signals:
     void net2ui_speeds(double prompt_per_second, double predicted_per_second);
     void net2ui_turn_counters(int cacheTokens, int promptTokens, int predictedTokens);
 
+    // 后台流生命周期：started 在真正占到 slot 后发出；finished 的 content 已去掉 <think> 段，出错时 error 非空
+    void net2ui_stream_started(quint64 streamId, int slotId);
+    void net2ui_stream_finished(quint64 streamId, const QString &content, const QString &error);
+
 private:
+    struct Stream
+    {
+        RequestSnapshot snapshot;
+        xNet *net = nullptr;
+        QString content;
+        QString error;
+        bool cancelled = false;
+    };
+
+    // 前台请求的一次尝试：主请求、对冲请求或失败切换后的请求
+    struct Attempt
+    {
+        int endpoint = -1; // 端点池下标；未启用端点池时为 -1
+        QElapsedTimer clock;
+        bool error = false;     // 出现过 WRONG_SIGNAL 状态
+        bool cancelled = false; // 对冲落败被取消
+        QStringList errors;     // 决出胜者前暂存的错误状态行，只有最后一个失败的尝试会转发
+    };
+
     void ensureNet();
+    xNet *createForegroundNet();
+    bool accepts(xNet *net) const;
+    bool pooled() const;
+    void launchAttempt(xNet *net, int endpoint);
+    void launchHedge();
+    int nextEndpoint(bool healthyOnly) const;
+    void onAttemptFirstByte(xNet *net);
+    void onAttemptPushover(xNet *net);
+    void finishRace();
+    void launchStream(quint64 streamId, int slotId);
+    void finishStream(quint64 streamId);
+    void launchGranted(const QVector<SlotScheduler::Grant> &grants);
 
     xNet *net_ = nullptr;
+    xNet *hedgeNet_ = nullptr;
+    RequestSnapshot foreground_;
+    EndpointPool pool_;
+    QHash<xNet *, Attempt> attempts_; // 在途的前台尝试
+    QSet<int> tried_;                 // 本轮已用过的端点
+    xNet *winner_ = nullptr;          // 先收到首包的尝试，之后只转发它的输出
+    xNet *lead_ = nullptr;            // 尚未决出胜者时，转发其状态行的尝试
+    bool stopping_ = false;
+    QTimer *hedgeTimer_ = nullptr;
+    QElapsedTimer poolClock_;
+    SlotScheduler slots_;
+    QHash<quint64, Stream> streams_;
+    QVector<xNet *> idleNets_; // 复用空闲的 xNet，保持连接常热
 };
@@ -0,0 +1,104 @@
+#include "service/net/slot_scheduler.h"
+
+QVector<SlotScheduler::Grant> SlotScheduler::configure(int slotCount, bool pinned)
+{
+    slotCount_ = qMax(1, slotCount);
+    pinned_ = pinned;
+    // slot 变多时排队的请求可以立刻开跑；变少时已在运行的流跑完后自然收敛
+    return dispatch();
+}
+
+void SlotScheduler::setForegroundSlot(int slot)
+{
+    foregroundSlot_ = slot;
+}
+
+int SlotScheduler::capacity() const
+{
+    return slotCount_ - 1;
+}
+
+int SlotScheduler::waiting() const
+{
+    int total = 0;
+    for (auto it = waiting_.constBegin(); it != waiting_.constEnd(); ++it) total += it.value().size();
+    return total;
+}
+
+int SlotScheduler::reservedSlot() const
+{
+    if (pinned_ && foregroundSlot_ >= 0 && foregroundSlot_ < slotCount_) return foregroundSlot_;
+    return 0;
+}
+
+int SlotScheduler::takeFreeSlot()
+{
+    const int reserved = reservedSlot();
+    QSet<int> used;
+    for (auto it = running_.constBegin(); it != running_.constEnd(); ++it) used.insert(it.value());
+    for (int slot = 0; slot < slotCount_; ++slot)
+    {
+        if (slot != reserved && !used.contains(slot)) return slot;
+    }
+    return -1;
+}
+
+bool SlotScheduler::request(quint64 requestId, const QString &owner, int *slot)
+{
+    // 不变式：有排队请求时一定没有空闲 slot，所以只有队列为空时才可能直接授予
+    if (owners_.isEmpty())
+    {
+        const int free = takeFreeSlot();
+        if (free >= 0)
+        {
+            running_.insert(requestId, free);
+            if (slot) *slot = pinned_ ? free : -1;
+            return true;
+        }
+    }
+    QQueue<quint64> &queue = waiting_[owner];
+    if (queue.isEmpty()) owners_.append(owner);
+    queue.enqueue(requestId);
+    return false;
+}
+
+QVector<SlotScheduler::Grant> SlotScheduler::release(quint64 requestId)
+{
+    if (running_.remove(requestId) > 0) return dispatch();
+
+    for (int i = 0; i < owners_.size(); ++i)
+    {
+        const QString owner = owners_.at(i);
+        QQueue<quint64> &queue = waiting_[owner];
+        if (queue.removeOne(requestId))
+        {
+            if (queue.isEmpty())
+            {
+                waiting_.remove(owner);
+                owners_.removeAt(i);
+            }
+            break;
+        }
+    }
+    return {};
+}
+
+QVector<SlotScheduler::Grant> SlotScheduler::dispatch()
+{
+    QVector<Grant> grants;
+    while (!owners_.isEmpty())
+    {
+        const int free = takeFreeSlot();
+        if (free < 0) break;
+        const QString owner = owners_.takeFirst();
+        QQueue<quint64> &queue = waiting_[owner];
+        const quint64 requestId = queue.dequeue();
+        if (queue.isEmpty())
+            waiting_.remove(owner);
+        else
+            owners_.append(owner); // 轮到下一个 owner
+        running_.insert(requestId, free);
+        grants.append({requestId, pinned_ ? free : -1});
+    }
+    return grants;
+}
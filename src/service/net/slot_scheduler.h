@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+// 后台流的 slot 分配：llama-server 以 --parallel N 启动时有 N 个独立 slot，
+// 前台对话占一个，其余空闲 slot 给后台请求（隔离的定时任务等）并行使用，不必排在前台对话后面。
+// - 前台 slot 永远不分给后台；前台 slot 未知（服务端尚未分配）时预留 slot 0
+// - 后台请求按 owner 分队列，空出 slot 时在 owner 之间轮转，单个 owner 的大量请求不会饿死其它 owner
+// - pinned=false（远端 API）时没有真实 slot，只限制并发数，授予的 slot 为 -1
+class SlotScheduler
+{
+  public:
+    struct Grant
+    {
+        quint64 requestId = 0;
+        int slot = -1;
+    };
+
+    // 返回因 slot 变多而立即授予的排队请求
+    QVector<Grant> configure(int slotCount, bool pinned);
+    void setForegroundSlot(int slot);
+
+    // 后台可同时运行的流数；0 表示没有空闲 slot 可用（单 slot 后端）
+    int capacity() const;
+    int running() const { return running_.size(); }
+    int waiting() const;
+    bool pinned() const { return pinned_; }
+
+    // 立即授予时返回 true 并写入 slot，否则排队等待
+    bool request(quint64 requestId, const QString &owner, int *slot);
+    // 结束或取消：释放 slot / 移出队列，返回因此被授予的排队请求
+    QVector<Grant> release(quint64 requestId);
+
+  private:
+    int reservedSlot() const;
+    int takeFreeSlot();
+    QVector<Grant> dispatch();
+
+    int slotCount_ = 1;
+    bool pinned_ = true;
+    int foregroundSlot_ = -1;
+    QHash<quint64, int> running_; // requestId -> 内部 slot 下标
+    QHash<QString, QQueue<quint64>> waiting_;
+    QList<QString> owners_; // 有排队请求的 owner，按轮转顺序
+};
@@ -0,0 +1,416 @@
+#include "content_search.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ContentSearch
+{
+namespace
+{
+constexpr qint64 kBinaryProbeBytes = 8192;
+
+inline unsigned char foldAscii(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + ('a' - 'A')) : c;
+}
+
+// 根目录 .gitignore 的简化实现：支持名称/通配/锚定路径与仅目录（末尾 /）规则，不支持否定（!）
+class IgnoreRules
+{
+  public:
+    explicit IgnoreRules(const QString &root)
+        : root_(root)
+    {
+        names_ = {QStringLiteral(".git"), QStringLiteral(".hg"), QStringLiteral(".svn"),
+                  QStringLiteral("node_modules"), QStringLiteral("__pycache__"), QStringLiteral(".venv"),
+                  QStringLiteral("venv"), QStringLiteral(".mypy_cache"), QStringLiteral(".pytest_cache"),
+                  QStringLiteral(".gradle"), QStringLiteral(".idea"), QStringLiteral(".vs"),
+                  QStringLiteral("CMakeFiles")};
+        QFile file(QDir(root).filePath(QStringLiteral(".gitignore")));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+        QTextStream in(&file);
+        in.setCodec("UTF-8");
+        while (!in.atEnd())
+        {
+            QString line = in.readLine().trimmed();
+            if (line.isEmpty() || line.startsWith(QLatin1Char('#')) || line.startsWith(QLatin1Char('!'))) continue;
+            bool dirOnly = false;
+            while (line.endsWith(QLatin1Char('/')))
+            {
+                line.chop(1);
+                dirOnly = true;
+            }
+            if (line.startsWith(QStringLiteral("**/"))) line.remove(0, 3);
+            const bool anchored = line.contains(QLatin1Char('/'));
+            while (line.startsWith(QLatin1Char('/'))) line.remove(0, 1);
+            if (line.isEmpty()) continue;
+            const bool wildcard = line.contains(QLatin1Char('*')) || line.contains(QLatin1Char('?')) || line.contains(QLatin1Char('['));
+            if (!anchored && !wildcard)
+            {
+                (dirOnly ? names_ : fileNames_).insert(line);
+                continue;
+            }
+            const QRegularExpression re(QRegularExpression::wildcardToRegularExpression(line));
+            if (!re.isValid()) continue;
+            rules_.append(Rule{re, anchored, dirOnly});
+        }
+    }
+
+    bool ignored(const QString &absPath, const QString &name, bool isDir) const
+    {
+        if (names_.contains(name) || fileNames_.contains(name)) return true;
+        QString rel;
+        for (const Rule &rule : rules_)
+        {
+            if (rule.dirOnly && !isDir) continue;
+            if (rule.anchored)
+            {
+                if (rel.isEmpty()) rel = QDir(root_).relativeFilePath(absPath);
+                if (rule.re.match(rel).hasMatch()) return true;
+            }
+            else if (rule.re.match(name).hasMatch())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+  private:
+    struct Rule
+    {
+        QRegularExpression re;
+        bool anchored = false;
+        bool dirOnly = false;
+    };
+    QString root_;
+    QSet<QString> names_;     // 目录或文件名
+    QSet<QString> fileNames_; // 不带 / 的名称规则同样作用于文件
+    QVector<Rule> rules_;
+};
+
+struct Hit
+{
+    QString rel;
+    int line = 0;
+    QString text;
+};
+
+// 多线程共享的检索状态
+class Search
+{
+  public:
+    Search(const QString &root, const Options &options)
+        : root_(QDir(root).absolutePath()), options_(options), matcher_(options.query, options.ignoreCase)
+    {
+        if (!options_.filePattern.isEmpty())
+        {
+            glob_ = QRegularExpression(QRegularExpression::wildcardToRegularExpression(options_.filePattern));
+            // 与 rg -g 一致：不含 / 的模式匹配任意层级的文件名
+            globByName_ = !options_.filePattern.contains(QLatin1Char('/'));
+        }
+    }
+
+    bool stopped() const
+    {
+        if (stop_.load(std::memory_order_relaxed)) return true;
+        if (options_.cancelled && options_.cancelled())
+        {
+            stop_.store(true);
+            return true;
+        }
+        return false;
+    }
+
+    void searchFile(const QString &absPath, qint64 size)
+    {
+        if (stopped()) return;
+        if (size <= 0 || size > options_.maxFileSize) return;
+        const QString rel = QDir(root_).relativeFilePath(absPath);
+        if (!glob_.pattern().isEmpty() && !glob_.match(globByName_ ? QFileInfo(absPath).fileName() : rel).hasMatch()) return;
+
+        QFile file(absPath);
+        if (!file.open(QIODevice::ReadOnly)) return;
+        QByteArray owned;
+        const char *data = reinterpret_cast<const char *>(file.map(0, size));
+        if (!data)
+        {
+            owned = file.readAll();
+            data = owned.constData();
+            size = owned.size();
+        }
+        filesScanned_.fetch_add(1, std::memory_order_relaxed);
+        bytesScanned_.fetch_add(size, std::memory_order_relaxed);
+        if (std::memchr(data, 0, size_t(std::min(size, kBinaryProbeBytes))))
+        {
+            binarySkipped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        QVector<Hit> hits;
+        if (matcher_.byteMode())
+            scanBytes(data, size, rel, &hits);
+        else
+            scanLines(data, size, rel, &hits);
+        if (hits.isEmpty()) return;
+
+        std::lock_guard<std::mutex> lock(hitsMutex_);
+        for (const Hit &hit : hits)
+        {
+            if (hits_.size() >= options_.maxMatches) break;
+            hits_.append(hit);
+        }
+        if (hits_.size() >= options_.maxMatches)
+        {
+            truncated_ = true;
+            stop_.store(true);
+        }
+    }
+
+    Result finish()
+    {
+        std::sort(hits_.begin(), hits_.end(), [](const Hit &a, const Hit &b)
+                  { return a.rel == b.rel ? a.line < b.line : a.rel < b.rel; });
+        Result result;
+        for (const Hit &hit : hits_) result.lines << QStringLiteral("%1:%2:%3").arg(hit.rel).arg(hit.line).arg(hit.text);
+        result.filesScanned = filesScanned_.load();
+        result.binarySkipped = binarySkipped_.load();
+        result.bytesScanned = bytesScanned_.load();
+        result.truncated = truncated_;
+        return result;
+    }
+
+    int threadCount() const
+    {
+        const int n = options_.threads > 0 ? options_.threads : QThread::idealThreadCount();
+        return qBound(1, n, 16);
+    }
+
+    const QString &root() const { return root_; }
+
+  private:
+    void scanBytes(const char *data, qint64 size, const QString &rel, QVector<Hit> *hits) const
+    {
+        qint64 pos = 0;
+        qint64 counted = 0; // 行号已统计到的位置
+        int lineNo = 1;
+        while (hits->size() < options_.maxPerFile)
+        {
+            const qint64 hit = matcher_.find(data, size, pos);
+            if (hit < 0) break;
+            qint64 lineStart = hit;
+            while (lineStart > 0 && data[lineStart - 1] != '\n') --lineStart;
+            const void *nl = std::memchr(data + hit, '\n', size_t(size - hit));
+            const qint64 lineEnd = nl ? static_cast<const char *>(nl) - data : size;
+            lineNo += int(std::count(data + counted, data + lineStart, '\n'));
+            counted = lineStart;
+            hits->append(Hit{rel, lineNo, QString::fromUtf8(data + lineStart, int(lineEnd - lineStart)).trimmed()});
+            pos = lineEnd + 1;
+            if (pos >= size) break;
+        }
+    }
+
+    void scanLines(const char *data, qint64 size, const QString &rel, QVector<Hit> *hits) const
+    {
+        qint64 pos = 0;
+        int lineNo = 0;
+        while (pos < size && hits->size() < options_.maxPerFile)
+        {
+            const void *nl = std::memchr(data + pos, '\n', size_t(size - pos));
+            const qint64 lineEnd = nl ? static_cast<const char *>(nl) - data : size;
+            ++lineNo;
+            const QString line = QString::fromUtf8(data + pos, int(lineEnd - pos));
+            if (matcher_.matchesLine(line)) hits->append(Hit{rel, lineNo, line.trimmed()});
+            pos = lineEnd + 1;
+        }
+    }
+
+    QString root_;
+    Options options_;
+    Matcher matcher_;
+    QRegularExpression glob_;
+    bool globByName_ = false;
+    mutable std::atomic_bool stop_{false};
+    std::atomic_int filesScanned_{0};
+    std::atomic_int binarySkipped_{0};
+    std::atomic<qint64> bytesScanned_{0};
+    std::mutex hitsMutex_;
+    QVector<Hit> hits_;
+    bool truncated_ = false;
+};
+} // namespace
+
+Matcher::Matcher(const QString &query, bool ignoreCase)
+    : query_(query), ignoreCase_(ignoreCase)
+{
+    needle_ = query.toUtf8();
+    if (ignoreCase_)
+    {
+        for (const QChar ch : query)
+        {
+            if (ch.unicode() >= 0x80 && (ch.toLower() != ch || ch.toUpper() != ch))
+            {
+                byteMode_ = false; // 非 ASCII 的大小写折叠交给 QString
+                break;
+            }
+        }
+        for (char &c : needle_) c = char(foldAscii(uchar(c)));
+    }
+    const int m = needle_.size();
+    for (int &s : skip_) s = qMax(1, m);
+    for (int i = 0; i + 1 < m; ++i) skip_[uchar(needle_.at(i))] = m - 1 - i;
+    if (ignoreCase_)
+    {
+        // 大写字节与对应小写字节使用相同的跳距
+        for (int c = 'A'; c <= 'Z'; ++c) skip_[c] = skip_[c + ('a' - 'A')];
+    }
+    firstByteCased_ = ignoreCase_ && m > 0 && needle_.at(0) >= 'a' && needle_.at(0) <= 'z';
+}
+
+qint64 Matcher::find(const char *data, qint64 size, qint64 from) const
+{
+    const int m = needle_.size();
+    if (m == 0 || size - from < m) return -1;
+    const char *needle = needle_.constData();
+    auto equalsAt = [&](qint64 at) -> bool
+    {
+        if (!ignoreCase_) return std::memcmp(data + at, needle, size_t(m)) == 0;
+        for (int j = 0; j < m; ++j)
+            if (foldAscii(uchar(data[at + j])) != uchar(needle[j])) return false;
+        return true;
+    };
+
+    if (!firstByteCased_)
+    {
+        // 首字节没有大小写变体（中文、数字、符号或区分大小写）：memchr 逐个定位候选
+        const qint64 last = size - m;
+        qint64 i = from;
+        while (i <= last)
+        {
+            const void *p = std::memchr(data + i, needle[0], size_t(last - i + 1));
+            if (!p) return -1;
+            i = static_cast<const char *>(p) - data;
+            if (equalsAt(i)) return i;
+            ++i;
+        }
+        return -1;
+    }
+
+    for (qint64 i = from; i + m <= size;)
+    {
+        const uchar tail = uchar(data[i + m - 1]);
+        if (foldAscii(tail) == uchar(needle[m - 1]) && equalsAt(i)) return i;
+        i += skip_[tail];
+    }
+    return -1;
+}
+
+bool Matcher::matchesLine(const QString &line) const
+{
+    return line.contains(query_, ignoreCase_ ? Qt::CaseInsensitive : Qt::CaseSensitive);
+}
+
+Result searchTree(const QString &root, const Options &options)
+{
+    Search search(root, options);
+    const IgnoreRules rules(search.root());
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<QString> dirs{search.root()};
+    QStringList skippedDirs;
+    int busy = 0;
+
+    auto worker = [&]()
+    {
+        for (;;)
+        {
+            QString dir;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return search.stopped() || !dirs.empty() || busy == 0; });
+                if (search.stopped() || dirs.empty())
+                {
+                    cv.notify_all();
+                    return;
+                }
+                dir = dirs.front();
+                dirs.pop_front();
+                ++busy;
+            }
+            // 默认不含隐藏项，与 rg 一致
+            const QFileInfoList entries = QDir(dir).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDir::Unsorted);
+            QStringList subdirs;
+            QStringList skipped;
+            for (const QFileInfo &info : entries)
+            {
+                if (search.stopped()) break;
+                if (info.isSymLink()) continue;
+                const bool isDir = info.isDir();
+                if (rules.ignored(info.absoluteFilePath(), info.fileName(), isDir))
+                {
+                    if (isDir) skipped << info.absoluteFilePath();
+                    continue;
+                }
+                if (isDir)
+                    subdirs << info.absoluteFilePath();
+                else
+                    search.searchFile(info.absoluteFilePath(), info.size());
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (const QString &sub : subdirs) dirs.push_back(sub);
+                skippedDirs << skipped;
+                --busy;
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const int n = search.threadCount();
+    threads.reserve(size_t(n));
+    for (int i = 0; i < n; ++i) threads.emplace_back(worker);
+    for (std::thread &t : threads) t.join();
+    Result result = search.finish();
+    skippedDirs.sort();
+    result.skippedDirs = skippedDirs;
+    return result;
+}
+
+Result searchFiles(const QString &root, const QStringList &files, const Options &options)
+{
+    Search search(root, options);
+    std::atomic_int next{0};
+    auto worker = [&]()
+    {
+        for (int i = next.fetch_add(1); i < files.size() && !search.stopped(); i = next.fetch_add(1))
+        {
+            const QFileInfo info(files.at(i));
+            if (info.fileName().startsWith(QLatin1Char('.'))) continue;
+            search.searchFile(info.absoluteFilePath(), info.size());
+        }
+    };
+    std::vector<std::thread> threads;
+    const int n = qMin(search.threadCount(), qMax(1, files.size()));
+    threads.reserve(size_t(n));
+    for (int i = 0; i < n; ++i) threads.emplace_back(worker);
+    for (std::thread &t : threads) t.join();
+    return search.finish();
+}
+} // namespace ContentSearch
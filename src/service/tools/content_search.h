@@ -0,0 +1,66 @@
+// In-process parallel content search for search_content when ripgrep is unavailable
+#ifndef CONTENT_SEARCH_H
+#define CONTENT_SEARCH_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+// 内置内容检索：语义对齐 search_content 调用 rg 时的参数
+// （--fixed-strings --ignore-case --max-count 3 --max-filesize 2000K，跳过隐藏文件与 .gitignore 中的路径）
+// - 多个工作线程共享目录队列，边遍历边检索；也可以直接给出候选文件（工作区索引）
+// - 文件经 QFile::map 映射后整体查找子串，命中后才回溯行首并计算行号
+// - 前 8KB 含 NUL 视为二进制跳过；达到命中上限或 cancelled() 为真时所有线程提前退出
+namespace ContentSearch
+{
+struct Options
+{
+    QString query;
+    QString filePattern; // 通配符，匹配相对 root 的路径
+    bool ignoreCase = true;
+    int maxMatches = 200;
+    int maxPerFile = 3;
+    qint64 maxFileSize = 2000 * 1024;
+    int threads = 0; // <= 0 时取 QThread::idealThreadCount()
+    std::function<bool()> cancelled;
+};
+
+struct Result
+{
+    QStringList lines; // "相对路径:行号:行内容"，按路径、行号排序
+    int filesScanned = 0;
+    int binarySkipped = 0;
+    qint64 bytesScanned = 0;
+    bool truncated = false; // 达到 maxMatches 后提前结束
+    QStringList skippedDirs; // 因忽略规则未进入的目录（绝对路径，仅 searchTree 填写）
+};
+
+// 并行遍历 root 并检索（遵循根目录 .gitignore 与常见重型目录）
+Result searchTree(const QString &root, const Options &options);
+// 只检索给定的文件（绝对路径，通常来自工作区索引，已经过目录忽略规则）
+Result searchFiles(const QString &root, const QStringList &files, const Options &options);
+
+// 定长子串查找：首字节无大小写变体时用 memchr 定位候选，否则用 Horspool 跳表；
+// 忽略大小写只折叠 ASCII，查询含其它有大小写的字符时 byteMode() 为 false，需要逐行按 QString 比较
+class Matcher
+{
+  public:
+    Matcher(const QString &query, bool ignoreCase);
+    bool byteMode() const { return byteMode_; }
+    // 返回 [from, size) 内第一个命中的偏移，找不到返回 -1
+    qint64 find(const char *data, qint64 size, qint64 from) const;
+    bool matchesLine(const QString &line) const;
+
+  private:
+    QString query_;
+    QByteArray needle_; // UTF-8，忽略大小写时已转为小写
+    bool ignoreCase_ = true;
+    bool byteMode_ = true;
+    bool firstByteCased_ = false;
+    int skip_[256];
+};
+} // namespace ContentSearch
+
+#endif // CONTENT_SEARCH_H
@@ -0,0 +1,194 @@
+#include "line_index.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+namespace
+{
+constexpr qint64 kBlockSize = 256 * 1024;
+
+QString decodeLine(const QByteArray &bytes, int line)
+{
+    if (line == 1 && bytes.startsWith("\xEF\xBB\xBF")) return QString::fromUtf8(bytes.constData() + 3, bytes.size() - 3);
+    return QString::fromUtf8(bytes);
+}
+} // namespace
+
+LineIndexCache::LineIndexCache(int capacity)
+    : capacity_(std::max(1, capacity))
+{
+}
+
+LineIndexCache &LineIndexCache::shared()
+{
+    static LineIndexCache instance;
+    return instance;
+}
+
+bool LineIndexCache::read(const QString &path, int start, int end, Window *out, QString *error)
+{
+    start = std::max(1, start);
+    end = std::max(start, end);
+
+    const QFileInfo info(path);
+    QFile file(path);
+    if (!info.isFile() || !file.open(QIODevice::ReadOnly))
+    {
+        if (error) *error = QStringLiteral("cannot open file: %1").arg(path);
+        return false;
+    }
+    const QString key = info.absoluteFilePath();
+    const qint64 size = file.size();
+    const qint64 mtimeMs = info.lastModified().toMSecsSinceEpoch();
+
+    // 取出索引的副本，扫描时不持锁；结束后写回扫描得更远的那份
+    Entry entry;
+    {
+        QMutexLocker locker(&mutex_);
+        const auto it = entries_.constFind(key);
+        if (it != entries_.constEnd() && it->size == size && it->mtimeMs == mtimeMs) entry = it.value();
+    }
+    entry.size = size;
+    entry.mtimeMs = mtimeMs;
+
+    Window window;
+    window.firstLine = start;
+    qint64 scanned = 0;
+    if (!entry.complete || start <= entry.totalLines)
+    {
+        int line = entry.knownLines;
+        qint64 pos = entry.knownPos;
+        if (start < entry.knownLines)
+        {
+            const int k = std::min((start - 1) / kStride, entry.checkpoints.size() - 1);
+            line = k * kStride + 1;
+            pos = entry.checkpoints.at(k);
+        }
+        scanned = scan(file, entry, pos, line, start, end, &window.lines);
+    }
+    window.totalLines = entry.complete ? entry.totalLines : -1;
+
+    {
+        QMutexLocker locker(&mutex_);
+        bytesScanned_ += quint64(scanned);
+        auto it = entries_.find(key);
+        if (it == entries_.end() || it->size != size || it->mtimeMs != mtimeMs || it->knownLines < entry.knownLines || (entry.complete && !it->complete))
+        {
+            if (it == entries_.end() && entries_.size() >= capacity_)
+            {
+                // 淘汰最久未用的文件
+                auto oldest = entries_.begin();
+                for (auto e = entries_.begin(); e != entries_.end(); ++e)
+                    if (e->lastUse < oldest->lastUse) oldest = e;
+                entries_.erase(oldest);
+            }
+            it = entries_.insert(key, entry);
+        }
+        it->lastUse = ++useClock_;
+    }
+
+    if (out) *out = window;
+    return true;
+}
+
+qint64 LineIndexCache::scan(QFile &file, Entry &entry, qint64 pos, int line, int start, int end, QStringList *collected)
+{
+    if (!file.seek(pos)) return 0;
+    qint64 bytes = 0;
+    QByteArray block;
+    qint64 blockStart = pos;
+    int at = 0;
+    auto refill = [&]() -> bool
+    {
+        blockStart += block.size();
+        block = file.read(kBlockSize);
+        at = 0;
+        bytes += block.size();
+        return !block.isEmpty();
+    };
+
+    qint64 lineStart = pos;
+    QByteArray current; // 收集区间内当前行的字节，可能跨多个块
+    while (line <= end)
+    {
+        if (at >= block.size() && !refill()) break;
+        const char *data = block.constData();
+        const int n = block.size();
+        int i = at;
+        while (i < n && data[i] != '\n' && data[i] != '\r') ++i;
+        const bool inWindow = collected && line >= start;
+        if (inWindow) current.append(data + at, i - at);
+        if (i >= n)
+        {
+            at = n; // 行跨块，继续读
+            continue;
+        }
+        qint64 next = blockStart + i + 1;
+        at = i + 1;
+        if (data[i] == '\r')
+        {
+            // \r\n 作为一个换行；\n 可能落在下一个块开头
+            if (at < n)
+            {
+                if (data[at] == '\n')
+                {
+                    ++at;
+                    ++next;
+                }
+            }
+            else if (refill() && block.at(0) == '\n')
+            {
+                at = 1;
+                ++next;
+            }
+        }
+        if (inWindow)
+        {
+            collected->append(decodeLine(current, line));
+            current.clear();
+        }
+        ++line;
+        lineStart = next;
+        noteLineStart(entry, line, next);
+    }
+
+    if (line <= end)
+    {
+        // 读到文件末尾：最后一行可能没有换行结尾
+        const bool unterminated = lineStart < entry.size;
+        if (unterminated && collected && line >= start) collected->append(decodeLine(current, line));
+        entry.complete = true;
+        entry.totalLines = unterminated ? line : line - 1;
+    }
+    return bytes;
+}
+
+void LineIndexCache::noteLineStart(Entry &entry, int line, qint64 pos)
+{
+    if (line <= entry.knownLines) return;
+    entry.knownLines = line;
+    entry.knownPos = pos;
+    if ((line - 1) % kStride == 0 && entry.checkpoints.size() == (line - 1) / kStride) entry.checkpoints.append(pos);
+}
+
+int LineIndexCache::size() const
+{
+    QMutexLocker locker(&mutex_);
+    return entries_.size();
+}
+
+void LineIndexCache::clear()
+{
+    QMutexLocker locker(&mutex_);
+    entries_.clear();
+}
+
+quint64 LineIndexCache::bytesScanned() const
+{
+    QMutexLocker locker(&mutex_);
+    return bytesScanned_;
+}
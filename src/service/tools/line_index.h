@@ -0,0 +1,66 @@
+// Random-access line reads for read_file on large files
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QFile;
+
+// 行偏移索引缓存：read_file 只取少量行时不再把整个文件读进内存再 split。
+// - 每个文件记录稀疏的行起点（每 kStride 行一个字节偏移），定位时从最近的检查点向后流式读取
+// - 索引按需向后扩展：只读前 N 行时只扫描到第 N 行；扫到文件末尾后才知道总行数
+// - 以 大小 + 修改时间 判断失效；线程安全，扫描过程不持锁
+// 换行规则与 normalizeNewlines() 一致：\r\n、\r、\n 都算一行结束，末尾换行不产生空行；首行的 UTF-8 BOM 会被去掉
+class LineIndexCache
+{
+  public:
+    struct Window
+    {
+        QStringList lines;   // 请求区间内实际存在的行（不含换行符）
+        int firstLine = 0;   // lines[0] 的行号（1 起）
+        int totalLines = -1; // 文件总行数；尚未扫描到文件末尾时为 -1
+    };
+
+    static constexpr int kStride = 512;
+
+    explicit LineIndexCache(int capacity = 32);
+
+    static LineIndexCache &shared();
+
+    // 读取第 start..end 行（1 起，闭区间）。start 超出文件行数时 lines 为空，totalLines 为实际行数
+    bool read(const QString &path, int start, int end, Window *out, QString *error);
+
+    int size() const;
+    void clear();
+    // 累计从磁盘读取的字节数（测试/诊断用）
+    quint64 bytesScanned() const;
+
+  private:
+    struct Entry
+    {
+        qint64 size = -1;
+        qint64 mtimeMs = 0;
+        QVector<qint64> checkpoints{0}; // checkpoints[k] = 第 k * kStride + 1 行的起点
+        int knownLines = 1;             // 已知起点的最大行号
+        qint64 knownPos = 0;            // 该行的起点
+        bool complete = false;
+        int totalLines = -1;
+        quint64 lastUse = 0;
+    };
+
+    // 从 pos（第 line 行的起点）向后读到第 end 行或文件末尾，收集 start 起的行；返回读取的字节数
+    static qint64 scan(QFile &file, Entry &entry, qint64 pos, int line, int start, int end, QStringList *collected);
+    static void noteLineStart(Entry &entry, int line, qint64 pos);
+
+    mutable QMutex mutex_;
+    QHash<QString, Entry> entries_;
+    int capacity_;
+    quint64 useClock_ = 0;
+    quint64 bytesScanned_ = 0;
+};
+
+#endif // LINE_INDEX_H
@@ -94,7 +94,7 @@ QVector<ToolRegistry::Entry> &mutableEntries()
          QStringLiteral("向知识库提问，问题越详细越好。知识库会返回与问题相似度最高的三个文本段。知识库描述：{embeddingdb describe}")},
         {promptx::PROMPT_TOOL_SD,
          QStringLiteral("stablediffusion"),
-         QStringLiteral(R"({"type":"object","properties":{"prompt":{"type":"string","description":"Describe the image you want to draw."}},"required":["prompt"]})"),
+         QStringLiteral(R"({"type":"object","properties":{"prompt":{"type":"string","description":"Describe the image you want to draw."},"count":{"type":"integer","description":"Optional number of images to generate (1-8), default 1."},"seed":{"type":"integer","description":"Optional base seed; with count > 1 each image uses seed+i. Omit for random."}},"required":["prompt"]})"),
          QStringLiteral("Describe the image you want to draw with a paragraph of English text. The tool will send the text to the drawing model and then return the drawn image, making sure to input English. You can add modifiers or phrases to improve the quality of the image before the text and separate them with commas."),
          QStringLiteral("用一段英文文本描述你想绘制的图像。工具会把文本发送到绘图模型并返回生成的图像，请确保输入英文。你可以在文本前添加修饰词或短语并用逗号分隔以提升质量。")},
         {promptx::PROMPT_TOOL_EXECUTE,
@@ -144,18 +144,20 @@ QVector<ToolRegistry::Entry> &mutableEntries()
          QStringLiteral("将任务升级给系统工程师。参数含 engineer_id 与 task。task 应描述目标、上下文与约束。工程师返回 <=200 字摘要。复用 engineer_id 可保留记忆；使用新 id 则从头开始。")},
         {promptx::PROMPT_TOOL_MONITOR,
          QStringLiteral("monitor"),
-         QStringLiteral(R"({"type":"object","properties":{"wait_ms":{"type":"integer","minimum":0,"maximum":30000},"note":{"type":"string"}},"required":["wait_ms"],"additionalProperties":false})"),
+         QStringLiteral(R"({"type":"object","properties":{"wait_ms":{"type":"integer","minimum":0,"maximum":30000},"until":{"type":"string","enum":["change","settle"]},"timeout_ms":{"type":"integer","minimum":1000,"maximum":55000},"settle_ms":{"type":"integer","minimum":200,"maximum":10000},"fps":{"type":"integer","minimum":1,"maximum":10},"bbox":{"type":"array","items":{"type":"number"},"minItems":4,"maxItems":4},"note":{"type":"string"}},"additionalProperties":false})"),
          QStringLiteral(
              "Desktop monitor:\n"
              "- Use only when you need to watch the screen and wait for a UI change.\n"
-             "- One call waits `wait_ms` ms, then you will receive a fresh screenshot.\n"
-             "- After each screenshot: if not ready, call monitor again (use backoff); if ready, stop monitoring and call controller.\n"
+             "- Prefer `until`: \"change\" returns as soon as the screen (or `bbox` [x1,y1,x2,y2] in controller coordinates) changes; \"settle\" returns once it stops changing for `settle_ms`. Gives up after `timeout_ms`.\n"
+             "- Without `until`, one call waits `wait_ms` ms, then you will receive a fresh screenshot.\n"
+             "- After each screenshot: if not ready, call monitor again; if ready, stop monitoring and call controller.\n"
              "- Do not loop forever: stop after reasonable attempts/time and ask the user."),
          QStringLiteral(
              "桌面监视器：\n"
              "- 仅在需要观察屏幕变化时使用。\n"
-             "- 每次调用等待 `wait_ms` 毫秒，然后获得新的截图。\n"
-             "- 每次截图后：未就绪则再次调用 monitor（可退避），就绪则停止监视并调用 controller。\n"
+             "- 优先使用 `until`：\"change\" 在屏幕（或 `bbox` [x1,y1,x2,y2]，controller 坐标）变化时立即返回；\"settle\" 在画面持续 `settle_ms` 不再变化后返回；超过 `timeout_ms` 放弃。\n"
+             "- 不指定 `until` 时，每次调用等待 `wait_ms` 毫秒，然后获得新的截图。\n"
+             "- 每次截图后：未就绪则再次调用 monitor，就绪则停止监视并调用 controller。\n"
              "- 不要无限循环：合理次数/时间后停止并询问用户。")},
         {promptx::PROMPT_TOOL_SKILL_CALL,
          QStringLiteral("skill_call"),
@@ -165,8 +167,8 @@ QVector<ToolRegistry::Entry> &mutableEntries()
         {promptx::PROMPT_TOOL_SCHEDULE_TASK,
          QStringLiteral("schedule_task"),
          QStringLiteral(R"({"type":"object","properties":{"action":{"type":"string","enum":["add","update","remove","enable","disable","get","list","run"]},"job":{"type":"object","properties":{"job_id":{"type":"string"},"name":{"type":"string"},"schedule":{"type":"object","properties":{"kind":{"type":"string","enum":["at","every","cron"]},"at":{"type":"string"},"every_ms":{"type":"integer","minimum":1000},"cron":{"type":"string"},"tz":{"type":"string"}},"required":["kind"]},"session":{"type":"string","enum":["main","isolated"]},"payload":{"type":"object","properties":{"message":{"type":"string"}}},"deliver":{"type":"object"},"enabled":{"type":"boolean"},"delete_after_run":{"type":"boolean"},"dedupe_key":{"type":"string"}}}},"required":["action"]})"),
-         QStringLiteral("Manage scheduled jobs. Use action add/update/remove/enable/disable/get/list/run. For add/update, provide job.schedule and payload.message."),
-         QStringLiteral("定时任务管理：action 支持 add/update/remove/enable/disable/get/list/run。add/update 需提供 job.schedule 与 payload.message。")},
+         QStringLiteral("Manage scheduled jobs. Use action add/update/remove/enable/disable/get/list/run. For add/update, provide job.schedule and payload.message. session=isolated runs the job as a single background request on an idle server slot instead of the main chat."),
+         QStringLiteral("定时任务管理：action 支持 add/update/remove/enable/disable/get/list/run。add/update 需提供 job.schedule 与 payload.message。session=isolated 时任务作为单轮后台请求在空闲 slot 上运行，不进入主对话。")},
     };
     static bool metadataApplied = false;
     if (!metadataApplied)
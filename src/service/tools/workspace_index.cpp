@@ -0,0 +1,502 @@
+#include "workspace_index.h"
+
+#include "utils/flowtracer.h"
+#include "xconfig.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QPointer>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+quint64 nextGeneration()
+{
+    // 全局单调递增：切换根目录后也不会与旧快照缓存的代号撞车
+    static std::atomic<quint64> counter{0};
+    return ++counter;
+}
+
+QString joinPath(const QString &dir, const QString &name)
+{
+    return dir.endsWith(QLatin1Char('/')) ? dir + name : dir + QLatin1Char('/') + name;
+}
+
+QString cleanedPath(const QString &path)
+{
+    return QDir::cleanPath(QDir::fromNativeSeparators(path.trimmed()));
+}
+
+QString canonicalOr(const QString &path)
+{
+    const QString canonical = QFileInfo(path).canonicalFilePath();
+    return canonical.isEmpty() ? path : canonical;
+}
+
+bool isUnder(const QString &path, const QString &dir)
+{
+    return path == dir || path.startsWith(dir.endsWith(QLatin1Char('/')) ? dir : dir + QLatin1Char('/'));
+}
+} // namespace
+
+WorkspaceIndex::WorkspaceIndex(QObject *parent)
+    : QObject(parent)
+{
+    watcher_ = new QFileSystemWatcher(this);
+    debounce_ = new QTimer(this);
+    debounce_->setSingleShot(true);
+    debounce_->setInterval(WORKSPACE_INDEX_DEBOUNCE_MS);
+    connect(watcher_, &QFileSystemWatcher::directoryChanged, this, &WorkspaceIndex::onDirectoryChanged);
+    connect(debounce_, &QTimer::timeout, this, &WorkspaceIndex::flushPending);
+}
+
+WorkspaceIndex::~WorkspaceIndex() = default;
+
+WorkspaceIndex *WorkspaceIndex::shared()
+{
+    static QPointer<WorkspaceIndex> instance = []()
+    {
+        auto *thread = new QThread;
+        thread->setObjectName(QStringLiteral("workspace_index"));
+        auto *index = new WorkspaceIndex;
+        index->moveToThread(thread);
+        // 与 main.cpp 中的工作线程一致：线程结束时在线程内释放索引（含 watcher/定时器）
+        QObject::connect(thread, &QThread::finished, index, &QObject::deleteLater);
+        if (QCoreApplication *app = QCoreApplication::instance())
+        {
+            // 首次调用可能来自工具线程：线程对象交给主线程并挂到 app 下，随 app 一起释放
+            thread->moveToThread(app->thread());
+            thread->setParent(app);
+            QObject::connect(app, &QCoreApplication::aboutToQuit, thread, [thread]()
+                             {
+                                 thread->requestInterruption(); // 让进行中的全量扫描尽快返回
+                                 thread->quit();
+                                 // 仍未退出时不随 app 析构，避免销毁运行中的线程
+                                 if (!thread->wait(2000)) thread->setParent(nullptr); });
+        }
+        thread->start(QThread::LowPriority);
+        return QPointer<WorkspaceIndex>(index);
+    }();
+    return instance.data();
+}
+
+void WorkspaceIndex::setRoot(const QString &root)
+{
+    const QString cleaned = cleanedPath(root);
+    if (cleaned.isEmpty()) return;
+    const QString canonical = canonicalOr(cleaned);
+    {
+        QWriteLocker locker(&lock_);
+        if (requestedRoot_ == canonical)
+        {
+            // 同一目录的不同写法（符号链接/未规范化）记为别名，查询时映射回规范路径
+            if (cleaned != canonical && !rootAliases_.contains(cleaned)) rootAliases_ << cleaned;
+            return;
+        }
+        requestedRoot_ = canonical;
+        rootAliases_.clear();
+        if (cleaned != canonical) rootAliases_ << cleaned;
+        ready_ = false; // 旧根的数据不能再回答新根的查询
+    }
+    QMetaObject::invokeMethod(this, [this, canonical]()
+                              { rebuild(canonical); }, Qt::QueuedConnection);
+}
+
+void WorkspaceIndex::notifyPathChanged(const QString &path)
+{
+    const QString cleaned = cleanedPath(path);
+    if (cleaned.isEmpty()) return;
+    QMetaObject::invokeMethod(this, [this, cleaned]()
+                              {
+                                  QString dir;
+                                  {
+                                      QReadLocker locker(&lock_);
+                                      if (!ready_) return;
+                                      dir = normalize(cleaned);
+                                      if (!isUnder(dir, root_)) return;
+                                      // 目录本身被改动（如删除）时同时刷新父目录的子项列表
+                                      if (dirs_.contains(dir) && dir != root_) pendingDirs_.insert(dir);
+                                      // 新建的多级目录尚未入索引：向上找到最近的已索引祖先
+                                      do
+                                      {
+                                          dir = QFileInfo(dir).absolutePath();
+                                      } while (!dirs_.contains(dir) && dir != root_ && isUnder(dir, root_));
+                                  }
+                                  pendingDirs_.insert(dir);
+                                  debounce_->start(); }, Qt::QueuedConnection);
+}
+
+QString WorkspaceIndex::root() const
+{
+    QReadLocker locker(&lock_);
+    return root_;
+}
+
+bool WorkspaceIndex::covers(const QString &root) const
+{
+    QReadLocker locker(&lock_);
+    if (!ready_) return false;
+    if (root.isEmpty()) return true;
+    return normalize(cleanedPath(root)) == root_;
+}
+
+quint64 WorkspaceIndex::generation() const
+{
+    QReadLocker locker(&lock_);
+    return generation_;
+}
+
+QString WorkspaceIndex::normalize(const QString &path) const
+{
+    // 调用方需已持有 lock_
+    const QString cleaned = cleanedPath(path);
+    for (const QString &alias : rootAliases_)
+    {
+        if (isUnder(cleaned, alias)) return root_ + cleaned.mid(alias.size());
+    }
+    return cleaned;
+}
+
+bool WorkspaceIndex::children(const QString &absDir, QVector<Entry> *out) const
+{
+    QReadLocker locker(&lock_);
+    if (!ready_) return false;
+    const auto it = dirs_.constFind(normalize(absDir));
+    if (it == dirs_.constEnd()) return false;
+    if (out) *out = it.value();
+    return true;
+}
+
+QVector<WorkspaceIndex::Entry> WorkspaceIndex::entriesFor(const QString &absDir, bool *fromIndex) const
+{
+    QVector<Entry> entries;
+    const bool hit = children(absDir, &entries);
+    if (fromIndex) *fromIndex = hit;
+    if (hit) return entries;
+    return readDirectory(absDir);
+}
+
+bool WorkspaceIndex::files(const QString &absDir, QVector<FileRef> *out, int limit, QStringList *skippedDirs) const
+{
+    if (!out) return false;
+    QReadLocker locker(&lock_);
+    if (!ready_) return false;
+    const QString start = normalize(absDir);
+    if (!dirs_.contains(start)) return false;
+    out->clear();
+    if (skippedDirs) skippedDirs->clear();
+    QStringList stack{start};
+    while (!stack.isEmpty())
+    {
+        const QString dir = stack.takeLast();
+        const QVector<Entry> entries = dirs_.value(dir);
+        for (const Entry &entry : entries)
+        {
+            const QString path = joinPath(dir, entry.name);
+            if (entry.isDir)
+            {
+                if (entry.ignored)
+                {
+                    if (skippedDirs) skippedDirs->append(path);
+                    continue;
+                }
+                if (!dirs_.contains(path)) return false; // 超出目录上限，子树不完整
+                stack << path;
+                continue;
+            }
+            out->append({path, entry.size});
+            if (out->size() >= limit) return true;
+        }
+    }
+    return true;
+}
+
+QStringList WorkspaceIndex::completePath(const QString &partial, int limit) const
+{
+    QStringList out;
+    QReadLocker locker(&lock_);
+    if (!ready_ || limit <= 0) return out;
+
+    QString rel = cleanedPath(partial);
+    if (QDir::isAbsolutePath(rel))
+    {
+        rel = normalize(rel);
+        if (!isUnder(rel, root_)) return out;
+        rel = rel.mid(root_.size());
+    }
+    while (rel.startsWith(QLatin1Char('/'))) rel.remove(0, 1);
+    if (rel == QStringLiteral(".")) rel.clear();
+
+    const int slash = rel.lastIndexOf(QLatin1Char('/'));
+    const QString dirRel = slash >= 0 ? rel.left(slash) : QString();
+    const QString prefix = slash >= 0 ? rel.mid(slash + 1) : rel;
+    const QString dirAbs = dirRel.isEmpty() ? root_ : joinPath(root_, dirRel);
+    const auto relOf = [this](const QString &dir, const Entry &entry)
+    {
+        QString path = QDir(root_).relativeFilePath(joinPath(dir, entry.name));
+        if (entry.isDir) path += QLatin1Char('/');
+        return path;
+    };
+
+    const auto it = dirs_.constFind(dirAbs);
+    if (it != dirs_.constEnd())
+    {
+        for (const Entry &entry : it.value())
+        {
+            if (!entry.name.startsWith(prefix, Qt::CaseInsensitive)) continue;
+            out << relOf(dirAbs, entry);
+            if (out.size() >= limit) return out;
+        }
+    }
+    if (!out.isEmpty() || prefix.isEmpty()) return out;
+
+    // 目录写错时按文件名在整个索引中找同名项，用于 “Did you mean” 提示
+    for (auto dirIt = dirs_.constBegin(); dirIt != dirs_.constEnd(); ++dirIt)
+    {
+        for (const Entry &entry : dirIt.value())
+        {
+            if (entry.name.compare(prefix, Qt::CaseInsensitive) == 0) out << relOf(dirIt.key(), entry);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    if (out.size() > limit) out = out.mid(0, limit);
+    return out;
+}
+
+QVector<WorkspaceIndex::Entry> WorkspaceIndex::readDirectory(const QString &absDir)
+{
+    QVector<Entry> entries;
+    const QFileInfoList infos = QDir(absDir).entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot,
+                                                           QDir::Name | QDir::IgnoreCase | QDir::LocaleAware);
+    entries.reserve(infos.size());
+    for (const QFileInfo &info : infos)
+    {
+        Entry entry;
+        entry.name = info.fileName();
+        entry.isDir = info.isDir();
+        entry.ignored = entry.isDir && info.isSymLink(); // 不跟随目录符号链接，避免环路
+        entry.size = entry.isDir ? 0 : info.size();
+        entry.mtimeMs = info.lastModified().toMSecsSinceEpoch();
+        entries.append(entry);
+    }
+    return entries;
+}
+
+void WorkspaceIndex::loadIgnoreRules(const QString &root)
+{
+    scanRoot_ = root;
+    ignoredNames_ = {QStringLiteral(".git"), QStringLiteral(".hg"), QStringLiteral(".svn"),
+                     QStringLiteral("node_modules"), QStringLiteral("__pycache__"), QStringLiteral(".venv"),
+                     QStringLiteral("venv"), QStringLiteral(".mypy_cache"), QStringLiteral(".pytest_cache"),
+                     QStringLiteral(".gradle"), QStringLiteral(".idea"), QStringLiteral(".vs"),
+                     QStringLiteral("CMakeFiles")};
+    ignoredNamePatterns_.clear();
+    ignoredPathPatterns_.clear();
+
+    // 只解析根目录 .gitignore 中的目录级模式；否定规则（!）与文件级细节交给 rg 处理
+    QFile file(joinPath(root, QStringLiteral(".gitignore")));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    while (!in.atEnd())
+    {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')) || line.startsWith(QLatin1Char('!'))) continue;
+        while (line.endsWith(QLatin1Char('/'))) line.chop(1);
+        if (line.startsWith(QStringLiteral("**/"))) line.remove(0, 3);
+        const bool anchored = line.contains(QLatin1Char('/'));
+        while (line.startsWith(QLatin1Char('/'))) line.remove(0, 1);
+        if (line.isEmpty()) continue;
+        const bool wildcard = line.contains(QLatin1Char('*')) || line.contains(QLatin1Char('?')) || line.contains(QLatin1Char('['));
+        if (!anchored && !wildcard)
+        {
+            ignoredNames_.insert(line);
+            continue;
+        }
+        const QRegularExpression re(QRegularExpression::wildcardToRegularExpression(line));
+        if (!re.isValid()) continue;
+        if (anchored)
+            ignoredPathPatterns_ << re;
+        else
+            ignoredNamePatterns_ << re;
+    }
+}
+
+bool WorkspaceIndex::isIgnoredDir(const QString &absPath, const QString &name) const
+{
+    if (ignoredNames_.contains(name)) return true;
+    for (const QRegularExpression &re : ignoredNamePatterns_)
+    {
+        if (re.match(name).hasMatch()) return true;
+    }
+    if (ignoredPathPatterns_.isEmpty()) return false;
+    const QString rel = QDir(scanRoot_).relativeFilePath(absPath);
+    for (const QRegularExpression &re : ignoredPathPatterns_)
+    {
+        if (re.match(rel).hasMatch()) return true;
+    }
+    return false;
+}
+
+void WorkspaceIndex::scanTree(const QString &absDir, DirMap &dirs, int maxDirs) const
+{
+    // 广度优先：目录数达到上限时保留浅层，深层目录回退到读盘
+    QStringList queue{absDir};
+    while (!queue.isEmpty() && dirs.size() < maxDirs)
+    {
+        if (QThread::currentThread()->isInterruptionRequested()) return;
+        const QString dir = queue.takeFirst();
+        QVector<Entry> entries = readDirectory(dir);
+        for (Entry &entry : entries)
+        {
+            if (!entry.isDir || entry.ignored) continue;
+            const QString child = joinPath(dir, entry.name);
+            if (isIgnoredDir(child, entry.name))
+            {
+                entry.ignored = true;
+                continue;
+            }
+            queue << child;
+        }
+        dirs.insert(dir, entries);
+    }
+}
+
+void WorkspaceIndex::rebuild(const QString &root)
+{
+    {
+        QReadLocker locker(&lock_);
+        if (requestedRoot_ != root) return; // 已被更新的 setRoot 取代
+    }
+    QElapsedTimer timer;
+    timer.start();
+    loadIgnoreRules(root);
+    DirMap dirs;
+    if (QFileInfo(root).isDir()) scanTree(root, dirs, WORKSPACE_INDEX_MAX_DIRS);
+    if (QThread::currentThread()->isInterruptionRequested()) return; // 程序退出中，不发布残缺的索引
+
+    const QStringList watched = watcher_->directories();
+    if (!watched.isEmpty()) watcher_->removePaths(watched);
+    pendingDirs_.clear();
+    if (!dirs.isEmpty()) watcher_->addPaths(dirs.keys());
+
+    quint64 generation = 0;
+    int dirCount = 0;
+    {
+        QWriteLocker locker(&lock_);
+        if (requestedRoot_ != root) return;
+        dirs_.swap(dirs);
+        root_ = root;
+        ready_ = !dirs_.isEmpty();
+        generation = generation_ = nextGeneration();
+        dirCount = dirs_.size();
+    }
+    FlowTracer::log(FlowChannel::Tool, QStringLiteral("workspace index: %1 dirs under %2 (%3 ms)")
+                                           .arg(dirCount)
+                                           .arg(QDir::toNativeSeparators(root))
+                                           .arg(timer.elapsed()));
+    emit indexed(root, dirCount);
+    emit changed(generation);
+}
+
+void WorkspaceIndex::onDirectoryChanged(const QString &path)
+{
+    pendingDirs_.insert(cleanedPath(path));
+    debounce_->start();
+}
+
+void WorkspaceIndex::dropSubtree(const QString &absDir, QStringList *removedDirs)
+{
+    // 调用方需已持有写锁
+    for (auto it = dirs_.begin(); it != dirs_.end();)
+    {
+        if (isUnder(it.key(), absDir))
+        {
+            if (removedDirs) removedDirs->append(it.key());
+            it = dirs_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void WorkspaceIndex::flushPending()
+{
+    if (pendingDirs_.isEmpty()) return;
+    QStringList pending = pendingDirs_.values();
+    pendingDirs_.clear();
+    std::sort(pending.begin(), pending.end()); // 父目录先于子目录处理
+
+    // dirs_ 只在本线程修改，读取无需加锁；磁盘扫描放在锁外，写锁只覆盖替换过程
+    bool changedAny = false;
+    QStringList unwatch;
+    QStringList watch;
+    for (const QString &dir : pending)
+    {
+        const auto it = dirs_.constFind(dir);
+        if (it == dirs_.constEnd()) continue;
+        if (!QFileInfo(dir).isDir())
+        {
+            QWriteLocker locker(&lock_);
+            dropSubtree(dir, &unwatch);
+            changedAny = true;
+            continue;
+        }
+
+        QSet<QString> oldDirs;
+        for (const Entry &entry : it.value())
+        {
+            if (entry.isDir && !entry.ignored) oldDirs.insert(entry.name);
+        }
+        QVector<Entry> fresh = readDirectory(dir);
+        QSet<QString> keptDirs;
+        DirMap added;
+        const int budget = qMax(0, WORKSPACE_INDEX_MAX_DIRS - dirs_.size());
+        for (Entry &entry : fresh)
+        {
+            if (!entry.isDir || entry.ignored) continue;
+            const QString child = joinPath(dir, entry.name);
+            if (isIgnoredDir(child, entry.name))
+            {
+                entry.ignored = true;
+                continue;
+            }
+            keptDirs.insert(entry.name);
+            if (!oldDirs.contains(entry.name)) scanTree(child, added, qMax(0, budget - added.size()));
+        }
+
+        QWriteLocker locker(&lock_);
+        for (const QString &name : oldDirs)
+        {
+            if (!keptDirs.contains(name)) dropSubtree(joinPath(dir, name), &unwatch);
+        }
+        dirs_.insert(dir, fresh);
+        for (auto addIt = added.constBegin(); addIt != added.constEnd(); ++addIt)
+        {
+            dirs_.insert(addIt.key(), addIt.value());
+            watch << addIt.key();
+        }
+        changedAny = true;
+    }
+    if (!unwatch.isEmpty()) watcher_->removePaths(unwatch);
+    if (!watch.isEmpty()) watcher_->addPaths(watch);
+    if (!changedAny) return;
+
+    quint64 generation = 0;
+    {
+        QWriteLocker locker(&lock_);
+        generation = generation_ = nextGeneration();
+    }
+    emit changed(generation);
+}
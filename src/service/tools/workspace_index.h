@@ -0,0 +1,103 @@
+// Incremental in-memory index of the engineer workspace
+#ifndef WORKSPACE_INDEX_H
+#define WORKSPACE_INDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+class QFileSystemWatcher;
+class QTimer;
+
+// 工作区索引：在后台线程维护工作目录的内存目录树（名称/大小/修改时间），
+// 由 QFileSystemWatcher 推送的目录变化增量刷新，供工作区快照、list_files、
+// search_content 回退扫描与路径补全复用，避免每次调用都重新遍历磁盘。
+// - 查询接口线程安全；目录未被索引（尚未建好/被忽略/超出上限）时返回 false，调用方回退到直接读盘
+// - 忽略规则：常见重型目录与根目录 .gitignore 中的目录模式；被忽略目录仍会出现在列表中，只是不再向下索引
+// - 文件内容变化不会触发目录事件，写文件类工具落盘后应调用 notifyPathChanged() 刷新大小与时间
+class WorkspaceIndex : public QObject
+{
+    Q_OBJECT
+  public:
+    struct Entry
+    {
+        QString name;
+        bool isDir = false;
+        bool ignored = false; // 目录未向下索引（忽略规则或符号链接）
+        qint64 size = 0;
+        qint64 mtimeMs = 0;
+    };
+    struct FileRef
+    {
+        QString absolutePath;
+        qint64 size = 0;
+    };
+
+    explicit WorkspaceIndex(QObject *parent = nullptr);
+    ~WorkspaceIndex() override;
+
+    // 进程内共享实例，运行在独立的低优先级线程上；程序退出（aboutToQuit）后线程结束、实例释放，返回 nullptr
+    static WorkspaceIndex *shared();
+
+    // 切换索引根目录；与当前根相同则忽略，否则在索引线程上后台重建
+    void setRoot(const QString &root);
+    // 写文件类工具落盘后通知：去抖后重扫所在目录
+    void notifyPathChanged(const QString &path);
+
+    QString root() const;
+    // root 已完成首次索引（root 为空时判断当前根）
+    bool covers(const QString &root = QString()) const;
+    // 每次索引内容变化递增；可替代基于时间的缓存过期
+    quint64 generation() const;
+
+    // 目录的直接子项，按 Name|IgnoreCase|LocaleAware 排序（与工作区快照一致）
+    bool children(const QString &absDir, QVector<Entry> *out) const;
+    // 优先返回索引中的子项，否则直接读盘；fromIndex 标识来源
+    QVector<Entry> entriesFor(const QString &absDir, bool *fromIndex = nullptr) const;
+    // absDir 下（递归、跳过被忽略目录）的全部文件；子树未完整索引时返回 false
+    // skippedDirs 非空时收集被跳过的目录（绝对路径），供调用方在结果中说明
+    bool files(const QString &absDir, QVector<FileRef> *out, int limit, QStringList *skippedDirs = nullptr) const;
+    // 相对根目录的路径补全：先按“目录/前缀”匹配，找不到时按同名文件全局匹配
+    QStringList completePath(const QString &partial, int limit = 8) const;
+
+    static QVector<Entry> readDirectory(const QString &absDir);
+
+  signals:
+    void indexed(const QString &root, int dirs);
+    void changed(quint64 generation);
+
+  private:
+    using DirMap = QHash<QString, QVector<Entry>>;
+
+    QString normalize(const QString &path) const;
+    void rebuild(const QString &root);
+    void loadIgnoreRules(const QString &root);
+    bool isIgnoredDir(const QString &absPath, const QString &name) const;
+    void scanTree(const QString &absDir, DirMap &dirs, int maxDirs) const;
+    void onDirectoryChanged(const QString &path);
+    void flushPending();
+    void dropSubtree(const QString &absDir, QStringList *removedDirs);
+
+    mutable QReadWriteLock lock_;
+    DirMap dirs_;
+    QString root_;        // 规范化（canonical）根目录
+    QStringList rootAliases_; // 调用方传入的其它写法（符号链接/未规范化）
+    QString requestedRoot_;
+    QString scanRoot_; // 仅索引线程使用：计算 .gitignore 相对路径
+    bool ready_ = false;
+    quint64 generation_ = 0;
+
+    QSet<QString> ignoredNames_;
+    QVector<QRegularExpression> ignoredNamePatterns_;
+    QVector<QRegularExpression> ignoredPathPatterns_;
+
+    QFileSystemWatcher *watcher_ = nullptr;
+    QTimer *debounce_ = nullptr;
+    QSet<QString> pendingDirs_;
+};
+
+#endif // WORKSPACE_INDEX_H
@@ -0,0 +1,487 @@
+// history_index.cpp - implementation
+
+#include "storage/history_index.h"
+
+#include <QAtomicInteger>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSet>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QtDebug>
+
+#include <algorithm>
+
+namespace
+{
+constexpr int kSchemaVersion = 1;
+constexpr int kSnippetRadius = 36;
+
+qint64 toMs(const QDateTime &t)
+{
+    return t.isValid() ? t.toMSecsSinceEpoch() : 0;
+}
+
+QDateTime fromMs(qint64 ms)
+{
+    return ms > 0 ? QDateTime::fromMSecsSinceEpoch(ms) : QDateTime();
+}
+
+// LIKE 模式：转义 % _ 与转义符本身
+QString likePattern(const QString &query)
+{
+    QString escaped = query;
+    escaped.replace(QLatin1Char('\\'), QStringLiteral("\\\\"));
+    escaped.replace(QLatin1Char('%'), QStringLiteral("\\%"));
+    escaped.replace(QLatin1Char('_'), QStringLiteral("\\_"));
+    return QLatin1Char('%') + escaped + QLatin1Char('%');
+}
+
+// FTS5 MATCH：整体作为一个短语，避免用户输入被解析成查询语法
+QString matchPhrase(const QString &query)
+{
+    QString escaped = query;
+    escaped.replace(QLatin1Char('"'), QStringLiteral("\"\""));
+    return QLatin1Char('"') + escaped + QLatin1Char('"');
+}
+
+QString makeSnippet(const QString &content, const QString &query)
+{
+    const int pos = content.indexOf(query, 0, Qt::CaseInsensitive);
+    const int begin = pos < 0 ? 0 : qMax(0, pos - kSnippetRadius);
+    const int length = (pos < 0 ? 0 : pos - begin) + query.size() + kSnippetRadius;
+    QString snippet = content.mid(begin, length).simplified();
+    if (begin > 0) snippet.prepend(QStringLiteral("..."));
+    if (begin + length < content.size()) snippet.append(QStringLiteral("..."));
+    return snippet;
+}
+} // namespace
+
+HistoryIndex::HistoryIndex()
+{
+    static QAtomicInteger<int> counter(0);
+    connectionName_ = QStringLiteral("eva_history_index_%1").arg(counter.fetchAndAddRelaxed(1));
+}
+
+HistoryIndex::~HistoryIndex()
+{
+    close();
+}
+
+bool HistoryIndex::open(const QString &dbPath)
+{
+    if (opened_) return true;
+    QDir().mkpath(QFileInfo(dbPath).absolutePath());
+    needsRebuild_ = !QFileInfo::exists(dbPath);
+
+    db_ = QSqlDatabase::addDatabase("QSQLITE", connectionName_);
+    db_.setDatabaseName(dbPath);
+    if (!db_.open())
+    {
+        qWarning() << "HistoryIndex open failed:" << db_.lastError().text();
+        close();
+        return false;
+    }
+    QSqlQuery pragma(db_);
+    pragma.exec("PRAGMA journal_mode=WAL");
+    pragma.exec("PRAGMA synchronous=NORMAL");
+    opened_ = ensureSchema();
+    if (!opened_) close();
+    return opened_;
+}
+
+void HistoryIndex::close()
+{
+    if (db_.isValid())
+    {
+        db_.close();
+        db_ = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connectionName_);
+    }
+    opened_ = false;
+}
+
+bool HistoryIndex::ensureSchema()
+{
+    QSqlQuery q(db_);
+    if (!q.exec("CREATE TABLE IF NOT EXISTS meta (key TEXT PRIMARY KEY, value TEXT)"))
+    {
+        qWarning() << "HistoryIndex schema(meta) failed:" << q.lastError().text();
+        return false;
+    }
+    int version = 0;
+    QString mode;
+    if (q.exec("SELECT key, value FROM meta"))
+    {
+        while (q.next())
+        {
+            if (q.value(0).toString() == QLatin1String("schema_version")) version = q.value(1).toInt();
+            if (q.value(0).toString() == QLatin1String("search_mode")) mode = q.value(1).toString();
+        }
+    }
+    if (version != kSchemaVersion)
+    {
+        // 结构过期：直接丢弃，稍后由 JSONL 重建
+        q.exec("DROP TABLE IF EXISTS sessions");
+        q.exec("DROP TABLE IF EXISTS messages_fts");
+        q.exec("DELETE FROM meta");
+        mode.clear();
+        needsRebuild_ = true;
+    }
+
+    if (!q.exec("CREATE TABLE IF NOT EXISTS sessions (\n"
+                "  id TEXT PRIMARY KEY,\n"
+                "  title TEXT NOT NULL DEFAULT '',\n"
+                "  started_at INTEGER NOT NULL DEFAULT 0,\n"
+                "  message_count INTEGER NOT NULL DEFAULT 0\n"
+                ")") ||
+        !q.exec("CREATE INDEX IF NOT EXISTS idx_sessions_started ON sessions(started_at DESC)"))
+    {
+        qWarning() << "HistoryIndex schema(sessions) failed:" << q.lastError().text();
+        return false;
+    }
+
+    if (mode == QLatin1String("trigram"))
+        mode_ = SearchMode::Trigram;
+    else if (mode == QLatin1String("words"))
+        mode_ = SearchMode::Words;
+    else if (mode == QLatin1String("like"))
+        mode_ = SearchMode::Like;
+    else if (!createMessageTable())
+        return false;
+
+    q.prepare("INSERT OR REPLACE INTO meta(key, value) VALUES('schema_version', :v)");
+    q.bindValue(":v", QString::number(kSchemaVersion));
+    return q.exec();
+}
+
+bool HistoryIndex::createMessageTable()
+{
+    QSqlQuery q(db_);
+    const QString columns = QStringLiteral("content, session_id UNINDEXED, seq UNINDEXED, role UNINDEXED");
+    if (q.exec(QStringLiteral("CREATE VIRTUAL TABLE IF NOT EXISTS messages_fts USING fts5(%1, tokenize='trigram')").arg(columns)))
+        mode_ = SearchMode::Trigram;
+    else if (q.exec(QStringLiteral("CREATE VIRTUAL TABLE IF NOT EXISTS messages_fts USING fts5(%1)").arg(columns)))
+        mode_ = SearchMode::Words;
+    else
+    {
+        // SQLite 未编译 FTS5：普通表 + LIKE 扫描，仍免去逐个解析 JSONL
+        if (!q.exec("CREATE TABLE IF NOT EXISTS messages_fts (content TEXT, session_id TEXT, seq INTEGER, role TEXT)") ||
+            !q.exec("CREATE INDEX IF NOT EXISTS idx_messages_session ON messages_fts(session_id)"))
+        {
+            qWarning() << "HistoryIndex schema(messages) failed:" << q.lastError().text();
+            return false;
+        }
+        mode_ = SearchMode::Like;
+    }
+    q.prepare("INSERT OR REPLACE INTO meta(key, value) VALUES('search_mode', :v)");
+    q.bindValue(":v", mode_ == SearchMode::Trigram ? QStringLiteral("trigram") : mode_ == SearchMode::Words ? QStringLiteral("words")
+                                                                                                            : QStringLiteral("like"));
+    return q.exec();
+}
+
+bool HistoryIndex::beginBatch()
+{
+    if (!opened_ || inBatch_) return false;
+    inBatch_ = db_.transaction();
+    return inBatch_;
+}
+
+bool HistoryIndex::commitBatch()
+{
+    if (!inBatch_) return false;
+    inBatch_ = false;
+    if (db_.commit()) return true;
+    qWarning() << "HistoryIndex commit failed:" << db_.lastError().text();
+    db_.rollback();
+    return false;
+}
+
+bool HistoryIndex::beginOwn()
+{
+    return !inBatch_ && db_.transaction();
+}
+
+bool HistoryIndex::commitOwn(bool own)
+{
+    return !own || db_.commit();
+}
+
+bool HistoryIndex::rebuild(const QString &baseDir)
+{
+    if (!opened_) return false;
+    const bool own = beginOwn();
+    clear();
+    const QFileInfoList entries = sessionDirs(baseDir);
+    for (const auto &fi : entries)
+    {
+        QFile f(QDir(fi.absoluteFilePath()).filePath("meta.json"));
+        if (!f.open(QIODevice::ReadOnly)) continue;
+        const QJsonObject o = QJsonDocument::fromJson(f.readAll()).object();
+        f.close();
+        const QString id = o.value("id").toString(fi.fileName());
+        upsertSession(id, o.value("title").toString(), QDateTime::fromString(o.value("started_at").toString(), Qt::ISODate));
+
+        QFile m(QDir(fi.absoluteFilePath()).filePath("messages.jsonl"));
+        if (!m.open(QIODevice::ReadOnly | QIODevice::Text)) continue;
+        int seq = 0;
+        while (!m.atEnd())
+        {
+            const QByteArray line = m.readLine();
+            if (line.trimmed().isEmpty()) continue;
+            QJsonParseError err;
+            const QJsonDocument d = QJsonDocument::fromJson(line, &err);
+            if (err.error != QJsonParseError::NoError) continue;
+            insertMessage(id, seq++, d.object());
+        }
+        QSqlQuery q(db_);
+        q.prepare("UPDATE sessions SET message_count = :n WHERE id = :id");
+        q.bindValue(":n", seq);
+        q.bindValue(":id", id);
+        q.exec();
+    }
+    const bool ok = commitOwn(own);
+    if (ok) needsRebuild_ = false;
+    return ok;
+}
+
+QFileInfoList HistoryIndex::sessionDirs(const QString &baseDir)
+{
+    QFileInfoList out;
+    const QFileInfoList entries = QDir(baseDir).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const auto &fi : entries)
+    {
+        // 没有 meta.json 的目录（建到一半/手工放入）不会进入索引，计数时也不能算上，否则每次启动都会重建
+        if (QFileInfo::exists(QDir(fi.absoluteFilePath()).filePath("meta.json"))) out.append(fi);
+    }
+    return out;
+}
+
+bool HistoryIndex::rebuildIfStale(const QString &baseDir, bool stale)
+{
+    if (!opened_) return false;
+    if (!stale && !needsRebuild_ && sessionCount() == sessionDirs(baseDir).size()) return true;
+    return rebuild(baseDir);
+}
+
+void HistoryIndex::upsertSession(const QString &id, const QString &title, const QDateTime &startedAt)
+{
+    if (!opened_ || id.isEmpty()) return;
+    QSqlQuery q(db_);
+    q.prepare("INSERT INTO sessions(id, title, started_at) VALUES(:id, :t, :s)\n"
+              "ON CONFLICT(id) DO UPDATE SET title = excluded.title, started_at = excluded.started_at");
+    q.bindValue(":id", id);
+    q.bindValue(":t", title);
+    q.bindValue(":s", toMs(startedAt));
+    if (!q.exec()) qWarning() << "HistoryIndex upsertSession failed:" << q.lastError().text();
+}
+
+void HistoryIndex::setTitle(const QString &id, const QString &title)
+{
+    if (!opened_) return;
+    QSqlQuery q(db_);
+    q.prepare("UPDATE sessions SET title = :t WHERE id = :id");
+    q.bindValue(":t", title);
+    q.bindValue(":id", id);
+    if (!q.exec()) qWarning() << "HistoryIndex setTitle failed:" << q.lastError().text();
+}
+
+void HistoryIndex::addMessage(const QString &id, const QJsonObject &msg)
+{
+    if (!opened_ || id.isEmpty()) return;
+    QSqlQuery q(db_);
+    q.prepare("SELECT message_count FROM sessions WHERE id = :id");
+    q.bindValue(":id", id);
+    if (!q.exec() || !q.next()) return; // 会话不在索引中（例如索引打开前创建）：交给下次重建
+    const int seq = q.value(0).toInt();
+    insertMessage(id, seq, msg);
+    q.prepare("UPDATE sessions SET message_count = :n WHERE id = :id");
+    q.bindValue(":n", seq + 1);
+    q.bindValue(":id", id);
+    q.exec();
+}
+
+void HistoryIndex::replaceMessages(const QString &id, const QJsonArray &msgs)
+{
+    if (!opened_ || id.isEmpty()) return;
+    const bool own = beginOwn();
+    QSqlQuery q(db_);
+    q.prepare("DELETE FROM messages_fts WHERE session_id = :id");
+    q.bindValue(":id", id);
+    q.exec();
+    int seq = 0;
+    for (const auto &v : msgs)
+    {
+        const QJsonObject obj = v.toObject();
+        if (obj.isEmpty()) continue;
+        insertMessage(id, seq++, obj);
+    }
+    q.prepare("UPDATE sessions SET message_count = :n WHERE id = :id");
+    q.bindValue(":n", seq);
+    q.bindValue(":id", id);
+    q.exec();
+    commitOwn(own);
+}
+
+void HistoryIndex::insertMessage(const QString &id, int seq, const QJsonObject &msg)
+{
+    const QString text = messageText(msg);
+    if (text.trimmed().isEmpty()) return;
+    QSqlQuery q(db_);
+    q.prepare("INSERT INTO messages_fts(content, session_id, seq, role) VALUES(:c, :id, :seq, :r)");
+    q.bindValue(":c", text);
+    q.bindValue(":id", id);
+    q.bindValue(":seq", seq);
+    q.bindValue(":r", msg.value("role").toString());
+    if (!q.exec()) qWarning() << "HistoryIndex insertMessage failed:" << q.lastError().text();
+}
+
+void HistoryIndex::removeSession(const QString &id)
+{
+    if (!opened_) return;
+    QSqlQuery q(db_);
+    q.prepare("DELETE FROM messages_fts WHERE session_id = :id");
+    q.bindValue(":id", id);
+    q.exec();
+    q.prepare("DELETE FROM sessions WHERE id = :id");
+    q.bindValue(":id", id);
+    q.exec();
+}
+
+void HistoryIndex::clear()
+{
+    if (!opened_) return;
+    QSqlQuery q(db_);
+    q.exec("DELETE FROM messages_fts");
+    q.exec("DELETE FROM sessions");
+}
+
+int HistoryIndex::sessionCount() const
+{
+    if (!opened_) return 0;
+    QSqlQuery q(db_);
+    if (!q.exec("SELECT COUNT(*) FROM sessions") || !q.next()) return 0;
+    return q.value(0).toInt();
+}
+
+QVector<HistoryIndex::SessionRow> HistoryIndex::recent(int offset, int limit) const
+{
+    QVector<SessionRow> out;
+    if (!opened_) return out;
+    QSqlQuery q(db_);
+    q.prepare("SELECT id, title, started_at FROM sessions ORDER BY started_at DESC, id DESC LIMIT :l OFFSET :o");
+    q.bindValue(":l", limit > 0 ? limit : -1);
+    q.bindValue(":o", qMax(0, offset));
+    if (!q.exec()) return out;
+    while (q.next())
+    {
+        SessionRow row;
+        row.id = q.value(0).toString();
+        row.title = q.value(1).toString();
+        row.startedAt = fromMs(q.value(2).toLongLong());
+        out.append(row);
+    }
+    return out;
+}
+
+QVector<HistoryIndex::Hit> HistoryIndex::searchMessages(const QString &query, int limit, bool useMatch) const
+{
+    QVector<Hit> out;
+    QSqlQuery q(db_);
+    // 每个会话只保留最早的命中消息；多取一些行以便去重后仍凑够 limit 个会话
+    const QString where = useMatch ? QStringLiteral("messages_fts MATCH :q") : QStringLiteral("messages_fts.content LIKE :q ESCAPE '\\'");
+    q.prepare(QStringLiteral("SELECT s.id, s.title, s.started_at, messages_fts.role, messages_fts.content FROM messages_fts\n"
+                             "JOIN sessions s ON s.id = messages_fts.session_id\n"
+                             "WHERE %1 ORDER BY s.started_at DESC, s.id DESC, messages_fts.seq ASC LIMIT :l")
+                  .arg(where));
+    q.bindValue(":q", useMatch ? matchPhrase(query) : likePattern(query));
+    q.bindValue(":l", limit * 8);
+    if (!q.exec())
+    {
+        qWarning() << "HistoryIndex search failed:" << q.lastError().text();
+        return out;
+    }
+    QSet<QString> seen;
+    while (q.next() && out.size() < limit)
+    {
+        const QString id = q.value(0).toString();
+        if (seen.contains(id)) continue;
+        seen.insert(id);
+        Hit hit;
+        hit.id = id;
+        hit.title = q.value(1).toString();
+        hit.startedAt = fromMs(q.value(2).toLongLong());
+        hit.role = q.value(3).toString();
+        hit.snippet = makeSnippet(q.value(4).toString(), query);
+        out.append(hit);
+    }
+    return out;
+}
+
+QVector<HistoryIndex::Hit> HistoryIndex::search(const QString &query, int limit) const
+{
+    QVector<Hit> out;
+    const QString needle = query.trimmed();
+    if (!opened_ || needle.isEmpty() || limit <= 0) return out;
+
+    // trigram 要求至少 3 个字符；unicode61 对连续中文不切分，查不到时再退回 LIKE
+    const bool trigramUsable = mode_ == SearchMode::Trigram && needle.size() >= 3;
+    QVector<Hit> messages;
+    if (trigramUsable || mode_ == SearchMode::Words) messages = searchMessages(needle, limit, true);
+    if (!trigramUsable && messages.isEmpty()) messages = searchMessages(needle, limit, false);
+
+    QSqlQuery q(db_);
+    q.prepare("SELECT id, title, started_at FROM sessions WHERE title LIKE :q ESCAPE '\\'\n"
+              "ORDER BY started_at DESC, id DESC LIMIT :l");
+    q.bindValue(":q", likePattern(needle));
+    q.bindValue(":l", limit);
+    QSet<QString> seen;
+    if (q.exec())
+    {
+        while (q.next())
+        {
+            Hit hit;
+            hit.id = q.value(0).toString();
+            hit.title = q.value(1).toString();
+            hit.startedAt = fromMs(q.value(2).toLongLong());
+            seen.insert(hit.id);
+            out.append(hit);
+        }
+    }
+    for (const Hit &hit : messages)
+    {
+        if (seen.contains(hit.id))
+        {
+            // 标题与正文同时命中：补上正文片段
+            for (Hit &existing : out)
+            {
+                if (existing.id != hit.id) continue;
+                existing.role = hit.role;
+                existing.snippet = hit.snippet;
+            }
+            continue;
+        }
+        out.append(hit);
+    }
+    std::stable_sort(out.begin(), out.end(), [](const Hit &a, const Hit &b)
+                     { return a.startedAt > b.startedAt; });
+    if (out.size() > limit) out.resize(limit);
+    return out;
+}
+
+QString HistoryIndex::messageText(const QJsonObject &msg)
+{
+    const QJsonValue content = msg.value("content");
+    if (content.isString()) return content.toString();
+    if (!content.isArray()) return QString();
+    QStringList parts;
+    for (const QJsonValue &pv : content.toArray())
+    {
+        const QString text = pv.toObject().value("text").toString();
+        if (!text.isEmpty()) parts << text;
+    }
+    return parts.join(QLatin1Char('\n'));
+}
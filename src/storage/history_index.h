@@ -0,0 +1,95 @@
+// history_index.h - SQLite index over the per-session history directories
+// Mirrors sessions (id/title/start time) and message text so the history manager
+// can page recent sessions and search all messages without parsing every
+// meta.json / messages.jsonl. The JSONL files stay the source of truth: the
+// index is rebuilt from them when the database file is missing or outdated.
+
+#pragma once
+
+#include <QDateTime>
+#include <QFileInfoList>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+
+class HistoryIndex
+{
+  public:
+    struct SessionRow
+    {
+        QString id;
+        QString title;
+        QDateTime startedAt;
+    };
+    struct Hit
+    {
+        QString id;
+        QString title;
+        QDateTime startedAt;
+        QString role;    // 命中消息的角色；仅标题命中时为空
+        QString snippet; // 命中位置附近的片段；仅标题命中时为空
+    };
+    // 全文检索方式：优先 FTS5 trigram（对中文等无空格文本也能做子串匹配），
+    // 其次 FTS5 unicode61 分词，SQLite 不带 FTS5 时退化为普通表 + LIKE
+    enum class SearchMode
+    {
+        Trigram,
+        Words,
+        Like
+    };
+
+    HistoryIndex();
+    ~HistoryIndex();
+
+    bool open(const QString &dbPath);
+    void close();
+    bool isOpen() const { return opened_; }
+    // 数据库是新建的或结构已过期，需要从 JSONL 重建
+    bool needsRebuild() const { return needsRebuild_; }
+    SearchMode searchMode() const { return mode_; }
+
+    // 扫描 baseDir 下的全部会话目录重建索引（单个事务）
+    bool rebuild(const QString &baseDir);
+    // 可建立索引的会话目录（含 meta.json）；rebuild() 与一致性检查都以它为准
+    static QFileInfoList sessionDirs(const QString &baseDir);
+    // 索引缺失/过期，或会话数与 sessionDirs() 不一致（旧版本写入的会话）时重建；返回是否成功
+    bool rebuildIfStale(const QString &baseDir, bool stale);
+
+    // 批量更新：其间的各项写入共用一个事务，replaceMessages()/rebuild() 不再单独开启事务
+    bool beginBatch();
+    bool commitBatch();
+
+    void upsertSession(const QString &id, const QString &title, const QDateTime &startedAt);
+    void setTitle(const QString &id, const QString &title);
+    void addMessage(const QString &id, const QJsonObject &msg);
+    void replaceMessages(const QString &id, const QJsonArray &msgs);
+    void removeSession(const QString &id);
+    void clear();
+
+    int sessionCount() const;
+    // 按开始时间降序分页
+    QVector<SessionRow> recent(int offset, int limit) const;
+    // 标题与消息全文检索，每个会话最多一条结果，按开始时间降序
+    QVector<Hit> search(const QString &query, int limit) const;
+
+    // 消息中可检索的文本：字符串 content 或多模态数组中的 text 段
+    static QString messageText(const QJsonObject &msg);
+
+  private:
+    bool ensureSchema();
+    bool createMessageTable();
+    void insertMessage(const QString &id, int seq, const QJsonObject &msg);
+    QVector<Hit> searchMessages(const QString &query, int limit, bool useMatch) const;
+    // 不在批量事务中时开启/提交自己的事务
+    bool beginOwn();
+    bool commitOwn(bool own);
+
+    QSqlDatabase db_;
+    QString connectionName_;
+    bool opened_ = false;
+    bool needsRebuild_ = false;
+    bool inBatch_ = false;
+    SearchMode mode_ = SearchMode::Like;
+};
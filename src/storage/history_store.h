@@ -12,6 +12,12 @@
 #include <QString>
 #include <QVector>
 
+#include <memory>
+
+#include "../xconfig.h"
+#include "history_index.h"
+#include "history_writer.h"
+
 // Lightweight session metadata for future retrieval/resume
 struct SessionMeta
 {
@@ -39,7 +45,12 @@ struct SessionMeta
     }
 };
 
-// Append-only JSONL writer: meta.json + messages.jsonl inside a session dir
+// Append-only JSONL writer: meta.json + messages.jsonl inside a session dir.
+// An index.sqlite next to the session dirs mirrors titles and message text for
+// paged listing and full-text search; it is rebuilt from the JSONL files when missing.
+// File writes and index updates go through a background HistoryWriter (group commit,
+// one index transaction per commit); every read flushes it first, and turn end
+// requests an asynchronous fsync.
 class HistoryStore
 {
   public:
@@ -49,13 +60,28 @@ class HistoryStore
         QString id;
         QString title;
         QDateTime startedAt;
+        QString snippet; // 搜索命中的正文片段（仅 search() 填写）
     };
 
   public:
     explicit HistoryStore(const QString &baseDir)
-        : baseDir_(baseDir)
+        : baseDir_(baseDir), writer_(new HistoryWriter(DEFAULT_HISTORY_FLUSH_MS))
     {
         QDir().mkpath(baseDir_);
+        index_.reset(new HistoryIndex);
+        const QString dbPath = QDir(baseDir_).filePath("index.sqlite");
+        // UI 线程的连接只用于查询；写入由 HistoryWriter 在写入线程上用自己的连接完成
+        if (!index_->open(dbPath) || !writer_->attachIndex(dbPath))
+        {
+            index_.reset(); // 索引不可用时退回逐个读取 meta.json
+            return;
+        }
+        // 索引缺失/过期，或与会话目录数量不一致（旧版本写入的会话）时从 JSONL 重建。
+        // 检查与重建都排在写入线程上执行，不阻塞构造（Widget 启动）；之后的写入排在重建之后
+        const bool stale = index_->needsRebuild();
+        const QString base = baseDir_;
+        writer_->updateIndex([base, stale](HistoryIndex &index)
+                             { return index.rebuildIfStale(base, stale); });
     }
 
     // Begin a new session directory using meta.json + messages.jsonl inside a session dir
@@ -63,25 +89,25 @@ class HistoryStore
     {
         meta_ = meta;
         sessionDir_ = QDir(baseDir_).filePath(meta_.id);
-        QDir().mkpath(sessionDir_);
-        // write meta.json
-        QFile f(QDir(sessionDir_).filePath("meta.json"));
-        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
-        f.write(QJsonDocument(meta_.toJson()).toJson(QJsonDocument::Compact));
-        f.close();
-        // create messages.jsonl
-        QFile m(QDir(sessionDir_).filePath("messages.jsonl"));
-        if (!m.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) return false;
-        m.close();
-        return true;
+        if (!QDir().mkpath(sessionDir_)) return false;
+        // write meta.json, create messages.jsonl; 新会话只有一次，直接等待落盘以便报告失败
+        writer_->replace(QDir(sessionDir_).filePath("meta.json"), QJsonDocument(meta_.toJson()).toJson(QJsonDocument::Compact));
+        writer_->append(QDir(sessionDir_).filePath("messages.jsonl"), QByteArray());
+        if (index_)
+        {
+            const SessionMeta m = meta_;
+            writer_->updateIndex([m](HistoryIndex &index)
+                                 {
+                                     index.upsertSession(m.id, m.title, m.startedAt);
+                                     return true; });
+        }
+        return writer_->flush(false);
     }
 
     // Append one message object to messages.jsonl (one compact JSON per line)
     void appendMessage(const QJsonObject &msg)
     {
         if (sessionDir_.isEmpty()) return;
-        QFile m(QDir(sessionDir_).filePath("messages.jsonl"));
-        if (!m.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) return;
         // 历史记录需要“可恢复”，但也要避免把 data:image/png;base64,... 这种超长内容直接写入磁盘。
         // 约定：
         // - UI 运行期/发给模型：仍使用 base64 data URL（OpenAI 兼容 schema）
@@ -90,8 +116,17 @@ class HistoryStore
         QJsonDocument d(stored);
         QByteArray line = d.toJson(QJsonDocument::Compact);
         line.append('\n');
-        m.write(line);
-        m.close();
+        // 交给后台写入线程：短时间内的多条追加合并为一次提交
+        writer_->append(QDir(sessionDir_).filePath("messages.jsonl"), line);
+        if (index_)
+        {
+            // 与这条追加在同一次提交中写入索引，UI 线程不碰 SQLite
+            const QString id = meta_.id;
+            writer_->updateIndex([id, stored](HistoryIndex &index)
+                                 {
+                                     index.addMessage(id, stored);
+                                     return true; });
+        }
         // 生成会话标题：优先取“第一条用户消息”的文本摘要。
         // 注意：挂载桌面控制器/多模态输入时，user.content 可能是数组（[{type:"text",...},{type:"image_url",...}]），
         // 旧实现对数组使用 toVariant().toString() 会得到空串，导致历史记录一直显示 (untitled)。
@@ -170,6 +205,7 @@ class HistoryStore
             {
                 meta_.title = title;
                 saveMeta();
+                indexTitle(meta_.id, meta_.title);
             }
         }
     }
@@ -179,8 +215,8 @@ class HistoryStore
     bool rewriteAllMessages(const QJsonArray &messages)
     {
         if (sessionDir_.isEmpty()) return false;
-        QFile m(QDir(sessionDir_).filePath("messages.jsonl"));
-        if (!m.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+        QByteArray content;
+        QJsonArray storedAll;
         for (const auto &v : messages)
         {
             QJsonObject obj = v.toObject();
@@ -191,9 +227,19 @@ class HistoryStore
             QJsonDocument d(stored);
             QByteArray line = d.toJson(QJsonDocument::Compact);
             line.append('\n');
-            m.write(line);
+            content.append(line);
+            if (index_) storedAll.append(stored);
+        }
+        // 整体替换（先写临时文件再改名），排在此前尚未写出的追加之后
+        writer_->replace(QDir(sessionDir_).filePath("messages.jsonl"), content);
+        if (index_)
+        {
+            const QString id = meta_.id;
+            writer_->updateIndex([id, storedAll](HistoryIndex &index)
+                                 {
+                                     index.replaceMessages(id, storedAll);
+                                     return true; });
         }
-        m.close();
         return true;
     }
 
@@ -220,6 +266,9 @@ class HistoryStore
     bool resume(const QString &id)
     {
         const QString dir = QDir(baseDir_).filePath(id);
+        // 之后会继续追加：先写完并关闭该会话的句柄，修复崩溃留下的残行，避免新消息接在半行后面
+        writer_->closeUnder(dir);
+        HistoryWriter::repairTornTail(QDir(dir).filePath("messages.jsonl"));
         QFile f(QDir(dir).filePath("meta.json"));
         if (!f.open(QIODevice::ReadOnly)) return false;
         const auto o = QJsonDocument::fromJson(f.readAll()).object();
@@ -240,6 +289,14 @@ class HistoryStore
     bool loadSession(const QString &id, SessionMeta &meta, QJsonArray &msgs) const
     {
         const QString dir = QDir(baseDir_).filePath(id);
+        writer_->flush(false);
+        const QString messagesPath = QDir(dir).filePath("messages.jsonl");
+        if (HistoryWriter::hasTornTail(messagesPath))
+        {
+            // 上次异常退出时写到一半的最后一行
+            writer_->closeUnder(dir);
+            HistoryWriter::repairTornTail(messagesPath);
+        }
         QFile f(QDir(dir).filePath("meta.json"));
         if (!f.open(QIODevice::ReadOnly)) return false;
         const auto o = QJsonDocument::fromJson(f.readAll()).object();
@@ -252,7 +309,7 @@ class HistoryStore
         meta.n_ctx = o.value("n_ctx").toInt();
         meta.slot_id = o.value("slot_id").toInt(-1);
         meta.startedAt = QDateTime::fromString(o.value("started_at").toString(), Qt::ISODate);
-        QFile m(QDir(dir).filePath("messages.jsonl"));
+        QFile m(messagesPath);
         if (!m.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
         msgs = QJsonArray();
         while (!m.atEnd())
@@ -270,55 +327,110 @@ class HistoryStore
     // List recent sessions (desc by startedAt)
     QVector<ListItem> listRecent(int maxCount) const
     {
+        if (index_) return listRecentPage(0, maxCount);
+        return scanRecent(maxCount);
+    }
+
+    // One page of recent sessions; limit <= 0 means all remaining
+    QVector<ListItem> listRecentPage(int offset, int limit) const
+    {
+        if (!index_)
+        {
+            writer_->flush(false);
+            QVector<ListItem> all = scanRecent(0);
+            return all.mid(qMax(0, offset), limit > 0 ? limit : -1);
+        }
+        writer_->flush(false); // 让排队的索引更新先生效
         QVector<ListItem> out;
-        QDir dir(baseDir_);
-        const auto entries = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time | QDir::Reversed);
-        for (const auto &fi : entries)
+        for (const auto &row : index_->recent(offset, limit)) out.append(ListItem{row.id, row.title, row.startedAt, QString()});
+        return out;
+    }
+
+    int sessionCount() const
+    {
+        if (index_)
         {
-            QFile f(QDir(fi.absoluteFilePath()).filePath("meta.json"));
-            if (!f.open(QIODevice::ReadOnly)) continue;
-            const auto o = QJsonDocument::fromJson(f.readAll()).object();
-            f.close();
-            ListItem it;
-            it.id = o.value("id").toString(fi.fileName());
-            it.title = o.value("title").toString();
-            it.startedAt = QDateTime::fromString(o.value("started_at").toString(), Qt::ISODate);
+            writer_->flush(false);
+            return index_->sessionCount();
+        }
+        return QDir(baseDir_).entryList(QDir::Dirs | QDir::NoDotAndDotDot).size();
+    }
+
+    // Search titles and message text across all sessions (desc by startedAt)
+    QVector<ListItem> search(const QString &query, int limit) const
+    {
+        QVector<ListItem> out;
+        if (index_)
+        {
+            writer_->flush(false);
+            for (const auto &hit : index_->search(query, limit)) out.append(ListItem{hit.id, hit.title, hit.startedAt, hit.snippet});
+            return out;
+        }
+        // 无索引：只能匹配标题
+        writer_->flush(false);
+        for (const auto &it : scanRecent(0))
+        {
+            if (!it.title.contains(query.trimmed(), Qt::CaseInsensitive)) continue;
             out.append(it);
+            if (limit > 0 && out.size() >= limit) break;
         }
-        std::sort(out.begin(), out.end(), [](const ListItem &a, const ListItem &b)
-                  { return a.startedAt > b.startedAt; });
-        if (maxCount > 0 && out.size() > maxCount) out.resize(maxCount);
         return out;
     }
 
+    // Rebuild index.sqlite from the session directories
+    bool rebuildIndex()
+    {
+        if (!index_) return false;
+        const QString base = baseDir_;
+        writer_->updateIndex([base](HistoryIndex &index)
+                             { return index.rebuild(base); });
+        return writer_->flush(false);
+    }
+    bool hasIndex() const { return index_ != nullptr; }
+
+    // Commit queued writes now; sync also forces them to disk
+    bool flush(bool sync = false) { return writer_->flush(sync); }
+    // Same without waiting (turn end on the UI thread); failures surface on the next flush()
+    void flushAsync(bool sync = true) { writer_->flushAsync(sync); }
+    HistoryWriter *writer() const { return writer_.get(); }
+
     // Rename title inside meta.json
     bool renameSession(const QString &id, const QString &newTitle)
     {
         const QString dir = QDir(baseDir_).filePath(id);
+        writer_->flush(false);
         QFile f(QDir(dir).filePath("meta.json"));
         if (!f.open(QIODevice::ReadOnly)) return false;
         QJsonObject o = QJsonDocument::fromJson(f.readAll()).object();
         f.close();
         o["title"] = newTitle;
-        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
-        f.write(QJsonDocument(o).toJson(QJsonDocument::Compact));
-        f.close();
+        writer_->replace(f.fileName(), QJsonDocument(o).toJson(QJsonDocument::Compact));
         if (meta_.id == id) meta_.title = newTitle;
+        indexTitle(id, newTitle);
         return true;
     }
 
     // Delete one session directory
-    bool deleteSession(const QString &id) const
+    bool deleteSession(const QString &id)
     {
         const QString dir = QDir(baseDir_).filePath(id);
+        if (index_)
+        {
+            writer_->updateIndex([id](HistoryIndex &index)
+                                 {
+                                     index.removeSession(id);
+                                     return true; });
+        }
+        writer_->closeUnder(dir);
         QDir d(dir);
         if (!d.exists()) return true;
         return d.removeRecursively();
     }
 
     // Purge all sessions under baseDir
-    bool purgeAll() const
+    bool purgeAll()
     {
+        writer_->closeUnder(baseDir_);
         QDir d(baseDir_);
         bool ok = true;
         const auto entries = d.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
@@ -327,10 +439,42 @@ class HistoryStore
             QDir sub(d.filePath(name));
             ok = sub.removeRecursively() && ok;
         }
+        if (index_)
+        {
+            writer_->updateIndex([](HistoryIndex &index)
+                                 {
+                                     index.clear();
+                                     return true; });
+            writer_->flush(false);
+        }
         return ok;
     }
 
   private:
+    // 无索引时的旧路径：逐个解析 meta.json
+    QVector<ListItem> scanRecent(int maxCount) const
+    {
+        QVector<ListItem> out;
+        QDir dir(baseDir_);
+        const auto entries = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time | QDir::Reversed);
+        for (const auto &fi : entries)
+        {
+            QFile f(QDir(fi.absoluteFilePath()).filePath("meta.json"));
+            if (!f.open(QIODevice::ReadOnly)) continue;
+            const auto o = QJsonDocument::fromJson(f.readAll()).object();
+            f.close();
+            ListItem it;
+            it.id = o.value("id").toString(fi.fileName());
+            it.title = o.value("title").toString();
+            it.startedAt = QDateTime::fromString(o.value("started_at").toString(), Qt::ISODate);
+            out.append(it);
+        }
+        std::sort(out.begin(), out.end(), [](const ListItem &a, const ListItem &b)
+                  { return a.startedAt > b.startedAt; });
+        if (maxCount > 0 && out.size() > maxCount) out.resize(maxCount);
+        return out;
+    }
+
     // 将一条消息转换为“适合落盘”的历史格式：
     // - 目标：避免把 data:image/...;base64,... 的超长字符串写入 messages.jsonl
     // - 手段：当 content 为数组且包含 image_url 时：
@@ -401,18 +545,26 @@ class HistoryStore
         return out;
     }
 
+    void indexTitle(const QString &id, const QString &title)
+    {
+        if (!index_) return;
+        writer_->updateIndex([id, title](HistoryIndex &index)
+                             {
+                                 index.setTitle(id, title);
+                                 return true; });
+    }
+
     void saveMeta()
     {
         if (sessionDir_.isEmpty()) return;
-        QFile f(QDir(sessionDir_).filePath("meta.json"));
-        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return;
-        f.write(QJsonDocument(meta_.toJson()).toJson(QJsonDocument::Compact));
-        f.close();
+        writer_->replace(QDir(sessionDir_).filePath("meta.json"), QJsonDocument(meta_.toJson()).toJson(QJsonDocument::Compact));
     }
 
     QString baseDir_;
     QString sessionDir_;
     SessionMeta meta_;
+    std::unique_ptr<HistoryWriter> writer_; // 析构时写完排队的数据
+    std::unique_ptr<HistoryIndex> index_;   // 可能为空：打开失败时退回旧路径
 };
 
 #endif // HISTORY_STORE_H
@@ -0,0 +1,377 @@
+#include "history_writer.h"
+
+#include "history_index.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QSaveFile>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// 同时缓存的文件句柄上限；通常只有当前会话的 messages.jsonl 在追加
+constexpr int kMaxOpenHandles = 8;
+
+// 把文件在操作系统缓存中的数据刷到磁盘
+bool syncToDisk(const QString &path)
+{
+#ifdef _WIN32
+    // QFile 在 Windows 上不暴露可用于 _commit 的 fd；FlushFileBuffers 作用于文件本身，另开一个句柄即可
+    HANDLE h = CreateFileW(reinterpret_cast<const wchar_t *>(path.utf16()), GENERIC_WRITE,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    const bool ok = FlushFileBuffers(h) != 0;
+    CloseHandle(h);
+    return ok;
+#else
+    const int fd = ::open(QFile::encodeName(path).constData(), O_WRONLY);
+    if (fd < 0) return false;
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+} // namespace
+
+class HistoryWriter::Worker : public QObject
+{
+  public:
+    Worker(int intervalMs, SyncPolicy policy)
+        : intervalMs_(qMax(0, intervalMs)), policy_(policy), timer_(new QTimer(this))
+    {
+        timer_->setSingleShot(true);
+        connect(timer_, &QTimer::timeout, this, [this]()
+                { failed_ += commit(false); });
+    }
+
+    void push(Op op)
+    {
+        if (op.kind == Op::Replace)
+        {
+            // 从队尾往前找同一文件的上一次操作：若也是整体替换，直接覆盖其内容（meta.json 会被频繁改写）
+            for (auto it = queue_.rbegin(); it != queue_.rend(); ++it)
+            {
+                if (it->kind == Op::Close) break;
+                if (it->kind == Op::Index || it->path != op.path) continue;
+                if (it->kind == Op::Replace)
+                {
+                    it->data = op.data;
+                    return;
+                }
+                break;
+            }
+        }
+        queue_.push_back(std::move(op));
+        // 攒批：第一条数据到达后再等一个间隔，期间到达的操作合并成一次提交
+        if (!timer_->isActive()) timer_->start(intervalMs_);
+    }
+
+    // 提交全部排队操作，返回自上次调用以来的失败数
+    int flushNow(bool sync)
+    {
+        failed_ += commit(sync);
+        const int failed = failed_;
+        failed_ = 0;
+        return failed;
+    }
+
+    // 异步提交：失败数留到下一次 flushNow() 一并报告
+    void commitLater(bool sync)
+    {
+        failed_ += commit(sync);
+    }
+
+    bool openIndex(const QString &dbPath)
+    {
+        index_.reset(new HistoryIndex);
+        if (index_->open(dbPath)) return true;
+        index_.reset();
+        return false;
+    }
+
+    // 退出前：提交剩余数据并 fsync，关闭全部句柄与索引连接（在写入线程上执行）
+    void shutdown()
+    {
+        commit(true);
+        timer_->stop();
+        const QStringList paths = handles_.keys();
+        for (const QString &path : paths) closeHandle(path, false);
+        index_.reset();
+    }
+
+    std::atomic<quint64> commits{0};
+    std::atomic<quint64> syncedCommits{0}; // 带 fsync 的提交次数
+    std::atomic_int handleCount{0};
+
+  private:
+    int commit(bool sync)
+    {
+        timer_->stop();
+        std::deque<Op> ops;
+        ops.swap(queue_);
+        const bool fsyncNow = policy_ == SyncPolicy::EveryCommit || (sync && policy_ == SyncPolicy::OnFlush);
+        // 回合结束时队列常常已被定时提交清空，仍要把那些提交写过的文件刷到磁盘
+        if (ops.empty()) return fsyncNow ? syncPending(QStringList()) : 0;
+        int failed = 0;
+        QStringList dirty;
+        bool indexBatch = false;
+        for (const Op &op : ops)
+        {
+            switch (op.kind)
+            {
+            case Op::Append:
+            {
+                QFile *f = handleFor(op.path, fsyncNow);
+                if (!f)
+                {
+                    ++failed;
+                    break;
+                }
+                if (!op.data.isEmpty() && f->write(op.data) != op.data.size()) ++failed;
+                if (!dirty.contains(op.path)) dirty.append(op.path);
+                break;
+            }
+            case Op::Replace:
+            {
+                closeHandle(op.path, false);
+                dirty.removeAll(op.path);
+                // QSaveFile::commit() 会先写临时文件、刷盘，再原子改名
+                QSaveFile out(op.path);
+                if (!out.open(QIODevice::WriteOnly) || out.write(op.data) != op.data.size() || !out.commit()) ++failed;
+                break;
+            }
+            case Op::Close:
+            {
+                const QStringList paths = handles_.keys();
+                for (const QString &path : paths)
+                {
+                    if (!path.startsWith(op.path)) continue;
+                    closeHandle(path, false);
+                    dirty.removeAll(path);
+                }
+                break;
+            }
+            case Op::Index:
+            {
+                if (!index_) break; // 索引不可用：JSONL 仍是唯一数据源
+                // 同一次提交中的索引更新共用一个事务
+                if (!indexBatch) indexBatch = index_->beginBatch();
+                if (!op.task(*index_)) ++failed;
+                break;
+            }
+            }
+        }
+        for (const QString &path : dirty)
+        {
+            const auto it = handles_.constFind(path);
+            if (it == handles_.constEnd()) continue;
+            if (!it.value()->flush()) ++failed;
+            if (fsyncNow && !syncToDisk(path)) ++failed;
+            if (!fsyncNow) unsynced_.insert(path);
+        }
+        if (indexBatch && !index_->commitBatch()) ++failed;
+        ++commits;
+        if (fsyncNow) failed += syncPending(dirty);
+        return failed;
+    }
+
+    // fsync 此前只写入系统缓存的文件（synced 为本次提交已刷过的），返回失败数
+    int syncPending(const QStringList &synced)
+    {
+        int failed = 0;
+        for (const QString &path : qAsConst(unsynced_))
+        {
+            // 会话可能已被删除
+            if (synced.contains(path) || !QFileInfo::exists(path)) continue;
+            if (!syncToDisk(path)) ++failed;
+        }
+        unsynced_.clear();
+        ++syncedCommits;
+        return failed;
+    }
+
+    QFile *handleFor(const QString &path, bool sync)
+    {
+        const auto it = handles_.constFind(path);
+        if (it != handles_.constEnd()) return it.value().get();
+        if (handles_.size() >= kMaxOpenHandles)
+        {
+            const QStringList paths = handles_.keys();
+            for (const QString &p : paths) closeHandle(p, sync);
+        }
+        auto f = std::make_shared<QFile>(path);
+        if (!f->open(QIODevice::WriteOnly | QIODevice::Append)) return nullptr;
+        handles_.insert(path, f);
+        handleCount.store(handles_.size());
+        return f.get();
+    }
+
+    void closeHandle(const QString &path, bool sync)
+    {
+        const auto f = handles_.take(path);
+        handleCount.store(handles_.size());
+        if (!f) return;
+        f->close();
+        if (sync) syncToDisk(path);
+    }
+
+    const int intervalMs_;
+    const SyncPolicy policy_;
+    QTimer *timer_ = nullptr;
+    std::deque<Op> queue_;
+    int failed_ = 0; // 自上次 flush 以来的写入失败数
+    QSet<QString> unsynced_; // 已写入系统缓存、尚未 fsync 的文件
+    QHash<QString, std::shared_ptr<QFile>> handles_;
+    std::unique_ptr<HistoryIndex> index_; // 写入线程自己的连接；QSqlDatabase 连接不能跨线程使用
+};
+
+HistoryWriter::HistoryWriter(int intervalMs, SyncPolicy policy)
+    : thread_(new QThread), worker_(new Worker(intervalMs, policy))
+{
+    thread_->setObjectName(QStringLiteral("history_writer"));
+    worker_->moveToThread(thread_);
+    thread_->start();
+}
+
+HistoryWriter::~HistoryWriter()
+{
+    QMetaObject::invokeMethod(worker_, [this]()
+                              { worker_->shutdown(); }, Qt::BlockingQueuedConnection);
+    thread_->quit();
+    thread_->wait();
+    delete worker_;
+    delete thread_;
+}
+
+void HistoryWriter::post(Op op)
+{
+    Worker *worker = worker_;
+    QMetaObject::invokeMethod(worker, [worker, op]() mutable
+                              { worker->push(std::move(op)); }, Qt::QueuedConnection);
+}
+
+void HistoryWriter::append(const QString &path, const QByteArray &data)
+{
+    post(Op{Op::Append, path, data, IndexTask()});
+}
+
+void HistoryWriter::replace(const QString &path, const QByteArray &content)
+{
+    post(Op{Op::Replace, path, content, IndexTask()});
+}
+
+bool HistoryWriter::attachIndex(const QString &dbPath)
+{
+    bool ok = false;
+    QMetaObject::invokeMethod(worker_, [this, &ok, &dbPath]()
+                              { ok = worker_->openIndex(dbPath); }, Qt::BlockingQueuedConnection);
+    return ok;
+}
+
+void HistoryWriter::updateIndex(IndexTask task)
+{
+    post(Op{Op::Index, QString(), QByteArray(), std::move(task)});
+}
+
+bool HistoryWriter::flush(bool sync)
+{
+    int failed = 0;
+    QMetaObject::invokeMethod(worker_, [this, &failed, sync]()
+                              { failed = worker_->flushNow(sync); }, Qt::BlockingQueuedConnection);
+    return failed == 0;
+}
+
+void HistoryWriter::flushAsync(bool sync)
+{
+    Worker *worker = worker_;
+    QMetaObject::invokeMethod(worker, [worker, sync]()
+                              { worker->commitLater(sync); }, Qt::QueuedConnection);
+}
+
+void HistoryWriter::closeUnder(const QString &dir)
+{
+    // 以分隔符结尾，避免 session-1 误伤 session-10
+    post(Op{Op::Close, dir.endsWith(QLatin1Char('/')) ? dir : dir + QLatin1Char('/'), QByteArray(), IndexTask()});
+    flush(false);
+}
+
+quint64 HistoryWriter::commits() const
+{
+    return worker_->commits.load();
+}
+
+quint64 HistoryWriter::syncedCommits() const
+{
+    return worker_->syncedCommits.load();
+}
+
+int HistoryWriter::openHandles() const
+{
+    return worker_->handleCount.load();
+}
+
+bool HistoryWriter::hasTornTail(const QString &path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly) || f.size() == 0) return false;
+    char last = 0;
+    return f.seek(f.size() - 1) && f.getChar(&last) && last != '\n';
+}
+
+bool HistoryWriter::repairTornTail(const QString &path)
+{
+    if (!hasTornTail(path)) return true;
+    QFile f(path);
+    if (!f.open(QIODevice::ReadWrite)) return false;
+    const qint64 size = f.size();
+
+    // 从尾部按块向前找最后一个换行，定位残行起点
+    constexpr qint64 kBlock = 4096;
+    qint64 lineStart = 0;
+    for (qint64 end = size; end > 0;)
+    {
+        const qint64 begin = qMax<qint64>(0, end - kBlock);
+        if (!f.seek(begin)) return false;
+        const int nl = f.read(end - begin).lastIndexOf('\n');
+        if (nl >= 0)
+        {
+            lineStart = begin + nl + 1;
+            break;
+        }
+        end = begin;
+    }
+
+    if (!f.seek(lineStart)) return false;
+    QJsonParseError err;
+    const QJsonDocument doc = QJsonDocument::fromJson(f.read(size - lineStart), &err);
+    if (err.error == QJsonParseError::NoError && doc.isObject())
+    {
+        // 只是缺少换行（例如手工编辑过），保留这条消息
+        return f.seek(size) && f.write("\n", 1) == 1;
+    }
+    return f.resize(lineStart);
+}
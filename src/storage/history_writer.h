@@ -0,0 +1,82 @@
+// history_writer.h - Background group-commit writer for the session JSONL files
+// appendMessage used to open messages.jsonl, write one line and close it for every
+// message. The writer keeps the files open on a QThread and merges the appends that
+// arrive within a short interval into one commit; operations reach the thread as
+// queued invocations, so callers never wait except on an explicit flush(). The
+// history index is updated on the same thread, one transaction per commit.
+// Whole-file rewrites (meta.json, edited history) go through QSaveFile so a crash
+// never leaves them half written.
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+
+class HistoryIndex;
+class QThread;
+
+class HistoryWriter
+{
+  public:
+    // 何时把数据真正落到磁盘（fsync）；写入操作系统缓存在每次提交时都会发生
+    enum class SyncPolicy
+    {
+        None,       // 从不 fsync，交给操作系统
+        OnFlush,    // 仅 flush(true)/flushAsync(true)（回合结束/退出）时 fsync
+        EveryCommit // 每次合并提交后都 fsync
+    };
+    // 在写入线程上执行的索引更新；返回 false 计为一次写入失败
+    using IndexTask = std::function<bool(HistoryIndex &index)>;
+
+    explicit HistoryWriter(int intervalMs, SyncPolicy policy = SyncPolicy::OnFlush);
+    ~HistoryWriter(); // 写完队列中剩余的数据后退出
+
+    // 追加到文件末尾（文件不存在则创建）；data 为空时只确保文件存在
+    void append(const QString &path, const QByteArray &data);
+    // 整体替换文件内容（QSaveFile 原子替换）；队列里尚未写出的同一文件的替换会被合并
+    void replace(const QString &path, const QByteArray &content);
+    // 在写入线程上打开自己的索引连接（阻塞到打开完成）；之后 updateIndex() 的任务与文件写入按序执行，
+    // 同一次提交中的索引更新合并为一个 SQLite 事务
+    bool attachIndex(const QString &dbPath);
+    void updateIndex(IndexTask task);
+    // 阻塞直到此前排队的写入全部提交；sync 为 true 且策略不是 None 时同时 fsync。
+    // 返回自上次 flush 以来是否没有写入失败
+    bool flush(bool sync = false);
+    // 立即提交（可选 fsync）但不等待，供 UI 线程在回合结束时调用
+    void flushAsync(bool sync);
+    // 写完排队数据并关闭 dir 下缓存的文件句柄（删除/截断文件前调用）
+    void closeUnder(const QString &dir);
+
+    quint64 commits() const;
+    // 带 fsync 的提交次数（含回合结束时只补刷此前定时提交写过的文件）
+    quint64 syncedCommits() const;
+    int openHandles() const;
+
+    // 崩溃可能留下没有换行结尾的残行：能解析为完整 JSON 的补上换行，否则截掉。
+    // 返回 true 表示文件结尾完好或已修复
+    static bool repairTornTail(const QString &path);
+    static bool hasTornTail(const QString &path);
+
+  private:
+    struct Op
+    {
+        enum Kind
+        {
+            Append,
+            Replace,
+            Close,
+            Index
+        } kind;
+        QString path;
+        QByteArray data;
+        IndexTask task;
+    };
+    class Worker; // 住在写入线程上，队列、文件句柄与索引连接只由它访问
+
+    void post(Op op);
+
+    QThread *thread_ = nullptr;
+    Worker *worker_ = nullptr;
+};
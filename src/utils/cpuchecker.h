@@ -138,6 +138,44 @@ class cpuChecker : public QObject
 #endif
     }
 
+    /**
+     * 读取物理内存总量与当前可用量（单位：MB）
+     * Linux 取 /proc/meminfo 的 MemTotal/MemAvailable；装载前的内存估算也用它判断能否装下
+     * 返回：读取失败或平台不支持时返回 false
+     */
+    static bool readMemoryMb(double &totalMb, double &availableMb)
+    {
+        totalMb = 0.0;
+        availableMb = 0.0;
+#ifdef _WIN32
+        MEMORYSTATUSEX memInfo;
+        memInfo.dwLength = sizeof(MEMORYSTATUSEX);
+        if (!GlobalMemoryStatusEx(&memInfo)) return false;
+        totalMb = double(memInfo.ullTotalPhys) / (1024.0 * 1024.0);
+        availableMb = double(memInfo.ullAvailPhys) / (1024.0 * 1024.0);
+        return totalMb > 0.0;
+#elif __linux__
+        std::ifstream memInfoFile("/proc/meminfo");
+        if (!memInfoFile.is_open()) return false;
+        std::string line;
+        while (std::getline(memInfoFile, line))
+        {
+            std::istringstream iss(line);
+            std::string key;
+            unsigned long value = 0; // kB
+            std::string unit;
+            iss >> key >> value >> unit;
+            if (key == "MemTotal:")
+                totalMb = value / 1024.0;
+            else if (key == "MemAvailable:")
+                availableMb = value / 1024.0;
+        }
+        return totalMb > 0.0;
+#else
+        return false;
+#endif
+    }
+
   signals:
     // 发送 CPU 与物理内存使用率（单位：百分比）
     void cpu_status(double cpuload, double memload);
@@ -166,27 +204,11 @@ class cpuChecker : public QObject
         emit cpu_status(cpuLoad, physMemUsedPercent);
 #elif __linux__
         // 物理内存使用率（从 /proc/meminfo 读取）
-        std::ifstream memInfoFile("/proc/meminfo");
-        unsigned long totalMem = 0;
-        unsigned long availMem = 0;
-        if (memInfoFile.is_open())
-        {
-            std::string line;
-            while (std::getline(memInfoFile, line))
-            {
-                std::istringstream iss(line);
-                std::string key;
-                unsigned long value = 0;
-                std::string unit;
-                iss >> key >> value >> unit;
-                if (key == "MemTotal:")
-                    totalMem = value;
-                else if (key == "MemAvailable:")
-                    availMem = value;
-            }
-        }
-        const unsigned long usedMem = (totalMem > availMem) ? (totalMem - availMem) : 0;
-        const double physMemUsedPercent = totalMem ? (usedMem * 100.0 / double(totalMem)) : 0.0;
+        double totalMem = 0.0;
+        double availMem = 0.0;
+        readMemoryMb(totalMem, availMem);
+        const double usedMem = (totalMem > availMem) ? (totalMem - availMem) : 0.0;
+        const double physMemUsedPercent = totalMem > 0.0 ? (usedMem * 100.0 / totalMem) : 0.0;
 
         double cpuLoad = CalculateCPULoad();
         if (cpuLoad < 0.0) cpuLoad = 0.0;
@@ -1114,10 +1114,11 @@ QString DeviceManager::projectForProgram(const QString &name)
     // Minimal mapping for known third-party projects; extend as new tools are added
     if (key == QLatin1String("llama-server") || key == QLatin1String("llama-server-main") || key == QLatin1String("llama-server-embed"))
         return QStringLiteral("llama.cpp");
-    if (key == QLatin1String("whisper-cli")) return QStringLiteral("whisper.cpp");
+    if (key == QLatin1String("whisper-cli") || key == QLatin1String("whisper-server")) return QStringLiteral("whisper.cpp");
     if (key == QLatin1String("llama-quantize")) return QStringLiteral("llama.cpp");
+    if (key == QLatin1String("sd-server")) return QStringLiteral("sd");
     if (key == QLatin1String("llama-tts")) return QStringLiteral("llama-tts");
-    if (key == QLatin1String("tts-cli")) return QStringLiteral("tts.cpp");
+    if (key == QLatin1String("tts-cli") || key == QLatin1String("tts-server")) return QStringLiteral("tts.cpp");
     // default to using the name itself as folder (best-effort)
     return key;
 }
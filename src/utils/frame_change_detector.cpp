@@ -0,0 +1,83 @@
+#include "frame_change_detector.h"
+
+#include <QtMath>
+
+#include <cstdlib>
+
+FrameChangeDetector::FrameChangeDetector(const Options &options)
+{
+    reset(options);
+}
+
+void FrameChangeDetector::reset(const Options &options)
+{
+    options_ = options;
+    options_.gridW = qBound(1, options_.gridW, 256);
+    options_.gridH = qBound(1, options_.gridH, 256);
+    options_.minChangedTiles = qMax(1, options_.minChangedTiles);
+    options_.settleMs = qMax(0, options_.settleMs);
+    options_.region = options_.region.normalized() & QRectF(0, 0, 1, 1);
+    if (options_.region.isEmpty()) options_.region = QRectF(0, 0, 1, 1);
+    first_.clear();
+    previous_.clear();
+    frames_ = 0;
+    changedPrev_ = 0;
+    changedFirst_ = 0;
+    lastMotionMs_ = 0;
+}
+
+FrameChangeDetector::Verdict FrameChangeDetector::feed(const QImage &frame, qint64 tsMs)
+{
+    const QVector<quint8> sig = signature(frame, options_.region, options_.gridW, options_.gridH);
+    if (sig.isEmpty()) return Verdict::Pending;
+    ++frames_;
+    if (first_.isEmpty())
+    {
+        first_ = sig;
+        previous_ = sig;
+        lastMotionMs_ = tsMs;
+        return Verdict::Pending;
+    }
+
+    changedPrev_ = changedTiles(previous_, sig, options_.tileDelta);
+    changedFirst_ = changedTiles(first_, sig, options_.tileDelta);
+    previous_ = sig;
+    if (changedPrev_ > 0) lastMotionMs_ = tsMs;
+
+    if (options_.mode == Mode::Change)
+        return changedFirst_ >= options_.minChangedTiles ? Verdict::Changed : Verdict::Pending;
+    return (tsMs - lastMotionMs_ >= options_.settleMs) ? Verdict::Settled : Verdict::Pending;
+}
+
+QVector<quint8> FrameChangeDetector::signature(const QImage &frame, const QRectF &region, int gridW, int gridH)
+{
+    if (frame.isNull() || gridW <= 0 || gridH <= 0) return {};
+    const QRect crop = QRect(qFloor(region.left() * frame.width()), qFloor(region.top() * frame.height()),
+                             qCeil(region.width() * frame.width()), qCeil(region.height() * frame.height()))
+                           .intersected(frame.rect());
+    if (crop.isEmpty()) return {};
+    // 平滑缩放近似按块求均值；先裁剪再缩放，bbox 外的变化不会被计入
+    const QImage small = frame.copy(crop)
+                             .convertToFormat(QImage::Format_RGB32)
+                             .scaled(gridW, gridH, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                             .convertToFormat(QImage::Format_Grayscale8);
+    QVector<quint8> out;
+    out.reserve(gridW * gridH);
+    for (int y = 0; y < gridH; ++y)
+    {
+        const uchar *row = small.constScanLine(y);
+        for (int x = 0; x < gridW; ++x) out.append(row[x]);
+    }
+    return out;
+}
+
+int FrameChangeDetector::changedTiles(const QVector<quint8> &a, const QVector<quint8> &b, int tileDelta)
+{
+    if (a.size() != b.size()) return qMax(a.size(), b.size());
+    int changed = 0;
+    for (int i = 0; i < a.size(); ++i)
+    {
+        if (std::abs(int(a.at(i)) - int(b.at(i))) > tileDelta) ++changed;
+    }
+    return changed;
+}
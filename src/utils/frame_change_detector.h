@@ -0,0 +1,63 @@
+#ifndef FRAME_CHANGE_DETECTOR_H
+#define FRAME_CHANGE_DETECTOR_H
+
+#include <QImage>
+#include <QRectF>
+#include <QVector>
+
+// 屏幕变化检测：monitor 工具的本地等待模式使用，连续截图后在本地判断“画面变了/稳定了”，
+// 只在满足条件时才把截图交给模型，省去大部分“再调用一次 monitor”的多模态回合。
+// - 每帧裁剪到 region（0~1 的相对坐标）后缩放成 gridW×gridH 的灰度缩略图，每个像素即一个分块的平均亮度
+// - 分块亮度差超过 tileDelta 记为变化块；光标闪烁、细小噪点对分块均值的影响远小于阈值
+// - Change：与第一帧相比变化块数达到 minChangedTiles 即返回 Changed
+// - Settle：连续 settleMs 内相邻帧没有变化块即返回 Settled
+class FrameChangeDetector
+{
+  public:
+    enum class Mode
+    {
+        Change,
+        Settle
+    };
+    enum class Verdict
+    {
+        Pending,
+        Changed,
+        Settled
+    };
+    struct Options
+    {
+        Mode mode = Mode::Change;
+        QRectF region = QRectF(0, 0, 1, 1);
+        int gridW = 32;
+        int gridH = 18;
+        int tileDelta = 12; // 0~255 的亮度差
+        int minChangedTiles = 1;
+        int settleMs = 1000;
+    };
+
+    explicit FrameChangeDetector(const Options &options = Options());
+
+    void reset(const Options &options);
+    Verdict feed(const QImage &frame, qint64 tsMs);
+
+    int frames() const { return frames_; }
+    // 最近一帧相对上一帧 / 相对第一帧的变化块数
+    int changedSincePrevious() const { return changedPrev_; }
+    int changedSinceFirst() const { return changedFirst_; }
+    int tileCount() const { return options_.gridW * options_.gridH; }
+
+    static QVector<quint8> signature(const QImage &frame, const QRectF &region, int gridW, int gridH);
+    static int changedTiles(const QVector<quint8> &a, const QVector<quint8> &b, int tileDelta);
+
+  private:
+    Options options_;
+    QVector<quint8> first_;
+    QVector<quint8> previous_;
+    int frames_ = 0;
+    int changedPrev_ = 0;
+    int changedFirst_ = 0;
+    qint64 lastMotionMs_ = 0;
+};
+
+#endif // FRAME_CHANGE_DETECTOR_H
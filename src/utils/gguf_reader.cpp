@@ -0,0 +1,387 @@
+#include "gguf_reader.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QHash>
+#include <QtEndian>
+
+#include <climits>
+#include <cstring>
+
+namespace
+{
+// GGUF 值类型（gguf_type）
+enum GgufType : quint32
+{
+    GGUF_U8 = 0,
+    GGUF_I8 = 1,
+    GGUF_U16 = 2,
+    GGUF_I16 = 3,
+    GGUF_U32 = 4,
+    GGUF_I32 = 5,
+    GGUF_F32 = 6,
+    GGUF_BOOL = 7,
+    GGUF_STRING = 8,
+    GGUF_ARRAY = 9,
+    GGUF_U64 = 10,
+    GGUF_I64 = 11,
+    GGUF_F64 = 12,
+};
+
+// 大多数模型的元数据在前几 MB（词表最大的也就十几 MB）；先只映射这一段，
+// 32 位进程也不会因为映射整个多 GB 文件而失败。不够时再映射整个文件重试。
+constexpr qint64 kHeaderMapBytes = 256ll * 1024 * 1024;
+const char *const kTruncated = "truncated metadata";
+
+int scalarSize(quint32 type)
+{
+    switch (type)
+    {
+    case GGUF_U8:
+    case GGUF_I8:
+    case GGUF_BOOL: return 1;
+    case GGUF_U16:
+    case GGUF_I16: return 2;
+    case GGUF_U32:
+    case GGUF_I32:
+    case GGUF_F32: return 4;
+    case GGUF_U64:
+    case GGUF_I64:
+    case GGUF_F64: return 8;
+    default: return 0;
+    }
+}
+
+bool isInteger(quint32 type)
+{
+    return scalarSize(type) > 0 && type != GGUF_F32 && type != GGUF_F64;
+}
+
+// 小端读取游标；越界后置 failed，后续读取都返回零值
+class Cursor
+{
+  public:
+    Cursor(const uchar *data, qint64 size)
+        : data_(data), size_(size) {}
+
+    bool failed() const { return failed_; }
+    qint64 pos() const { return pos_; }
+    const uchar *at(qint64 offset) const { return data_ + offset; }
+
+    template <typename T>
+    T read()
+    {
+        if (!take(qint64(sizeof(T)))) return T();
+        return qFromLittleEndian<T>(data_ + pos_ - qint64(sizeof(T)));
+    }
+
+    bool skip(qint64 bytes) { return take(bytes); }
+    // 回到此前读到过的位置（用于先窥视数组头再整体跳过）
+    void seek(qint64 pos)
+    {
+        if (!failed_ && pos >= 0 && pos <= pos_) pos_ = pos;
+    }
+
+    QByteArray readString()
+    {
+        const quint64 len = read<quint64>();
+        if (failed_ || len > quint64(size_ - pos_) || len > quint64(INT_MAX))
+        {
+            failed_ = true;
+            return QByteArray();
+        }
+        QByteArray out(reinterpret_cast<const char *>(data_ + pos_), int(len));
+        pos_ += qint64(len);
+        return out;
+    }
+
+    bool readInteger(quint32 type, qint64 *out)
+    {
+        switch (type)
+        {
+        case GGUF_U8: *out = read<quint8>(); break;
+        case GGUF_I8: *out = read<qint8>(); break;
+        case GGUF_BOOL: *out = read<quint8>() ? 1 : 0; break;
+        case GGUF_U16: *out = read<quint16>(); break;
+        case GGUF_I16: *out = read<qint16>(); break;
+        case GGUF_U32: *out = read<quint32>(); break;
+        case GGUF_I32: *out = read<qint32>(); break;
+        case GGUF_U64: *out = qint64(qMin<quint64>(read<quint64>(), quint64(LLONG_MAX))); break;
+        case GGUF_I64: *out = read<qint64>(); break;
+        default: return false;
+        }
+        return !failed_;
+    }
+
+    bool skipValue(quint32 type, int depth = 0)
+    {
+        if (type == GGUF_STRING)
+        {
+            const quint64 len = read<quint64>();
+            return !failed_ && len <= quint64(size_ - pos_) && skip(qint64(len));
+        }
+        if (type == GGUF_ARRAY)
+        {
+            if (depth > 4) return fail(); // 规范里没有多层嵌套，防御畸形文件
+            const quint32 elemType = read<quint32>();
+            const quint64 count = read<quint64>();
+            if (failed_) return false;
+            const int elemSize = scalarSize(elemType);
+            if (elemSize > 0)
+            {
+                if (count > quint64(size_ - pos_) / quint64(elemSize)) return fail();
+                return skip(qint64(count) * elemSize);
+            }
+            for (quint64 i = 0; i < count; ++i)
+            {
+                if (!skipValue(elemType, depth + 1)) return false;
+            }
+            return true;
+        }
+        const int bytes = scalarSize(type);
+        return bytes > 0 ? skip(bytes) : fail();
+    }
+
+  private:
+    bool take(qint64 bytes)
+    {
+        if (failed_ || bytes < 0 || bytes > size_ - pos_) return fail();
+        pos_ += bytes;
+        return true;
+    }
+    bool fail()
+    {
+        failed_ = true;
+        return false;
+    }
+
+    const uchar *data_;
+    qint64 size_;
+    qint64 pos_ = 0;
+    bool failed_ = false;
+};
+
+GgufInfo failWith(GgufInfo info, const QString &error)
+{
+    info.valid = false;
+    info.error = error;
+    return info;
+}
+} // namespace
+
+GgufInfo GgufReader::parse(const uchar *data, qint64 size)
+{
+    GgufInfo info;
+    if (!data || size < 4 || std::memcmp(data, "GGUF", 4) != 0) return failWith(info, QStringLiteral("not a GGUF file"));
+
+    Cursor c(data, size);
+    c.skip(4);
+    info.version = c.read<quint32>();
+    if (info.version < 2 || info.version > 3) return failWith(info, QStringLiteral("unsupported GGUF version %1").arg(info.version));
+    info.tensorCount = c.read<quint64>();
+    const quint64 kvCount = c.read<quint64>();
+    if (c.failed()) return failWith(info, QLatin1String(kTruncated));
+
+    QHash<QString, qint64> ints; // 整数/布尔类元数据，架构前缀的键在读完后再解析
+    qint64 tokensBegin = -1;
+    qint64 tokensEnd = -1;
+    for (quint64 i = 0; i < kvCount; ++i)
+    {
+        const QString key = QString::fromUtf8(c.readString());
+        const quint32 type = c.read<quint32>();
+        if (c.failed()) break;
+
+        if (type == GGUF_STRING && key == QLatin1String("general.architecture"))
+            info.arch = QString::fromUtf8(c.readString());
+        else if (type == GGUF_STRING && key == QLatin1String("general.name"))
+            info.name = QString::fromUtf8(c.readString());
+        else if (type == GGUF_STRING && key == QLatin1String("tokenizer.ggml.model"))
+            info.tokenizerModel = QString::fromUtf8(c.readString());
+        else if (type == GGUF_STRING && key == QLatin1String("tokenizer.chat_template"))
+            info.chatTemplate = QString::fromUtf8(c.readString());
+        else if (type == GGUF_ARRAY && key == QLatin1String("tokenizer.ggml.tokens"))
+        {
+            // 词表原始字节留作分词器指纹，读完全部 KV 后再哈希（不逐条解码）
+            const qint64 start = c.pos();
+            c.read<quint32>();
+            const quint64 count = c.read<quint64>();
+            c.seek(start);
+            if (!c.skipValue(type)) break;
+            info.vocabSize = int(qMin<quint64>(count, quint64(INT_MAX)));
+            tokensBegin = start;
+            tokensEnd = c.pos();
+        }
+        else if (type == GGUF_ARRAY && key.endsWith(QLatin1String(".attention.head_count_kv")))
+        {
+            // 部分架构逐层给出 KV 头数：估算显存取最大值
+            const qint64 start = c.pos();
+            const quint32 elemType = c.read<quint32>();
+            const quint64 count = c.read<quint64>();
+            if (!isInteger(elemType))
+            {
+                c.seek(start);
+                if (!c.skipValue(type)) break;
+                continue;
+            }
+            qint64 best = 0;
+            for (quint64 n = 0; n < count && !c.failed(); ++n)
+            {
+                qint64 v = 0;
+                if (c.readInteger(elemType, &v)) best = qMax(best, v);
+            }
+            ints.insert(key, best);
+        }
+        else if (isInteger(type))
+        {
+            qint64 v = 0;
+            if (c.readInteger(type, &v)) ints.insert(key, v);
+        }
+        else if (!c.skipValue(type))
+        {
+            break;
+        }
+    }
+    if (c.failed()) return failWith(info, QLatin1String(kTruncated));
+
+    if (tokensBegin >= 0)
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(info.tokenizerModel.toUtf8());
+        hash.addData(reinterpret_cast<const char *>(c.at(tokensBegin)), int(qMin<qint64>(tokensEnd - tokensBegin, INT_MAX)));
+        info.tokenizerHash = QString::fromLatin1(hash.result().toHex().left(16));
+    }
+
+    const QString prefix = info.arch + QLatin1Char('.');
+    auto archInt = [&ints, &prefix](const char *suffix, qint64 fallback)
+    {
+        return ints.value(prefix + QLatin1String(suffix), fallback);
+    };
+    const auto clampInt = [](qint64 v)
+    { return int(qBound<qint64>(INT_MIN, v, INT_MAX)); };
+    info.fileType = clampInt(ints.value(QStringLiteral("general.file_type"), -1));
+    if (info.fileType >= 0) info.quantType = fileTypeName(info.fileType);
+    info.nCtxTrain = clampInt(archInt("context_length", 0));
+    info.nEmbd = clampInt(archInt("embedding_length", 0));
+    info.nLayer = clampInt(archInt("block_count", 0));
+    info.nHead = clampInt(archInt("attention.head_count", 0));
+    info.nHeadKv = clampInt(archInt("attention.head_count_kv", info.nHead));
+    info.keyLength = clampInt(archInt("attention.key_length", info.nHead > 0 ? info.nEmbd / info.nHead : 0));
+    info.valueLength = clampInt(archInt("attention.value_length", info.keyLength));
+    info.poolingType = clampInt(archInt("pooling_type", -1));
+    info.valid = !info.arch.isEmpty();
+    if (!info.valid) info.error = QStringLiteral("missing general.architecture");
+    return info;
+}
+
+GgufInfo GgufReader::read(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return failWith(GgufInfo(), file.errorString());
+    const qint64 size = file.size();
+    if (size < 24) return failWith(GgufInfo(), QStringLiteral("not a GGUF file"));
+
+    qint64 mapBytes = qMin(size, kHeaderMapBytes);
+    uchar *data = file.map(0, mapBytes);
+    if (!data) return failWith(GgufInfo(), file.errorString());
+    GgufInfo info = parse(data, mapBytes);
+    file.unmap(data);
+    if (!info.valid && info.error == QLatin1String(kTruncated) && mapBytes < size)
+    {
+        data = file.map(0, size);
+        if (!data) return failWith(info, file.errorString());
+        info = parse(data, size);
+        file.unmap(data);
+    }
+    return info;
+}
+
+QString GgufReader::fileTypeName(int fileType)
+{
+    // 与 llama.cpp 的 llama_ftype 保持一致（已废弃的编号不列出）
+    switch (fileType)
+    {
+    case 0: return QStringLiteral("F32");
+    case 1: return QStringLiteral("F16");
+    case 2: return QStringLiteral("Q4_0");
+    case 3: return QStringLiteral("Q4_1");
+    case 7: return QStringLiteral("Q8_0");
+    case 8: return QStringLiteral("Q5_0");
+    case 9: return QStringLiteral("Q5_1");
+    case 10: return QStringLiteral("Q2_K");
+    case 11: return QStringLiteral("Q3_K_S");
+    case 12: return QStringLiteral("Q3_K_M");
+    case 13: return QStringLiteral("Q3_K_L");
+    case 14: return QStringLiteral("Q4_K_S");
+    case 15: return QStringLiteral("Q4_K_M");
+    case 16: return QStringLiteral("Q5_K_S");
+    case 17: return QStringLiteral("Q5_K_M");
+    case 18: return QStringLiteral("Q6_K");
+    case 19: return QStringLiteral("IQ2_XXS");
+    case 20: return QStringLiteral("IQ2_XS");
+    case 21: return QStringLiteral("Q2_K_S");
+    case 22: return QStringLiteral("IQ3_XS");
+    case 23: return QStringLiteral("IQ3_XXS");
+    case 24: return QStringLiteral("IQ1_S");
+    case 25: return QStringLiteral("IQ4_NL");
+    case 26: return QStringLiteral("IQ3_S");
+    case 27: return QStringLiteral("IQ3_M");
+    case 28: return QStringLiteral("IQ2_S");
+    case 29: return QStringLiteral("IQ2_M");
+    case 30: return QStringLiteral("IQ4_XS");
+    case 31: return QStringLiteral("IQ1_M");
+    case 32: return QStringLiteral("BF16");
+    case 36: return QStringLiteral("TQ1_0");
+    case 37: return QStringLiteral("TQ2_0");
+    default: return QStringLiteral("ftype%1").arg(fileType);
+    }
+}
+
+QJsonObject GgufInfo::toJson() const
+{
+    return QJsonObject{{QStringLiteral("valid"), valid},
+                       {QStringLiteral("error"), error},
+                       {QStringLiteral("version"), int(version)},
+                       {QStringLiteral("tensor_count"), double(tensorCount)},
+                       {QStringLiteral("arch"), arch},
+                       {QStringLiteral("name"), name},
+                       {QStringLiteral("file_type"), fileType},
+                       {QStringLiteral("quant_type"), quantType},
+                       {QStringLiteral("n_ctx_train"), nCtxTrain},
+                       {QStringLiteral("n_embd"), nEmbd},
+                       {QStringLiteral("n_layer"), nLayer},
+                       {QStringLiteral("n_head"), nHead},
+                       {QStringLiteral("n_head_kv"), nHeadKv},
+                       {QStringLiteral("key_length"), keyLength},
+                       {QStringLiteral("value_length"), valueLength},
+                       {QStringLiteral("pooling_type"), poolingType},
+                       {QStringLiteral("vocab_size"), vocabSize},
+                       {QStringLiteral("tokenizer_model"), tokenizerModel},
+                       {QStringLiteral("tokenizer_hash"), tokenizerHash},
+                       {QStringLiteral("chat_template"), chatTemplate}};
+}
+
+GgufInfo GgufInfo::fromJson(const QJsonObject &object)
+{
+    GgufInfo info;
+    info.valid = object.value(QStringLiteral("valid")).toBool();
+    info.error = object.value(QStringLiteral("error")).toString();
+    info.version = quint32(object.value(QStringLiteral("version")).toInt());
+    info.tensorCount = quint64(object.value(QStringLiteral("tensor_count")).toDouble());
+    info.arch = object.value(QStringLiteral("arch")).toString();
+    info.name = object.value(QStringLiteral("name")).toString();
+    info.fileType = object.value(QStringLiteral("file_type")).toInt(-1);
+    info.quantType = object.value(QStringLiteral("quant_type")).toString();
+    info.nCtxTrain = object.value(QStringLiteral("n_ctx_train")).toInt();
+    info.nEmbd = object.value(QStringLiteral("n_embd")).toInt();
+    info.nLayer = object.value(QStringLiteral("n_layer")).toInt();
+    info.nHead = object.value(QStringLiteral("n_head")).toInt();
+    info.nHeadKv = object.value(QStringLiteral("n_head_kv")).toInt();
+    info.keyLength = object.value(QStringLiteral("key_length")).toInt();
+    info.valueLength = object.value(QStringLiteral("value_length")).toInt();
+    info.poolingType = object.value(QStringLiteral("pooling_type")).toInt(-1);
+    info.vocabSize = object.value(QStringLiteral("vocab_size")).toInt();
+    info.tokenizerModel = object.value(QStringLiteral("tokenizer_model")).toString();
+    info.tokenizerHash = object.value(QStringLiteral("tokenizer_hash")).toString();
+    info.chatTemplate = object.value(QStringLiteral("chat_template")).toString();
+    return info;
+}
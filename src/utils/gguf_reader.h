@@ -0,0 +1,50 @@
+#ifndef GGUF_READER_H
+#define GGUF_READER_H
+
+#include <QJsonObject>
+#include <QString>
+
+// GGUF 文件头元数据（只读 KV 区，不碰张量数据）。
+// 在拉起 llama-server 之前即可知道训练上下文、嵌入维度、层数/注意力头数（显存估算）与分词器指纹（草稿模型配对）。
+struct GgufInfo
+{
+    bool valid = false;
+    QString error;          // valid=false 时的原因
+    quint32 version = 0;    // GGUF 版本（支持 2/3）
+    quint64 tensorCount = 0;
+    QString arch;           // general.architecture，例如 llama/qwen2/bert/clip
+    QString name;           // general.name
+    int fileType = -1;      // general.file_type（llama_ftype）
+    QString quantType;      // fileType 对应的名称，例如 Q4_K_M
+    int nCtxTrain = 0;      // <arch>.context_length
+    int nEmbd = 0;          // <arch>.embedding_length
+    int nLayer = 0;         // <arch>.block_count
+    int nHead = 0;          // <arch>.attention.head_count
+    int nHeadKv = 0;        // <arch>.attention.head_count_kv（逐层数组时取最大值；缺省等于 nHead）
+    int keyLength = 0;      // <arch>.attention.key_length（缺省为 nEmbd / nHead）
+    int valueLength = 0;    // <arch>.attention.value_length
+    int poolingType = -1;   // <arch>.pooling_type（嵌入模型才有）
+    int vocabSize = 0;      // tokenizer.ggml.tokens 的条数
+    QString tokenizerModel; // tokenizer.ggml.model，例如 gpt2/llama
+    QString tokenizerHash;  // 分词器模型名 + 词表原始字节的 SHA1（前 16 位十六进制）
+    QString chatTemplate;   // tokenizer.chat_template
+
+    // 多模态投影（mmproj）文件：不能单独作为对话模型装载
+    bool isProjector() const { return arch == QLatin1String("clip"); }
+
+    QJsonObject toJson() const;
+    static GgufInfo fromJson(const QJsonObject &object);
+};
+
+class GgufReader
+{
+  public:
+    // 以内存映射方式读取文件头；只会触及元数据所在的页面
+    static GgufInfo read(const QString &path);
+    // 解析内存中的 GGUF 字节（read 的核心，便于测试）
+    static GgufInfo parse(const uchar *data, qint64 size);
+    // llama_ftype 枚举值转可读名称；未知值返回 "ftype<N>"
+    static QString fileTypeName(int fileType);
+};
+
+#endif // GGUF_READER_H
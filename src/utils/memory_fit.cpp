@@ -0,0 +1,165 @@
+#include "memory_fit.h"
+
+#include <QtGlobal>
+
+namespace
+{
+constexpr qint64 kMiB = 1024ll * 1024;
+// 驱动上下文、cuBLAS/Vulkan 工作区等与模型无关的固定显存开销
+constexpr qint64 kGpuReserveBytes = 300 * kMiB;
+// 与旧的“模型体积 <= 95% 可用显存”判定保持同样的余量
+constexpr double kVramHeadroom = 0.95;
+// 内存需要给系统和 EVA 自身留出余量
+constexpr double kRamHeadroom = 0.90;
+// llama-server 默认 ubatch
+constexpr int kMaxUbatch = 512;
+
+int fallbackPositive(int value, int fallback)
+{
+    return value > 0 ? value : fallback;
+}
+
+int ubatchOf(const MemoryFitInput &input)
+{
+    return qBound(1, input.batch, kMaxUbatch);
+}
+
+// 计算图缓冲：激活 + 输出 logits；未开 flash attention 时再加一层 KQ 矩阵（图分配器跨层复用）
+qint64 computeBufferBytes(const MemoryFitInput &input, int totalCtx)
+{
+    const qint64 ubatch = ubatchOf(input);
+    const qint64 nEmbd = fallbackPositive(input.info.nEmbd, 4096);
+    const qint64 vocab = fallbackPositive(input.info.vocabSize, 32000);
+    const qint64 heads = fallbackPositive(input.info.nHead, 32);
+    const qint64 activations = ubatch * nEmbd * 4 * 8;
+    const qint64 logits = ubatch * vocab * 4;
+    const qint64 kq = input.flashAttn ? 0 : ubatch * qint64(totalCtx) * heads * 4;
+    return activations + logits + kq;
+}
+
+bool vramFits(const MemoryFitInput &input, const MemoryFitPlan &plan)
+{
+    if (input.freeVramMb <= 0.0 || plan.gpuLayers == 0) return true;
+    return double(plan.vramBytes) <= input.freeVramMb * kVramHeadroom * double(kMiB);
+}
+
+bool ramFits(const MemoryFitInput &input, const MemoryFitPlan &plan)
+{
+    if (input.freeRamMb <= 0.0) return true;
+    return double(plan.ramBytes) <= input.freeRamMb * kRamHeadroom * double(kMiB);
+}
+} // namespace
+
+namespace MemoryFit
+{
+double cacheTypeBytes(const QString &type)
+{
+    const QString t = type.trimmed().toLower();
+    if (t == QLatin1String("f32")) return 4.0;
+    if (t == QLatin1String("f16") || t == QLatin1String("bf16")) return 2.0;
+    // 量化块 32 个元素：数据 + 每块 scale(/min)
+    if (t == QLatin1String("q8_0")) return 34.0 / 32.0;
+    if (t == QLatin1String("q5_1")) return 24.0 / 32.0;
+    if (t == QLatin1String("q5_0")) return 22.0 / 32.0;
+    if (t == QLatin1String("q4_1")) return 20.0 / 32.0;
+    if (t == QLatin1String("q4_0") || t == QLatin1String("iq4_nl")) return 18.0 / 32.0;
+    return 2.0;
+}
+
+qint64 kvCacheBytes(const GgufInfo &info, int totalCtx, const QString &cacheTypeK, const QString &cacheTypeV)
+{
+    if (info.nLayer <= 0 || totalCtx <= 0) return 0;
+    const int heads = fallbackPositive(info.nHead, 1);
+    const int kvHeads = fallbackPositive(info.nHeadKv, heads);
+    const int headDim = fallbackPositive(info.nEmbd, 0) / heads;
+    const double keyLength = fallbackPositive(info.keyLength, headDim);
+    const double valueLength = fallbackPositive(info.valueLength, headDim);
+    const double perToken = kvHeads * (keyLength * cacheTypeBytes(cacheTypeK) + valueLength * cacheTypeBytes(cacheTypeV));
+    return qint64(perToken * double(totalCtx) * double(info.nLayer));
+}
+
+MemoryFitPlan estimate(const MemoryFitInput &input, int gpuLayers, int nctx)
+{
+    MemoryFitPlan plan;
+    const int layerCount = input.info.nLayer;
+    if (layerCount <= 0 || input.modelBytes <= 0) return plan;
+
+    plan.valid = true;
+    plan.maxGpuLayers = layerCount + 1;
+    plan.gpuLayers = input.gpu ? qBound(0, gpuLayers, plan.maxGpuLayers) : 0;
+    plan.nctx = qMax(1, nctx);
+    const int totalCtx = plan.nctx * qMax(1, input.parallel);
+
+    // 权重按 n_layer + 1 份均分（最后一份近似输出层），与 -ngl 的计数方式一致
+    const qint64 gpuWeights = input.modelBytes * plan.gpuLayers / plan.maxGpuLayers;
+    const qint64 cpuWeights = input.modelBytes - gpuWeights;
+
+    plan.kvBytes = kvCacheBytes(input.info, totalCtx, input.cacheTypeK, input.cacheTypeV);
+    const qint64 gpuKv = plan.kvBytes * qMin(plan.gpuLayers, layerCount) / layerCount;
+    const qint64 cpuKv = plan.kvBytes - gpuKv;
+
+    plan.computeBytes = computeBufferBytes(input, totalCtx);
+    plan.weightsBytes = input.modelBytes + input.mmprojBytes;
+    if (plan.gpuLayers > 0)
+    {
+        // 卸载后主机侧只剩输入嵌入与输出的暂存缓冲
+        const qint64 hostCompute = qint64(ubatchOf(input)) * (fallbackPositive(input.info.nEmbd, 4096) + fallbackPositive(input.info.vocabSize, 32000)) * 4;
+        plan.vramBytes = gpuWeights + gpuKv + plan.computeBytes + input.mmprojBytes + kGpuReserveBytes;
+        plan.ramBytes = cpuKv + hostCompute;
+    }
+    else
+    {
+        plan.ramBytes = cpuKv + plan.computeBytes + input.mmprojBytes;
+    }
+    if (input.useMmap)
+        plan.mappedBytes = cpuWeights;
+    else
+        plan.ramBytes += cpuWeights;
+
+    plan.fits = vramFits(input, plan) && ramFits(input, plan);
+    return plan;
+}
+
+MemoryFitPlan plan(const MemoryFitInput &input)
+{
+    MemoryFitPlan result;
+    if (!input.info.valid)
+    {
+        result.reason = input.info.error.isEmpty() ? QStringLiteral("not a GGUF model") : input.info.error;
+        return result;
+    }
+    if (input.info.nLayer <= 0 || input.modelBytes <= 0)
+    {
+        result.reason = QStringLiteral("missing block_count");
+        return result;
+    }
+
+    const int maxGpuLayers = input.info.nLayer + 1;
+    const int requested = input.gpu ? qBound(0, input.requestedGpuLayers, maxGpuLayers) : 0;
+    const auto bestForContext = [&](int ctx)
+    {
+        int layers = requested;
+        MemoryFitPlan candidate = estimate(input, layers, ctx);
+        while (layers > 0 && !vramFits(input, candidate))
+        {
+            candidate = estimate(input, --layers, ctx);
+        }
+        return candidate;
+    };
+
+    const int wantedCtx = qMax(1, input.nctx);
+    for (int ctx = wantedCtx; ctx >= 1; ctx /= 2)
+    {
+        if (ctx != wantedCtx && ctx < input.minCtx) break;
+        const MemoryFitPlan candidate = bestForContext(ctx);
+        if (candidate.fits) return candidate;
+    }
+
+    // 收缩上下文也装不下（权重本身超出内存）：保持原上下文，交给运行期回退处理
+    result = bestForContext(wantedCtx);
+    result.reason = QStringLiteral("needs %1 MB RAM / %2 MB VRAM")
+                        .arg(result.ramBytes / kMiB)
+                        .arg(result.vramBytes / kMiB);
+    return result;
+}
+} // namespace MemoryFit
@@ -0,0 +1,58 @@
+#ifndef MEMORY_FIT_H
+#define MEMORY_FIT_H
+
+#include "gguf_reader.h"
+
+#include <QString>
+
+// 装载前的内存/显存占用估算：权重 + KV 缓存（-c × --parallel，按 KV 类型）+ 计算缓冲。
+// 只依赖 GGUF 元数据与文件大小，在拉起 llama-server 之前就能选出装得下的最大 -ngl / 上下文，
+// 避免每次都要完整装载一次、等 serverStartFailed 再回退。数值是偏保守的近似，不追求与 llama.cpp 逐字节一致。
+struct MemoryFitInput
+{
+    GgufInfo info;
+    qint64 modelBytes = 0;  // 模型文件大小
+    qint64 mmprojBytes = 0; // 视觉投影文件大小（可为 0）
+    int nctx = 0;           // 单槽上下文（SETTINGS.nctx）
+    int parallel = 1;       // 并发槽数，总上下文 = nctx × parallel
+    int batch = 512;        // -b；计算缓冲按 min(batch, 512) 的 ubatch 估算
+    bool flashAttn = true;  // 关闭时需要额外的 KQ 注意力矩阵
+    bool useMmap = true;    // mmap 装载时留在 CPU 的权重走页缓存，可被回收，不计入必须占用
+    QString cacheTypeK = QStringLiteral("f16");
+    QString cacheTypeV = QStringLiteral("f16");
+    bool gpu = true;             // 当前后端是否为 GPU 设备（cpu 后端不传 -ngl）
+    int requestedGpuLayers = 999; // 期望的 -ngl；999 表示尽可能全量
+    double freeVramMb = 0.0;     // 可用显存；<= 0 表示未知，不做显存约束
+    double freeRamMb = 0.0;      // 可用内存；<= 0 表示未知，不做内存约束
+    int minCtx = 2048;           // 收缩上下文时的下限
+};
+
+struct MemoryFitPlan
+{
+    bool valid = false;   // 元数据不足（非 GGUF / 缺层数）时为 false，调用方应保持原设置
+    bool fits = false;    // 所选配置是否在预算内
+    QString reason;       // 不可估算或装不下的原因
+    int maxGpuLayers = 0; // n_layer + 1（含输出层），与 llama-server 回报的 max_ngl 一致
+    int gpuLayers = 0;    // 选定的 -ngl
+    int nctx = 0;         // 选定的单槽上下文
+    qint64 weightsBytes = 0;
+    qint64 kvBytes = 0;
+    qint64 computeBytes = 0;
+    qint64 vramBytes = 0;   // 显存需求（含驱动/上下文预留）
+    qint64 ramBytes = 0;    // 必须常驻的内存需求
+    qint64 mappedBytes = 0; // 留在 CPU 且经 mmap 映射的权重（可回收，不计入 ramBytes）
+};
+
+namespace MemoryFit
+{
+// KV 缓存单个元素的平均字节数（含量化块的 scale）；未知类型按 f16 处理
+double cacheTypeBytes(const QString &type);
+// 总上下文 totalCtx 下全部层的 KV 缓存大小
+qint64 kvCacheBytes(const GgufInfo &info, int totalCtx, const QString &cacheTypeK, const QString &cacheTypeV);
+// 固定 -ngl / 上下文下的占用
+MemoryFitPlan estimate(const MemoryFitInput &input, int gpuLayers, int nctx);
+// 先保上下文、再在显存内取最大 -ngl；内存不足时按一半逐步收缩上下文（不低于 minCtx）
+MemoryFitPlan plan(const MemoryFitInput &input);
+} // namespace MemoryFit
+
+#endif // MEMORY_FIT_H
@@ -0,0 +1,133 @@
+#include "utils/model_catalog.h"
+
+#include "xconfig.h"
+
+#include <QDateTime>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+namespace
+{
+constexpr int kCatalogVersion = 1;
+
+qint64 modifiedMs(const QFileInfo &fi)
+{
+    return fi.lastModified().toMSecsSinceEpoch();
+}
+} // namespace
+
+ModelCatalog::ModelCatalog(const QString &cacheFile)
+    : cacheFile_(cacheFile)
+{
+    load();
+}
+
+ModelCatalog::~ModelCatalog()
+{
+    save();
+}
+
+ModelCatalog &ModelCatalog::shared(const QString &applicationDirPath)
+{
+    static ModelCatalog catalog(QDir(applicationDirPath).filePath(QStringLiteral(EVA_TEMP_DIR_RELATIVE) + QStringLiteral("/model_catalog.json")));
+    static const bool hooked = []()
+    {
+        // 退出前写回本次会话积累的改动；析构时的写回只作兜底
+        if (QCoreApplication *app = QCoreApplication::instance())
+            QObject::connect(app, &QCoreApplication::aboutToQuit, []() { catalog.save(); });
+        return true;
+    }();
+    Q_UNUSED(hooked);
+    return catalog;
+}
+
+void ModelCatalog::load()
+{
+    QFile file(cacheFile_);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    // 版本不符（字段含义变化）时整体作废，下次访问按需重建
+    if (root.value(QStringLiteral("version")).toInt() != kCatalogVersion) return;
+    const QJsonObject models = root.value(QStringLiteral("models")).toObject();
+    for (auto it = models.begin(); it != models.end(); ++it)
+    {
+        const QJsonObject object = it.value().toObject();
+        Entry entry;
+        entry.path = it.key();
+        entry.size = qint64(object.value(QStringLiteral("size")).toDouble());
+        entry.mtimeMs = qint64(object.value(QStringLiteral("mtime_ms")).toDouble());
+        entry.info = GgufInfo::fromJson(object.value(QStringLiteral("gguf")).toObject());
+        entries_.insert(entry.path, entry);
+    }
+}
+
+bool ModelCatalog::save()
+{
+    QMutexLocker locker(&mutex_);
+    if (!dirty_) return true;
+    QJsonObject models;
+    for (auto it = entries_.begin(); it != entries_.end();)
+    {
+        if (!QFileInfo::exists(it.key()))
+        {
+            it = entries_.erase(it);
+            continue;
+        }
+        models.insert(it.key(), QJsonObject{{QStringLiteral("size"), double(it->size)},
+                                            {QStringLiteral("mtime_ms"), double(it->mtimeMs)},
+                                            {QStringLiteral("gguf"), it->info.toJson()}});
+        ++it;
+    }
+    QDir().mkpath(QFileInfo(cacheFile_).absolutePath());
+    QSaveFile file(cacheFile_);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(QJsonDocument(QJsonObject{{QStringLiteral("version"), kCatalogVersion}, {QStringLiteral("models"), models}}).toJson(QJsonDocument::Compact));
+    if (!file.commit()) return false;
+    dirty_ = false;
+    return true;
+}
+
+int ModelCatalog::parseCount() const
+{
+    QMutexLocker locker(&mutex_);
+    return parseCount_;
+}
+
+ModelCatalog::Entry ModelCatalog::lookupLocked(const QString &absolutePath, qint64 size, qint64 mtimeMs)
+{
+    auto it = entries_.find(absolutePath);
+    if (it != entries_.end() && it->size == size && it->mtimeMs == mtimeMs) return *it;
+
+    Entry entry;
+    entry.path = absolutePath;
+    entry.size = size;
+    entry.mtimeMs = mtimeMs;
+    entry.info = GgufReader::read(absolutePath);
+    ++parseCount_;
+    entries_.insert(absolutePath, entry);
+    dirty_ = true;
+    return entry;
+}
+
+GgufInfo ModelCatalog::lookup(const QString &modelPath)
+{
+    const QFileInfo fi(modelPath);
+    if (modelPath.isEmpty() || !fi.isFile())
+    {
+        GgufInfo missing;
+        missing.error = QStringLiteral("file not found");
+        return missing;
+    }
+    GgufInfo info;
+    {
+        QMutexLocker locker(&mutex_);
+        info = lookupLocked(fi.absoluteFilePath(), fi.size(), modifiedMs(fi)).info;
+    }
+    return info;
+}
@@ -0,0 +1,50 @@
+#ifndef MODEL_CATALOG_H
+#define MODEL_CATALOG_H
+
+#include "gguf_reader.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+// 模型目录缓存：以 (绝对路径, 文件大小, 修改时间) 为键缓存 GGUF 元数据，落盘到 EVA_TEMP/model_catalog.json。
+// 命中时只需一次 stat；文件被替换（大小或时间变化）才重新解析文件头。线程安全。
+// lookup 只在内存中标记改动，不写盘（常在界面线程调用）；改动在程序退出或实例析构时一次写回。
+class ModelCatalog
+{
+  public:
+    struct Entry
+    {
+        QString path;
+        qint64 size = 0;
+        qint64 mtimeMs = 0;
+        GgufInfo info;
+    };
+
+    explicit ModelCatalog(const QString &cacheFile);
+    ~ModelCatalog();
+
+    // 单个模型的元数据；非 GGUF 或解析失败时 info.valid=false（同样缓存，避免反复解析坏文件）
+    GgufInfo lookup(const QString &modelPath);
+    // 有改动时写回缓存文件，顺带丢弃文件已不存在的缓存项
+    bool save();
+
+    QString cacheFile() const { return cacheFile_; }
+    // 自构造以来真正解析文件头的次数（缓存命中不计）
+    int parseCount() const;
+
+    // 进程内共享实例，缓存位于 <applicationDirPath>/EVA_TEMP/model_catalog.json
+    static ModelCatalog &shared(const QString &applicationDirPath);
+
+  private:
+    Entry lookupLocked(const QString &absolutePath, qint64 size, qint64 mtimeMs);
+    void load();
+
+    QString cacheFile_;
+    mutable QMutex mutex_;
+    QHash<QString, Entry> entries_;
+    bool dirty_ = false;
+    int parseCount_ = 0;
+};
+
+#endif // MODEL_CATALOG_H
@@ -5,7 +5,8 @@
 #include <QtGlobal>
 
 // 网络重试策略：
-// - 仅用于“尚未收到首包”的请求失败，避免流式输出中途重试造成重复内容。
+// - 重试仅用于“尚未收到首包”的请求失败，避免流式输出中途重试造成重复内容。
+// - 首包之后断流改为续写：把已收到的部分作为前缀重新请求，由服务端接着生成，与重试共用同一预算。
 // - 通过 HTTP 状态码与网络错误类型判断是否属于短暂故障。
 inline bool isRetryableHttpStatus(int httpCode)
 {
@@ -49,6 +50,24 @@ inline bool shouldRetryNetRequest(bool canceled,
     return isRetryableNetworkError(error);
 }
 
+// prefixResumable：已输出内容能否原样作为前缀续写（结构化工具调用、独立推理字段等无法续写）
+inline bool shouldResumeNetStream(bool canceled,
+                                  bool firstByteSeen,
+                                  bool prefixResumable,
+                                  QNetworkReply::NetworkError error,
+                                  int httpCode,
+                                  int retriesUsed,
+                                  int maxRetries)
+{
+    if (canceled) return false;
+    if (!firstByteSeen) return false; // 首包前的失败走普通重试
+    if (!prefixResumable) return false;
+    if (maxRetries <= 0) return false;
+    if (retriesUsed >= maxRetries) return false;
+    if (httpCode >= 400) return isRetryableHttpStatus(httpCode);
+    return isRetryableNetworkError(error);
+}
+
 inline int nextRetryBackoffMs(int retriesUsed, int baseDelayMs, int maxDelayMs)
 {
     const int safeBase = qMax(1, baseDelayMs);
@@ -1,7 +1,9 @@
 #ifndef EVA_OPENAI_COMPAT_H
 #define EVA_OPENAI_COMPAT_H
 
+#include <QRegularExpression>
 #include <QString>
+#include <QStringList>
 #include <QUrl>
 
 // OpenAI 兼容端点的小工具：
@@ -73,6 +75,13 @@ inline QUrl joinPath(const QUrl &base, const QString &absolutePath)
     url.setPath(basePath + suffix);
     return url;
 }
+
+// 链接端点可填写多个等价端点（逗号、分号或空白分隔）：第一个为主端点，其余进入端点池用于失败切换与对冲
+inline QStringList splitEndpointList(const QString &raw)
+{
+    static const QRegularExpression separators(QStringLiteral("[,;\\s]+"));
+    return raw.split(separators, Qt::SkipEmptyParts);
+}
 } // namespace OpenAiCompat
 
 #endif // EVA_OPENAI_COMPAT_H
@@ -666,6 +666,18 @@ void SchedulerService::saveJobs()
     file.commit();
 }
 
+void SchedulerService::recordRunResult(const QString &jobId, const QString &output, const QString &error)
+{
+    QJsonObject record;
+    record.insert(QStringLiteral("job_id"), jobId);
+    record.insert(QStringLiteral("trigger"), QStringLiteral("result"));
+    record.insert(QStringLiteral("ts"), QDateTime::currentDateTime().toString(Qt::ISODate));
+    record.insert(QStringLiteral("ok"), error.isEmpty());
+    if (!error.isEmpty()) record.insert(QStringLiteral("error"), error);
+    if (!output.isEmpty()) record.insert(QStringLiteral("output"), output);
+    appendRunLog(jobId, record);
+}
+
 void SchedulerService::appendRunLog(const QString &jobId, const QJsonObject &record)
 {
     if (jobId.trimmed().isEmpty() || runsDir_.isEmpty()) return;
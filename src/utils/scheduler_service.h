@@ -31,6 +31,9 @@ class SchedulerService : public QObject
     // UI 手动操作（启用/禁用/删除/立即执行）
     QJsonObject handleUiAction(const QString &action, const QString &jobId);
 
+    // 隔离任务在后台流中跑完后记录结果（写入该任务的运行日志）
+    void recordRunResult(const QString &jobId, const QString &output, const QString &error);
+
   signals:
     void jobsUpdated(const QJsonArray &jobs);
     void jobDue(const QJsonObject &job, const QDateTime &fireTime);
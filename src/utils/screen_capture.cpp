@@ -0,0 +1,190 @@
+#include "screen_capture.h"
+
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+// -----------------------------------------------------------------------------
+// Windows 桌面截图（GDI/BitBlt）
+// -----------------------------------------------------------------------------
+// 背景：Qt 的 `QScreen::grabWindow(0)` 在极少数机器/驱动环境下可能出现“偶发卡死”，
+//       表现为调用线程被阻塞，UI 无法响应（重置按钮也无效）。
+// 目标：提供一个不依赖 Qt 平台插件截图链路的兜底实现，尽量避免 UI 被截图卡死。
+//
+// 说明：
+// - 这里只抓取“主屏幕”(0,0)-(SM_CXSCREEN,SM_CYSCREEN)，与 controller 工具层
+//   使用 `GetSystemMetrics(SM_CXSCREEN/SM_CYSCREEN)` 的坐标系保持一致。
+// - 返回的 QImage 为“物理像素”尺寸，不设置 devicePixelRatio；调用方如需按 Qt 逻辑坐标绘制，
+//   可以自行对 QPixmap 设置 devicePixelRatio。
+// -----------------------------------------------------------------------------
+QImage capturePrimaryWin32(int *outWidth, int *outHeight, QString *errorMessage)
+{
+    if (outWidth) *outWidth = 0;
+    if (outHeight) *outHeight = 0;
+
+    const int width = GetSystemMetrics(SM_CXSCREEN);
+    const int height = GetSystemMetrics(SM_CYSCREEN);
+    if (width <= 0 || height <= 0)
+    {
+        if (errorMessage) *errorMessage = QStringLiteral("GetSystemMetrics returned invalid size");
+        return {};
+    }
+
+    HDC screenDc = GetDC(nullptr);
+    if (!screenDc)
+    {
+        if (errorMessage) *errorMessage = QStringLiteral("GetDC(nullptr) failed");
+        return {};
+    }
+
+    HDC memDc = CreateCompatibleDC(screenDc);
+    if (!memDc)
+    {
+        ReleaseDC(nullptr, screenDc);
+        if (errorMessage) *errorMessage = QStringLiteral("CreateCompatibleDC failed");
+        return {};
+    }
+
+    HBITMAP bmp = CreateCompatibleBitmap(screenDc, width, height);
+    if (!bmp)
+    {
+        DeleteDC(memDc);
+        ReleaseDC(nullptr, screenDc);
+        if (errorMessage) *errorMessage = QStringLiteral("CreateCompatibleBitmap failed");
+        return {};
+    }
+
+    HGDIOBJ old = SelectObject(memDc, bmp);
+
+    // CAPTUREBLT：尽量包含 DWM/分层窗口内容（controller 截图前会隐藏 overlay，但加上更稳妥）
+    const BOOL bltOk = BitBlt(memDc, 0, 0, width, height, screenDc, 0, 0, SRCCOPY | CAPTUREBLT);
+    if (!bltOk)
+    {
+        const DWORD err = GetLastError();
+        SelectObject(memDc, old);
+        DeleteObject(bmp);
+        DeleteDC(memDc);
+        ReleaseDC(nullptr, screenDc);
+        if (errorMessage) *errorMessage = QStringLiteral("BitBlt failed (err=%1)").arg(err);
+        return {};
+    }
+
+    BITMAPINFO bmi{};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height; // 负数表示 top-down DIB，避免后续翻转
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    std::vector<uchar> buffer(static_cast<size_t>(width) * static_cast<size_t>(height) * 4u);
+    const int scanlines = GetDIBits(memDc, bmp, 0, static_cast<UINT>(height), buffer.data(), &bmi, DIB_RGB_COLORS);
+
+    SelectObject(memDc, old);
+    DeleteObject(bmp);
+    DeleteDC(memDc);
+    ReleaseDC(nullptr, screenDc);
+
+    if (scanlines <= 0)
+    {
+        if (errorMessage) *errorMessage = QStringLiteral("GetDIBits failed");
+        return {};
+    }
+
+    // QImage::Format_ARGB32 在 little-endian 下内存布局为 BGRA，与 DIB buffer 兼容。
+    // 但 GDI 截屏的 alpha 可能是未定义值，所以这里转一次 RGB32，强制 alpha=255。
+    QImage img(buffer.data(), width, height, QImage::Format_ARGB32);
+    QImage out = img.convertToFormat(QImage::Format_RGB32);
+
+    if (outWidth) *outWidth = width;
+    if (outHeight) *outHeight = height;
+    return out;
+}
+#elif defined(__linux__)
+// -----------------------------------------------------------------------------
+// X11 桌面截图（XGetImage）：每次调用独立打开 Display，可在任意线程使用
+// 供 monitor 工具在工具线程上连续截图做变化检测；QScreen::grabWindow 只能在 GUI 线程调用
+// -----------------------------------------------------------------------------
+QImage capturePrimaryX11(int *outWidth, int *outHeight, QString *errorMessage)
+{
+    if (outWidth) *outWidth = 0;
+    if (outHeight) *outHeight = 0;
+    Display *display = XOpenDisplay(nullptr);
+    if (!display)
+    {
+        if (errorMessage) *errorMessage = QStringLiteral("XOpenDisplay failed");
+        return {};
+    }
+    const Window root = DefaultRootWindow(display);
+    XWindowAttributes attrs;
+    if (!XGetWindowAttributes(display, root, &attrs) || attrs.width <= 0 || attrs.height <= 0)
+    {
+        XCloseDisplay(display);
+        if (errorMessage) *errorMessage = QStringLiteral("XGetWindowAttributes failed");
+        return {};
+    }
+    XImage *ximg = XGetImage(display, root, 0, 0, unsigned(attrs.width), unsigned(attrs.height), AllPlanes, ZPixmap);
+    if (!ximg)
+    {
+        XCloseDisplay(display);
+        if (errorMessage) *errorMessage = QStringLiteral("XGetImage failed");
+        return {};
+    }
+
+    QImage out(attrs.width, attrs.height, QImage::Format_RGB32);
+    const bool directCopy = ximg->bits_per_pixel == 32 && ximg->red_mask == 0xff0000 && ximg->green_mask == 0xff00 && ximg->blue_mask == 0xff &&
+                            ximg->byte_order == LSBFirst;
+    for (int y = 0; y < attrs.height; ++y)
+    {
+        QRgb *dst = reinterpret_cast<QRgb *>(out.scanLine(y));
+        if (directCopy)
+        {
+            // 常见的 24/32 位 TrueColor：内存布局与 Format_RGB32 一致，逐行拷贝并补齐 alpha
+            const quint32 *src = reinterpret_cast<const quint32 *>(ximg->data + y * ximg->bytes_per_line);
+            for (int x = 0; x < attrs.width; ++x) dst[x] = 0xff000000u | src[x];
+            continue;
+        }
+        for (int x = 0; x < attrs.width; ++x)
+        {
+            const unsigned long pixel = XGetPixel(ximg, x, y);
+            auto channel = [pixel](unsigned long mask) -> int {
+                if (!mask) return 0;
+                int shift = 0;
+                while (!((mask >> shift) & 1ul)) ++shift;
+                const unsigned long bits = mask >> shift;
+                return int(((pixel & mask) >> shift) * 255ul / bits);
+            };
+            dst[x] = qRgb(channel(ximg->red_mask), channel(ximg->green_mask), channel(ximg->blue_mask));
+        }
+    }
+    XDestroyImage(ximg);
+    XCloseDisplay(display);
+
+    if (outWidth) *outWidth = attrs.width;
+    if (outHeight) *outHeight = attrs.height;
+    return out;
+}
+#endif
+} // namespace
+
+QImage ScreenCapture::capturePrimary(int *outWidth, int *outHeight, QString *errorMessage)
+{
+#ifdef _WIN32
+    return capturePrimaryWin32(outWidth, outHeight, errorMessage);
+#elif defined(__linux__)
+    return capturePrimaryX11(outWidth, outHeight, errorMessage);
+#else
+    if (outWidth) *outWidth = 0;
+    if (outHeight) *outHeight = 0;
+    if (errorMessage) *errorMessage = QStringLiteral("screen capture not supported on this platform");
+    return {};
+#endif
+}
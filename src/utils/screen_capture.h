@@ -0,0 +1,14 @@
+#ifndef SCREEN_CAPTURE_H
+#define SCREEN_CAPTURE_H
+
+#include <QImage>
+#include <QString>
+
+// 不经过 Qt 平台插件的主屏幕截图：Windows 走 GDI/BitBlt，Linux 走 X11 XGetImage。
+// 不依赖 GUI 线程，可在工作线程/工具线程调用；返回物理像素尺寸的 RGB32 图像，失败时返回空图并写入 errorMessage
+namespace ScreenCapture
+{
+QImage capturePrimary(int *outWidth, int *outHeight, QString *errorMessage);
+} // namespace ScreenCapture
+
+#endif // SCREEN_CAPTURE_H
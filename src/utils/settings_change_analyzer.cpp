@@ -52,6 +52,13 @@ SettingsChangeSummary analyzeSettingsChanges(const SETTINGS &beforeSettings,
     appendUniqueIfChanged(beforeSettings.hid_use_mmap != afterSettings.hid_use_mmap, QStringLiteral("mmap"), &summary.restartItems);
     appendUniqueIfChanged(beforeSettings.hid_use_mlock != afterSettings.hid_use_mlock, QStringLiteral("mlock"), &summary.restartItems);
     appendUniqueIfChanged(beforeSettings.hid_flash_attn != afterSettings.hid_flash_attn, QStringLiteral("flash_attn"), &summary.restartItems);
+    // KV 类型按实际生效值比较：flash attention 关闭时量化类型不会传给后端，改动无需重启
+    appendUniqueIfChanged(effectiveKvCacheType(beforeSettings.hid_cache_type_k, beforeSettings.hid_flash_attn) != effectiveKvCacheType(afterSettings.hid_cache_type_k, afterSettings.hid_flash_attn),
+                          QStringLiteral("cache_type_k"), &summary.restartItems);
+    appendUniqueIfChanged(effectiveKvCacheType(beforeSettings.hid_cache_type_v, beforeSettings.hid_flash_attn) != effectiveKvCacheType(afterSettings.hid_cache_type_v, afterSettings.hid_flash_attn),
+                          QStringLiteral("cache_type_v"), &summary.restartItems);
+    appendUniqueIfChanged(qMax(0, beforeSettings.hid_cache_reuse) != qMax(0, afterSettings.hid_cache_reuse), QStringLiteral("cache_reuse"), &summary.restartItems);
+    appendUniqueIfChanged(beforeSettings.hid_context_shift != afterSettings.hid_context_shift, QStringLiteral("context_shift"), &summary.restartItems);
     appendUniqueIfChanged(beforePort != afterPort, QStringLiteral("port"), &summary.restartItems);
     appendUniqueIfChanged(!isTrimmedCaseInsensitiveEqual(beforeDevice, afterDevice), QStringLiteral("device"), &summary.restartItems);
     appendUniqueIfChanged(backendOverrideDirty, QStringLiteral("backend_override"), &summary.restartItems);
@@ -0,0 +1,68 @@
+#include "speech_stream_window.h"
+
+#include <QtGlobal>
+
+SpeechStreamWindow::SpeechStreamWindow(int stepBytes, int windowBytes)
+    : stepBytes_(qMax(2, stepBytes)), windowBytes_(qMax(2, windowBytes))
+{
+}
+
+void SpeechStreamWindow::reset()
+{
+    window_.clear();
+    sentBytes_ = 0;
+    committed_.clear();
+    partial_.clear();
+}
+
+void SpeechStreamWindow::append(const QByteArray &pcm)
+{
+    window_.append(pcm);
+}
+
+bool SpeechStreamWindow::takePartial(QByteArray *pcm)
+{
+    const int aligned = alignedSize();
+    if (aligned - sentBytes_ < stepBytes_) return false;
+    sentBytes_ = aligned;
+    if (pcm) *pcm = window_.left(aligned);
+    return true;
+}
+
+bool SpeechStreamWindow::takeFinal(QByteArray *pcm)
+{
+    if (!hasUnsentAudio()) return false;
+    const int aligned = alignedSize();
+    sentBytes_ = aligned;
+    if (pcm) *pcm = window_.left(aligned);
+    return true;
+}
+
+void SpeechStreamWindow::acceptPartial(const QString &text)
+{
+    if (sentBytes_ >= windowBytes_)
+    {
+        // 窗口已满：这次结果定稿，未送出的尾部留作新窗口的开头
+        committed_ = joinTranscript(committed_, text);
+        window_.remove(0, sentBytes_);
+        sentBytes_ = 0;
+        partial_.clear();
+        return;
+    }
+    partial_ = text;
+}
+
+QString SpeechStreamWindow::finish(const QString &tail)
+{
+    const QString content = joinTranscript(committed_, tail);
+    reset();
+    return content;
+}
+
+QString SpeechStreamWindow::joinTranscript(const QString &a, const QString &b)
+{
+    if (a.isEmpty()) return b;
+    if (b.isEmpty()) return a;
+    const bool ascii = a.back().unicode() < 0x80 && b.front().unicode() < 0x80;
+    return ascii ? a + QLatin1Char(' ') + b : a + b;
+}
@@ -0,0 +1,48 @@
+#ifndef SPEECH_STREAM_WINDOW_H
+#define SPEECH_STREAM_WINDOW_H
+
+#include <QByteArray>
+#include <QString>
+
+// 流式语音识别的窗口状态（F2 录音 -> 常驻 whisper-server）。
+// - 录音 PCM 追加到当前窗口；未送出的新数据达到 stepBytes 时整窗送一次部分识别
+// - 部分识别返回时窗口已达到 windowBytes：该结果定稿，窗口从它覆盖到的位置重新开始
+// - 松开按键后只需识别尾段；最近一次部分识别已覆盖全部数据时直接用它收尾
+// 只管理字节与文本，不涉及网络，发请求与回退由 Expend 负责。
+class SpeechStreamWindow
+{
+  public:
+    SpeechStreamWindow(int stepBytes, int windowBytes);
+
+    void reset();
+    void append(const QByteArray &pcm);
+
+    // 新增数据达到步长时取出整个窗口（按 16-bit 采样对齐）用于部分识别，并记下已送出的位置
+    bool takePartial(QByteArray *pcm);
+    // 取出收尾识别的窗口；没有新数据时返回 false，调用方直接 finish(partial())
+    bool takeFinal(QByteArray *pcm);
+    bool hasUnsentAudio() const { return alignedSize() > sentBytes_; }
+    // 部分识别结果返回
+    void acceptPartial(const QString &text);
+    // 已定稿文本 + tail，并清空状态
+    QString finish(const QString &tail);
+
+    QString text() const { return joinTranscript(committed_, partial_); }
+    QString partial() const { return partial_; }
+    int pendingBytes() const { return window_.size(); }
+
+    // 拼接两段转写文本：英文等需要空格分隔，中日文直接相连
+    static QString joinTranscript(const QString &a, const QString &b);
+
+  private:
+    int alignedSize() const { return window_.size() & ~1; }
+
+    int stepBytes_ = 0;
+    int windowBytes_ = 0;
+    QByteArray window_;  // 未定稿窗口的 PCM
+    int sentBytes_ = 0;  // 最近一次识别覆盖到的窗口长度
+    QString committed_;  // 已定稿文本
+    QString partial_;    // 当前窗口的最新识别结果
+};
+
+#endif // SPEECH_STREAM_WINDOW_H
@@ -1,15 +1,39 @@
 #include "startuplogger.h"
 
+#include <QCoreApplication>
+#include <QDir>
 #include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QLoggingCategory>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QPair>
+#include <QThread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
 
 namespace
 {
 QElapsedTimer g_timer;
 bool g_started = false;
 QMutex g_mutex;
+QVector<StartupLogger::Span> g_spans;
+QVector<QPair<QString, qint64>> g_milestones;
+
+QString currentThreadLabel()
+{
+    QThread *current = QThread::currentThread();
+    if (QCoreApplication::instance() && current == QCoreApplication::instance()->thread()) return QStringLiteral("main");
+    const QString name = current ? current->objectName() : QString();
+    return name.isEmpty() ? QStringLiteral("worker") : name;
+}
 } // namespace
 
 void StartupLogger::start()
@@ -17,6 +41,8 @@ void StartupLogger::start()
     QMutexLocker locker(&g_mutex);
     g_timer.start();
     g_started = true;
+    g_spans.clear();
+    g_milestones.clear();
     qInfo().noquote() << QStringLiteral("[startup] timer started");
 }
 
@@ -33,3 +59,129 @@ qint64 StartupLogger::elapsedMs()
     QMutexLocker locker(&g_mutex);
     return g_started ? g_timer.elapsed() : -1;
 }
+
+double StartupLogger::threadCpuMs()
+{
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exitTime, &kernel, &user)) return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return double(k.QuadPart + u.QuadPart) / 10000.0; // 100ns ticks
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0.0;
+    return double(ts.tv_sec) * 1000.0 + double(ts.tv_nsec) / 1e6;
+#endif
+}
+
+StartupLogger::Scope::Scope(const QString &name)
+    : name_(name)
+{
+    {
+        QMutexLocker locker(&g_mutex);
+        if (!g_started) return;
+        startNs_ = g_timer.nsecsElapsed();
+    }
+    startCpuMs_ = threadCpuMs();
+}
+
+StartupLogger::Scope::~Scope()
+{
+    finish();
+}
+
+double StartupLogger::Scope::finish()
+{
+    if (startNs_ < 0) return 0.0;
+    const qint64 startNs = startNs_;
+    startNs_ = -1;
+    const double cpuMs = threadCpuMs() - startCpuMs_;
+    Span span;
+    span.name = name_;
+    span.thread = currentThreadLabel();
+    span.cpuMs = qMax(0.0, cpuMs);
+    {
+        QMutexLocker locker(&g_mutex);
+        if (!g_started) return 0.0;
+        span.startMs = startNs / 1e6;
+        span.wallMs = (g_timer.nsecsElapsed() - startNs) / 1e6;
+    }
+    recordSpan(span);
+    return span.wallMs;
+}
+
+void StartupLogger::recordSpan(const Span &span)
+{
+    QMutexLocker locker(&g_mutex);
+    if (!g_started) return;
+    g_spans.append(span);
+    qInfo().noquote() << QStringLiteral("[startup] %1 [%2] wall %3 ms, cpu %4 ms")
+                             .arg(span.name, span.thread, QString::number(span.wallMs, 'f', 1), QString::number(span.cpuMs, 'f', 1));
+}
+
+void StartupLogger::milestone(const QString &name)
+{
+    QMutexLocker locker(&g_mutex);
+    if (!g_started) return;
+    for (const auto &entry : g_milestones)
+    {
+        if (entry.first == name) return;
+    }
+    const qint64 ms = g_timer.elapsed();
+    g_milestones.append(qMakePair(name, ms));
+    qInfo().noquote() << QStringLiteral("[startup] milestone %1 @ %2 ms").arg(name, QString::number(ms));
+}
+
+qint64 StartupLogger::milestoneMs(const QString &name)
+{
+    QMutexLocker locker(&g_mutex);
+    for (const auto &entry : g_milestones)
+    {
+        if (entry.first == name) return entry.second;
+    }
+    return -1;
+}
+
+QVector<StartupLogger::Span> StartupLogger::spans()
+{
+    QMutexLocker locker(&g_mutex);
+    return g_spans;
+}
+
+QJsonObject StartupLogger::timeline()
+{
+    QJsonObject milestones;
+    QJsonArray spanArray;
+    {
+        QMutexLocker locker(&g_mutex);
+        for (const auto &entry : g_milestones) milestones.insert(entry.first, entry.second);
+        for (const Span &span : g_spans)
+        {
+            spanArray.append(QJsonObject{{QStringLiteral("name"), span.name},
+                                         {QStringLiteral("thread"), span.thread},
+                                         {QStringLiteral("start_ms"), span.startMs},
+                                         {QStringLiteral("wall_ms"), span.wallMs},
+                                         {QStringLiteral("cpu_ms"), span.cpuMs}});
+        }
+    }
+    QJsonObject out;
+    out.insert(QStringLiteral("first_window_ms"), milestones.value(QStringLiteral("first_window")).toDouble(-1));
+    out.insert(QStringLiteral("ready_ms"), milestones.value(QStringLiteral("ready")).toDouble(-1));
+    out.insert(QStringLiteral("milestones"), milestones);
+    out.insert(QStringLiteral("spans"), spanArray);
+    return out;
+}
+
+bool StartupLogger::writeTimeline(const QString &path)
+{
+    if (path.isEmpty()) return false;
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    file.write(QJsonDocument(timeline()).toJson(QJsonDocument::Indented));
+    return true;
+}
@@ -1,11 +1,14 @@
 #ifndef STARTUPLOGGER_H
 #define STARTUPLOGGER_H
 
+#include <QJsonObject>
 #include <QString>
+#include <QVector>
 
 namespace StartupLogger
 {
-// Start global startup timer. Safe to call multiple times (later calls restart).
+// Start global startup timer. Safe to call multiple times (later calls restart
+// and drop previously recorded spans/milestones).
 void start();
 
 // Log a step message with the current elapsed milliseconds since start().
@@ -13,6 +16,55 @@ void log(const QString &step);
 
 // Retrieve current elapsed milliseconds since start(); returns -1 if not started.
 qint64 elapsedMs();
+
+// ---- Structured timeline ----
+// One finished subsystem span: wall time vs. CPU time of the thread that ran it.
+// cpuMs well below wallMs means the step was blocked (disk, process spawn, locks).
+struct Span
+{
+    QString name;
+    QString thread; // "main" for the GUI thread, otherwise the QThread objectName (or "worker")
+    double startMs = 0.0;
+    double wallMs = 0.0;
+    double cpuMs = 0.0;
+};
+
+// RAII span; records on destruction (or at finish(), whichever comes first).
+// No-op when the timer was not started.
+class Scope
+{
+  public:
+    explicit Scope(const QString &name);
+    ~Scope();
+    // End the span early, for objects that must outlive the measured block. Returns wall ms.
+    double finish();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    QString name_;
+    qint64 startNs_ = -1;
+    double startCpuMs_ = 0.0;
+};
+
+// Record an already measured span (e.g. from a worker that timed itself).
+void recordSpan(const Span &span);
+
+// Named point in time, e.g. "first_window" (main window painted) or "ready"
+// (deferred startup work drained). Only the first mark of a name is kept.
+void milestone(const QString &name);
+// Milliseconds since start() of a milestone; -1 if not reached.
+qint64 milestoneMs(const QString &name);
+
+QVector<Span> spans();
+
+// CPU time consumed by the calling thread, in milliseconds.
+double threadCpuMs();
+
+// {"first_window_ms":..,"ready_ms":..,"milestones":{..},"spans":[{name,thread,start_ms,wall_ms,cpu_ms},..]}
+QJsonObject timeline();
+// Write timeline() as indented JSON; creates parent directories.
+bool writeTimeline(const QString &path);
 } // namespace StartupLogger
 
 #endif // STARTUPLOGGER_H
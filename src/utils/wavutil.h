@@ -0,0 +1,138 @@
+#ifndef WAVUTIL_H
+#define WAVUTIL_H
+
+#include <QByteArray>
+#include <QtEndian>
+#include <QtGlobal>
+
+// 把 16-bit PCM（小端）封装为标准 WAV（RIFF）字节流。
+// 流式录音直接拿到裸 PCM，送 whisper-server 识别或落盘回退时都需要带头的 wav。
+inline QByteArray pcm16ToWav(const QByteArray &pcm, int sampleRate, int channels = 1)
+{
+    auto put32 = [](QByteArray &out, quint32 v)
+    {
+        char b[4];
+        qToLittleEndian<quint32>(v, b);
+        out.append(b, 4);
+    };
+    auto put16 = [](QByteArray &out, quint16 v)
+    {
+        char b[2];
+        qToLittleEndian<quint16>(v, b);
+        out.append(b, 2);
+    };
+
+    const quint16 bitsPerSample = 16;
+    const quint16 blockAlign = quint16(channels * bitsPerSample / 8);
+    // 不完整的末尾帧（奇数字节等）直接丢弃，保证 data 长度是 blockAlign 的整数倍
+    const int dataSize = blockAlign > 0 ? pcm.size() - pcm.size() % blockAlign : 0;
+    QByteArray out;
+    out.reserve(44 + dataSize);
+    out.append("RIFF", 4);
+    put32(out, quint32(36 + dataSize));
+    out.append("WAVE", 4);
+    out.append("fmt ", 4);
+    put32(out, 16);
+    put16(out, 1); // PCM
+    put16(out, quint16(channels));
+    put32(out, quint32(sampleRate));
+    put32(out, quint32(sampleRate) * blockAlign);
+    put16(out, blockAlign);
+    put16(out, bitsPerSample);
+    out.append("data", 4);
+    put32(out, quint32(dataSize));
+    out.append(pcm.constData(), dataSize);
+    return out;
+}
+
+struct WavPcm16
+{
+    int sampleRate = 0;
+    int channels = 0;
+    QByteArray pcm; // 交错的 16-bit 小端采样
+};
+
+// 解析 16-bit PCM 的 WAV：按块遍历（跳过 LIST 等附加块），data 块被截断时保留已有的完整帧。
+// 非 PCM、非 16-bit 或头部不完整时返回 false。
+inline bool parseWavPcm16(const QByteArray &wav, WavPcm16 *out)
+{
+    if (wav.size() < 12 || !wav.startsWith("RIFF") || wav.mid(8, 4) != "WAVE") return false;
+    const uchar *base = reinterpret_cast<const uchar *>(wav.constData());
+    int channels = 0;
+    int sampleRate = 0;
+    bool haveFormat = false;
+    qint64 pos = 12;
+    while (pos + 8 <= wav.size())
+    {
+        const QByteArray id = wav.mid(int(pos), 4);
+        const qint64 size = qFromLittleEndian<quint32>(base + pos + 4);
+        const qint64 body = pos + 8;
+        if (id == "fmt ")
+        {
+            if (size < 16 || body + 16 > wav.size()) return false;
+            const quint16 format = qFromLittleEndian<quint16>(base + body);
+            channels = qFromLittleEndian<quint16>(base + body + 2);
+            sampleRate = int(qFromLittleEndian<quint32>(base + body + 4));
+            const quint16 bits = qFromLittleEndian<quint16>(base + body + 14);
+            // 1 = PCM，0xFFFE = WAVE_FORMAT_EXTENSIBLE（子格式按 PCM 处理）
+            if ((format != 1 && format != 0xFFFE) || bits != 16 || channels <= 0 || sampleRate <= 0) return false;
+            haveFormat = true;
+        }
+        else if (id == "data")
+        {
+            if (!haveFormat) return false;
+            const qint64 available = qMin<qint64>(size, wav.size() - body);
+            const qint64 frame = qint64(channels) * 2;
+            if (out)
+            {
+                out->sampleRate = sampleRate;
+                out->channels = channels;
+                out->pcm = wav.mid(int(body), int(available - available % frame));
+            }
+            return true;
+        }
+        pos = body + size + (size & 1); // 块按偶数字节对齐
+    }
+    return false;
+}
+
+// 下混为单声道并线性插值重采样，供只接受 16kHz/mono 的 whisper-server 使用
+inline QByteArray resamplePcm16Mono(const QByteArray &pcm, int srcRate, int channels, int dstRate)
+{
+    if (srcRate <= 0 || dstRate <= 0 || channels <= 0) return QByteArray();
+    const qint64 frames = pcm.size() / (qint64(channels) * 2);
+    if (frames <= 0) return QByteArray();
+    const uchar *src = reinterpret_cast<const uchar *>(pcm.constData());
+    auto monoAt = [&](qint64 frame) -> double
+    {
+        double sum = 0.0;
+        for (int c = 0; c < channels; ++c)
+        {
+            sum += qFromLittleEndian<qint16>(src + (frame * channels + c) * 2);
+        }
+        return sum / channels;
+    };
+
+    const qint64 outFrames = qMax<qint64>(1, frames * dstRate / srcRate);
+    QByteArray out(int(outFrames * 2), Qt::Uninitialized);
+    uchar *dst = reinterpret_cast<uchar *>(out.data());
+    const double ratio = double(srcRate) / double(dstRate);
+    for (qint64 i = 0; i < outFrames; ++i)
+    {
+        const double at = i * ratio;
+        const qint64 left = qMin<qint64>(qint64(at), frames - 1);
+        const qint64 right = qMin<qint64>(left + 1, frames - 1);
+        const double t = at - double(left);
+        const double v = monoAt(left) * (1.0 - t) + monoAt(right) * t;
+        qToLittleEndian<qint16>(qint16(qRound(qBound(-32768.0, v, 32767.0))), dst + i * 2);
+    }
+    return out;
+}
+
+// 指定时长对应的 PCM 字节数（16-bit），按采样对齐
+inline int pcm16BytesForMs(int ms, int sampleRate, int channels = 1)
+{
+    return int(qint64(ms) * sampleRate / 1000) * channels * 2;
+}
+
+#endif // WAVUTIL_H
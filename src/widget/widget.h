@@ -41,6 +41,7 @@
 #include <QScrollBar>
 #include <QQueue>
 #include <QFutureWatcher>
+#include <QSet>
 #include <QSettings>
 #include <QSharedPointer>
 #include <QShortcut>
@@ -106,6 +107,7 @@ class ControllerOverlay;
 class SessionController;
 class ToolFlowController;
 class BackendCoordinator;
+class AgentStageProfiler;
 
 enum class DockerTargetMode
 {
@@ -316,6 +318,9 @@ class Widget : public QWidget
         QDateTime fireTime;
     };
     QQueue<ScheduledDispatch> scheduledDispatchQueue_;
+    // 定时任务：session=isolated 的任务在后台流中运行（streamId -> 任务）
+    QHash<quint64, ScheduledDispatch> isolatedScheduleRuns_;
+    quint64 nextStreamId_ = 1;
 
     float load_time = 0;
     QElapsedTimer load_timer; // measure local-server load duration
@@ -406,6 +411,13 @@ class Widget : public QWidget
     QString outFilePath;
     QTimer *audio_timer;
     QString whisper_model_path = "";
+    // 流式录音：QAudioInput 直接产出 16kHz/mono PCM，边录边交给 whisper-server；不可用时回退 QAudioRecorder
+    QAudioInput *streamAudioInput_ = nullptr;
+    QIODevice *streamAudioDevice_ = nullptr;
+    QByteArray streamPcm_;      // 本次录音的完整 PCM，结束时落盘为 EVA_.wav
+    QString speechPartialText_; // 录音期间的实时转写
+    bool startStreamCapture();
+    bool stopStreamCapture(const QString &wavPath);
 
     // 设置按钮相关
     void set_SetDialog(); // 设置设置选项
@@ -418,6 +430,7 @@ class Widget : public QWidget
     void ensurePendingOverridesInitialized();
     void commitPendingBackendOverrides();
     void rebuildReasoningCombo();
+    void syncKvCacheControls(); // KV 缓存类型 / 缓存复用 / 上下文平移控件与 ui_SETTINGS 同步
     Ui::Settings_Dialog_Ui *settings_ui;
     QDialog *settings_dialog = nullptr;
     QString deviceLabelBaseText; // “推理设备”标签的原始文本，用于 auto 提示拼接
@@ -567,6 +580,7 @@ class Widget : public QWidget
     mutable QString cachedWorkspaceRoot_;
     mutable bool cachedWorkspaceDockerView_ = false;
     mutable qint64 cachedWorkspaceSnapshotAtMs_ = 0;
+    mutable quint64 cachedWorkspaceIndexGeneration_ = 0; // 0 表示快照生成时索引尚未就绪
     mutable bool workspaceSnapshotDirty_ = true;
     void invalidateWorkspaceSnapshotCache();
     QFutureWatcher<EngineerEnvSnapshot> engineerEnvWatcher_;
@@ -686,6 +700,10 @@ class Widget : public QWidget
   signals:
     void ui2net_send(RequestSnapshot snapshot); // 快照式发送
     void ui2net_stop(bool stop);              // 传递停止信号
+    void ui2net_stream_config(int slotCount, bool pinned);                              // 后台流：slot 数与是否固定 slot
+    void ui2net_foreground_slot(int slotId);                                            // 后台流：避开前台对话的 slot
+    void ui2net_stream_start(quint64 streamId, QString owner, RequestSnapshot snapshot); // 后台流：启动
+    void ui2net_stream_cancel(quint64 streamId);                                        // 后台流：取消
 
     // 发送给tool的信号
     void ui2tool_language(int language_flag_); // 传递使用的语言
@@ -707,6 +725,9 @@ class Widget : public QWidget
     void ui2expend_settings(SETTINGS s);                              // 传递设置（评估使用）
     void ui2expend_mode(EVA_MODE m);                                  // 传递当前模式（评估使用）
     void ui2expend_speechdecode(QString wavpath, QString out_format); // 传一个wav文件开始解码
+    void ui2expend_speechstream_begin();                              // 流式录音开始
+    void ui2expend_speechstream_chunk(QByteArray pcm);                // 流式录音 PCM 片段
+    void ui2expend_speechstream_end(QString wavpath);                 // 流式录音结束（附完整 wav）
     void ui2expend_resettts();                                        // 重置文字转语音
     // 将后端（llama-server）日志输出给增殖窗口的“模型日志”
     void ui2expend_llamalog(QString log);
@@ -753,6 +774,8 @@ class Widget : public QWidget
     void recv_prompt_baseline(int tokens);                                       // set prompt baseline tokens in LINK mode
     void recv_turn_counters(int cacheTokens, int promptTokens, int predictedTokens); // final totals from timings
     void onSlotAssigned(int slotId);                                             // server slot id notification
+    void recv_stream_started(quint64 streamId, int slotId);                      // 后台流占到 slot
+    void recv_stream_finished(quint64 streamId, const QString &content, const QString &error); // 后台流结束
     void recv_reasoning_tokens(int tokens);                                      // capture <think> token count of this turn
     void recv_net_speeds(double promptPerSec, double genPerSec);                 // final speeds from xNet timings
     void toolCommandStarted(const QString &command, const QString &workingDir);
@@ -764,6 +787,7 @@ class Widget : public QWidget
 
     // 处理expend信号的槽
     void recv_speechdecode_over(QString result);
+    void recv_speechdecode_partial(QString text);     // 流式转写的实时结果
     void recv_whisper_modelpath(QString modelpath);   // 传递模型路径
     void recv_embeddingdb_describe(QString describe); // 传递知识库的描述
     void recv_schedule_action(QString action, QString jobId); // 增殖窗口触发定时任务操作
@@ -902,6 +926,8 @@ class Widget : public QWidget
     void enqueueScheduledDispatch(const QJsonObject &job, const QDateTime &fireTime);
     void tryDispatchScheduledJobs();
     bool dispatchScheduledText(const QString &text, const QJsonObject &job);
+    bool startIsolatedScheduledJob(const QJsonObject &job, const QDateTime &fireTime);
+    void cancelIsolatedScheduledJob(const QString &jobId);
     QString buildScheduleMessage(const QJsonObject &job, const QDateTime &fireTime) const;
 
     void refreshSkillsUI();
@@ -925,6 +951,9 @@ class Widget : public QWidget
     QString flowPhaseName(FlowPhase phase) const;
     QString flowTag(quint64 turnId) const;
     void logFlow(FlowPhase phase, const QString &detail, SIGNAL_STATE state = USUAL_SIGNAL);
+    void attachStageProfiler(AgentStageProfiler *profiler) { stageProfiler_ = profiler; } // 回放/压测：logFlow 同步打点到分段计时
+    void startAgentReplay(const QString &prompt, int toolCallMode);                         // 回放：按链接模式行为发出录像里的用户输入
+    void applyModelCatalogHints(const QString &modelPath);                                  // 装载前按 GGUF 元数据预设上下文上限
     void startTurnFlow(ConversationTask task, bool continuingTool);
     void finishTurnFlow(const QString &reason, bool success);
     void ensureSystemHeader(const QString &systemText);
@@ -984,8 +1013,9 @@ class Widget : public QWidget
     void setControlHostEnabled(bool enabled);
     void beginControlLink();
     void releaseControl(bool notifyRemote = true);
-    void handleControlHostClientChanged(bool connected, const QString &reason);
-    void handleControlHostCommand(const QJsonObject &payload);
+    void handleControlHostClientChanged(int peerId, bool connected, const QString &reason);
+    void handleControlHostCommand(int peerId, const QJsonObject &payload);
+    void handleControlHostPeerLagging(int peerId);
     void handleControlControllerEvent(const QJsonObject &payload);
     void handleControlControllerState(ControlChannel::ControllerState state, const QString &reason);
     void applyControlSnapshot(const QJsonObject &snap);
@@ -1010,6 +1040,7 @@ class Widget : public QWidget
     QJsonArray buildControlRecords() const;
 
   private:
+    AgentStageProfiler *stageProfiler_ = nullptr; // 不拥有
     void syncDefaultSystemPrompt(); // 切换语种时刷新默认系统提示词
     bool processServerOutputLine(const QString &line); // 按“单行”解析 llama-server 日志（onServerOutput 内部使用）；true=中断后续解析
     Ui::Widget *ui;
@@ -1024,13 +1055,16 @@ class Widget : public QWidget
     QString controlStreamRole_;       // last role hint from host ("think"/"assistant")
     struct ControlHostState
     {
-        bool active = false;
+        bool active = false; // 是否存在可下发命令的控制端（writer）
+        int writerId = -1;
         QString peer;
+        QSet<int> observers; // 只读镜像的观察端
     } controlHost_;
     struct ControlClientState
     {
         ControlChannel::ControllerState state = ControlChannel::ControllerState::Idle;
         QString peer;
+        bool observer = false; // 主机已有控制端时以只读观察者身份接入
         bool remoteRunning = false;
         EVA_STATE remoteUiState = CHAT_STATE;
     } controlClient_;
@@ -195,7 +195,7 @@ void Widget::fetchOpenAiModelsAsync()
     if (apiModelFetchInFlight_) return;
     if (!api_endpoint_LineEdit || !api_key_LineEdit) return;
 
-    const QString baseInput = api_endpoint_LineEdit->text();
+    const QString baseInput = OpenAiCompat::splitEndpointList(api_endpoint_LineEdit->text()).value(0); // 端点池共用模型，探测主端点即可
     const QString keyInput = api_key_LineEdit->text();
     const QString normalizedBase = normalizeOpenAiBaseForModels(baseInput);
     const QString cleanKey = TextParse::removeAllWhitespace(keyInput);
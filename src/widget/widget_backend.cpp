@@ -1,6 +1,7 @@
 #include "widget.h"
 #include "ui_widget.h"
 #include "service/backend/backend_coordinator.h"
+#include "../utils/model_catalog.h"
 #include "../utils/perf_metrics.h"
 #include "../utils/startuplogger.h"
 #include "../utils/flowtracer.h"
@@ -9,6 +10,23 @@
 #include <QMessageBox>
 #include <QSignalBlocker>
 
+// 本地模型装载前：从模型目录缓存读取 GGUF 元数据，先把上下文滑块上限设为训练长度，
+// 不必等 llama-server 日志回报 n_ctx_train（回报后仍以服务端为准）
+void Widget::applyModelCatalogHints(const QString &modelPath)
+{
+    const GgufInfo info = ModelCatalog::shared(applicationDirPath).lookup(modelPath);
+    if (!info.valid || info.nCtxTrain <= 0) return;
+    ui_n_ctx_train = info.nCtxTrain;
+    if (settings_ui && settings_ui->nctx_slider && settings_ui->nctx_slider->maximum() != info.nCtxTrain)
+    {
+        settings_ui->nctx_slider->setMaximum(info.nCtxTrain);
+    }
+    FlowTracer::log(FlowChannel::Backend,
+                    QStringLiteral("catalog: %1 arch=%2 quant=%3 n_ctx_train=%4")
+                        .arg(QFileInfo(modelPath).fileName(), info.arch, info.quantType)
+                        .arg(info.nCtxTrain));
+}
+
 void Widget::recv_params(MODEL_PARAMS p)
 {
     ui_n_ctx_train = p.n_ctx_train;
@@ -59,19 +77,9 @@ void Widget::recv_gpu_status(float vmem, float vramp, float vcore, float vfree_)
 
     if (gpu_wait_load)
     {
-        gpu_wait_load = false;                       // 以文件体积近似估计显存占用：若模型大小低于当前可用显存的95%，则尝试全量 offload（ngl=999）
-        QFileInfo fileInfo(ui_SETTINGS.modelpath);   // 模型文件大小
-        QFileInfo fileInfo2(ui_SETTINGS.mmprojpath); // mmproj 文件大小（可为空）
-        const int modelsize_MB = fileInfo.size() / 1024 / 1024 + fileInfo2.size() / 1024 / 1024;
-        const double limit = 0.95 * vfree; // 95% 当前可用显存
-        if (modelsize_MB > 0 && vfree > 0 && modelsize_MB <= limit)
-        {
-            ui_SETTINGS.ngl = 999; // 初次装载：尽可能全量 offload
-        }
-        else
-        {
-            ui_SETTINGS.ngl = 0; // 不足则先走纯CPU/少量 offload
-        }
+        gpu_wait_load = false;
+        // 按 GGUF 元数据估算权重 + KV + 计算缓冲，取当前可用显存内能卸载的最多层数（全部放得下时为 999）
+        ui_SETTINGS.ngl = backendCoordinator_ ? backendCoordinator_->autoGpuLayers() : 0;
         // 应用新设置并按需重启本地服务
         if (ui_mode == LOCAL_MODE) ensureLocalServer();
     }
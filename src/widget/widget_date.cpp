@@ -1034,6 +1034,7 @@ void Widget::on_set_clicked()
     settings_ui->lora_LineEdit->setText(ui_SETTINGS.lorapath);
     settings_ui->mmproj_LineEdit->setText(ui_SETTINGS.mmprojpath);
     settings_ui->nthread_slider->setValue(ui_SETTINGS.nthread);
+    syncKvCacheControls();
     settings_ui->port_lineEdit->setText(ui_port);
     if (settings_ui->allow_control_checkbox)
     {
@@ -192,6 +192,7 @@ void Widget::onSlotAssigned(int slotId)
     if (currentSlotId_ == slotId) return;
     currentSlotId_ = slotId;
     if (history_) history_->updateSlotId(slotId);
+    emit ui2net_foreground_slot(slotId);
     reflash_state(QString("net:slot id=%1").arg(slotId), SIGNAL_SIGNAL);
 }
 
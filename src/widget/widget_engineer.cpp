@@ -1,5 +1,6 @@
 #include "widget.h"
 #include "ui_widget.h"
+#include "service/tools/workspace_index.h"
 #include <QDate>
 #include <QDateTime>
 #include <QDebug>
@@ -24,8 +25,9 @@ QString canonicalOrAbsolutePath(const QDir &dir)
 
 void appendWorkspaceListing(const QDir &dir, int depth, int maxDepth, int maxEntriesPerDir, QStringList &lines)
 {
-    QStringList entries = dir.entryList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot,
-                                        QDir::Name | QDir::IgnoreCase | QDir::LocaleAware);
+    // 优先读取后台工作区索引，未覆盖的目录（被忽略/超出上限/索引未就绪）回退到直接读盘
+    WorkspaceIndex *index = WorkspaceIndex::shared();
+    const QVector<WorkspaceIndex::Entry> entries = index ? index->entriesFor(dir.absolutePath()) : WorkspaceIndex::readDirectory(dir.absolutePath());
     if (entries.isEmpty())
     {
         const QString indent(depth * 2 + 2, ' ');
@@ -37,11 +39,10 @@ void appendWorkspaceListing(const QDir &dir, int depth, int maxDepth, int maxEnt
     const int displayed = std::min(maxEntriesPerDir, static_cast<int>(total));
     for (int i = 0; i < displayed; ++i)
     {
-        const QString &name = entries.at(i);
+        const QString &name = entries.at(i).name;
         const QString indent(depth * 2 + 2, ' ');
         const QString absolutePath = dir.absoluteFilePath(name);
-        QFileInfo info(absolutePath);
-        const bool isDir = info.isDir();
+        const bool isDir = entries.at(i).isDir;
         QString line = QString("%1- %2").arg(indent, name);
         if (isDir) line.append('/');
         lines << line;
@@ -94,12 +95,19 @@ QString Widget::buildWorkspaceSnapshot(const QString &root, bool dockerView) con
 
     const QString canonicalRoot = canonicalOrAbsolutePath(rootDir);
     const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    // 索引就绪后以其代号判定缓存是否过期（目录有变化才重建）；索引未就绪时沿用时间过期
+    WorkspaceIndex *index = WorkspaceIndex::shared();
+    if (index) index->setRoot(canonicalRoot);
+    const bool indexed = index && index->covers(canonicalRoot);
+    const quint64 indexGeneration = indexed ? index->generation() : 0;
+    const bool cacheFresh = indexed ? (cachedWorkspaceIndexGeneration_ == indexGeneration)
+                                    : ((cachedWorkspaceSnapshotAtMs_ > 0) &&
+                                       (nowMs - cachedWorkspaceSnapshotAtMs_ < WORKSPACE_SNAPSHOT_CACHE_MS));
     const bool cacheMatch = !workspaceSnapshotDirty_ &&
                             cachedWorkspaceDockerView_ == dockerView &&
                             !cachedWorkspaceRoot_.isEmpty() &&
                             cachedWorkspaceRoot_ == canonicalRoot &&
-                            (cachedWorkspaceSnapshotAtMs_ > 0) &&
-                            (nowMs - cachedWorkspaceSnapshotAtMs_ < WORKSPACE_SNAPSHOT_CACHE_MS) &&
+                            cacheFresh &&
                             !cachedWorkspaceSnapshot_.isEmpty();
     if (cacheMatch)
     {
@@ -120,6 +128,7 @@ QString Widget::buildWorkspaceSnapshot(const QString &root, bool dockerView) con
     cachedWorkspaceRoot_ = canonicalRoot;
     cachedWorkspaceDockerView_ = dockerView;
     cachedWorkspaceSnapshotAtMs_ = nowMs;
+    cachedWorkspaceIndexGeneration_ = indexGeneration;
     workspaceSnapshotDirty_ = false;
     return cachedWorkspaceSnapshot_;
 }
@@ -128,6 +137,7 @@ void Widget::invalidateWorkspaceSnapshotCache()
 {
     workspaceSnapshotDirty_ = true;
     cachedWorkspaceSnapshotAtMs_ = 0;
+    cachedWorkspaceIndexGeneration_ = 0;
 }
 
 bool Widget::isArchitectModeActive() const
@@ -111,6 +111,18 @@ void Widget::get_set()
     ui_SETTINGS.ngl = settings_ui->ngl_slider->value();   // 获取ngl滑块的值
     ui_SETTINGS.lorapath = settings_ui->lora_LineEdit->text();
     ui_SETTINGS.mmprojpath = settings_ui->mmproj_LineEdit->text();
+    if (settings_ui->kv_cache_comboBox)
+    {
+        // 下拉框同时设定 K/V；未改动时保留配置文件里手工拆开的 K/V 组合
+        const QString kvType = settings_ui->kv_cache_comboBox->currentData().toString();
+        if (!kvType.isEmpty() && kvType != ui_SETTINGS.hid_cache_type_k.trimmed().toLower())
+        {
+            ui_SETTINGS.hid_cache_type_k = kvType;
+            ui_SETTINGS.hid_cache_type_v = kvType;
+        }
+    }
+    if (settings_ui->cache_reuse_spin) ui_SETTINGS.hid_cache_reuse = settings_ui->cache_reuse_spin->value();
+    if (settings_ui->context_shift_checkbox) ui_SETTINGS.hid_context_shift = settings_ui->context_shift_checkbox->isChecked();
     const int newLazyMinutes = settings_ui->lazy_timeout_spin ? settings_ui->lazy_timeout_spin->value() : qMax(0, int(lazyUnloadMs_ / 60000));
     lazyUnloadMs_ = qMax(0, newLazyMinutes) * 60000;
     if (lazyUnloadMs_ <= 0)
@@ -1139,6 +1151,10 @@ void Widget::auto_save_user()
     settings.setValue("hid_use_mlock", ui_SETTINGS.hid_use_mlock);
     settings.setValue("hid_flash_attn", ui_SETTINGS.hid_flash_attn);
     settings.setValue("hid_parallel", ui_SETTINGS.hid_parallel);
+    settings.setValue("hid_cache_type_k", ui_SETTINGS.hid_cache_type_k);
+    settings.setValue("hid_cache_type_v", ui_SETTINGS.hid_cache_type_v);
+    settings.setValue("hid_cache_reuse", ui_SETTINGS.hid_cache_reuse);
+    settings.setValue("hid_context_shift", ui_SETTINGS.hid_context_shift);
     settings.setValue("reasoning_effort", ui_SETTINGS.reasoning_effort);
     // 上下文压缩（Compaction）配置：可在配置文件中手动调整
     settings.setValue("compaction_enabled", compactionSettings_.enabled);
@@ -1204,7 +1220,8 @@ void Widget::auto_save_user()
     // 保存 api 参数：仅在链接模式下更新，避免切到本地模式后把远端配置覆盖掉
     if (ui_mode == LINK_MODE)
     {
-        settings.setValue("api_endpoint", apis.api_endpoint);
+        settings.setValue("api_endpoint", (QStringList{apis.api_endpoint} + apis.api_endpoint_pool).join(QStringLiteral("; ")));
+        settings.setValue("api_hedge", apis.api_hedge);
         settings.setValue("api_key", apis.api_key);
         settings.setValue("api_model", apis.api_model);
     }
@@ -1229,5 +1246,6 @@ void Widget::emit_send(const ENDPOINT_DATA &data)
     snapshot.wordsObj = wordsObj;
     snapshot.languageFlag = language_flag;
     snapshot.turnId = activeTurnId_;
+    logFlow(FlowPhase::NetRequest, QStringLiteral("messages=%1").arg(data.messagesArray.size()), SIGNAL_SIGNAL);
     emit ui2net_send(snapshot);
 }
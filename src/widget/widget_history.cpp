@@ -8,6 +8,7 @@
 #include <QAbstractItemView>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QScrollBar>
 
 void Widget::openHistoryManager()
 {
@@ -41,21 +42,18 @@ void Widget::openHistoryManager()
     table->setSelectionMode(QAbstractItemView::SingleSelection);
     table->setEditTriggers(QAbstractItemView::NoEditTriggers);
     v->addWidget(table);
-    auto fill = [&, self](const QString &filter)
+    // 无过滤时按页从索引读取，滚动到底部再加载下一页；有过滤时在标题与全部消息中全文检索
+    const int kPageSize = 200;
+    int loaded = 0;
+    bool filtered = false;
+    auto appendRows = [&, self](const QVector<HistoryStore::ListItem> &items)
     {
         // Limit how long a title is shown to avoid extremely wide columns
         const int kTitleMaxChars = 48; // display limit; full title is available via tooltip
-        table->setRowCount(0);
-        auto items = self->history_->listRecent(1000);
         for (const auto &it : items)
         {
             const QString title = it.title.isEmpty() ? QStringLiteral("(untitled)") : it.title;
             const QString when = it.startedAt.toString("yyyy-MM-dd hh:mm");
-            if (!filter.isEmpty())
-            {
-                const QString key = (title + " " + when).toLower();
-                if (!key.contains(filter.toLower())) continue;
-            }
             const int row = table->rowCount();
             table->insertRow(row);
             // Column 0: time (also keep the session id here for selection helpers)
@@ -66,13 +64,27 @@ void Widget::openHistoryManager()
             trimmed.replace('\n', ' ').replace('\r', ' ');
             if (trimmed.size() > kTitleMaxChars) trimmed = trimmed.left(kTitleMaxChars) + "...";
             auto *c1 = new QTableWidgetItem(trimmed);
-            c1->setToolTip(title); // show full title on hover
+            c1->setToolTip(it.snippet.isEmpty() ? title : title + "\n" + it.snippet); // show full title (and matched text) on hover
             table->setItem(row, 0, c0);
             table->setItem(row, 1, c1);
         }
         // No resize to contents; header resize modes above keep layout tidy
     };
+    auto fill = [&, self](const QString &filter)
+    {
+        table->setRowCount(0);
+        filtered = !filter.trimmed().isEmpty();
+        const auto items = filtered ? self->history_->search(filter, 1000) : self->history_->listRecentPage(0, kPageSize);
+        loaded = items.size();
+        appendRows(items);
+    };
     fill("");
+    QObject::connect(table->verticalScrollBar(), &QScrollBar::valueChanged, &dlg, [&, self](int value)
+                     {
+        if (filtered || value < table->verticalScrollBar()->maximum()) return;
+        const auto more = self->history_->listRecentPage(loaded, kPageSize);
+        loaded += more.size();
+        appendRows(more); });
     // buttons
     QHBoxLayout *h = new QHBoxLayout();
     QPushButton *restoreBtn = new QPushButton(self->jtr("restore"), &dlg);
@@ -86,6 +86,18 @@ QString normalizeLinkEndpoint(const QString &rawEndpoint)
     }
     return url.toString(QUrl::RemoveFragment);
 }
+
+// 输入框可填写多个等价端点：逐个规整并去重，第一个为主端点
+QStringList normalizeLinkEndpoints(const QString &rawEndpoints)
+{
+    QStringList endpoints;
+    for (const QString &raw : OpenAiCompat::splitEndpointList(rawEndpoints))
+    {
+        const QString clean = normalizeLinkEndpoint(raw);
+        if (!clean.isEmpty() && !endpoints.contains(clean)) endpoints << clean;
+    }
+    return endpoints;
+}
 } // namespace
 
 //-------------------------------------------------------------------------
@@ -103,14 +115,16 @@ void Widget::set_api()
 
     // 获取设置值
     // Sanitize endpoint/key/model: strip whitespace, normalize scheme, strip trailing /v1
-    QString clean_endpoint = normalizeLinkEndpoint(api_endpoint_LineEdit->text());
+    const QStringList endpoints = normalizeLinkEndpoints(api_endpoint_LineEdit->text());
+    QString clean_endpoint = endpoints.value(0);
     const QString clean_key = TextParse::removeAllWhitespace(api_key_LineEdit->text());
     const QString clean_model = TextParse::removeAllWhitespace(api_model_LineEdit->text());
     // Reflect cleaned values in UI
-    api_endpoint_LineEdit->setText(clean_endpoint);
+    api_endpoint_LineEdit->setText(endpoints.join(QStringLiteral("; ")));
     api_key_LineEdit->setText(clean_key);
     api_model_LineEdit->setText(clean_model);
     apis.api_endpoint = clean_endpoint;
+    apis.api_endpoint_pool = endpoints.mid(1);
     apis.api_key = clean_key;
     apis.api_model = clean_model;
     apis.is_local_backend = false;
@@ -219,12 +233,15 @@ void Widget::tool_testhandleTimeout()
     // Ensure latest LINK apis before pushing (users may edit endpoint/key/model after linking)
     if (ui_mode == LINK_MODE)
     {
-        QString clean_endpoint = normalizeLinkEndpoint(api_endpoint_LineEdit->text());
+        const QStringList endpoints = normalizeLinkEndpoints(api_endpoint_LineEdit->text());
+        QString clean_endpoint = endpoints.value(0);
         const QString clean_key = TextParse::removeAllWhitespace(api_key_LineEdit->text());
         const QString clean_model = TextParse::removeAllWhitespace(api_model_LineEdit->text());
-        if (clean_endpoint != apis.api_endpoint || clean_key != apis.api_key || clean_model != apis.api_model)
+        if (clean_endpoint != apis.api_endpoint || endpoints.mid(1) != apis.api_endpoint_pool ||
+            clean_key != apis.api_key || clean_model != apis.api_model)
         {
             apis.api_endpoint = clean_endpoint;
+            apis.api_endpoint_pool = endpoints.mid(1);
             apis.api_key = clean_key;
             apis.api_model = clean_model;
             apis.is_local_backend = false;
@@ -814,7 +831,8 @@ bool Widget::isControllerActive() const
 
 bool Widget::isHostControlled() const
 {
-    return controlChannel_ && controlHost_.active;
+    // 任一控制端或观察端接入时都需要镜像广播
+    return controlChannel_ && (controlHost_.active || !controlHost_.observers.isEmpty());
 }
 
 void Widget::setupControlChannel()
@@ -823,6 +841,7 @@ void Widget::setupControlChannel()
     controlChannel_ = new ControlChannel(this);
     connect(controlChannel_, &ControlChannel::hostClientChanged, this, &Widget::handleControlHostClientChanged);
     connect(controlChannel_, &ControlChannel::hostCommandArrived, this, &Widget::handleControlHostCommand);
+    connect(controlChannel_, &ControlChannel::hostPeerLagging, this, &Widget::handleControlHostPeerLagging);
     connect(controlChannel_, &ControlChannel::controllerEventArrived, this, &Widget::handleControlControllerEvent);
     connect(controlChannel_, &ControlChannel::controllerStateChanged, this, &Widget::handleControlControllerState);
 }
@@ -867,7 +886,9 @@ void Widget::setControlHostEnabled(bool enabled)
         bye.insert(QStringLiteral("type"), QStringLiteral("released"));
         controlChannel_->sendToController(bye);
         controlHost_.active = false;
+        controlHost_.writerId = -1;
         controlHost_.peer.clear();
+        controlHost_.observers.clear();
     }
     controlChannel_->stopHost();
 }
@@ -1119,35 +1140,62 @@ void Widget::applyControlRecordUpdate(int index, const QString &deltaText)
     recordAppendText(index, deltaText);
 }
 
-void Widget::handleControlHostClientChanged(bool connected, const QString &reason)
+void Widget::handleControlHostClientChanged(int peerId, bool connected, const QString &reason)
 {
     Q_UNUSED(reason);
-    if (!connected)
+    if (connected) return; // 等待 hello 再分配角色
+    if (controlHost_.observers.remove(peerId))
     {
-        controlHost_.active = false;
-        controlHost_.peer.clear();
-        appendControlStateLog(jtr("control disconnected"), SIGNAL_SIGNAL, jtr("control peer prefix"), true);
-        broadcastControlState(jtr("control disconnected"), SIGNAL_SIGNAL);
+        appendControlStateLog(jtr("control observer left").arg(controlHost_.observers.size()), SIGNAL_SIGNAL, jtr("control peer prefix"), true);
         return;
     }
-    controlHost_.peer = controlChannel_ ? controlChannel_->hostPeer() : QString();
+    if (peerId != controlHost_.writerId) return;
+    controlHost_.active = false;
+    controlHost_.writerId = -1;
+    controlHost_.peer.clear();
+    appendControlStateLog(jtr("control disconnected"), SIGNAL_SIGNAL, jtr("control peer prefix"), true);
+    broadcastControlState(jtr("control disconnected"), SIGNAL_SIGNAL);
 }
 
-void Widget::handleControlHostCommand(const QJsonObject &payload)
+void Widget::handleControlHostPeerLagging(int peerId)
+{
+    if (!controlChannel_) return;
+    // 慢速观察端的积压已被丢弃，补发一次完整快照让其重新对齐
+    QJsonObject payload;
+    payload.insert(QStringLiteral("type"), QStringLiteral("snapshot"));
+    payload.insert(QStringLiteral("snapshot"), buildControlSnapshot());
+    controlChannel_->sendToPeer(peerId, payload);
+    FlowTracer::log(FlowChannel::Session,
+                    QStringLiteral("[control] host resync lagging peer=%1").arg(peerId),
+                    activeTurnId_);
+}
+
+void Widget::handleControlHostCommand(int peerId, const QJsonObject &payload)
 {
     const QString type = payload.value(QStringLiteral("type")).toString();
     if (type == QStringLiteral("hello"))
     {
-        if (controlHost_.active)
+        if (controlHost_.active && peerId != controlHost_.writerId)
         {
-            QJsonObject busy;
-            busy.insert(QStringLiteral("type"), QStringLiteral("reject"));
-            busy.insert(QStringLiteral("reason"), QStringLiteral("busy"));
-            controlChannel_->sendToController(busy);
+            // 已有控制端：以只读观察者身份接入，只接收镜像，不接受命令
+            controlHost_.observers.insert(peerId);
+            controlChannel_->setPeerRole(peerId, ControlChannel::PeerRole::Observer);
+            const QString observerPeer = controlChannel_->hostPeer(peerId);
+            appendControlStateLog(jtr("control observer joined").arg(observerPeer.isEmpty() ? QStringLiteral("-") : observerPeer).arg(controlHost_.observers.size()),
+                                  SIGNAL_SIGNAL, jtr("control peer prefix"), true);
+            QJsonObject ack;
+            ack.insert(QStringLiteral("type"), QStringLiteral("hello_ack"));
+            ack.insert(QStringLiteral("role"), QStringLiteral("observer"));
+            ack.insert(QStringLiteral("snapshot"), buildControlSnapshot());
+            ack.insert(QStringLiteral("peer"), QHostInfo::localHostName());
+            controlChannel_->sendToPeer(peerId, ack);
             return;
         }
+        controlHost_.observers.remove(peerId);
         controlHost_.active = true;
-        controlHost_.peer = controlChannel_ ? controlChannel_->hostPeer() : QString();
+        controlHost_.writerId = peerId;
+        controlChannel_->setPeerRole(peerId, ControlChannel::PeerRole::Writer);
+        controlHost_.peer = controlChannel_ ? controlChannel_->hostPeer(peerId) : QString();
         reflash_state(jtr("control connected").arg(controlHost_.peer), SIGNAL_SIGNAL);
         const QString modeLabel = (ui_mode == LINK_MODE) ? QStringLiteral("链接") : QStringLiteral("本地");
         const QString stateLabel = (ui_state == CHAT_STATE) ? QStringLiteral("对话") : QStringLiteral("补完");
@@ -1173,9 +1221,10 @@ void Widget::handleControlHostCommand(const QJsonObject &payload)
         appendControlStateLog(infoLine, SIGNAL_SIGNAL, jtr("control peer prefix"), true);
         QJsonObject ack;
         ack.insert(QStringLiteral("type"), QStringLiteral("hello_ack"));
+        ack.insert(QStringLiteral("role"), QStringLiteral("writer"));
         ack.insert(QStringLiteral("snapshot"), buildControlSnapshot());
         ack.insert(QStringLiteral("peer"), QHostInfo::localHostName());
-        controlChannel_->sendToController(ack);
+        controlChannel_->sendToPeer(peerId, ack);
         return;
     }
     if (!isHostControlled()) return;
@@ -1183,11 +1232,29 @@ void Widget::handleControlHostCommand(const QJsonObject &payload)
     const QString name = payload.value(QStringLiteral("name")).toString();
     if (name == QStringLiteral("release"))
     {
-        controlHost_.active = false;
-        reflash_state(jtr("control host exit"), SIGNAL_SIGNAL);
         QJsonObject bye;
         bye.insert(QStringLiteral("type"), QStringLiteral("released"));
-        controlChannel_->sendToController(bye);
+        if (controlHost_.observers.remove(peerId))
+        {
+            controlChannel_->sendToPeer(peerId, bye);
+            return;
+        }
+        if (peerId != controlHost_.writerId) return;
+        controlHost_.active = false;
+        controlHost_.writerId = -1;
+        controlChannel_->setPeerRole(peerId, ControlChannel::PeerRole::Pending);
+        reflash_state(jtr("control host exit"), SIGNAL_SIGNAL);
+        controlChannel_->sendToPeer(peerId, bye);
+        return;
+    }
+    if (peerId != controlHost_.writerId)
+    {
+        // 观察端只读：拒绝命令但保持连接
+        QJsonObject warn;
+        warn.insert(QStringLiteral("type"), QStringLiteral("state_log"));
+        warn.insert(QStringLiteral("text"), jtr("control observer readonly"));
+        warn.insert(QStringLiteral("level"), static_cast<int>(WRONG_SIGNAL));
+        controlChannel_->sendToPeer(peerId, warn);
         return;
     }
     if (name == QStringLiteral("stop"))
@@ -1215,7 +1282,7 @@ void Widget::handleControlHostCommand(const QJsonObject &payload)
             warn.insert(QStringLiteral("type"), QStringLiteral("state_log"));
             warn.insert(QStringLiteral("text"), jtr("control command blocked"));
             warn.insert(QStringLiteral("level"), static_cast<int>(WRONG_SIGNAL));
-            controlChannel_->sendToController(warn);
+            controlChannel_->sendToPeer(peerId, warn);
             return;
         }
         const QString text = payload.value(QStringLiteral("text")).toString();
@@ -1225,7 +1292,7 @@ void Widget::handleControlHostCommand(const QJsonObject &payload)
             warn.insert(QStringLiteral("type"), QStringLiteral("state_log"));
             warn.insert(QStringLiteral("text"), jtr("control send missing"));
             warn.insert(QStringLiteral("level"), static_cast<int>(WRONG_SIGNAL));
-            controlChannel_->sendToController(warn);
+            controlChannel_->sendToPeer(peerId, warn);
             return;
         }
         struct DraftBackup
@@ -1272,6 +1339,11 @@ void Widget::handleControlControllerEvent(const QJsonObject &payload)
     {
         controlAwaitingHello_ = false;
         if (payload.contains(QStringLiteral("peer"))) controlClient_.peer = payload.value(QStringLiteral("peer")).toString();
+        if (type == QStringLiteral("hello_ack"))
+        {
+            controlClient_.observer = (payload.value(QStringLiteral("role")).toString() == QStringLiteral("observer"));
+            if (controlClient_.observer) reflash_state(jtr("control observer readonly"), SIGNAL_SIGNAL);
+        }
         const QJsonObject snap = payload.value(QStringLiteral("snapshot")).toObject();
         applyControlSnapshot(snap);
         reflash_state(jtr("control snapshot applied"), SIGNAL_SIGNAL);
@@ -1534,9 +1606,9 @@ void Widget::applyControlUiLock()
     const QString releaseLabel = jtr("control release");
     if (isControllerActive())
     {
-        const bool canSend = !controlClient_.remoteRunning;
+        const bool canSend = !controlClient_.remoteRunning && !controlClient_.observer;
         ui->send->setEnabled(canSend);
-        ui->reset->setEnabled(true);
+        ui->reset->setEnabled(!controlClient_.observer);
         // Merge load/date/set into a single “解除” control to match controller UI spec
         if (ui->load) ui->load->setVisible(false);
         if (ui->set) ui->set->setVisible(false);
@@ -1549,7 +1621,7 @@ void Widget::applyControlUiLock()
         ui->date->setEnabled(true);
         ui->set->setEnabled(true);
         ui->load->setEnabled(true);
-        if (ui->input && ui->input->textEdit) ui->input->textEdit->setReadOnly(false);
+        if (ui->input && ui->input->textEdit) ui->input->textEdit->setReadOnly(controlClient_.observer);
     }
     else
     {
@@ -1606,6 +1678,7 @@ void Widget::beginControlLink()
     controlToken_ = control_token_LineEdit ? control_token_LineEdit->text() : QString();
     ui_mode = LINK_MODE;
     controlClient_.remoteRunning = false;
+    controlClient_.observer = false;
     controlClient_.remoteUiState = ui_state;
     controlAwaitingHello_ = true;
     if (controlChannel_) controlChannel_->connectToHost(controlTargetHost_, controlTargetPort_);
@@ -1624,6 +1697,7 @@ void Widget::releaseControl(bool notifyRemote)
     }
     controlClient_.state = ControlChannel::ControllerState::Idle;
     controlClient_.peer.clear();
+    controlClient_.observer = false;
     controlClient_.remoteRunning = false;
     controlAwaitingHello_ = false;
     linkProfile_ = LinkProfile::Api;
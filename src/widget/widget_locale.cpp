@@ -300,6 +300,27 @@ void Widget::apply_language(int language_flag_)
     settings_ui->parallel_label->setText(jtr("parallel") + " " + QString::number(ui_SETTINGS.hid_parallel));
     settings_ui->parallel_slider->setToolTip(jtr("parallel_label_tooltip"));
     settings_ui->parallel_label->setToolTip(jtr("parallel_label_tooltip"));
+    if (settings_ui->kv_cache_label)
+    {
+        settings_ui->kv_cache_label->setText(jtr("kv cache"));
+        settings_ui->kv_cache_label->setToolTip(jtr("kv cache tooltip"));
+    }
+    if (settings_ui->kv_cache_comboBox) settings_ui->kv_cache_comboBox->setToolTip(jtr("kv cache tooltip"));
+    if (settings_ui->context_shift_checkbox)
+    {
+        settings_ui->context_shift_checkbox->setText(jtr("context shift"));
+        settings_ui->context_shift_checkbox->setToolTip(jtr("context shift tooltip"));
+    }
+    if (settings_ui->cache_reuse_label)
+    {
+        settings_ui->cache_reuse_label->setText(jtr("cache reuse"));
+        settings_ui->cache_reuse_label->setToolTip(jtr("cache reuse tooltip"));
+    }
+    if (settings_ui->cache_reuse_spin)
+    {
+        settings_ui->cache_reuse_spin->setSpecialValueText(jtr("off"));
+        settings_ui->cache_reuse_spin->setToolTip(jtr("cache reuse tooltip"));
+    }
     settings_ui->repeat_label->setToolTip(jtr("Reduce the probability of the model outputting synonymous words"));
     settings_ui->repeat_slider->setToolTip(jtr("Reduce the probability of the model outputting synonymous words"));
     settings_ui->backend_box->setTitle(jtr("backend set")); // 后端设置区域
@@ -1,6 +1,8 @@
 #include "widget.h"
 #include "ui_widget.h"
 #include "controller_overlay.h"
+#include "../utils/screen_capture.h"
+#include "../utils/wavutil.h"
 #include <QImage>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -16,6 +18,7 @@
 #include <QUrl>
 #include <QTextCursor>
 #include <QAudioDeviceInfo>
+#include <QAudioFormat>
 #include <QScrollBar>
 #include <QEventLoop>
 #include <QFutureWatcher>
@@ -27,108 +30,6 @@
 #include <windows.h>
 #endif
 
-namespace
-{
-#ifdef _WIN32
-// -----------------------------------------------------------------------------
-// Windows 桌面截图（GDI/BitBlt）
-// -----------------------------------------------------------------------------
-// 背景：Qt 的 `QScreen::grabWindow(0)` 在极少数机器/驱动环境下可能出现“偶发卡死”，
-//       表现为调用线程被阻塞，UI 无法响应（重置按钮也无效）。
-// 目标：提供一个不依赖 Qt 平台插件截图链路的兜底实现，尽量避免 UI 被截图卡死。
-//
-// 说明：
-// - 这里只抓取“主屏幕”(0,0)-(SM_CXSCREEN,SM_CYSCREEN)，与 controller 工具层
-//   使用 `GetSystemMetrics(SM_CXSCREEN/SM_CYSCREEN)` 的坐标系保持一致。
-// - 返回的 QImage 为“物理像素”尺寸，不设置 devicePixelRatio；调用方如需按 Qt 逻辑坐标绘制，
-//   可以自行对 QPixmap 设置 devicePixelRatio。
-// -----------------------------------------------------------------------------
-static QImage capturePrimaryScreenWin32(int *outWidth, int *outHeight, QString *errorMessage)
-{
-    if (outWidth) *outWidth = 0;
-    if (outHeight) *outHeight = 0;
-
-    const int width = GetSystemMetrics(SM_CXSCREEN);
-    const int height = GetSystemMetrics(SM_CYSCREEN);
-    if (width <= 0 || height <= 0)
-    {
-        if (errorMessage) *errorMessage = QStringLiteral("GetSystemMetrics returned invalid size");
-        return {};
-    }
-
-    HDC screenDc = GetDC(nullptr);
-    if (!screenDc)
-    {
-        if (errorMessage) *errorMessage = QStringLiteral("GetDC(nullptr) failed");
-        return {};
-    }
-
-    HDC memDc = CreateCompatibleDC(screenDc);
-    if (!memDc)
-    {
-        ReleaseDC(nullptr, screenDc);
-        if (errorMessage) *errorMessage = QStringLiteral("CreateCompatibleDC failed");
-        return {};
-    }
-
-    HBITMAP bmp = CreateCompatibleBitmap(screenDc, width, height);
-    if (!bmp)
-    {
-        DeleteDC(memDc);
-        ReleaseDC(nullptr, screenDc);
-        if (errorMessage) *errorMessage = QStringLiteral("CreateCompatibleBitmap failed");
-        return {};
-    }
-
-    HGDIOBJ old = SelectObject(memDc, bmp);
-
-    // CAPTUREBLT：尽量包含 DWM/分层窗口内容（controller 截图前会隐藏 overlay，但加上更稳妥）
-    const BOOL bltOk = BitBlt(memDc, 0, 0, width, height, screenDc, 0, 0, SRCCOPY | CAPTUREBLT);
-    if (!bltOk)
-    {
-        const DWORD err = GetLastError();
-        SelectObject(memDc, old);
-        DeleteObject(bmp);
-        DeleteDC(memDc);
-        ReleaseDC(nullptr, screenDc);
-        if (errorMessage) *errorMessage = QStringLiteral("BitBlt failed (err=%1)").arg(err);
-        return {};
-    }
-
-    BITMAPINFO bmi{};
-    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = width;
-    bmi.bmiHeader.biHeight = -height; // 负数表示 top-down DIB，避免后续翻转
-    bmi.bmiHeader.biPlanes = 1;
-    bmi.bmiHeader.biBitCount = 32;
-    bmi.bmiHeader.biCompression = BI_RGB;
-
-    std::vector<uchar> buffer(static_cast<size_t>(width) * static_cast<size_t>(height) * 4u);
-    const int scanlines = GetDIBits(memDc, bmp, 0, static_cast<UINT>(height), buffer.data(), &bmi, DIB_RGB_COLORS);
-
-    SelectObject(memDc, old);
-    DeleteObject(bmp);
-    DeleteDC(memDc);
-    ReleaseDC(nullptr, screenDc);
-
-    if (scanlines <= 0)
-    {
-        if (errorMessage) *errorMessage = QStringLiteral("GetDIBits failed");
-        return {};
-    }
-
-    // QImage::Format_ARGB32 在 little-endian 下内存布局为 BGRA，与 DIB buffer 兼容。
-    // 但 GDI 截屏的 alpha 可能是未定义值，所以这里转一次 RGB32，强制 alpha=255。
-    QImage img(buffer.data(), width, height, QImage::Format_ARGB32);
-    QImage out = img.convertToFormat(QImage::Format_RGB32);
-
-    if (outWidth) *outWidth = width;
-    if (outHeight) *outHeight = height;
-    return out;
-}
-#endif
-} // namespace
-
 void Widget::ensureControllerOverlay()
 {
     if (controllerOverlay_) return;
@@ -505,8 +406,71 @@ void Widget::recordAudio()
 {
     reflash_state("ui:" + jtr("recoding") + "... ");
     ui_state_recoding();
-    audioRecorder.record();  // 在这之前检查是否可用
-    audio_timer->start(100); // 每隔100毫秒刷新一次输入区
+    if (!startStreamCapture()) audioRecorder.record(); // 在这之前检查是否可用
+    audio_timer->start(100);                            // 每隔100毫秒刷新一次输入区
+}
+
+// 流式录音：直接采集 PCM 并逐段转发给增殖窗口，录音过程中即可开始识别
+bool Widget::startStreamCapture()
+{
+    if (!DEFAULT_WHISPER_RESIDENT_ENABLE) return false;
+    QAudioFormat format;
+    format.setSampleRate(DEFAULT_WHISPER_SAMPLE_RATE);
+    format.setChannelCount(1);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec(QStringLiteral("audio/pcm"));
+    const QAudioDeviceInfo device = QAudioDeviceInfo::defaultInputDevice();
+    if (device.isNull() || !device.isFormatSupported(format)) return false;
+
+    streamPcm_.clear();
+    speechPartialText_.clear();
+    streamAudioInput_ = new QAudioInput(device, format, this);
+    streamAudioDevice_ = streamAudioInput_->start();
+    if (!streamAudioDevice_)
+    {
+        streamAudioInput_->deleteLater();
+        streamAudioInput_ = nullptr;
+        return false;
+    }
+    connect(streamAudioDevice_, &QIODevice::readyRead, this, [this]()
+            {
+                if (!streamAudioDevice_) return;
+                const QByteArray chunk = streamAudioDevice_->readAll();
+                if (chunk.isEmpty()) return;
+                streamPcm_.append(chunk);
+                emit ui2expend_speechstream_chunk(chunk); });
+    emit ui2expend_speechstream_begin();
+    return true;
+}
+
+// 结束流式录音并把完整 PCM 落盘；返回 false 表示本次走的是 QAudioRecorder
+bool Widget::stopStreamCapture(const QString &wavPath)
+{
+    if (!streamAudioInput_) return false;
+    if (streamAudioDevice_)
+    {
+        const QByteArray tail = streamAudioDevice_->readAll();
+        if (!tail.isEmpty())
+        {
+            streamPcm_.append(tail);
+            emit ui2expend_speechstream_chunk(tail);
+        }
+    }
+    streamAudioInput_->stop();
+    streamAudioInput_->deleteLater();
+    streamAudioInput_ = nullptr;
+    streamAudioDevice_ = nullptr;
+
+    QFile file(wavPath);
+    if (file.open(QIODevice::WriteOnly))
+    {
+        file.write(pcm16ToWav(streamPcm_, DEFAULT_WHISPER_SAMPLE_RATE));
+        file.close();
+    }
+    streamPcm_.clear();
+    return true;
 }
 
 void Widget::monitorAudioLevel()
@@ -519,12 +483,16 @@ void Widget::stop_recordAudio()
 {
     QString wav_path = applicationDirPath + "/EVA_TEMP/" + QString("EVA_") + ".wav";
     is_recodering = false;
-    audioRecorder.stop();
+    const bool streamed = stopStreamCapture(wav_path);
+    if (!streamed) audioRecorder.stop();
     audio_timer->stop();
     reflash_state("ui:" + jtr("recoding over") + " " + QString::number(float(audio_time) / 1000.0, 'f', 2) + "s");
     audio_time = 0;
     // 录音已直接以 16kHz/mono 输出，无需再做重采样
-    emit ui2expend_speechdecode(wav_path, "txt"); // 传一个wav文件开始解码
+    if (streamed)
+        emit ui2expend_speechstream_end(wav_path); // 大部分内容已在录音中识别，只需收尾
+    else
+        emit ui2expend_speechdecode(wav_path, "txt"); // 传一个wav文件开始解码
 }
 
 QString Widget::saveScreen()
@@ -543,7 +511,7 @@ QString Widget::saveScreen()
         QString err;
         int w = 0;
         int h = 0;
-        const QImage snap = capturePrimaryScreenWin32(&w, &h, &err);
+        const QImage snap = ScreenCapture::capturePrimary(&w, &h, &err);
         if (snap.isNull())
         {
             // 兜底：失败时不再回退到 grabWindow，避免把“卡死风险”带回来。
@@ -677,7 +645,7 @@ Widget::ControllerFrame Widget::captureControllerFrame()
         // 注意：这里用“等待 + 事件循环”的方式让 UI 仍可响应（例如用户点击重置）。
         QFuture<WinCaptureResult> future = QtConcurrent::run([]() -> WinCaptureResult {
             WinCaptureResult result;
-            result.image = capturePrimaryScreenWin32(&result.width, &result.height, &result.error);
+            result.image = ScreenCapture::capturePrimary(&result.width, &result.height, &result.error);
             return result;
         });
 
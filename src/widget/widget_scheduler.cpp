@@ -41,6 +41,11 @@ void Widget::handleScheduleToolCall(const mcp::json &toolsCall)
         }
     }
 
+    const QString action = argsObj.value(QStringLiteral("action")).toString().trimmed().toLower();
+    if (action == QStringLiteral("remove") || action == QStringLiteral("disable"))
+    {
+        cancelIsolatedScheduledJob(argsObj.value(QStringLiteral("job")).toObject().value(QStringLiteral("job_id")).toString().trimmed());
+    }
     const QJsonObject resultObj = scheduler_->handleToolCall(argsObj);
     const QString resultJson = QString::fromUtf8(QJsonDocument(resultObj).toJson(QJsonDocument::Compact));
     const QString toolResult = QStringLiteral("schedule_task return\n") + resultJson;
@@ -57,6 +62,10 @@ void Widget::handleScheduleUiAction(const QString &action, const QString &jobId)
 {
     if (!scheduler_) initScheduler();
     if (!scheduler_) return;
+    if (action == QStringLiteral("remove") || action == QStringLiteral("disable"))
+    {
+        cancelIsolatedScheduledJob(jobId);
+    }
     const QJsonObject result = scheduler_->handleUiAction(action, jobId);
     const bool ok = result.value(QStringLiteral("ok")).toBool(true);
     const QString err = result.value(QStringLiteral("error")).toString();
@@ -74,10 +83,110 @@ void Widget::onSchedulerJobsUpdated(const QJsonArray &jobs)
 
 void Widget::onSchedulerJobDue(const QJsonObject &job, const QDateTime &fireTime)
 {
+    // session=isolated：不进入主对话，占用空闲 slot 在后台并行执行；没有空闲 slot 时回退到主对话队列
+    const QString session = job.value(QStringLiteral("session")).toString().trimmed().toLower();
+    if (session == QStringLiteral("isolated") && startIsolatedScheduledJob(job, fireTime)) return;
     enqueueScheduledDispatch(job, fireTime);
     tryDispatchScheduledJobs();
 }
 
+bool Widget::startIsolatedScheduledJob(const QJsonObject &job, const QDateTime &fireTime)
+{
+    int slotCount = 1 + DEFAULT_NET_REMOTE_BACKGROUND_STREAMS;
+    const bool pinned = (ui_mode == LOCAL_MODE);
+    if (pinned)
+    {
+        const bool serverRunning = serverManager && serverManager->isRunning();
+        const bool backendReady = serverRunning && backendOnline_ && !lazyUnloaded_ && !lazyWakeInFlight_;
+        slotCount = ui_SETTINGS.hid_parallel > 0 ? ui_SETTINGS.hid_parallel : 1;
+        if (!backendReady || slotCount < 2) return false;
+    }
+    else if (linkProfile_ == LinkProfile::Control)
+    {
+        return false;
+    }
+
+    const QString message = buildScheduleMessage(job, fireTime);
+    if (message.trimmed().isEmpty()) return false;
+
+    // 单轮、无工具：隔离任务没有可见的对话记录，工具循环需要主对话的 UI 流程
+    ENDPOINT_DATA data = prepareEndpointData();
+    data.is_complete_state = false;
+    data.tool_call_mode = TOOL_CALL_TEXT;
+    data.tools = QJsonArray();
+    data.id_slot = -1;
+    data.turn_id = 0;
+    QJsonArray messages;
+    QJsonObject systemMessage;
+    systemMessage.insert(QStringLiteral("role"), QStringLiteral(DEFAULT_SYSTEM_NAME));
+    systemMessage.insert(QStringLiteral("content"), ui_DATES.date_prompt);
+    messages.append(systemMessage);
+    QJsonObject userMessage;
+    userMessage.insert(QStringLiteral("role"), QStringLiteral(DEFAULT_USER_NAME));
+    userMessage.insert(QStringLiteral("content"), message);
+    messages.append(userMessage);
+    data.messagesArray = messages;
+
+    RequestSnapshot snapshot;
+    snapshot.apis = apis;
+    snapshot.endpoint = data;
+    snapshot.wordsObj = wordsObj;
+    snapshot.languageFlag = language_flag;
+
+    const quint64 streamId = nextStreamId_++;
+    ScheduledDispatch item;
+    item.job = job;
+    item.fireTime = fireTime;
+    isolatedScheduleRuns_.insert(streamId, item);
+
+    emit ui2net_stream_config(slotCount, pinned);
+    emit ui2net_foreground_slot(currentSlotId_);
+    emit ui2net_stream_start(streamId, QStringLiteral("schedule:") + job.value(QStringLiteral("job_id")).toString(), snapshot);
+    return true;
+}
+
+void Widget::cancelIsolatedScheduledJob(const QString &jobId)
+{
+    if (jobId.isEmpty()) return;
+    for (auto it = isolatedScheduleRuns_.constBegin(); it != isolatedScheduleRuns_.constEnd(); ++it)
+    {
+        if (it.value().job.value(QStringLiteral("job_id")).toString().trimmed() == jobId) emit ui2net_stream_cancel(it.key());
+    }
+}
+
+void Widget::recv_stream_started(quint64 streamId, int slotId)
+{
+    const auto it = isolatedScheduleRuns_.constFind(streamId);
+    if (it == isolatedScheduleRuns_.constEnd()) return;
+    const QString name = it.value().job.value(QStringLiteral("name")).toString().trimmed();
+    reflash_state(QStringLiteral("ui:schedule %1 running in background (slot %2)")
+                      .arg(name.isEmpty() ? it.value().job.value(QStringLiteral("job_id")).toString() : name)
+                      .arg(slotId),
+                  SIGNAL_SIGNAL);
+}
+
+void Widget::recv_stream_finished(quint64 streamId, const QString &content, const QString &error)
+{
+    if (!isolatedScheduleRuns_.contains(streamId)) return;
+    const ScheduledDispatch item = isolatedScheduleRuns_.take(streamId);
+    const QString jobId = item.job.value(QStringLiteral("job_id")).toString().trimmed();
+    if (error == QStringLiteral("no idle slot"))
+    {
+        enqueueScheduledDispatch(item.job, item.fireTime);
+        tryDispatchScheduledJobs();
+        return;
+    }
+    if (scheduler_) scheduler_->recordRunResult(jobId, content, error);
+    QString name = item.job.value(QStringLiteral("name")).toString().trimmed();
+    if (name.isEmpty()) name = jobId;
+    if (!error.isEmpty())
+    {
+        reflash_state(QStringLiteral("ui:schedule %1 failed: %2").arg(name, error), WRONG_SIGNAL);
+        return;
+    }
+    reflash_state(QStringLiteral("ui:schedule %1 done\n%2").arg(name, content), SUCCESS_SIGNAL);
+}
+
 void Widget::enqueueScheduledDispatch(const QJsonObject &job, const QDateTime &fireTime)
 {
     const QString jobId = job.value(QStringLiteral("job_id")).toString().trimmed();
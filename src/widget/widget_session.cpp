@@ -1,5 +1,6 @@
 ﻿#include "widget.h"
 #include "ui_widget.h"
+#include "core/replay/agent_stage_profiler.h"
 #include "core/session/session_controller.h"
 #include "../utils/flowtracer.h"
 
@@ -58,6 +59,7 @@ void Widget::on_load_clicked()
         ui_mode = LOCAL_MODE;      // 本地模式 -> 使用本地llama-server + xNet
         historypath = currentpath; // 记录这个路径
         ui_SETTINGS.modelpath = currentpath;
+        applyModelCatalogHints(currentpath);
         ui_SETTINGS.mmprojpath = ""; // 清空mmproj模型路径
         ui_SETTINGS.lorapath = "";   // 清空lora模型路径
         // 自动在同级目录搜索带有 mmproj 关键字的 gguf 视觉模型，存在则设置路径
@@ -284,6 +286,7 @@ void Widget::logFlow(FlowPhase phase, const QString &detail, SIGNAL_STATE state)
 {
     const QString line = QStringLiteral("[%1] %2").arg(flowPhaseName(phase), detail);
     FlowTracer::log(FlowChannel::Session, line, activeTurnId_);
+    if (stageProfiler_) stageProfiler_->mark(phase);
     Q_UNUSED(state);
 }
 
@@ -380,6 +383,17 @@ void Widget::logCurrentTask(ConversationTask task)
 
 
 
+void Widget::startAgentReplay(const QString &prompt, int toolCallMode)
+{
+    // 回放不经过真实后端：按链接模式跳过本地后端唤醒，并挂载工具链以解析录像里的工具调用
+    ui_mode = LINK_MODE;
+    ui_state = CHAT_STATE;
+    is_load_tool = true;
+    ui_tool_call_mode = toolCallMode;
+    if (ui && ui->input && ui->input->textEdit) ui->input->textEdit->setPlainText(prompt);
+    on_send_clicked();
+}
+
 void Widget::on_send_clicked()
 {
 	FlowTracer::log(FlowChannel::Session,
@@ -395,6 +409,11 @@ void Widget::on_send_clicked()
     }
     if (isControllerActive())
     {
+        if (controlClient_.observer)
+        {
+            reflash_state(jtr("control observer readonly"), WRONG_SIGNAL);
+            return;
+        }
         const QString text = ui && ui->input && ui->input->textEdit ? ui->input->textEdit->toPlainText() : QString();
         if (text.trimmed().isEmpty())
         {
@@ -153,6 +153,8 @@ void Widget::set_SetDialog()
     settings_ui->parallel_slider->setValue(ui_SETTINGS.hid_parallel);
     settings_ui->parallel_label->setText(jtr("parallel") + " " + QString::number(settings_ui->parallel_slider->value()));
     connect(settings_ui->parallel_slider, &QSlider::valueChanged, this, &Widget::parallel_change);
+    // KV 缓存类型 / 缓存复用 / 上下文平移（llama-server -ctk/-ctv、--cache-reuse、--context-shift）
+    syncKvCacheControls();
     // load lora
     settings_ui->lora_LineEdit->setContextMenuPolicy(Qt::NoContextMenu); // 取消右键菜单
     settings_ui->lora_LineEdit->installEventFilter(this);
@@ -271,6 +273,38 @@ void Widget::rebuildReasoningCombo()
     settings_ui->reasoning_comboBox->setToolTip(jtr("reasoning effort note"));
 }
 
+void Widget::syncKvCacheControls()
+{
+    if (!settings_ui) return;
+    if (settings_ui->kv_cache_comboBox)
+    {
+        QSignalBlocker blocker(settings_ui->kv_cache_comboBox);
+        settings_ui->kv_cache_comboBox->clear();
+        for (const QString &type : KV_CACHE_TYPES) settings_ui->kv_cache_comboBox->addItem(type, type);
+        // 配置文件里手工填写的其它类型（如 q5_1）也照常显示
+        const QString current = ui_SETTINGS.hid_cache_type_k.trimmed().toLower();
+        int idx = settings_ui->kv_cache_comboBox->findData(current);
+        if (idx < 0 && !current.isEmpty())
+        {
+            settings_ui->kv_cache_comboBox->addItem(current, current);
+            idx = settings_ui->kv_cache_comboBox->count() - 1;
+        }
+        settings_ui->kv_cache_comboBox->setCurrentIndex(qMax(0, idx));
+        // 量化 KV 依赖 flash attention（hid_flash_attn），关闭时后端只用 f16
+        settings_ui->kv_cache_comboBox->setEnabled(ui_SETTINGS.hid_flash_attn);
+    }
+    if (settings_ui->cache_reuse_spin)
+    {
+        QSignalBlocker blocker(settings_ui->cache_reuse_spin);
+        settings_ui->cache_reuse_spin->setValue(qBound(0, ui_SETTINGS.hid_cache_reuse, settings_ui->cache_reuse_spin->maximum()));
+    }
+    if (settings_ui->context_shift_checkbox)
+    {
+        QSignalBlocker blocker(settings_ui->context_shift_checkbox);
+        settings_ui->context_shift_checkbox->setChecked(ui_SETTINGS.hid_context_shift);
+    }
+}
+
 void Widget::setupGlobalSettingsPanel()
 {
     if (!settings_ui || !settings_dialog) return;
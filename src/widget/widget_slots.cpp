@@ -77,11 +77,22 @@ void Widget::recv_predecode(QString bot_predecode_content_)
 // 接收 whisper 解码完成的结果
 void Widget::recv_speechdecode_over(QString result)
 {
+    speechPartialText_.clear();
     ui_state_normal();
     ui->input->textEdit->append(result);
     // ui->send->click();//尝试一次发送
 }
 
+// 流式转写的实时结果：只在录音/收尾期间显示在输入区占位文本中
+void Widget::recv_speechdecode_partial(QString text)
+{
+    speechPartialText_ = text;
+    if (is_recodering)
+        ui_state_recoding();
+    else if (!text.isEmpty())
+        ui->input->textEdit->setPlaceholderText(text);
+}
+
 // 接收模型路径
 void Widget::recv_whisper_modelpath(QString modelpath)
 {
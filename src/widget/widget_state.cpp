@@ -236,7 +236,9 @@ void Widget::ui_state_recoding()
     }
     else
     {
-        ui->input->textEdit->setPlaceholderText(jtr("recoding") + "... " + QString::number(float(audio_time) / 1000.0, 'f', 2) + "s " + jtr("push f2 to stop"));
+        QString hint = jtr("recoding") + "... " + QString::number(float(audio_time) / 1000.0, 'f', 2) + "s " + jtr("push f2 to stop");
+        if (!speechPartialText_.isEmpty()) hint += QStringLiteral("\n") + speechPartialText_;
+        ui->input->textEdit->setPlaceholderText(hint);
     }
     if (isHostControlled()) broadcastControlUiPhase(QStringLiteral("recording"));
 }
@@ -71,6 +71,9 @@ void Widget::normal_finish_pushover()
     }
     // 推理完成后尝试派发定时任务
     tryDispatchScheduledJobs();
+    logFlow(FlowPhase::Finish, QStringLiteral("reply finished"), SIGNAL_SIGNAL);
+    // 回合结束：提交并 fsync 本轮历史（在写入线程上完成，UI 线程不等待）
+    if (history_) history_->flushAsync(true);
 }
 
 void Widget::recv_toolpushover(QString tool_result_)
@@ -266,6 +269,11 @@ void Widget::on_reset_clicked()
     }
     if (isControllerActive())
     {
+        if (controlClient_.observer)
+        {
+            reflash_state(jtr("control observer readonly"), WRONG_SIGNAL);
+            return;
+        }
         if (controlChannel_)
         {
             QJsonObject cmd;
@@ -45,6 +45,10 @@ class QWidget;
 #define PROMPT_TOOL_HIGHLIGHT_MAX_CHARS 8000
 // 工作区快照缓存时间（ms）：避免重置时反复扫描目录导致卡顿
 #define WORKSPACE_SNAPSHOT_CACHE_MS 30000
+// 工作区索引：最多索引的目录数（同时也是 inotify 监视数上限），超出部分回退到直接读盘
+#define WORKSPACE_INDEX_MAX_DIRS 4000
+// 工作区索引：目录变化事件的去抖间隔（ms）
+#define WORKSPACE_INDEX_DEBOUNCE_MS 150
 
 //------------------------------------------------------------------------------
 // 多语言（界面语言）
@@ -148,6 +152,9 @@ inline QString evaLanguageCodeFromFlag(int flag)
 #define DEFAULT_USE_MMAP false   // 默认关闭内存映射
 #define DEFAULT_FLASH_ATTN true  // 默认开启注意力加速
 #define DEFAULT_USE_MLOCCK false // 默认关闭内存锁定
+#define DEFAULT_CACHE_TYPE "f16"   // 默认 KV 缓存类型（-ctk/-ctv）
+#define DEFAULT_CACHE_REUSE 0      // 默认不启用 --cache-reuse（提示词缓存按块复用的最小块长，单位 token）
+#define DEFAULT_CONTEXT_SHIFT false // 默认不启用 --context-shift（上下文满时丢弃旧 token 继续生成）
 
 // CUDA 后端版本约束：当前内置 CUDA 版 llama.cpp 仅支持 CUDA 12，
 // 因此后端路径解析时需要同时检查 CUDA 12 runtime 依赖。
@@ -197,6 +204,28 @@ inline const QStringList DEFAULT_CUDA_RUNTIME_LIB_PATTERNS = {};
 #define DEFAULT_NET_RETRY_MAX_RETRIES 1
 #define DEFAULT_NET_RETRY_BASE_BACKOFF_MS 400
 #define DEFAULT_NET_RETRY_MAX_BACKOFF_MS 2000
+// 后台流（隔离的定时任务等）：本地后端按 --parallel 的空闲 slot 并行；远端 API 没有 slot，只限制并发数
+#define DEFAULT_NET_REMOTE_BACKGROUND_STREAMS 2
+// 链接模式端点池：配置多个等价端点时按健康度排序、失败切换，并可在首包过慢时对冲到第二个端点
+// - cooldown：连续失败的端点暂时降级，窗口按失败次数指数增长
+// - hedge：首包等待超过该端点近期 TTFB 的分位数后，向下一个健康端点并发发起同样的请求，先到首包者胜出；
+//   对冲会让落败端点也处理（并可能计费）同一请求，默认关闭，需在配置中设置 api_hedge=true 开启
+#define DEFAULT_NET_POOL_COOLDOWN_MS 5000
+#define DEFAULT_NET_POOL_COOLDOWN_MAX_MS 60000
+#define DEFAULT_NET_POOL_TTFB_WINDOW 32
+#define DEFAULT_NET_HEDGE_ENABLED false
+#define DEFAULT_NET_HEDGE_PERCENTILE 90
+#define DEFAULT_NET_HEDGE_MIN_SAMPLES 5
+#define DEFAULT_NET_HEDGE_DEFAULT_DELAY_MS 3000
+#define DEFAULT_NET_HEDGE_MIN_DELAY_MS 300
+// --agent-replay：回放零延迟，超过该时长没有任何请求/工具调用且未收尾即视为卡死，报告卡住的回合后退出
+#define DEFAULT_AGENT_REPLAY_IDLE_TIMEOUT_MS 30000
+// eva-bench（无界面评估）：本地拉起 llama-server 的端口与层数、单请求超时、等待模型加载的上限
+#define DEFAULT_BENCH_SERVER_PORT "8180" // 避开界面默认的 8080，可与正在运行的机体并存
+#define DEFAULT_BENCH_NGL 99
+#define DEFAULT_BENCH_REQUEST_TIMEOUT_MS 300000
+#define DEFAULT_BENCH_HEALTH_TIMEOUT_MS 600000
+#define DEFAULT_BENCH_HEALTH_POLL_MS 500
 // GPU 状态检测：Windows AMD PowerShell 脚本超时（ms）
 // - 首次/强制刷新会调用 dxdiag 生成缓存，可能耗时较长
 // - 常规刷新仅读取缓存与性能计数器，耗时较短
@@ -213,7 +242,37 @@ inline const QStringList DEFAULT_CUDA_RUNTIME_LIB_PATTERNS = {};
 // 知识库嵌入服务上下文：按分块长度估算，避免使用 n_ctx_train 默认值导致显存膨胀
 #define DEFAULT_EMBEDDING_CTX_MIN 512
 #define DEFAULT_EMBEDDING_CTX_PADDING 64
+// 知识库切分：嵌入服务运行时通过其 /tokenize 端点按真实 token 数装箱
+#define DEFAULT_EMBEDDING_TOKENIZE_API "/tokenize"
+#define DEFAULT_EMBEDDING_TOKENIZE_TIMEOUT_MS 5000
+// 知识库检索：查询向量 LRU 缓存条数与单次查询嵌入超时
+#define DEFAULT_EMBEDDING_QUERY_CACHE_SIZE 256
+#define DEFAULT_EMBEDDING_QUERY_TIMEOUT_MS 30000
+// 知识库重排序（可选）：常驻 llama-server --reranking 加载交叉编码器，对余弦召回的候选段重新打分，
+// 只把最相关的结果个数送入提示词；服务不可用时回退到余弦排序
+#define DEFAULT_RERANK_PORT "7762"
+#define DEFAULT_RERANK_API "/v1/rerank"
+#define DEFAULT_RERANK_CANDIDATE_FACTOR 4 // 召回候选数 = 结果个数 × 该倍数
+#define DEFAULT_RERANK_CANDIDATE_MAX 40
+#define DEFAULT_RERANK_TIMEOUT_MS 20000
 #define DEFAULT_MAX_INPUT 80000 // 一次最大输入字符数
+// 历史记录后台写入：追加的消息最多攒这么久合并成一次提交；回合结束/退出时立即刷盘
+#define DEFAULT_HISTORY_FLUSH_MS 250
+// 发送前 token 预算：本地后端可用时经 /tokenize 按消息哈希缓存精确计数，否则按字符启发式估算
+#define DEFAULT_BUDGET_TOKENIZE_API "/tokenize"
+#define DEFAULT_BUDGET_TOKEN_CACHE 4096       // 缓存的消息计数条数
+#define DEFAULT_BUDGET_EXACT_MIN_CHARS 256    // 短文本直接估算，不值得一次请求
+#define DEFAULT_BUDGET_TOKENIZE_RETRY_MS 2000      // /tokenize 失败后的首次重试间隔，之后逐次翻倍
+#define DEFAULT_BUDGET_TOKENIZE_RETRY_MAX_MS 60000 // 重试间隔上限
+#define DEFAULT_BUDGET_MESSAGE_OVERHEAD 4     // 每条消息的模板标记开销
+#define DEFAULT_BUDGET_MEDIA_TOKENS 1024      // 每张图片/每段音频按固定开销计
+#define DEFAULT_BUDGET_OUTPUT_RESERVE 1024    // n_predict 未设置时为生成预留
+#define DEFAULT_BUDGET_TOOL_OUTPUT_MIN 512    // 工具输出截断后至少保留
+// monitor 本地等待模式（until=change/settle）：工具线程按 fps 连续截图，变化/稳定后才把截图交给模型
+#define DEFAULT_MONITOR_WATCH_FPS 4
+#define DEFAULT_MONITOR_WATCH_TIMEOUT_MS 15000
+#define DEFAULT_MONITOR_WATCH_MAX_MS 55000 // 需小于 monitor 工具超时（60s）
+#define DEFAULT_MONITOR_SETTLE_MS 1000
 
 // llama日志信号字样，用来指示下一步动作
 #define SERVER_START "server is listening on"              // server启动成功返回的字样
@@ -236,6 +295,32 @@ inline const QStringList DEFAULT_CUDA_RUNTIME_LIB_PATTERNS = {};
 // tts.cpp 音色枚举偶发失败时的自动重试策略
 #define DEFAULT_TTSCPP_VOICE_LIST_RETRY_COUNT 2
 #define DEFAULT_TTSCPP_VOICE_LIST_RETRY_DELAY_MS 800
+// tts.cpp 常驻服务（tts-server）：模型只加载一次，按段落经本地 HTTP 合成；
+// 找不到 tts-server 或启动失败时自动回退到逐段启动 tts-cli。
+#define DEFAULT_TTS_RESIDENT_ENABLE true
+#define DEFAULT_TTS_SERVER_PORT "7759"
+#define DEFAULT_TTS_SERVER_API "/v1/audio/speech"
+// 常驻段落切分：模型已常驻时更细的句级切分能更早出声（仅对超过该长度的段落生效）
+#define DEFAULT_TTS_RESIDENT_SENTENCE_SPLIT 120
+// 常驻辅助服务（tts/whisper/sd）：空闲多久后自动退出以释放内存/显存，以及启动就绪超时
+#define DEFAULT_RESIDENT_WORKER_IDLE_MS 600000
+#define DEFAULT_RESIDENT_WORKER_READY_TIMEOUT_MS 120000
+// whisper 常驻服务（whisper-server）与流式转写：录音期间按步长把当前窗口送去识别并实时回显；
+// 找不到 whisper-server 或启动失败时回退到录音结束后整段调用 whisper-cli。
+#define DEFAULT_WHISPER_RESIDENT_ENABLE true
+#define DEFAULT_WHISPER_SERVER_PORT "7760"
+#define DEFAULT_WHISPER_SERVER_API "/inference"
+#define DEFAULT_WHISPER_SAMPLE_RATE 16000
+// 每累计多少毫秒的新音频发起一次部分识别
+#define DEFAULT_WHISPER_STREAM_STEP_MS 1000
+// 窗口超过该时长后把已识别文本定稿、窗口从当前位置重新开始，保证松开 F2 后只需识别一小段尾巴
+#define DEFAULT_WHISPER_STREAM_WINDOW_MS 12000
+// 文生图常驻服务（sd-server）：按当前预设加载一次模型，绘制任务排队执行；图生图/视频/ControlNet 仍走 sd CLI
+#define DEFAULT_SD_RESIDENT_ENABLE true
+#define DEFAULT_SD_SERVER_PORT "7761"
+#define DEFAULT_SD_SERVER_API "/sdapi/v1/txt2img"
+// 单次 stablediffusion 工具调用最多生成的图片数（count 参数上限）
+#define DEFAULT_SD_TOOL_MAX_IMAGES 8
 
 //------------------------------------------------------------------------------
 // EVA_TEMP：机体临时/持久化目录
@@ -466,8 +551,27 @@ struct SETTINGS
     bool hid_use_mlock = DEFAULT_USE_MLOCCK;  // use mlock to keep model in memory
     bool hid_flash_attn = DEFAULT_FLASH_ATTN; // flash attention
     int hid_parallel = DEFAULT_PARALLEL;
+    QString hid_cache_type_k = DEFAULT_CACHE_TYPE;   // KV 缓存 K 类型
+    QString hid_cache_type_v = DEFAULT_CACHE_TYPE;   // KV 缓存 V 类型
+    int hid_cache_reuse = DEFAULT_CACHE_REUSE;       // --cache-reuse 块长，0 为关闭
+    bool hid_context_shift = DEFAULT_CONTEXT_SHIFT;  // --context-shift
 };
 
+// 设置窗口可选的 KV 缓存类型：量化后 KV 占用约为 f16 的 53%（q8_0）/ 28%（q4_0）
+inline const QStringList KV_CACHE_TYPES = {QStringLiteral("f16"), QStringLiteral("q8_0"), QStringLiteral("q4_0")};
+
+// 实际传给 llama-server 的 KV 缓存类型：量化 KV 依赖 flash attention，关闭时退回 f16；无法识别的类型同样退回 f16
+inline QString effectiveKvCacheType(const QString &type, bool flashAttn)
+{
+    static const QStringList plain = {QStringLiteral("f32"), QStringLiteral("f16"), QStringLiteral("bf16")};
+    static const QStringList quantized = {QStringLiteral("q8_0"), QStringLiteral("q5_1"), QStringLiteral("q5_0"),
+                                          QStringLiteral("q4_1"), QStringLiteral("q4_0"), QStringLiteral("iq4_nl")};
+    const QString normalized = type.trimmed().toLower();
+    if (plain.contains(normalized)) return normalized;
+    if (flashAttn && quantized.contains(normalized)) return normalized;
+    return QStringLiteral(DEFAULT_CACHE_TYPE);
+}
+
 // 上下文压缩配置：用于自动压缩、摘要生成与输入裁剪
 struct COMPACTION_SETTINGS
 {
@@ -511,6 +615,8 @@ struct APIS
     QString api_completion_endpoint = COMPLETION_ENDPOINT;
     bool is_cache = true;
     bool is_local_backend = false;
+    QStringList api_endpoint_pool;            // 链接模式：与 api_endpoint 等价的备用端点（共用密钥与模型）
+    bool api_hedge = DEFAULT_NET_HEDGE_ENABLED; // 端点池内首包过慢时是否对冲
 };
 
 // 端点接收参数
@@ -267,17 +267,27 @@ void xNet::resetState()
     tokens_ = 0;
     thinkFlag = false;
     current_content.clear();
+    t_first_.invalidate();
+    reasoningTokensTurn_ = 0;
+    extThinkActive_ = false;
+    sawToolStopword_ = false;
+    toolCallsAcc_.clear();
+    toolCallsEmitted_ = false;
+    resumePrefix_.clear();
+    resumeBlocked_ = false;
+    resuming_ = false;
+    streamSlotId_ = -1;
+    resetTransferState();
+}
+
+// 单次请求的传输状态；续写沿用本轮的思考状态、token 计数与前缀，只重置这一部分
+void xNet::resetTransferState()
+{
     sseBuffer_.clear();
     firstByteSeen_ = false;
-    t_first_.invalidate();
     aborted_ = false;
     abortReason_ = AbortReason::None;
     speedsEmitted_ = false;
-    reasoningTokensTurn_ = 0;
-    extThinkActive_ = false;
-    sawToolStopword_ = false;
-    toolCallsAcc_.clear();
-    toolCallsEmitted_ = false;
     // reset timing stats
     promptTokens_ = -1;
     promptMs_ = 0.0;
@@ -302,7 +312,16 @@ void xNet::abortActiveReply(AbortReason reason)
         {
             aborted_ = true;
         }
+        detachReply();
+        running_ = false;
+        emit net2ui_pushover();
+    }
+}
 
+void xNet::detachReply()
+{
+    if (reply_)
+    {
         // disconnect all our slots from this reply first to prevent late callbacks
         QObject::disconnect(connReadyRead_);
         QObject::disconnect(connFinished_);
@@ -324,11 +343,85 @@ void xNet::abortActiveReply(AbortReason reason)
         reply_->abort();
         reply_->deleteLater();
         reply_ = nullptr;
-        running_ = false;
-        emit net2ui_pushover();
     }
 }
 
+bool xNet::canResumeStream() const
+{
+    // 结构化工具调用的参数分片无法作为前缀续写；独立推理字段续写后会丢失思考内容
+    if (resumeBlocked_ || !toolCallsAcc_.isEmpty()) return false;
+    // 补完模式直接把前缀拼进 prompt；chat 模式依赖 llama-server 把末尾 assistant 消息当作预填充，
+    // 远端接口不保证支持，已有输出时续写会变成重新回答
+    if (!endpoint_data.is_complete_state && !apis.is_local_backend && !resumePrefix_.isEmpty()) return false;
+    return true;
+}
+
+bool xNet::tryResumeStream(bool canceled, QNetworkReply::NetworkError error, int httpCode)
+{
+    if (!shouldResumeNetStream(canceled,
+                               firstByteSeen_,
+                               canResumeStream(),
+                               error,
+                               httpCode,
+                               retryAttempt_,
+                               DEFAULT_NET_RETRY_MAX_RETRIES))
+        return false;
+    emitFlowLog(QStringLiteral("net: stream cut prefix=%1 chars tokens=%2 slot=%3")
+                    .arg(resumePrefix_.size())
+                    .arg(tokens_)
+                    .arg(streamSlotId_),
+                SIGNAL_SIGNAL);
+    scheduleRetry(true, error, httpCode);
+    return true;
+}
+
+void xNet::scheduleRetry(bool resume, QNetworkReply::NetworkError error, int httpCode)
+{
+    const int delayMs = nextRetryBackoffMs(retryAttempt_,
+                                           DEFAULT_NET_RETRY_BASE_BACKOFF_MS,
+                                           DEFAULT_NET_RETRY_MAX_BACKOFF_MS);
+    const int currentRetry = retryAttempt_ + 1;
+    retryAttempt_ = currentRetry;
+    retrying_ = true;
+    // 续写请求在首包前再次失败时走普通重试，仍然保持续写
+    if (resume) resuming_ = true;
+
+    emitFlowLog(QStringLiteral("net: %1 scheduled %2/%3 delay=%4ms http=%5 err=%6")
+                    .arg(resume ? QStringLiteral("resume") : QStringLiteral("retry"))
+                    .arg(currentRetry)
+                    .arg(DEFAULT_NET_RETRY_MAX_RETRIES)
+                    .arg(delayMs)
+                    .arg(httpCode)
+                    .arg(int(error)),
+                SIGNAL_SIGNAL);
+    emit net2ui_state(QStringLiteral("net: %1 %2/%3 in %4ms")
+                          .arg(resume ? QStringLiteral("resuming") : QStringLiteral("retrying"))
+                          .arg(currentRetry)
+                          .arg(DEFAULT_NET_RETRY_MAX_RETRIES)
+                          .arg(delayMs),
+                      SIGNAL_SIGNAL);
+
+    if (timeoutTimer_) timeoutTimer_->stop();
+    detachReply();
+    running_ = false;
+    aborted_ = false;
+    abortReason_ = AbortReason::None;
+
+    QTimer::singleShot(delayMs, this, [this]()
+                       {
+        if (!retrying_) return;
+        if (is_stop)
+        {
+            retrying_ = false;
+            retryAttempt_ = 0;
+            resuming_ = false;
+            running_ = false;
+            emit net2ui_pushover();
+            return;
+        }
+        run(); });
+}
+
 void xNet::emitSpeedsIfAvailable(bool allowFallback)
 {
     // 统一封装速度上报：优先使用服务器 timings，缺失时可在工具中断场景下回退为本地估算
@@ -400,7 +493,10 @@ void xNet::run()
     if (!retrying_) retryAttempt_ = 0;
     running_ = true;
     turn_id_ = endpoint_data.turn_id;
-    resetState();
+    if (resuming_)
+        resetTransferState();
+    else
+        resetState();
     // Clear any stale stop flag from previous aborted turn
     is_stop = false;
     ensureNetObjects();
@@ -426,6 +522,13 @@ void xNet::run()
                         .arg(DEFAULT_NET_RETRY_MAX_RETRIES),
                     SIGNAL_SIGNAL);
     }
+    if (resuming_)
+    {
+        emitFlowLog(QStringLiteral("net:req resume prefix=%1 chars slot=%2")
+                        .arg(resumePrefix_.size())
+                        .arg(streamSlotId_),
+                    SIGNAL_SIGNAL);
+    }
 
     // Fire asynchronous request
     reply_ = nam_->post(request, body);
@@ -447,9 +550,14 @@ void xNet::run()
         if (timeoutTimer_) timeoutTimer_->start(DEFAULT_NET_IDLE_TIMEOUT_MS);
         if (!firstByteSeen_)
         {
+            // HTTP 错误响应的正文不算首包：留给 finished 提取错误信息，并按首包前失败处理（重试/切换端点）
+            const QVariant codeVar = reply_->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+            if (codeVar.isValid() && codeVar.toInt() >= 400) return;
             firstByteSeen_ = true;
-            t_first_.start();
-            emitFlowLog("net:stream begin", SIGNAL_SIGNAL);
+            if (!t_first_.isValid()) t_first_.start(); // 续写沿用首个请求的首包时间
+            emitFlowLog(resuming_ ? "net:stream resumed" : "net:stream begin", SIGNAL_SIGNAL);
+            emit net2ui_first_byte();
+            if (aborted_ || !reply_) return; // 对冲落败时接收方会立即中止本请求
         }
 
         QByteArray chunk = reply_->readAll();
@@ -522,49 +630,11 @@ void xNet::run()
                                   retryAttempt_,
                                   DEFAULT_NET_RETRY_MAX_RETRIES))
         {
-            const int delayMs = nextRetryBackoffMs(retryAttempt_,
-                                                   DEFAULT_NET_RETRY_BASE_BACKOFF_MS,
-                                                   DEFAULT_NET_RETRY_MAX_BACKOFF_MS);
-            const int currentRetry = retryAttempt_ + 1;
-            retryAttempt_ = currentRetry;
-            retrying_ = true;
-
-            emitFlowLog(QStringLiteral("net: retry scheduled %1/%2 delay=%3ms http=%4 err=%5")
-                            .arg(currentRetry)
-                            .arg(DEFAULT_NET_RETRY_MAX_RETRIES)
-                            .arg(delayMs)
-                            .arg(httpCode)
-                            .arg(int(err)),
-                        SIGNAL_SIGNAL);
-            emit net2ui_state(QStringLiteral("net: retrying %1/%2 in %3ms")
-                                  .arg(currentRetry)
-                                  .arg(DEFAULT_NET_RETRY_MAX_RETRIES)
-                                  .arg(delayMs),
-                              SIGNAL_SIGNAL);
-
-            if (reply_)
-            {
-                reply_->deleteLater();
-                reply_ = nullptr;
-            }
-            running_ = false;
-            aborted_ = false;
-            abortReason_ = AbortReason::None;
-
-            QTimer::singleShot(delayMs, this, [this]()
-                               {
-                if (!retrying_) return;
-                if (is_stop)
-                {
-                    retrying_ = false;
-                    retryAttempt_ = 0;
-                    running_ = false;
-                    emit net2ui_pushover();
-                    return;
-                }
-                run(); });
+            scheduleRetry(false, err, httpCode);
             return;
         }
+        // 首包之后断流：带着已输出的前缀续写，计入同一重试预算
+        if (tryResumeStream(canceled, err, httpCode)) return;
 
         if (!canceled)
         {
@@ -669,6 +739,7 @@ void xNet::run()
 
         retrying_ = false;
         retryAttempt_ = 0;
+        resuming_ = false;
         abortReason_ = AbortReason::None;
         running_ = false;
         if (!canceled)
@@ -715,6 +786,8 @@ void xNet::ensureNetObjects()
         connect(timeoutTimer_, &QTimer::timeout, this, [this]()
                 {
             emitFlowLog("net: timeout", WRONG_SIGNAL);
+            // 首包之后卡住：带着已输出的前缀续写，而不是整轮失败
+            if (tryResumeStream(false, QNetworkReply::TimeoutError, 0)) return;
             emit net2ui_state(netTimeoutStateLine(), WRONG_SIGNAL);
             abortActiveReply(AbortReason::Timeout); });
     }
@@ -751,7 +824,9 @@ QByteArray xNet::createChatBody()
         streamOptions.insert(QStringLiteral("include_usage"), true);
         json.insert(QStringLiteral("stream_options"), streamOptions);
     }
-    const int requestedPredict = endpoint_data.n_predict;
+    int requestedPredict = endpoint_data.n_predict;
+    // 续写时扣除已生成的部分，整轮输出仍受用户设定的上限约束
+    if (resuming_ && requestedPredict > 0) requestedPredict = qMax(1, requestedPredict - tokens_);
     const bool hasManualPredict = (requestedPredict > 0);
     if (hasManualPredict)
     {
@@ -856,9 +931,18 @@ QByteArray xNet::createChatBody()
         }
         finalMessages = compatMsgs;
     }
-    json.insert(QStringLiteral("messages"), finalMessages);
-    // Reuse llama.cpp server slot KV cache if available
-    if (isLocal && endpoint_data.id_slot >= 0) { json.insert("id_slot", endpoint_data.id_slot); }
+    if (resuming_ && !resumePrefix_.isEmpty())
+    {
+        // 续写：llama-server 把末尾的 assistant 消息当作预填充，模型从断点接着生成
+        QJsonObject partial;
+        partial.insert(QStringLiteral("role"), QStringLiteral("assistant"));
+        partial.insert(QStringLiteral("content"), resumePrefix_);
+        finalMessages.append(partial);
+    }
+    json.insert(QStringLiteral("messages"), finalMessages);
+    // Reuse llama.cpp server slot KV cache if available; 续写固定到断流前的 slot，前缀直接命中缓存
+    const int slot = (resuming_ && streamSlotId_ >= 0) ? streamSlotId_ : endpoint_data.id_slot;
+    if (isLocal && slot >= 0) { json.insert("id_slot", slot); }
     maybeAttachReasoningPayload(json, endpoint_data.reasoning_effort, isLocal);
 
     // debug summary: role and content kind/length
@@ -893,8 +977,9 @@ QByteArray xNet::createCompleteBody()
         json.insert("cache_prompt", apis.is_cache);
     } // 缓存上文
     json.insert("model", apis.api_model);
-    json.insert("prompt", endpoint_data.input_prompt);
-    const int requestedPredict2 = endpoint_data.n_predict;
+    json.insert("prompt", resuming_ ? endpoint_data.input_prompt + resumePrefix_ : endpoint_data.input_prompt);
+    int requestedPredict2 = endpoint_data.n_predict;
+    if (resuming_ && requestedPredict2 > 0) requestedPredict2 = qMax(1, requestedPredict2 - tokens_);
     const bool hasManualPredict2 = (requestedPredict2 > 0);
     if (hasManualPredict2)
     {
@@ -938,7 +1023,8 @@ QByteArray xNet::createCompleteBody()
         json.insert("top_k", endpoint_data.top_k);
         json.insert("repeat_penalty", endpoint_data.repeat);
     }
-    if (isLocal && endpoint_data.id_slot >= 0) { json.insert("id_slot", endpoint_data.id_slot); }
+    const int slot = (resuming_ && streamSlotId_ >= 0) ? streamSlotId_ : endpoint_data.id_slot;
+    if (isLocal && slot >= 0) { json.insert("id_slot", slot); }
     maybeAttachReasoningPayload(json, endpoint_data.reasoning_effort, isLocal);
 
     // 将 JSON 对象转换为字节序列
@@ -1045,7 +1131,11 @@ void xNet::processSsePayload(bool isChat, const QByteArray &payload)
         if (obj.contains("slot_id"))
         {
             const int sid = obj.value("slot_id").toInt(-1);
-            if (sid >= 0) emit net2ui_slot_id(sid);
+            if (sid >= 0)
+            {
+                streamSlotId_ = sid;
+                emit net2ui_slot_id(sid);
+            }
         }
         // OpenAI chat format
         if (isChat)
@@ -1077,6 +1167,7 @@ void xNet::processSsePayload(bool isChat, const QByteArray &payload)
 
                 if (!reasoning.isEmpty())
                 {
+                    resumeBlocked_ = true;
                     // Open synthetic think block at first reasoning token
                     if (!extThinkActive_)
                     {
@@ -1095,6 +1186,7 @@ void xNet::processSsePayload(bool isChat, const QByteArray &payload)
 
                 // 2) Normal assistant content
                 current_content = delta.value("content").toString();
+                resumePrefix_ += current_content; // 原始正文，断流续写时作为 assistant 前缀
                 // qDebug() << current_content;
                 // If reasoning section is open and normal content arrives, close think.
                 if (extThinkActive_ && !current_content.isEmpty())
@@ -1161,6 +1253,7 @@ void xNet::processSsePayload(bool isChat, const QByteArray &payload)
 
             if (!content.isEmpty())
             {
+                resumePrefix_ += content;
                 tokens_++;
                 // notify UI of streamed token for fallback memory/speed in LINK mode
                 emit net2ui_kv_tokens(tokens_);
@@ -1336,6 +1429,7 @@ void xNet::recv_stop(bool stop)
         const bool pendingRetryOnly = retrying_ && !reply_;
         retrying_ = false;
         retryAttempt_ = 0;
+        resuming_ = false;
         if (pendingRetryOnly)
         {
             running_ = false;
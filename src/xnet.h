@@ -71,6 +71,7 @@ class xNet : public QObject
     // Final per-turn speeds from llama.cpp server timings (tokens/second)
     // prompt_per_second = 上文处理速度; predicted_per_second = 文字生成速度
     void net2ui_speeds(double prompt_per_second, double predicted_per_second);
+    void net2ui_first_byte(); // 本次请求收到首包（续写请求也会再发一次）
     void net2ui_turn_counters(int cacheTokens, int promptTokens, int predictedTokens);
 
   private:
@@ -119,6 +120,11 @@ class xNet : public QObject
     AbortReason abortReason_ = AbortReason::None;
     int retryAttempt_ = 0; // 当前请求已执行的重试次数（不含首次请求）
     bool retrying_ = false;
+    // 中途断流续写：把本轮已收到的正文作为前缀重新请求，固定到同一 slot 时 KV 缓存命中，只需补算极少的 token
+    QString resumePrefix_;       // 本轮已流式输出的原始正文（不含合成的思考标记）
+    bool resumeBlocked_ = false; // 出现了独立推理字段，前缀无法原样续写
+    bool resuming_ = false;      // 下一次 run() 是续写请求
+    int streamSlotId_ = -1;      // 服务端为本轮分配的 slot
     // 工具调用停符处理：命中 </tool_call> 后标记并立刻终止当前流，避免模型继续输出干扰工具判定
     bool sawToolStopword_ = false; // 本轮是否已命中工具停符，防止重复中止
     int cacheTokens_ = -1;
@@ -136,7 +142,12 @@ class xNet : public QObject
 #endif
 
     void resetState();
+    void resetTransferState();
+    void detachReply();
     void abortActiveReply(AbortReason reason = AbortReason::Other);
+    bool canResumeStream() const;
+    bool tryResumeStream(bool canceled, QNetworkReply::NetworkError error, int httpCode);
+    void scheduleRetry(bool resume, QNetworkReply::NetworkError error, int httpCode);
     QNetworkRequest buildRequest(const QUrl &url) const;
     void ensureNetObjects();
     void logRequestPayload(const char *modeTag, const QByteArray &body);
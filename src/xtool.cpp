@@ -1,9 +1,15 @@
 #include "xtool.h"
 
+#include "service/net/embedding_client.h"
+#include "service/tools/content_search.h"
+#include "service/tools/line_index.h"
 #include "service/tools/tool_registry.h"
+#include "service/tools/workspace_index.h"
 #include "utils/eva_error.h"
+#include "utils/frame_change_detector.h"
 #include "utils/perf_metrics.h"
 #include "utils/processrunner.h"
+#include "utils/screen_capture.h"
 #include "utils/flowtracer.h"
 
 #include <QDirIterator>
@@ -11,6 +17,7 @@
 #include <QHash>
 #include <QPair>
 #include <QRegularExpression>
+#include <QStandardPaths>
 #include <QtConcurrent/QtConcurrentRun>
 #include <algorithm>
 #include <limits>
@@ -35,6 +42,18 @@ QString clampToolMessage(const QString &message)
     return head + "\n...\n" + tail + QString("\n[tool output truncated: %1 KB total, showing first %2 KB and last %3 KB]").arg(totalKb, 0, 'f', 1).arg(headKb, 0, 'f', 1).arg(tailKb, 0, 'f', 1);
 }
 
+// 路径不存在时借助工作区索引给出候选路径，减少模型反复 list_files 试探
+QString workspacePathHint(const QString &root, const QString &requested)
+{
+    WorkspaceIndex *index = WorkspaceIndex::shared();
+    if (!index) return QString();
+    index->setRoot(root);
+    if (!index->covers(root)) return QString();
+    const QStringList candidates = index->completePath(requested, 5);
+    if (candidates.isEmpty()) return QString();
+    return QStringLiteral("\nDid you mean: %1").arg(candidates.join(QStringLiteral(", ")));
+}
+
 struct MatchRange
 {
     int start = -1;
@@ -1343,6 +1362,114 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
             return tlsCurrentInvocation_ && tlsCurrentInvocation_->cancelled.load(std::memory_order_acquire);
         };
 
+        // 用归一化尺寸给模型一个稳定锚点（与 controller 保持一致），方便它在 monitor->controller 切换时不混淆坐标空间。
+        const int normMaxX = std::max(1, controllerNormX_.load(std::memory_order_acquire));
+        const int normMaxY = std::max(1, controllerNormY_.load(std::memory_order_acquire));
+
+        // 本地等待模式：until=change/settle 时在工具线程连续截图，画面变化/稳定（或超时）后才返回，
+        // 省去“等一会儿 -> 截图给模型 -> 再调用 monitor”的多轮多模态往返
+        const QString until = QString::fromStdString(get_string_safely(tools_args_, "until")).trimmed().toLower();
+        if (until == QStringLiteral("change") || until == QStringLiteral("settle"))
+        {
+            FrameChangeDetector::Options options;
+            options.mode = until == QStringLiteral("change") ? FrameChangeDetector::Mode::Change : FrameChangeDetector::Mode::Settle;
+            options.settleMs = std::clamp(get_int_safely(tools_args_, "settle_ms", DEFAULT_MONITOR_SETTLE_MS), 200, 10000);
+            const int timeoutMs = std::clamp(get_int_safely(tools_args_, "timeout_ms", DEFAULT_MONITOR_WATCH_TIMEOUT_MS), 1000, DEFAULT_MONITOR_WATCH_MAX_MS);
+            const int fps = std::clamp(get_int_safely(tools_args_, "fps", DEFAULT_MONITOR_WATCH_FPS), 1, 10);
+            QString regionText = QStringLiteral("full");
+            if (tools_args_.contains("bbox") && tools_args_["bbox"].is_array() && tools_args_["bbox"].size() == 4)
+            {
+                // bbox 与 controller 一致：归一化截图上的像素坐标 [x1,y1,x2,y2]
+                double v[4] = {0, 0, 0, 0};
+                bool ok = true;
+                for (int i = 0; i < 4; ++i)
+                {
+                    const auto &item = tools_args_["bbox"][static_cast<size_t>(i)];
+                    if (!item.is_number())
+                    {
+                        ok = false;
+                        break;
+                    }
+                    v[i] = item.get<double>();
+                }
+                const QRectF region = QRectF(QPointF(v[0] / normMaxX, v[1] / normMaxY), QPointF(v[2] / normMaxX, v[3] / normMaxY)).normalized();
+                if (ok && region.width() > 0 && region.height() > 0)
+                {
+                    options.region = region;
+                    regionText = QStringLiteral("[%1,%2,%3,%4]").arg(v[0]).arg(v[1]).arg(v[2]).arg(v[3]);
+                }
+            }
+
+            sendStateMessage(QStringLiteral("tool:monitor(until=%1, timeout_ms=%2, fps=%3, region=%4)").arg(until).arg(timeoutMs).arg(fps).arg(regionText));
+            // 不显示倒计时叠加层：它本身会让画面不断变化
+
+            FrameChangeDetector detector(options);
+            FrameChangeDetector::Verdict verdict = FrameChangeDetector::Verdict::Pending;
+            QString captureError;
+            QElapsedTimer clock;
+            clock.start();
+            const int intervalMs = 1000 / fps;
+            while (!cancelled())
+            {
+                const qint64 frameStart = clock.elapsed();
+                int width = 0;
+                int height = 0;
+                const QImage frame = ScreenCapture::capturePrimary(&width, &height, &captureError);
+                if (frame.isNull()) break;
+                verdict = detector.feed(frame, clock.elapsed());
+                if (verdict != FrameChangeDetector::Verdict::Pending || clock.elapsed() >= timeoutMs) break;
+                int remaining = int(std::max<qint64>(0, intervalMs - (clock.elapsed() - frameStart)));
+                while (remaining > 0 && !cancelled())
+                {
+                    const int chunk = std::min(50, remaining);
+                    msleep(static_cast<unsigned long>(chunk));
+                    remaining -= chunk;
+                }
+            }
+            if (cancelled()) return;
+
+            const bool captureFailed = detector.frames() == 0;
+            QString outcome = QStringLiteral("timeout");
+            if (captureFailed)
+                outcome = QStringLiteral("capture_failed");
+            else if (verdict == FrameChangeDetector::Verdict::Changed)
+                outcome = QStringLiteral("changed");
+            else if (verdict == FrameChangeDetector::Verdict::Settled)
+                outcome = QStringLiteral("settled");
+            FlowTracer::log(FlowChannel::Tool,
+                            QStringLiteral("tool:monitor until=%1 result=%2 frames=%3 elapsed=%4ms")
+                                .arg(until, outcome)
+                                .arg(detector.frames())
+                                .arg(clock.elapsed()),
+                            tlsCurrentInvocation_ ? tlsCurrentInvocation_->turnId : 0);
+
+            QString next = QStringLiteral("Check the screenshot; if the target state is reached, call controller.");
+            if (outcome == QStringLiteral("timeout"))
+                next = QStringLiteral("No %1 within timeout. Check the screenshot; wait again with a longer timeout_ms only if the task still needs it.")
+                           .arg(options.mode == FrameChangeDetector::Mode::Change ? QStringLiteral("change") : QStringLiteral("settle"));
+            else if (captureFailed)
+                next = QStringLiteral("Local capture is unavailable (%1); use monitor with wait_ms instead.").arg(captureError);
+            const QString detail = QStringLiteral(
+                                       "ok\n"
+                                       "until=%1\n"
+                                       "result=%2\n"
+                                       "elapsed_ms=%3\n"
+                                       "frames=%4\n"
+                                       "changed_tiles=%5/%6\n"
+                                       "screenshot=attached (normalized %7x%8)\n"
+                                       "next=%9")
+                                       .arg(until, outcome)
+                                       .arg(clock.elapsed())
+                                       .arg(detector.frames())
+                                       .arg(detector.changedSinceFirst())
+                                       .arg(detector.tileCount())
+                                       .arg(normMaxX)
+                                       .arg(normMaxY)
+                                       .arg(next);
+            sendPushMessage(QStringLiteral("monitor ") + jtr("return") + "\n" + detail);
+            return;
+        }
+
         int waitMs = get_int_safely(tools_args_, "wait_ms", -1);
         if (waitMs < 0)
         {
@@ -1368,15 +1495,11 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
         emit tool2ui_monitor_countdown_done();
         if (cancelled()) return;
 
-        // 用归一化尺寸给模型一个稳定锚点（与 controller 保持一致），方便它在 monitor->controller 切换时不混淆坐标空间。
-        const int normMaxX = std::max(1, controllerNormX_.load(std::memory_order_acquire));
-        const int normMaxY = std::max(1, controllerNormY_.load(std::memory_order_acquire));
-
         const QString detail = QStringLiteral(
                                    "ok\n"
                                    "wait_ms=%1\n"
                                    "screenshot=attached (normalized %2x%3)\n"
-                                   "next=If the target state is NOT reached, call monitor again; if reached, call controller.")
+                                   "next=If the target state is NOT reached, call monitor again (or wait locally with until=change/settle); if reached, call controller.")
                                    .arg(waitMs)
                                    .arg(normMaxX)
                                    .arg(normMaxY);
@@ -1408,25 +1531,18 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
         QStringList outputs;
         outputs.reserve(specs.size());
 
-        auto readFileContent = [&](const ToolPathResolution &pathRes, QString &content, QString &error) -> bool {
+        // 只读取请求的行：宿主机走行偏移索引（按 大小+修改时间 缓存），容器内用 sed 读到区间末尾即退出，
+        // 读取大文件的小窗口时开销与窗口大小成正比，而不是整个文件
+        auto readRange = [&](const ToolPathResolution &pathRes, int start, int end, LineIndexCache::Window &window, QString &error) -> bool {
+            window = LineIndexCache::Window();
+            window.firstLine = start;
             if (useDocker)
             {
                 const bool pathIsContainer = pathRes.containerAbsolute;
                 const QString dockerPath = pathIsContainer ? pathRes.containerPath : pathRes.hostPath;
-                if (!dockerReadTextFile(dockerPath, &content, &error, pathIsContainer)) return false;
-                return true;
-            }
-            QFile file(pathRes.hostPath);
-            if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-            {
-                error = QStringLiteral("cannot open file: %1").arg(pathRes.hostPath);
-                return false;
+                return dockerReadLines(dockerPath, start, end, &window.lines, &window.totalLines, &error, pathIsContainer);
             }
-            QTextStream in(&file);
-            in.setCodec("UTF-8");
-            content = in.readAll();
-            file.close();
-            return true;
+            return LineIndexCache::shared().read(pathRes.hostPath, start, end, &window, &error);
         };
 
         for (const FileReadSpec &spec : specs)
@@ -1439,18 +1555,6 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
                 outputs << QStringLiteral(">>> %1\n%2").arg(spec.path, pathError.isEmpty() ? QStringLiteral("invalid path") : pathError);
                 continue;
             }
-            QString fileContent;
-            QString readError;
-            if (!readFileContent(pathRes, fileContent, readError))
-            {
-                outputs << QStringLiteral(">>> %1\n%2").arg(spec.path, readError);
-                continue;
-            }
-
-            QString normalized = normalizeNewlines(fileContent);
-            const bool hadTrailingNewline = normalized.endsWith('\n');
-            QStringList lines = normalized.split('\n', Qt::KeepEmptyParts);
-            if (hadTrailingNewline && !lines.isEmpty() && lines.last().isEmpty()) lines.removeLast();
 
             QString displayPath;
             if (useDocker && pathRes.containerAbsolute)
@@ -1460,29 +1564,39 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
             if (displayPath.isEmpty() || displayPath.startsWith("..")) displayPath = pathRes.hostPath;
 
             QStringList rangeOutput;
+            QString readError;
             for (const LineRange &range : spec.ranges)
             {
                 if (shouldAbort(invocation)) break;
                 const int start = std::max(1, range.start);
                 const int end = std::max(start, range.end);
-                if (lines.isEmpty())
+                LineIndexCache::Window window;
+                if (!readRange(pathRes, start, end, window, readError))
                 {
-                    rangeOutput << QStringLiteral("(empty file)");
-                    continue;
+                    if (readError.isEmpty()) readError = QStringLiteral("cannot read file: %1").arg(spec.path);
+                    break;
                 }
-                if (start > lines.size())
+                if (window.lines.isEmpty())
                 {
-                    rangeOutput << QStringLiteral("(range %1-%2 out of file size %3)").arg(start).arg(end).arg(lines.size());
+                    if (window.totalLines == 0)
+                        rangeOutput << QStringLiteral("(empty file)");
+                    else
+                        rangeOutput << QStringLiteral("(range %1-%2 out of file size %3)").arg(start).arg(end).arg(window.totalLines);
                     continue;
                 }
-                const int last = std::min(end, lines.size());
                 QStringList slice;
-                for (int i = start - 1; i < last; ++i)
+                for (int i = 0; i < window.lines.size(); ++i)
                 {
-                    slice << QStringLiteral("%1: %2").arg(i + 1).arg(lines.at(i));
+                    slice << QStringLiteral("%1: %2").arg(window.firstLine + i).arg(window.lines.at(i));
                 }
                 rangeOutput << slice.join("\n");
             }
+            if (!readError.isEmpty())
+            {
+                if (!useDocker && !QFileInfo::exists(pathRes.hostPath)) readError += workspacePathHint(root, spec.path);
+                outputs << QStringLiteral(">>> %1\n%2").arg(spec.path, readError);
+                continue;
+            }
             const QString header = QStringLiteral(">>> %1").arg(displayPath);
             outputs << header + QStringLiteral("\n") + rangeOutput.join("\n---\n");
         }
@@ -1596,6 +1710,7 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
             out << content;
             file.close();
         }
+        if (WorkspaceIndex *index = WorkspaceIndex::shared()) index->notifyPathChanged(pathRes.hostPath);
         QString result = "write over";
         sendStateMessage("tool:" + QString("write_file ") + jtr("return") + "\n" + result, TOOL_SIGNAL);
         sendPushMessage(QString("write_file ") + jtr("return") + "\n" + result);
@@ -1728,6 +1843,7 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
             ts << finalContent;
             outFile.close();
         }
+        if (WorkspaceIndex *index = WorkspaceIndex::shared()) index->notifyPathChanged(pathRes.hostPath);
         QString result = QString("replaced %1 occurrence(s)").arg(applied);
         QStringList notes;
         if (usedFlexibleMatch) notes << "whitespace-insensitive search";
@@ -1994,6 +2110,7 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
             ts << finalContent;
             outFile.close();
         }
+        if (WorkspaceIndex *index = WorkspaceIndex::shared()) index->notifyPathChanged(pathRes.hostPath);
         QStringList parts;
         const QString actions[] = {"replace", "insert_before", "insert_after", "delete"};
         for (const QString &act : actions)
@@ -2207,29 +2324,32 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
         QFileInfo dirInfo(targetPath);
         if (!dirInfo.exists() || !dirInfo.isDir())
         {
-            const QString msg = QString("Not a directory: %1").arg(dirInfo.absoluteFilePath());
+            QString msg = QString("Not a directory: %1").arg(dirInfo.absoluteFilePath());
+            if (!dirInfo.exists()) msg += workspacePathHint(root, effectivePath);
             sendPushMessage(QString("list_files ") + jtr("return") + " " + msg);
             sendStateMessage("tool:" + QString("list_files ") + jtr("return") + " " + msg, TOOL_SIGNAL);
             return;
         }
-        QDir d(dirInfo.absoluteFilePath());
-        d.setFilter(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-        d.setSorting(QDir::DirsFirst | QDir::IgnoreCase | QDir::Name);
+        // 目录内容优先取自后台工作区索引（由文件系统监视增量维护），未覆盖时回退到读盘
+        const QString dirPath = dirInfo.absoluteFilePath();
+        WorkspaceIndex *index = WorkspaceIndex::shared();
+        if (index) index->setRoot(root);
+        QVector<WorkspaceIndex::Entry> items = index ? index->entriesFor(dirPath) : WorkspaceIndex::readDirectory(dirPath);
+        std::stable_partition(items.begin(), items.end(), [](const WorkspaceIndex::Entry &e) { return e.isDir; });
         QStringList outLines;
-        const QFileInfoList items = d.entryInfoList();
         int shown = 0;
         const int kMax = 2000; // 上限，防止过长输出
-        for (const QFileInfo &it : items)
+        for (const WorkspaceIndex::Entry &it : items)
         {
             if (shouldAbort(invocation)) break;
-            const QString rel = rootDir.relativeFilePath(it.absoluteFilePath());
-            if (it.isDir())
+            const QString rel = rootDir.relativeFilePath(QDir(dirPath).filePath(it.name));
+            if (it.isDir)
             {
                 outLines << (QString("DIR  ") + rel + "/");
             }
             else
             {
-                outLines << (QString("FILE ") + rel + QString(" (%1 B)").arg(it.size()));
+                outLines << (QString("FILE ") + rel + QString(" (%1 B)").arg(it.size));
             }
             if (++shown >= kMax) break;
         }
@@ -2280,14 +2400,11 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
             return;
         }
 
-        auto runRipGrep = [&]() -> QStringList {
-            QStringList lines;
+        // rg 可用时优先使用；未安装或执行失败时使用内置并行检索（参数语义一致）
+        static const QString ripgrepPath = QStandardPaths::findExecutable(QStringLiteral("rg"));
+        auto runRipGrep = [&](QStringList *lines) -> bool {
             QProcess rg;
-#ifdef Q_OS_WIN
-            rg.setProgram(QStringLiteral("rg.exe"));
-#else
-            rg.setProgram(QStringLiteral("rg"));
-#endif
+            rg.setProgram(ripgrepPath);
             QStringList args;
             args << QStringLiteral("--fixed-strings") << QStringLiteral("--ignore-case") << QStringLiteral("--no-heading") << QStringLiteral("--line-number")
                  << QStringLiteral("--max-count") << QStringLiteral("3") << QStringLiteral("--max-filesize") << QStringLiteral("2000K")
@@ -2300,86 +2417,86 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
             if (!rg.waitForFinished(15000))
             {
                 rg.kill();
-                return lines;
+                return false;
             }
             const QString stderrText = QString::fromUtf8(rg.readAllStandardError());
+            // 退出码 1 表示没有命中，不需要再用内置检索重扫一遍
             if (rg.error() != QProcess::UnknownError || rg.exitCode() >= 2)
             {
                 qDebug() << "ripgrep failed:" << stderrText;
-                return lines;
+                return false;
             }
             const QString stdoutText = QString::fromUtf8(rg.readAllStandardOutput());
             const QStringList raw = stdoutText.split('\n', Qt::SkipEmptyParts);
             const int kMaxLines = 160;
-            for (int i = 0; i < raw.size() && lines.size() < kMaxLines; ++i)
+            for (int i = 0; i < raw.size() && lines->size() < kMaxLines; ++i)
             {
                 if (shouldAbort(invocation)) break;
-                lines << raw.at(i);
+                *lines << raw.at(i);
             }
-            return lines;
+            return true;
         };
 
-        QStringList results = runRipGrep();
-        if (results.isEmpty())
-        {
-            // 回退到简易扫描
-            auto isLikelyText = [](const QFileInfo &info, qint64 size) -> bool {
-                if (size > (qint64)2 * 1024 * 1024) return false;
-                static const QSet<QString> exts = {
-                    "txt", "md", "markdown", "log", "ini", "cfg", "conf", "csv", "tsv", "json", "yaml", "yml", "toml", "xml", "html", "htm",
-                    "css", "js", "ts", "tsx", "jsx", "py", "ipynb", "c", "cc", "cpp", "h", "hpp", "hh", "java", "kt", "rs", "go", "rb", "php",
-                    "sh", "bash", "zsh", "ps1", "bat", "cmake", "mak", "make", "gradle", "properties", "sql", "mm", "m", "swift"
-                };
-                static const QSet<QString> namesWithoutExt = {
-                    ".gitignore", ".gitmodules", ".gitattributes", ".clang-format", ".clang-tidy", ".editorconfig", ".env", ".env.local",
-                    ".env.example", "dockerfile", "makefile", "cmakelists.txt", "license", "license.txt", "readme", "readme.md"
-                };
-                const QString ext = info.suffix().toLower();
-                if (!ext.isEmpty()) return exts.contains(ext);
-                const QString name = info.fileName().toLower();
-                return namesWithoutExt.contains(name);
-            };
-            QRegularExpression globRegex;
-            if (!filePattern.isEmpty())
-            {
-                globRegex = QRegularExpression(QRegularExpression::wildcardToRegularExpression(filePattern));
+        QStringList results;
+        QStringList skippedDirs; // 内置检索未进入的被忽略目录（相对 rootDir）
+        QString engine = QStringLiteral("rg");
+        QElapsedTimer searchTimer;
+        searchTimer.start();
+        if (ripgrepPath.isEmpty() || !runRipGrep(&results))
+        {
+            engine = QStringLiteral("builtin");
+            results.clear();
+            ContentSearch::Options options;
+            options.query = query;
+            options.filePattern = filePattern;
+            options.maxMatches = 200;
+            options.cancelled = [this, invocation]() { return shouldAbort(invocation); };
+            // 候选文件优先取自工作区索引（已跳过 node_modules/.gitignore 等目录）；子树未完整索引时并行遍历磁盘
+            QVector<WorkspaceIndex::FileRef> indexedFiles;
+            QStringList indexSkipped;
+            WorkspaceIndex *index = WorkspaceIndex::shared();
+            if (index) index->setRoot(root);
+            ContentSearch::Result found;
+            if (index && index->files(rootDir.absolutePath(), &indexedFiles, std::numeric_limits<int>::max(), &indexSkipped))
+            {
+                QStringList files;
+                files.reserve(indexedFiles.size());
+                for (const auto &ref : indexedFiles) files << ref.absolutePath;
+                found = ContentSearch::searchFiles(rootDir.absolutePath(), files, options);
+                found.skippedDirs = indexSkipped;
             }
-
-            const int kMaxMatches = 200;
-            QDirIterator it(rootDir.absolutePath(), QDir::Files, QDirIterator::Subdirectories);
-            while (it.hasNext())
+            else
             {
-                if (shouldAbort(invocation)) break;
-                const QString absolutePath = it.next();
-                const QFileInfo fi(absolutePath);
-                const QString relCheck = rootDir.relativeFilePath(fi.absoluteFilePath());
-                if (relCheck.startsWith("..")) continue;
-                if (fi.fileName().startsWith('.')) continue;
-                if (!globRegex.pattern().isEmpty() && !globRegex.match(relCheck).hasMatch()) continue;
-                if (!isLikelyText(fi, fi.size())) continue;
-                QFile file(absolutePath);
-                if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) continue;
-                QTextStream stream(&file);
-                stream.setCodec("UTF-8");
-                int lineNumber = 0;
-                while (!stream.atEnd() && results.size() < kMaxMatches)
-                {
-                    if (shouldAbort(invocation)) break;
-                    ++lineNumber;
-                    const QString line = stream.readLine();
-                    if (!line.contains(query, Qt::CaseInsensitive)) continue;
-                    const QString rel = rootDir.relativeFilePath(fi.absoluteFilePath());
-                    results << QString("%1:%2:%3").arg(rel).arg(lineNumber).arg(line.trimmed());
-                }
-                file.close();
-                if (results.size() >= kMaxMatches || shouldAbort(invocation)) break;
+                found = ContentSearch::searchTree(rootDir.absolutePath(), options);
             }
+            results = found.lines;
+            // 内置检索跳过了被忽略的目录（node_modules/.gitignore 等），在结果里说明，避免模型误以为其中没有命中
+            for (const QString &dir : found.skippedDirs) skippedDirs << rootDir.relativeFilePath(dir);
+            FlowTracer::log(FlowChannel::Tool,
+                            QStringLiteral("tool:search_content builtin files=%1 binary=%2 bytes=%3 truncated=%4")
+                                .arg(found.filesScanned)
+                                .arg(found.binarySkipped)
+                                .arg(found.bytesScanned)
+                                .arg(found.truncated ? QStringLiteral("yes") : QStringLiteral("no")),
+                            invocation ? invocation->turnId : 0);
         }
+        FlowTracer::log(FlowChannel::Tool,
+                        QStringLiteral("tool:search_content engine=%1 matches=%2 %3ms").arg(engine).arg(results.size()).arg(searchTimer.elapsed()),
+                        invocation ? invocation->turnId : 0);
 
         if (shouldAbort(invocation)) return;
+        QString skippedNote;
+        if (!skippedDirs.isEmpty())
+        {
+            skippedDirs.sort();
+            const int kShownSkipped = 8;
+            skippedNote = QStringLiteral("[Not searched (ignored directories): %1%2. Pass path=<dir> to search inside one.]")
+                              .arg(skippedDirs.mid(0, kShownSkipped).join(QStringLiteral(", ")))
+                              .arg(skippedDirs.size() > kShownSkipped ? QStringLiteral(", ... (%1 total)").arg(skippedDirs.size()) : QString());
+        }
         if (results.isEmpty())
         {
-            const QString msg = QString("No matches.");
+            const QString msg = skippedNote.isEmpty() ? QString("No matches.") : QString("No matches.\n") + skippedNote;
             sendPushMessage(QString("search_content ") + jtr("return") + " " + msg);
             sendStateMessage("tool:" + QString("search_content ") + jtr("return") + " " + msg, TOOL_SIGNAL);
             return;
@@ -2395,6 +2512,7 @@ void xTool::runToolWorker(const ToolInvocationPtr &invocation)
             results = results.mid(0, 160);
             results << QStringLiteral("[Results truncated. Refine your query or add file_pattern/path.]");
         }
+        if (!skippedNote.isEmpty()) results << skippedNote;
 
         const QString result = results.join("\n");
         const QString prefix = QString("search_content ") + jtr("return") + "\n";
@@ -2612,7 +2730,10 @@ void xTool::handleStableDiffusion(const ToolInvocationPtr &invocation)
     if (!invocation) return;
     pendingDrawInvocations_[invocation->id] = invocation;
     QString prompt = QString::fromStdString(get_string_safely(invocation->args, "prompt"));
-    emit tool2expend_draw(invocation->id, prompt);
+    // count/seed 可选：一次调用生成多张（固定种子时逐张递增），由常驻 sd-server 连续出图
+    const int count = std::max(1, get_int_safely(invocation->args, "count", 1));
+    const int seed = get_int_safely(invocation->args, "seed", -1);
+    emit tool2expend_draw(invocation->id, prompt, count, seed);
 }
 
 void xTool::handleMcpToolList(const ToolInvocationPtr &invocation)
@@ -2865,6 +2986,62 @@ bool xTool::dockerReadTextFile(const QString &path, QString *content, QString *e
     return true;
 }
 
+bool xTool::dockerReadLines(const QString &path, int start, int end, QStringList *lines, int *totalLines, QString *errorMessage, bool pathIsContainer)
+{
+    if (!dockerSandboxEnabled())
+    {
+        if (errorMessage) *errorMessage = QStringLiteral("docker sandbox not enabled");
+        return false;
+    }
+    QString ensureError;
+    if (!ensureDockerSandboxReady(&ensureError))
+    {
+        if (errorMessage) *errorMessage = ensureError;
+        return false;
+    }
+    QString containerPath;
+    if (pathIsContainer)
+    {
+        containerPath = normalizeUnixPath(path);
+    }
+    else
+    {
+        containerPath = containerPathForHost(path);
+        if (containerPath.isEmpty())
+        {
+            if (errorMessage) *errorMessage = QStringLiteral("Path outside permitted roots");
+            return false;
+        }
+    }
+    QString stdOut;
+    QString stdErr;
+    QString execError;
+    // sed 打印到第 end 行后立即退出，不会把整个文件传出容器
+    const QString command = QStringLiteral("sed -n '%1,%2p;%2q' %3").arg(start).arg(end).arg(shellQuote(containerPath));
+    if (!runDockerShellCommand(command, &stdOut, &stdErr, &execError))
+    {
+        if (errorMessage) *errorMessage = execError.isEmpty() ? stdErr.trimmed() : execError;
+        return false;
+    }
+    QStringList out = stdOut.split('\n', Qt::KeepEmptyParts);
+    if (stdOut.endsWith('\n')) out.removeLast();
+    if (stdOut.isEmpty()) out.clear();
+    for (QString &line : out)
+    {
+        if (line.endsWith('\r')) line.chop(1);
+    }
+    if (totalLines) *totalLines = -1;
+    if (out.isEmpty() && totalLines)
+    {
+        // 区间为空：再数一次行数用于提示（awk 会计入末尾没有换行的最后一行）
+        QString countOut;
+        const QString countCommand = QStringLiteral("awk 'END{print NR}' %1").arg(shellQuote(containerPath));
+        if (runDockerShellCommand(countCommand, &countOut, nullptr, nullptr)) *totalLines = countOut.trimmed().toInt();
+    }
+    if (lines) *lines = out;
+    return true;
+}
+
 bool xTool::dockerWriteTextFile(const QString &path, const QString &content, QString *errorMessage, bool pathIsContainer)
 {
     if (!dockerSandboxEnabled())
@@ -3004,6 +3181,7 @@ void xTool::cancelActiveTool()
     mark(pendingDrawInvocations_);
     mark(pendingMcpInvocations_);
     mark(pendingMcpListInvocations_);
+    if (invocation && invocation->name == QLatin1String("knowledge")) EmbeddingClient::shared()->abort();
     cancelExecuteCommand();
 }
 
@@ -3046,96 +3224,86 @@ QString xTool::embedding_query_process(QString query_str)
 {
     QString knowledge_result;
     //---------------计算查询文本段的词向量-------------------------
-    ipAddress = getFirstNonLoopbackIPv4Address();
-    QEventLoop loop; // 进入事件循环，等待回复
-    QNetworkAccessManager manager;
-    // 设置请求的端点 URL
-    QString embedding_server_api = "http://" + QString(DEFAULT_EMBEDDING_IP) + ":" + DEFAULT_EMBEDDING_PORT + DEFAULT_EMBEDDING_API;
-    QNetworkRequest request(QUrl(embedding_server_api + QString(""))); // 加一个""是为了避免语法解析错误
-    // 设置请求头
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    QString api_key = "Bearer " + QString("sjxx");
-    request.setRawHeader("Authorization", api_key.toUtf8());
-    // 构造请求的数据体
-    QJsonObject json;
-    json.insert("model", "defult");
-    json.insert("encoding_format", "float");
-    json.insert("input", query_str);
-    QJsonDocument doc(json);
-    QByteArray data = doc.toJson();
-    // POST 请求
-    QNetworkReply *reply = manager.post(request, data);
-    // 处理响应
-    QObject::connect(reply, &QNetworkReply::readyRead, [&]()
-                     {
-                         QString jsonString = reply->readAll();
-                         QJsonDocument document = QJsonDocument::fromJson(jsonString.toUtf8()); // 使用QJsonDocument解析JSON数据
-                         QJsonObject rootObject = document.object();
-                         // 遍历"data"数组,获取嵌入向量结构体的嵌入向量
-                         QJsonArray dataArray = rootObject["data"].toArray();
-                         QString vector_str = "[";
-                         for (int i = 0; i < dataArray.size(); ++i)
-                         {
-                             QJsonObject dataObj = dataArray[i].toObject();
-                             // 检查"data"对象中是否存在"embedding"
-                              if (dataObj.contains("embedding"))
-                              {
-                                  QJsonArray embeddingArray = dataObj["embedding"].toArray();
-                                  const int actual_dim = embeddingArray.size();
-                                  int target_dim = embedding_server_dim;
-                                  if (!Embedding_DB.isEmpty())
-                                      target_dim = static_cast<int>(Embedding_DB.first().value.size());
-                                  if (target_dim <= 0) target_dim = actual_dim;
-                                  if (target_dim <= 0) break;
-                                  query_embedding_vector.value.assign(target_dim, 0.0);
-                                  const int fill_count = std::min(actual_dim, target_dim);
-                                  // 处理"embedding"数组：只写入安全范围，避免越界
-                                  for (int j = 0; j < fill_count; ++j)
-                                  {
-                                      query_embedding_vector.value[j] = embeddingArray[j].toDouble();
-                                      vector_str += QString::number(query_embedding_vector.value[j], 'f', 4) + ", ";
-                                  }
-                              }
-                         }
-                         vector_str += "]";
-                         sendStateMessage("tool:" + jtr("The query text segment has been embedded") + jtr("dimension") + ": " + QString::number(query_embedding_vector.value.size()) + " " + jtr("word vector") + ": " + vector_str, USUAL_SIGNAL); });
-    // 完成
-    QObject::connect(reply, &QNetworkReply::finished, [&]()
-                     {
-                         if (reply->error() == QNetworkReply::NoError)
-                         {
-                             // 请求完成，所有数据都已正常接收
-                             //------------------------计算余弦相似度---------------------------
-                             // A向量点积B向量除以(A模乘B模)
-                             std::vector<std::pair<int, double>> score;
-                             score = similar_indices(query_embedding_vector.value, Embedding_DB); // 计算查询文本段和所有嵌入文本段之间的相似度
-                             if (score.size() > 0)
-                             {
-                                 knowledge_result += jtr("The three text segments with the highest similarity") + DEFAULT_SPLITER;
-                             }
-                              size_t limit = std::min<size_t>(static_cast<size_t>(embedding_server_resultnumb), score.size());
-                              for (size_t i = 0; i < limit; ++i)
-                             {
-                                 knowledge_result += QString::number(score[i].first + 1) + jtr("Number text segment similarity") + ": " + QString::number(score[i].second);
-                                 knowledge_result += " " + jtr("content") + DEFAULT_SPLITER + Embedding_DB.at(score[i].first).chunk + "\n";
-                             }
-                             if (score.size() > 0)
-                             {
-                                 knowledge_result += jtr("Based on this information, reply to the user's previous questions");
-                             }
-                         }
-                         else
-                         {
-                             // 请求出错
-                             sendStateMessage("tool:" + jtr("Request error") + " " + reply->error(), WRONG_SIGNAL);
-                             knowledge_result += jtr("Request error") + " " + reply->error();
-                         }
-                         reply->abort(); // 终止
-                         reply->deleteLater(); });
-    // 回复完成时退出事件循环
-    QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-    // 进入事件循环
-    loop.exec();
+    // 共享客户端复用到嵌入服务的长连接；相同（归一化后）查询直接命中向量缓存
+    const QString embedding_server_api = "http://" + QString(DEFAULT_EMBEDDING_IP) + ":" + DEFAULT_EMBEDDING_PORT + DEFAULT_EMBEDDING_API;
+    EmbeddingClient *client = EmbeddingClient::shared();
+    const QString modelKey = EmbeddingClient::modelKey(embedding_server_api, embeddingModelPath(), embedding_server_dim);
+    const EmbeddingClient::Result embedded = client->query(embedding_server_api, QStringLiteral("sjxx"), query_str, DEFAULT_EMBEDDING_QUERY_TIMEOUT_MS, modelKey);
+    if (!embedded.ok)
+    {
+        sendStateMessage("tool:" + jtr("Request error") + " " + embedded.error, WRONG_SIGNAL);
+        return jtr("Request error") + " " + embedded.error;
+    }
+    FlowTracer::log(FlowChannel::Tool,
+                    QStringLiteral("tool:knowledge embed %1 us=%2").arg(embedded.cached ? QStringLiteral("cached") : QStringLiteral("fetched")).arg(embedded.elapsedUs),
+                    activeTurnId_.load(std::memory_order_relaxed));
+
+    const int actual_dim = static_cast<int>(embedded.vector.size());
+    int target_dim = embedding_server_dim;
+    if (!Embedding_DB.isEmpty())
+        target_dim = static_cast<int>(Embedding_DB.first().value.size());
+    if (target_dim <= 0) target_dim = actual_dim;
+    query_embedding_vector.value.assign(target_dim, 0.0);
+    const int fill_count = std::min(actual_dim, target_dim);
+    // 只写入安全范围，避免越界
+    QString vector_str = "[";
+    for (int j = 0; j < fill_count; ++j)
+    {
+        query_embedding_vector.value[j] = embedded.vector[j];
+        vector_str += QString::number(query_embedding_vector.value[j], 'f', 4) + ", ";
+    }
+    vector_str += "]";
+    sendStateMessage("tool:" + jtr("The query text segment has been embedded") + (embedded.cached ? QStringLiteral(" (cached)") : QString()) + jtr("dimension") + ": " + QString::number(query_embedding_vector.value.size()) + " " + jtr("word vector") + ": " + vector_str, USUAL_SIGNAL);
+
+    //------------------------计算余弦相似度---------------------------
+    // A向量点积B向量除以(A模乘B模)
+    std::vector<std::pair<int, double>> score;
+    score = similar_indices(query_embedding_vector.value, Embedding_DB); // 计算查询文本段和所有嵌入文本段之间的相似度
+
+    //------------------------重排序（可选）---------------------------
+    // 余弦召回更宽的候选集，再由交叉编码器打分，只保留最相关的结果个数；失败时保持余弦排序
+    const QString rerank_api = rerankEndpoint();
+    const size_t want = static_cast<size_t>(std::max(1, embedding_server_resultnumb));
+    bool reranked_scores = false; // 分数来自重排序模型的相关度，而非余弦相似度
+    if (!rerank_api.isEmpty() && score.size() > want)
+    {
+        const size_t candidates = std::min<size_t>(score.size(), std::max<size_t>(want, std::min<size_t>(want * DEFAULT_RERANK_CANDIDATE_FACTOR, DEFAULT_RERANK_CANDIDATE_MAX)));
+        QStringList documents;
+        documents.reserve(int(candidates));
+        for (size_t i = 0; i < candidates; ++i) documents << Embedding_DB.at(score[i].first).chunk;
+        const EmbeddingClient::RerankResult reranked = client->rerank(rerank_api, query_str, documents, DEFAULT_RERANK_TIMEOUT_MS);
+        if (reranked.ok)
+        {
+            std::vector<std::pair<int, double>> reordered;
+            reordered.reserve(reranked.scores.size());
+            for (const auto &item : reranked.scores) reordered.emplace_back(score[size_t(item.first)].first, item.second);
+            score.swap(reordered);
+            reranked_scores = true;
+            sendStateMessage("tool:rerank " + QString::number(candidates) + " -> " + QString::number(std::min(want, score.size())) + " " + QString::number(reranked.elapsedUs / 1000.0, 'f', 1) + " ms", USUAL_SIGNAL);
+        }
+        else
+        {
+            sendStateMessage("tool:rerank " + jtr("Request error") + " " + reranked.error, WRONG_SIGNAL);
+        }
+        FlowTracer::log(FlowChannel::Tool,
+                        QStringLiteral("tool:knowledge rerank ok=%1 candidates=%2 us=%3").arg(reranked.ok).arg(candidates).arg(reranked.elapsedUs),
+                        activeTurnId_.load(std::memory_order_relaxed));
+    }
+    if (score.size() > 0)
+    {
+        knowledge_result += jtr(reranked_scores ? "The text segments with the highest relevance" : "The three text segments with the highest similarity") + DEFAULT_SPLITER;
+    }
+    const QString score_label = jtr(reranked_scores ? "Number text segment relevance" : "Number text segment similarity");
+    size_t limit = std::min<size_t>(static_cast<size_t>(embedding_server_resultnumb), score.size());
+    for (size_t i = 0; i < limit; ++i)
+    {
+        knowledge_result += QString::number(score[i].first + 1) + score_label + ": " + QString::number(score[i].second);
+        knowledge_result += " " + jtr("content") + DEFAULT_SPLITER + Embedding_DB.at(score[i].first).chunk + "\n";
+    }
+    if (score.size() > 0)
+    {
+        knowledge_result += jtr("Based on this information, reply to the user's previous questions");
+    }
     return knowledge_result;
 }
 
@@ -3201,7 +3369,20 @@ void xTool::recv_embeddingdb(QVector<Embedding_vector> Embedding_DB_)
 void xTool::recv_embedding_dim(int dim)
 {
     if (dim <= 0) return;
-    embedding_server_dim = dim;
+    embedding_server_dim = dim; // 维度参与查询向量缓存的键，变化后旧向量自然作废
+}
+
+// 同步嵌入模型路径
+void xTool::recv_embedding_model(QString modelpath)
+{
+    std::lock_guard<std::mutex> lock(rerankMutex_);
+    embeddingModelPath_ = modelpath;
+}
+
+QString xTool::embeddingModelPath() const
+{
+    std::lock_guard<std::mutex> lock(rerankMutex_);
+    return embeddingModelPath_;
 }
 
 // 传递嵌入结果返回个数
@@ -3211,6 +3392,20 @@ void xTool::recv_embedding_resultnumb(int resultnumb)
     embedding_server_resultnumb = resultnumb;
 }
 
+// 同步重排序服务端点
+
+void xTool::recv_rerank_endpoint(QString endpoint)
+{
+    std::lock_guard<std::mutex> lock(rerankMutex_);
+    rerankEndpoint_ = endpoint;
+}
+
+QString xTool::rerankEndpoint() const
+{
+    std::lock_guard<std::mutex> lock(rerankMutex_);
+    return rerankEndpoint_;
+}
+
 // 接收图像绘制完成信号
 
 void xTool::recv_drawover(quint64 invocationId, QString result_, bool ok_)
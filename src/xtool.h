@@ -96,7 +96,9 @@ class xTool : public QObject
     // 桌面控制器：归一化坐标系（截图与坐标统一），用于把模型输出坐标换算为真实屏幕坐标
     void recv_controllerNormalize(int normX, int normY);
     void recv_embedding_dim(int dim);
+    void recv_embedding_model(QString modelpath);
     void recv_embedding_resultnumb(int resultnumb);
+    void recv_rerank_endpoint(QString endpoint); // 空串表示重排序服务不可用
     void recv_embeddingdb(QVector<Embedding_vector> Embedding_DB_);
     void recv_drawover(quint64 invocationId, QString result_, bool ok_); // 接收图像绘制完成信号
     void tool2ui_controller_over(QString result);                        // 传递控制完成结果
@@ -120,7 +122,7 @@ class xTool : public QObject
     void tool2mcp_toolcall(quint64 invocationId, QString tool_name, QString tool_args);
     void tool2ui_pushover(QString tool_result);
     void tool2ui_state(const QString &state_string, SIGNAL_STATE state = USUAL_SIGNAL); // 发送的状态信号
-    void tool2expend_draw(quint64 invocationId, QString prompt_);
+    void tool2expend_draw(quint64 invocationId, QString prompt_, int count, int seed);
     // 桌面控制器：用于在 UI 线程绘制“即将执行”的屏幕叠加提示。
     // x/y 为真实屏幕坐标（与鼠标移动/点击一致），UI 侧会以此为中心绘制 80x80 目标框与描述文案。
     void tool2ui_controller_hint(int x, int y, const QString &description);
@@ -176,6 +178,8 @@ class xTool : public QObject
     QString containerPathForHost(const QString &absHostPath) const;
     bool dockerReadTextFile(const QString &path, QString *content, QString *errorMessage, bool pathIsContainer = false);
     bool dockerWriteTextFile(const QString &path, const QString &content, QString *errorMessage, bool pathIsContainer = false);
+    // 容器内按行读取 start..end（sed 读到 end 即退出）；区间为空时 totalLines 为文件行数，否则为 -1
+    bool dockerReadLines(const QString &path, int start, int end, QStringList *lines, int *totalLines, QString *errorMessage, bool pathIsContainer = false);
     bool runDockerShellCommand(const QString &shellCommand, QString *stdOut, QString *stdErr, QString *errorMessage, const QByteArray &stdinData = QByteArray());
     bool markInvocationTimeout(const ToolInvocationPtr &invocation, int timeoutMs);
     ToolInvocationPtr activeInvocation() const;
@@ -198,6 +202,11 @@ class xTool : public QObject
     std::atomic<quint64> activeTurnId_{0};
     std::atomic<int> controllerNormX_{DEFAULT_CONTROLLER_NORM_X};
     std::atomic<int> controllerNormY_{DEFAULT_CONTROLLER_NORM_Y};
+    mutable std::mutex rerankMutex_; // 保护下面两项：UI 线程经排队槽写入，工具在线程池中读取
+    QString rerankEndpoint_;         // 知识库重排序端点
+    QString embeddingModelPath_;     // 当前嵌入模型路径，参与查询向量缓存的键
+    QString rerankEndpoint() const;
+    QString embeddingModelPath() const;
 };
 
 // 桌面控制器工具的函数
@@ -1,9 +1,16 @@
+#include "mock/mock_openai_server.h"
+#include "scenario_drivers.h"
+
 #include <QDir>
+#include <QEventLoop>
 #include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QProcess>
+#include <QProcessEnvironment>
+#include <QScopedPointer>
+#include <QTimer>
 #include <QtTest/QtTest>
 
 namespace
@@ -17,11 +24,32 @@ QString scenarioRoot()
 #endif
 }
 
+QString benchProgram()
+{
+#ifdef EVA_BENCH_PROGRAM
+    return QString::fromUtf8(EVA_BENCH_PROGRAM);
+#else
+    return QString();
+#endif
+}
+
+QString appProgram()
+{
+#ifdef EVA_APP_PROGRAM
+    return QString::fromUtf8(EVA_APP_PROGRAM);
+#else
+    return QString();
+#endif
+}
+
 struct Scenario
 {
     QString name;
+    QString driver; // command（默认，跑外部进程）或 ScenarioDrivers 支持的进程内驱动
+    QJsonObject mock;
     QString program;
     QStringList arguments;
+    QJsonObject env; // 追加到子进程的环境变量
     int timeoutMs = 60000;
     QString expectStdout;
     int expectExitCode = 0;
@@ -30,6 +58,8 @@ struct Scenario
     {
         Scenario scenario;
         scenario.name = object.value(QStringLiteral("name")).toString(fileName);
+        scenario.driver = object.value(QStringLiteral("driver")).toString(QStringLiteral("command"));
+        scenario.mock = object.value(QStringLiteral("mock")).toObject();
 
         const auto commandArray = object.value(QStringLiteral("command")).toArray();
         if (commandArray.isEmpty())
@@ -43,6 +73,7 @@ struct Scenario
             scenario.arguments.append(commandArray.at(i).toString());
         }
 
+        scenario.env = object.value(QStringLiteral("env")).toObject();
         scenario.timeoutMs = object.value(QStringLiteral("timeout_ms")).toInt(60000);
         scenario.expectStdout = object.value(QStringLiteral("expect_stdout_contains")).toString();
         scenario.expectExitCode = object.value(QStringLiteral("expect_exit_code")).toInt(0);
@@ -81,18 +112,80 @@ void FunctionalScenarioTests::executeScenarios()
         QVERIFY2(!document.isNull() && document.isObject(),
                  qPrintable(QStringLiteral("Scenario JSON is invalid: %1").arg(file)));
 
-        const auto scenario = Scenario::fromJson(file, document.object());
+        auto scenario = Scenario::fromJson(file, document.object());
+        if (ScenarioDrivers::isNetDriver(scenario.driver))
+        {
+            const auto outcome = ScenarioDrivers::runNetScenario(scenario.driver, document.object());
+            QVERIFY2(outcome.ok, qPrintable(QStringLiteral("Scenario %1 failed: %2").arg(scenario.name, outcome.error)));
+            continue;
+        }
+        QVERIFY2(scenario.driver == QLatin1String("command"),
+                 qPrintable(QStringLiteral("Unknown scenario driver %1: %2").arg(scenario.driver, file)));
         QVERIFY2(!scenario.program.isEmpty(),
                  qPrintable(QStringLiteral("Scenario missing command: %1").arg(file)));
 
+        // {eva_bench} 指向构建出的 eva-bench；未构建时跳过该场景
+        if (scenario.program == QLatin1String("{eva_bench}"))
+        {
+            if (benchProgram().isEmpty())
+            {
+                qInfo("Skipping %s: eva-bench is not built", qPrintable(scenario.name));
+                continue;
+            }
+            scenario.program = benchProgram();
+        }
+        // {eva} 指向构建出的主程序（启动剖析等场景）
+        if (scenario.program == QLatin1String("{eva}"))
+        {
+            if (appProgram().isEmpty())
+            {
+                qInfo("Skipping %s: eva is not built", qPrintable(scenario.name));
+                continue;
+            }
+            scenario.program = appProgram();
+        }
+
+        // 带 mock 的命令场景：进程内起 mock，参数里的 {mock_endpoint} 替换成其地址
+        QScopedPointer<MockOpenAiServer> mock;
+        if (!scenario.mock.isEmpty())
+        {
+            mock.reset(new MockOpenAiServer(MockOpenAiServer::Profile::fromJson(scenario.mock)));
+            QVERIFY2(mock->listen(), qPrintable(QStringLiteral("Mock server failed to listen: %1").arg(scenario.name)));
+            for (auto &argument : scenario.arguments)
+            {
+                argument.replace(QStringLiteral("{mock_endpoint}"), mock->endpoint());
+            }
+        }
+
         QProcess process;
         process.setProgram(scenario.program);
         process.setArguments(scenario.arguments);
+        if (!scenario.env.isEmpty())
+        {
+            QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+            for (auto it = scenario.env.begin(); it != scenario.env.end(); ++it)
+            {
+                environment.insert(it.key(), it.value().toString());
+            }
+            process.setProcessEnvironment(environment);
+        }
         process.start();
 
         QVERIFY2(process.waitForStarted(), qPrintable(QStringLiteral("Failed to start scenario: %1").arg(scenario.name)));
-        QVERIFY2(process.waitForFinished(scenario.timeoutMs),
-                 qPrintable(QStringLiteral("Scenario timed out: %1").arg(scenario.name)));
+        // 用事件循环等待而不是 waitForFinished，进程内的 mock 才能继续服务
+        if (process.state() != QProcess::NotRunning)
+        {
+            QEventLoop loop;
+            QTimer::singleShot(scenario.timeoutMs, &loop, &QEventLoop::quit);
+            connect(&process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), &loop, &QEventLoop::quit);
+            loop.exec();
+        }
+        if (process.state() != QProcess::NotRunning)
+        {
+            process.kill();
+            process.waitForFinished(2000);
+            QFAIL(qPrintable(QStringLiteral("Scenario timed out: %1").arg(scenario.name)));
+        }
 
         QCOMPARE(process.exitCode(), scenario.expectExitCode);
 
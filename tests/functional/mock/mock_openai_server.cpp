@@ -0,0 +1,417 @@
+#include "mock_openai_server.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <cmath>
+#include <memory>
+
+namespace
+{
+QByteArray statusText(int status)
+{
+    switch (status)
+    {
+    case 200: return QByteArrayLiteral("OK");
+    case 400: return QByteArrayLiteral("Bad Request");
+    case 404: return QByteArrayLiteral("Not Found");
+    case 429: return QByteArrayLiteral("Too Many Requests");
+    case 503: return QByteArrayLiteral("Service Unavailable");
+    default: return QByteArrayLiteral("Internal Server Error");
+    }
+}
+
+QByteArray sseFrame(const QJsonObject &object)
+{
+    return QByteArrayLiteral("data: ") + QJsonDocument(object).toJson(QJsonDocument::Compact) + QByteArrayLiteral("\n\n");
+}
+
+QString messageText(const QJsonObject &message)
+{
+    const QJsonValue content = message.value(QStringLiteral("content"));
+    if (content.isString()) return content.toString();
+    QString text;
+    for (const QJsonValue &part : content.toArray())
+    {
+        const QJsonObject obj = part.toObject();
+        if (obj.value(QStringLiteral("type")).toString() == QLatin1String("text")) text += obj.value(QStringLiteral("text")).toString();
+    }
+    return text;
+}
+} // namespace
+
+MockOpenAiServer::Profile MockOpenAiServer::Profile::fromJson(const QJsonObject &object)
+{
+    Profile profile;
+    auto turnFrom = [](const QJsonObject &obj)
+    {
+        Turn turn;
+        turn.content = obj.value(QStringLiteral("content")).toString();
+        // reply_tokens：生成 N 个确定性的 token，省得在场景里写长文本
+        const int generated = obj.value(QStringLiteral("reply_tokens")).toInt(0);
+        for (int i = 0; i < generated; ++i) turn.content += QStringLiteral("w%1 ").arg(i);
+        turn.reasoning = obj.value(QStringLiteral("reasoning")).toString();
+        const QJsonObject tool = obj.value(QStringLiteral("tool_call")).toObject();
+        turn.toolName = tool.value(QStringLiteral("name")).toString();
+        turn.toolArguments = tool.value(QStringLiteral("arguments")).toObject();
+        turn.httpStatus = obj.value(QStringLiteral("http_status")).toInt(200);
+        return turn;
+    };
+    const QJsonValue script = object.value(QStringLiteral("script"));
+    if (script.isArray())
+    {
+        for (const QJsonValue &v : script.toArray()) profile.script.append(turnFrom(v.toObject()));
+    }
+    else
+    {
+        profile.script.append(turnFrom(object));
+    }
+    profile.tokensPerSec = object.value(QStringLiteral("tokens_per_sec")).toDouble(profile.tokensPerSec);
+    profile.firstTokenMs = object.value(QStringLiteral("first_token_ms")).toInt(profile.firstTokenMs);
+    profile.jitterMs = object.value(QStringLiteral("jitter_ms")).toInt(profile.jitterMs);
+    profile.seed = static_cast<quint32>(object.value(QStringLiteral("seed")).toInt(static_cast<int>(profile.seed)));
+    profile.fragmentBytes = object.value(QStringLiteral("fragment_bytes")).toInt(profile.fragmentBytes);
+    profile.disconnectAfterTokens = object.value(QStringLiteral("disconnect_after_tokens")).toInt(profile.disconnectAfterTokens);
+    profile.disconnectEvery = qMax(1, object.value(QStringLiteral("disconnect_every")).toInt(profile.disconnectEvery));
+    profile.timings = object.value(QStringLiteral("timings")).toBool(profile.timings);
+    profile.nCtx = object.value(QStringLiteral("n_ctx")).toInt(profile.nCtx);
+    profile.slots = object.value(QStringLiteral("slots")).toInt(profile.slots);
+    profile.embeddingDim = object.value(QStringLiteral("embedding_dim")).toInt(profile.embeddingDim);
+    profile.model = object.value(QStringLiteral("model")).toString(profile.model);
+    return profile;
+}
+
+MockOpenAiServer::MockOpenAiServer(const Profile &profile, QObject *parent)
+    : QObject(parent), profile_(profile), server_(new QTcpServer(this)), rng_(profile.seed)
+{
+    if (profile_.script.isEmpty()) profile_.script.append(Turn{QStringLiteral("Hello from the mock server."), QString(), QString(), QJsonObject(), 200});
+    connect(server_, &QTcpServer::newConnection, this, &MockOpenAiServer::onNewConnection);
+}
+
+MockOpenAiServer::~MockOpenAiServer() = default;
+
+bool MockOpenAiServer::listen(quint16 port)
+{
+    return server_->listen(QHostAddress::LocalHost, port);
+}
+
+quint16 MockOpenAiServer::port() const
+{
+    return server_->serverPort();
+}
+
+QString MockOpenAiServer::endpoint() const
+{
+    return QStringLiteral("http://127.0.0.1:%1").arg(port());
+}
+
+QStringList MockOpenAiServer::tokenize(const QString &text)
+{
+    QStringList tokens;
+    QString current;
+    for (const QChar c : text)
+    {
+        if (!c.isSpace() && !current.isEmpty() && current.back().isSpace())
+        {
+            tokens.append(current);
+            current.clear();
+        }
+        current += c;
+    }
+    if (!current.isEmpty()) tokens.append(current);
+    return tokens;
+}
+
+QString MockOpenAiServer::replyText(const Turn &turn)
+{
+    QString text = turn.content;
+    if (!turn.toolName.isEmpty())
+    {
+        const QJsonObject call{{QStringLiteral("name"), turn.toolName}, {QStringLiteral("arguments"), turn.toolArguments}};
+        text += QStringLiteral("<tool_call>") + QString::fromUtf8(QJsonDocument(call).toJson(QJsonDocument::Compact)) + QStringLiteral("</tool_call>");
+    }
+    return text;
+}
+
+void MockOpenAiServer::onNewConnection()
+{
+    while (QTcpSocket *socket = server_->nextPendingConnection())
+    {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        pending_.insert(socket, Pending());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]()
+                { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]()
+                {
+            pending_.remove(socket);
+            socket->deleteLater(); });
+    }
+}
+
+void MockOpenAiServer::onReadyRead(QTcpSocket *socket)
+{
+    if (!pending_.contains(socket)) return;
+    QByteArray &buffer = pending_[socket].buffer;
+    buffer += socket->readAll();
+    const int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) return;
+
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    int contentLength = 0;
+    for (int i = 1; i < lines.size(); ++i)
+    {
+        const QByteArray line = lines.at(i).trimmed();
+        const int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == "content-length") contentLength = line.mid(colon + 1).trimmed().toInt();
+    }
+    if (buffer.size() < headerEnd + 4 + contentLength) return;
+
+    const QByteArray body = buffer.mid(headerEnd + 4, contentLength);
+    // 每个连接只处理一个请求（响应都带 Connection: close）
+    pending_.remove(socket);
+    QString path = QString::fromLatin1(requestLine.value(1));
+    const int query = path.indexOf(QLatin1Char('?'));
+    if (query >= 0) path.truncate(query);
+    handleRequest(socket, QString::fromLatin1(requestLine.value(0)), path, body);
+}
+
+void MockOpenAiServer::handleRequest(QTcpSocket *socket, const QString &method, const QString &path, const QByteArray &body)
+{
+    const QJsonObject json = QJsonDocument::fromJson(body).object();
+    requests_.append({method, path, json});
+
+    if (path.endsWith(QLatin1String("/chat/completions")))
+    {
+        handleChat(socket, json);
+        return;
+    }
+    if (path.endsWith(QLatin1String("/embeddings")))
+    {
+        QStringList inputs;
+        const QJsonValue input = json.value(QStringLiteral("input"));
+        if (input.isArray())
+        {
+            for (const QJsonValue &v : input.toArray()) inputs << v.toString();
+        }
+        else
+        {
+            inputs << input.toString();
+        }
+        QJsonArray data;
+        int tokens = 0;
+        for (int i = 0; i < inputs.size(); ++i)
+        {
+            // 由文本哈希决定的单位向量：相同文本得到相同向量
+            QJsonArray vec;
+            const uint h = qHash(inputs.at(i));
+            double norm = 0.0;
+            QVector<double> values;
+            for (int d = 0; d < profile_.embeddingDim; ++d)
+            {
+                const double v = double((h ^ (uint(d) * 2654435761u)) % 2001u) / 1000.0 - 1.0;
+                values.append(v);
+                norm += v * v;
+            }
+            norm = norm > 0.0 ? std::sqrt(norm) : 1.0;
+            for (double v : values) vec.append(v / norm);
+            data.append(QJsonObject{{QStringLiteral("object"), QStringLiteral("embedding")}, {QStringLiteral("index"), i}, {QStringLiteral("embedding"), vec}});
+            tokens += tokenize(inputs.at(i)).size();
+        }
+        writeJson(socket, 200, QJsonObject{{QStringLiteral("object"), QStringLiteral("list")}, {QStringLiteral("data"), data}, {QStringLiteral("model"), profile_.model}, {QStringLiteral("usage"), QJsonObject{{QStringLiteral("prompt_tokens"), tokens}, {QStringLiteral("total_tokens"), tokens}}}});
+        return;
+    }
+    if (path == QLatin1String("/tokenize"))
+    {
+        QJsonArray ids;
+        for (const QString &piece : tokenize(json.value(QStringLiteral("content")).toString())) ids.append(int(qHash(piece) % 32000u));
+        writeJson(socket, 200, QJsonObject{{QStringLiteral("tokens"), ids}});
+        return;
+    }
+    if (path == QLatin1String("/props"))
+    {
+        QJsonObject settings{{QStringLiteral("n_ctx"), profile_.nCtx}};
+        writeJson(socket, 200, QJsonObject{{QStringLiteral("default_generation_settings"), settings}, {QStringLiteral("total_slots"), profile_.slots}, {QStringLiteral("model_alias"), profile_.model}, {QStringLiteral("model_path"), profile_.model + QStringLiteral(".gguf")}});
+        return;
+    }
+    if (path == QLatin1String("/slots"))
+    {
+        QJsonArray slots;
+        for (int i = 0; i < profile_.slots; ++i) slots.append(QJsonObject{{QStringLiteral("id"), i}, {QStringLiteral("n_ctx"), profile_.nCtx}, {QStringLiteral("is_processing"), false}});
+        const QByteArray payload = QJsonDocument(slots).toJson(QJsonDocument::Compact);
+        writeChunked(socket, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " + QByteArray::number(payload.size()) + "\r\nConnection: close\r\n\r\n" + payload);
+        socket->disconnectFromHost();
+        return;
+    }
+    if (path == QLatin1String("/health"))
+    {
+        writeJson(socket, 200, QJsonObject{{QStringLiteral("status"), QStringLiteral("ok")}});
+        return;
+    }
+    if (path.endsWith(QLatin1String("/models")))
+    {
+        writeJson(socket, 200, QJsonObject{{QStringLiteral("object"), QStringLiteral("list")}, {QStringLiteral("data"), QJsonArray{QJsonObject{{QStringLiteral("id"), profile_.model}, {QStringLiteral("object"), QStringLiteral("model")}}}}});
+        return;
+    }
+    writeJson(socket, 404, QJsonObject{{QStringLiteral("error"), QJsonObject{{QStringLiteral("message"), QStringLiteral("unknown path %1").arg(path)}}}});
+}
+
+void MockOpenAiServer::handleChat(QTcpSocket *socket, const QJsonObject &body)
+{
+    const int index = chatRequests_++;
+    const Turn &turn = profile_.script.at(index % profile_.script.size());
+    if (turn.httpStatus != 200)
+    {
+        writeJson(socket, turn.httpStatus, QJsonObject{{QStringLiteral("error"), QJsonObject{{QStringLiteral("message"), QStringLiteral("mock error")}, {QStringLiteral("code"), turn.httpStatus}}}});
+        return;
+    }
+
+    QString content = replyText(turn);
+
+    const QJsonArray messages = body.value(QStringLiteral("messages")).toArray();
+    int promptTokens = 0;
+    for (const QJsonValue &m : messages) promptTokens += tokenize(messageText(m.toObject())).size();
+
+    // 末尾 assistant 消息是回复前缀时按续写处理：思考段已经出过，只补剩余正文
+    QString reasoning = turn.reasoning;
+    const QJsonObject last = messages.isEmpty() ? QJsonObject() : messages.last().toObject();
+    if (last.value(QStringLiteral("role")).toString() == QLatin1String("assistant"))
+    {
+        const QString prefix = messageText(last);
+        if (!prefix.isEmpty() && content.startsWith(prefix))
+        {
+            content = content.mid(prefix.size());
+            reasoning.clear();
+        }
+    }
+
+    const bool dropMidway = profile_.disconnectAfterTokens >= 0 && index % profile_.disconnectEvery == 0;
+    if (!body.value(QStringLiteral("stream")).toBool(false))
+    {
+        QJsonObject message{{QStringLiteral("role"), QStringLiteral("assistant")}, {QStringLiteral("content"), content}};
+        if (!reasoning.isEmpty()) message.insert(QStringLiteral("reasoning_content"), reasoning);
+        const int completion = tokenize(reasoning).size() + tokenize(content).size();
+        writeJson(socket, 200, QJsonObject{{QStringLiteral("id"), QStringLiteral("mock-%1").arg(index)}, {QStringLiteral("object"), QStringLiteral("chat.completion")}, {QStringLiteral("model"), profile_.model}, {QStringLiteral("choices"), QJsonArray{QJsonObject{{QStringLiteral("index"), 0}, {QStringLiteral("message"), message}, {QStringLiteral("finish_reason"), QStringLiteral("stop")}}}}, {QStringLiteral("usage"), QJsonObject{{QStringLiteral("prompt_tokens"), promptTokens}, {QStringLiteral("completion_tokens"), completion}, {QStringLiteral("total_tokens"), promptTokens + completion}}}});
+        return;
+    }
+    streamChat(socket, tokenize(reasoning), tokenize(content), promptTokens, dropMidway);
+}
+
+void MockOpenAiServer::streamChat(QTcpSocket *socket, const QStringList &reasoning, const QStringList &content, int promptTokens, bool dropMidway)
+{
+    const QString id = QStringLiteral("mock-%1").arg(chatRequests_ - 1);
+    const qint64 created = QDateTime::currentSecsSinceEpoch();
+    auto chunk = [&](const QJsonObject &delta, const QJsonValue &finish)
+    {
+        return QJsonObject{{QStringLiteral("id"), id}, {QStringLiteral("object"), QStringLiteral("chat.completion.chunk")}, {QStringLiteral("created"), created}, {QStringLiteral("model"), profile_.model}, {QStringLiteral("slot_id"), 0}, {QStringLiteral("choices"), QJsonArray{QJsonObject{{QStringLiteral("index"), 0}, {QStringLiteral("delta"), delta}, {QStringLiteral("finish_reason"), finish}}}}};
+    };
+
+    // 预先排好每一帧的到期时间（相对响应开始），定时器按到期时间批量写出，高 token 速率下也不受毫秒粒度限制
+    struct Frame
+    {
+        QByteArray bytes;
+        double dueMs = 0.0;
+        bool token = false;
+    };
+    auto frames = std::make_shared<QVector<Frame>>();
+    frames->append({sseFrame(chunk(QJsonObject{{QStringLiteral("role"), QStringLiteral("assistant")}}, QJsonValue::Null)), 0.0, false});
+    double due = profile_.firstTokenMs;
+    bool first = true;
+    auto addToken = [&](const QString &field, const QString &piece)
+    {
+        if (!first) due += nextDelayMs();
+        first = false;
+        frames->append({sseFrame(chunk(QJsonObject{{field, piece}}, QJsonValue::Null)), due, true});
+    };
+    for (const QString &piece : reasoning) addToken(QStringLiteral("reasoning_content"), piece);
+    for (const QString &piece : content) addToken(QStringLiteral("content"), piece);
+
+    const int predicted = reasoning.size() + content.size();
+    QJsonObject last = chunk(QJsonObject(), QStringLiteral("stop"));
+    const double decodeMs = qMax(1.0, due - profile_.firstTokenMs);
+    if (profile_.timings)
+    {
+        last.insert(QStringLiteral("timings"), QJsonObject{{QStringLiteral("prompt_n"), promptTokens}, {QStringLiteral("prompt_ms"), double(qMax(1, profile_.firstTokenMs))}, {QStringLiteral("prompt_per_second"), promptTokens * 1000.0 / qMax(1, profile_.firstTokenMs)}, {QStringLiteral("predicted_n"), predicted}, {QStringLiteral("predicted_ms"), decodeMs}, {QStringLiteral("predicted_per_second"), predicted > 1 ? (predicted - 1) * 1000.0 / decodeMs : 0.0}, {QStringLiteral("cache_n"), 0}});
+    }
+    last.insert(QStringLiteral("usage"), QJsonObject{{QStringLiteral("prompt_tokens"), promptTokens}, {QStringLiteral("completion_tokens"), predicted}, {QStringLiteral("total_tokens"), promptTokens + predicted}});
+    frames->append({sseFrame(last), due, false});
+    frames->append({QByteArrayLiteral("data: [DONE]\n\n"), due, false});
+
+    writeChunked(socket, QByteArrayLiteral("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n"));
+
+    auto clock = std::make_shared<QElapsedTimer>();
+    clock->start();
+    auto cursor = std::make_shared<int>(0);
+    auto sentTokens = std::make_shared<int>(0);
+    const int dropAt = dropMidway ? profile_.disconnectAfterTokens : -1;
+    QTimer *timer = new QTimer(socket);
+    timer->setSingleShot(true);
+    QPointer<QTcpSocket> guard(socket);
+    connect(timer, &QTimer::timeout, socket, [this, guard, timer, frames, clock, cursor, sentTokens, dropAt]()
+            {
+        if (!guard || guard->state() != QAbstractSocket::ConnectedState) return;
+        const double now = clock->nsecsElapsed() / 1e6;
+        QByteArray batch;
+        while (*cursor < frames->size() && frames->at(*cursor).dueMs <= now)
+        {
+            const Frame &frame = frames->at(*cursor);
+            if (frame.token && dropAt >= 0 && *sentTokens >= dropAt)
+            {
+                // 模拟断流：已写出的数据照常送达，然后直接复位连接
+                if (!batch.isEmpty()) writeChunked(guard, batch);
+                guard->flush();
+                guard->abort();
+                return;
+            }
+            batch += frame.bytes;
+            if (frame.token) ++*sentTokens;
+            ++*cursor;
+        }
+        if (!batch.isEmpty()) writeChunked(guard, batch);
+        if (*cursor >= frames->size())
+        {
+            guard->disconnectFromHost();
+            return;
+        }
+        timer->start(qMax(0, int(std::ceil(frames->at(*cursor).dueMs - now)))); });
+    timer->start(0);
+}
+
+void MockOpenAiServer::writeJson(QTcpSocket *socket, int status, const QJsonObject &object)
+{
+    const QByteArray payload = QJsonDocument(object).toJson(QJsonDocument::Compact);
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' + statusText(status) + "\r\n";
+    head += "Content-Type: application/json\r\nContent-Length: " + QByteArray::number(payload.size()) + "\r\nConnection: close\r\n\r\n";
+    writeChunked(socket, head + payload);
+    socket->disconnectFromHost();
+}
+
+void MockOpenAiServer::writeChunked(QTcpSocket *socket, const QByteArray &data)
+{
+    if (profile_.fragmentBytes <= 0)
+    {
+        socket->write(data);
+        socket->flush();
+        return;
+    }
+    // 逐片写出并立即冲刷（配合 TCP_NODELAY），让客户端在 SSE 帧中间收到半截数据
+    for (int pos = 0; pos < data.size(); pos += profile_.fragmentBytes)
+    {
+        socket->write(data.mid(pos, profile_.fragmentBytes));
+        socket->flush();
+    }
+}
+
+double MockOpenAiServer::nextDelayMs()
+{
+    const double base = profile_.tokensPerSec > 0.0 ? 1000.0 / profile_.tokensPerSec : 0.0;
+    const int jitter = profile_.jitterMs > 0 ? int(rng_.bounded(2 * profile_.jitterMs + 1)) - profile_.jitterMs : 0;
+    return qMax(0.0, base + jitter);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QString>
+#include <QVector>
+
+class QTcpServer;
+class QTcpSocket;
+
+// 可脚本化的本地 OpenAI 兼容 mock 服务，用于在没有 GPU/模型的环境里复现地测量 xNet、LocalProxyServer 与工具循环。
+// 支持的端点：
+// - POST /v1/chat/completions：SSE 流式（也支持 stream=false），按 tokens_per_sec 定速出 token，可加抖动、
+//   把 SSE 帧拆成任意字节数的碎片写出、在第 N 个 token 后直接断开连接；
+//   末尾 assistant 消息若是回复的前缀，则从断点接着出（模拟 llama-server 的续写）
+// - POST /v1/embeddings、POST /tokenize、GET /props、GET /slots、GET /health、GET /v1/models
+// 所有随机性都来自 profile 里的 seed，同一 profile 每次运行产出相同的字节序列与节奏。
+class MockOpenAiServer : public QObject
+{
+    Q_OBJECT
+  public:
+    // 一次对话请求的回复；script 按 chat 请求序号循环取（工具循环可写成 [tool_call, 最终回答]）
+    struct Turn
+    {
+        QString content;
+        QString reasoning;
+        QString toolName; // 非空时在 content 之后追加 <tool_call>{...}</tool_call>
+        QJsonObject toolArguments;
+        int httpStatus = 200;
+    };
+
+    struct Profile
+    {
+        QVector<Turn> script;
+        double tokensPerSec = 200.0;
+        int firstTokenMs = 0;
+        int jitterMs = 0;
+        quint32 seed = 1;
+        int fragmentBytes = 0;          // >0 时把每次写出拆成该大小的碎片
+        int disconnectAfterTokens = -1; // >=0 时在该 token 数后断开
+        int disconnectEvery = 1;        // 每 N 个 chat 请求断一次（序号 %N==0）；2 表示断流后的续写请求能跑完
+        bool timings = true;            // 末帧附带 llama.cpp timings
+        int nCtx = 4096;
+        int slots = 1;
+        int embeddingDim = 8;
+        QString model = QStringLiteral("mock-model");
+
+        // 字段与 JSON 同名（snake_case）；未给出的字段取默认值
+        static Profile fromJson(const QJsonObject &object);
+    };
+
+    struct RequestLog
+    {
+        QString method;
+        QString path;
+        QJsonObject body;
+    };
+
+    explicit MockOpenAiServer(const Profile &profile, QObject *parent = nullptr);
+    ~MockOpenAiServer() override;
+
+    bool listen(quint16 port = 0);
+    quint16 port() const;
+    QString endpoint() const;
+
+    const QVector<RequestLog> &requests() const { return requests_; }
+    int chatRequests() const { return chatRequests_; }
+
+    // 与 mock 的 token 切分一致：按空白切片，空白归到前一个 token
+    static QStringList tokenize(const QString &text);
+    // 该回合完整的正文（含追加的 <tool_call> 块），场景据此校验回复是否完整
+    static QString replyText(const Turn &turn);
+
+  private slots:
+    void onNewConnection();
+
+  private:
+    struct Pending
+    {
+        QByteArray buffer;
+    };
+
+    void onReadyRead(QTcpSocket *socket);
+    void handleRequest(QTcpSocket *socket, const QString &method, const QString &path, const QByteArray &body);
+    void handleChat(QTcpSocket *socket, const QJsonObject &body);
+    void streamChat(QTcpSocket *socket, const QStringList &reasoning, const QStringList &content, int promptTokens, bool dropMidway);
+    void writeJson(QTcpSocket *socket, int status, const QJsonObject &object);
+    void writeChunked(QTcpSocket *socket, const QByteArray &data);
+    double nextDelayMs();
+
+    Profile profile_;
+    QTcpServer *server_ = nullptr;
+    QHash<QTcpSocket *, Pending> pending_;
+    QVector<RequestLog> requests_;
+    int chatRequests_ = 0;
+    QRandomGenerator rng_;
+};
@@ -0,0 +1,45 @@
+// eva_mock_server: standalone launcher for MockOpenAiServer
+// 便于手动压测或给 eva-bench 当目标：
+//   eva_mock_server --port 18080 --profile tests/functional/scenarios/xnet_stream_throughput.json
+// profile 可以是整个场景文件（读取其中的 "mock" 对象），也可以直接是 mock 配置。
+#include "mock_openai_server.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Scriptable OpenAI-compatible mock server for EVA performance tests."));
+    parser.addHelpOption();
+    const QCommandLineOption portOpt(QStringLiteral("port"), QStringLiteral("Port to listen on (0 picks a free port)."), QStringLiteral("port"), QStringLiteral("0"));
+    const QCommandLineOption profileOpt(QStringLiteral("profile"), QStringLiteral("JSON profile or scenario file."), QStringLiteral("path"));
+    parser.addOptions({portOpt, profileOpt});
+    parser.process(app);
+
+    QJsonObject profileJson;
+    if (parser.isSet(profileOpt))
+    {
+        QFile file(parser.value(profileOpt));
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            fprintf(stderr, "eva_mock_server: cannot read %s\n", qPrintable(parser.value(profileOpt)));
+            return 1;
+        }
+        profileJson = QJsonDocument::fromJson(file.readAll()).object();
+        if (profileJson.value(QStringLiteral("mock")).isObject()) profileJson = profileJson.value(QStringLiteral("mock")).toObject();
+    }
+
+    MockOpenAiServer server(MockOpenAiServer::Profile::fromJson(profileJson));
+    if (!server.listen(static_cast<quint16>(parser.value(portOpt).toUInt())))
+    {
+        fprintf(stderr, "eva_mock_server: listen failed\n");
+        return 1;
+    }
+    QTextStream(stdout) << "eva_mock_server listening on " << server.endpoint() << Qt::endl;
+    return app.exec();
+}
@@ -0,0 +1,244 @@
+#include "scenario_drivers.h"
+
+#include "mock/mock_openai_server.h"
+
+#include "expend/eval_suite.h"
+#include "service/backend/localproxy.h"
+#include "xnet.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QScopedPointer>
+#include <QTextStream>
+#include <QTimer>
+
+namespace
+{
+constexpr int kMaxToolTurns = 8;
+
+// 单次 xNet::run 的观测结果
+struct TurnStats
+{
+    double ttfbMs = -1.0;
+    double totalMs = 0.0;
+    QString output;
+    QString error;
+};
+
+TurnStats runTurn(xNet &net, const ENDPOINT_DATA &data, int timeoutMs)
+{
+    TurnStats stats;
+    QEventLoop loop;
+    QElapsedTimer clock;
+    bool finished = false;
+    bool stopping = false;
+
+    // 以 loop 作为连接上下文，函数返回时连接随之断开
+    QObject::connect(&net, &xNet::net2ui_output, &loop, [&](const QString &text, bool, QColor)
+                     {
+        stats.output += text;
+        if (stats.ttfbMs < 0.0 && !text.trimmed().isEmpty()) stats.ttfbMs = clock.nsecsElapsed() / 1e6; });
+    QObject::connect(&net, &xNet::net2ui_state, &loop, [&](const QString &line, SIGNAL_STATE state)
+                     {
+        if (!stopping && state == WRONG_SIGNAL && stats.error.isEmpty()) stats.error = line; });
+    QObject::connect(&net, &xNet::net2ui_pushover, &loop, [&]()
+                     {
+        finished = true;
+        loop.quit(); });
+
+    QTimer guard;
+    guard.setSingleShot(true);
+    QObject::connect(&guard, &QTimer::timeout, &loop, [&]()
+                     {
+        stats.error = QStringLiteral("timed out after %1 ms").arg(timeoutMs);
+        stopping = true;
+        net.recv_stop(true); });
+
+    net.recv_stop(false);
+    net.recv_data(data);
+    clock.start();
+    guard.start(timeoutMs);
+    net.run();
+    // 请求在 run() 内同步失败时 pushover 已经发过，不能再进事件循环
+    if (!finished) loop.exec();
+    stats.totalMs = clock.nsecsElapsed() / 1e6;
+    return stats;
+}
+
+ENDPOINT_DATA makeData(const QJsonArray &messages)
+{
+    const SETTINGS defaults;
+    ENDPOINT_DATA d{};
+    d.is_complete_state = false;
+    d.messagesArray = messages;
+    d.temp = 0.0f;
+    d.repeat = defaults.repeat;
+    d.top_k = defaults.top_k;
+    d.top_p = defaults.hid_top_p;
+    d.n_predict = -1;
+    d.reasoning_effort = sanitizeReasoningEffort(defaults.reasoning_effort);
+    d.id_slot = -1;
+    return d;
+}
+
+QJsonObject message(const char *role, const QString &content)
+{
+    return QJsonObject{{QStringLiteral("role"), QString::fromLatin1(role)}, {QStringLiteral("content"), content}};
+}
+
+QJsonObject summaryJson(const QVector<double> &samples)
+{
+    const EvalSuite::Summary s = EvalSuite::summarize(samples);
+    return QJsonObject{{QStringLiteral("count"), s.count}, {QStringLiteral("min"), s.min}, {QStringLiteral("mean"), s.mean}, {QStringLiteral("p50"), s.p50}, {QStringLiteral("p90"), s.p90}, {QStringLiteral("max"), s.max}};
+}
+
+// 指标一律打印到 stdout（CI 日志可 grep），设置 EVA_FUNCTIONAL_METRICS_DIR 时另存 <name>.json
+void publishMetrics(const QString &name, const QJsonObject &metrics)
+{
+    const QByteArray json = QJsonDocument(metrics).toJson(QJsonDocument::Compact);
+    QTextStream(stdout) << "functional-metrics " << name << ' ' << QString::fromUtf8(json) << Qt::endl;
+    const QString dir = qEnvironmentVariable("EVA_FUNCTIONAL_METRICS_DIR");
+    if (dir.isEmpty()) return;
+    QDir().mkpath(dir);
+    QFile file(QDir(dir).filePath(name + QStringLiteral(".json")));
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) file.write(QJsonDocument(metrics).toJson(QJsonDocument::Indented));
+}
+} // namespace
+
+namespace ScenarioDrivers
+{
+bool isNetDriver(const QString &driver)
+{
+    return driver == QLatin1String("xnet_stream") || driver == QLatin1String("local_proxy") || driver == QLatin1String("tool_loop");
+}
+
+Outcome runNetScenario(const QString &driver, const QJsonObject &scenario)
+{
+    Outcome outcome;
+    const QString name = scenario.value(QStringLiteral("name")).toString(driver);
+    auto fail = [&outcome](const QString &reason)
+    {
+        if (outcome.ok) outcome.error = reason;
+        outcome.ok = false;
+    };
+
+    const MockOpenAiServer::Profile profile = MockOpenAiServer::Profile::fromJson(scenario.value(QStringLiteral("mock")).toObject());
+    MockOpenAiServer mock(profile);
+    if (!mock.listen())
+    {
+        fail(QStringLiteral("mock server failed to listen"));
+        return outcome;
+    }
+
+    QString endpoint = mock.endpoint();
+    QScopedPointer<LocalProxyServer> proxy;
+    if (driver == QLatin1String("local_proxy"))
+    {
+        proxy.reset(new LocalProxyServer);
+        proxy->setBackendEndpoint(QStringLiteral("127.0.0.1"), mock.port());
+        proxy->setBackendAvailable(true);
+        QString err;
+        if (!proxy->start(QStringLiteral("127.0.0.1"), 0, &err))
+        {
+            fail(QStringLiteral("proxy failed to listen: %1").arg(err));
+            return outcome;
+        }
+        endpoint = QStringLiteral("http://127.0.0.1:%1").arg(proxy->listenPort());
+    }
+
+    xNet net;
+    APIS apis;
+    apis.api_endpoint = endpoint;
+    apis.api_model = profile.model;
+    // 本地后端才会走断流续写；远端语义可在场景里关掉
+    apis.is_local_backend = scenario.value(QStringLiteral("local_backend")).toBool(true);
+    net.recv_apis(apis);
+
+    const int iterations = qMax(1, scenario.value(QStringLiteral("iterations")).toInt(3));
+    const int warmup = qMax(0, scenario.value(QStringLiteral("warmup")).toInt(0));
+    const int timeoutMs = scenario.value(QStringLiteral("timeout_ms")).toInt(30000);
+    const QString prompt = scenario.value(QStringLiteral("prompt")).toString(QStringLiteral("Benchmark prompt."));
+    const bool toolLoop = driver == QLatin1String("tool_loop");
+    const QJsonObject expect = scenario.value(QStringLiteral("expect")).toObject();
+
+    QVector<double> ttfb, total, tps, requestsPerIteration, turnsPerIteration;
+    int errors = 0;
+    for (int i = 0; i < warmup + iterations; ++i)
+    {
+        const int before = mock.chatRequests();
+        QJsonArray messages{message(DEFAULT_SYSTEM_NAME, QStringLiteral("You are a benchmark target.")), message(DEFAULT_USER_NAME, prompt)};
+        double firstTtfb = -1.0;
+        double elapsed = 0.0;
+        int turns = 0;
+        TurnStats last;
+        while (turns < kMaxToolTurns)
+        {
+            last = runTurn(net, makeData(messages), timeoutMs);
+            ++turns;
+            elapsed += last.totalMs;
+            if (firstTtfb < 0.0) firstTtfb = last.ttfbMs;
+            const QString visible = EvalSuite::stripReasoning(last.output);
+            if (!last.error.isEmpty() || !toolLoop || !visible.contains(QStringLiteral("<tool_call>"))) break;
+            // 工具结果固定回灌，只测往返开销
+            messages.append(message(DEFAULT_MODEL_NAME, visible));
+            messages.append(message(DEFAULT_USER_NAME, QStringLiteral("<tool_response>ok</tool_response>")));
+        }
+        if (i < warmup) continue;
+
+        const int requests = mock.chatRequests() - before;
+        if (!last.error.isEmpty())
+        {
+            ++errors;
+            fail(QStringLiteral("iteration %1: %2").arg(i - warmup).arg(last.error));
+            continue;
+        }
+        ttfb.append(firstTtfb >= 0.0 ? firstTtfb : elapsed);
+        total.append(elapsed);
+        requestsPerIteration.append(requests);
+        turnsPerIteration.append(turns);
+
+        // 客户端视角的解码速度：用 mock 的切分规则数可见 token，覆盖断流续写的两段
+        const QString visible = EvalSuite::stripReasoning(last.output);
+        const int tokens = MockOpenAiServer::tokenize(visible).size();
+        const double decodeMs = last.totalMs - qMax(0.0, last.ttfbMs);
+        if (tokens > 1 && decodeMs > 0.0) tps.append((tokens - 1) * 1000.0 / decodeMs);
+
+        if (expect.value(QStringLiteral("reply_intact")).toBool(false))
+        {
+            // 续写场景用单回合脚本；工具循环的最后一次请求即最终回答
+            const MockOpenAiServer::Turn &turn = profile.script.at((mock.chatRequests() - 1) % profile.script.size());
+            if (visible.trimmed() != MockOpenAiServer::replyText(turn).trimmed()) fail(QStringLiteral("iteration %1: reply differs from the scripted text").arg(i - warmup));
+        }
+        if (expect.contains(QStringLiteral("chat_requests_per_iteration")) && requests != expect.value(QStringLiteral("chat_requests_per_iteration")).toInt())
+            fail(QStringLiteral("iteration %1: %2 chat requests, expected %3").arg(i - warmup).arg(requests).arg(expect.value(QStringLiteral("chat_requests_per_iteration")).toInt()));
+        if (expect.contains(QStringLiteral("tool_turns")) && turns != expect.value(QStringLiteral("tool_turns")).toInt())
+            fail(QStringLiteral("iteration %1: %2 turns, expected %3").arg(i - warmup).arg(turns).arg(expect.value(QStringLiteral("tool_turns")).toInt()));
+    }
+
+    const EvalSuite::Summary ttfbSummary = EvalSuite::summarize(ttfb);
+    const EvalSuite::Summary tpsSummary = EvalSuite::summarize(tps);
+    outcome.metrics = QJsonObject{
+        {QStringLiteral("driver"), driver},
+        {QStringLiteral("iterations"), iterations},
+        {QStringLiteral("errors"), errors},
+        {QStringLiteral("ttfb_ms"), summaryJson(ttfb)},
+        {QStringLiteral("total_ms"), summaryJson(total)},
+        {QStringLiteral("tokens_per_sec"), summaryJson(tps)},
+        {QStringLiteral("chat_requests"), summaryJson(requestsPerIteration)},
+        {QStringLiteral("turns"), summaryJson(turnsPerIteration)},
+        {QStringLiteral("mock_tokens_per_sec"), profile.tokensPerSec},
+    };
+
+    if (expect.contains(QStringLiteral("min_tokens_per_sec")) && tpsSummary.p50 < expect.value(QStringLiteral("min_tokens_per_sec")).toDouble())
+        fail(QStringLiteral("p50 tokens/s %1 below %2").arg(tpsSummary.p50, 0, 'f', 1).arg(expect.value(QStringLiteral("min_tokens_per_sec")).toDouble()));
+    if (expect.contains(QStringLiteral("max_ttfb_ms")) && ttfbSummary.p50 > expect.value(QStringLiteral("max_ttfb_ms")).toDouble())
+        fail(QStringLiteral("p50 ttfb %1 ms above %2").arg(ttfbSummary.p50, 0, 'f', 1).arg(expect.value(QStringLiteral("max_ttfb_ms")).toDouble()));
+
+    publishMetrics(name, outcome.metrics);
+    return outcome;
+}
+} // namespace ScenarioDrivers
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+
+// 基于 mock 服务的功能场景驱动：在进程内跑 xNet / LocalProxyServer / 工具循环，采集首包延迟与吞吐。
+// 场景字段见 tests/functional/scenarios/README.md；失败时 ok=false 并给出原因，metrics 无论成败都会填写。
+namespace ScenarioDrivers
+{
+struct Outcome
+{
+    bool ok = true;
+    QString error;
+    QJsonObject metrics;
+};
+
+bool isNetDriver(const QString &driver);
+Outcome runNetScenario(const QString &driver, const QJsonObject &scenario);
+} // namespace ScenarioDrivers
@@ -141,3 +141,53 @@ TEST_CASE("buildLocalServerArgs adds no-repack for Win7 q4_0 models")
     const QStringList args = buildLocalServerArgs(input);
     CHECK(args.contains(QStringLiteral("--no-repack")));
 }
+
+TEST_CASE("buildLocalServerArgs passes KV cache type, cache reuse and context shift")
+{
+    ensureQtApp();
+    LocalServerArgsInput input;
+    input.settings = SETTINGS{};
+    CHECK_FALSE(buildLocalServerArgs(input).contains(QStringLiteral("-ctk")));
+    CHECK_FALSE(buildLocalServerArgs(input).contains(QStringLiteral("--cache-reuse")));
+    CHECK_FALSE(buildLocalServerArgs(input).contains(QStringLiteral("--context-shift")));
+
+    input.settings.hid_cache_type_k = QStringLiteral("q8_0");
+    input.settings.hid_cache_type_v = QStringLiteral("Q4_0");
+    input.settings.hid_cache_reuse = 256;
+    input.settings.hid_context_shift = true;
+    const QStringList args = buildLocalServerArgs(input);
+    const int ctkIdx = args.indexOf(QStringLiteral("-ctk"));
+    const int ctvIdx = args.indexOf(QStringLiteral("-ctv"));
+    const int reuseIdx = args.indexOf(QStringLiteral("--cache-reuse"));
+    REQUIRE(ctkIdx >= 0);
+    REQUIRE(ctvIdx >= 0);
+    REQUIRE(reuseIdx >= 0);
+    CHECK(args.at(ctkIdx + 1) == QStringLiteral("q8_0"));
+    CHECK(args.at(ctvIdx + 1) == QStringLiteral("q4_0"));
+    CHECK(args.at(reuseIdx + 1) == QStringLiteral("256"));
+    CHECK(args.contains(QStringLiteral("--context-shift")));
+    CHECK_FALSE(buildLocalServerArgs(LocalServerArgsInput{}).contains(QStringLiteral("-fa")));
+
+    // 量化 KV 依赖 flash attention：关闭时不传 -ctk/-ctv
+    input.settings.hid_flash_attn = false;
+    const QStringList noFa = buildLocalServerArgs(input);
+    CHECK_FALSE(noFa.contains(QStringLiteral("-ctk")));
+    CHECK_FALSE(noFa.contains(QStringLiteral("-ctv")));
+    CHECK(noFa.contains(QStringLiteral("--cache-reuse")));
+}
+
+TEST_CASE("buildLocalServerArgs turns flash attention on explicitly for a quantized V cache")
+{
+    ensureQtApp();
+    LocalServerArgsInput input;
+    input.settings = SETTINGS{};
+    input.settings.hid_cache_type_v = QStringLiteral("q8_0");
+    const QStringList args = buildLocalServerArgs(input);
+    const int ctvIdx = args.indexOf(QStringLiteral("-ctv"));
+    const int faIdx = args.indexOf(QStringLiteral("-fa"));
+    REQUIRE(ctvIdx >= 0);
+    REQUIRE(faIdx >= 0);
+    CHECK(args.at(ctvIdx + 1) == QStringLiteral("q8_0"));
+    CHECK(args.at(faIdx + 1) == QStringLiteral("on"));
+    CHECK(args.count(QStringLiteral("-fa")) == 1);
+}
@@ -0,0 +1,274 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include "expend/doc_ingest.h"
+
+namespace
+{
+QCoreApplication *ensureQtApp()
+{
+    static int argc = 0;
+    static char **argv = nullptr;
+    static QCoreApplication app(argc, argv);
+    return &app;
+}
+
+// 旧实现：QStringList token + 逐个拼接，作为切分结果的对照
+QStringList legacySplit(const QString &content, int splitLength, int overlap)
+{
+    QStringList tokens;
+    const QVector<int> bounds = DocIngest::tokenBoundaries(content);
+    for (int i = 0; i + 1 < bounds.size(); ++i) tokens << content.mid(bounds[i], bounds[i + 1] - bounds[i]);
+    QStringList out;
+    int start = 0;
+    while (start < tokens.size())
+    {
+        int length = 0;
+        int end = start;
+        while (end < tokens.size() && length + tokens[end].length() <= splitLength) length += tokens[end++].length();
+        QString paragraph;
+        for (int i = start; i < end; ++i) paragraph += tokens[i];
+        if (!paragraph.trimmed().isEmpty()) out << paragraph;
+        if (end >= tokens.size()) break;
+        int overlapLength = 0;
+        int overlapTokens = 0;
+        while (end - overlapTokens > start && overlapLength < overlap)
+        {
+            overlapLength += tokens[end - 1 - overlapTokens].length();
+            ++overlapTokens;
+        }
+        start = end - overlapTokens;
+    }
+    return out;
+}
+
+// 伪分词器：汉字逐字计 1，其它非空白 token 计 1
+int fakeTokens(const QString &text)
+{
+    const QVector<int> bounds = DocIngest::tokenBoundaries(text);
+    int tokens = 0;
+    for (int i = 0; i + 1 < bounds.size(); ++i)
+    {
+        const QString piece = text.mid(bounds[i], bounds[i + 1] - bounds[i]);
+        if (piece.trimmed().isEmpty()) continue;
+        tokens += piece.at(0).script() == QChar::Script_Han ? piece.size() : 1;
+    }
+    return tokens;
+}
+
+void writeText(const QString &path, const QString &text)
+{
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(text.toUtf8());
+}
+} // namespace
+
+TEST_CASE("tokenBoundaries covers the whole text")
+{
+    const QString text = QStringLiteral("知识库 ingest 测试😀, tab\tend\n");
+    const QVector<int> bounds = DocIngest::tokenBoundaries(text);
+    REQUIRE(bounds.size() >= 2);
+    CHECK(bounds.first() == 0);
+    CHECK(bounds.last() == text.size());
+    CHECK(text.mid(bounds[0], bounds[1] - bounds[0]) == QStringLiteral("知识库"));
+}
+
+TEST_CASE("splitChunks matches the legacy sliding window")
+{
+    QString text;
+    for (int i = 0; i < 40; ++i) text += QStringLiteral("第%1段内容，包含 English words and 标点。\n").arg(i);
+    CHECK(DocIngest::splitChunks(text, 60, 10) == legacySplit(text, 60, 10));
+    CHECK(DocIngest::splitChunks(text, 200, 0) == legacySplit(text, 200, 0));
+}
+
+TEST_CASE("splitChunks keeps an oversized token instead of stalling")
+{
+    const QString longRun(500, QChar(0x4E2D)); // 500 个连续汉字构成单个 token
+    const QStringList chunks = DocIngest::splitChunks(longRun + QStringLiteral(" tail"), 100, 20);
+    REQUIRE(chunks.size() == 2);
+    CHECK(chunks.first() == longRun);
+    CHECK(chunks.last().trimmed() == QStringLiteral("tail"));
+}
+
+TEST_CASE("packByTokens respects the token budget and heading boundaries")
+{
+    QString markdown = QStringLiteral("# 第一章\n");
+    for (int i = 0; i < 30; ++i) markdown += QStringLiteral("这是第%1句中文说明。Some English words follow here. ").arg(i);
+    markdown += QStringLiteral("\n\n## Second heading\nShort tail paragraph.\n");
+
+    QStringList chunks;
+    int calls = 0;
+    const DocIngest::TokenCounter counter = [&calls](const QString &text)
+    {
+        ++calls;
+        return fakeTokens(text);
+    };
+    REQUIRE(DocIngest::packByTokens(markdown, 40, 0, counter, &chunks));
+    REQUIRE(chunks.size() > 2);
+    CHECK(chunks.join(QString()) == markdown); // 无重叠时拼接即原文
+    for (const QString &chunk : chunks) CHECK(fakeTokens(chunk) <= 40);
+    CHECK(chunks.first().startsWith(QStringLiteral("# 第一章")));
+    CHECK(chunks.last().startsWith(QStringLiteral("## Second heading")));
+    CHECK(calls < chunks.size() * 4);
+}
+
+TEST_CASE("packByTokens hard-splits an oversized sentence and reports tokenizer failure")
+{
+    const QString runOn(300, QChar(0x5B57));
+    QStringList chunks;
+    REQUIRE(DocIngest::packByTokens(runOn, 50, 5, fakeTokens, &chunks));
+    CHECK(chunks.size() >= 6);
+    for (const QString &chunk : chunks) CHECK(fakeTokens(chunk) <= 50);
+
+    const DocIngest::TokenCounter broken = [](const QString &) { return -1; };
+    CHECK_FALSE(DocIngest::packByTokens(QStringLiteral("text"), 50, 0, broken, &chunks));
+}
+
+TEST_CASE("parseTokenPieces maps pieces back to character offsets")
+{
+    const QString text = QStringLiteral("Hi 你好😀");
+    // piece 拼接后与原文一致；“好”被拆成两个不完整的 UTF-8 片段，以字节数组返回
+    const QByteArray reply = R"({"tokens":[{"id":1,"piece":"Hi"},{"id":2,"piece":" "},{"id":3,"piece":"你"},)"
+                             R"({"id":4,"piece":[229,165]},{"id":5,"piece":[189]},{"id":6,"piece":"😀"}]})";
+    QVector<int> starts;
+    REQUIRE(DocIngest::parseTokenPieces(reply, text, &starts));
+    CHECK(starts == QVector<int>({0, 2, 3, 4, 4, 5}));
+
+    // 旧版服务端只返回 token id
+    CHECK_FALSE(DocIngest::parseTokenPieces(QByteArray(R"({"tokens":[1,2,3]})"), text, &starts));
+    CHECK_FALSE(DocIngest::parseTokenPieces(QByteArray("not json"), text, &starts));
+}
+
+TEST_CASE("offset token counter counts tokens overlapping a range")
+{
+    // 4 个 token：[0,3) [3,5) [5,9) [9,10)
+    const DocIngest::RangeTokenCounter counter = DocIngest::makeOffsetTokenCounter({0, 3, 5, 9});
+    CHECK(counter(0, 10) == 4);
+    CHECK(counter(3, 9) == 2);
+    CHECK(counter(4, 6) == 2); // 两端都落在 token 内部，跨边界的 token 都计入
+    CHECK(counter(5, 5) == 0);
+    CHECK(DocIngest::makeOffsetTokenCounter({})(0, 10) == 0);
+}
+
+TEST_CASE("packByTokenRanges packs with a whole-document tokenization")
+{
+    QString markdown = QStringLiteral("# Title\n");
+    for (int i = 0; i < 40; ++i) markdown += QStringLiteral("Sentence number %1 is here. ").arg(i);
+    // 以字边界模拟整篇分词结果
+    QVector<int> starts;
+    const QVector<int> bounds = DocIngest::tokenBoundaries(markdown);
+    for (int k = 0; k + 1 < bounds.size(); ++k) starts.append(bounds.at(k));
+    QStringList chunks;
+    REQUIRE(DocIngest::packByTokenRanges(markdown, 30, 0, DocIngest::makeOffsetTokenCounter(starts), &chunks));
+    REQUIRE(chunks.size() > 2);
+    CHECK(chunks.join(QString()) == markdown);
+    for (const QString &chunk : chunks) CHECK(DocIngest::tokenBoundaries(chunk).size() - 1 <= 30);
+}
+
+TEST_CASE("DocIngestPipeline delivers files in order and finishes")
+{
+    ensureQtApp();
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    QStringList paths;
+    for (int i = 0; i < 6; ++i)
+    {
+        const QString path = QDir(dir.path()).filePath(QStringLiteral("doc%1.txt").arg(i));
+        writeText(path, QStringLiteral("file %1 body text").arg(i));
+        paths << path;
+    }
+    paths << QDir(dir.path()).filePath(QStringLiteral("missing.txt"));
+
+    DocIngestPipeline pipeline;
+    QStringList parsedOrder;
+    int failed = 0;
+    bool done = false;
+    bool wasCanceled = true;
+    int chunkTotal = -1;
+    QObject::connect(&pipeline, &DocIngestPipeline::fileParsed, [&](const QString &path, const QStringList &, const QStringList &, bool ok)
+                     {
+                         parsedOrder << path;
+                         if (!ok) ++failed; });
+    QEventLoop loop;
+    QObject::connect(&pipeline, &DocIngestPipeline::finished, [&](bool canceled, int chunks)
+                     {
+                         done = true;
+                         wasCanceled = canceled;
+                         chunkTotal = chunks;
+                         loop.quit(); });
+    QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+    pipeline.start(paths, 300, 20);
+    loop.exec();
+
+    REQUIRE(done);
+    CHECK_FALSE(wasCanceled);
+    CHECK(parsedOrder == paths);
+    CHECK(failed == 1);
+    CHECK(chunkTotal == 6);
+    CHECK_FALSE(pipeline.isRunning());
+}
+
+TEST_CASE("DocIngestPipeline bounds in-flight files and can be canceled mid-run")
+{
+    ensureQtApp();
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    QStringList paths;
+    for (int i = 0; i < 64; ++i)
+    {
+        const QString path = QDir(dir.path()).filePath(QStringLiteral("doc%1.txt").arg(i));
+        writeText(path, QStringLiteral("file %1 body text").arg(i));
+        paths << path;
+    }
+
+    DocIngestPipeline pipeline;
+    QStringList parsedOrder;
+    int maxInFlight = 0;
+    QObject::connect(&pipeline, &DocIngestPipeline::fileParsed, [&](const QString &path, const QStringList &, const QStringList &, bool)
+                     {
+                         parsedOrder << path;
+                         maxInFlight = qMax(maxInFlight, pipeline.inFlight()); });
+    QEventLoop loop;
+    bool wasCanceled = true;
+    QObject::connect(&pipeline, &DocIngestPipeline::finished, [&](bool canceled, int)
+                     {
+                         wasCanceled = canceled;
+                         loop.quit(); });
+    QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+    pipeline.start(paths, 300, 20);
+    CHECK(pipeline.inFlight() <= pipeline.maxWorkers() * 2);
+    loop.exec();
+    CHECK_FALSE(wasCanceled);
+    CHECK(parsedOrder == paths);
+    CHECK(maxInFlight <= pipeline.maxWorkers() * 2);
+
+    // 交付第 3 个文件时取消：之后不再有文件交付，finished 报告已取消
+    parsedOrder.clear();
+    QObject::disconnect(&pipeline, &DocIngestPipeline::fileParsed, nullptr, nullptr);
+    QObject::connect(&pipeline, &DocIngestPipeline::fileParsed, [&](const QString &path, const QStringList &, const QStringList &, bool)
+                     {
+                         parsedOrder << path;
+                         if (parsedOrder.size() == 3) pipeline.cancel(); });
+    wasCanceled = false;
+    QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+    pipeline.start(paths, 300, 20);
+    loop.exec();
+    CHECK(wasCanceled);
+    CHECK(parsedOrder.size() == 3);
+    CHECK_FALSE(pipeline.isRunning());
+    CHECK(pipeline.inFlight() <= pipeline.maxWorkers() * 2);
+
+    // 取消后遗留的在途结果不会混入后续批次
+    QEventLoop drain;
+    QTimer::singleShot(200, &drain, &QEventLoop::quit);
+    drain.exec();
+    CHECK(parsedOrder.size() == 3);
+}
@@ -0,0 +1,134 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <QJsonObject>
+#include <QStringLiteral>
+
+#include "net/control_outbox.h"
+
+namespace
+{
+QJsonObject streamFrame(const QString &text, const QString &role = QStringLiteral("assistant"))
+{
+    QJsonObject obj;
+    obj.insert(QStringLiteral("type"), QStringLiteral("output"));
+    obj.insert(QStringLiteral("text"), text);
+    obj.insert(QStringLiteral("stream"), true);
+    obj.insert(QStringLiteral("role"), role);
+    return obj;
+}
+
+QJsonObject typed(const QString &type)
+{
+    QJsonObject obj;
+    obj.insert(QStringLiteral("type"), type);
+    return obj;
+}
+} // namespace
+
+TEST_CASE("classify maps protocol frame types to backpressure classes")
+{
+    CHECK(ControlOutbox::classify(streamFrame(QStringLiteral("a"))) == ControlOutbox::FrameClass::Stream);
+    CHECK(ControlOutbox::classify(typed(QStringLiteral("record_update"))) == ControlOutbox::FrameClass::Stream);
+    CHECK(ControlOutbox::classify(typed(QStringLiteral("monitor"))) == ControlOutbox::FrameClass::Latest);
+    CHECK(ControlOutbox::classify(typed(QStringLiteral("snapshot"))) == ControlOutbox::FrameClass::Snapshot);
+    CHECK(ControlOutbox::classify(typed(QStringLiteral("state_log"))) == ControlOutbox::FrameClass::Log);
+    CHECK(ControlOutbox::classify(typed(QStringLiteral("hello_ack"))) == ControlOutbox::FrameClass::Control);
+}
+
+TEST_CASE("consecutive stream frames coalesce at the tail only")
+{
+    ControlOutbox box;
+    box.enqueue(streamFrame(QStringLiteral("Hel")));
+    box.enqueue(streamFrame(QStringLiteral("lo")));
+    CHECK(box.size() == 1);
+    box.enqueue(typed(QStringLiteral("state_log")));
+    box.enqueue(streamFrame(QStringLiteral("!")));
+    box.enqueue(streamFrame(QStringLiteral("?"), QStringLiteral("think")));
+    REQUIRE(box.size() == 4);
+    CHECK(box.takeFirst().value(QStringLiteral("text")).toString() == QStringLiteral("Hello"));
+    CHECK(box.takeFirst().value(QStringLiteral("type")).toString() == QStringLiteral("state_log"));
+    CHECK(box.takeFirst().value(QStringLiteral("text")).toString() == QStringLiteral("!"));
+    CHECK(box.takeFirst().value(QStringLiteral("role")).toString() == QStringLiteral("think"));
+    CHECK(box.isEmpty());
+    CHECK(box.pendingBytes() == 0);
+}
+
+TEST_CASE("latest-value frames keep only the newest copy")
+{
+    ControlOutbox box;
+    QJsonObject kv = typed(QStringLiteral("kv"));
+    kv.insert(QStringLiteral("used"), 1);
+    box.enqueue(kv);
+    box.enqueue(typed(QStringLiteral("record_clear")));
+    kv.insert(QStringLiteral("used"), 2);
+    box.enqueue(kv);
+    REQUIRE(box.size() == 2);
+    CHECK(box.takeFirst().value(QStringLiteral("type")).toString() == QStringLiteral("record_clear"));
+    CHECK(box.takeFirst().value(QStringLiteral("used")).toInt() == 2);
+}
+
+TEST_CASE("snapshot supersedes queued state but keeps control frames")
+{
+    ControlOutbox box;
+    box.enqueue(typed(QStringLiteral("hello_ack")));
+    box.enqueue(streamFrame(QStringLiteral("x")));
+    box.enqueue(typed(QStringLiteral("record_add")));
+    box.enqueue(typed(QStringLiteral("snapshot")));
+    REQUIRE(box.size() == 2);
+    CHECK(box.takeFirst().value(QStringLiteral("type")).toString() == QStringLiteral("hello_ack"));
+    CHECK(box.takeFirst().value(QStringLiteral("type")).toString() == QStringLiteral("snapshot"));
+}
+
+TEST_CASE("overflow drops state frames and waits for a resync snapshot")
+{
+    ControlOutbox box;
+    box.setLimits(3, 1024 * 1024);
+    box.enqueue(typed(QStringLiteral("released")));
+    box.enqueue(typed(QStringLiteral("state_log")));
+    box.enqueue(typed(QStringLiteral("record_add")));
+    box.enqueue(typed(QStringLiteral("record_clear")));
+    CHECK(box.needsResync());
+    CHECK(box.size() == 1);
+    CHECK(box.droppedFrames() >= 3);
+
+    // 等待快照期间状态帧直接丢弃，控制帧照常入队
+    box.enqueue(streamFrame(QStringLiteral("late")));
+    box.enqueue(typed(QStringLiteral("reject")));
+    CHECK(box.size() == 2);
+
+    box.enqueue(typed(QStringLiteral("snapshot")));
+    CHECK_FALSE(box.needsResync());
+    CHECK(box.size() == 3);
+}
+
+TEST_CASE("byte budget bounds a slow peer's stream backlog")
+{
+    ControlOutbox box;
+    box.setLimits(1000, 4096);
+    const QString chunk(256, QLatin1Char('a'));
+    for (int i = 0; i < 64; ++i) box.enqueue(streamFrame(chunk));
+    CHECK(box.needsResync());
+    CHECK(box.pendingBytes() <= 4096);
+}
+
+TEST_CASE("snapshot larger than the byte budget is still delivered")
+{
+    ControlOutbox box;
+    box.setLimits(16, 4096);
+    for (int i = 0; i < 64; ++i) box.enqueue(streamFrame(QString(256, QLatin1Char('a'))));
+    REQUIRE(box.needsResync());
+
+    QJsonObject snapshot = typed(QStringLiteral("snapshot"));
+    snapshot.insert(QStringLiteral("records"), QString(16 * 1024, QLatin1Char('r')));
+    box.enqueue(snapshot);
+    CHECK_FALSE(box.needsResync());
+    REQUIRE(box.size() == 1);
+    CHECK(box.pendingBytes() > 4096);
+
+    // 快照之后的增量仍受预算约束
+    box.enqueue(streamFrame(QStringLiteral("next")));
+    CHECK_FALSE(box.needsResync());
+    CHECK(box.size() == 2);
+    CHECK(box.takeFirst().value(QStringLiteral("type")).toString() == QStringLiteral("snapshot"));
+}
@@ -0,0 +1,237 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+
+#include "service/net/embedding_client.h"
+
+namespace
+{
+QCoreApplication *ensureQtApp()
+{
+    static int argc = 0;
+    static char **argv = nullptr;
+    static QCoreApplication app(argc, argv);
+    return &app;
+}
+
+// 极简 /v1/embeddings 服务：支持 keep-alive，统计连接数与请求数
+class FakeEmbeddingServer : public QObject
+{
+  public:
+    FakeEmbeddingServer()
+    {
+        QObject::connect(&server_, &QTcpServer::newConnection, this, [this]()
+                         {
+                             while (QTcpSocket *socket = server_.nextPendingConnection())
+                             {
+                                 ++connections;
+                                 QObject::connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+                             }
+                         });
+        server_.listen(QHostAddress::LocalHost, 0);
+    }
+
+    QString url() const { return QStringLiteral("http://127.0.0.1:%1/v1/embeddings").arg(server_.serverPort()); }
+    QString rerankUrl() const { return QStringLiteral("http://127.0.0.1:%1/v1/rerank").arg(server_.serverPort()); }
+
+    int connections = 0;
+    int requests = 0;
+    QString model = QStringLiteral("bge-m3");
+
+  private:
+    void onReadyRead(QTcpSocket *socket)
+    {
+        QByteArray &buffer = buffers_[socket];
+        buffer += socket->readAll();
+        for (;;)
+        {
+            const int headerEnd = buffer.indexOf("\r\n\r\n");
+            if (headerEnd < 0) return;
+            int contentLength = 0;
+            for (const QByteArray &line : buffer.left(headerEnd).split('\n'))
+            {
+                if (line.trimmed().toLower().startsWith("content-length:")) contentLength = line.mid(line.indexOf(':') + 1).trimmed().toInt();
+            }
+            if (buffer.size() < headerEnd + 4 + contentLength) return;
+            const bool rerank = buffer.startsWith("POST /v1/rerank");
+            const QByteArray body = buffer.mid(headerEnd + 4, contentLength);
+            buffer.remove(0, headerEnd + 4 + contentLength);
+            ++requests;
+
+            QJsonObject root;
+            const QJsonObject request = QJsonDocument::fromJson(body).object();
+            if (rerank)
+            {
+                // 相关度 = 文本段中查询词出现的次数，故意按原顺序返回，由客户端排序
+                const QString query = request.value(QStringLiteral("query")).toString();
+                const QJsonArray documents = request.value(QStringLiteral("documents")).toArray();
+                QJsonArray results;
+                for (int i = 0; i < documents.size(); ++i)
+                {
+                    QJsonObject item;
+                    item.insert(QStringLiteral("index"), i);
+                    item.insert(QStringLiteral("relevance_score"), double(documents.at(i).toString().count(query)));
+                    results.append(item);
+                }
+                root.insert(QStringLiteral("results"), results);
+            }
+            else
+            {
+                // 向量由输入长度决定，便于断言
+                const QString input = request.value(QStringLiteral("input")).toString();
+                QJsonObject item;
+                item.insert(QStringLiteral("embedding"), QJsonArray{double(input.size()), 1.0, 0.5});
+                root.insert(QStringLiteral("model"), model);
+                root.insert(QStringLiteral("data"), QJsonArray{item});
+            }
+            const QByteArray payload = QJsonDocument(root).toJson(QJsonDocument::Compact);
+            socket->write("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: keep-alive\r\nContent-Length: " + QByteArray::number(payload.size()) + "\r\n\r\n" + payload);
+        }
+    }
+
+    QTcpServer server_;
+    QHash<QTcpSocket *, QByteArray> buffers_;
+};
+} // namespace
+
+TEST_CASE("query normalization folds case, whitespace and trailing punctuation")
+{
+    CHECK(QueryVectorCache::normalizeQuery(QStringLiteral("  What is   EVA?  ")) == QStringLiteral("what is eva"));
+    CHECK(QueryVectorCache::normalizeQuery(QStringLiteral("什么是知识库？")) == QStringLiteral("什么是知识库"));
+    CHECK(QueryVectorCache::normalizeQuery(QStringLiteral("\"eva\"")) == QStringLiteral("eva"));
+    CHECK(QueryVectorCache::normalizeQuery(QStringLiteral("???")) == QStringLiteral("???"));
+}
+
+TEST_CASE("query cache evicts least recently used entries and separates models")
+{
+    QueryVectorCache cache(2);
+    cache.insert(QStringLiteral("m"), QStringLiteral("a"), {1.0});
+    cache.insert(QStringLiteral("m"), QStringLiteral("b"), {2.0});
+    std::vector<double> out;
+    REQUIRE(cache.lookup(QStringLiteral("m"), QStringLiteral("A "), &out)); // a 变为最近使用
+    CHECK(out == std::vector<double>{1.0});
+    cache.insert(QStringLiteral("m"), QStringLiteral("c"), {3.0});
+    CHECK(cache.size() == 2);
+    CHECK_FALSE(cache.lookup(QStringLiteral("m"), QStringLiteral("b"), nullptr));
+    CHECK(cache.lookup(QStringLiteral("m"), QStringLiteral("c"), nullptr));
+    CHECK_FALSE(cache.lookup(QStringLiteral("other"), QStringLiteral("a"), nullptr));
+    cache.clear();
+    CHECK(cache.size() == 0);
+}
+
+TEST_CASE("client reuses one connection and serves repeated queries from cache")
+{
+    ensureQtApp();
+    FakeEmbeddingServer server;
+    EmbeddingClient client;
+
+    const EmbeddingClient::Result first = client.query(server.url(), QStringLiteral("sjxx"), QStringLiteral("hello"), 5000);
+    REQUIRE(first.ok);
+    CHECK_FALSE(first.cached);
+    CHECK(first.vector == std::vector<double>{5.0, 1.0, 0.5});
+
+    const EmbeddingClient::Result again = client.query(server.url(), QStringLiteral("sjxx"), QStringLiteral(" Hello "), 5000);
+    REQUIRE(again.ok);
+    CHECK(again.cached);
+    CHECK(again.vector == first.vector);
+    CHECK(server.requests == 1);
+
+    const EmbeddingClient::Result other = client.query(server.url(), QStringLiteral("sjxx"), QStringLiteral("knowledge"), 5000);
+    REQUIRE(other.ok);
+    CHECK_FALSE(other.cached);
+    CHECK(server.requests == 2);
+    CHECK(server.connections == 1); // keep-alive：第二次请求复用同一连接
+
+    // llama-server 回显的 model 字段不代表加载的模型，不影响缓存
+    server.model = QStringLiteral("defult");
+    CHECK(client.query(server.url(), QStringLiteral("sjxx"), QStringLiteral("hello"), 5000).cached);
+}
+
+TEST_CASE("changing the configured model or dimension invalidates cached vectors")
+{
+    ensureQtApp();
+    FakeEmbeddingServer server;
+    EmbeddingClient client;
+    const QString bge = EmbeddingClient::modelKey(server.url(), QStringLiteral("/models/bge-m3.gguf"), 1024);
+    const QString small = EmbeddingClient::modelKey(server.url(), QStringLiteral("/models/bge-small.gguf"), 384);
+
+    REQUIRE(client.query(server.url(), QStringLiteral("sjxx"), QStringLiteral("hello"), 5000, bge).ok);
+    CHECK(client.query(server.url(), QStringLiteral("sjxx"), QStringLiteral("hello"), 5000, bge).cached);
+
+    const EmbeddingClient::Result swapped = client.query(server.url(), QStringLiteral("sjxx"), QStringLiteral("hello"), 5000, small);
+    REQUIRE(swapped.ok);
+    CHECK_FALSE(swapped.cached);
+    CHECK(client.cache().size() == 1);
+    CHECK(client.modelId() == small);
+
+    // 同一模型文件换了维度也视为新模型
+    const QString resized = EmbeddingClient::modelKey(server.url(), QStringLiteral("/models/bge-small.gguf"), 256);
+    CHECK_FALSE(client.query(server.url(), QStringLiteral("sjxx"), QStringLiteral("hello"), 5000, resized).cached);
+    CHECK(server.requests == 3);
+}
+
+TEST_CASE("client reports connection errors with a readable message")
+{
+    ensureQtApp();
+    QTcpServer probe;
+    REQUIRE(probe.listen(QHostAddress::LocalHost, 0));
+    const quint16 port = probe.serverPort();
+    probe.close();
+
+    EmbeddingClient client;
+    const EmbeddingClient::Result result = client.query(QStringLiteral("http://127.0.0.1:%1/v1/embeddings").arg(port), QString(), QStringLiteral("hello"), 5000);
+    CHECK_FALSE(result.ok);
+    CHECK_FALSE(result.error.isEmpty());
+}
+
+TEST_CASE("rerank responses are sorted by relevance and out-of-range indices dropped")
+{
+    const QByteArray body = R"({"results":[{"index":0,"relevance_score":-1.5},{"index":2,"relevance_score":3.25},{"index":7,"relevance_score":9},{"index":1,"relevance_score":0.5}]})";
+    QVector<QPair<int, double>> scores;
+    REQUIRE(EmbeddingClient::parseRerankResponse(body, 3, &scores));
+    REQUIRE(scores.size() == 3);
+    CHECK(scores.at(0).first == 2);
+    CHECK(scores.at(1).first == 1);
+    CHECK(scores.at(2).first == 0);
+    CHECK(scores.at(0).second == doctest::Approx(3.25));
+    CHECK_FALSE(EmbeddingClient::parseRerankResponse(QByteArray("{\"error\":\"no model\"}"), 3, &scores));
+}
+
+TEST_CASE("client reranks candidates over the same connection as embeddings")
+{
+    ensureQtApp();
+    FakeEmbeddingServer server;
+    EmbeddingClient client;
+    REQUIRE(client.query(server.url(), QString(), QStringLiteral("eva"), 5000).ok);
+
+    const QStringList documents{QStringLiteral("nothing here"), QStringLiteral("eva eva"), QStringLiteral("about eva")};
+    const EmbeddingClient::RerankResult result = client.rerank(server.rerankUrl(), QStringLiteral("eva"), documents, 5000);
+    REQUIRE(result.ok);
+    REQUIRE(result.scores.size() == 3);
+    CHECK(result.scores.at(0).first == 1);
+    CHECK(result.scores.at(1).first == 2);
+    CHECK(result.scores.at(2).first == 0);
+    CHECK(server.connections == 1);
+}
+
+TEST_CASE("calls from other threads fail fast once the client thread has stopped")
+{
+    ensureQtApp();
+    QThread stopped; // 从未启动，等同 aboutToQuit 之后已退出的客户端线程
+    EmbeddingClient client;
+    client.moveToThread(&stopped);
+
+    const EmbeddingClient::Result embedded = client.query(QStringLiteral("http://127.0.0.1:1/v1/embeddings"), QString(), QStringLiteral("eva"), 1000);
+    CHECK_FALSE(embedded.ok);
+    CHECK_FALSE(embedded.error.isEmpty());
+    const EmbeddingClient::RerankResult reranked = client.rerank(QStringLiteral("http://127.0.0.1:1/v1/rerank"), QStringLiteral("eva"), QStringList{QStringLiteral("eva")}, 1000);
+    CHECK_FALSE(reranked.ok);
+    CHECK_FALSE(reranked.error.isEmpty());
+}
@@ -0,0 +1,79 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include "service/net/endpoint_pool.h"
+
+namespace
+{
+EndpointPool threeEndpoints()
+{
+    EndpointPool pool;
+    pool.setEndpoints({QStringLiteral("https://a"), QStringLiteral("https://b"), QStringLiteral("https://c")});
+    return pool;
+}
+} // namespace
+
+TEST_CASE("EndpointPool ranks by TTFB and probes unmeasured endpoints first")
+{
+    EndpointPool pool = threeEndpoints();
+    CHECK(pool.ranked(0) == QVector<int>({0, 1, 2}));
+
+    pool.recordSuccess(0, 800);
+    pool.recordSuccess(1, 200);
+    // c 尚未测过，视为最快，先去探测一次
+    CHECK(pool.ranked(0) == QVector<int>({2, 1, 0}));
+}
+
+TEST_CASE("EndpointPool weighs generation speed into the score")
+{
+    EndpointPool pool = threeEndpoints();
+    pool.recordSuccess(0, 800);
+    pool.recordSuccess(1, 200);
+    pool.recordSuccess(2, 100);
+    pool.recordSpeed(0, 200.0); // 800 + 1280
+    pool.recordSpeed(1, 50.0);  // 200 + 5120
+    pool.recordSpeed(2, 25.0);  // 100 + 10240
+    CHECK(pool.score(0) == doctest::Approx(2080.0));
+    CHECK(pool.ranked(0) == QVector<int>({0, 1, 2}));
+}
+
+TEST_CASE("EndpointPool cools down failing endpoints with growing windows")
+{
+    EndpointPool pool = threeEndpoints();
+    pool.recordSuccess(0, 800);
+    pool.recordSuccess(1, 200);
+    pool.recordFailure(2, 1000);
+    CHECK_FALSE(pool.isHealthy(2, 1000));
+    CHECK(pool.ranked(1000) == QVector<int>({1, 0, 2}));
+    CHECK(pool.isHealthy(2, 6000));
+    CHECK(pool.stats(2).errorRate == doctest::Approx(0.2));
+
+    pool.recordFailure(2, 7000);
+    CHECK_FALSE(pool.isHealthy(2, 16999));
+    CHECK(pool.isHealthy(2, 17000));
+
+    pool.recordSuccess(2, 100);
+    CHECK(pool.isHealthy(2, 0));
+    CHECK(pool.stats(2).consecutiveFailures == 0);
+}
+
+TEST_CASE("EndpointPool derives the hedge delay from the TTFB percentile")
+{
+    EndpointPool pool = threeEndpoints();
+    CHECK(pool.hedgeDelayMs(0) == 3000); // 样本不足时使用默认阈值
+    for (int ms = 100; ms <= 1000; ms += 100) pool.recordSuccess(0, ms);
+    CHECK(pool.hedgeDelayMs(0) == 900);
+
+    for (int i = 0; i < 5; ++i) pool.recordSuccess(1, 50);
+    CHECK(pool.hedgeDelayMs(1) == 300); // 下限，避免极快端点每次都触发对冲
+}
+
+TEST_CASE("EndpointPool keeps stats across reconfiguration")
+{
+    EndpointPool pool = threeEndpoints();
+    pool.recordSuccess(1, 200);
+    pool.setEndpoints({QStringLiteral("https://b"), QStringLiteral("https://d")});
+    CHECK(pool.size() == 2);
+    CHECK(pool.stats(0).ttfbMs == doctest::Approx(200.0));
+    CHECK(pool.stats(1).ttfbMs < 0.0);
+}
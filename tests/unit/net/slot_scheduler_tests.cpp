@@ -0,0 +1,96 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include "service/net/slot_scheduler.h"
+
+TEST_CASE("SlotScheduler keeps the foreground slot out of background use")
+{
+    SlotScheduler scheduler;
+    scheduler.configure(4, true);
+    scheduler.setForegroundSlot(2);
+    CHECK(scheduler.capacity() == 3);
+
+    int slot = -1;
+    REQUIRE(scheduler.request(1, QStringLiteral("a"), &slot));
+    CHECK(slot == 0);
+    REQUIRE(scheduler.request(2, QStringLiteral("a"), &slot));
+    CHECK(slot == 1);
+    REQUIRE(scheduler.request(3, QStringLiteral("a"), &slot));
+    CHECK(slot == 3);
+    CHECK_FALSE(scheduler.request(4, QStringLiteral("a"), &slot));
+    CHECK(scheduler.waiting() == 1);
+
+    // 前台 slot 未知时预留 slot 0
+    SlotScheduler fresh;
+    fresh.configure(2, true);
+    REQUIRE(fresh.request(7, QStringLiteral("a"), &slot));
+    CHECK(slot == 1);
+}
+
+TEST_CASE("SlotScheduler has no background capacity on a single-slot backend")
+{
+    SlotScheduler scheduler;
+    scheduler.configure(1, true);
+    CHECK(scheduler.capacity() == 0);
+    int slot = -1;
+    CHECK_FALSE(scheduler.request(1, QStringLiteral("a"), &slot));
+}
+
+TEST_CASE("SlotScheduler rotates released slots across owners")
+{
+    SlotScheduler scheduler;
+    scheduler.configure(2, true); // 1 个后台 slot
+    int slot = -1;
+    REQUIRE(scheduler.request(1, QStringLiteral("busy"), &slot));
+    CHECK_FALSE(scheduler.request(2, QStringLiteral("busy"), &slot));
+    CHECK_FALSE(scheduler.request(3, QStringLiteral("busy"), &slot));
+    CHECK_FALSE(scheduler.request(4, QStringLiteral("quiet"), &slot));
+
+    QVector<SlotScheduler::Grant> grants = scheduler.release(1);
+    REQUIRE(grants.size() == 1);
+    CHECK(grants.first().requestId == 2);
+    CHECK(grants.first().slot == 1);
+
+    // busy 刚被服务过，下一个轮到 quiet，尽管 busy 的请求 3 更早排队
+    grants = scheduler.release(2);
+    REQUIRE(grants.size() == 1);
+    CHECK(grants.first().requestId == 4);
+
+    grants = scheduler.release(4);
+    REQUIRE(grants.size() == 1);
+    CHECK(grants.first().requestId == 3);
+    CHECK(scheduler.release(3).isEmpty());
+    CHECK(scheduler.running() == 0);
+}
+
+TEST_CASE("SlotScheduler cancels queued requests and grows with configure")
+{
+    SlotScheduler scheduler;
+    scheduler.configure(2, true);
+    int slot = -1;
+    REQUIRE(scheduler.request(1, QStringLiteral("a"), &slot));
+    CHECK_FALSE(scheduler.request(2, QStringLiteral("b"), &slot));
+    CHECK_FALSE(scheduler.request(3, QStringLiteral("c"), &slot));
+
+    CHECK(scheduler.release(2).isEmpty()); // 取消排队中的请求不会授予任何东西
+    CHECK(scheduler.waiting() == 1);
+
+    const QVector<SlotScheduler::Grant> grants = scheduler.configure(3, true);
+    REQUIRE(grants.size() == 1);
+    CHECK(grants.first().requestId == 3);
+    CHECK(grants.first().slot == 2);
+}
+
+TEST_CASE("SlotScheduler limits concurrency without pinning for remote APIs")
+{
+    SlotScheduler scheduler;
+    scheduler.configure(3, false);
+    int slot = 99;
+    REQUIRE(scheduler.request(1, QStringLiteral("a"), &slot));
+    CHECK(slot == -1);
+    REQUIRE(scheduler.request(2, QStringLiteral("a"), &slot));
+    CHECK_FALSE(scheduler.request(3, QStringLiteral("a"), &slot));
+    const QVector<SlotScheduler::Grant> grants = scheduler.release(1);
+    REQUIRE(grants.size() == 1);
+    CHECK(grants.first().slot == -1);
+}
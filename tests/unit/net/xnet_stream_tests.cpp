@@ -1,7 +1,10 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest.h>
 
+#include <QCoreApplication>
 #include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
 #include <QVariant>
 
 #include "xnet.h"
@@ -12,6 +15,48 @@ class TestableNet : public xNet
     using xNet::processSsePayload;
 };
 
+namespace
+{
+QCoreApplication *ensureQtApp()
+{
+    static int argc = 0;
+    static char **argv = nullptr;
+    static QCoreApplication app(argc, argv);
+    return &app;
+}
+
+// 收到请求头后回一个固定的 HTTP 响应并断开
+class CannedHttpServer : public QObject
+{
+  public:
+    explicit CannedHttpServer(const QByteArray &response)
+        : response_(response)
+    {
+        QObject::connect(&server_, &QTcpServer::newConnection, this, [this]()
+                         {
+                             while (QTcpSocket *socket = server_.nextPendingConnection())
+                             {
+                                 QObject::connect(socket, &QTcpSocket::readyRead, this, [this, socket]()
+                                                  {
+                                                      buffer_ += socket->readAll();
+                                                      if (!buffer_.contains("\r\n\r\n")) return;
+                                                      socket->write(response_);
+                                                      socket->disconnectFromHost();
+                                                  });
+                             }
+                         });
+        server_.listen(QHostAddress::LocalHost, 0);
+    }
+
+    QString url() const { return QStringLiteral("http://127.0.0.1:%1").arg(server_.serverPort()); }
+
+  private:
+    QTcpServer server_;
+    QByteArray response_;
+    QByteArray buffer_;
+};
+} // namespace
+
 TEST_CASE("processSsePayload streams reasoning content and closes think blocks")
 {
     TestableNet net;
@@ -62,3 +107,28 @@ TEST_CASE("processSsePayload derives prompt baselines and timings for completion
     CHECK(totals.at(1).toInt() == 2);
     CHECK(totals.at(2).toInt() == 4);
 }
+
+TEST_CASE("an HTTP error body is not a first byte and is reported as a failure")
+{
+    ensureQtApp();
+    const QByteArray body = R"({"error":{"message":"model not found"}})";
+    CannedHttpServer server("HTTP/1.1 400 Bad Request\r\nContent-Type: application/json\r\nContent-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body);
+
+    xNet net;
+    net.apis.api_endpoint = server.url();
+    net.endpoint_data.is_complete_state = false;
+    net.endpoint_data.n_predict = 16;
+    QSignalSpy firstByteSpy(&net, &xNet::net2ui_first_byte);
+    QStringList errors;
+    QObject::connect(&net, &xNet::net2ui_state, [&errors](const QString &line, SIGNAL_STATE state)
+                     { if (state == WRONG_SIGNAL) errors << line; });
+    QSignalSpy pushoverSpy(&net, &xNet::net2ui_pushover);
+    net.run();
+    REQUIRE(pushoverSpy.wait(10000));
+
+    // 对冲竞速以首包定胜负，错误响应不能抢先胜出
+    CHECK(firstByteSpy.isEmpty());
+    REQUIRE(errors.size() == 1);
+    CHECK(errors.first().contains(QStringLiteral("http 400")));
+    CHECK(errors.first().contains(QStringLiteral("model not found")));
+}
@@ -0,0 +1,202 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include "core/replay/agent_replay.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QTemporaryDir>
+#include <QTimer>
+
+namespace
+{
+QCoreApplication *ensureQtApp()
+{
+    static int argc = 0;
+    static char **argv = nullptr;
+    static QCoreApplication app(argc, argv);
+    return &app;
+}
+
+RequestSnapshot snapshotWithPrompt(const QString &prompt)
+{
+    RequestSnapshot snapshot;
+    snapshot.endpoint.tool_call_mode = TOOL_CALL_TEXT;
+    snapshot.endpoint.messagesArray = QJsonArray{
+        QJsonObject{{QStringLiteral("role"), QStringLiteral(DEFAULT_SYSTEM_NAME)}, {QStringLiteral("content"), QStringLiteral("sys")}},
+        QJsonObject{{QStringLiteral("role"), QStringLiteral(DEFAULT_USER_NAME)}, {QStringLiteral("content"), prompt}},
+    };
+    return snapshot;
+}
+} // namespace
+
+TEST_CASE("AgentTapeRecorder writes a tape that AgentTape loads back in order")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("tapes/session.jsonl"));
+    {
+        AgentTapeRecorder recorder(path);
+        REQUIRE(recorder.isOpen());
+        recorder.recordSend(snapshotWithPrompt(QStringLiteral("compute 1+1")));
+        recorder.recordOutput(QStringLiteral("<tool_call>{\"name\":\"calculator\","));
+        recorder.recordOutput(QStringLiteral("\"arguments\":{\"expression\":\"1+1\"}}</tool_call>"));
+        recorder.recordPushover();
+        mcp::json call;
+        call["name"] = "calculator";
+        call["arguments"] = {{"expression", "1+1"}};
+        recorder.recordToolExec(call);
+        recorder.recordToolResult(QStringLiteral("2"));
+        recorder.recordSend(snapshotWithPrompt(QStringLiteral("ignored")));
+        recorder.recordOutput(QStringLiteral("The answer is 2."));
+        recorder.recordPushover();
+        // 没有对应请求的 pushover 不落盘
+        recorder.recordPushover();
+    }
+
+    AgentTape tape;
+    QString error;
+    REQUIRE(AgentTape::load(path, &tape, &error));
+    CHECK(tape.prompt == QStringLiteral("compute 1+1"));
+    CHECK(tape.toolCallMode == TOOL_CALL_TEXT);
+    REQUIRE(tape.model.size() == 2);
+    CHECK(tape.model.at(0).chunks.size() == 2);
+    CHECK(tape.model.at(1).chunks == QStringList{QStringLiteral("The answer is 2.")});
+    REQUIRE(tape.tools.size() == 1);
+    CHECK(tape.tools.at(0).name == QStringLiteral("calculator"));
+    CHECK(tape.tools.at(0).arguments.value(QStringLiteral("expression")).toString() == QStringLiteral("1+1"));
+    CHECK(tape.tools.at(0).result == QStringLiteral("2"));
+}
+
+TEST_CASE("AgentTape rejects malformed or empty tapes")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("bad.jsonl"));
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write("{\"type\":\"session\",\"prompt\":\"hi\"}\n{\"type\":\"bogus\"}\n");
+    file.close();
+
+    QString error;
+    CHECK_FALSE(AgentTape::load(path, nullptr, &error));
+    CHECK(error.contains(QStringLiteral("line 2")));
+    CHECK_FALSE(AgentTape::load(dir.filePath(QStringLiteral("missing.jsonl")), nullptr, &error));
+}
+
+TEST_CASE("AgentStageProfiler splits a tool turn into build/net/parse/tool stages")
+{
+    AgentStageProfiler profiler;
+    int finished = 0;
+    QObject::connect(&profiler, &AgentStageProfiler::turnFinished, [&finished]()
+                     { ++finished; });
+
+    profiler.markAt(FlowPhase::Start, 0.0);
+    profiler.markAt(FlowPhase::NetRequest, 2.0);
+    profiler.markAt(FlowPhase::NetDone, 5.0);
+    profiler.markAt(FlowPhase::ToolParsed, 5.5);
+    profiler.markAt(FlowPhase::ToolStart, 6.0);
+    profiler.markAt(FlowPhase::ToolResult, 10.0);
+    profiler.markAt(FlowPhase::ContinueTurn, 10.0);
+    profiler.markAt(FlowPhase::Start, 10.5); // 工具续轮的 Start 不重新开回合
+    profiler.markAt(FlowPhase::NetRequest, 11.0);
+    profiler.markAt(FlowPhase::NetDone, 14.0);
+    profiler.markAt(FlowPhase::Finish, 15.0);
+    profiler.markAt(FlowPhase::Finish, 20.0); // 重置时的重复 Finish 被忽略
+
+    CHECK(finished == 1);
+    CHECK(profiler.turns() == 1);
+    CHECK(profiler.samples(QStringLiteral("build")) == QVector<double>{2.0, 1.0});
+    CHECK(profiler.samples(QStringLiteral("net")) == QVector<double>{3.0, 3.0});
+    CHECK(profiler.samples(QStringLiteral("parse")) == QVector<double>{1.0, 1.0});
+    CHECK(profiler.samples(QStringLiteral("tool")) == QVector<double>{4.0});
+
+    const QJsonObject report = profiler.report();
+    CHECK(report.value(QStringLiteral("turn_ms")).toObject().value(QStringLiteral("max")).toDouble() == doctest::Approx(15.0));
+    CHECK(report.value(QStringLiteral("stages")).toObject().value(QStringLiteral("net")).toObject().value(QStringLiteral("total")).toDouble() == doctest::Approx(6.0));
+}
+
+TEST_CASE("AgentReplay answers requests from the tape and reports divergences")
+{
+    ensureQtApp(); // 看门狗定时器需要事件分发器
+    AgentTape tape;
+    tape.prompt = QStringLiteral("compute");
+    tape.model = {{{QStringLiteral("a"), QStringLiteral("b")}, QString()}, {{QStringLiteral("done")}, QString()}};
+    tape.tools = {{QStringLiteral("calculator"), QJsonObject(), QStringLiteral("2")}};
+
+    AgentReplay replay(tape);
+    QStringList outputs;
+    QStringList toolResults;
+    int pushovers = 0;
+    QObject::connect(&replay, &AgentReplay::net2ui_output, [&outputs](const QString &text, bool, QColor)
+                     { outputs << text; });
+    QObject::connect(&replay, &AgentReplay::net2ui_pushover, [&pushovers]()
+                     { ++pushovers; });
+    QObject::connect(&replay, &AgentReplay::tool2ui_pushover, [&toolResults](const QString &result)
+                     { toolResults << result; });
+
+    replay.send(RequestSnapshot());
+    CHECK(outputs == QStringList{QStringLiteral("a"), QStringLiteral("b")});
+    CHECK(pushovers == 1);
+
+    mcp::json call;
+    call["name"] = "calculator";
+    replay.exec(call);
+    CHECK(toolResults == QStringList{QStringLiteral("2")});
+    CHECK_FALSE(replay.diverged());
+
+    // 录制时没有的工具调用：仍然回一个结果让回环继续，但记为偏离
+    call["name"] = "execute_command";
+    replay.exec(call);
+    CHECK(replay.diverged());
+    CHECK(toolResults.last().contains(QStringLiteral("execute_command")));
+
+    const QJsonObject report = replay.report();
+    CHECK(report.value(QStringLiteral("model_turns")).toObject().value(QStringLiteral("replayed")).toInt() == 1);
+    CHECK(report.value(QStringLiteral("tool_steps")).toObject().value(QStringLiteral("replayed")).toInt() == 2);
+    CHECK(report.value(QStringLiteral("divergences")).toArray().size() == 1);
+}
+
+TEST_CASE("AgentReplay watchdog reports the stuck turn when Finish never arrives")
+{
+    ensureQtApp();
+    AgentTape tape;
+    tape.model = {{{QStringLiteral("calling")}, QStringLiteral("{\"name\":\"schedule_task\"}")}, {{QStringLiteral("done")}, QString()}};
+    tape.tools = {{QStringLiteral("schedule_task"), QJsonObject(), QStringLiteral("ok")}};
+
+    AgentReplay replay(tape);
+    replay.setIdleTimeoutMs(50);
+    replay.profiler()->mark(FlowPhase::Start);
+    replay.profiler()->mark(FlowPhase::NetRequest);
+    replay.send(RequestSnapshot());
+    replay.profiler()->mark(FlowPhase::NetDone);
+    replay.profiler()->mark(FlowPhase::ToolStart);
+    mcp::json call;
+    call["name"] = "schedule_task";
+    replay.exec(call);
+
+    // 工具返回后回合既没有继续也没有打出 Finish：看门狗应结束回放而不是一直等
+    QEventLoop loop;
+    bool finished = false;
+    QObject::connect(&replay, &AgentReplay::finished, &loop, [&]()
+                     { finished = true; loop.quit(); });
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    REQUIRE(finished);
+    CHECK(replay.stalled());
+    CHECK(replay.diverged());
+    CHECK(replay.stallReason().contains(QStringLiteral("turn 1 stalled in tool")));
+    CHECK(replay.stallReason().contains(QStringLiteral("model turns 1/2")));
+    CHECK(replay.report().value(QStringLiteral("stalled")).toBool());
+
+    // 卡住之后迟到的 Finish 不再重复收尾
+    int extra = 0;
+    QObject::connect(&replay, &AgentReplay::finished, [&extra]()
+                     { ++extra; });
+    replay.profiler()->mark(FlowPhase::Finish);
+    QCoreApplication::processEvents();
+    CHECK(extra == 0);
+}
@@ -0,0 +1,73 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include "expend/eval_suite.h"
+
+TEST_CASE("EvalSuite judges multiple-choice answers outside the reasoning block")
+{
+    CHECK(EvalSuite::parseChoice(QStringLiteral(" b) ")) == QChar('B'));
+    CHECK(EvalSuite::parseChoice(QString()).isNull());
+    CHECK(EvalSuite::parseChoice(QStringLiteral("xyz")).isNull());
+
+    const QString raw = QStringLiteral("<think>maybe A</think>C");
+    CHECK(EvalSuite::stripReasoning(raw) == QStringLiteral("C"));
+    CHECK(EvalSuite::judgeChoice(EvalSuite::stripReasoning(raw), QChar('c')));
+    CHECK_FALSE(EvalSuite::judgeChoice(EvalSuite::stripReasoning(raw), QChar('a')));
+    // 未闭合的思考段一直删到末尾
+    CHECK(EvalSuite::stripReasoning(QStringLiteral("D<think>still thinking")) == QStringLiteral("D"));
+}
+
+TEST_CASE("EvalSuite extracts the tool name from the first tool_call block")
+{
+    QString json;
+    const QString ok = QStringLiteral("sure <tool_call>\n{\"name\":\"calculator\",\"arguments\":{\"expression\":\"1+1\"}}\n</tool_call>");
+    CHECK(EvalSuite::toolCallName(ok, &json) == QStringLiteral("calculator"));
+    CHECK(json.startsWith(QLatin1Char('{')));
+
+    json.clear();
+    CHECK(EvalSuite::toolCallName(QStringLiteral("<tool_call>{broken</tool_call>"), &json).isEmpty());
+    CHECK(json == QStringLiteral("{broken"));
+    CHECK(EvalSuite::toolCallName(QStringLiteral("no call here")).isEmpty());
+}
+
+TEST_CASE("EvalSuite scores match the evaluation tab rubric")
+{
+    CHECK(EvalSuite::scoreTtfb(-1.0) == doctest::Approx(0.0));
+    CHECK(EvalSuite::scoreTtfb(400.0) == doctest::Approx(100.0));
+    CHECK(EvalSuite::scoreTtfb(5250.0) == doctest::Approx(50.0));
+    CHECK(EvalSuite::scoreTtfb(12000.0) == doctest::Approx(0.0));
+    CHECK(EvalSuite::scoreGen(42.0) == doctest::Approx(42.0));
+    CHECK(EvalSuite::scoreGen(250.0) == doctest::Approx(100.0));
+
+    CHECK(EvalSuite::syncRate(500.0, 100.0, 100.0, 100.0, 100.0) == doctest::Approx(100.0));
+    // 首包与生成缺失时只剩三项正确率：0.2*50 + 0.2*50 + 0.3*50
+    CHECK(EvalSuite::syncRate(-1.0, -1.0, 50.0, 50.0, 50.0) == doctest::Approx(35.0));
+}
+
+TEST_CASE("EvalSuite summarizes samples with nearest-rank percentiles")
+{
+    const EvalSuite::Summary empty = EvalSuite::summarize({});
+    CHECK(empty.count == 0);
+
+    const EvalSuite::Summary s = EvalSuite::summarize({7, 3, 10, 1, 9, 2, 8, 4, 6, 5});
+    CHECK(s.count == 10);
+    CHECK(s.min == doctest::Approx(1.0));
+    CHECK(s.max == doctest::Approx(10.0));
+    CHECK(s.mean == doctest::Approx(5.5));
+    CHECK(s.p50 == doctest::Approx(5.0));
+    CHECK(s.p90 == doctest::Approx(9.0));
+    CHECK(s.p99 == doctest::Approx(10.0));
+
+    const EvalSuite::Summary one = EvalSuite::summarize({42.0});
+    CHECK(one.p50 == doctest::Approx(42.0));
+    CHECK(one.p99 == doctest::Approx(42.0));
+}
+
+TEST_CASE("EvalSuite keeps the question tables the evaluation tab relies on")
+{
+    CHECK(EvalSuite::qaItems().size() == 5);
+    CHECK(EvalSuite::logicItems().size() == 5);
+    CHECK(EvalSuite::toolCases().size() == 12);
+    CHECK(EvalSuite::latencyUserPrompt().size() == 1024);
+    CHECK(EvalSuite::toolTask(QStringLiteral("Compute 1+1.")).startsWith(QStringLiteral("Compute 1+1. Strictly")));
+}
@@ -0,0 +1,179 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QUrl>
+
+#include "core/session/token_budget.h"
+
+namespace
+{
+TokenBudget::Limits limits32k()
+{
+    TokenBudget::Limits limits;
+    limits.contextCap = 32768;
+    limits.reserveOutput = 1024;
+    limits.triggerRatio = 0.85;
+    limits.reserveTokens = 2000;
+    limits.minToolOutput = 512;
+    return limits;
+}
+} // namespace
+
+TEST_CASE("estimateTokens counts ASCII by thirds and CJK per character")
+{
+    CHECK(TokenBudget::estimateTokens(QString()) == 0);
+    CHECK(TokenBudget::estimateTokens(QStringLiteral("abc")) == 1);
+    CHECK(TokenBudget::estimateTokens(QStringLiteral("abcdefg")) == 3);
+    CHECK(TokenBudget::estimateTokens(QStringLiteral("同步率")) == 3);
+    // 代理对（Emoji）只计一次
+    CHECK(TokenBudget::estimateTokens(QString::fromUtf8("\xF0\x9F\x98\x80")) == 1);
+}
+
+TEST_CASE("plan leaves a prompt that fits untouched")
+{
+    TokenBudget::Sections sections;
+    sections.system = 800;
+    sections.tools = 3000;
+    sections.history = 9000;
+    const TokenBudget::Plan plan = TokenBudget::plan(sections, limits32k());
+    CHECK(plan.fits());
+    CHECK_FALSE(plan.compact);
+    CHECK_FALSE(plan.dropAttachments);
+    CHECK(plan.toolOutputKeep == -1);
+    CHECK(plan.projected == sections.total());
+    CHECK(plan.hardLimit == 32768 - 1024);
+    CHECK(plan.softLimit == 27852);
+}
+
+TEST_CASE("plan compacts history before the request overflows")
+{
+    TokenBudget::Sections sections;
+    sections.system = 800;
+    sections.history = 20000;
+    sections.attachments = 9000; // 新附带的文档把总量推过 soft 上限
+    TokenBudget::Limits limits = limits32k();
+    limits.canCompact = true;
+    limits.compactableHistory = 16000;
+    limits.summaryTokens = 2000;
+    limits.droppableAttachments = 9000;
+    const TokenBudget::Plan plan = TokenBudget::plan(sections, limits);
+    CHECK(plan.compact);
+    CHECK_FALSE(plan.dropAttachments);
+    CHECK(plan.projected == sections.total() - 14000);
+    CHECK(plan.fits());
+
+    // 不允许压缩（如工具循环中）时只能丢弃文档
+    limits.canCompact = false;
+    sections.history = 25000;
+    const TokenBudget::Plan noCompact = TokenBudget::plan(sections, limits);
+    CHECK_FALSE(noCompact.compact);
+    CHECK(noCompact.dropAttachments);
+    CHECK(noCompact.projected == 25800);
+}
+
+TEST_CASE("plan skips compaction that would not save enough")
+{
+    TokenBudget::Sections sections;
+    sections.history = 29000;
+    TokenBudget::Limits limits = limits32k();
+    limits.canCompact = true;
+    limits.compactableHistory = 3000; // 大部分内容在保留的尾部消息里
+    limits.summaryTokens = 2000;
+    const TokenBudget::Plan plan = TokenBudget::plan(sections, limits);
+    CHECK_FALSE(plan.compact);
+    CHECK(plan.fits());
+}
+
+TEST_CASE("plan truncates oversized tool output but keeps a floor")
+{
+    TokenBudget::Sections sections;
+    sections.system = 1000;
+    sections.history = 10000;
+    sections.toolOutput = 40000;
+    const TokenBudget::Plan plan = TokenBudget::plan(sections, limits32k());
+    CHECK(plan.toolOutputKeep == plan.hardLimit - 11000);
+    CHECK(plan.projected == plan.hardLimit);
+    CHECK(plan.fits());
+
+    sections.history = 40000;
+    const TokenBudget::Plan over = TokenBudget::plan(sections, limits32k());
+    CHECK(over.toolOutputKeep == 512);
+    CHECK_FALSE(over.fits());
+    CHECK(over.describe().contains(QStringLiteral("still over")));
+}
+
+TEST_CASE("plan does nothing when n_ctx is unknown")
+{
+    TokenBudget::Sections sections;
+    sections.history = 1000000;
+    TokenBudget::Limits limits;
+    const TokenBudget::Plan plan = TokenBudget::plan(sections, limits);
+    CHECK(plan.fits());
+    CHECK(plan.describe().contains(QStringLiteral("n_ctx unknown")));
+}
+
+TEST_CASE("truncateMiddle keeps head and tail proportionally")
+{
+    QString text;
+    for (int i = 0; i < 300; ++i) text += QStringLiteral("line %1\n").arg(i, 3, 10, QLatin1Char('0'));
+    const QString cut = TokenBudget::truncateMiddle(text, 1000, 100);
+    CHECK(cut.size() < text.size() / 5);
+    CHECK(cut.startsWith(QStringLiteral("line 000")));
+    CHECK(cut.endsWith(QStringLiteral("line 299\n")));
+    CHECK(cut.contains(QStringLiteral("truncated")));
+    CHECK(TokenBudget::truncateMiddle(text, 1000, 1000) == text);
+}
+
+TEST_CASE("TokenCounter falls back to the heuristic without an endpoint")
+{
+    TokenCounter counter;
+    bool exact = true;
+    const QString text = QString(900, QLatin1Char('x'));
+    CHECK(counter.count(text, &exact) == 300);
+    CHECK_FALSE(exact);
+    CHECK(counter.cachedEntries() == 0);
+    CHECK(TokenCounter::keyFor(text) == TokenCounter::keyFor(QString(900, QLatin1Char('x'))));
+    CHECK(TokenCounter::keyFor(text) != TokenCounter::keyFor(text + QLatin1Char('x')));
+
+    // 短文本即使有端点也直接估算，不发请求
+    counter.setEndpoint(QUrl(QStringLiteral("http://127.0.0.1:9/tokenize")), QStringLiteral("model.gguf"));
+    CHECK(counter.count(QStringLiteral("hello"), &exact) == 2);
+    CHECK_FALSE(exact);
+}
+
+TEST_CASE("TokenCounter backs off after a failed request and recovers on reset")
+{
+    static int argc = 0;
+    static char **argv = nullptr;
+    static QCoreApplication app(argc, argv);
+
+    // 取一个刚释放的端口：连接会被立即拒绝
+    QTcpServer probe;
+    REQUIRE(probe.listen(QHostAddress::LocalHost, 0));
+    const quint16 port = probe.serverPort();
+    probe.close();
+
+    TokenCounter counter;
+    counter.setEndpoint(QUrl(QStringLiteral("http://127.0.0.1:%1/tokenize").arg(port)), QStringLiteral("model.gguf"));
+    const QString text(600, QLatin1Char('y'));
+    bool exact = true;
+    CHECK(counter.count(text, &exact) == 200);
+    CHECK_FALSE(exact);
+    QElapsedTimer timer;
+    timer.start();
+    while (!counter.backingOff() && timer.elapsed() < 5000) QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+    CHECK(counter.backingOff());
+
+    // 后端重启后立即恢复请求；换端点同样清除退避
+    counter.resetBackoff();
+    CHECK_FALSE(counter.backingOff());
+    counter.count(text, &exact);
+    timer.restart();
+    while (!counter.backingOff() && timer.elapsed() < 5000) QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+    CHECK(counter.backingOff());
+    counter.setEndpoint(QUrl(QStringLiteral("http://127.0.0.1:%1/tokenize").arg(port)), QStringLiteral("other.gguf"));
+    CHECK_FALSE(counter.backingOff());
+}
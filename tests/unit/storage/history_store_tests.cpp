@@ -1,18 +1,32 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest.h>
 
+#include <QCoreApplication>
 #include <QDate>
 #include <QDateTime>
+#include <QDir>
+#include <QFile>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QTemporaryDir>
+#include <QThread>
 #include <QTime>
 #include <QVector>
 
 #include "storage/history_store.h"
+#include "storage/history_writer.h"
 
 namespace
 {
+// HistoryWriter 的写入线程需要事件循环
+QCoreApplication *ensureQtApp()
+{
+    static int argc = 0;
+    static char **argv = nullptr;
+    static QCoreApplication app(argc, argv);
+    return &app;
+}
+
 SessionMeta makeMeta(const QString &id, const QDateTime &startedAt)
 {
     SessionMeta meta;
@@ -28,6 +42,7 @@ SessionMeta makeMeta(const QString &id, const QDateTime &startedAt)
 
 TEST_CASE("HistoryStore begin/append/resume persists metadata and messages")
 {
+    ensureQtApp();
     QTemporaryDir dir;
     REQUIRE(dir.isValid());
 
@@ -58,6 +73,7 @@ TEST_CASE("HistoryStore begin/append/resume persists metadata and messages")
 
 TEST_CASE("HistoryStore rewrite, list, rename and purge sessions")
 {
+    ensureQtApp();
     QTemporaryDir dir;
     REQUIRE(dir.isValid());
 
@@ -104,3 +120,240 @@ TEST_CASE("HistoryStore rewrite, list, rename and purge sessions")
     recent = store.listRecent(0);
     CHECK(recent.isEmpty());
 }
+
+TEST_CASE("HistoryStore index pages recent sessions and searches message text")
+{
+    ensureQtApp();
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+
+    HistoryStore store(dir.path());
+    REQUIRE(store.hasIndex());
+    const QDateTime baseTime(QDate(2025, 3, 1), QTime(8, 0), Qt::UTC);
+    for (int i = 0; i < 5; ++i)
+    {
+        REQUIRE(store.begin(makeMeta(QStringLiteral("session-%1").arg(i), baseTime.addSecs(60 * i))));
+        store.appendMessage(QJsonObject{{"role", QStringLiteral("user")}, {"content", QStringLiteral("routine check %1").arg(i)}});
+    }
+    REQUIRE(store.resume(QStringLiteral("session-1")));
+    store.appendMessage(QJsonObject{{"role", QStringLiteral("assistant")}, {"content", QStringLiteral("同步率已经达到百分之四百，请立即撤离")}});
+    QJsonArray parts;
+    parts.append(QJsonObject{{"type", QStringLiteral("text")}, {"text", QStringLiteral("Unit-01 berserk telemetry")}});
+    REQUIRE(store.begin(makeMeta(QStringLiteral("session-5"), baseTime.addSecs(600))));
+    store.appendMessage(QJsonObject{{"role", QStringLiteral("user")}, {"content", parts}});
+
+    CHECK(store.sessionCount() == 6);
+    const auto firstPage = store.listRecentPage(0, 4);
+    REQUIRE(firstPage.size() == 4);
+    CHECK(firstPage.first().id == QStringLiteral("session-5"));
+    CHECK(firstPage.first().title == QStringLiteral("Unit-01 berserk telemetry"));
+    const auto secondPage = store.listRecentPage(4, 4);
+    REQUIRE(secondPage.size() == 2);
+    CHECK(secondPage.last().id == QStringLiteral("session-0"));
+
+    auto hits = store.search(QStringLiteral("百分之四百"), 10);
+    REQUIRE(hits.size() == 1);
+    CHECK(hits.first().id == QStringLiteral("session-1"));
+    CHECK(hits.first().snippet.contains(QStringLiteral("百分之四百")));
+
+    hits = store.search(QStringLiteral("BERSERK"), 10);
+    REQUIRE(hits.size() == 1);
+    CHECK(hits.first().id == QStringLiteral("session-5"));
+
+    hits = store.search(QStringLiteral("routine"), 3);
+    CHECK(hits.size() == 3);
+    CHECK(hits.first().id == QStringLiteral("session-4"));
+
+    REQUIRE(store.renameSession(QStringLiteral("session-2"), QStringLiteral("Angel sighting")));
+    hits = store.search(QStringLiteral("angel"), 10);
+    REQUIRE(hits.size() == 1);
+    CHECK(hits.first().id == QStringLiteral("session-2"));
+
+    REQUIRE(store.deleteSession(QStringLiteral("session-1")));
+    CHECK(store.search(QStringLiteral("百分之四百"), 10).isEmpty());
+    CHECK(store.sessionCount() == 5);
+}
+
+TEST_CASE("HistoryStore rebuilds a missing index from the session files")
+{
+    ensureQtApp();
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QDateTime baseTime(QDate(2025, 4, 2), QTime(9, 30), Qt::UTC);
+    {
+        HistoryStore store(dir.path());
+        REQUIRE(store.begin(makeMeta(QStringLiteral("old-one"), baseTime)));
+        store.appendMessage(QJsonObject{{"role", QStringLiteral("user")}, {"content", QStringLiteral("positron rifle calibration")}});
+        REQUIRE(store.begin(makeMeta(QStringLiteral("old-two"), baseTime.addSecs(30))));
+        store.appendMessage(QJsonObject{{"role", QStringLiteral("user")}, {"content", QStringLiteral("umbilical cable length")}});
+    }
+    for (const QString &name : QDir(dir.path()).entryList({QStringLiteral("index.sqlite*")}, QDir::Files))
+        REQUIRE(QFile::remove(QDir(dir.path()).filePath(name)));
+
+    HistoryStore reopened(dir.path());
+    REQUIRE(reopened.hasIndex());
+    const auto recent = reopened.listRecent(0);
+    REQUIRE(recent.size() == 2);
+    CHECK(recent.first().id == QStringLiteral("old-two"));
+    CHECK(recent.first().title == QStringLiteral("umbilical cable length"));
+    const auto hits = reopened.search(QStringLiteral("positron"), 10);
+    REQUIRE(hits.size() == 1);
+    CHECK(hits.first().id == QStringLiteral("old-one"));
+}
+
+TEST_CASE("HistoryStore does not rebuild for directories without meta.json")
+{
+    ensureQtApp();
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    {
+        HistoryStore store(dir.path());
+        REQUIRE(store.begin(makeMeta(QStringLiteral("kept"), QDateTime::currentDateTimeUtc())));
+        store.appendMessage(QJsonObject{{"role", QStringLiteral("user")}, {"content", QStringLiteral("dummy plug")}});
+    }
+    REQUIRE(QDir(dir.path()).mkdir(QStringLiteral("stray")));
+    CHECK(HistoryIndex::sessionDirs(dir.path()).size() == 1);
+    {
+        // 直接改索引里的标题：若重新打开时触发了重建，它会被 meta.json 覆盖回去
+        HistoryIndex index;
+        REQUIRE(index.open(QDir(dir.path()).filePath(QStringLiteral("index.sqlite"))));
+        index.setTitle(QStringLiteral("kept"), QStringLiteral("marker"));
+    }
+
+    HistoryStore reopened(dir.path());
+    REQUIRE(reopened.hasIndex());
+    const auto recent = reopened.listRecent(0);
+    REQUIRE(recent.size() == 1);
+    CHECK(recent.first().title == QStringLiteral("marker"));
+    CHECK(reopened.sessionCount() == 1);
+}
+
+TEST_CASE("HistoryWriter merges queued appends into one commit")
+{
+    ensureQtApp();
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = QDir(dir.path()).filePath(QStringLiteral("messages.jsonl"));
+
+    // 间隔足够长：只有 flush() 会触发提交
+    HistoryWriter writer(60000);
+    for (int i = 0; i < 50; ++i) writer.append(path, QStringLiteral("{\"seq\":%1}\n").arg(i).toUtf8());
+    CHECK(writer.commits() == 0);
+    REQUIRE(writer.flush(true));
+    CHECK(writer.commits() == 1);
+    CHECK(writer.openHandles() == 1);
+
+    QFile f(path);
+    REQUIRE(f.open(QIODevice::ReadOnly));
+    const QList<QByteArray> lines = f.readAll().split('\n');
+    f.close();
+    REQUIRE(lines.size() == 51); // 末尾换行后的空串
+    CHECK(lines.at(49) == QByteArray("{\"seq\":49}"));
+
+    writer.replace(path, QByteArray("{\"seq\":0}\n"));
+    writer.replace(path, QByteArray("{\"seq\":1}\n"));
+    writer.append(path, QByteArray("{\"seq\":2}\n"));
+    writer.closeUnder(dir.path());
+    CHECK(writer.openHandles() == 0);
+    REQUIRE(f.open(QIODevice::ReadOnly));
+    CHECK(f.readAll() == QByteArray("{\"seq\":1}\n{\"seq\":2}\n"));
+}
+
+TEST_CASE("HistoryWriter applies index updates on its thread and flushes asynchronously")
+{
+    ensureQtApp();
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = QDir(dir.path()).filePath(QStringLiteral("messages.jsonl"));
+    const QString dbPath = QDir(dir.path()).filePath(QStringLiteral("index.sqlite"));
+
+    HistoryWriter writer(60000);
+    REQUIRE(writer.attachIndex(dbPath));
+    Qt::HANDLE taskThread = nullptr;
+    writer.append(path, QByteArray("{\"role\":\"user\",\"content\":\"entry plug\"}\n"));
+    writer.updateIndex([&taskThread](HistoryIndex &index)
+                       {
+                           taskThread = QThread::currentThreadId();
+                           index.upsertSession(QStringLiteral("s1"), QStringLiteral("entry plug"), QDateTime::currentDateTimeUtc());
+                           index.addMessage(QStringLiteral("s1"), QJsonObject{{"role", QStringLiteral("user")}, {"content", QStringLiteral("entry plug")}});
+                           return true; });
+    // 不等待：提交由写入线程完成
+    writer.flushAsync(true);
+    for (int i = 0; i < 300 && writer.commits() == 0; ++i) QThread::msleep(10);
+    CHECK(writer.commits() == 1); // 文件追加与索引更新在同一次提交中
+    REQUIRE(writer.flush());
+    CHECK(taskThread != nullptr);
+    CHECK(taskThread != QThread::currentThreadId());
+
+    HistoryIndex reader;
+    REQUIRE(reader.open(dbPath));
+    CHECK(reader.sessionCount() == 1);
+    CHECK(reader.search(QStringLiteral("entry"), 10).size() == 1);
+}
+
+TEST_CASE("HistoryStore syncs a completed turn even after the timer committed it")
+{
+    ensureQtApp();
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+
+    HistoryStore store(dir.path());
+    REQUIRE(store.begin(makeMeta(QStringLiteral("session-sync"), QDateTime::currentDateTimeUtc())));
+    store.appendMessage(QJsonObject{{"role", QStringLiteral("user")}, {"content", QStringLiteral("sync ratio")}});
+    store.appendMessage(QJsonObject{{"role", QStringLiteral("assistant")}, {"content", QStringLiteral("400%")}});
+    // 相当于攒批定时器到期：默认策略下只写入系统缓存，不 fsync
+    REQUIRE(store.flush(false));
+    const quint64 commits = store.writer()->commits();
+    CHECK(store.writer()->syncedCommits() == 0);
+
+    // 回合结束（Widget::normal_finish_pushover）：队列已空，仍要把本轮写过的文件刷到磁盘
+    store.flushAsync();
+    REQUIRE(store.flush(false)); // 排在异步提交之后，返回时它已执行完
+    CHECK(store.writer()->syncedCommits() == 1);
+    CHECK(store.writer()->commits() == commits);
+}
+
+TEST_CASE("HistoryStore drops a torn trailing line left by a crash")
+{
+    ensureQtApp();
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const SessionMeta meta = makeMeta(QStringLiteral("session-torn"), QDateTime::currentDateTimeUtc());
+    {
+        HistoryStore store(dir.path());
+        REQUIRE(store.begin(meta));
+        store.appendMessage(QJsonObject{{"role", QStringLiteral("user")}, {"content", QStringLiteral("first contact")}});
+        store.appendMessage(QJsonObject{{"role", QStringLiteral("assistant")}, {"content", QStringLiteral("pattern blue")}});
+    }
+    const QString path = QDir(QDir(dir.path()).filePath(meta.id)).filePath(QStringLiteral("messages.jsonl"));
+    {
+        QFile f(path);
+        REQUIRE(f.open(QIODevice::WriteOnly | QIODevice::Append));
+        f.write("{\"role\":\"user\",\"content\":\"interrup");
+    }
+    CHECK(HistoryWriter::hasTornTail(path));
+
+    HistoryStore store(dir.path());
+    SessionMeta loadedMeta;
+    QJsonArray loadedMessages;
+    REQUIRE(store.loadSession(meta.id, loadedMeta, loadedMessages));
+    CHECK(loadedMessages.size() == 2);
+    CHECK_FALSE(HistoryWriter::hasTornTail(path));
+
+    REQUIRE(store.resume(meta.id));
+    store.appendMessage(QJsonObject{{"role", QStringLiteral("user")}, {"content", QStringLiteral("resumed")}});
+    REQUIRE(store.loadSession(meta.id, loadedMeta, loadedMessages));
+    REQUIRE(loadedMessages.size() == 3);
+    CHECK(loadedMessages.last().toObject().value("content").toString() == QStringLiteral("resumed"));
+
+    // 完整但缺少换行的最后一行会被保留
+    {
+        QFile f(path);
+        REQUIRE(f.open(QIODevice::WriteOnly | QIODevice::Append));
+        f.write("{\"role\":\"assistant\",\"content\":\"kept\"}");
+    }
+    store.flush();
+    REQUIRE(store.loadSession(meta.id, loadedMeta, loadedMessages));
+    REQUIRE(loadedMessages.size() == 4);
+    CHECK(loadedMessages.last().toObject().value("content").toString() == QStringLiteral("kept"));
+}
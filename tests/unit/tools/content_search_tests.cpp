@@ -0,0 +1,226 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <limits>
+
+#include "service/tools/content_search.h"
+
+namespace
+{
+void writeFile(const QString &path, const QByteArray &content)
+{
+    QVERIFY(QDir().mkpath(QFileInfo(path).absolutePath()));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(content);
+}
+
+qint64 findIn(const ContentSearch::Matcher &matcher, const QByteArray &haystack)
+{
+    return matcher.find(haystack.constData(), haystack.size(), 0);
+}
+
+// 用与内置检索相同的限制调用 rg，返回输出行数；失败时返回 -1
+int ripgrepLineCount(const QString &rg, const QString &root, const QString &query)
+{
+    QProcess process;
+    process.setWorkingDirectory(root);
+    process.start(rg, {QStringLiteral("--fixed-strings"), QStringLiteral("--ignore-case"), QStringLiteral("--no-heading"),
+                       QStringLiteral("--line-number"), QStringLiteral("--max-count"), QStringLiteral("3"),
+                       QStringLiteral("--max-filesize"), QStringLiteral("2000K"), query, QStringLiteral(".")});
+    if (!process.waitForFinished(60000)) return -1;
+    return QString::fromUtf8(process.readAllStandardOutput()).split('\n', Qt::SkipEmptyParts).size();
+}
+} // namespace
+
+class ContentSearchTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void matcherFindsSubstrings();
+    void searchTreeHonorsIgnoreRules();
+    void stopsAtMatchCap();
+    void searchFilesUsesGivenList();
+    void matchCountMatchesRipgrep();
+    void benchmarkAgainstRipgrep();
+};
+
+void ContentSearchTest::matcherFindsSubstrings()
+{
+    const ContentSearch::Matcher ascii(QStringLiteral("Needle"), true);
+    QVERIFY(ascii.byteMode());
+    QCOMPARE(findIn(ascii, QByteArray("hay NEEDLE hay")), qint64(4));
+    QCOMPARE(findIn(ascii, QByteArray("needl needlE")), qint64(6));
+    QCOMPARE(findIn(ascii, QByteArray("nothing here")), qint64(-1));
+
+    const ContentSearch::Matcher exact(QStringLiteral("Needle"), false);
+    QCOMPARE(findIn(exact, QByteArray("needle Needle")), qint64(7));
+
+    const ContentSearch::Matcher cjk(QStringLiteral("同步率"), true);
+    QVERIFY(cjk.byteMode());
+    const QByteArray text = QStringLiteral("当前同步率400%").toUtf8();
+    QCOMPARE(findIn(cjk, text), qint64(QStringLiteral("当前").toUtf8().size()));
+
+    const ContentSearch::Matcher symbol(QStringLiteral("::run("), true);
+    QCOMPARE(findIn(symbol, QByteArray("void Worker::Run(int)")), qint64(11));
+
+    // 非 ASCII 的大小写折叠走逐行 QString 比较
+    const ContentSearch::Matcher umlaut(QStringLiteral("ÄRGER"), true);
+    QVERIFY(!umlaut.byteMode());
+    QVERIFY(umlaut.matchesLine(QStringLiteral("kein ärger hier")));
+}
+
+void ContentSearchTest::searchTreeHonorsIgnoreRules()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QDir root(tempDir.path());
+    writeFile(root.filePath(QStringLiteral(".gitignore")), "build/\n*.log\n/docs/generated\n");
+    writeFile(root.filePath(QStringLiteral("src/main.cpp")), "int main()\n{\n    // TARGET one\n    return 0; // target two\n}\n");
+    writeFile(root.filePath(QStringLiteral("src/many.txt")), "target\ntarget\ntarget\ntarget\ntarget\n");
+    writeFile(root.filePath(QStringLiteral("src/crlf.txt")), "a\r\nb\r\nc target\r\n");
+    writeFile(root.filePath(QStringLiteral("build/out.txt")), "target in build\n");
+    writeFile(root.filePath(QStringLiteral("node_modules/pkg/index.js")), "target in deps\n");
+    writeFile(root.filePath(QStringLiteral("docs/generated/api.md")), "target in generated docs\n");
+    writeFile(root.filePath(QStringLiteral("docs/guide.md")), "target in guide\n");
+    writeFile(root.filePath(QStringLiteral("run.log")), "target in log\n");
+    writeFile(root.filePath(QStringLiteral(".hidden.txt")), "target hidden\n");
+    writeFile(root.filePath(QStringLiteral("blob.bin")), QByteArray("target\0\0binary", 14));
+
+    ContentSearch::Options options;
+    options.query = QStringLiteral("target");
+    options.threads = 4;
+    const ContentSearch::Result result = ContentSearch::searchTree(root.path(), options);
+    QCOMPARE(result.lines, QStringList({QStringLiteral("docs/guide.md:1:target in guide"),
+                                        QStringLiteral("src/crlf.txt:3:c target"),
+                                        QStringLiteral("src/main.cpp:3:// TARGET one"),
+                                        QStringLiteral("src/main.cpp:4:return 0; // target two"),
+                                        QStringLiteral("src/many.txt:1:target"),
+                                        QStringLiteral("src/many.txt:2:target"),
+                                        QStringLiteral("src/many.txt:3:target")}));
+    QCOMPARE(result.binarySkipped, 1);
+    QVERIFY(!result.truncated);
+    // 被忽略的目录逐个报告，便于 search_content 在结果里说明
+    QStringList skipped;
+    for (const QString &dir : result.skippedDirs) skipped << root.relativeFilePath(dir);
+    QCOMPARE(skipped, QStringList({QStringLiteral("build"), QStringLiteral("docs/generated"), QStringLiteral("node_modules")}));
+
+    options.filePattern = QStringLiteral("*.cpp");
+    const ContentSearch::Result filtered = ContentSearch::searchTree(root.path(), options);
+    QCOMPARE(filtered.lines.size(), 2);
+    QVERIFY(filtered.lines.first().startsWith(QStringLiteral("src/main.cpp:3:")));
+}
+
+void ContentSearchTest::stopsAtMatchCap()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QDir root(tempDir.path());
+    for (int i = 0; i < 60; ++i) writeFile(root.filePath(QStringLiteral("d%1/f%2.txt").arg(i % 6).arg(i)), "alpha match\n");
+
+    ContentSearch::Options options;
+    options.query = QStringLiteral("match");
+    options.maxMatches = 10;
+    const ContentSearch::Result result = ContentSearch::searchTree(root.path(), options);
+    QCOMPARE(result.lines.size(), 10);
+    QVERIFY(result.truncated);
+
+    int calls = 0;
+    options.maxMatches = 200;
+    options.threads = 1;
+    options.cancelled = [&calls]() { return ++calls > 3; };
+    const ContentSearch::Result cancelled = ContentSearch::searchTree(root.path(), options);
+    QVERIFY(cancelled.filesScanned < 60);
+}
+
+void ContentSearchTest::searchFilesUsesGivenList()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QDir root(tempDir.path());
+    writeFile(root.filePath(QStringLiteral("a.txt")), "first\nsecond needle\n");
+    writeFile(root.filePath(QStringLiteral("b.txt")), "needle\n");
+    writeFile(root.filePath(QStringLiteral("c.txt")), "needle too\n");
+
+    ContentSearch::Options options;
+    options.query = QStringLiteral("needle");
+    const ContentSearch::Result result =
+        ContentSearch::searchFiles(root.path(), {root.filePath(QStringLiteral("a.txt")), root.filePath(QStringLiteral("b.txt"))}, options);
+    QCOMPARE(result.lines, QStringList({QStringLiteral("a.txt:2:second needle"), QStringLiteral("b.txt:1:needle")}));
+    QCOMPARE(result.filesScanned, 2);
+}
+
+void ContentSearchTest::matchCountMatchesRipgrep()
+{
+    const QString rg = QStandardPaths::findExecutable(QStringLiteral("rg"));
+    if (rg.isEmpty()) QSKIP("rg not installed");
+    // 小型合成树：没有嵌套 .gitignore 等 rg 独有的规则，两侧命中必须一致
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QDir root(tempDir.path());
+    for (int i = 0; i < 12; ++i)
+    {
+        QByteArray content;
+        for (int line = 0; line < 60; ++line)
+            content += (line % 7 == i % 7) ? "    const QString s = QStringLiteral(\"value\");\n" : "    int value = compute(line) + offset;\n";
+        writeFile(root.filePath(QStringLiteral("src/mod%1/file%2.cpp").arg(i % 3).arg(i)), content);
+    }
+
+    ContentSearch::Options options;
+    options.query = QStringLiteral("qstringliteral");
+    options.maxMatches = std::numeric_limits<int>::max();
+    options.maxPerFile = 3;
+    const ContentSearch::Result builtin = ContentSearch::searchTree(root.path(), options);
+    QVERIFY(!builtin.truncated);
+    QCOMPARE(builtin.filesScanned, 12);
+    QCOMPARE(builtin.lines.size(), ripgrepLineCount(rg, root.path(), options.query));
+}
+
+// 计时对比仅在设置 EVA_SEARCH_BENCH_ROOT（例如 EVA 源码树）时运行，默认单测不做耗时断言
+void ContentSearchTest::benchmarkAgainstRipgrep()
+{
+    const QString root = qEnvironmentVariable("EVA_SEARCH_BENCH_ROOT");
+    if (root.isEmpty()) QSKIP("set EVA_SEARCH_BENCH_ROOT to compare timings with rg");
+    const QString query = qEnvironmentVariable("EVA_SEARCH_BENCH_QUERY", QStringLiteral("QStringLiteral"));
+
+    // 两侧使用相同的限制：不设总命中上限，每个文件最多 3 条（对应 rg --max-count 3）
+    ContentSearch::Options options;
+    options.query = query;
+    options.maxMatches = std::numeric_limits<int>::max();
+    options.maxPerFile = 3;
+    QElapsedTimer timer;
+    timer.start();
+    const ContentSearch::Result builtin = ContentSearch::searchTree(root, options);
+    const qint64 builtinMs = timer.elapsed();
+    qInfo().noquote() << QStringLiteral("builtin: %1 ms, %2 files, %3 bytes, %4 lines")
+                             .arg(builtinMs)
+                             .arg(builtin.filesScanned)
+                             .arg(builtin.bytesScanned)
+                             .arg(builtin.lines.size());
+
+    const QString rg = QStandardPaths::findExecutable(QStringLiteral("rg"));
+    if (rg.isEmpty()) QSKIP("rg not installed; builtin timing printed above");
+    timer.restart();
+    const int rgLines = ripgrepLineCount(rg, root, query);
+    const qint64 rgMs = timer.elapsed();
+    qInfo().noquote() << QStringLiteral("rg: %1 ms, %2 lines; builtin/rg = %3")
+                             .arg(rgMs)
+                             .arg(rgLines)
+                             .arg(rgMs > 0 ? QString::number(double(builtinMs) / rgMs, 'f', 2) : QStringLiteral("n/a"));
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    ContentSearchTest tc;
+    return QTest::qExec(&tc, argc, argv);
+}
+
+#include "content_search_tests.moc"
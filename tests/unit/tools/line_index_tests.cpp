@@ -0,0 +1,130 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include "service/tools/line_index.h"
+
+namespace
+{
+void writeFile(const QString &path, const QByteArray &content)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(content);
+}
+} // namespace
+
+class LineIndexTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void readsWindowWithoutScanningWholeFile();
+    void matchesNewlineNormalization();
+    void invalidatesOnChange();
+};
+
+void LineIndexTest::readsWindowWithoutScanningWholeFile()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = QDir(tempDir.path()).filePath(QStringLiteral("big.log"));
+    QByteArray content;
+    const int total = 20000;
+    for (int i = 1; i <= total; ++i) content += QByteArray("line ") + QByteArray::number(i) + QByteArray(120, 'x') + "\n";
+    writeFile(path, content);
+
+    LineIndexCache cache;
+    LineIndexCache::Window window;
+    QString error;
+    QVERIFY(cache.read(path, 100, 150, &window, &error));
+    QCOMPARE(window.lines.size(), 51);
+    QVERIFY(window.lines.first().startsWith(QStringLiteral("line 100x")));
+    QVERIFY(window.lines.last().startsWith(QStringLiteral("line 150x")));
+    QCOMPARE(window.totalLines, -1); // 只扫描到第 150 行
+    QVERIFY(cache.bytesScanned() < quint64(content.size()) / 4);
+
+    // 再读前面的窗口：从检查点开始，只需读一个块
+    const quint64 before = cache.bytesScanned();
+    QVERIFY(cache.read(path, 10, 12, &window, &error));
+    QCOMPARE(window.firstLine, 10);
+    QVERIFY(window.lines.at(2).startsWith(QStringLiteral("line 12x")));
+    QVERIFY(cache.bytesScanned() - before <= 256 * 1024);
+
+    QVERIFY(cache.read(path, total - 1, total + 10, &window, &error));
+    QCOMPARE(window.lines.size(), 2);
+    QCOMPARE(window.totalLines, total);
+
+    // 索引已完整：窗口读取从最近的检查点开始
+    const quint64 indexed = cache.bytesScanned();
+    QVERIFY(cache.read(path, 15000, 15001, &window, &error));
+    QVERIFY(window.lines.first().startsWith(QStringLiteral("line 15000x")));
+    QVERIFY(cache.bytesScanned() - indexed <= 256 * 1024);
+
+    QVERIFY(cache.read(path, total + 5, total + 6, &window, &error));
+    QVERIFY(window.lines.isEmpty());
+    QCOMPARE(window.totalLines, total);
+    QCOMPARE(cache.size(), 1);
+}
+
+void LineIndexTest::matchesNewlineNormalization()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = QDir(tempDir.path()).filePath(QStringLiteral("mixed.txt"));
+    writeFile(path, QByteArray("\xEF\xBB\xBF") + "alpha\r\nbeta\rgamma\n\n中文行\nlast");
+
+    LineIndexCache cache;
+    LineIndexCache::Window window;
+    QString error;
+    QVERIFY(cache.read(path, 1, 100, &window, &error));
+    QCOMPARE(window.lines, QStringList({QStringLiteral("alpha"), QStringLiteral("beta"), QStringLiteral("gamma"), QString(),
+                                        QStringLiteral("中文行"), QStringLiteral("last")}));
+    QCOMPARE(window.totalLines, 6);
+
+    const QString empty = QDir(tempDir.path()).filePath(QStringLiteral("empty.txt"));
+    writeFile(empty, QByteArray());
+    QVERIFY(cache.read(empty, 1, 10, &window, &error));
+    QVERIFY(window.lines.isEmpty());
+    QCOMPARE(window.totalLines, 0);
+
+    QVERIFY(!cache.read(QDir(tempDir.path()).filePath(QStringLiteral("missing.txt")), 1, 2, &window, &error));
+    QVERIFY(error.startsWith(QStringLiteral("cannot open file")));
+}
+
+void LineIndexTest::invalidatesOnChange()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = QDir(tempDir.path()).filePath(QStringLiteral("notes.txt"));
+    writeFile(path, "one\ntwo\nthree\n");
+
+    LineIndexCache cache;
+    LineIndexCache::Window window;
+    QString error;
+    QVERIFY(cache.read(path, 1, 10, &window, &error));
+    QCOMPARE(window.totalLines, 3);
+
+    writeFile(path, "zero\none\ntwo\nthree\nfour\n");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(10), QFileDevice::FileModificationTime));
+    file.close();
+
+    QVERIFY(cache.read(path, 2, 2, &window, &error));
+    QCOMPARE(window.lines, QStringList({QStringLiteral("one")}));
+    QVERIFY(cache.read(path, 9, 9, &window, &error));
+    QCOMPARE(window.totalLines, 5);
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    LineIndexTest tc;
+    return QTest::qExec(&tc, argc, argv);
+}
+
+#include "line_index_tests.moc"
@@ -0,0 +1,107 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include "service/tools/workspace_index.h"
+
+namespace
+{
+void touchFile(const QString &path, const QByteArray &content = QByteArrayLiteral("x"))
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(content);
+}
+
+QStringList entryNames(const WorkspaceIndex &index, const QString &dir)
+{
+    QVector<WorkspaceIndex::Entry> entries;
+    if (!index.children(dir, &entries)) return {};
+    QStringList names;
+    for (const auto &entry : entries) names << entry.name;
+    return names;
+}
+} // namespace
+
+class WorkspaceIndexTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void indexesTreeAndSkipsIgnoredDirs();
+    void picksUpChangesIncrementally();
+};
+
+void WorkspaceIndexTest::indexesTreeAndSkipsIgnoredDirs()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QDir root(tempDir.path());
+    QVERIFY(root.mkpath(QStringLiteral("src/core")));
+    QVERIFY(root.mkpath(QStringLiteral("node_modules/pkg")));
+    QVERIFY(root.mkpath(QStringLiteral("out")));
+    touchFile(root.filePath(QStringLiteral("src/core/main.cpp")), QByteArrayLiteral("int main(){}"));
+    touchFile(root.filePath(QStringLiteral("node_modules/pkg/index.js")));
+    touchFile(root.filePath(QStringLiteral("out/build.log")));
+    touchFile(root.filePath(QStringLiteral(".gitignore")), QByteArrayLiteral("# build output\nout/\n"));
+
+    WorkspaceIndex index;
+    index.setRoot(tempDir.path());
+    QTRY_VERIFY(index.covers(tempDir.path()));
+
+    // 被忽略目录仍出现在父目录列表中，但不向下索引
+    QCOMPARE(entryNames(index, tempDir.path()), QStringList({QStringLiteral("node_modules"), QStringLiteral("out"), QStringLiteral("src")}));
+    QVERIFY(!index.children(root.filePath(QStringLiteral("node_modules")), nullptr));
+    QVERIFY(!index.children(root.filePath(QStringLiteral("out")), nullptr));
+
+    QVector<WorkspaceIndex::FileRef> files;
+    QStringList skipped;
+    QVERIFY(index.files(tempDir.path(), &files, 100, &skipped));
+    QCOMPARE(files.size(), 1);
+    // 跳过的目录需报告给调用方（search_content 会在结果中说明）
+    skipped.sort();
+    QCOMPARE(skipped.size(), 2);
+    QCOMPARE(QFileInfo(skipped.at(0)).fileName(), QStringLiteral("node_modules"));
+    QCOMPARE(QFileInfo(skipped.at(1)).fileName(), QStringLiteral("out"));
+    QCOMPARE(QFileInfo(files.first().absolutePath).fileName(), QStringLiteral("main.cpp"));
+    QCOMPARE(files.first().size, qint64(12));
+
+    QCOMPARE(index.completePath(QStringLiteral("src/co")), QStringList({QStringLiteral("src/core/")}));
+    QCOMPARE(index.completePath(QStringLiteral("lib/main.cpp")), QStringList({QStringLiteral("src/core/main.cpp")}));
+}
+
+void WorkspaceIndexTest::picksUpChangesIncrementally()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QDir root(tempDir.path());
+    QVERIFY(root.mkpath(QStringLiteral("docs")));
+
+    WorkspaceIndex index;
+    index.setRoot(tempDir.path());
+    QTRY_VERIFY(index.covers(tempDir.path()));
+    const quint64 before = index.generation();
+
+    // 新建多级目录与文件：由写文件工具的通知驱动，不依赖平台文件监视
+    QVERIFY(root.mkpath(QStringLiteral("docs/api/v1")));
+    touchFile(root.filePath(QStringLiteral("docs/api/v1/spec.md")));
+    index.notifyPathChanged(root.filePath(QStringLiteral("docs/api/v1/spec.md")));
+    QTRY_COMPARE(entryNames(index, root.filePath(QStringLiteral("docs/api/v1"))), QStringList({QStringLiteral("spec.md")}));
+    QVERIFY(index.generation() > before);
+
+    QVERIFY(QDir(root.filePath(QStringLiteral("docs/api"))).removeRecursively());
+    index.notifyPathChanged(root.filePath(QStringLiteral("docs/api")));
+    QTRY_VERIFY(entryNames(index, root.filePath(QStringLiteral("docs"))).isEmpty());
+    QVERIFY(!index.children(root.filePath(QStringLiteral("docs/api/v1")), nullptr));
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    WorkspaceIndexTest tc;
+    return QTest::qExec(&tc, argc, argv);
+}
+
+#include "workspace_index_tests.moc"
@@ -0,0 +1,118 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <QImage>
+#include <QPainter>
+
+#include "utils/frame_change_detector.h"
+
+namespace
+{
+QImage desktop()
+{
+    QImage image(640, 360, QImage::Format_RGB32);
+    image.fill(QColor(40, 44, 52));
+    QPainter painter(&image);
+    painter.fillRect(QRect(20, 20, 280, 140), QColor(200, 200, 200));
+    painter.fillRect(QRect(340, 200, 260, 120), QColor(90, 120, 200));
+    return image;
+}
+
+QImage withRect(QImage image, const QRect &rect, const QColor &color)
+{
+    QPainter painter(&image);
+    painter.fillRect(rect, color);
+    return image;
+}
+} // namespace
+
+TEST_CASE("FrameChangeDetector settles on a static screen")
+{
+    FrameChangeDetector::Options options;
+    options.mode = FrameChangeDetector::Mode::Settle;
+    options.settleMs = 1000;
+    FrameChangeDetector detector(options);
+    const QImage frame = desktop();
+
+    CHECK(detector.feed(frame, 0) == FrameChangeDetector::Verdict::Pending);
+    CHECK(detector.feed(frame, 500) == FrameChangeDetector::Verdict::Pending);
+    CHECK(detector.feed(frame, 1000) == FrameChangeDetector::Verdict::Settled);
+    CHECK(detector.frames() == 3);
+}
+
+TEST_CASE("FrameChangeDetector waits for motion to stop before settling")
+{
+    FrameChangeDetector::Options options;
+    options.mode = FrameChangeDetector::Mode::Settle;
+    options.settleMs = 600;
+    FrameChangeDetector detector(options);
+
+    // 进度条在 0~800ms 内持续增长，之后静止
+    qint64 ts = 0;
+    FrameChangeDetector::Verdict verdict = FrameChangeDetector::Verdict::Pending;
+    for (int step = 0; step <= 4; ++step, ts += 200)
+    {
+        verdict = detector.feed(withRect(desktop(), QRect(20, 300, 60 + step * 60, 30), Qt::green), ts);
+        CHECK(verdict == FrameChangeDetector::Verdict::Pending);
+    }
+    const QImage finalFrame = withRect(desktop(), QRect(20, 300, 300, 30), Qt::green);
+    CHECK(detector.feed(finalFrame, 1000) == FrameChangeDetector::Verdict::Pending);
+    CHECK(detector.feed(finalFrame, 1200) == FrameChangeDetector::Verdict::Pending);
+    CHECK(detector.feed(finalFrame, 1400) == FrameChangeDetector::Verdict::Settled);
+}
+
+TEST_CASE("FrameChangeDetector reports a change inside the region")
+{
+    FrameChangeDetector::Options options;
+    options.mode = FrameChangeDetector::Mode::Change;
+    options.region = QRectF(0.5, 0.5, 0.5, 0.5);
+    FrameChangeDetector detector(options);
+
+    CHECK(detector.feed(desktop(), 0) == FrameChangeDetector::Verdict::Pending);
+    // 区域外（左上角）弹出对话框：忽略
+    CHECK(detector.feed(withRect(desktop(), QRect(40, 40, 200, 100), Qt::white), 250) == FrameChangeDetector::Verdict::Pending);
+    CHECK(detector.changedSinceFirst() == 0);
+    // 区域内（右下角）按钮变色：命中
+    CHECK(detector.feed(withRect(desktop(), QRect(360, 220, 200, 80), Qt::red), 500) == FrameChangeDetector::Verdict::Changed);
+    CHECK(detector.changedSinceFirst() > 0);
+}
+
+TEST_CASE("FrameChangeDetector ignores cursor-sized flicker and noise")
+{
+    FrameChangeDetector::Options options;
+    options.mode = FrameChangeDetector::Mode::Change;
+    FrameChangeDetector detector(options);
+    const QImage base = desktop();
+    CHECK(detector.feed(base, 0) == FrameChangeDetector::Verdict::Pending);
+
+    // 闪烁的文本光标：1x12 像素，远小于一个 20x20 的分块
+    CHECK(detector.feed(withRect(base, QRect(100, 62, 1, 12), Qt::black), 250) == FrameChangeDetector::Verdict::Pending);
+
+    // 全屏 ±3 的亮度抖动（如抗锯齿/压缩噪点）
+    QImage noisy = base.copy();
+    for (int y = 0; y < noisy.height(); ++y)
+    {
+        QRgb *row = reinterpret_cast<QRgb *>(noisy.scanLine(y));
+        for (int x = 0; x < noisy.width(); ++x)
+        {
+            const int d = ((x * 7 + y * 13) % 7) - 3;
+            const QRgb p = row[x];
+            row[x] = qRgb(qBound(0, qRed(p) + d, 255), qBound(0, qGreen(p) + d, 255), qBound(0, qBlue(p) + d, 255));
+        }
+    }
+    CHECK(detector.feed(noisy, 500) == FrameChangeDetector::Verdict::Pending);
+    CHECK(detector.changedSinceFirst() == 0);
+}
+
+TEST_CASE("FrameChangeDetector signature matches grid size and clamps region")
+{
+    const QImage frame = desktop();
+    CHECK(FrameChangeDetector::signature(frame, QRectF(0, 0, 1, 1), 32, 18).size() == 32 * 18);
+    CHECK(FrameChangeDetector::signature(QImage(), QRectF(0, 0, 1, 1), 32, 18).isEmpty());
+
+    FrameChangeDetector::Options options;
+    options.region = QRectF(0.9, 0.9, 0.5, 0.5); // 超出屏幕的部分被裁掉
+    FrameChangeDetector detector(options);
+    CHECK(detector.feed(frame, 0) == FrameChangeDetector::Verdict::Pending);
+    CHECK(detector.frames() == 1);
+}
@@ -0,0 +1,112 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include "utils/memory_fit.h"
+
+namespace
+{
+constexpr qint64 kMiB = 1024ll * 1024;
+
+// 近似 8B 级 GQA 模型：32 层、8 个 KV 头、头维 128
+MemoryFitInput llama8bInput()
+{
+    MemoryFitInput input;
+    input.info.valid = true;
+    input.info.arch = QStringLiteral("llama");
+    input.info.nLayer = 32;
+    input.info.nEmbd = 4096;
+    input.info.nHead = 32;
+    input.info.nHeadKv = 8;
+    input.info.keyLength = 128;
+    input.info.valueLength = 128;
+    input.info.vocabSize = 128256;
+    input.modelBytes = 4608 * kMiB;
+    input.nctx = 8192;
+    input.parallel = 1;
+    input.batch = 2048;
+    return input;
+}
+} // namespace
+
+TEST_CASE("KV cache size follows layers, KV heads, context and cache type")
+{
+    const MemoryFitInput input = llama8bInput();
+    // 32 层 × 8 头 × (128 + 128) × 2 字节 × 8192 = 1 GiB
+    CHECK(MemoryFit::kvCacheBytes(input.info, 8192, QStringLiteral("f16"), QStringLiteral("f16")) == 1024 * kMiB);
+    CHECK(MemoryFit::kvCacheBytes(input.info, 4 * 8192, QStringLiteral("f16"), QStringLiteral("f16")) == 4096 * kMiB);
+    CHECK(MemoryFit::kvCacheBytes(input.info, 8192, QStringLiteral("q8_0"), QStringLiteral("q8_0")) == 544 * kMiB);
+    CHECK(MemoryFit::kvCacheBytes(input.info, 8192, QStringLiteral("q8_0"), QStringLiteral("f16")) == 784 * kMiB);
+    CHECK(MemoryFit::cacheTypeBytes(QStringLiteral("unknown")) == 2.0);
+}
+
+TEST_CASE("Ample VRAM offloads every layer and keeps the requested context")
+{
+    MemoryFitInput input = llama8bInput();
+    input.freeVramMb = 24000;
+    input.freeRamMb = 32000;
+    const MemoryFitPlan plan = MemoryFit::plan(input);
+    REQUIRE(plan.valid);
+    CHECK(plan.fits);
+    CHECK(plan.maxGpuLayers == 33);
+    CHECK(plan.gpuLayers == 33);
+    CHECK(plan.nctx == 8192);
+    CHECK(plan.mappedBytes == 0);
+
+    // 用户手动指定的层数不会被抬高
+    input.requestedGpuLayers = 10;
+    CHECK(MemoryFit::plan(input).gpuLayers == 10);
+}
+
+TEST_CASE("Limited VRAM picks the largest layer count that fits")
+{
+    MemoryFitInput input = llama8bInput();
+    input.freeVramMb = 4000;
+    input.freeRamMb = 32000;
+    const MemoryFitPlan plan = MemoryFit::plan(input);
+    REQUIRE(plan.valid);
+    CHECK(plan.fits);
+    CHECK(plan.nctx == 8192);
+    CHECK(plan.gpuLayers > 0);
+    CHECK(plan.gpuLayers < plan.maxGpuLayers);
+    CHECK(double(plan.vramBytes) <= 4000 * 0.95 * kMiB);
+    const MemoryFitPlan oneMore = MemoryFit::estimate(input, plan.gpuLayers + 1, plan.nctx);
+    CHECK(double(oneMore.vramBytes) > 4000 * 0.95 * kMiB);
+    // 没卸载的权重经 mmap 映射，不计入必须常驻的内存
+    CHECK(plan.mappedBytes > 0);
+}
+
+TEST_CASE("CPU backend with tight RAM halves the context until the KV cache fits")
+{
+    MemoryFitInput input = llama8bInput();
+    input.gpu = false;
+    input.nctx = 32768;
+    input.parallel = 4;
+    input.freeRamMb = 8000;
+    const MemoryFitPlan plan = MemoryFit::plan(input);
+    REQUIRE(plan.valid);
+    CHECK(plan.fits);
+    CHECK(plan.gpuLayers == 0);
+    CHECK(plan.vramBytes == 0);
+    CHECK(plan.nctx == 8192);
+    CHECK(double(plan.ramBytes) <= 8000 * 0.9 * kMiB);
+}
+
+TEST_CASE("Unusable metadata or weights larger than RAM leave the settings alone")
+{
+    MemoryFitInput input = llama8bInput();
+    input.info.valid = false;
+    input.info.error = QStringLiteral("not a GGUF file");
+    const MemoryFitPlan invalid = MemoryFit::plan(input);
+    CHECK_FALSE(invalid.valid);
+    CHECK(invalid.reason == QStringLiteral("not a GGUF file"));
+
+    input = llama8bInput();
+    input.gpu = false;
+    input.useMmap = false;
+    input.freeRamMb = 2048;
+    const MemoryFitPlan tooBig = MemoryFit::plan(input);
+    REQUIRE(tooBig.valid);
+    CHECK_FALSE(tooBig.fits);
+    CHECK(tooBig.nctx == 8192);
+    CHECK_FALSE(tooBig.reason.isEmpty());
+}
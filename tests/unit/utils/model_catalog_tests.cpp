@@ -0,0 +1,240 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include <cstring>
+
+#include "app/default_model_finder.h"
+#include "utils/gguf_reader.h"
+#include "utils/model_catalog.h"
+
+namespace
+{
+// 按 GGUF v3 规范拼出只含元数据的文件（张量数为 0）
+class GgufBuilder
+{
+  public:
+    GgufBuilder &str(const char *key, const QByteArray &value)
+    {
+        keyHeader(key, 8);
+        putString(value);
+        return *this;
+    }
+    GgufBuilder &u32(const char *key, quint32 value)
+    {
+        keyHeader(key, 4);
+        put<quint32>(value);
+        return *this;
+    }
+    GgufBuilder &f32(const char *key, float value)
+    {
+        keyHeader(key, 6);
+        quint32 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        put<quint32>(bits);
+        return *this;
+    }
+    GgufBuilder &i32Array(const char *key, const QVector<qint32> &values)
+    {
+        keyHeader(key, 9);
+        put<quint32>(5);
+        put<quint64>(quint64(values.size()));
+        for (qint32 v : values) put<qint32>(v);
+        return *this;
+    }
+    GgufBuilder &strArray(const char *key, const QList<QByteArray> &values)
+    {
+        keyHeader(key, 9);
+        put<quint32>(8);
+        put<quint64>(quint64(values.size()));
+        for (const QByteArray &v : values) putString(v);
+        return *this;
+    }
+
+    QByteArray bytes() const
+    {
+        QByteArray out("GGUF");
+        appendLe<quint32>(out, 3);
+        appendLe<quint64>(out, 0);
+        appendLe<quint64>(out, quint64(count_));
+        return out + body_;
+    }
+
+    bool writeTo(const QString &path, int padding = 0) const
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+        file.write(bytes());
+        if (padding > 0) file.write(QByteArray(padding, '\0'));
+        return true;
+    }
+
+  private:
+    template <typename T>
+    static void appendLe(QByteArray &out, T value)
+    {
+        uchar buf[sizeof(T)];
+        qToLittleEndian<T>(value, buf);
+        out.append(reinterpret_cast<const char *>(buf), int(sizeof(T)));
+    }
+    template <typename T>
+    void put(T value) { appendLe<T>(body_, value); }
+    void putString(const QByteArray &value)
+    {
+        put<quint64>(quint64(value.size()));
+        body_.append(value);
+    }
+    void keyHeader(const char *key, quint32 type)
+    {
+        ++count_;
+        putString(QByteArray(key));
+        put<quint32>(type);
+    }
+
+    QByteArray body_;
+    int count_ = 0;
+};
+
+GgufBuilder llamaModel(const QByteArray &name = "tiny")
+{
+    GgufBuilder b;
+    b.str("general.architecture", "llama")
+        .str("general.name", name)
+        .u32("general.file_type", 15)
+        .u32("llama.context_length", 8192)
+        .u32("llama.embedding_length", 2048)
+        .u32("llama.block_count", 16)
+        .u32("llama.attention.head_count", 32)
+        .u32("llama.attention.head_count_kv", 8)
+        .f32("llama.rope.freq_base", 500000.0f)
+        .str("tokenizer.ggml.model", "gpt2")
+        .strArray("tokenizer.ggml.tokens", {"a", "b", "c"})
+        .str("tokenizer.chat_template", "{{ messages }}");
+    return b;
+}
+
+const uchar *raw(const QByteArray &bytes)
+{
+    return reinterpret_cast<const uchar *>(bytes.constData());
+}
+} // namespace
+
+TEST_CASE("GgufReader extracts architecture, context, attention shape and tokenizer fingerprint")
+{
+    const QByteArray bytes = llamaModel().bytes();
+    const GgufInfo info = GgufReader::parse(raw(bytes), bytes.size());
+    REQUIRE(info.valid);
+    CHECK(info.version == 3);
+    CHECK(info.arch == QStringLiteral("llama"));
+    CHECK(info.name == QStringLiteral("tiny"));
+    CHECK(info.quantType == QStringLiteral("Q4_K_M"));
+    CHECK(info.nCtxTrain == 8192);
+    CHECK(info.nEmbd == 2048);
+    CHECK(info.nLayer == 16);
+    CHECK(info.nHead == 32);
+    CHECK(info.nHeadKv == 8);
+    CHECK(info.keyLength == 64);
+    CHECK(info.valueLength == 64);
+    CHECK(info.vocabSize == 3);
+    CHECK(info.tokenizerModel == QStringLiteral("gpt2"));
+    CHECK(info.tokenizerHash.size() == 16);
+    CHECK(info.chatTemplate == QStringLiteral("{{ messages }}"));
+    CHECK_FALSE(info.isProjector());
+
+    // 同一词表指纹相同，词表不同则不同（草稿模型配对依据）
+    const QByteArray same = llamaModel("other-name").bytes();
+    CHECK(GgufReader::parse(raw(same), same.size()).tokenizerHash == info.tokenizerHash);
+    GgufBuilder different;
+    different.str("general.architecture", "llama").str("tokenizer.ggml.model", "gpt2").strArray("tokenizer.ggml.tokens", {"a", "b", "d"});
+    const QByteArray differentBytes = different.bytes();
+    CHECK(GgufReader::parse(raw(differentBytes), differentBytes.size()).tokenizerHash != info.tokenizerHash);
+}
+
+TEST_CASE("GgufReader takes the largest per-layer KV head count and rejects malformed input")
+{
+    GgufBuilder b;
+    b.str("general.architecture", "openelm").u32("openelm.attention.head_count", 16).i32Array("openelm.attention.head_count_kv", {3, 5, 4});
+    const QByteArray bytes = b.bytes();
+    const GgufInfo info = GgufReader::parse(raw(bytes), bytes.size());
+    REQUIRE(info.valid);
+    CHECK(info.nHeadKv == 5);
+
+    CHECK_FALSE(GgufReader::parse(raw(QByteArray("GGML....")), 8).valid);
+    const QByteArray truncated = llamaModel().bytes().left(60);
+    const GgufInfo cut = GgufReader::parse(raw(truncated), truncated.size());
+    CHECK_FALSE(cut.valid);
+    CHECK(cut.error.contains(QStringLiteral("truncated")));
+}
+
+TEST_CASE("ModelCatalog serves repeat lookups from its cache and reparses changed files")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString modelPath = dir.filePath(QStringLiteral("models/tiny.gguf"));
+    QDir().mkpath(QFileInfo(modelPath).absolutePath());
+    REQUIRE(llamaModel().writeTo(modelPath));
+    const QString cacheFile = dir.filePath(QStringLiteral("EVA_TEMP/model_catalog.json"));
+
+    {
+        ModelCatalog catalog(cacheFile);
+        CHECK(catalog.lookup(modelPath).nCtxTrain == 8192);
+        CHECK(catalog.lookup(modelPath).nCtxTrain == 8192);
+        CHECK(catalog.parseCount() == 1);
+        // lookup 不写盘，改动留到 save（或析构）时一次写回
+        CHECK_FALSE(QFile::exists(cacheFile));
+    }
+    CHECK(QFile::exists(cacheFile));
+    {
+        // 新实例从磁盘缓存恢复：命中只需 stat
+        ModelCatalog catalog(cacheFile);
+        CHECK(catalog.lookup(modelPath).quantType == QStringLiteral("Q4_K_M"));
+        CHECK(catalog.parseCount() == 0);
+
+        // 文件被替换（大小变化）后重新解析
+        REQUIRE(llamaModel().writeTo(modelPath, 128));
+        CHECK(catalog.lookup(modelPath).valid);
+        CHECK(catalog.parseCount() == 1);
+
+        // 文件删除后，写回时清掉对应的缓存项
+        QFile::remove(modelPath);
+        CHECK_FALSE(catalog.lookup(modelPath).valid);
+        REQUIRE(catalog.save());
+    }
+    QFile cache(cacheFile);
+    REQUIRE(cache.open(QIODevice::ReadOnly));
+    CHECK(QJsonDocument::fromJson(cache.readAll()).object().value(QStringLiteral("models")).toObject().isEmpty());
+
+    ModelCatalog reloaded(cacheFile);
+    CHECK_FALSE(reloaded.lookup(modelPath).valid);
+    CHECK(reloaded.parseCount() == 0);
+}
+
+TEST_CASE("DefaultModelFinder skips projector and non-GGUF files when picking the smallest LLM")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString llmDir = dir.filePath(QStringLiteral("llm"));
+    QDir().mkpath(llmDir);
+
+    GgufBuilder projector;
+    projector.str("general.architecture", "clip");
+    REQUIRE(projector.writeTo(QDir(llmDir).filePath(QStringLiteral("mmproj-f16.gguf"))));
+    QFile junk(QDir(llmDir).filePath(QStringLiteral("partial.gguf")));
+    REQUIRE(junk.open(QIODevice::WriteOnly));
+    junk.write("not a model");
+    junk.close();
+    const QString model = QDir(llmDir).filePath(QStringLiteral("tiny-q4.gguf"));
+    REQUIRE(llamaModel().writeTo(model, 4096));
+
+    ModelCatalog catalog(dir.filePath(QStringLiteral("catalog.json")));
+    const DefaultModelPaths paths = DefaultModelFinder::discover(dir.path(), &catalog);
+    CHECK(paths.llmModel == QFileInfo(model).absoluteFilePath());
+    CHECK(DefaultModelFinder::discover(dir.path()).llmModel == QFileInfo(model).absoluteFilePath());
+}
@@ -45,3 +45,15 @@ TEST_CASE("nextRetryBackoffMs uses capped exponential growth")
     CHECK(nextRetryBackoffMs(3, 400, 2000) == 2000);
     CHECK(nextRetryBackoffMs(9, 400, 2000) == 2000);
 }
+
+TEST_CASE("shouldResumeNetStream only resumes interrupted streams within the retry budget")
+{
+    CHECK(shouldResumeNetStream(false, true, true, QNetworkReply::RemoteHostClosedError, 200, 0, 1));
+    CHECK(shouldResumeNetStream(false, true, true, QNetworkReply::TimeoutError, 0, 0, 1));
+    CHECK_FALSE(shouldResumeNetStream(false, false, true, QNetworkReply::RemoteHostClosedError, 0, 0, 1));
+    CHECK_FALSE(shouldResumeNetStream(true, true, true, QNetworkReply::RemoteHostClosedError, 200, 0, 1));
+    CHECK_FALSE(shouldResumeNetStream(false, true, false, QNetworkReply::RemoteHostClosedError, 200, 0, 1));
+    CHECK_FALSE(shouldResumeNetStream(false, true, true, QNetworkReply::RemoteHostClosedError, 200, 1, 1));
+    // 正常结束的流不续写
+    CHECK_FALSE(shouldResumeNetStream(false, true, true, QNetworkReply::NoError, 200, 0, 1));
+}
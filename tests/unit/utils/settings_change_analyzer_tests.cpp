@@ -103,3 +103,42 @@ TEST_CASE("compact change items keeps output short and stable")
     CHECK(compactChangeItems(items, 2) == QStringLiteral("model, nctx +2"));
     CHECK(compactChangeItems(items, 8) == QStringLiteral("model, nctx, port, device"));
 }
+
+TEST_CASE("settings analyzer restarts for effective KV cache, cache reuse and context shift changes")
+{
+    SETTINGS before;
+    SETTINGS after = before;
+    after.hid_cache_type_k = QStringLiteral("q8_0");
+    after.hid_cache_type_v = QStringLiteral("q8_0");
+    after.hid_cache_reuse = 256;
+    after.hid_context_shift = true;
+
+    const SettingsChangeSummary summary = analyzeSettingsChanges(before,
+                                                                 after,
+                                                                 QStringLiteral("8080"),
+                                                                 QStringLiteral("8080"),
+                                                                 QStringLiteral("auto"),
+                                                                 QStringLiteral("auto"),
+                                                                 false,
+                                                                 0);
+    CHECK(summary.requiresBackendRestart);
+    CHECK(summary.restartItems.contains(QStringLiteral("cache_type_k")));
+    CHECK(summary.restartItems.contains(QStringLiteral("cache_type_v")));
+    CHECK(summary.restartItems.contains(QStringLiteral("cache_reuse")));
+    CHECK(summary.restartItems.contains(QStringLiteral("context_shift")));
+
+    // flash attention 关闭时量化类型不会生效，仅改 KV 类型无需重启
+    before.hid_flash_attn = false;
+    SETTINGS quantOnly = before;
+    quantOnly.hid_cache_type_k = QStringLiteral("q4_0");
+    quantOnly.hid_cache_type_v = QStringLiteral("q4_0");
+    const SettingsChangeSummary inert = analyzeSettingsChanges(before,
+                                                               quantOnly,
+                                                               QStringLiteral("8080"),
+                                                               QStringLiteral("8080"),
+                                                               QStringLiteral("auto"),
+                                                               QStringLiteral("auto"),
+                                                               false,
+                                                               0);
+    CHECK_FALSE(inert.requiresBackendRestart);
+}
@@ -0,0 +1,96 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include "utils/speech_stream_window.h"
+
+namespace
+{
+QByteArray pcmBytes(int bytes)
+{
+    return QByteArray(bytes, '\x01');
+}
+} // namespace
+
+TEST_CASE("joinTranscript spaces ASCII words but joins CJK text directly")
+{
+    CHECK(SpeechStreamWindow::joinTranscript(QStringLiteral("hello"), QStringLiteral("world")) == QStringLiteral("hello world"));
+    CHECK(SpeechStreamWindow::joinTranscript(QStringLiteral("你好"), QStringLiteral("世界")) == QStringLiteral("你好世界"));
+    CHECK(SpeechStreamWindow::joinTranscript(QString(), QStringLiteral("tail")) == QStringLiteral("tail"));
+    CHECK(SpeechStreamWindow::joinTranscript(QStringLiteral("head"), QString()) == QStringLiteral("head"));
+}
+
+TEST_CASE("partial requests fire once per step of new audio")
+{
+    SpeechStreamWindow window(100, 1000);
+    window.append(pcmBytes(60));
+    QByteArray pcm;
+    CHECK_FALSE(window.takePartial(&pcm));
+
+    window.append(pcmBytes(60));
+    REQUIRE(window.takePartial(&pcm));
+    CHECK(pcm.size() == 120);
+    // 已送出的部分不重复计入步长
+    window.append(pcmBytes(50));
+    CHECK_FALSE(window.takePartial(&pcm));
+    window.append(pcmBytes(50));
+    REQUIRE(window.takePartial(&pcm));
+    CHECK(pcm.size() == 220); // 部分识别总是整窗送出
+}
+
+TEST_CASE("odd-length chunks are sent sample aligned")
+{
+    SpeechStreamWindow window(10, 1000);
+    window.append(pcmBytes(11));
+    QByteArray pcm;
+    REQUIRE(window.takePartial(&pcm));
+    CHECK(pcm.size() == 10);
+    // 落单的半个采样留到下次
+    CHECK(window.pendingBytes() == 11);
+    CHECK_FALSE(window.hasUnsentAudio());
+    window.append(pcmBytes(1));
+    CHECK(window.hasUnsentAudio());
+    REQUIRE(window.takeFinal(&pcm));
+    CHECK(pcm.size() == 12);
+}
+
+TEST_CASE("a full window commits its text and restarts from the unsent tail")
+{
+    SpeechStreamWindow window(100, 200);
+    window.append(pcmBytes(120));
+    QByteArray pcm;
+    REQUIRE(window.takePartial(&pcm));
+    window.acceptPartial(QStringLiteral("one"));
+    CHECK(window.text() == QStringLiteral("one"));
+
+    window.append(pcmBytes(100));
+    REQUIRE(window.takePartial(&pcm));
+    CHECK(pcm.size() == 220);
+    // 请求在途时继续录到的音频属于下一个窗口
+    window.append(pcmBytes(30));
+    window.acceptPartial(QStringLiteral("one two"));
+    CHECK(window.text() == QStringLiteral("one two"));
+    CHECK(window.partial().isEmpty());
+    CHECK(window.pendingBytes() == 30);
+
+    REQUIRE(window.takeFinal(&pcm));
+    CHECK(pcm.size() == 30);
+    CHECK(window.finish(QStringLiteral("three")) == QStringLiteral("one two three"));
+    CHECK(window.pendingBytes() == 0);
+    CHECK(window.text().isEmpty());
+}
+
+TEST_CASE("final request is skipped when the last partial already covered everything")
+{
+    SpeechStreamWindow window(100, 1000);
+    window.append(pcmBytes(150));
+    QByteArray pcm;
+    REQUIRE(window.takePartial(&pcm));
+    window.acceptPartial(QStringLiteral("done"));
+    CHECK_FALSE(window.hasUnsentAudio());
+    CHECK_FALSE(window.takeFinal(&pcm));
+    CHECK(window.finish(window.partial()) == QStringLiteral("done"));
+
+    SpeechStreamWindow empty(100, 1000);
+    CHECK_FALSE(empty.takeFinal(&pcm));
+    CHECK(empty.finish(QString()).isEmpty());
+}
@@ -0,0 +1,163 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <QApplication>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <QWidget>
+
+#include "app/startup_sequencer.h"
+#include "utils/startuplogger.h"
+
+namespace
+{
+QApplication *ensureQtApp()
+{
+#ifdef Q_OS_LINUX
+    qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+#endif
+    static int argc = 1;
+    static char arg0[] = "startup_timeline_tests";
+    static char *argv[] = {arg0, nullptr};
+    static QApplication app(argc, argv);
+    return &app;
+}
+
+void burnCpu(int ms)
+{
+    const double until = StartupLogger::threadCpuMs() + ms;
+    volatile double sink = 0.0;
+    while (StartupLogger::threadCpuMs() < until) sink = sink + 1.0;
+}
+
+QJsonObject findSpan(const QJsonObject &timeline, const QString &name)
+{
+    for (const QJsonValue &value : timeline.value(QStringLiteral("spans")).toArray())
+    {
+        if (value.toObject().value(QStringLiteral("name")).toString() == name) return value.toObject();
+    }
+    return QJsonObject();
+}
+
+bool waitFor(StartupSequencer &sequencer, int timeoutMs)
+{
+    if (sequencer.isFinished()) return true;
+    QEventLoop loop;
+    QObject::connect(&sequencer, &StartupSequencer::finished, &loop, &QEventLoop::quit);
+    QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    return sequencer.isFinished();
+}
+} // namespace
+
+TEST_CASE("StartupLogger spans separate wall time from thread CPU time")
+{
+    ensureQtApp();
+    StartupLogger::start();
+    {
+        StartupLogger::Scope busy(QStringLiteral("busy"));
+        burnCpu(30);
+    }
+    {
+        StartupLogger::Scope blocked(QStringLiteral("blocked"));
+        QThread::msleep(60);
+    }
+
+    const QJsonObject timeline = StartupLogger::timeline();
+    const QJsonObject busy = findSpan(timeline, QStringLiteral("busy"));
+    const QJsonObject blocked = findSpan(timeline, QStringLiteral("blocked"));
+    REQUIRE_FALSE(busy.isEmpty());
+    REQUIRE_FALSE(blocked.isEmpty());
+    CHECK(busy.value(QStringLiteral("thread")).toString() == QStringLiteral("main"));
+    CHECK(busy.value(QStringLiteral("cpu_ms")).toDouble() >= 25.0);
+    CHECK(busy.value(QStringLiteral("wall_ms")).toDouble() >= busy.value(QStringLiteral("cpu_ms")).toDouble() * 0.9);
+    // 睡眠不占 CPU：墙钟远大于 CPU 时间，正是时间线要暴露的“阻塞型”步骤
+    CHECK(blocked.value(QStringLiteral("wall_ms")).toDouble() >= 55.0);
+    CHECK(blocked.value(QStringLiteral("cpu_ms")).toDouble() < 20.0);
+    CHECK(blocked.value(QStringLiteral("start_ms")).toDouble() >= busy.value(QStringLiteral("start_ms")).toDouble());
+}
+
+TEST_CASE("StartupLogger keeps the first milestone and finish() records a span once")
+{
+    ensureQtApp();
+    StartupLogger::start();
+    StartupLogger::Scope scope(QStringLiteral("early"));
+    const double wall = scope.finish();
+    CHECK(wall >= 0.0);
+    CHECK(scope.finish() == 0.0);
+    CHECK(StartupLogger::spans().size() == 1);
+
+    CHECK(StartupLogger::milestoneMs(QStringLiteral("first_window")) == -1);
+    StartupLogger::milestone(QStringLiteral("first_window"));
+    const qint64 first = StartupLogger::milestoneMs(QStringLiteral("first_window"));
+    QThread::msleep(5);
+    StartupLogger::milestone(QStringLiteral("first_window"));
+    CHECK(StartupLogger::milestoneMs(QStringLiteral("first_window")) == first);
+
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("metrics/startup.json"));
+    REQUIRE(StartupLogger::writeTimeline(path));
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::ReadOnly));
+    const QJsonObject written = QJsonDocument::fromJson(file.readAll()).object();
+    CHECK(written.value(QStringLiteral("first_window_ms")).toDouble() == double(first));
+    CHECK(written.value(QStringLiteral("ready_ms")).toDouble() == -1.0);
+    CHECK(written.value(QStringLiteral("spans")).toArray().size() == 1);
+}
+
+TEST_CASE("StartupSequencer runs deferred work after the first paint, in order")
+{
+    ensureQtApp();
+    StartupLogger::start();
+    QWidget window;
+    window.resize(200, 120);
+    StartupSequencer sequencer(&window);
+    QStringList order;
+    qint64 firstWindowAtTask = -2;
+    sequencer.defer(QStringLiteral("backend"), [&]()
+                    {
+                        firstWindowAtTask = StartupLogger::milestoneMs(QStringLiteral("first_window"));
+                        order << QStringLiteral("backend"); });
+    sequencer.defer(QStringLiteral("store"), [&]()
+                    { order << QStringLiteral("store"); });
+    CHECK(order.isEmpty());
+
+    window.show();
+    REQUIRE(waitFor(sequencer, 5000));
+    CHECK(order == QStringList{QStringLiteral("backend"), QStringLiteral("store")});
+    // 任务执行时首帧已经记下
+    CHECK(firstWindowAtTask >= 0);
+    const QJsonObject timeline = StartupLogger::timeline();
+    CHECK(timeline.value(QStringLiteral("ready_ms")).toDouble() >= timeline.value(QStringLiteral("first_window_ms")).toDouble());
+    CHECK_FALSE(findSpan(timeline, QStringLiteral("backend")).isEmpty());
+    CHECK_FALSE(findSpan(timeline, QStringLiteral("store")).isEmpty());
+
+    // 排空后追加的任务仍会执行
+    sequencer.defer(QStringLiteral("late"), [&]()
+                    { order << QStringLiteral("late"); });
+    CHECK_FALSE(sequencer.isFinished());
+    REQUIRE(waitFor(sequencer, 5000));
+    CHECK(order.last() == QStringLiteral("late"));
+}
+
+TEST_CASE("StartupSequencer falls back when the window is never painted")
+{
+    ensureQtApp();
+    StartupLogger::start();
+    QWidget hidden;
+    StartupSequencer sequencer(&hidden);
+    sequencer.setFallbackMs(50);
+    bool ran = false;
+    sequencer.defer(QStringLiteral("backend"), [&ran]()
+                    { ran = true; });
+    REQUIRE(waitFor(sequencer, 5000));
+    CHECK(ran);
+    CHECK(StartupLogger::milestoneMs(QStringLiteral("first_window")) == -1);
+}
@@ -0,0 +1,131 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include "utils/wavutil.h"
+
+namespace
+{
+QByteArray samples(std::initializer_list<qint16> values)
+{
+    QByteArray out;
+    for (qint16 v : values)
+    {
+        char b[2];
+        qToLittleEndian<qint16>(v, b);
+        out.append(b, 2);
+    }
+    return out;
+}
+
+qint16 sampleAt(const QByteArray &pcm, int index)
+{
+    return qFromLittleEndian<qint16>(reinterpret_cast<const uchar *>(pcm.constData()) + index * 2);
+}
+
+quint32 u32At(const QByteArray &bytes, int offset)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(bytes.constData()) + offset);
+}
+} // namespace
+
+TEST_CASE("pcm16ToWav writes a canonical 44-byte header")
+{
+    const QByteArray pcm = samples({1, -1, 300, -300});
+    const QByteArray wav = pcm16ToWav(pcm, 16000);
+    REQUIRE(wav.size() == 44 + pcm.size());
+    CHECK(wav.left(4) == "RIFF");
+    CHECK(u32At(wav, 4) == quint32(36 + pcm.size()));
+    CHECK(wav.mid(8, 8) == "WAVEfmt ");
+    CHECK(u32At(wav, 24) == 16000u);
+    CHECK(u32At(wav, 28) == 32000u); // byte rate
+    CHECK(wav.mid(36, 4) == "data");
+    CHECK(u32At(wav, 40) == quint32(pcm.size()));
+    CHECK(wav.mid(44) == pcm);
+}
+
+TEST_CASE("odd-length PCM is trimmed to whole frames")
+{
+    const QByteArray wav = pcm16ToWav(samples({7, 8}) + QByteArray(1, '\x05'), 16000);
+    CHECK(u32At(wav, 40) == 4u);
+    CHECK(wav.size() == 48);
+
+    // 双声道时按 4 字节帧对齐
+    const QByteArray stereo = pcm16ToWav(samples({1, 2, 3}), 8000, 2);
+    CHECK(u32At(stereo, 40) == 4u);
+    CHECK(pcm16ToWav(QByteArray(), 16000).size() == 44);
+}
+
+TEST_CASE("parseWavPcm16 round-trips and skips unknown chunks")
+{
+    const QByteArray pcm = samples({10, 20, 30, 40});
+    WavPcm16 parsed;
+    REQUIRE(parseWavPcm16(pcm16ToWav(pcm, 22050, 2), &parsed));
+    CHECK(parsed.sampleRate == 22050);
+    CHECK(parsed.channels == 2);
+    CHECK(parsed.pcm == pcm);
+
+    // 在 fmt 与 data 之间插入一个奇数长度的 LIST 块（含填充字节）
+    QByteArray wav = pcm16ToWav(pcm, 16000);
+    QByteArray list("LIST", 4);
+    char size[4];
+    qToLittleEndian<quint32>(3, size);
+    list.append(size, 4);
+    list.append("abc\0", 4);
+    wav.insert(36, list);
+    REQUIRE(parseWavPcm16(wav, &parsed));
+    CHECK(parsed.pcm == pcm);
+}
+
+TEST_CASE("parseWavPcm16 keeps the complete frames of a truncated data chunk")
+{
+    const QByteArray wav = pcm16ToWav(samples({1, 2, 3, 4}), 16000, 2);
+    WavPcm16 parsed;
+    // 截掉最后 3 个字节：只剩一个完整的双声道帧
+    REQUIRE(parseWavPcm16(wav.left(wav.size() - 3), &parsed));
+    CHECK(parsed.pcm == samples({1, 2}));
+
+    CHECK_FALSE(parseWavPcm16(wav.left(30), &parsed)); // fmt 块不完整
+    CHECK_FALSE(parseWavPcm16(QByteArray("RIFF"), &parsed));
+    CHECK_FALSE(parseWavPcm16(QByteArray(64, '\0'), &parsed));
+
+    // 8-bit PCM 不支持
+    QByteArray eightBit = wav;
+    eightBit[34] = 8;
+    CHECK_FALSE(parseWavPcm16(eightBit, &parsed));
+}
+
+TEST_CASE("resamplePcm16Mono downmixes and interpolates")
+{
+    // 立体声下混取平均
+    const QByteArray mono = resamplePcm16Mono(samples({100, 300, -100, -300}), 16000, 2, 16000);
+    REQUIRE(mono.size() == 4);
+    CHECK(sampleAt(mono, 0) == 200);
+    CHECK(sampleAt(mono, 1) == -200);
+
+    // 8k -> 16k：新增的采样落在相邻采样之间
+    const QByteArray up = resamplePcm16Mono(samples({0, 1000, 2000}), 8000, 1, 16000);
+    REQUIRE(up.size() == 12);
+    CHECK(sampleAt(up, 0) == 0);
+    CHECK(sampleAt(up, 1) == 500);
+    CHECK(sampleAt(up, 2) == 1000);
+    CHECK(sampleAt(up, 5) == 2000); // 末尾保持最后一个采样
+
+    // 48k -> 16k：每 3 个取 1 个
+    const QByteArray down = resamplePcm16Mono(samples({0, 1, 2, 30, 31, 32}), 48000, 1, 16000);
+    REQUIRE(down.size() == 4);
+    CHECK(sampleAt(down, 0) == 0);
+    CHECK(sampleAt(down, 1) == 30);
+}
+
+TEST_CASE("resamplePcm16Mono handles empty and partial input")
+{
+    CHECK(resamplePcm16Mono(QByteArray(), 44100, 1, 16000).isEmpty());
+    CHECK(resamplePcm16Mono(QByteArray(1, '\x01'), 44100, 1, 16000).isEmpty());
+    CHECK(resamplePcm16Mono(samples({1, 2}), 0, 1, 16000).isEmpty());
+    // 多出的半帧被忽略
+    CHECK(resamplePcm16Mono(samples({5, 6, 7}), 16000, 2, 16000).size() == 2);
+    // 满幅信号下混后不溢出
+    const QByteArray loud = resamplePcm16Mono(samples({32767, 32767, -32768, -32768}), 16000, 2, 16000);
+    CHECK(sampleAt(loud, 0) == 32767);
+    CHECK(sampleAt(loud, 1) == -32768);
+}
@@ -190,7 +190,7 @@ static void appendUtf8CodePoint(std::string &out, uint32_t codePoint)
 
 static std::string utf16ToUtf8(const char16_t *data, size_t length)
 {
-    static std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> converter;
+    thread_local std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> converter;
     try
     {
         return converter.to_bytes(data, data + length);